@@ -0,0 +1,95 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <vector>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include "arraypool.h"
+
+namespace pvxs {
+namespace ioc {
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+// number of released buffers kept for re-use.
+// enough for a subscription queue to hold a couple of updates in flight.
+constexpr size_t maxFree = 4u;
+}
+
+struct ArrayPool::Pvt {
+    epicsMutex lock;
+    struct Buffer {
+        size_t size;
+        std::unique_ptr<char[]> buf;
+    };
+    std::vector<Buffer> idle; // guarded by lock
+
+    void release(char* buf, size_t size)
+    {
+        // any unused buffer is free()'d after unlock
+        std::unique_ptr<char[]> owned(buf);
+        Guard G(lock);
+        if(idle.size() < maxFree) {
+            idle.push_back(Buffer{size, std::move(owned)});
+
+        } else {
+            // replace the smallest, which is least useful
+            auto smallest = idle.begin();
+            for(auto it = idle.begin(), end = idle.end(); it!=end; ++it) {
+                if(it->size < smallest->size)
+                    smallest = it;
+            }
+            if(smallest->size < size) {
+                smallest->size = size;
+                smallest->buf.swap(owned);
+            }
+        }
+    }
+};
+
+ArrayPool::ArrayPool()
+    :pvt(std::make_shared<Pvt>())
+{}
+
+ArrayPool::~ArrayPool() {}
+
+std::shared_ptr<char> ArrayPool::take(size_t nbytes) const
+{
+    std::unique_ptr<char[]> buf;
+    size_t size = nbytes;
+    {
+        Guard G(pvt->lock);
+        // best fit, but not so large that a small array would pin a much larger buffer
+        auto best = pvt->idle.end();
+        for(auto it = pvt->idle.begin(), end = pvt->idle.end(); it!=end; ++it) {
+            if(it->size >= nbytes && it->size/2u <= nbytes
+                    && (best==end || it->size < best->size))
+                best = it;
+        }
+        if(best!=pvt->idle.end()) {
+            size = best->size;
+            buf = std::move(best->buf);
+            pvt->idle.erase(best);
+        }
+    }
+    if(!buf)
+        buf.reset(new char[size ? size : 1u]); // not zero'd
+
+    std::weak_ptr<Pvt> wpool(pvt);
+    return std::shared_ptr<char>(buf.release(), [wpool, size](char* ptr) {
+        if(auto pool = wpool.lock()) {
+            pool->release(ptr, size);
+        } else {
+            delete[] ptr;
+        }
+    });
+}
+
+} // pvxs
+} // ioc
@@ -0,0 +1,36 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef PVXS_ARRAYPOOL_H
+#define PVXS_ARRAYPOOL_H
+
+#include <memory>
+
+namespace pvxs {
+namespace ioc {
+
+/**
+ * Recycles the buffers of array values read from one channel.
+ *
+ * A buffer is returned to its pool when the last reference (eg. through a shared_array) is released.
+ * Buffers released after the pool is destroyed are simply freed.
+ * Safe to use from any thread.
+ */
+class ArrayPool {
+    struct Pvt;
+    std::shared_ptr<Pvt> pvt;
+public:
+    ArrayPool();
+    ~ArrayPool();
+
+    // Buffer of at least nbytes, suitably aligned for any element type.  Contents are not initialized.
+    std::shared_ptr<char> take(size_t nbytes) const;
+};
+
+} // pvxs
+} // ioc
+
+#endif //PVXS_ARRAYPOOL_H
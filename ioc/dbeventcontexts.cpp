@@ -0,0 +1,77 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdexcept>
+#include <string>
+#include <stdlib.h>
+
+#include <dbLock.h>
+#include <epicsThread.h>
+
+#include <pvxs/log.h>
+
+#include "dbeventcontexts.h"
+#include "utilpvt.h"
+
+namespace pvxs {
+namespace ioc {
+
+DEFINE_LOGGER(_logname, "pvxs.ioc.events");
+
+namespace {
+
+size_t numEventContexts()
+{
+    size_t ncontexts = 1u;
+    if(auto env = getenv("PVXS_QSRV_EVENT_THREADS")) {
+        try {
+            auto temp = parseTo<uint64_t>(env);
+            if(temp < 1u || temp > 64u)
+                throw std::out_of_range("not in range [1, 64]");
+            ncontexts = size_t(temp);
+        } catch(std::exception& e) {
+            log_err_printf(_logname, "Ignoring invalid PVXS_QSRV_EVENT_THREADS=%s : %s\n", env, e.what());
+        }
+    }
+    return ncontexts;
+}
+
+} // namespace
+
+DBEventContexts::DBEventContexts()
+{
+    auto n = numEventContexts();
+    contexts.reserve(n);
+    for(auto i : range(n)) {
+        (void)i;
+        contexts.emplace_back(db_init_events());
+        if(!contexts.back())
+            throw std::runtime_error("Event Context failed to initialise: db_init_events()");
+    }
+}
+
+void DBEventContexts::start(const char* name)
+{
+    for(auto i : range(contexts.size())) {
+        std::string tname(name);
+        if(contexts.size() > 1u)
+            tname = SB()<<name<<'-'<<i;
+
+        if(db_start_events(contexts[i].get(), tname.c_str(), nullptr, nullptr, epicsThreadPriorityCAServerLow - 1))
+            throw std::runtime_error("Could not start event thread: db_start_events()");
+    }
+}
+
+size_t DBEventContexts::indexOf(dbChannel* chan) const
+{
+    if(contexts.size()<=1u || !chan)
+        return 0u;
+    // lockset IDs are assigned sequentially, so are spread evenly by modulo
+    return dbLockGetLockId(dbChannelRecord(chan)) % contexts.size();
+}
+
+} // ioc
+} // pvxs
@@ -0,0 +1,52 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef PVXS_DBEVENTCONTEXTS_H
+#define PVXS_DBEVENTCONTEXTS_H
+
+#include <vector>
+
+#include <dbEvent.h>
+#include <dbChannel.h>
+
+#include "dbeventcontextdeleter.h"
+
+namespace pvxs {
+namespace ioc {
+
+/**
+ * A number of DB event contexts, each with its own event thread.
+ *
+ * Subscriptions are spread across the contexts by record lockset.
+ * So the events of records which are processed together are delivered by one thread,
+ * while unrelated records are not delayed by each other.
+ *
+ * The number of contexts is taken from $PVXS_QSRV_EVENT_THREADS (default 1).
+ */
+class DBEventContexts {
+public:
+    //! Create contexts.  Event threads are not started until start()
+    //! @throws std::runtime_error if a context can not be created
+    DBEventContexts();
+
+    //! Start event threads.  With more than one context, thread names are suffixed with "-<index>"
+    //! @throws std::runtime_error if an event thread can not be started
+    void start(const char* name);
+
+    inline size_t size() const { return contexts.size(); }
+    inline dbEventCtx operator[](size_t i) const { return contexts[i].get(); }
+
+    //! Index of the context for subscriptions to the record of chan
+    size_t indexOf(dbChannel* chan) const;
+
+private:
+    std::vector<DBEventContext> contexts;
+};
+
+} // ioc
+} // pvxs
+
+#endif //PVXS_DBEVENTCONTEXTS_H
@@ -1,5 +1,13 @@
 #include <epicsExport.h>
 
+#include <pvxs/iochooks.h>
+
+namespace pvxs {
+namespace ioc {
+// no QSRV to use the array
+void publishArray(dbCommon* prec, const char* field, const shared_array<const void>& value) {}
+}} // namespace pvxs::ioc
+
 static
 void pvxsSingleSourceRegistrar() {}
 
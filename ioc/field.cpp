@@ -53,6 +53,10 @@ Field::Field(const FieldDefinition &def)
  * @return the Value referenced by this field within the given value
  */
 Value Field::findIn(Value valueTarget) const {
+    if (ref.resolved()) {
+        // falls back to lookup by name if valueTarget is not an instance of Group::valueTemplate
+        return valueTarget[ref];
+    }
     if (!fieldName.empty()) {
         for (const auto& component: fieldName.fieldNameComponents) {
             valueTarget = valueTarget[component.name];
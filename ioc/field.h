@@ -17,6 +17,7 @@
 
 #include <pvxs/nt.h>
 
+#include "arraypool.h"
 #include "dblocker.h"
 #include "channel.h"
 #include "dbmanylocker.h"
@@ -44,6 +45,10 @@ public:
 
     // only for Meta mapping.  type infered from dbChannelFinalFieldType()
     Value anyType;
+    // buffers for array values of this field
+    ArrayPool arrays;
+    // fieldName resolved against Group::valueTemplate.  Not resolved if fieldName includes an array element.
+    FieldRef ref;
 
     Field(const FieldDefinition& def);
     Field(const Field&) = delete;
@@ -63,8 +63,9 @@ void Group::show(int level) const {
     // no locking as we only print things which are const after initialization
 
     // Group field information
-    printf("  Atomic Get/Put:%s Atomic Members:%ld\n",
+    printf("  Atomic Get/Put:%s Coalesce:%s Atomic Members:%ld\n",
             (atomicPutGet ? "yes" : "no"),
+            (coalesce ? "yes" : "no"),
             fields.size());
 
     // If we need to show detailed information then iterate through all fields showing details
@@ -38,7 +38,11 @@ private:
 public:
     const std::string name;
     const bool atomicPutGet;
+    // subscription updates are posted once per batch of DB events, instead of once per event
+    const bool coalesce;
     std::vector<Field> fields;
+    // fields read by a GET, in the order of Group::fields.  points to storage in Group::fields
+    std::vector<const Field*> getPlan;
     Value valueTemplate;
     ChannelLocks value;
     ChannelLocks properties;
@@ -46,9 +50,10 @@ public:
     void show(int level) const;
     Field& operator[](const std::string& fieldName);
 
-    Group(const std::string& name, bool atomicPutGet)
+    Group(const std::string& name, bool atomicPutGet, bool coalesce = false)
         :name(name)
         ,atomicPutGet(atomicPutGet)
+        ,coalesce(coalesce)
     {}
     Group(const Group&) = delete;
 };
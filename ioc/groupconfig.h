@@ -24,10 +24,11 @@ namespace ioc {
 class GroupConfig {
 public:
     bool atomic, atomicIsSet;
+    bool coalesce, coalesceIsSet;
     std::string structureId;
     std::map<std::string, FieldConfig> fieldConfigMap;
     GroupConfig()
-            :atomic(true), atomicIsSet(false) {
+            :atomic(true), atomicIsSet(false), coalesce(false), coalesceIsSet(false) {
     }
 };
 
@@ -9,6 +9,7 @@
 
 #include <fstream>
 #include <map>
+#include <sstream>
 #include <string>
 
 #include <dbChannel.h>
@@ -181,11 +182,11 @@ void GroupConfigProcessor::defineGroups() {
             }
 
             // Create group when it is first referenced
-            auto&& groupDefinition = groupDefinitionMap[groupName];
+            auto& groupDefinition = groupDefinitionMap[groupName];
 
             // If the structure ID is not already set then set it
             if (!groupConfig.structureId.empty()) {
-                groupDefinitionMap[groupName].structureId = groupConfig.structureId;
+                groupDefinition.structureId = groupConfig.structureId;
             }
 
             // configure the group fields
@@ -195,6 +196,10 @@ void GroupConfigProcessor::defineGroups() {
                 defineAtomicity(groupDefinition, groupConfig, groupName);
             }
 
+            if (groupConfig.coalesceIsSet) {
+                groupDefinition.coalesce = groupConfig.coalesce ? True : False;
+            }
+
         } catch (std::exception& e) {
             fprintf(stderr, "Error configuring group \"%s\" : %s\n", groupName.c_str(), e.what());
         }
@@ -436,7 +441,8 @@ void GroupConfigProcessor::createGroups() {
             auto pair = groupMap.emplace(std::piecewise_construct,
                                          std::forward_as_tuple(groupName),
                                          std::forward_as_tuple(groupName,
-                                                               groupDefinition.atomic != False));
+                                                               groupDefinition.atomic != False,
+                                                               groupDefinition.coalesce == True));
             if (!pair.second) {
                 throw std::runtime_error("Group name already in use");
             }
@@ -449,6 +455,9 @@ void GroupConfigProcessor::createGroups() {
         }
     }
 
+    // Group value types by shape.  Groups with the same shape share one type.
+    std::map<std::string, Value> valueTemplates;
+
     // Second Pass: assemble group's PV structure definitions and db locker
     for (auto& groupDefinitionMapEntry: groupDefinitionMap) {
         auto& groupName = groupDefinitionMapEntry.first;
@@ -462,7 +471,9 @@ void GroupConfigProcessor::createGroups() {
             // Initialize the given group's triggers and associated db locks
             initialiseTriggers(group, groupDefinition);
             // Initialise the given group's value type
-            initialiseValueTemplate(group, groupDefinition);
+            initialiseValueTemplate(group, groupDefinition, valueTemplates);
+            // Resolve field names against the value type, once
+            initialiseGetPlan(group);
         } catch (std::exception& e) {
             fprintf(stderr, "%s: Error Group not created: %s\n", groupName.c_str(), e.what());
         }
@@ -492,14 +503,67 @@ void GroupConfigProcessor::initialiseGroupFields(Group& group, const GroupDefini
     }
 }
 
+/**
+ * Describe the shape of the type of the given group.  All groups with the same shape have the same type.
+ * This depends on the group ID, and on the name, mapping, and channel type of each field.
+ *
+ * @param group the group whose fields have been created
+ * @param groupDefinition the group definition
+ * @return the description, or an empty string if the type must not be shared
+ */
+std::string GroupConfigProcessor::valueTemplateShape(const Group& group, const GroupDefinition& groupDefinition) {
+    std::ostringstream shape;
+    shape << groupDefinition.structureId << '\n';
+
+    // group.fields were created from, and in the same order as, groupDefinition.fields
+    for (auto& field: group.fields) {
+        shape << field.fieldName << ' ' << field.id << ' ' << int(field.info.type);
+        switch(field.info.type) {
+        case MappingInfo::Scalar:
+            shape << ' ' << dbChannelFinalFieldType(field.value)
+                  << ' ' << unsigned(IOCSource::getChannelValueType(field.value, true).code);
+            break;
+        case MappingInfo::Plain:
+            shape << ' ' << unsigned(IOCSource::getChannelValueType(field.value, true).code);
+            break;
+        case MappingInfo::Structure:
+            shape << ' ' << field.isArray;
+            break;
+        case MappingInfo::Const:
+            if (field.info.cval.type().kind() == Kind::Compound)
+                return std::string();
+            shape << ' ' << unsigned(field.info.cval.type().code);
+            break;
+        case MappingInfo::Any:
+        case MappingInfo::Meta:
+        case MappingInfo::Proc:
+            break;
+        }
+        shape << '\n';
+    }
+    return shape.str();
+}
+
 /**
  * Initialise the given group's value template from the given group definition.
  * Creates the top level PVStructure for the group and stores it in valueTemplate.
+ * A group with the same shape as a group already created re-uses its type.
  *
  * @param group the group we're setting
  * @param groupDefinition the group definition we're reading from
+ * @param valueTemplates value templates already created, by shape
  */
-void GroupConfigProcessor::initialiseValueTemplate(Group& group, const GroupDefinition& groupDefinition) {
+void GroupConfigProcessor::initialiseValueTemplate(Group& group, const GroupDefinition& groupDefinition,
+                                                   std::map<std::string, Value>& valueTemplates) {
+    auto shape(valueTemplateShape(group, groupDefinition));
+    if (!shape.empty()) {
+        auto it(valueTemplates.find(shape));
+        if (it != valueTemplates.end()) {
+            group.valueTemplate = it->second.cloneEmpty();
+            return;
+        }
+    }
+
     using namespace pvxs::members;
     // We will go add members to this list, and then add them to the group's valueTemplate before returning
     std::vector<Member> groupMembersToAdd;
@@ -524,6 +588,10 @@ void GroupConfigProcessor::initialiseValueTemplate(Group& group, const GroupDefi
     // create the group's valueTemplate from the group type
     auto groupValueTemplate = groupType.create();
     group.valueTemplate = std::move(groupValueTemplate);
+
+    if (!shape.empty()) {
+        valueTemplates.emplace(std::move(shape), group.valueTemplate);
+    }
 }
 
 /**
@@ -543,7 +611,8 @@ void GroupConfigProcessor::initialiseTriggers(Group& group, const GroupDefinitio
     for (auto& fieldDefinition: groupDefinition.fields) {
         // As long as it has a channel specified
         if (!fieldDefinition.channel.empty()) {
-            auto& field = group[fieldDefinition.name];
+            // group.fields were created from, and in the same order as, groupDefinition.fields
+            auto& field = group.fields.at(&fieldDefinition - groupDefinition.fields.data());
             references.clear();
             // Look at the fields that it triggers
             for (auto& referencedFieldName: fieldDefinition.triggerNames) {
@@ -566,6 +635,31 @@ void GroupConfigProcessor::initialiseTriggers(Group& group, const GroupDefinitio
     }
 }
 
+/**
+ * Initialise the group's GET plan.  Resolve each field name against the group's valueTemplate,
+ * and list the fields which a GET operation must read, so that a GET does no
+ * string lookups.  Must be called after the valueTemplate has been created.
+ *
+ * @param group the group whose GET plan is to be created
+ */
+void GroupConfigProcessor::initialiseGetPlan(Group& group) {
+    group.getPlan.clear();
+    group.getPlan.reserve(group.fields.size());
+    for (auto& field: group.fields) {
+        bool hasArrayElement = false;
+        for (const auto& component: field.fieldName.fieldNameComponents) {
+            hasArrayElement |= component.isArray();
+        }
+        if (!field.fieldName.empty() && !hasArrayElement) {
+            field.ref = group.valueTemplate.index(field.fullName);
+        }
+
+        if (field.info.type != MappingInfo::Proc && field.info.type != MappingInfo::Structure) {
+            group.getPlan.push_back(&field);
+        }
+    }
+}
+
 /**
  * Add members to the given vector of members, for any fields in the given group.
  *
@@ -575,8 +669,9 @@ void GroupConfigProcessor::initialiseTriggers(Group& group, const GroupDefinitio
  */
 void GroupConfigProcessor::addTemplatesForDefinedFields(std::vector<Member>& groupMembers, Group& group,
                                                         const GroupDefinition& groupDefinition) {
-    for (auto& fieldDefinition: groupDefinition.fields) {
-        auto& field = group[fieldDefinition.name];
+    // group.fields were created from, and in the same order as, groupDefinition.fields
+    for (auto& field: group.fields) {
+        auto& fieldDefinition = groupDefinition.fields.at(&field - group.fields.data());
         auto& pDbChannel(field.value);
         switch(fieldDefinition.info.type) {
         case MappingInfo::Scalar:
@@ -611,6 +706,27 @@ void GroupConfigProcessor::addTemplatesForDefinedFields(std::vector<Member>& gro
     }
 }
 
+/**
+ * Create a Value to hold a json scalar.  Values of the same type share one type description.
+ *
+ * @param code the type of json scalar, one of Bool, Int64, Float64, or String
+ * @return a new Value
+ */
+static
+Value jsonValue(TypeCode code) {
+    static const Value prototypes[] = {
+        TypeDef(TypeCode::Bool).create(),
+        TypeDef(TypeCode::Int64).create(),
+        TypeDef(TypeCode::Float64).create(),
+        TypeDef(TypeCode::String).create(),
+    };
+    for (auto& prototype: prototypes) {
+        if (prototype.type() == code)
+            return prototype.cloneEmpty();
+    }
+    return TypeDef(code).create();
+}
+
 /**
  * To process key part of json nodes.  This will be followed by a boolean, integer, block, or null
  *
@@ -630,8 +746,10 @@ int parserCallbackKey(void* parserContext, const unsigned char* key, const size_
 
         if (self->depth == 1) {
             self->groupName.swap(name);
+            self->groupConfig = nullptr;
         } else if (self->depth == 2) {
             self->field.swap(name);
+            self->fieldConfig = nullptr;
         } else if (self->depth == 3) {
             self->key.swap(name);
         } else {
@@ -666,7 +784,7 @@ int parserCallbackNull(void* parserContext) {
 static
 int parserCallbackBoolean(void* parserContext, int booleanValue) {
     return GroupConfigProcessor::yajlProcess(parserContext, [&booleanValue](GroupProcessorContext* self) {
-        auto value = pvxs::TypeDef(TypeCode::Bool).create();
+        auto value = jsonValue(TypeCode::Bool);
         value = booleanValue;
         self->assign(value);
         return 1;
@@ -683,7 +801,7 @@ int parserCallbackBoolean(void* parserContext, int booleanValue) {
 static
 int parserCallbackInteger(void* parserContext, long long integerVal) {
     return GroupConfigProcessor::yajlProcess(parserContext, [&integerVal](GroupProcessorContext* self) {
-        auto value = pvxs::TypeDef(TypeCode::Int64).create();
+        auto value = jsonValue(TypeCode::Int64);
         value = (int64_t)integerVal;
         self->assign(value);
         return 1;
@@ -700,7 +818,7 @@ int parserCallbackInteger(void* parserContext, long long integerVal) {
 static
 int parserCallbackDouble(void* parserContext, double doubleVal) {
     return GroupConfigProcessor::yajlProcess(parserContext, [&doubleVal](GroupProcessorContext* self) {
-        auto value = pvxs::TypeDef(TypeCode::Float64).create();
+        auto value = jsonValue(TypeCode::Float64);
         value = doubleVal;
         self->assign(value);
         return 1;
@@ -720,7 +838,7 @@ int parserCallbackString(void* parserContext, const unsigned char* stringVal,
                                                const size_t stringLen) {
     return GroupConfigProcessor::yajlProcess(parserContext, [&stringVal, &stringLen](GroupProcessorContext* self) {
         std::string val((const char*)stringVal, stringLen);
-        auto value = pvxs::TypeDef(TypeCode::String).create();
+        auto value = jsonValue(TypeCode::String);
         value = val;
         self->assign(value);
         return 1;
@@ -759,8 +877,10 @@ int parserCallbackEndBlock(void* parserContext) {
             self->key.clear();
         } else if (self->depth == 2) {
             self->field.clear();
+            self->fieldConfig = nullptr;
         } else if (self->depth == 1) {
             self->groupName.clear();
+            self->groupConfig = nullptr;
         } else {
             throw std::logic_error("Internal error in json parser: invalid depth");
         }
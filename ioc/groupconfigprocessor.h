@@ -50,7 +50,9 @@ public:
     void createGroups();
     static const char* infoField(DBEntry& dbEntry, const char* key, const char* defaultValue = nullptr);
     static void initialiseGroupFields(Group& group, const GroupDefinition& groupDefinition);
-    static void initialiseValueTemplate(Group& group, const GroupDefinition& groupDefinition);
+    static void initialiseValueTemplate(Group& group, const GroupDefinition& groupDefinition,
+                                        std::map<std::string, Value>& valueTemplates);
+    static std::string valueTemplateShape(const Group& group, const GroupDefinition& groupDefinition);
     void loadConfigFiles();
     void loadConfigFromDb();
     void resolveTriggerReferences();
@@ -84,6 +86,7 @@ private:
     static bool yajlParseHelper(std::istream& jsonGroupDefinitionStream, yajl_handle handle);
     static void initialiseDbLocker(Group& group);
     static void initialiseTriggers(Group& group, const GroupDefinition& groupDefinition);
+    static void initialiseGetPlan(Group& group);
     static TypeDef getTypeDefForChannel(const Channel &pDbChannel);
 };
 
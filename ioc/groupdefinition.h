@@ -32,6 +32,7 @@ public:
     std::string structureId;            // The Normative Type structure ID or any other arbitrary string if not a normative type
     bool hasTriggers{ false };
     TriState atomic{ Unset };
+    TriState coalesce{ Unset };
     std::vector<FieldDefinition> fields;            // The group's fields
     std::map<std::string, size_t> fieldMap;        // The field map, mapping field order
     std::map<std::string, TriggerNames> fieldTriggerMap;    // The trigger map, mapping fields to related triggering fields
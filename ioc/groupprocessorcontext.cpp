@@ -22,13 +22,20 @@ namespace ioc {
  */
 void GroupProcessorContext::assign(const Value& value) {
     canAssign();
-    auto& groupPvConfig = groupConfigProcessor->groupConfigMap[groupName];
+    if (!groupConfig) {
+        groupConfig = &groupConfigProcessor->groupConfigMap[groupName];
+    }
+    auto& groupPvConfig = *groupConfig;
 
     if (depth == 2) {
         if (field == "+atomic") {
             groupPvConfig.atomic = value.as<bool>();
             groupPvConfig.atomicIsSet = true;
 
+        } else if (field == "+coalesce") {
+            groupPvConfig.coalesce = value.as<bool>();
+            groupPvConfig.coalesceIsSet = true;
+
         } else if (field == "+id") {
             groupPvConfig.structureId = value.as<std::string>();
 
@@ -39,7 +46,10 @@ void GroupProcessorContext::assign(const Value& value) {
         field.clear();
 
     } else if (depth == 3) {
-        auto& groupField = groupPvConfig.fieldConfigMap[field];
+        if (!fieldConfig) {
+            fieldConfig = &groupPvConfig.fieldConfigMap[field];
+        }
+        auto& groupField = *fieldConfig;
 
         if (key == "+type") {
             auto tname = value.as<std::string>();
@@ -29,6 +29,9 @@ public:
     std::string groupName, field, key;
     unsigned depth; // number of '{'s
     std::string errorMessage;
+    // configuration of groupName and field, once looked up.  Reset when groupName or field changes.
+    GroupConfig* groupConfig = nullptr;
+    FieldConfig* fieldConfig = nullptr;
 
     GroupProcessorContext(std::string& channelPrefix, GroupConfigProcessor* groupConfigProcessor)
             :channelPrefix(channelPrefix), groupConfigProcessor(groupConfigProcessor), depth(0u) {
@@ -28,6 +28,7 @@
 #include "securitylogger.h"
 #include "securityclient.h"
 #include "localfieldlog.h"
+#include "opworkers.h"
 
 namespace pvxs {
 namespace ioc {
@@ -37,12 +38,13 @@ DEFINE_LOGGER(_logname, "pvxs.ioc.group.source");
 DEFINE_INST_COUNTER(GroupSourceSubscriptionCtx);
 DEFINE_INST_COUNTER(GroupSecurityCache);
 
+static void coalescedPost(void* userArg);
+
 /**
  * Constructor for GroupSource registrar.
  */
 GroupSource::GroupSource()
-        :eventContext(db_init_events()) // Initialise event context
-        ,config(IOCGroupConfig::instance())
+        :config(IOCGroupConfig::instance())
 {
     // Get GroupPv configuration and register each pv name in the server
     auto names(std::make_shared<std::set<std::string >>());
@@ -60,14 +62,18 @@ GroupSource::GroupSource()
 
     allRecords.names = names;
 
-    // Start event pump
-    if (!eventContext) {
-        throw std::runtime_error("Group Source: Event Context failed to initialise: db_init_events()");
+    // Start event pumps
+    postQueues.reserve(eventContexts.size());
+    for (size_t i = 0u; i < eventContexts.size(); i++) {
+        postQueues.emplace_back(new GroupPostQueue());
+        auto& postQueue = postQueues.back();
+        postQueue->eventContext = eventContexts[i];
+        if (db_add_extra_labor_event(eventContexts[i], coalescedPost, postQueue.get())) {
+            throw std::runtime_error("Could not add extra labor: db_add_extra_labor_event()");
+        }
     }
 
-    if (db_start_events(eventContext.get(), "qsrvGroup", nullptr, nullptr, epicsThreadPriorityCAServerLow - 1)) {
-        throw std::runtime_error("Could not start event thread: db_start_events()");
-    }
+    eventContexts.start("qsrvGroup");
 }
 
 /**
@@ -85,8 +91,9 @@ void GroupSource::onCreate(std::unique_ptr<server::ChannelControl>&& channelCont
     auto it(config.groupMap.find(sourceName));
     if(it != config.groupMap.end()) {
         auto& group(it->second);
-        channelControl->onOp([&](std::unique_ptr<server::ConnectOp>&& channelConnectOperation) {
-            onOp(group, std::move(channelConnectOperation));
+        auto channelSecurity(std::make_shared<ChannelSecurity<GroupSecurityCache>>());
+        channelControl->onOp([&group, channelSecurity](std::unique_ptr<server::ConnectOp>&& channelConnectOperation) {
+            onOp(group, channelSecurity, std::move(channelConnectOperation));
         });
 
         channelControl
@@ -148,42 +155,55 @@ void GroupSource::onDisableSubscription(const std::shared_ptr<GroupSourceSubscri
  * @param channelConnectOperation the channel connect operation object
  */
 void GroupSource::onOp(Group& group,
+        const std::shared_ptr<ChannelSecurity<GroupSecurityCache>>& channelSecurity,
         std::unique_ptr<server::ConnectOp>&& channelConnectOperation) {
     // First stage for handling any request is to announce the channel type with a `connect()` call
     // @note The type signalled here must match the eventual type returned by a pvxs get
     channelConnectOperation->connect(group.valueTemplate);
 
-    // register handler for pvxs group get
+    // register handler for pvxs group get.  Locking is done by a QSRV worker, not the server TCP worker
     channelConnectOperation->onGet([&group](std::unique_ptr<server::ExecOp>&& getOperation) {
-        get(group, getOperation);
+        auto op(std::make_shared<std::unique_ptr<server::ExecOp>>(std::move(getOperation)));
+        queueOpWork([&group, op]() {
+            get(group, *op);
+        });
     });
 
-    // Make a security cache for this client's connection to this group
-    // Each time the same client calls put we will re-use the cached security client
-    // The security cache will be deleted when the client disconnects from this group pv
-    auto securityCache = std::make_shared<GroupSecurityCache>();
+    // Processing options of this put operation.
+    // The security clients are cached by the channel, and re-used by every put operation on it,
+    // until the client disconnects from this group pv
+    auto putOptions = std::make_shared<SecurityControlObject>();
 
     // register handler for pvxs group put
     channelConnectOperation
-            ->onPut([&group, securityCache](std::unique_ptr<server::ExecOp>&& putOperation, Value&& value) {
-                if (!securityCache->done) {
-                    // First time we call put we need to initialise the security cache
-                    securityCache->securityClients.resize(group.fields.size());
-                    securityCache->credentials.reset(new Credentials(*putOperation->credentials()));
+            ->onPut([&group, channelSecurity, putOptions](std::unique_ptr<server::ExecOp>&& putOperation,
+                    Value&& value) {
+                // First put on this channel initialises the security cache
+                auto securityCache(channelSecurity->get([&](GroupSecurityCache& security) {
+                    security.securityClients.resize(group.fields.size());
+                    security.credentials.reset(new Credentials(*putOperation->credentials()));
                     auto fieldIndex = 0u;
                     for (auto& field: group.fields) {
                         if (field.value) {
-                            securityCache->securityClients[fieldIndex]
-                                    .update(field.value, *securityCache->credentials);
+                            security.securityClients[fieldIndex]
+                                    .update(field.value, *security.credentials);
                         }
                         fieldIndex++;
                     }
+                }));
+                if (!putOptions->done) {
                     auto& pvRequest = putOperation->pvRequest();
-                    IOCSource::setForceProcessingFlag(pvRequest, securityCache);
-                    securityCache->done = true;
+                    IOCSource::setForceProcessingFlag(pvRequest, putOptions);
+                    putOptions->done = true;
                 }
 
-                putGroup(group, putOperation, value, *securityCache);
+                // Locking and processing are done by a QSRV worker, not the server TCP worker
+                auto op(std::make_shared<std::unique_ptr<server::ExecOp>>(std::move(putOperation)));
+                Value toPut(std::move(value));
+                auto forceProcessing(putOptions->forceProcessing);
+                queueOpWork([&group, securityCache, forceProcessing, op, toPut]() {
+                    putGroup(group, *op, toPut, *securityCache, forceProcessing);
+                });
             });
 }
 
@@ -226,6 +246,46 @@ void subscriptionPost(GroupSourceSubscriptionCtx *pGroupCtx)
     currentValue.unmark();
 }
 
+/**
+ * For a +coalesce group, post once all DB events currently queued have been delivered,
+ * so that the changes to many members from one processing chain are posted together.
+ * Called from the event task.
+ */
+static
+void subscriptionPostLater(GroupSourceSubscriptionCtx *pGroupCtx)
+{
+    if (pGroupCtx->postPending)
+        return;
+    pGroupCtx->postPending = true;
+    pGroupCtx->postQueue->pending.push_back(pGroupCtx->shared_from_this());
+    db_post_extra_labor(pGroupCtx->postQueue->eventContext);
+}
+
+/**
+ * Extra labor of the event task, run after it has delivered a batch of DB events.
+ *
+ * @param userArg the GroupPostQueue of a GroupSource
+ */
+static
+void coalescedPost(void* userArg)
+{
+    try {
+        auto queue = static_cast<GroupPostQueue*>(userArg);
+        auto pending(std::move(queue->pending));
+        queue->pending.clear();
+
+        for (auto& weakCtx: pending) {
+            if (auto pGroupCtx = weakCtx.lock()) {
+                pGroupCtx->postPending = false;
+                if (pGroupCtx->eventsEnabled)
+                    subscriptionPost(pGroupCtx.get());
+            }
+        }
+    } catch(std::exception& e) {
+        log_exc_printf(_logname, "Unhandled exception in %s\n", __func__);
+    }
+}
+
 /**
  * Called when a client starts a subscription it has subscribed to.  For each field in the subscription,
  * enable events and post a single event to both the values and properties event channels to kick things off.
@@ -276,10 +336,14 @@ void subscriptionValueCallback(void* userArg, dbChannel* pChannel, int, struct d
 #endif
             LocalFieldLog localFieldLog(channelToUse, isSelfTrig ? pDbFieldLog : nullptr);
             IOCSource::get(leafNode, pTriggeredField->info, pTriggeredField->anyType,
-                           change, channelToUse, localFieldLog.pFieldLog);
+                           change, channelToUse, localFieldLog.pFieldLog, &pTriggeredField->arrays);
         }
 
-        subscriptionPost(pGroupCtx);
+        if (pGroupCtx->group.coalesce) {
+            subscriptionPostLater(pGroupCtx);
+        } else {
+            subscriptionPost(pGroupCtx);
+        }
 
     } catch(std::exception& e) {
         log_exc_printf(_logname, "Unhandled exception in %s\n", __func__);
@@ -301,7 +365,6 @@ void subscriptionPropertiesCallback(void* userArg, dbChannel* pChannel, int, str
          */
 
         DBLocker L(dbChannelRecord(pChannel));
-        LocalFieldLog localFieldLog(pChannel, pDbFieldLog);
         IOCSource::get(fieldValue, field.info, field.anyType,
                        UpdateType::Property, pChannel, pDbFieldLog);
 
@@ -332,6 +395,17 @@ void GroupSource::onSubscribe(const std::shared_ptr<GroupSourceSubscriptionCtx>&
     groupSubscriptionCtx->currentValue["record._options.queueSize"] = stats.limitQueue;
     groupSubscriptionCtx->currentValue["record._options.atomic"] = true;
 
+    // all fields share the context chosen by the lockset of the first record
+    size_t shard = 0u;
+    for (auto& field: groupSubscriptionCtx->group.fields) {
+        if (field.value) {
+            shard = eventContexts.indexOf(field.value);
+            break;
+        }
+    }
+    auto eventContext(eventContexts[shard]);
+    groupSubscriptionCtx->postQueue = postQueues[shard].get();
+
     // Initialise the field subscription contexts.  One for each group field.
     // This is stored in the group context
     groupSubscriptionCtx->fieldSubscriptionContexts.reserve(groupSubscriptionCtx->group.fields.size());
@@ -356,16 +430,16 @@ void GroupSource::onSubscribe(const std::shared_ptr<GroupSourceSubscriptionCtx>&
         // one for value|alarm changes
         if (field.info.type == MappingInfo::Meta) {
             fieldSubscriptionContext
-                    .subscribeField(eventContext.get(), subscriptionValueCallback, DBE_ALARM);
+                    .subscribeField(eventContext, subscriptionValueCallback, DBE_ALARM);
         } else {
             fieldSubscriptionContext
-                    .subscribeField(eventContext.get(), subscriptionValueCallback, DBE_VALUE | DBE_ALARM | DBE_ARCHIVE);
+                    .subscribeField(eventContext, subscriptionValueCallback, DBE_VALUE | DBE_ALARM | DBE_ARCHIVE);
         }
         // one for property changes
         if (field.info.type == MappingInfo::Meta || field.info.type == MappingInfo::Scalar) {
             // only scalar and meta mappings include property metadata (display, control, ...)
             fieldSubscriptionContext
-                    .subscribeField(eventContext.get(), subscriptionPropertiesCallback, DBE_PROPERTY, false);
+                    .subscribeField(eventContext, subscriptionPropertiesCallback, DBE_PROPERTY, false);
         } else {
             fieldSubscriptionContext.hadPropertyEvent = true;
         }
@@ -385,7 +459,7 @@ bool getGroupField(const Field& field, Value valueTarget, const std::string& gro
         IOCSource::initialize(valueTarget, field.info, field.value);
         LocalFieldLog localFieldLog(field.value);
         IOCSource::get(valueTarget, field.info, field.anyType,
-                       UpdateType::Everything, field.value, localFieldLog.pFieldLog);
+                       UpdateType::Everything, field.value, localFieldLog.pFieldLog, &field.arrays);
     } catch (std::exception& e) {
         std::stringstream errorString;
         errorString << "Error retrieving value for pvName: " << groupName << (field.name.empty() ? "/" : ".")
@@ -417,14 +491,9 @@ void GroupSource::get(Group& group, const std::unique_ptr<server::ExecOp>& getOp
     if (atomic) {
         // Lock all the fields
         DBManyLocker G(group.value.lock);
-        // Loop through all fields
-        for (auto& field: group.fields) {
-            if(field.info.type == MappingInfo::Proc || field.info.type==MappingInfo::Structure)
-                continue;
-            // find the leaf node in which to set the value
-            auto leafNode = field.findIn(returnValue);
-
-            if (!getGroupField(field, leafNode, group.name, getOperation)) {
+        // Read all fields, through names resolved when the group was created
+        for (auto pField: group.getPlan) {
+            if (!getGroupField(*pField, pField->findIn(returnValue), group.name, getOperation)) {
                 return;
             }
         }
@@ -435,17 +504,14 @@ void GroupSource::get(Group& group, const std::unique_ptr<server::ExecOp>& getOp
         // Otherwise, this is a non-atomic operation, and we need to `put` each field individually,
         // locking each of them independently of each other.
 
-        // Loop through all fields
-        for (auto& field: group.fields) {
-            dbChannel* pDbChannel = field.value;
-
-            // find the leaf node in which to set the value
-            auto leafNode = field.findIn(returnValue);
+        for (auto pField: group.getPlan) {
+            dbChannel* pDbChannel = pField->value;
+            auto leafNode = pField->findIn(returnValue);
 
             if (pDbChannel && leafNode) {
                 // Lock this field
                 DBLocker F(pDbChannel->addr.precord);
-                if (!getGroupField(field, leafNode, group.name, getOperation)) {
+                if (!getGroupField(*pField, leafNode, group.name, getOperation)) {
                     return;
                 }
             }
@@ -463,9 +529,10 @@ void GroupSource::get(Group& group, const std::unique_ptr<server::ExecOp>& getOp
  * @param putOperation the put operation object to use to interact with the client
  * @param value the value being posted
  * @param groupSecurityCache the object that caches the security context of client connections
+ * @param forceProcessing whether to force processing, True, False
  */
 void GroupSource::putGroup(Group& group, std::unique_ptr<server::ExecOp>& putOperation, const Value& value,
-        const GroupSecurityCache& groupSecurityCache) {
+        const GroupSecurityCache& groupSecurityCache, TriState forceProcessing) {
     try {
         CurrentOp op(putOperation.get());
 
@@ -503,7 +570,7 @@ void GroupSource::putGroup(Group& group, std::unique_ptr<server::ExecOp>& putOpe
                 // Put the field
                 putGroupField(value, field, groupSecurityCache.securityClients[fieldIndex]);
                 // Do processing if required
-                IOCSource::doPostProcessing(field.value, groupSecurityCache.forceProcessing);
+                IOCSource::doPostProcessing(field.value, forceProcessing);
                 fieldIndex++;
             }
 
@@ -523,7 +590,7 @@ void GroupSource::putGroup(Group& group, std::unique_ptr<server::ExecOp>& putOpe
                 // Put the field
                 putGroupField(value, field, groupSecurityCache.securityClients[fieldIndex]);
                 // Do processing if required
-                IOCSource::doPostProcessing(field.value, groupSecurityCache.forceProcessing);
+                IOCSource::doPostProcessing(field.value, forceProcessing);
                 // Unlock this field when locker goes out of scope
                 fieldIndex++;
             }
@@ -10,7 +10,7 @@
 #ifndef PVXS_GROUPSOURCE_H
 #define PVXS_GROUPSOURCE_H
 
-#include "dbeventcontextdeleter.h"
+#include "dbeventcontexts.h"
 #include "groupsrcsubscriptionctx.h"
 #include "iocsource.h"
 #include "securityclient.h"
@@ -39,13 +39,16 @@ public:
 private:
     // List of all database records that this single source serves
     List allRecords;
-    // The event context for all subscriptions
-    DBEventContext eventContext;
+    // Deferred posts of +coalesce groups, one for each of eventContexts.  Must out-live eventContexts
+    std::vector<std::unique_ptr<GroupPostQueue>> postQueues;
+    // The event contexts for all subscriptions.  All fields of one group subscription use the same context.
+    DBEventContexts eventContexts;
 
     IOCGroupConfig& config;
 
     // Handles all get, put and subscribe requests
-    static void onOp(Group& group, std::unique_ptr<server::ConnectOp>&& channelConnectOperation);
+    static void onOp(Group& group, const std::shared_ptr<ChannelSecurity<GroupSecurityCache>>& channelSecurity,
+            std::unique_ptr<server::ConnectOp>&& channelConnectOperation);
 
     //////////////////////////////
     // Get
@@ -56,7 +59,7 @@ private:
     // Put
     //////////////////////////////
     static void putGroup(Group& group, std::unique_ptr<server::ExecOp>& putOperation, const Value& value,
-            const GroupSecurityCache& groupSecurityCache);
+            const GroupSecurityCache& groupSecurityCache, TriState forceProcessing);
 
     //////////////////////////////
     // Subscriptions
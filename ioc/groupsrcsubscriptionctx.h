@@ -11,6 +11,7 @@
 #define PVXS_GROUPSRCSUBSCRIPTIONCTX_H
 
 #include <map>
+#include <memory>
 #include <vector>
 
 #include <pvxs/source.h>
@@ -24,9 +25,23 @@
 namespace pvxs {
 namespace ioc {
 
-class GroupSourceSubscriptionCtx {
+class GroupSourceSubscriptionCtx;
+
+/**
+ * Subscriptions of +coalesce groups which will post an update once the current batch of DB events
+ * has been delivered.  Only accessed from the event task of GroupSource.
+ */
+struct GroupPostQueue {
+    dbEventCtx eventContext = nullptr;
+    std::vector<std::weak_ptr<GroupSourceSubscriptionCtx>> pending;
+};
+
+class GroupSourceSubscriptionCtx : public std::enable_shared_from_this<GroupSourceSubscriptionCtx> {
 public:
     Group& group;
+    // for +coalesce.  Set in GroupSource::onSubscribe()
+    GroupPostQueue* postQueue = nullptr;
+    bool postPending = false;
     epicsMutex eventLock{};
     bool eventsPrimed = false, firstEvent = true;
     bool eventsEnabled = false;
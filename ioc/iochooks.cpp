@@ -76,6 +76,8 @@ void pvxsAtExit(void*) noexcept {
             // take ownership
             std::unique_ptr<server::Server> serverInstance(pPvxsServer);
             serverInstance->stop();
+            // finish queued operations before the groups they reference are destroyed
+            IOCOpWorkersCleanup();
             IOCGroupConfigCleanup();
             log_debug_printf(_logname, "Stopped Server%s", "\n");
         }
@@ -202,6 +204,17 @@ void pvxrefdiff() {
     }
 }
 
+void pvxcapture(int nbytes) {
+    wireCaptureSet(nbytes>0 ? size_t(nbytes) : 0u);
+}
+
+void pvxcapdump(const char* fname) {
+    if(!fname || !*fname)
+        throw std::runtime_error("Missing file name");
+    auto n = wireCaptureDump(fname);
+    printf("Wrote %zu messages to %s\n", n, fname);
+}
+
 } // namespace
 
 /**
@@ -302,6 +315,11 @@ void pvxsBaseRegistrar() {
                        "Save the current set of instance counters for reference by later pvxrefdiff.\n").implementation<&pvxrefsave>();
         IOCShCommand<>("pvxrefdiff",
                        "Show different of current instance counts with those when pvxrefsave was called.\n").implementation<&pvxrefdiff>();
+        IOCShCommand<int>("pvxcapture", "nbytes",
+                          "Capture recent PVA messages of TCP connections opened later, up to nbytes per connection.\n"
+                          "Zero disables.\n").implementation<&pvxcapture>();
+        IOCShCommand<const char*>("pvxcapdump", "filename",
+                                  "Write messages captured by pvxcapture to a pcap format file.\n").implementation<&pvxcapdump>();
 
         // Initialise the PVXS Server
         initialisePvxsServer();
@@ -12,12 +12,14 @@
 #include <atomic>
 
 #include <special.h>
+#include <recSup.h>
 #include <epicsTime.h>
 #include <epicsStdlib.h>
 #include <epicsString.h>
 
 #include "alarm.h"
 #include "iocsource.h"
+#include "publishedarray.h"
 #include "dbentry.h"
 #include "dberrormessage.h"
 #include "typeutils.h"
@@ -151,41 +153,96 @@ void getScalarValue(dbChannel* pChannel,
     }
 }
 
+// Upper bound on the number of elements dbChannelGet() will return.
+// Avoids allocating for the full NELM of an array which is mostly empty.
+static
+long currentElements(dbChannel* pChannel, db_field_log *pfl)
+{
+    long nMax = dbChannelFinalElements(pChannel);
+#ifdef dbfl_has_copy
+    if(pfl && dbfl_has_copy(pfl))
+        return std::min(nMax, pfl->no_elements);
+#endif
+    // dbChannelGet() will read from the record.  as dbGet(), ask how many elements are present.
+    auto paddr = &pChannel->addr;
+    auto prset = dbGetRset(paddr);
+    if(paddr->pfldDes->special==SPC_DBADDR && prset && prset->get_array_info) {
+        long nord = nMax, offset = 0;
+        typedef long (*get_array_info_t)(dbAddr *, long *, long *);
+        if(!reinterpret_cast<get_array_info_t>(prset->get_array_info)(paddr, &nord, &offset))
+            nMax = std::min(nMax, std::max(nord, 0l));
+    }
+    return nMax;
+}
+
+// Whether dbChannelGet() will read from the record, not a copy held by the field log
+static
+bool readsRecord(db_field_log *pfl)
+{
+#ifdef dbfl_has_copy
+    return !pfl || !dbfl_has_copy(pfl);
+#else
+    return !pfl || pfl->type==dbfl_type_rec;
+#endif
+}
+
 static
 void getArrayValue(dbChannel* pChannel,
                          db_field_log *pfl,
-                         Value& value)
+                         Value& value,
+                         const ArrayPool* arrays)
 {
     auto final_type(dbChannelFinalFieldType(pChannel));
-    auto buf(std::make_shared<std::vector<char>>(dbChannelFinalElements(pChannel) * dbChannelFinalFieldSize(pChannel)));
-    long nReq = dbChannelFinalElements(pChannel);
+    auto esize(dbChannelFinalFieldSize(pChannel));
+    long nReq = currentElements(pChannel, pfl);
+
+    if(final_type!=DBR_STRING && value.type()!=TypeCode::String
+            && final_type==dbChannelExportType(pChannel)
+            && !ellCount(&pChannel->filters)
+            && readsRecord(pfl))
+    {
+        // device support may have published the current array.  cf. publishArray()
+        auto arr(publishedArray(pChannel->addr));
+        if(!arr.empty()
+                && arr.data()==pChannel->addr.pfield // not stale.  updated by currentElements()
+                && arr.original_type()==value.type().arrayType()
+                && arr.size()<=size_t(nReq))
+        {
+            value.from(arr);
+            return;
+        }
+    }
+
+    size_t nbytes = size_t(nReq) * esize;
+    std::shared_ptr<char> buf;
+    if(arrays) {
+        buf = arrays->take(nbytes);
+    } else {
+        buf.reset(new char[nbytes ? nbytes : 1u], std::default_delete<char[]>()); // not zero'd
+    }
 
     DBErrorMessage dbErrorMessage(dbChannelGet(pChannel, final_type,
-                                               buf->data(), nullptr, &nReq, pfl));
+                                               buf.get(), nullptr, &nReq, pfl));
     if (dbErrorMessage) {
         throw std::runtime_error(SB()<<dbChannelName(pChannel)<<" "<<__func__<<" ERROR : "<<dbErrorMessage.c_str());
     }
 
-    if(final_type == DBR_CHAR && value.type()==TypeCode::String && !buf->empty()) {
+    if(final_type == DBR_CHAR && value.type()==TypeCode::String) {
         // long string
-        (*buf)[buf->size()-1u] = '\0'; // paranoia?
-        value = std::string(buf->data());
+        value = std::string(buf.get(), strnlen(buf.get(), size_t(nReq)));
 
     } else if(final_type == DBR_STRING) {
         shared_array<std::string> arr(nReq);
 
         for(long n = 0; n < nReq; n++) {
-            auto sval = &(*buf)[n*MAX_STRING_SIZE];
-            auto nlen = strnlen(sval, MAX_STRING_SIZE);
-            arr[n] = std::string(sval, nlen);
+            auto sval = buf.get() + n*MAX_STRING_SIZE;
+            arr[n].assign(sval, strnlen(sval, MAX_STRING_SIZE));
         }
 
         value.from(arr.freeze());
     } else {
-        std::shared_ptr<char> cbuf(buf, buf->data());
-        buf.reset(); // TODO: c++14 adds aliasing ctor by move()
-        shared_array<void> arr(cbuf, nReq, value.type().arrayType());
-        cbuf.reset();
+        shared_array<void> arr(buf, nReq, value.type().arrayType());
+        buf.reset();
 
         value.from(arr.freeze());
     }
@@ -351,7 +408,8 @@ void IOCSource::get(Value& node, // node within top level structure addressed by
                     const Value& anyType,
                     UpdateType::type change,
                     dbChannel *pChannel, // which type of event
-                    db_field_log* pDbFieldLog)
+                    db_field_log* pDbFieldLog,
+                    const ArrayPool* arrays)
 {
     if(info.type==MappingInfo::Proc || info.type==MappingInfo::Structure)
         return;
@@ -383,7 +441,7 @@ void IOCSource::get(Value& node, // node within top level structure addressed by
         if(dbChannelFinalElements(pChannel)==1) {
             getScalarValue(pChannel, pDbFieldLog, value);
         } else {
-            getArrayValue(pChannel, pDbFieldLog, value);
+            getArrayValue(pChannel, pDbFieldLog, value, arrays);
         }
     }
 }
@@ -14,6 +14,7 @@
 
 #include <dbAccess.h>
 
+#include "arraypool.h"
 #include "dbeventcontextdeleter.h"
 #include "fieldconfig.h"
 #include "singlesrcsubscriptionctx.h"
@@ -51,7 +52,8 @@ public:
                     const MappingInfo& info, const Value &anyType,
                     UpdateType::type change,
                     dbChannel *pChannel,
-                    db_field_log* pDbFieldLog);
+                    db_field_log* pDbFieldLog,
+                    const ArrayPool* arrays = nullptr);
     static void put(dbChannel* pDbChannel, const Value& value, const MappingInfo& info);
     static void doPostProcessing(dbChannel* pDbChannel, TriState forceProcessing);
     static void doPreProcessing(dbChannel* pDbChannel, SecurityLogger& securityLogger, const Credentials& credentials,
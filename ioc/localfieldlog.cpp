@@ -12,16 +12,13 @@
 namespace pvxs {
 namespace ioc {
 
-LocalFieldLog::LocalFieldLog(dbChannel* pDbChannel, db_field_log* existingFieldLog)
-        :pFieldLog(existingFieldLog) {
-    if (pDbChannel && !pFieldLog && (ellCount(&pDbChannel->pre_chain) != 0 || ellCount(&pDbChannel->post_chain) != 0)) {
-        pFieldLog = db_create_read_log(pDbChannel);
+void LocalFieldLog::runFilters(dbChannel* pDbChannel) {
+    pFieldLog = db_create_read_log(pDbChannel);
+    if (pFieldLog) {
+        pFieldLog = dbChannelRunPreChain(pDbChannel, pFieldLog);
         if (pFieldLog) {
-            pFieldLog = dbChannelRunPreChain(pDbChannel, pFieldLog);
-            if (pFieldLog) {
-                pFieldLog = dbChannelRunPostChain(pDbChannel, pFieldLog);
-                owned = true;
-            }
+            pFieldLog = dbChannelRunPostChain(pDbChannel, pFieldLog);
+            owned = true;
         }
     }
 }
@@ -15,17 +15,35 @@
 namespace pvxs {
 namespace ioc {
 
+/**
+ * The db_field_log to use when reading a channel outside of a DB event callback, eg. for a GET.
+ *
+ * A read log is only made when the channel has server side filters (eg. arr, dbnd), which are then run over it.
+ * Otherwise pFieldLog is the given existing log, if any, and nothing is allocated.
+ * Read logs come from a free list in Base, and can not be re-used as filters may keep or replace them.
+ */
 class LocalFieldLog {
 public:
     db_field_log* pFieldLog;
     bool owned = false;
-    explicit LocalFieldLog(dbChannel* pDbChannel, db_field_log* existingFieldLog = nullptr);
+    explicit LocalFieldLog(dbChannel* pDbChannel, db_field_log* existingFieldLog = nullptr)
+        :pFieldLog(existingFieldLog)
+    {
+        // inline test for the common case, a channel without filters
+        if (pDbChannel && !pFieldLog && (ellCount(&pDbChannel->pre_chain) != 0 || ellCount(&pDbChannel->post_chain) != 0)) {
+            runFilters(pDbChannel);
+        }
+    }
     ~LocalFieldLog() {
         if (owned) {
             db_delete_field_log(pFieldLog);
         }
     }
+    LocalFieldLog(const LocalFieldLog&) = delete;
+    LocalFieldLog& operator=(const LocalFieldLog&) = delete;
 
+private:
+    void runFilters(dbChannel* pDbChannel);
 };
 
 } // pvxs
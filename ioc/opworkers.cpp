@@ -0,0 +1,131 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <memory>
+#include <stdlib.h>
+#include <vector>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
+
+#include <pvxs/log.h>
+#include <pvxs/util.h>
+
+#include "opworkers.h"
+#include "utilpvt.h"
+
+namespace pvxs {
+namespace ioc {
+
+DEFINE_LOGGER(_logname, "pvxs.ioc.workers");
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+typedef MPMCFIFO<std::function<void()>> OpQueue;
+
+struct OpWorker final : public epicsThreadRunable {
+    OpQueue& queue;
+    epicsThread thread;
+
+    OpWorker(OpQueue& queue, const char* name)
+        :queue(queue)
+        ,thread(*this, name,
+                epicsThreadGetStackSize(epicsThreadStackBig),
+                epicsThreadPriorityCAServerLow)
+    {
+        thread.start();
+    }
+    virtual ~OpWorker() {}
+
+    virtual void run() override final {
+        // queue.push(nullptr) to stop
+        while(auto work = queue.pop()) {
+            try {
+                work();
+            } catch(std::exception& e) {
+                log_exc_printf(_logname, "Unhandled exception in QSRV worker: %s\n", e.what());
+            }
+        }
+    }
+};
+
+struct OpWorkers {
+    OpQueue queue;
+    std::vector<std::unique_ptr<OpWorker>> workers;
+
+    explicit OpWorkers(unsigned nworkers) {
+        workers.reserve(nworkers);
+        for(auto i : range(nworkers)) {
+            std::string name(SB()<<"qsrvWork"<<i);
+            workers.emplace_back(new OpWorker(queue, name.c_str()));
+        }
+        log_debug_printf(_logname, "Started %u QSRV workers\n", nworkers);
+    }
+    ~OpWorkers() {
+        // run any remaining work, then stop
+        for(auto i : range(workers.size())) {
+            (void)i;
+            queue.push(nullptr);
+        }
+        for(auto& worker : workers) {
+            worker->thread.exitWait();
+        }
+    }
+};
+
+epicsMutex* opWorkersLock;
+std::unique_ptr<OpWorkers> opWorkers; // guarded by opWorkersLock
+
+epicsThreadOnceId opWorkersOnce = EPICS_THREAD_ONCE_INIT;
+
+void opWorkersInit(void*)
+{
+    opWorkersLock = new epicsMutex();
+}
+
+unsigned numOpWorkers()
+{
+    unsigned nworkers = 4u;
+    if(auto env = getenv("PVXS_QSRV_WORKERS")) {
+        try {
+            auto temp = parseTo<uint64_t>(env);
+            if(temp < 1u || temp > 64u)
+                throw std::out_of_range("not in range [1, 64]");
+            nworkers = unsigned(temp);
+        } catch(std::exception& e) {
+            log_err_printf(_logname, "Ignoring invalid PVXS_QSRV_WORKERS=%s : %s\n", env, e.what());
+        }
+    }
+    return nworkers;
+}
+
+} // namespace
+
+void queueOpWork(std::function<void()>&& work)
+{
+    epicsThreadOnce(&opWorkersOnce, &opWorkersInit, nullptr);
+    Guard G(*opWorkersLock);
+    if(!opWorkers)
+        opWorkers.reset(new OpWorkers(numOpWorkers()));
+    opWorkers->queue.push(std::move(work));
+}
+
+void IOCOpWorkersCleanup()
+{
+    epicsThreadOnce(&opWorkersOnce, &opWorkersInit, nullptr);
+    std::unique_ptr<OpWorkers> trash;
+    {
+        Guard G(*opWorkersLock);
+        trash = std::move(opWorkers);
+    }
+    // joins workers, outside of lock
+}
+
+} // pvxs
+} // ioc
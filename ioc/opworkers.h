@@ -0,0 +1,30 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef PVXS_OPWORKERS_H
+#define PVXS_OPWORKERS_H
+
+#include <functional>
+
+namespace pvxs {
+namespace ioc {
+
+/**
+ * Queue work to be run by one of the QSRV worker threads.
+ *
+ * QSRV GET and PUT operations take database locks, and may wait for record processing.
+ * They are run by these workers so that a server TCP worker thread never blocks on the database.
+ * Completion is reported from the worker through server::ExecOp::reply() or server::ExecOp::error().
+ *
+ * Work is started in FIFO order, possibly concurrently with other work.
+ * Workers are started on first use.  The number of workers is taken from $PVXS_QSRV_WORKERS (default 4).
+ */
+void queueOpWork(std::function<void()>&& work);
+
+} // pvxs
+} // ioc
+
+#endif //PVXS_OPWORKERS_H
@@ -0,0 +1,95 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#include <dbAccess.h>
+#include <dbCommon.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
+
+#include <pvxs/iochooks.h>
+
+#include "publishedarray.h"
+#include "utilpvt.h"
+
+namespace pvxs {
+namespace ioc {
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+// keyed by record and field.  Both stable for the life of the IOC.
+typedef std::pair<const dbCommon*, const dbFldDes*> key_t;
+
+struct published_t {
+    epicsMutex lock;
+    std::map<key_t, shared_array<const void>> arrays; // guarded by lock
+} *published;
+
+// skip lookup, and locking, until the first publishArray()
+std::atomic<bool> anyPublished{false};
+
+epicsThreadOnceId published_once = EPICS_THREAD_ONCE_INIT;
+void published_init(void *unused)
+{
+    (void)unused;
+    published = new published_t;
+}
+} // namespace
+
+void publishArray(dbCommon* prec, const char* field, const shared_array<const void>& value)
+{
+    if(!prec || !field)
+        throw std::invalid_argument("publishArray() requires record and field");
+
+    DBADDR addr;
+    if(dbNameToAddr(SB()<<prec->name<<"."<<field, &addr))
+        throw std::invalid_argument(SB()<<"publishArray() no such field "<<prec->name<<"."<<field);
+    else if(addr.no_elements<=1)
+        throw std::invalid_argument(SB()<<"publishArray() not an array field "<<prec->name<<"."<<field);
+
+    epicsThreadOnce(&published_once, &published_init, nullptr);
+
+    key_t key(prec, addr.pfldDes);
+    // previous array, if any, released after unlock
+    shared_array<const void> prev;
+    {
+        Guard G(published->lock);
+        auto it(published->arrays.find(key));
+        if(it!=published->arrays.end()) {
+            prev = std::move(it->second);
+            if(value.empty())
+                published->arrays.erase(it);
+            else
+                it->second = value;
+
+        } else if(!value.empty()) {
+            published->arrays.emplace(key, value);
+        }
+    }
+    if(!value.empty())
+        anyPublished = true;
+}
+
+shared_array<const void> publishedArray(const dbAddr& addr)
+{
+    shared_array<const void> ret;
+    if(anyPublished) {
+        Guard G(published->lock);
+        auto it(published->arrays.find(key_t(addr.precord, addr.pfldDes)));
+        if(it!=published->arrays.end())
+            ret = it->second;
+    }
+    return ret;
+}
+
+} // pvxs
+} // ioc
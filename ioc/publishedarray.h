@@ -0,0 +1,26 @@
+/*
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef PVXS_PUBLISHEDARRAY_H
+#define PVXS_PUBLISHEDARRAY_H
+
+#include <pvxs/sharedArray.h>
+
+#include <dbAccess.h>
+
+namespace pvxs {
+namespace ioc {
+
+/* Lookup an array published through publishArray() for this field.
+ * Caller must hold the record lock.
+ * Returns an empty array if nothing published.
+ */
+shared_array<const void> publishedArray(const dbAddr& addr);
+
+} // pvxs
+} // ioc
+
+#endif //PVXS_PUBLISHEDARRAY_H
@@ -7,6 +7,7 @@
 #define PVXS_IOCHOOKS_H
 
 #include <pvxs/version.h>
+#include <pvxs/sharedArray.h>
 
 #if defined(_WIN32) || defined(__CYGWIN__)
 
@@ -26,6 +27,8 @@
 #  define PVXS_IOC_API
 #endif
 
+struct dbCommon;
+
 namespace pvxs {
 namespace server {
 class Server;
@@ -90,5 +93,36 @@ long dbLoadGroup(const char* jsonFilename, const char* macros=nullptr);
 PVXS_IOC_API
 void testShutdown();
 
+/** Publish a reference counted array as the current value of an array field,
+ *  for QSRV to pass to clients without copying.
+ *
+ *  Intended for device support which fills a new buffer for each update,
+ *  and points the record at it.  eg. a double buffered waveform which sets BPTR and NORD.
+ *  The array must not be modified once published.
+ *
+ *  QSRV uses the published array in place of dbChannelGet() only while the record
+ *  field still references the same buffer (eg. BPTR==value.data()), with the same element type,
+ *  and when no server side filter or type conversion applies.  Otherwise the field is copied as usual.
+ *
+ *  Call with the record locked.  eg. from process().
+ *  Publishing an empty array withdraws any previous array.
+ *
+ * @code
+ * // in device support read_wf()
+ * shared_array<double> next(nelm);
+ * // ... fill in next ...
+ * auto frozen(next.freeze().castTo<const void>());
+ * prec->bptr = const_cast<void*>(frozen.data());
+ * prec->nord = frozen.size();
+ * ioc::publishArray((dbCommon*)prec, "VAL", frozen);
+ * // previous buffer remains valid while any client still references it
+ * @endcode
+ *
+ *  @throws std::invalid_argument if field does not exist, or is not an array.
+ *  @since 1.3.0
+ */
+PVXS_IOC_API
+void publishArray(dbCommon* prec, const char* field, const shared_array<const void>& value);
+
 }} // namespace pvxs::ioc
 #endif // PVXS_IOCHOOKS_H
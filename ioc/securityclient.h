@@ -10,10 +10,13 @@
 #ifndef PVXS_SECURITYCLIENT_H
 #define PVXS_SECURITYCLIENT_H
 
+#include <memory>
 #include <vector>
 #include <asLib.h>
 #include <dbChannel.h>
 #include <dbNotify.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
 
 #include "credentials.h"
 #include "typeutils.h"
@@ -42,7 +45,7 @@ public:
 /**
  * group security cache - for storing group security credentials and clients
  */
-class GroupSecurityCache : public SecurityControlObject {
+class GroupSecurityCache {
 public:
 	std::vector<SecurityClient> securityClients;
 	std::unique_ptr<Credentials> credentials;
@@ -52,17 +55,42 @@ public:
 /**
  * sing security cache - for storing single a source security credential and client
  */
-class SingleSecurityCache : public SecurityControlObject {
+class SingleSecurityCache {
 public:
 	SecurityClient securityClient;
 	std::unique_ptr<Credentials> credentials;
 };
 
+/**
+ * The security cache of one server channel, shared by all put operations on that channel.
+ * Made by the first put.  A server channel belongs to one client connection, so its credentials do not change.
+ * asLib re-computes the access rights of existing clients when the ACF is reloaded,
+ * or when a record is moved to another ASG (asChangeGroup()), so a cache remains valid for the life of the channel.
+ */
+template<typename Cache>
+class ChannelSecurity {
+    epicsMutex lock;
+    std::shared_ptr<const Cache> cache; // guarded by lock
+public:
+    // build(Cache&) is called to fill in the cache on first use
+    template<typename Fn>
+    std::shared_ptr<const Cache> get(Fn&& build) {
+        epicsGuard<epicsMutex> G(lock);
+        if(!cache) {
+            auto temp(std::make_shared<Cache>());
+            build(*temp);
+            cache = std::move(temp);
+        }
+        return cache;
+    }
+};
+
 /**
  * The put operation cache for caching information about the current client put connection
- * Includes a single security cache as well as information pertaining to asynchronous put operations
+ * Includes the channel's security cache as well as information pertaining to asynchronous put operations
  */
-struct PutOperationCache : public SingleSecurityCache {
+struct PutOperationCache : public SecurityControlObject {
+	std::shared_ptr<const SingleSecurityCache> security;
 	bool doWait{ false };
 	processNotify notify{};
 	Value valueToSet;
@@ -33,6 +33,7 @@
 #include "securityclient.h"
 #include "typeutils.h"
 #include "localfieldlog.h"
+#include "opworkers.h"
 
 namespace pvxs {
 namespace ioc {
@@ -42,6 +43,8 @@ DEFINE_LOGGER(_logname, "pvxs.ioc.single.source");
 DEFINE_INST_COUNTER(PutOperationCache);
 DEFINE_INST_COUNTER(SingleInfo);
 
+typedef epicsGuard<epicsMutex> Guard;
+
 namespace {
 
 void subscriptionCallback(SingleSourceSubscriptionCtx* subscriptionContext,
@@ -49,21 +52,28 @@ void subscriptionCallback(SingleSourceSubscriptionCtx* subscriptionContext,
                           dbChannel* pChannel,
                           struct db_field_log* pDbFieldLog) {
     try {
+        Guard G(subscriptionContext->eventLock);
+
         // Get the current value of this subscription
         // We simply merge new field changes onto this value as events occur
-        auto currentValue = subscriptionContext->currentValue;
+        auto& currentValue = subscriptionContext->currentValue;
 
         {
             DBLocker F(dbChannelRecord(subscriptionContext->info->chan));
             // TODO MappingInfo::nsecMask
-            IOCSource::get(currentValue, MappingInfo(), Value(), change, pChannel, pDbFieldLog);
+            IOCSource::get(currentValue, MappingInfo(), Value(), change, pChannel, pDbFieldLog,
+                           &subscriptionContext->info->arrays);
         }
 
         // Make sure that the initial subscription update has occurred on both channels before continuing
         // As we make two initial updates when opening a new subscription, we need both to have completed before continuing
         if (subscriptionContext->hadValueEvent && subscriptionContext->hadPropertyEvent) {
-            // Return value
-            subscriptionContext->subscriptionControl->post(currentValue.clone());
+            // One update, shared by all subscribers
+            auto update(currentValue.clone());
+            subscriptionContext->complete.assign(update);
+            for (auto& subscriptionControl: subscriptionContext->running) {
+                subscriptionControl->post(update);
+            }
             currentValue.unmark();
         }
     } catch(std::exception& e) {
@@ -93,76 +103,60 @@ void subscriptionPropertiesCallback(void* userArg, struct dbChannel* pChannel, i
 
 /**
  * Called by the framework when a client subscribes to a channel.  We intercept the call before this function is called
- * to add a new subscription context with a value prototype matching the channel definition.
+ * to find, or create, the subscription context shared by all subscriptions to this channel.
  *
- * @param subscriptionContext a new subscription context with a value prototype matching the channel
+ * @param subscriptionContext the shared subscription context, with a value prototype matching the channel
  * @param subscriptionOperation the channel subscription operation
  */
 void onSubscribe(const std::shared_ptr<SingleSourceSubscriptionCtx>& subscriptionContext,
-                 const DBEventContext& eventContext,
                  std::unique_ptr<server::MonitorSetupOp>&& subscriptionOperation)
 {
     // inform peer of data type and acquire control of the subscription queue
-    subscriptionContext->subscriptionControl = subscriptionOperation->connect(subscriptionContext->currentValue);
-
-    IOCSource::initialize(subscriptionContext->currentValue,
-                          *subscriptionContext->info,
-                          subscriptionContext->info->chan);
-
-    // Two subscription are made for pvxs
-    // first subscription is for Value changes
-    subscriptionContext->pValueEventSubscription.subscribe(eventContext.get(),
-                                                           subscriptionContext->info->chan,
-                                                           subscriptionValueCallback,
-                                                           subscriptionContext.get(),
-                                                           DBE_VALUE | DBE_ALARM | DBE_ARCHIVE
-                                                           );
-    // second subscription is for Property changes
-    subscriptionContext->pPropertiesEventSubscription.subscribe(eventContext.get(),
-                                                                subscriptionContext->pPropertiesChannel,
-                                                                subscriptionPropertiesCallback,
-                                                                subscriptionContext.get(),
-                                                                DBE_PROPERTY
-                                                                );
+    // Updates are posted with this same type, so that they may be shared by all subscribers
+    std::shared_ptr<server::MonitorControlOp> subscriptionControl(
+            subscriptionOperation->connect(subscriptionContext->currentValue));
 
     // If all goes well, Set up handlers for start and stop monitoring events
     // The subscription context is being kept alive because it is being bound into some internal storage by onStart
-    subscriptionContext->subscriptionControl->onStart([subscriptionContext](bool isStarting) {
-        if (isStarting) {
+    subscriptionControl->onStart([subscriptionContext, subscriptionControl](bool isStarting) {
+        Guard S(subscriptionContext->startLock);
+        bool changed = false;
+        {
+            Guard G(subscriptionContext->eventLock);
+            auto& running = subscriptionContext->running;
+            auto it = std::find(running.begin(), running.end(), subscriptionControl);
+
+            if (isStarting && it == running.end()) {
+                changed = running.empty();
+                running.push_back(subscriptionControl);
+                if (changed) {
+                    // (re)enabling DB events will post both initial updates again
+                    subscriptionContext->hadValueEvent = false;
+                    subscriptionContext->hadPropertyEvent = false;
+
+                } else if (subscriptionContext->hadValueEvent && subscriptionContext->hadPropertyEvent) {
+                    // DB events are already flowing.  Start with the latest complete value
+                    subscriptionControl->post(subscriptionContext->complete.clone());
+                }
+
+            } else if (!isStarting && it != running.end()) {
+                running.erase(it);
+                changed = running.empty();
+            }
+        }
+
+        // first subscriber started, or last subscriber stopped
+        if (changed && isStarting) {
             subscriptionContext->eventsEnabled = true;
             subscriptionContext->pValueEventSubscription.enable();
             subscriptionContext->pPropertiesEventSubscription.enable();
-        } else {
+        } else if (changed) {
             subscriptionContext->pValueEventSubscription.disable();
             subscriptionContext->pPropertiesEventSubscription.disable();
             subscriptionContext->eventsEnabled = false;
         }
     });
 }
-/**
- * Create a Value Prototype for storing values returned by the given channel.
- *
- * @param dbChannelSharedPtr pointer to the channel
- * @return a value prototype for the given channel
- */
-Value getValuePrototype(const std::shared_ptr<SingleInfo>& sinfo) {
-    auto& chan(sinfo->chan);
-    short dbrType(dbChannelFinalFieldType(chan));
-    auto valueType(IOCSource::getChannelValueType(chan));
-
-    Value valuePrototype;
-    // To control optional metadata set to true to include in the output
-    bool display = true;
-    bool control = true;
-    bool valueAlarm = true;
-
-    if (dbrType == DBR_ENUM) {
-        valuePrototype = nt::NTEnum{}.create();
-    } else {
-        valuePrototype = nt::NTScalar{ valueType, display, control, valueAlarm, true }.create();
-    }
-    return valuePrototype;
-}
 
 /**
  * Callback for asynchronous put operations to handle the actual put value operation
@@ -233,10 +227,12 @@ void doneCallback(struct processNotify* notify) {
  * @param pDbChannel the channel that the request comes in on
  * @param getOperation the current executing operation
  * @param valuePrototype a value prototype that is made based on the expected type to be returned
+ * @param change which meta-data to read.  Properties only if selected by the client pvRequest
  */
 void singleGet(const SingleInfo& info,
                std::unique_ptr<server::ExecOp>& getOperation,
-               const Value& valuePrototype) {
+               const Value& valuePrototype,
+               UpdateType::type change) {
     auto& pDbChannel(info.chan);
     try {
         auto returnValue = valuePrototype.cloneEmpty();
@@ -246,8 +242,8 @@ void singleGet(const SingleInfo& info,
             DBLocker F(pDbChannel->addr.precord); // lock
             LocalFieldLog localFieldLog(pDbChannel);
             IOCSource::get(returnValue, info,
-                           Value(), UpdateType::Everything,
-                           pDbChannel, localFieldLog.pFieldLog);
+                           Value(), change,
+                           pDbChannel, localFieldLog.pFieldLog, &info.arrays);
         }
         getOperation->reply(returnValue);
     } catch (const std::exception& getException) {
@@ -255,6 +251,77 @@ void singleGet(const SingleInfo& info,
     }
 }
 
+/**
+ * Handle a put operation, on a QSRV worker thread
+ *
+ * @param info the channel that the request comes in on
+ * @param channelSecurity the security cache shared by all put operations on this channel
+ * @param putOperationCache the security and processing options cached for this client's put operation
+ * @param putOperation the current executing operation
+ * @param value the value to put
+ */
+void singlePut(const SingleInfo& info,
+               ChannelSecurity<SingleSecurityCache>& channelSecurity,
+               const std::shared_ptr<PutOperationCache>& putOperationCache,
+               std::unique_ptr<server::ExecOp>& putOperation,
+               const Value& value) {
+    try {
+        dbChannel* pDbChannel = info.chan;
+        if (!putOperationCache->done) {
+            putOperationCache->security = channelSecurity.get([&](SingleSecurityCache& security) {
+                security.credentials.reset(new Credentials(*putOperation->credentials()));
+                security.securityClient.update(pDbChannel, *security.credentials);
+            });
+            putOperationCache->notify.usrPvt = putOperationCache.get();
+            putOperationCache->notify.chan = pDbChannel;
+            putOperationCache->notify.putCallback = putCallback;
+            putOperationCache->notify.doneCallback = doneCallback;
+
+            auto& pvRequest = putOperation->pvRequest();
+            pvRequest["record._options.block"].as<bool>(putOperationCache->doWait);
+            IOCSource::setForceProcessingFlag(pvRequest, putOperationCache);
+            if (putOperationCache->forceProcessing) {
+                putOperationCache->doWait = false; // no point in waiting
+            }
+            putOperationCache->done = true;
+        }
+
+        SecurityLogger securityLogger;
+
+        IOCSource::doPreProcessing(pDbChannel,
+                securityLogger,
+                *putOperationCache->security->credentials,
+                putOperationCache->security->securityClient); // pre-process
+        IOCSource::doFieldPreProcessing(putOperationCache->security->securityClient); // pre-process field
+        if (putOperationCache->doWait) {
+            putOperationCache->valueToSet = value;
+            // TODO prevent concurrent put with callbacks (notifyBusy)
+
+            putOperationCache->notify.requestType = value["value"].isMarked() ? putProcessRequest
+                                                                              : processRequest;
+            putOperationCache->putOperation = std::move(putOperation);
+            dbProcessNotify(&putOperationCache->notify);
+            return;
+        }
+
+        CurrentOp op(putOperation.get());
+
+        if (dbChannelFieldType(pDbChannel) >= DBF_INLINK
+                && dbChannelFieldType(pDbChannel) <= DBF_FWDLINK) {
+            // Locking is handled by dbPutField() called as a special case in IOCSource::put() for links
+            IOCSource::put(pDbChannel, value, MappingInfo()); // put
+        } else {
+            // All other field types call dbChannelPut() directly, so we have to perform locking here
+            DBLocker F(pDbChannel->addr.precord); // lock
+            IOCSource::put(pDbChannel, value, MappingInfo()); // put
+            IOCSource::doPostProcessing(pDbChannel, putOperationCache->forceProcessing); // post-process
+        }
+        putOperation->reply();
+    } catch (std::exception& e) {
+        putOperation->error(e.what());
+    }
+}
+
 /**
  * Handler for the onOp event raised by pvxs Sources when they are started, in order to define the get and put handlers
  * on a per source basis.
@@ -262,82 +329,54 @@ void singleGet(const SingleInfo& info,
  *
  * @param dbChannelSharedPtr the channel to which the get/put operation pertains
  * @param valuePrototype the value prototype that is appropriate for the given channel
+ * @param channelSecurity the security cache shared by all put operations on this channel
  * @param channelConnectOperation the channel connect operation object
  */
 void onOp(const std::shared_ptr<SingleInfo>& sInfo, const Value& valuePrototype,
+        const std::shared_ptr<ChannelSecurity<SingleSecurityCache>>& channelSecurity,
         std::unique_ptr<server::ConnectOp>&& channelConnectOperation) {
     // Announce the channel type with a `connect()` call.  This happens only once
     channelConnectOperation->connect(valuePrototype);
 
+    // Skip reading display, control, alarm limit, and enum choices meta-data when the client has not asked for them.
+    // eg. with pvRequest "field(value)"
+    auto getChange = UpdateType::type(UpdateType::Value | UpdateType::Alarm);
+    {
+        auto selected(channelConnectOperation->selected(valuePrototype));
+        for(auto name : {"display", "control", "valueAlarm", "value.choices"}) {
+            if(selected[name].isMarked(true, true)) {
+                getChange = UpdateType::Everything;
+                break;
+            }
+        }
+    }
+
     // Set up handler for get requests
     channelConnectOperation
-            ->onGet([sInfo, valuePrototype](std::unique_ptr<server::ExecOp>&& getOperation) {
-                singleGet(*sInfo, getOperation, valuePrototype);
+            ->onGet([sInfo, valuePrototype, getChange](std::unique_ptr<server::ExecOp>&& getOperation) {
+                // Locking is done by a QSRV worker, not the server TCP worker
+                auto op(std::make_shared<std::unique_ptr<server::ExecOp>>(std::move(getOperation)));
+                queueOpWork([sInfo, valuePrototype, getChange, op]() {
+                    singleGet(*sInfo, *op, valuePrototype, getChange);
+                });
             });
 
-    // Make a security cache for this client's connection to this pv
-    // Each time the same client calls put we will re-use the cached security client
-    // The security cache will be deleted when the client disconnects from this pv
+    // Processing options of this put operation.
+    // The security client is cached by the channel, and re-used by every put operation on it,
+    // until the client disconnects from this pv
     auto putOperationCache = std::make_shared<PutOperationCache>();
 
     // Set up handler for put requests
     channelConnectOperation
-            ->onPut([sInfo, putOperationCache](
+            ->onPut([sInfo, channelSecurity, putOperationCache](
                     std::unique_ptr<server::ExecOp>&& putOperation,
                     Value&& value) {
-                try {
-                    dbChannel* pDbChannel = sInfo->chan;
-                    if (!putOperationCache->done) {
-                        putOperationCache->credentials.reset(new Credentials(*putOperation->credentials()));
-                        putOperationCache->securityClient.update(pDbChannel, *putOperationCache->credentials);
-                        putOperationCache->notify.usrPvt = putOperationCache.get();
-                        putOperationCache->notify.chan = pDbChannel;
-                        putOperationCache->notify.putCallback = putCallback;
-                        putOperationCache->notify.doneCallback = doneCallback;
-
-                        auto& pvRequest = putOperation->pvRequest();
-                        pvRequest["record._options.block"].as<bool>(putOperationCache->doWait);
-                        IOCSource::setForceProcessingFlag(pvRequest, putOperationCache);
-                        if (putOperationCache->forceProcessing) {
-                            putOperationCache->doWait = false; // no point in waiting
-                        }
-                        putOperationCache->done = true;
-                    }
-
-                    SecurityLogger securityLogger;
-
-                    IOCSource::doPreProcessing(pDbChannel,
-                            securityLogger,
-                            *putOperationCache->credentials,
-                            putOperationCache->securityClient); // pre-process
-                    IOCSource::doFieldPreProcessing(putOperationCache->securityClient); // pre-process field
-                    if (putOperationCache->doWait) {
-                        putOperationCache->valueToSet = value;
-                        // TODO prevent concurrent put with callbacks (notifyBusy)
-
-                        putOperationCache->notify.requestType = value["value"].isMarked() ? putProcessRequest
-                                                                                          : processRequest;
-                        putOperationCache->putOperation = std::move(putOperation);
-                        dbProcessNotify(&putOperationCache->notify);
-                        return;
-                    }
-
-                    CurrentOp op(putOperation.get());
-
-                    if (dbChannelFieldType(pDbChannel) >= DBF_INLINK
-                            && dbChannelFieldType(pDbChannel) <= DBF_FWDLINK) {
-                        // Locking is handled by dbPutField() called as a special case in IOCSource::put() for links
-                        IOCSource::put(pDbChannel, value, MappingInfo()); // put
-                    } else {
-                        // All other field types call dbChannelPut() directly, so we have to perform locking here
-                        DBLocker F(pDbChannel->addr.precord); // lock
-                        IOCSource::put(pDbChannel, value, MappingInfo()); // put
-                        IOCSource::doPostProcessing(pDbChannel, putOperationCache->forceProcessing); // post-process
-                    }
-                    putOperation->reply();
-                } catch (std::exception& e) {
-                    putOperation->error(e.what());
-                }
+                // Locking and processing are done by a QSRV worker, not the server TCP worker
+                auto op(std::make_shared<std::unique_ptr<server::ExecOp>>(std::move(putOperation)));
+                Value toPut(std::move(value));
+                queueOpWork([sInfo, channelSecurity, putOperationCache, op, toPut]() {
+                    singlePut(*sInfo, *channelSecurity, putOperationCache, *op, toPut);
+                });
             });
 }
 
@@ -347,7 +386,6 @@ void onOp(const std::shared_ptr<SingleInfo>& sInfo, const Value& valuePrototype,
  * Constructor for SingleSource registrar.
  */
 SingleSource::SingleSource()
-        :eventContext(db_init_events()) // Initialise event context
 {
     auto names(std::make_shared<std::set<std::string >>());
 
@@ -361,14 +399,8 @@ SingleSource::SingleSource()
 
     allRecords.names = names;
 
-    // Start event pump
-    if (!eventContext) {
-        throw std::runtime_error("Single Source: Event Context failed to initialise: db_init_events()");
-    }
-
-    if (db_start_events(eventContext.get(), "qsrvSingle", nullptr, nullptr, epicsThreadPriorityCAServerLow - 1)) {
-        throw std::runtime_error("Could not start event thread: db_start_events()");
-    }
+    // Start event pumps
+    eventContexts.start("qsrvSingle");
 }
 
 /**
@@ -390,28 +422,112 @@ void SingleSource::onCreate(std::unique_ptr<server::ChannelControl>&& channelCon
     log_debug_printf(_logname, "Accepting channel for '%s'\n", sourceName);
 
     auto sInfo(std::make_shared<SingleInfo>(std::move(pDbChannel)));
+    auto channelSecurity(std::make_shared<ChannelSecurity<SingleSecurityCache>>());
 
-    // Create callbacks for handling requests and channel subscriptions
-    Value valuePrototype = getValuePrototype(sInfo);
+    // Create callbacks for handling requests and channel subscriptions.
+    // The value prototype is only found when a client first starts an operation.
+    // binding 'this' safe as Server shutdown will close connections before dropping Source
 
     // Get and Put requests
     channelControl
-            ->onOp([sInfo, valuePrototype](std::unique_ptr<server::ConnectOp>&& channelConnectOperation) {
-                onOp(sInfo, valuePrototype, std::move(channelConnectOperation));
+            ->onOp([this, sInfo, channelSecurity](std::unique_ptr<server::ConnectOp>&& channelConnectOperation) {
+                onOp(sInfo, valuePrototype(*sInfo), channelSecurity, std::move(channelConnectOperation));
             });
 
-    // binding 'this' safe as Server shutdown will close connections before dropping Source
     channelControl
-            ->onSubscribe([this, valuePrototype, sInfo](
+            ->onSubscribe([this, sInfo](
                     std::unique_ptr<server::MonitorSetupOp>&& subscriptionOperation) {
                 // The subscription must be kept alive
                 // We accomplish this further on during the binding of the onStart()
-                auto subscriptionContext(std::make_shared<SingleSourceSubscriptionCtx>(sInfo));
-                subscriptionContext->currentValue = valuePrototype.cloneEmpty();
-                onSubscribe(subscriptionContext, eventContext, std::move(subscriptionOperation));
+                onSubscribe(sharedSubscription(sInfo), std::move(subscriptionOperation));
             });
 }
 
+/**
+ * Find the value prototype for storing values returned by the given channel.
+ * Prototypes depend only on the value type, so one is shared by all channels with the same type.
+ *
+ * @param info the channel
+ * @return a value prototype for the given channel
+ */
+Value SingleSource::valuePrototype(const SingleInfo& info) {
+    auto& chan(info.chan);
+    bool isEnum = dbChannelFinalFieldType(chan) == DBR_ENUM;
+    auto valueType(IOCSource::getChannelValueType(chan));
+
+    Guard G(prototypesLock);
+    auto& prototype = prototypes[std::make_pair(isEnum, valueType.code)];
+    if (!prototype) {
+        // To control optional metadata set to true to include in the output
+        bool display = true;
+        bool control = true;
+        bool valueAlarm = true;
+
+        if (isEnum) {
+            prototype = nt::NTEnum{}.create();
+        } else {
+            prototype = nt::NTScalar{ valueType, display, control, valueAlarm, true }.create();
+        }
+    }
+    return prototype;
+}
+
+/**
+ * Find the subscription context shared by all subscriptions to the channel of the given SingleInfo,
+ * or create and subscribe a new one.  Channel names, including any server side filters, must match exactly.
+ *
+ * @param sInfo the channel being subscribed
+ * @return the shared subscription context
+ */
+std::shared_ptr<SingleSourceSubscriptionCtx>
+SingleSource::sharedSubscription(const std::shared_ptr<SingleInfo>& sInfo) {
+    std::string name(dbChannelName(sInfo->chan));
+
+    Guard G(subscriptionsLock);
+    auto& slot = subscriptions[name];
+    auto subscriptionContext(slot.lock());
+    if (!subscriptionContext) {
+        // forget this name when the last subscription is released
+        subscriptionContext.reset(new SingleSourceSubscriptionCtx(sInfo),
+                                  [this, name](SingleSourceSubscriptionCtx* ctx) {
+            {
+                Guard G(subscriptionsLock);
+                auto it(subscriptions.find(name));
+                if (it != subscriptions.end() && it->second.expired())
+                    subscriptions.erase(it);
+            }
+            delete ctx;
+        });
+        auto prototype(valuePrototype(*sInfo));
+        subscriptionContext->currentValue = prototype.cloneEmpty();
+        subscriptionContext->complete = prototype.cloneEmpty();
+
+        IOCSource::initialize(subscriptionContext->currentValue,
+                              *subscriptionContext->info,
+                              subscriptionContext->info->chan);
+
+        auto eventContext(eventContexts[eventContexts.indexOf(subscriptionContext->info->chan)]);
+
+        // Two subscription are made for pvxs
+        // first subscription is for Value changes
+        subscriptionContext->pValueEventSubscription.subscribe(eventContext,
+                                                               subscriptionContext->info->chan,
+                                                               subscriptionValueCallback,
+                                                               subscriptionContext.get(),
+                                                               DBE_VALUE | DBE_ALARM | DBE_ARCHIVE
+                                                               );
+        // second subscription is for Property changes
+        subscriptionContext->pPropertiesEventSubscription.subscribe(eventContext,
+                                                                    subscriptionContext->pPropertiesChannel,
+                                                                    subscriptionPropertiesCallback,
+                                                                    subscriptionContext.get(),
+                                                                    DBE_PROPERTY
+                                                                    );
+        slot = subscriptionContext;
+    }
+    return subscriptionContext;
+}
+
 /**
  * Respond to search requests.  For each matching pv, claim that pv
  *
@@ -10,10 +10,15 @@
 #ifndef PVXS_SINGLESOURCE_H
 #define PVXS_SINGLESOURCE_H
 
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
 #include <dbNotify.h>
 #include <dbEvent.h>
 
-#include "dbeventcontextdeleter.h"
+#include "dbeventcontexts.h"
 #include "iocsource.h"
 #include "singlesrcsubscriptionctx.h"
 
@@ -39,8 +44,20 @@ public:
 private:
     // List of all database records that this single source serves
     List allRecords;
-    // The event context for all subscriptions
-    DBEventContext eventContext;
+    // The event contexts for all subscriptions, by record lockset
+    DBEventContexts eventContexts;
+    // guards subscriptions
+    epicsMutex subscriptionsLock;
+    // subscription contexts by channel name, shared by all subscriptions to that name
+    std::map<std::string, std::weak_ptr<SingleSourceSubscriptionCtx>> subscriptions;
+
+    // guards prototypes
+    epicsMutex prototypesLock;
+    // value prototypes by (is enum, value type), shared by all channels of that type
+    std::map<std::pair<bool, TypeCode::code_t>, Value> prototypes;
+
+    Value valuePrototype(const SingleInfo& info);
+    std::shared_ptr<SingleSourceSubscriptionCtx> sharedSubscription(const std::shared_ptr<SingleInfo>& sInfo);
 };
 
 } // ioc
@@ -87,14 +87,15 @@ void qReport(unsigned level) noexcept {
 void qStats(unsigned *channels, unsigned *clients) noexcept {
     try{
         if (auto pPvxsServer = pvxsServer.load()) {
-            auto report(pPvxsServer->report(false));
+            // counts only.  Skip visiting every channel
+            auto report(pPvxsServer->report(false, false));
             if(clients) {
                 *clients = report.connections.size();
             }
             if(channels) {
                 size_t nchan = 0u;
                 for(auto& conn : report.connections) {
-                    nchan += conn.channels.size();
+                    nchan += conn.nChannels;
                 }
                 *channels = nchan;
             }
@@ -10,8 +10,13 @@
 #ifndef PVXS_SINGLESRCSUBSCRIPTIONCTX_H
 #define PVXS_SINGLESRCSUBSCRIPTIONCTX_H
 
+#include <vector>
+
+#include <epicsMutex.h>
+
 #include <pvxs/source.h>
 
+#include "arraypool.h"
 #include "channel.h"
 #include "fieldconfig.h"
 #include "subscriptionctx.h"
@@ -22,6 +27,8 @@ namespace ioc {
 
 struct SingleInfo : public MappingInfo {
     Channel chan;
+    // buffers for array values, shared by gets and subscriptions
+    ArrayPool arrays;
     INST_COUNTER(SingleInfo);
 
     explicit SingleInfo(Channel&& chan) :chan(std::move(chan)) {
@@ -30,7 +37,8 @@ struct SingleInfo : public MappingInfo {
 };
 
 /**
- * A subscription context
+ * A subscription context.  Shared by all client subscriptions to the same channel name,
+ * so that each DB event is read once, and the resulting update is posted to every running subscriber.
  */
 class SingleSourceSubscriptionCtx : public SubscriptionCtx {
 
@@ -43,9 +51,15 @@ public:
     // This is used to store the current value.  Each subscription event simply merges
     // new fields into this value
     Value currentValue{};
+    // All fields ever posted, and never unmarked.  Initial update for subscribers which start later.
+    Value complete{};
     std::shared_ptr<SingleInfo> info;
+    // guards currentValue, complete, and running
     epicsMutex eventLock{};
-    std::unique_ptr<server::MonitorControlOp> subscriptionControl{};
+    // serializes enabling and disabling of DB events
+    epicsMutex startLock{};
+    // started client subscriptions
+    std::vector<std::shared_ptr<server::MonitorControlOp>> running;
     bool eventsEnabled = false;
     INST_COUNTER(SingleSourceSubscriptionCtx);
 
@@ -14,17 +14,25 @@ namespace pvxs {
 
 
 BitMask::BitMask(BitMask&& o) noexcept
-    :_words(std::move(o._words))
+    :_remote(std::move(o._remote))
     ,_size(o._size)
+    ,_nwords(o._nwords)
 {
-    o._size = 0u;
+    std::copy_n(o._local, nLocal, _local);
+    std::fill_n(o._local, nLocal, 0u);
+    o._size = o._nwords = 0u;
 }
 
 BitMask& BitMask::operator=(BitMask&& o) noexcept
 {
-    _words = std::move(o._words);
-    _size = o._size;
-    o._size = 0u;
+    if(this!=&o) {
+        _remote = std::move(o._remote);
+        std::copy_n(o._local, nLocal, _local);
+        std::fill_n(o._local, nLocal, 0u);
+        _size = o._size;
+        _nwords = o._nwords;
+        o._size = o._nwords = 0u;
+    }
     return *this;
 }
 
@@ -43,48 +51,72 @@ BitMask::BitMask(std::initializer_list<size_t> bits, size_t nbits)
 
 void BitMask::resize(size_t bits) {
     // round up to multiple of 64
-    size_t storebits = ((bits-1u)|0x3f)+1u;
-    _words.resize(storebits/64u, 0u);
+    size_t nwords = (bits+63u)/64u;
+
+    if(nwords <= nLocal) {
+        if(_remote) {
+            std::copy_n(_remote.get(), nwords, _local);
+            _remote.reset();
+        }
+        std::fill(_local+nwords, _local+nLocal, 0u);
+
+    } else if(nwords!=_nwords) {
+        std::unique_ptr<uint64_t[]> store(new uint64_t[nwords]()); // zeroed
+        std::copy_n(_words(), std::min(nwords, size_t(_nwords)), store.get());
+        _remote = std::move(store);
+    }
+
+    _nwords = uint16_t(nwords);
     _size = uint16_t(bits);
 }
 
-size_t BitMask::findSet(size_t start) const
+namespace {
+// index of lowest set bit.  masked must be non-zero
+inline
+unsigned ctz64(uint64_t masked)
 {
-    while(start < _size) {
-        size_t word = start/64u,
-                bit = start%64u;
-
-        // first see if we can skip to next word
-        uint64_t mask = ~((1ull<<bit)-1); // mask of bit and higher
-        uint64_t masked = _words[word]&mask;
-        if(masked==0u) {
-            start = (word+1u)*64u;
-            continue;
-        }
-
-        // the answer is in range [bit, 64)
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctzll(masked));
+#else
+    // count consecutive "trailing" zeros.
+    // http://graphics.stanford.edu/~seander/bithacks.html#ZerosOnRightParallel
+
+    masked &= -masked; // and with two's complement.  neat.  clears all except the bit we care about
+
+    // now a binary search
+    // we know masked is non-zero, and can start from 63
+    unsigned bit = 63u;
+    if(masked&0x00000000ffffffffull) bit -= 32u;
+    if(masked&0x0000ffff0000ffffull) bit -= 16u;
+    if(masked&0x00ff00ff00ff00ffull) bit -= 8u;
+    if(masked&0x0f0f0f0f0f0f0f0full) bit -= 4u;
+    if(masked&0x3333333333333333ull) bit -= 2u; // 0xb0011 repeated
+    if(masked&0x5555555555555555ull) bit -= 1u; // 0xb0101 repeated
+    return bit;
+#endif
+}
+} // namespace
 
-        // count consecutive "trailing" zeros.
-        // http://graphics.stanford.edu/~seander/bithacks.html#ZerosOnRightParallel
+size_t BitMask::findSet(size_t start) const
+{
+    if(start >= _size)
+        return _size;
 
-        masked &= -masked; // and with two's complement.  neat.  clears all except the bit we care about
+    auto words = _words();
+    size_t word = start/64u;
 
-        // now a binary search
-        // we know masked is non-zero, and can start from 63
-        //bit = 64u;
-        //if(masked) bit--;
-        bit = 63u;
-        if(masked&0x00000000ffffffffull) bit -= 32u;
-        if(masked&0x0000ffff0000ffffull) bit -= 16u;
-        if(masked&0x00ff00ff00ff00ffull) bit -= 8u;
-        if(masked&0x0f0f0f0f0f0f0f0full) bit -= 4u;
-        if(masked&0x3333333333333333ull) bit -= 2u; // 0xb0011 repeated
-        if(masked&0x5555555555555555ull) bit -= 1u; // 0xb0101 repeated
+    // mask of start bit and higher in the first word
+    uint64_t masked = words[word] & (~uint64_t(0u) << (start%64u));
 
-        return (word*64u) | bit;
+    // skip whole words of zeros
+    while(!masked) {
+        if(++word >= _nwords)
+            return _size;
+        masked = words[word];
     }
 
-    return _size;
+    // bits beyond _size may be set by a whole word operation
+    return std::min(size_t(_size), word*64u + ctz64(masked));
 }
 
 std::ostream& operator<<(std::ostream& strm, const BitMask& mask)
@@ -105,9 +137,9 @@ bool operator==(const BitMask& lhs, const BitMask& rhs)
     if(lhs.size()!=rhs.size())
         return false;
 
-    return std::equal(lhs._words.begin(),
-                      lhs._words.end(),
-                      rhs._words.begin());
+    return std::equal(lhs._words(),
+                      lhs._words()+lhs._nwords,
+                      rhs._words());
 }
 
 namespace impl {
@@ -10,6 +10,7 @@
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <cstdint>
 
 #include <pvxs/version.h>
@@ -92,10 +93,19 @@ class BitMask : public detail::BitBase<BitMask> {
     // bit  0 - lsb of word 0
     // bit 63 - msb of word 0
     // bit 64 - lsb of word 1
-    std::vector<uint64_t> _words;
+
+    // Masks of up to nLocal*64 bits are stored inline, larger are allocated.
+    // Words beyond _nwords are kept zero.
+    static constexpr size_t nLocal = 2u;
+    uint64_t _local[nLocal] = {};
+    std::unique_ptr<uint64_t[]> _remote;
     // actual size in bits
-    // _words.size()*64u >= _size
+    // _nwords*64u >= _size
     uint16_t _size=0u;
+    uint16_t _nwords=0u;
+
+    inline uint64_t* _words() { return _remote ? _remote.get() : _local; }
+    inline const uint64_t* _words() const { return _remote ? _remote.get() : _local; }
 
 public:
 
@@ -124,10 +134,10 @@ public:
     inline bool empty() const { return _size==0u; }
 
     //! number of storage words
-    inline size_t wsize() const { return _words.size(); }
+    inline size_t wsize() const { return _nwords; }
     //! storage word
-    inline uint64_t& word(size_t i) { return _words[i]; }
-    inline const uint64_t& word(size_t i) const { return _words[i]; }
+    inline uint64_t& word(size_t i) { return _words()[i]; }
+    inline const uint64_t& word(size_t i) const { return _words()[i]; }
 
     PVXS_API
     void resize(size_t bits);
@@ -147,10 +157,10 @@ private:
     public:
 
         operator bool() const {
-            return _mask->_words[_bit/64u]&(uint64_t(1)<<(_bit%64u));
+            return _mask->word(_bit/64u)&(uint64_t(1)<<(_bit%64u));
         }
         _BitRef& operator=(bool v) {
-            auto& word = _mask->_words[_bit/64u];
+            auto& word = _mask->word(_bit/64u);
             if(v)
                 word |= uint64_t(1)<<(_bit%64u);
             else
@@ -204,16 +214,18 @@ public:
     template<typename Inp>
     BitMask(const detail::BitBase<Inp>& expr) {
         resize(expr.size());
+        auto words = _words();
         for(size_t i=0, N=expr.wsize(); i<N; i++)
-            _words[i] = expr.word(i);
+            words[i] = expr.word(i);
     }
 
     // evaluate expression
     template<typename Inp>
     BitMask& operator=(const detail::BitBase<Inp>& expr) {
         resize(expr.size());
+        auto words = _words();
         for(size_t i=0, N=expr.wsize(); i<N; i++)
-            _words[i] = expr.word(i);
+            words[i] = expr.word(i);
         return *this;
     }
 
@@ -221,8 +233,9 @@ public:
     template<typename Inp>
     BitMask& operator|=(const detail::BitBase<Inp>& expr) {
         resize(expr.size());
+        auto words = _words();
         for(size_t i=0, N=expr.wsize(); i<N; i++)
-            _words[i] |= expr.word(i);
+            words[i] |= expr.word(i);
         return *this;
     }
 
@@ -230,8 +243,9 @@ public:
     template<typename Inp>
     BitMask& operator&=(const detail::BitBase<Inp>& expr) {
         resize(expr.size());
+        auto words = _words();
         for(size_t i=0, N=expr.wsize(); i<N; i++)
-            _words[i] &= expr.word(i);
+            words[i] &= expr.word(i);
         return *this;
     }
 
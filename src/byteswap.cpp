@@ -0,0 +1,145 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include "pvaproto.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define BSWAP_X86
+#  include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__)
+#  define BSWAP_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace pvxs {namespace impl {
+
+namespace {
+
+typedef void (*bswap_fn)(uint8_t* dest, const uint8_t* src, size_t nbytes, unsigned esize);
+
+template<unsigned N>
+void bswapScalarN(uint8_t* dest, const uint8_t* src, size_t nbytes)
+{
+    for(size_t i=0u; i<nbytes; i+=N) {
+        uint8_t temp[N]; // allows dest==src
+        memcpy(temp, src+i, N);
+        for(unsigned n=0u; n<N; n++)
+            dest[i + N-1u-n] = temp[n];
+    }
+}
+
+void bswapScalar(uint8_t* dest, const uint8_t* src, size_t nbytes, unsigned esize)
+{
+    switch(esize) {
+    case 2u: bswapScalarN<2u>(dest, src, nbytes); break;
+    case 4u: bswapScalarN<4u>(dest, src, nbytes); break;
+    case 8u: bswapScalarN<8u>(dest, src, nbytes); break;
+    }
+}
+
+// shuffle control which reverses each element of esize bytes
+void bswapMask(uint8_t* mask, size_t len, unsigned esize)
+{
+    for(size_t i=0u; i<len; i++)
+        mask[i] = uint8_t((i/esize)*esize + esize-1u - i%esize);
+}
+
+#ifdef BSWAP_X86
+
+__attribute__((target("ssse3")))
+void bswapSSSE3(uint8_t* dest, const uint8_t* src, size_t nbytes, unsigned esize)
+{
+    uint8_t m[16];
+    bswapMask(m, sizeof(m), esize);
+    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m));
+
+    size_t i=0u;
+    for(; i+16u<=nbytes; i+=16u) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest+i), _mm_shuffle_epi8(v, mask));
+    }
+    bswapScalar(dest+i, src+i, nbytes-i, esize);
+}
+
+__attribute__((target("avx2")))
+void bswapAVX2(uint8_t* dest, const uint8_t* src, size_t nbytes, unsigned esize)
+{
+    // _mm256_shuffle_epi8() shuffles within each 128-bit lane, so repeat the 16 byte mask
+    uint8_t m[32];
+    bswapMask(m, sizeof(m), esize);
+    const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m));
+
+    size_t i=0u;
+    for(; i+64u<=nbytes; i+=64u) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i+32u));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest+i), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest+i+32u), _mm256_shuffle_epi8(b, mask));
+    }
+    for(; i+32u<=nbytes; i+=32u) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest+i), _mm256_shuffle_epi8(a, mask));
+    }
+    bswapScalar(dest+i, src+i, nbytes-i, esize);
+}
+
+#endif // BSWAP_X86
+
+#ifdef BSWAP_NEON
+
+void bswapNEON(uint8_t* dest, const uint8_t* src, size_t nbytes, unsigned esize)
+{
+    size_t i=0u;
+    switch(esize) {
+    case 2u:
+        for(; i+16u<=nbytes; i+=16u)
+            vst1q_u8(dest+i, vrev16q_u8(vld1q_u8(src+i)));
+        break;
+    case 4u:
+        for(; i+16u<=nbytes; i+=16u)
+            vst1q_u8(dest+i, vrev32q_u8(vld1q_u8(src+i)));
+        break;
+    case 8u:
+        for(; i+16u<=nbytes; i+=16u)
+            vst1q_u8(dest+i, vrev64q_u8(vld1q_u8(src+i)));
+        break;
+    }
+    bswapScalar(dest+i, src+i, nbytes-i, esize);
+}
+
+#endif // BSWAP_NEON
+
+bswap_fn pickBSwap()
+{
+#if defined(BSWAP_X86)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return &bswapAVX2;
+    if(__builtin_cpu_supports("ssse3"))
+        return &bswapSSSE3;
+#elif defined(BSWAP_NEON)
+    return &bswapNEON;
+#endif
+    return &bswapScalar;
+}
+
+} // namespace
+
+void bswapArray(void* dest, const void* src, size_t nbytes, size_t esize)
+{
+    if(esize!=2u && esize!=4u && esize!=8u)
+        throw std::logic_error("bswapArray() element size must be 2, 4, or 8");
+
+    // selected once, according to the capabilities of the running CPU
+    static const bswap_fn fn = pickBSwap();
+
+    (*fn)(static_cast<uint8_t*>(dest), static_cast<const uint8_t*>(src), nbytes&~(esize-1u), unsigned(esize));
+}
+
+}} // namespace pvxs::impl
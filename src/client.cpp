@@ -5,6 +5,7 @@
  */
 
 #include <algorithm>
+#include <new>
 #include <set>
 #include <tuple>
 
@@ -42,6 +43,23 @@ constexpr timeval bucketIntervalFast{0,200000};
 constexpr timeval initialSearchDelay{0, 10000}; // 10 ms
 // number of buckets in the search ring
 constexpr size_t nBuckets = 30u;
+// SearchSched lists [0, nBuckets) are the search ring.
+// [nBuckets, 2*nBuckets) a second ring for Channel::urgent
+constexpr size_t urgentRing = nBuckets;
+// additional SearchSched lists, each with an urgent counterpart
+constexpr size_t initialBucket = 2u*nBuckets;
+constexpr size_t urgentInitialBucket = initialBucket+1u;
+constexpr size_t workBucket = initialBucket+2u;
+constexpr size_t urgentWorkBucket = initialBucket+3u;
+// maximum interval between searches for one Channel, in ticks of the search ring
+constexpr size_t maxSearchHoldoff = nBuckets;
+// maximum interval between searches for an urgent Channel
+constexpr size_t maxUrgentSearchHoldoff = 4u;
+// maximum random delay, in ticks of the search ring, before re-search of a Channel
+// whose server disconnects.  Avoids a thundering herd of clients when a server restarts.
+constexpr size_t maxReconnectHoldoff = 3u;
+// names skipped while packing one search packet before it is sent
+constexpr unsigned maxSearchPackMiss = 4u;
 
 /* our limit for UDP packet payload.
  * try not to fragment with usual MTU==1500 allowing for some overhead
@@ -50,6 +68,12 @@ constexpr size_t nBuckets = 30u;
  */
 constexpr size_t maxSearchPayload = 1400;
 
+/* Limits for TCP search messages to name servers.  Many names in one message,
+ * and many messages queued without waiting for replies.
+ */
+constexpr size_t maxSearchPayloadTCP = 60000u;
+constexpr size_t maxSearchBacklogTCP = 8u*1024u*1024u;
+
 /* Interval between checks for Channels which are no longer used by any operation.
  * Channels will be discarded if found to be unused by two consecutive checks.
  */
@@ -64,9 +88,18 @@ constexpr size_t beaconTrackLimit{20000};
 // interval between checks to discard servers which have stopped sending beacons
 constexpr timeval beaconCleanInterval{180, 0};
 
+// monotonic time in units of beaconCleanInterval
+epicsUInt64 beaconTickNow()
+{
+    return epicsMonotonicGet()/(epicsUInt64(beaconCleanInterval.tv_sec)*1000000000u);
+}
+
 // special interval to attempt to reconnect to disconnected name servers
 constexpr timeval tcpNSCheckInterval{10, 0};
 
+// interval to repeat lookup of host names in address list and name servers
+constexpr timeval dnsRefreshInterval{300, 0};
+
 // searchSequenceID in CMD_SEARCH is redundant.
 // So we use a static value and instead rely on IDs for individual PVs
 constexpr uint32_t search_seq{0x66696e64}; // "find"
@@ -114,6 +147,7 @@ Channel::Channel(const std::shared_ptr<ContextImpl>& context, const std::string&
 Channel::~Channel()
 {
     disconnect(nullptr);
+    context->chanByCID.erase(cid);
 }
 
 void Channel::createOperations()
@@ -151,6 +185,14 @@ void Channel::disconnect(const std::shared_ptr<Channel>& self)
 {
     assert(!self || this==self.get());
     auto current(std::move(conn));
+    // the type may differ after reconnect
+    infoCache = Value();
+
+    // remembered server did not claim
+    const bool wasHinted = hinted && self;
+    hinted = false;
+    if(wasHinted && context->nameCache)
+        context->nameCache->forget(name);
 
     size_t holdoff = 0u;
     switch(state) {
@@ -160,13 +202,16 @@ void Channel::disconnect(const std::shared_ptr<Channel>& self)
          * likely lower level networking issue.  Try to slow
          * down reconnect loop.
          */
-        holdoff = 10u; // arbitrary
+        holdoff = wasHinted ? 0u : 10u; // arbitrary
         break;
     case Channel::Creating:
         current->creatingByCID.erase(cid);
+        // maybe send one CREATE_CHANNEL in place of this one
+        current->createChannels();
         break;
     case Channel::Active:
         current->chanBySID.erase(sid);
+        holdoff = size_t(context->reconnectJitter()*maxReconnectHoldoff);
         break;
     default:
         break;
@@ -203,20 +248,18 @@ void Channel::disconnect(const std::shared_ptr<Channel>& self)
     }
 
     if(!self) { // in ~Channel
-        // searchBuckets cleaned in tickSearch()
-
-    } else if(forcedServer.family()==AF_UNSPEC) { // begin search
+        context->searchSched.remove(this);
 
-        auto next = (context->currentBucket + holdoff) % nBuckets;
+    } else if(!forcedServer) { // begin search
 
-        context->searchBuckets[next].push_back(self);
+        context->searchAfter(this, holdoff);
 
         log_debug_printf(io, "Server %s detach channel '%s' to re-search\n",
                          current ? current->peerName.c_str() : "<disconnected>",
                          name.c_str());
 
     } else if(context->state==ContextImpl::Running) { // reconnect to specific server
-        conn = Connection::build(context, forcedServer, true);
+        conn = Connection::build(context, *forcedServer, true, nullptr, context->streamFor(*this));
 
         conn->pending[cid] = self;
         state = Connecting;
@@ -245,7 +288,7 @@ std::shared_ptr<Connect> ConnectBuilder::exec()
         throw std::logic_error("NULL Builder");
 
     auto syncCancel(_syncCancel);
-    auto context(ctx->impl->shared_from_this());
+    auto context(ctx->shardFor(_pvname));
 
     auto op(std::make_shared<ConnectImpl>(context->tcp_loop, _pvname));
     op->_onConn = std::move(_onConn);
@@ -262,15 +305,17 @@ std::shared_ptr<Connect> ConnectBuilder::exec()
 
                       // ordering of dispatch()/call() ensures creation before destruction
                       assert(op->chan);
-                      op->chan->connectors.remove(op.get());
+                      auto& conns = op->chan->connectors;
+                      conns.erase(std::remove(conns.begin(), conns.end(), op.get()), conns.end());
                   }, std::move(temp)));
     });
 
     auto server(std::move(_server));
-    context->tcp_loop.dispatch([op, context, server]() {
+    auto prio(_prio);
+    context->tcp_loop.dispatch([op, context, server, prio]() {
         // on worker
 
-        op->chan = Channel::build(context, op->_name, server);
+        op->chan = Channel::build(context, op->_name, server, false, prio);
 
         bool cur = op->_connected = op->chan->state==Channel::Active;
         if(cur && op->_onConn)
@@ -344,24 +389,35 @@ RequestInfo::RequestInfo(uint32_t sid, uint32_t ioid, std::shared_ptr<OperationB
 
 std::shared_ptr<Channel> Channel::build(const std::shared_ptr<ContextImpl>& context,
                                         const std::string& name,
-                                        const std::string& server)
+                                        const std::string& server,
+                                        bool bulk,
+                                        unsigned prio)
 {
     if(context->state!=ContextImpl::Running)
         throw std::logic_error("Context close()d");
 
-    SockAddr forceServer;
-    decltype (context->chanByName)::key_type namekey(name, server);
+    std::unique_ptr<SockAddr> forceServer;
 
     if(!server.empty()) {
-        forceServer.setAddress(server.c_str(), context->effective.tcp_port);
+        forceServer.reset(new SockAddr());
+        forceServer->setAddress(server.c_str(), context->effective.tcp_port);
     }
 
     std::shared_ptr<Channel> chan;
 
-    auto it = context->chanByName.find(namekey);
+    auto it = context->chanByName.find(ContextImpl::ChanNameKey(name, server, bulk));
     if(it!=context->chanByName.end()) {
         chan = it->second;
         chan->garbage = false;
+
+        if(prio>0u && !chan->urgent) {
+            // promote.  If still searching, search again promptly.
+            chan->urgent = true;
+            if(chan->state==Searching && chan->searchIdx!=SearchSched::none) {
+                context->searchSched.insert(chan.get(), urgentInitialBucket);
+                context->scheduleInitialSearch();
+            }
+        }
     }
 
     if(!chan) {
@@ -369,18 +425,38 @@ std::shared_ptr<Channel> Channel::build(const std::shared_ptr<ContextImpl>& cont
             context->nextCID++;
 
         chan = std::make_shared<Channel>(context, name, context->nextCID);
+        chan->bulk = bulk;
+        chan->urgent = prio>0u;
 
         context->chanByCID[chan->cid] = chan;
-        context->chanByName[namekey] = chan;
+        context->chanByName[ContextImpl::ChanNameKey(chan->name, server, bulk)] = chan;
 
-        if(server.empty()) {
-            context->initialSearchBucket.push_back(chan);
+        NameCache::Entry hint;
+
+        if(server.empty() && context->nameCache && context->nameCache->lookup(chan->name, hint)) {
+            // connect to the server which last claimed this name.  Search if it does not.
+            chan->hinted = true;
+            chan->guid = hint.guid;
+            chan->replyAddr = hint.server;
+            chan->conn = Connection::build(context, hint.server, false,
+                                           context->effective.inProcess ? &chan->guid : nullptr,
+                                           context->streamFor(*chan));
+
+            chan->conn->pending[chan->cid] = chan;
+            chan->state = Connecting;
+
+            chan->conn->createChannels();
+
+        } else if(server.empty()) {
+            context->searchSched.insert(chan.get(), chan->urgent ? urgentInitialBucket : initialBucket);
 
             context->scheduleInitialSearch();
 
         } else { // bypass search and connect so a specific server
-            chan->forcedServer = forceServer;
-            chan->conn = Connection::build(context, forceServer);
+            chan->forcedServer = std::move(forceServer);
+            chan->forcedServerKey.reset(new std::string(server));
+            chan->conn = Connection::build(context, *chan->forcedServer, false, nullptr,
+                                           context->streamFor(*chan));
 
             chan->conn->pending[chan->cid] = chan;
             chan->state = Connecting;
@@ -390,22 +466,152 @@ std::shared_ptr<Channel> Channel::build(const std::shared_ptr<ContextImpl>& cont
         }
     }
 
-    return chan;
+    // Operations share a separate reference, which notices when the last is released,
+    // so that unused channels are found without walking chanByName.  cf. ContextImpl::cacheCleanIdle()
+    auto user(chan->users.lock());
+    if(!user) {
+        auto inner(chan);
+        user = std::shared_ptr<Channel>(chan.get(), [inner](Channel*) mutable noexcept {
+            inner->context->channelIdle(inner);
+            inner.reset();
+        });
+        chan->users = user;
+    }
+
+    return user;
 }
 
 Operation::~Operation() {}
 
 Subscription::~Subscription() {}
 
+std::ostream& operator<<(std::ostream& strm, Event evt)
+{
+    switch(evt) {
+#define CASE(NAME) case Event::NAME: strm<<#NAME; break
+    CASE(Empty);
+    CASE(Data);
+    CASE(Connected);
+    CASE(Disconnect);
+    CASE(Finished);
+    CASE(RemoteError);
+    CASE(Error);
+#undef CASE
+    default:
+        strm<<"Event("<<unsigned(evt)<<")";
+    }
+    return strm;
+}
+
+Event Subscription::tryPop(Value& out, std::exception_ptr* err)
+{
+    // fallback.  Implementations avoid rethrowing
+    out = Value();
+    try {
+        out = pop();
+        return out ? Event::Data : Event::Empty;
+    } catch(Connected&) {
+        if(err)
+            *err = std::current_exception();
+        return Event::Connected;
+    } catch(Finished&) {
+        if(err)
+            *err = std::current_exception();
+        return Event::Finished;
+    } catch(Disconnect&) {
+        if(err)
+            *err = std::current_exception();
+        return Event::Disconnect;
+    } catch(RemoteError&) {
+        if(err)
+            *err = std::current_exception();
+        return Event::RemoteError;
+    } catch(std::exception&) {
+        if(err)
+            *err = std::current_exception();
+        return Event::Error;
+    }
+}
+
+Value Subscription::_latest(uint64_t* version)
+{
+    if(version)
+        *version = 0u;
+    return Value();
+}
+
+uint64_t Subscription::version() const { return 0u; }
+
 Context Context::fromEnv()
 {
     return Config::fromEnv().build();
 }
 
+namespace {
+// Contexts built with Config::shareContext, by effective configuration
+struct SharedContexts {
+    epicsMutex lock;
+    std::map<std::string, std::weak_ptr<Context::Pvt>> byConfig;
+};
+
+SharedContexts* sharedContexts()
+{
+    // Intentionally never free'd
+    static SharedContexts* ret = new SharedContexts;
+    return ret;
+}
+
+std::string sharedContextKey(const Config& conf)
+{
+    Config eff(conf);
+    eff.expand();
+    Config::defs_t defs;
+    eff.updateDefs(defs);
+
+    std::ostringstream strm;
+    for(auto& pair : defs)
+        strm<<pair.first<<'='<<pair.second<<'\n';
+    strm<<"BE="<<eff.sendBE()<<"\nUDP="<<eff.shareUDP()<<"\nshareMonitors="<<eff.shareMonitors
+        <<"\ninProcess="<<eff.inProcess
+        <<"\narrayAllocator="<<eff.arrayAllocator.get()<<'\n';
+    return strm.str();
+}
+} // namespace
+
 Context::Context(const Config& conf)
-    :pvt(std::make_shared<Pvt>(conf))
 {
-    pvt->impl->startNS();
+    if(!conf.shareContext) {
+        pvt = std::make_shared<Pvt>(conf);
+        for(auto& shard : pvt->shards)
+            shard->startNS();
+        return;
+    }
+
+    auto key(sharedContextKey(conf));
+    auto reg(sharedContexts());
+    Guard G(reg->lock);
+
+    auto it(reg->byConfig.find(key));
+    if(it!=reg->byConfig.end()) {
+        auto prev(it->second.lock());
+        if(prev && !prev->closed) {
+            pvt = std::move(prev);
+            return;
+        }
+    }
+
+    pvt = std::make_shared<Pvt>(conf);
+    for(auto& shard : pvt->shards)
+        shard->startNS();
+
+    // prune Contexts since released
+    for(auto it(reg->byConfig.begin()); it!=reg->byConfig.end();) {
+        if(it->second.expired())
+            it = reg->byConfig.erase(it);
+        else
+            ++it;
+    }
+    reg->byConfig[key] = pvt;
 }
 
 Context::~Context() {}
@@ -423,7 +629,11 @@ void Context::close()
     if(!pvt)
         throw std::logic_error("NULL Context");
 
-    pvt->impl->close();
+    pvt->closed = true;
+    for(auto& shard : pvt->shards)
+        shard->close();
+    if(pvt->nameCache)
+        pvt->nameCache->save();
 }
 
 void Context::hurryUp()
@@ -432,7 +642,8 @@ void Context::hurryUp()
         throw std::logic_error("NULL Context");
 
     pvt->impl->manager.loop().call([this](){
-        pvt->impl->poke();
+        for(auto& shard : pvt->shards)
+            shard->poke();
     });
 }
 
@@ -441,12 +652,14 @@ void Context::cacheClear(const std::string& name, cacheAction action)
     if(!pvt)
         throw std::logic_error("NULL Context");
 
-    pvt->impl->tcp_loop.call([this, name, action](){
-        // run twice to ensure both mark and sweep of all unused channels
-        log_debug_printf(setup, "cacheClear('%s')\n", name.c_str());
-        pvt->impl->cacheClean(name, action);
-        pvt->impl->cacheClean(name, action);
-    });
+    for(auto& shard : pvt->shards) {
+        shard->tcp_loop.call([&shard, name, action](){
+            // run twice to ensure both mark and sweep of all unused channels
+            log_debug_printf(setup, "cacheClear('%s')\n", name.c_str());
+            shard->cacheClean(name, action);
+            shard->cacheClean(name, action);
+        });
+    }
 }
 
 void Context::ignoreServerGUIDs(const std::vector<ServerGUID>& guids)
@@ -455,55 +668,222 @@ void Context::ignoreServerGUIDs(const std::vector<ServerGUID>& guids)
         throw std::logic_error("NULL Context");
 
     pvt->impl->manager.loop().call([this, &guids](){
-        pvt->impl->ignoreServerGUIDs = guids;
+        for(auto& shard : pvt->shards)
+            shard->ignoreServerGUIDs = guids;
     });
 }
 
 Report Context::report(bool zero) const
 {
-    Report ret;
-
-    pvt->impl->tcp_loop.call([this, &ret, zero](){
+    return report(zero, true);
+}
 
-        for(auto& pair : pvt->impl->connByAddr) {
-            auto conn = pair.second.lock();
-            if(!conn)
-                continue;
+Report Context::report(bool zero, bool channels) const
+{
+    Report ret;
 
-            ret.connections.emplace_back();
-            auto& sconn = ret.connections.back();
-            sconn.peer = conn->peerName;
-            sconn.tx = conn->statTx;
-            sconn.rx = conn->statRx;
+    for(auto& shard : pvt->shards) {
+        // Visit each connection with a separate call(), so that a report of many
+        // connections, or channels, does not stall the worker for the whole walk.
+        std::vector<std::shared_ptr<Connection>> conns;
 
+        shard->tcp_loop.call([&shard, &ret, &conns, zero](){
+            ret.searchPending += shard->searchSched.size();
+            ret.searchLastTick += shard->searchLastTick;
+            ret.searchSent += shard->searchSent;
+            ret.searchPackets += shard->searchPackets;
             if(zero) {
-                conn->statTx = conn->statRx = 0u;
+                shard->searchSent = 0u;
+                shard->searchPackets = 0u;
             }
 
-            // omit stats for transitory conn->creatingByCID
+            {
+                auto stats(shard->tcp_loop.stats(zero));
+                ret.workers.emplace_back();
+                auto& worker = ret.workers.back();
+                worker.name = stats.name;
+                worker.nWork = stats.nWork;
+                worker.busy = stats.busy;
+                worker.queued = stats.queued;
+                worker.maxQueued = stats.maxQueued;
+                worker.maxDispatchLatency = stats.maxDispatchLatency;
+                worker.maxLag = stats.maxLag;
+                worker.interval = stats.interval;
+            }
 
-            for(auto& pair : conn->chanBySID) {
-                auto chan = pair.second.lock();
-                if(!chan)
-                    continue;
+            auto& latency = ret.latency[std::string()];
+            shard->latency.get.take(latency.get.count.data(), zero);
+            shard->latency.put.take(latency.put.count.data(), zero);
+            shard->latency.rpc.take(latency.rpc.count.data(), zero);
 
-                sconn.channels.emplace_back();
-                auto& schan = sconn.channels.back();
-                schan.name = chan->name;
-                schan.tx = chan->statTx;
-                schan.rx = chan->statRx;
+            conns.reserve(shard->connByAddr.size());
+            for(auto& pair : shard->connByAddr) {
+                if(auto conn = pair.second.lock())
+                    conns.push_back(std::move(conn));
+            }
+        });
+
+        for(auto& conn : conns) {
+            Report::Connection sconn;
+            bool open = false;
+
+            shard->tcp_loop.call([&conn, &sconn, &open, zero, channels](){
+                if(!conn->bev)
+                    return; // closed since listed
+
+                open = true;
+                sconn.peer = conn->peerName;
+                sconn.tx = conn->statTx;
+                sconn.rx = conn->statRx;
+                sconn.txTypeHit = conn->txTypes.hits;
+                sconn.txTypeMiss = conn->txTypes.misses;
+                sconn.txTypes = conn->txTypes.size();
+                sconn.rxTypes = conn->rxRegistry.size();
+                conn->memoryUsage(sconn.memTypes, sconn.memTx, sconn.memRx);
+                sconn.sendBE = conn->sendBE;
+                sconn.peerBE = conn->peerBE;
+                sconn.nChannels = conn->chanBySID.size();
 
                 if(zero) {
-                    chan->statTx = chan->statRx = 0u;
+                    conn->statTx = conn->statRx = 0u;
+                    conn->txTypes.hits = conn->txTypes.misses = 0u;
                 }
-            }
+
+                if(!channels)
+                    return;
+
+                for(auto& pair : conn->opByIOID) {
+                    if(auto op = pair.second.handle.lock())
+                        sconn.memQueue += op->queueBytes();
+                }
+
+                // omit stats for transitory conn->creatingByCID
+
+                for(auto& pair : conn->chanBySID) {
+                    auto chan = pair.second.lock();
+                    if(!chan)
+                        continue;
+
+                    sconn.channels.emplace_back();
+                    auto& schan = sconn.channels.back();
+                    schan.name = chan->name;
+                    schan.tx = chan->statTx;
+                    schan.rx = chan->statRx;
+
+                    if(zero) {
+                        chan->statTx = chan->statRx = 0u;
+                    }
+                }
+            });
+
+            if(open)
+                ret.connections.push_back(std::move(sconn));
         }
+    }
 
-    });
+    ret.memory = memorySnapshot();
 
     return ret;
 }
 
+void SerialExecutor::post(std::function<void()>&& fn)
+{
+    bool idle;
+    {
+        Guard G(lock);
+        pending.push_back(std::move(fn));
+        idle = !scheduled;
+        scheduled = true;
+    }
+    if(idle)
+        submit();
+}
+
+void SerialExecutor::submit()
+{
+    auto self(shared_from_this());
+    try {
+        exec([self]() {
+            self->drain();
+        });
+    } catch(std::exception& e) {
+        log_exc_printf(setup, "Unhandled exception from Executor: %s\n", e.what());
+        Guard G(lock);
+        pending.clear();
+        scheduled = false;
+    }
+}
+
+void SerialExecutor::drain()
+{
+    decltype (pending) batch;
+    {
+        Guard G(lock);
+        batch.swap(pending);
+    }
+
+    for(auto& fn : batch) {
+        try {
+            fn();
+        } catch(std::exception& e) {
+            log_exc_printf(setup, "Unhandled exception in client callback: %s\n", e.what());
+        }
+    }
+
+    bool more;
+    {
+        Guard G(lock);
+        more = !pending.empty();
+        scheduled = more;
+    }
+    // re-submit, rather than loop, to share the Executor with other operations
+    if(more)
+        submit();
+}
+
+std::function<void(Result&&)> viaExecutor(const std::shared_ptr<SerialExecutor>& serial,
+                                          std::function<void(Result&&)>&& cb)
+{
+    if(!serial || !cb)
+        return std::move(cb);
+    auto fn(std::make_shared<std::function<void(Result&&)>>(std::move(cb)));
+    return [serial, fn](Result&& result) {
+        Result res(std::move(result));
+        serial->post([fn, res]() mutable {
+            (*fn)(std::move(res));
+        });
+    };
+}
+
+std::function<void(const Value&)> viaExecutor(const std::shared_ptr<SerialExecutor>& serial,
+                                              std::function<void(const Value&)>&& cb)
+{
+    if(!serial || !cb)
+        return std::move(cb);
+    auto fn(std::make_shared<std::function<void(const Value&)>>(std::move(cb)));
+    return [serial, fn](const Value& prototype) {
+        // the callback will run later, so give it a private copy
+        auto val(prototype.clone());
+        serial->post([fn, val]() {
+            (*fn)(val);
+        });
+    };
+}
+
+std::function<void(Value&&)> viaExecutor(const std::shared_ptr<SerialExecutor>& serial,
+                                         std::function<void(Value&&)>&& cb)
+{
+    if(!serial || !cb)
+        return std::move(cb);
+    auto fn(std::make_shared<std::function<void(Value&&)>>(std::move(cb)));
+    return [serial, fn](Value&& value) {
+        Value val(std::move(value));
+        serial->post([fn, val]() mutable {
+            (*fn)(std::move(val));
+        });
+    };
+}
+
 static
 Value buildCAMethod()
 {
@@ -525,6 +905,9 @@ ContextImpl::ContextImpl(const Config& conf, const evbase& tcp_loop)
     ,caMethod(buildCAMethod())
     ,searchTx4(AF_INET, SOCK_DGRAM, 0)
     ,searchTx6(AF_INET6, SOCK_DGRAM, 0)
+    ,prng(std::minstd_rand::result_type(epicsMonotonicGet() ^ size_t(this)))
+    ,searchSched(2u*nBuckets+4u)
+    ,getArrays(effective.arrayAllocator ? std::make_shared<impl::ArrayPool>(0u, effective.arrayAllocator) : nullptr)
     ,tcp_loop(tcp_loop)
     ,searchRx4(__FILE__, __LINE__,
                event_new(tcp_loop.base, searchTx4.sock, EV_READ|EV_PERSIST, &ContextImpl::onSearchS, this))
@@ -541,15 +924,17 @@ ContextImpl::ContextImpl(const Config& conf, const evbase& tcp_loop)
                   event_new(tcp_loop.base, -1, EV_TIMEOUT|EV_PERSIST, &ContextImpl::cacheCleanS, this))
     ,nsChecker(__FILE__, __LINE__,
                event_new(tcp_loop.base, -1, EV_TIMEOUT|EV_PERSIST, &ContextImpl::onNSCheckS, this))
+    ,dnsRefresher(__FILE__, __LINE__,
+                  event_new(tcp_loop.base, -1, EV_TIMEOUT|EV_PERSIST, &ContextImpl::onDNSRefreshS, this))
 {
-    searchBuckets.resize(nBuckets);
-
     std::set<SockAddr, SockAddrOnlyLess> bcasts;
     for(auto& addr : searchTx4.broadcasts()) {
         addr.setPort(0u);
         bcasts.insert(addr);
     }
 
+    beaconCleaned = beaconTickNow();
+
     searchTx6.ipv6_only();
 
     {
@@ -576,6 +961,12 @@ ContextImpl::ContextImpl(const Config& conf, const evbase& tcp_loop)
     searchTx6.enable_SO_RXQ_OVFL();
 
     for(auto& addr : effective.addressList) {
+        if(SockEndpoint::isHostName(addr)) {
+            log_info_printf(io, "Searching to %s after DNS lookup\n", addr.c_str());
+            hostNames.push_back(HostName{addr, searchDest.size(), false});
+            searchDest.emplace_back(SockEndpoint(), false); // placeholder
+            continue;
+        }
         SockEndpoint ep;
         try {
             ep = SockEndpoint(addr, effective.udp_port);
@@ -596,6 +987,12 @@ ContextImpl::ContextImpl(const Config& conf, const evbase& tcp_loop)
     }
 
     for(auto& addr : effective.nameServers) {
+        if(SockEndpoint::isHostName(addr)) {
+            log_info_printf(io, "Searching to TCP %s after DNS lookup\n", addr.c_str());
+            hostNames.push_back(HostName{addr, nameServers.size(), true});
+            nameServers.emplace_back(SockAddr(), nullptr); // placeholder
+            continue;
+        }
         SockAddr saddr;
         try {
             saddr.setAddress(addr.c_str(), effective.tcp_port);
@@ -647,6 +1044,17 @@ ContextImpl::~ContextImpl() {}
 
 void ContextImpl::startNS()
 {
+    if(!hostNames.empty()) {
+        resolver = evbase("PVXCDNS", epicsThreadPriorityLow);
+
+        tcp_loop.call([this]() {
+            lookupHostNames();
+
+            if(event_add(dnsRefresher.get(), &dnsRefreshInterval))
+                log_err_printf(setup, "Error enabling DNS refresh timer\n%s", "");
+        });
+    }
+
     if(nameServers.empty()) // vector size const after ctor, contents remain mutable
         return;
 
@@ -654,6 +1062,8 @@ void ContextImpl::startNS()
         // start connections to name servers
         for(auto& ns : nameServers) {
             const auto& serv = ns.first;
+            if(serv.family()==AF_UNSPEC)
+                continue; // after DNS lookup.  cf. onHostNames()
             ns.second = Connection::build(shared_from_this(), serv);
             ns.second->nameserver = true;
             log_debug_printf(io, "Connecting to nameserver %s\n", ns.second->peerName.c_str());
@@ -679,6 +1089,7 @@ void ContextImpl::close()
         (void)event_del(searchRx6.get());
         (void)event_del(beaconCleaner.get());
         (void)event_del(cacheCleaner.get());
+        (void)event_del(dnsRefresher.get());
 
         auto conns(std::move(connByAddr));
         // explicitly break ref. loop of channel cache
@@ -694,6 +1105,12 @@ void ContextImpl::close()
 
         conns.clear();
         chans.clear();
+        idleMarked.clear();
+        {
+            Guard G(idleLock);
+            idleChannels.clear();
+        }
+        monitorsShared.clear();
         // breaks a ref. loop between Connection and ClientContextImpl
         nameServers.clear();
 
@@ -744,6 +1161,127 @@ void ContextImpl::scheduleInitialSearch()
     }
 }
 
+void ContextImpl::searchAfter(Channel* chan, size_t holdoff)
+{
+    searchSched.insert(chan, (chan->urgent ? urgentRing : 0u) + (currentBucket + holdoff) % nBuckets);
+}
+
+double ContextImpl::reconnectJitter()
+{
+    return std::uniform_real_distribution<double>(0.0, 1.0)(prng);
+}
+
+unsigned ContextImpl::streamFor(const Channel& chan) const
+{
+    if(chan.bulk) // after those shared by other Channels
+        return std::max(1u, effective.tcpStreams);
+    else if(effective.tcpStreams<=1u)
+        return 0u;
+    // the PV name hash modulo tcpWorkers selected this shard.  cf. Context::Pvt::shardFor()
+    return unsigned(std::hash<std::string>{}(chan.name) / effective.tcpWorkers % effective.tcpStreams);
+}
+
+SearchSched::SearchSched(size_t nlists)
+    :lists(nlists)
+{}
+
+void SearchSched::insert(Channel* chan, size_t list)
+{
+    auto idx = chan->searchIdx;
+    if(idx==none) {
+        if(freeHead!=none) {
+            idx = freeHead;
+            freeHead = nodes[idx].next;
+            nfree--;
+        } else {
+            if(nodes.size() >= none)
+                throw std::bad_alloc();
+            idx = uint32_t(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[idx].chan = chan;
+        chan->searchIdx = idx;
+
+    } else {
+        unlink(idx);
+    }
+    link(idx, list);
+}
+
+void SearchSched::remove(Channel* chan)
+{
+    auto idx = chan->searchIdx;
+    if(idx==none)
+        return;
+
+    unlink(idx);
+    chan->searchIdx = none;
+
+    auto& node = nodes[idx];
+    node.chan = nullptr;
+    node.list = none;
+    node.next = freeHead;
+    freeHead = idx;
+    nfree++;
+}
+
+void SearchSched::splice(size_t from, size_t to)
+{
+    auto& src = lists[from];
+    if(from==to || !src.count)
+        return;
+    auto& dst = lists[to];
+
+    for(auto idx = src.head; idx!=none; idx = nodes[idx].next)
+        nodes[idx].list = uint32_t(to);
+
+    if(dst.tail==none) {
+        dst.head = src.head;
+    } else {
+        nodes[dst.tail].next = src.head;
+        nodes[src.head].prev = dst.tail;
+    }
+    dst.tail = src.tail;
+    dst.count += src.count;
+
+    src = List{};
+}
+
+void SearchSched::unlink(uint32_t idx)
+{
+    auto& node = nodes[idx];
+    auto& list = lists[node.list];
+
+    if(node.prev==none)
+        list.head = node.next;
+    else
+        nodes[node.prev].next = node.next;
+
+    if(node.next==none)
+        list.tail = node.prev;
+    else
+        nodes[node.next].prev = node.prev;
+
+    list.count--;
+}
+
+void SearchSched::link(uint32_t idx, size_t list)
+{
+    auto& node = nodes[idx];
+    auto& L = lists[list];
+
+    node.list = uint32_t(list);
+    node.next = none;
+    node.prev = L.tail;
+
+    if(L.tail==none)
+        L.head = idx;
+    else
+        nodes[L.tail].next = idx;
+    L.tail = idx;
+    L.count++;
+}
+
 void ContextImpl::onBeacon(const UDPManager::Beacon& msg)
 {
     epicsTimeStamp now;
@@ -778,6 +1316,12 @@ void ContextImpl::onBeacon(const UDPManager::Beacon& msg)
 
     auto& cur(it->second);
 
+    const auto tick = beaconTickNow();
+    if(action==New || cur.tick!=tick) {
+        cur.tick = tick;
+        beaconWheel[tick%3u].emplace_back(key, tick);
+    }
+
     if(action==Update && (cur.guid!=msg.guid || cur.peerVersion!=msg.peerVersion)) {
         action = Change;
         log_debug_printf(beacon, "Update server %s\n",
@@ -817,10 +1361,28 @@ void ContextImpl::onBeacon(const UDPManager::Beacon& msg)
                                now
                     });
 
-        poke();
+        // Search for pending Channels through this server only, instead of a poke()
+        // which hurries searches to every server.
+        SockAddr target(msg.src);
+        target.setPort(effective.udp_port);
+        std::weak_ptr<ContextImpl> wself(shared_from_this());
+        tcp_loop.dispatch([wself, target]() {
+            if(auto self = wself.lock())
+                self->searchServer(target);
+        });
     }
 }
 
+void ContextImpl::searchServer(const SockAddr& target)
+{
+    if(state!=Running || !searchSched.size())
+        return;
+
+    log_debug_printf(io, "Search pending Channels through new server %s\n", target.tostring().c_str());
+
+    tickSearch(SearchKind::targeted, false, target);
+}
+
 static
 void procSearchReply(ContextImpl& self, const SockAddr& src, uint8_t peerVersion, Buffer& M, bool istcp)
 {
@@ -901,10 +1463,13 @@ void procSearchReply(ContextImpl& self, const SockAddr& src, uint8_t peerVersion
             chan->guid = guid;
             chan->replyAddr = serv;
 
-            chan->conn = Connection::build(self.shared_from_this(), serv);
+            chan->conn = Connection::build(self.shared_from_this(), serv, false,
+                                           self.effective.inProcess ? &guid : nullptr,
+                                           self.streamFor(*chan));
 
             chan->conn->pending[chan->cid] = chan;
             chan->state = Channel::Connecting;
+            self.searchSched.remove(chan.get());
 
             chan->conn->createChannels();
 
@@ -918,20 +1483,29 @@ void procSearchReply(ContextImpl& self, const SockAddr& src, uint8_t peerVersion
 
 }
 
+// RX buffer for one search reply datagram
+static constexpr size_t search_rx_slot = 0x10000;
+// max. search reply datagrams received with one syscall
+#ifndef PVXS_SMALL_FOOTPRINT
+static constexpr size_t search_rx_batch = 8u;
+#else
+static constexpr size_t search_rx_batch = 1u;
+#endif
+
 bool ContextImpl::onSearch(evutil_socket_t fd)
 {
-    searchMsg.resize(0x10000);
-    SockAddr src;
+    if(!searchRx)
+        searchRx.reset(new uint8_t[search_rx_batch*search_rx_slot]);
 
-    recvfromx rx{fd, (char*)&searchMsg[0], searchMsg.size()-1, &src};
-    const int nrx = rx.call();
-
-    if(nrx>=0 && rx.ndrop!=0 && prevndrop!=rx.ndrop) {
-        log_debug_printf(io, "UDP search reply buffer overflow %u -> %u\n", unsigned(prevndrop), unsigned(rx.ndrop));
-        prevndrop = rx.ndrop;
+    SockAddr src[search_rx_batch];
+    recvfromx rx[search_rx_batch];
+    for(auto i : range(search_rx_batch)) {
+        rx[i] = recvfromx{fd, (char*)&searchRx[i*search_rx_slot], search_rx_slot-1u, &src[i]};
     }
 
-    if(nrx<0) {
+    const int nbatch = recvfromx::call_many(rx, search_rx_batch);
+
+    if(nbatch<0) {
         int err = evutil_socket_geterror(fd);
         if(err==SOCK_EWOULDBLOCK || err==EAGAIN || err==SOCK_EINTR) {
             // nothing to do here
@@ -943,22 +1517,39 @@ bool ContextImpl::onSearch(evutil_socket_t fd)
 
     }
 
-    FixedBuf M(true, searchMsg.data(), nrx);
+    for(auto i : range(size_t(nbatch))) {
+        if(rx[i].ndrop!=0 && prevndrop!=rx[i].ndrop) {
+            log_debug_printf(io, "UDP search reply buffer overflow %u -> %u\n", unsigned(prevndrop), unsigned(rx[i].ndrop));
+            prevndrop = rx[i].ndrop;
+        }
+
+        if(netImpairDrop())
+            continue; // emulated loss.  cf. testNetImpair()
+
+        onSearchOne(static_cast<const uint8_t*>(rx[i].buf), rx[i].nrx, src[i]);
+    }
+
+    return size_t(nbatch)==search_rx_batch;
+}
+
+void ContextImpl::onSearchOne(const uint8_t* buf, int nrx, const SockAddr& src)
+{
+    FixedBuf M(true, const_cast<uint8_t*>(buf), nrx);
     Header head{};
     from_wire(M, head); // overwrites M.be
 
     if(!M.good() || (head.flags&(pva_flags::Control|pva_flags::SegMask))) {
         // UDP packets can't contain control messages, or use segmentation
 
-        log_hex_printf(io, Level::Debug, &searchMsg[0], nrx, "Ignore UDP message from %s\n", src.tostring().c_str());
-        return true;
+        log_hex_printf(io, Level::Debug, buf, nrx, "Ignore UDP message from %s\n", src.tostring().c_str());
+        return;
     }
 
-    log_hex_printf(io, Level::Debug, &searchMsg[0], nrx, "UDP search Rx %d from %s\n", nrx, src.tostring().c_str());
+    log_hex_printf(io, Level::Debug, buf, nrx, "UDP search Rx %d from %s\n", nrx, src.tostring().c_str());
 
     if(head.len > M.size() && M.good()) {
         log_info_printf(io, "UDP ignore header truncated%s", "\n");
-        return true;
+        return;
     }
 
     if(head.cmd==CMD_SEARCH_RESPONSE) {
@@ -969,12 +1560,10 @@ bool ContextImpl::onSearch(evutil_socket_t fd)
     }
 
     if(!M.good()) {
-        log_hex_printf(io, Level::Err, &searchMsg[0], nrx,
+        log_hex_printf(io, Level::Err, buf, nrx,
                 "%s:%d Invalid search reply %d from %s\n",
                 M.file(), M.line(), nrx, src.tostring().c_str());
     }
-
-    return true;
 }
 
 void Connection::handle_SEARCH_RESPONSE()
@@ -997,9 +1586,9 @@ void ContextImpl::onSearchS(evutil_socket_t fd, short evt, void *raw)
         if(!(evt&EV_READ))
             return;
 
-        // limit number of packets processed before going back to the reactor
+        // limit number of batches of packets processed before going back to the reactor
         unsigned i;
-        const unsigned limit = 40;
+        const unsigned limit = 5;
         for(i=0; i<limit && static_cast<ContextImpl*>(raw)->onSearch(fd); i++) {}
         log_debug_printf(io, "UDP search processed %u/%u\n", i, limit);
 
@@ -1008,7 +1597,7 @@ void ContextImpl::onSearchS(evutil_socket_t fd, short evt, void *raw)
     }
 }
 
-void ContextImpl::tickSearch(SearchKind kind, bool poked)
+void ContextImpl::tickSearch(SearchKind kind, bool poked, const SockAddr& target)
 {
     // If kind == SearchKind::discover, then this is a discovery ping.
     // these are really empty searches with must-reply set.
@@ -1016,22 +1605,107 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
     //
     // If kind == SearchKind::initial we are sending the first search request
     // for the channels in initalSearchBucket, and not resending requests for
-    // channels in the searchBuckets.
+    // channels in the search ring.
+    //
+    // If kind == SearchKind::targeted we are sending a unicast search to 'target' only,
+    // for all channels in the search ring, without re-scheduling them.
+    //
+    // Urgent Channels, in their own lists, are packed first.
 
     auto idx = currentBucket;
     if(kind == SearchKind::check)
-        currentBucket = (currentBucket+1u)%searchBuckets.size();
+        currentBucket = (currentBucket+1u)%nBuckets;
 
     log_debug_printf(io, "Search tick %zu\n", idx);
 
-    decltype (searchBuckets)::value_type bucket;
+    // move the Channels to be searched to the work list, which is drained as names are sent
     if (kind == SearchKind::initial) {
-        initialSearchBucket.swap(bucket);
+        searchSched.splice(initialBucket, workBucket);
+        searchSched.splice(urgentInitialBucket, urgentWorkBucket);
     } else if(kind == SearchKind::check) {
-        searchBuckets[idx].swap(bucket);
+        searchSched.splice(idx, workBucket);
+        searchSched.splice(urgentRing + idx, urgentWorkBucket);
+    }
+
+    // With SearchKind::targeted, visit each list of the urgent ring, then of the search ring.
+    // This order is its own inverse.
+    auto ringOrder = [](size_t list) -> size_t { return (list + nBuckets) % (2u*nBuckets); };
+
+    // next member of the list being sent.  Continues from the urgent work list to the work list.
+    // With SearchKind::targeted, continues through each list of both rings in turn.
+    auto nextOf = [this, kind, &ringOrder](uint32_t n) -> uint32_t {
+        auto list = searchSched.node(n).list;
+        n = searchSched.node(n).next;
+        if(kind==SearchKind::targeted) {
+            for(auto i = ringOrder(list); n==SearchSched::none && ++i < 2u*nBuckets; )
+                n = searchSched.head(ringOrder(i));
+        } else if(n==SearchSched::none && list==urgentWorkBucket) {
+            n = searchSched.head(workBucket);
+        }
+        return n;
+    };
+
+    uint32_t tnode = SearchSched::none;
+    if(kind == SearchKind::targeted) {
+        for(size_t i=0u; i<2u*nBuckets && tnode==SearchSched::none; i++)
+            tnode = searchSched.head(ringOrder(i));
     }
 
-    while(!bucket.empty() || kind == SearchKind::discover) {
+    std::vector<std::pair<SockEndpoint, bool>> targetDest;
+    if(kind == SearchKind::targeted)
+        targetDest.emplace_back(SockEndpoint(target), true);
+    const auto& dests = kind == SearchKind::targeted ? targetDest : searchDest;
+
+    // Names are also searched through any name servers, in fewer and larger messages.
+    // Entries are (CID, name) as in the UDP packets.  Prefix and count added by flushTCP().
+    const bool batchTCP = !nameServers.empty() && (kind == SearchKind::initial || kind == SearchKind::check);
+    std::vector<uint8_t> prefixTCP;
+    uint16_t countTCP = 0u;
+    searchMsgTCP.clear();
+
+    auto flushTCP = [this, &prefixTCP, &countTCP]() {
+        if(!countTCP)
+            return;
+
+        uint8_t hbuf[8+2];
+        {
+            FixedBuf H(true, hbuf, sizeof(hbuf));
+            to_wire(H, Header{CMD_SEARCH, 0, uint32_t(prefixTCP.size() + 2u + searchMsgTCP.size())});
+            to_wire(H, countTCP);
+            assert(H.good());
+        }
+
+        for(auto& pair : nameServers) {
+            auto& serv = pair.second;
+
+            if(!serv || !serv->ready || !serv->connection())
+                continue;
+
+            auto tx = bufferevent_get_output(serv->connection());
+
+            // arbitrarily skip searching if TX buffer is too full
+            if(evbuffer_get_length(tx) > maxSearchBacklogTCP)
+                continue;
+
+            (void)evbuffer_add(tx, hbuf, 8u);
+            (void)evbuffer_add(tx, prefixTCP.data(), prefixTCP.size());
+            (void)evbuffer_add(tx, hbuf+8u, 2u);
+            (void)evbuffer_add(tx, searchMsgTCP.data(), searchMsgTCP.size());
+            // fail silently, will retry
+            serv->statTx += 8u + prefixTCP.size() + 2u + searchMsgTCP.size();
+        }
+
+        log_debug_printf(io, "Search %u names through name servers\n", unsigned(countTCP));
+
+        searchMsgTCP.clear();
+        countTCP = 0u;
+    };
+
+    size_t nsent = 0u;
+
+    while(searchSched.size(workBucket) || searchSched.size(urgentWorkBucket) || kind == SearchKind::discover
+          || (kind == SearchKind::targeted && tnode!=SearchSched::none))
+    {
         // when 'discover' we only loop once
 
         searchMsg.resize(0x10000);
@@ -1072,32 +1746,49 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
         M.skip(2u, __FILE__, __LINE__);
 
         bool payload = false;
-        while(!bucket.empty()) {
+        unsigned nmiss = 0u;
+        auto n = kind == SearchKind::targeted ? tnode
+                                              : searchSched.size(urgentWorkBucket) ? searchSched.head(urgentWorkBucket)
+                                                                                   : searchSched.head(workBucket);
+        while(n!=SearchSched::none && nmiss < maxSearchPackMiss) {
             assert(kind != SearchKind::discover);
 
-            auto chan = bucket.front().lock();
-            if(!chan || chan->state!=Channel::Searching) {
-                bucket.pop_front();
+            auto chan = searchSched.node(n).chan;
+            auto next = nextOf(n); // before chan is moved to another list
+
+            if(chan->state!=Channel::Searching) {
+                searchSched.remove(chan);
+                n = next;
                 continue;
             }
 
-            auto save = M.save();
-            to_wire(M, uint32_t(chan->cid));
-            to_wire(M, chan->name);
-
-            if(!M.good()) {
+            if(chan->name.size() > searchMsg.size() - 128u) {
                 // some absurdly long PV name?
                 log_err_printf(io, "PV name exceeds search buffer: '%s'\n", chan->name.c_str());
                 // drop it on the floor
-                bucket.pop_front();
+                searchSched.remove(chan);
+                n = next;
                 continue;
+            }
+
+            auto save = M.save();
+            to_wire(M, uint32_t(chan->cid));
+            to_wire(M, chan->name);
 
-            } else if(size_t(M.save() - searchMsg.data()) > maxSearchPayload) {
-                if(payload) {
-                    // other names did fit, defer this one to the next packet
+            if(size_t(M.save() - searchMsg.data()) > maxSearchPayload) {
+                if(payload && kind == SearchKind::targeted) {
+                    // other names did fit, resume from this one in the next packet
                     M.restore(save);
                     break;
 
+                } else if(payload) {
+                    // other names did fit, leave this one for the next packet
+                    // and see if some later (shorter) name fills the remaining space.
+                    M.restore(save);
+                    nmiss++;
+                    n = next;
+                    continue;
+
                 } else {
                     // some slightly less absurdly long PV name.
                     // Less than the UDP packet limit, but longer
@@ -1107,34 +1798,58 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
             }
 
             count++;
+            payload = true;
+            n = next;
+
+            if(batchTCP) {
+                if(prefixTCP.empty()) {
+                    // same as UDP, except always "unicast", and reply port is meaningless
+                    prefixTCP.assign(searchMsg.data()+8u, pcount);
+                    prefixTCP[pflags - searchMsg.data() - 8u] |= pva_search_flags::Unicast;
+                    prefixTCP[pport - searchMsg.data() - 8u] = 0u;
+                    prefixTCP[pport - searchMsg.data() - 8u + 1u] = 0u;
+                }
+                if(searchMsgTCP.size() + (M.save() - save) > maxSearchPayloadTCP || countTCP==0xffff)
+                    flushTCP();
+                searchMsgTCP.insert(searchMsgTCP.end(), save, M.save());
+                countTCP++;
+            }
 
+            if(kind == SearchKind::targeted)
+                continue; // stays in its place in the ring
+
+            // exponential backoff.  1, 2, 4, ... ticks until the next search, up to maxSearchHoldoff,
+            // or maxUrgentSearchHoldoff
             size_t ninc = 0u;
-            if(kind==SearchKind::check && !poked)
-                ninc = chan->nSearch = std::min(searchBuckets.size(), chan->nSearch+1u);
-            auto next = (idx + ninc)%searchBuckets.size();
-            auto nextnext = (next + 1u)%searchBuckets.size();
+            if(kind==SearchKind::check && !poked) {
+                chan->nSearch = std::min(chan->nSearch+1u, size_t(8u));
+                ninc = std::min(size_t(1u)<<(chan->nSearch-1u),
+                                chan->urgent ? maxUrgentSearchHoldoff : maxSearchHoldoff);
+            }
+            const size_t ring = chan->urgent ? urgentRing : 0u;
+            auto bucket = ring + (idx + ninc)%nBuckets;
+            auto bucket2 = ring + (idx + ninc + 1u)%nBuckets;
 
             // try to smooth out UDP bcast load by waiting one extra tick
             {
-                auto nextN = searchBuckets[next].size();
-                auto nextnextN = searchBuckets[nextnext].size();
+                auto nextN = searchSched.size(bucket);
+                auto nextnextN = searchSched.size(bucket2);
 
                 if(nextN > nextnextN && (nextN-nextnextN > 100u))
-                    next = nextnext;
+                    bucket = bucket2;
             }
 
-            auto& nextBucket = searchBuckets[next];
-
-            nextBucket.splice(nextBucket.end(),
-                              bucket,
-                              bucket.begin());
-            payload = true;
+            searchSched.insert(chan, bucket);
         }
         assert(M.good());
 
+        tnode = n;
+
         if(!payload && kind != SearchKind::discover)
             break;
 
+        nsent += count;
+
         {
             FixedBuf C(true, pcount, 2u);
             to_wire(C, count);
@@ -1144,7 +1859,10 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
             FixedBuf H(true, searchMsg.data(), 8);
             to_wire(H, Header{CMD_SEARCH, 0, uint32_t(consumed-8u)});
         }
-        for(auto& pair : searchDest) {
+        for(auto& pair : dests) {
+            if(pair.first.addr.family()==AF_UNSPEC)
+                continue; // awaiting DNS lookup
+
             auto& dest = pair.first.addr.family()==AF_INET ? searchTx4 : searchTx6;
 
             if(pair.second) {
@@ -1159,6 +1877,9 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
             int ntx = sendto(dest.sock, (char*)searchMsg.data(), consumed, 0,
                              &pair.first.addr->sa, pair.first.addr.size());
 
+            if(ntx>=0)
+                searchPackets++;
+
             if(ntx<0) {
                 int err = evutil_socket_geterror(dest.sock);
                 auto lvl = Level::Warn;
@@ -1178,6 +1899,11 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
                                pair.second ? "ucast" : "bcast");
             }
         }
+        if(kind == SearchKind::targeted)
+            continue; // not to name servers
+        else if(batchTCP)
+            continue; // name servers searched by flushTCP()
+
         *pflags |= 0x80; // TCP search is always "unicast"
         // TCP search replies should always come back on the same connection,
         // so zero out the meaningless response port.
@@ -1186,7 +1912,7 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
         for(auto& pair : nameServers) {
             auto& serv = pair.second;
 
-            if(!serv->ready || !serv->connection())
+            if(!serv || !serv->ready || !serv->connection())
                 continue;
 
             auto tx = bufferevent_get_output(serv->connection());
@@ -1203,6 +1929,21 @@ void ContextImpl::tickSearch(SearchKind kind, bool poked)
         if(kind == SearchKind::discover)
             break;
     }
+
+    flushTCP();
+
+    if(kind == SearchKind::targeted) {
+        searchSent += nsent;
+
+        log_debug_printf(io, "Search %s sent %zu names\n", target.tostring().c_str(), nsent);
+
+    } else if(kind != SearchKind::discover) {
+        searchLastTick = nsent;
+        searchSent += nsent;
+
+        log_debug_printf(io, "Search tick %zu sent %zu names, %zu pending\n",
+                         idx, nsent, searchSched.size());
+    }
 }
 
 void ContextImpl::tickSearchS(evutil_socket_t fd, short evt, void *raw)
@@ -1239,6 +1980,27 @@ void ContextImpl::initialSearchS(evutil_socket_t fd, short evt, void *raw)
     }
 }
 
+size_t ContextImpl::BeaconServerHash::operator()(const BeaconServer& key) const
+{
+    size_t ret = std::hash<std::string>()(key.second);
+    auto& addr = key.first;
+    const uint8_t* raw = nullptr;
+    size_t len = 0u;
+    switch(addr.family()) {
+    case AF_INET:
+        raw = reinterpret_cast<const uint8_t*>(&addr->in.sin_addr);
+        len = sizeof(addr->in.sin_addr);
+        break;
+    case AF_INET6:
+        raw = reinterpret_cast<const uint8_t*>(&addr->in6.sin6_addr);
+        len = sizeof(addr->in6.sin6_addr);
+        break;
+    }
+    for(auto i : range(len))
+        ret = ret*31u + raw[i];
+    return ret*31u + addr.port();
+}
+
 void ContextImpl::tickBeaconClean()
 {
     epicsTimeStamp now;
@@ -1246,29 +2008,44 @@ void ContextImpl::tickBeaconClean()
 
     Guard G(pokeLock);
 
-    auto it = beaconTrack.begin();
-    while(it!=beaconTrack.end()) {
-        auto cur = it++;
-
-        double age = epicsTimeDiffInSeconds(&now, &cur->second.time);
+    /* A server last seen during tick T is lost when not seen again by the start of tick T+3.
+     * eg. between 2 and 3 intervals ago.  Only the slots of the ticks which have
+     * expired since the previous call need to be checked.
+     * Called both from the UDP worker (beaconCleaner), and more often from the
+     * TCP worker (cacheCleaner), so usually there is nothing to do.
+     */
+    const auto tick = beaconTickNow();
+    for(auto T = beaconCleaned+1u; T<=tick && T<=beaconCleaned+3u; T++) {
+        auto& slot = beaconWheel[T%3u]; // also slot of tick T-3
+        size_t nkeep = 0u;
+        for(auto& ent : slot) {
+            auto it = beaconTrack.find(ent.first);
+            if(it==beaconTrack.end() || it->second.tick!=ent.second)
+                continue; // already lost, or seen again since
+
+            if(ent.second+3u > tick) {
+                slot[nkeep++] = ent; // seen during a later tick, T or after
+                continue;
+            }
 
-        if(age < -15.0 || age > 2*beaconCleanInterval.tv_sec) {
             log_debug_printf(io, "%s\n",
-                             std::string(SB()<<" Lost server "<<cur->second.guid
-                                         <<' '<<cur->first.second<<'/'<<cur->first.first).c_str());
+                             std::string(SB()<<" Lost server "<<it->second.guid
+                                         <<' '<<it->first.second<<'/'<<it->first.first).c_str());
 
             serverEvent(Discovered{Discovered::Timeout,
-                                   cur->second.peerVersion,
+                                   it->second.peerVersion,
                                    "", // no associated Beacon
-                                   cur->first.second,
-                                   cur->first.first.tostring(),
-                                   cur->second.guid,
+                                   it->first.second,
+                                   it->first.first.tostring(),
+                                   it->second.guid,
                                    now
                         });
 
-            beaconTrack.erase(cur);
+            beaconTrack.erase(it);
         }
+        slot.resize(nkeep);
     }
+    beaconCleaned = tick;
 }
 
 void ContextImpl::tickBeaconCleanS(evutil_socket_t fd, short evt, void *raw)
@@ -1285,6 +2062,8 @@ void ContextImpl::onNSCheck()
     for(auto& ns : nameServers) {
         if(ns.second && ns.second->state != ConnBase::Disconnected) // hold-off, connecting, or connected
             continue;
+        else if(ns.first.family()==AF_UNSPEC) // awaiting DNS lookup
+            continue;
 
         ns.second = Connection::build(shared_from_this(), ns.first);
         ns.second->nameserver = true;
@@ -1301,6 +2080,92 @@ void ContextImpl::onNSCheckS(evutil_socket_t fd, short evt, void *raw)
     }
 }
 
+void ContextImpl::lookupHostNames()
+{
+    std::weak_ptr<ContextImpl> wself(shared_from_this());
+    auto loop(tcp_loop);
+    auto names(hostNames);
+    auto udp_port(effective.udp_port), tcp_port(effective.tcp_port);
+
+    // no strong reference to this ContextImpl from resolver
+    resolver.dispatch([wself, loop, names, udp_port, tcp_port]() {
+        std::vector<SockEndpoint> results(names.size());
+
+        for(auto i : range(names.size())) {
+            auto& host = names[i];
+            try {
+                // may block
+                results[i] = SockEndpoint(host.name, host.nameserver ? tcp_port : udp_port);
+            }catch(std::exception& e){
+                log_warn_printf(setup, "Unable to lookup %s : %s\n", host.name.c_str(), e.what());
+            }
+        }
+
+        loop.tryDispatch([wself, results]() {
+            if(auto self = wself.lock())
+                self->onHostNames(results);
+        });
+    });
+}
+
+void ContextImpl::onHostNames(const std::vector<SockEndpoint>& results)
+{
+    if(state==Stopped)
+        return;
+
+    assert(results.size()==hostNames.size());
+
+    std::set<SockAddr, SockAddrOnlyLess> bcasts;
+    for(auto& addr : searchTx4.broadcasts()) {
+        addr.setPort(0u);
+        bcasts.insert(addr);
+    }
+
+    for(auto i : range(hostNames.size())) {
+        auto& host = hostNames[i];
+        auto& ep = results[i];
+
+        if(ep.addr.family()==AF_UNSPEC)
+            continue; // lookup failed.  Keep any previous result
+
+        if(host.nameserver) {
+            auto& ns = nameServers[host.index];
+            if(ns.first==ep.addr)
+                continue;
+
+            log_info_printf(io, "Searching to TCP %s (%s)\n",
+                            ep.addr.tostring().c_str(), host.name.c_str());
+            ns.first = ep.addr;
+            // replaces any connection to a previous address
+            ns.second = Connection::build(shared_from_this(), ns.first);
+            ns.second->nameserver = true;
+
+        } else {
+            auto& dest = searchDest[host.index];
+            if(dest.first==ep)
+                continue;
+
+            auto isucast = !ep.addr.isMCast();
+
+            if(isucast && ep.addr.family()==AF_INET && bcasts.find(ep.addr)!=bcasts.end())
+                isucast = false;
+
+            log_info_printf(io, "Searching to %s%s (%s)\n", std::string(SB()<<ep).c_str(),
+                            (isucast?" unicast":""), host.name.c_str());
+            dest = std::make_pair(ep, isucast);
+        }
+    }
+}
+
+void ContextImpl::onDNSRefreshS(evutil_socket_t fd, short evt, void *raw)
+{
+    try {
+        static_cast<ContextImpl*>(raw)->lookupHostNames();
+    }catch(std::exception& e){
+        log_exc_printf(io, "Unhandled error in DNS refresh timer callback: %s\n", e.what());
+    }
+}
+
 void ContextImpl::cacheClean(const std::string& name, Context::cacheAction action)
 {
     auto next(chanByName.begin()),
@@ -1309,7 +2174,7 @@ void ContextImpl::cacheClean(const std::string& name, Context::cacheAction actio
     while(next!=end) {
         auto cur(next++);
 
-        if(!name.empty() && cur->first.first!=name)
+        if(!name.empty() && *cur->first.name!=name)
             continue;
 
         else if(action!=Context::Clean || cur->second.use_count()<=1) {
@@ -1318,11 +2183,11 @@ void ContextImpl::cacheClean(const std::string& name, Context::cacheAction actio
             if(action==Context::Clean && !cur->second->garbage) {
                 // mark for next sweep
                 log_debug_printf(setup, "Chan GC mark '%s':'%s'\n",
-                                 cur->first.first.c_str(), cur->first.second.c_str());
+                                 cur->first.name->c_str(), cur->first.server.c_str());
 
             } else {
                 log_debug_printf(setup, "Chan GC sweep '%s':'%s'\n",
-                                 cur->first.first.c_str(), cur->first.second.c_str());
+                                 cur->first.name->c_str(), cur->first.server.c_str());
 
                 auto trash(std::move(cur->second));
 
@@ -1337,10 +2202,63 @@ void ContextImpl::cacheClean(const std::string& name, Context::cacheAction actio
     }
 }
 
+void ContextImpl::channelIdle(const std::shared_ptr<Channel>& chan) noexcept
+{
+    try {
+        Guard G(idleLock);
+        idleChannels.emplace_back(chan);
+    }catch(std::bad_alloc&){
+        idleLost = true;
+    }
+}
+
+void ContextImpl::cacheCleanIdle()
+{
+    if(idleLost.exchange(false)) {
+        // fallback to the full mark and sweep
+        cacheClean(std::string(), Context::Clean);
+    }
+
+    // sweep those marked by the previous tick, and not re-used since.
+    // unused for at least one channelCacheCleanInterval
+    for(auto& wchan : idleMarked) {
+        auto chan(wchan.lock());
+        if(!chan || !chan->garbage || !chan->users.expired())
+            continue;
+
+        ChanNameKey key(chan->name, chan->forcedServerKey ? *chan->forcedServerKey : std::string(), chan->bulk);
+        auto it(chanByName.find(key));
+        if(it==chanByName.end() || it->second!=chan)
+            continue; // already removed.  eg. by cacheClear()
+
+        log_debug_printf(setup, "Chan GC sweep '%s':'%s'\n",
+                         chan->name.c_str(), key.server.c_str());
+
+        // explicitly break ref. loop of channel cache
+        chanByName.erase(it);
+        // Channel destroyed when chan goes out of scope
+    }
+    idleMarked.clear();
+
+    {
+        Guard G(idleLock);
+        idleMarked.swap(idleChannels);
+    }
+
+    // mark
+    for(auto& wchan : idleMarked) {
+        auto chan(wchan.lock());
+        if(chan && chan->users.expired()) {
+            chan->garbage = true;
+            log_debug_printf(setup, "Chan GC mark '%s'\n", chan->name.c_str());
+        }
+    }
+}
+
 void ContextImpl::cacheCleanS(evutil_socket_t fd, short evt, void *raw)
 {
     try {
-        static_cast<ContextImpl*>(raw)->cacheClean(std::string(), Context::Clean);
+        static_cast<ContextImpl*>(raw)->cacheCleanIdle();
         static_cast<ContextImpl*>(raw)->tickBeaconClean();
     }catch(std::exception& e){
         log_exc_printf(io, "Unhandled error in beacon cleaner timer callback: %s\n", e.what());
@@ -1348,13 +2266,45 @@ void ContextImpl::cacheCleanS(evutil_socket_t fd, short evt, void *raw)
 }
 
 Context::Pvt::Pvt(const Config& conf)
-    :loop("PVXCTCP", epicsThreadPriorityCAServerLow)
+    :loop(tcpWorkerLoop("PVXCTCP", epicsThreadPriorityCAServerLow, conf))
     ,impl(std::make_shared<ContextImpl>(conf, loop.internal()))
-{}
+{
+    shards.push_back(impl);
+
+    if(!impl->effective.nameCacheFile.empty())
+        nameCache = std::make_shared<NameCache>(impl->effective.nameCacheFile);
+    impl->nameCache = nameCache;
+
+    try {
+        const auto nworkers = impl->effective.tcpWorkers;
+        extraLoops.reserve(nworkers-1u);
+        shards.reserve(nworkers);
+
+        for(auto i : range(1u, nworkers)) {
+            extraLoops.push_back(tcpWorkerLoop(SB()<<"PVXCTCP-"<<i, epicsThreadPriorityCAServerLow, conf, i));
+            shards.push_back(std::make_shared<ContextImpl>(conf, extraLoops.back().internal()));
+            shards.back()->nameCache = nameCache;
+        }
+    }catch(...){
+        for(auto& shard : shards)
+            shard->close();
+        throw;
+    }
+}
 
 Context::Pvt::~Pvt()
 {
-    impl->close();
+    for(auto& shard : shards)
+        shard->close();
+    if(nameCache)
+        nameCache->save();
+}
+
+const std::shared_ptr<ContextImpl>& Context::Pvt::shardFor(const std::string& name) const
+{
+    if(shards.size()==1u)
+        return impl;
+    return shards[std::hash<std::string>{}(name) % shards.size()];
 }
 
 } // namespace client
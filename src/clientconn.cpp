@@ -18,22 +18,24 @@ DEFINE_LOGGER(remote, "pvxs.remote.log");
 
 Connection::Connection(const std::shared_ptr<ContextImpl>& context,
                        const SockAddr& peerAddr,
-                       bool reconn)
+                       bool reconn,
+                       const ServerGUID* local,
+                       unsigned stream)
     :ConnBase (true, context->effective.sendBE(),
                nullptr,
                peerAddr)
     ,context(context)
-    ,echoTimer(__FILE__, __LINE__,
-               event_new(context->tcp_loop.base, -1, EV_TIMEOUT|EV_PERSIST, &tickEchoS, this))
+    ,stream(stream)
+    ,echoTimer(context->tcp_loop, [this]() { tickEcho(); })
 {
     if(reconn) {
-        log_debug_printf(io, "start holdoff timer for %s\n", peerName.c_str());
+        // randomize so that many clients do not all reconnect at once
+        double holdoff = 2.0 + 2.0*context->reconnectJitter();
+        log_debug_printf(io, "start holdoff timer for %s %.2f sec\n", peerName.c_str(), holdoff);
 
-        constexpr timeval holdoff{2, 0};
-        if(event_add(echoTimer.get(), &holdoff))
-            log_err_printf(io, "Server %s error starting echoTimer as holdoff\n", peerName.c_str());
+        echoTimer.start(holdoff);
 
-    } else {
+    } else if(!local || !connectLocal(*local)) {
         startConnecting();
     }
 }
@@ -45,15 +47,18 @@ Connection::~Connection()
 }
 
 std::shared_ptr<Connection> Connection::build(const std::shared_ptr<ContextImpl>& context,
-                                              const SockAddr& serv, bool reconn)
+                                              const SockAddr& serv, bool reconn,
+                                              const ServerGUID* local,
+                                              unsigned stream)
 {
     if(context->state!=ContextImpl::Running)
         throw std::logic_error("Context close()d");
 
     std::shared_ptr<Connection> ret;
-    auto it = context->connByAddr.find(serv);
+    auto key(std::make_pair(serv, stream));
+    auto it = context->connByAddr.find(key);
     if(it==context->connByAddr.end() || !(ret = it->second.lock())) {
-        context->connByAddr[serv] = ret = std::make_shared<Connection>(context, serv, reconn);
+        context->connByAddr[key] = ret = std::make_shared<Connection>(context, serv, reconn, local, stream);
     }
     return ret;
 }
@@ -62,7 +67,24 @@ void Connection::startConnecting()
 {
     assert(!this->bev);
 
-    auto bev(bufferevent_socket_new(context->tcp_loop.base, -1, BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS));
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    if(!context->effective.unixSocketDir.empty()
+            && (peerAddr.isLO() || context->ifmap.is_iface(peerAddr))
+            && connectUnix())
+        return;
+#endif
+
+    // create socket here, instead of in bufferevent_socket_connect(), to apply options before connect()
+    evsocket sock(peerAddr.family(), SOCK_STREAM, 0);
+    evsocket::set_tcp_options(sock.sock, context->effective);
+    // before connect(), so that the TCP window scale reflects a larger buffer.  cf. ContextImpl::streamFor()
+    if(context->effective.tcpBulkRecvBuffer && stream==std::max(1u, context->effective.tcpStreams))
+        evsocket::set_tcp_options(sock.sock, 0u, context->effective.tcpBulkRecvBuffer, false, 0u, 0u);
+
+    auto bev(bufferevent_socket_new(context->tcp_loop.base, sock.sock, BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS));
+    if(!bev)
+        throw BAD_ALLOC();
+    sock.sock = evutil_socket_t(-1); // now owned by bev
 
     bufferevent_setcb(bev, &bevReadS, nullptr, &bevEventS, this);
 
@@ -77,37 +99,145 @@ void Connection::startConnecting()
     log_debug_printf(io, "Connecting to %s, RX readahead %zu\n", peerName.c_str(), readahead);
 }
 
+bool Connection::connectLocal(const ServerGUID& guid)
+{
+    assert(!this->bev);
+
+    SOCKET s[2];
+    try {
+        compat_socketpair(s);
+    }catch(std::exception& e){
+        log_warn_printf(io, "Unable to create local connection to %s : %s\n", peerName.c_str(), e.what());
+        return false;
+    }
+    for(auto sock : s) {
+        evutil_make_socket_closeonexec(sock);
+        (void)evutil_make_socket_nonblocking(sock);
+    }
+
+    auto bev(bufferevent_socket_new(context->tcp_loop.base, s[0], BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS));
+    if(!bev) {
+        evutil_closesocket(s[0]);
+        evutil_closesocket(s[1]);
+        throw BAD_ALLOC();
+    }
+
+    // the Server sees a peer on the same host, as with a TCP connection through loopback
+    if(!impl::acceptLocalConnection(guid, s[1], peerAddr.withPort(0))) {
+        log_debug_printf(io, "No local Server for %s\n", peerName.c_str());
+        bufferevent_free(bev);
+        evutil_closesocket(s[1]);
+        return false;
+    }
+
+    connectedLocal(bev);
+    return true;
+}
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+bool Connection::connectUnix()
+{
+    auto path(unixSocketPath(context->effective.unixSocketDir, peerAddr.port()));
+    sockaddr_un addr;
+    socklen_t alen;
+    evutil_socket_t sock;
+    try {
+        alen = unixSocketAddr(addr, path);
+        sock = unixSocket();
+    }catch(std::exception& e){
+        log_warn_printf(io, "Unable to connect to %s through Unix socket : %s\n", peerName.c_str(), e.what());
+        return false;
+    }
+
+    // completes, or fails, immediately
+    if(::connect(sock, (sockaddr*)&addr, alen)) {
+        log_debug_printf(io, "Unable to connect to %s through %s\n", peerName.c_str(), path.c_str());
+        evutil_closesocket(sock);
+        return false;
+    }
+
+    auto bev(bufferevent_socket_new(context->tcp_loop.base, sock, BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS));
+    if(!bev) {
+        evutil_closesocket(sock);
+        throw BAD_ALLOC();
+    }
+
+    connectedLocal(bev);
+    return true;
+}
+#endif // PVXS_HAVE_UNIX_SOCKET
+
+void Connection::connectedLocal(bufferevent* bev)
+{
+    bufferevent_setcb(bev, &bevReadS, nullptr, &bevEventS, this);
+
+    timeval tmo(totv(context->effective.tcpTimeout));
+    bufferevent_set_timeouts(bev, &tmo, &tmo);
+
+    connect(bev);
+
+    log_debug_printf(io, "Local connection to %s, RX readahead %zu\n", peerName.c_str(), readahead);
+
+    // already connected
+    bevEvent(BEV_EVENT_CONNECTED);
+}
+
 void Connection::createChannels()
 {
     if(!ready)
         return; // defer until CONNECTION_VALIDATED
 
-    (void)evbuffer_drain(txBody.get(), evbuffer_get_length(txBody.get()));
-
-    auto todo = std::move(pending);
+    // channels for the next CREATE_CHANNEL.  Only one unless the server advertises pva_qos::MultiCreate
+    std::vector<std::shared_ptr<Channel>> batch;
+    size_t blen = 0u;
 
-    for(auto& pair : todo) {
-        auto chan = pair.second.lock();
+    // the remainder is sent as replies arrive.  cf. handle_CREATE_CHANNEL()
+    for(auto it(pending.begin()); it!=pending.end() && creatingByCID.size() < maxCreating; ) {
+        auto chan = it->second.lock();
+        it = pending.erase(it);
         if(!chan || chan->state!=Channel::Connecting)
             continue;
 
-        {
-            (void)evbuffer_drain(txBody.get(), evbuffer_get_length(txBody.get()));
+        creatingByCID[chan->cid] = chan;
+        chan->state = Channel::Creating;
 
-            EvOutBuf R(sendBE, txBody.get());
+        log_debug_printf(io, "Server %s creating channel '%s' (%u)\n", peerName.c_str(),
+                         chan->name.c_str(), unsigned(chan->cid));
+
+        batch.push_back(std::move(chan));
+        blen += 4u + 5u + batch.back()->name.size(); // cid and name, with worst case Size
+
+        if(!peerMultiCreate || blen >= maxCreateBody) {
+            sendCreateChannels(batch);
+            blen = 0u;
+        }
+    }
+
+    if(!batch.empty())
+        sendCreateChannels(batch);
+}
+
+void Connection::sendCreateChannels(std::vector<std::shared_ptr<Channel>>& batch)
+{
+    static_assert(maxCreating <= 0xffff, "CREATE_CHANNEL count is uint16_t");
+    {
+        (void)evbuffer_drain(txBody.get(), evbuffer_get_length(txBody.get()));
 
-            to_wire(R, uint16_t(1u));
+        EvOutBuf R(sendBE, txBody.get());
+
+        to_wire(R, uint16_t(batch.size()));
+        for(auto& chan : batch) {
             to_wire(R, chan->cid);
             to_wire(R, chan->name);
         }
-        chan->statTx += enqueueTxBody(CMD_CREATE_CHANNEL);
-
-        creatingByCID[chan->cid] = chan;
-        chan->state = Channel::Creating;
+    }
+    auto nbytes = enqueueTxBody(CMD_CREATE_CHANNEL);
 
-        log_debug_printf(io, "Server %s creating channel '%s' (%u)\n", peerName.c_str(),
-                         chan->name.c_str(), unsigned(chan->cid));
+    // split message among channels
+    for(auto& chan : batch) {
+        chan->statTx += nbytes/batch.size();
     }
+    batch.clear();
 }
 
 void Connection::sendDestroyRequest(uint32_t sid, uint32_t ioid)
@@ -140,9 +270,8 @@ void Connection::bevEvent(short events)
         // start echo timer
         // tcpTimeout(40) -> 15 second echo period
         // bound echo to range [1, 15]
-        timeval tmo(totv(std::max(1.0, std::min(15.0, context->effective.tcpTimeout*3.0/8.0))));
-        if(event_add(echoTimer.get(), &tmo))
-            log_err_printf(io, "Server %s error starting echoTimer\n", peerName.c_str());
+        echoPeriod = std::max(1.0, std::min(15.0, context->effective.tcpTimeout*3.0/8.0));
+        echoTimer.start(echoPeriod);
 
         state = Connected;
     }
@@ -157,27 +286,29 @@ void Connection::cleanup()
 {
     ready = false;
 
-    context->connByAddr.erase(peerAddr);
+    context->connByAddr.erase(std::make_pair(peerAddr, stream));
 
     if(bev)
         bev.reset();
 
-    if(event_del(echoTimer.get()))
-        log_err_printf(io, "Server %s error stopping echoTimer\n", peerName.c_str());
+    echoTimer.cancel();
 
-    // return Channels to Searching state
-    std::set<std::shared_ptr<Channel>> todo;
+    // return Channels to Searching state.
+    // Each Channel appears in only one of these, according to its state.
+    // Done in one pass so that no Channel is left referring to this Connection.
+    std::vector<std::shared_ptr<Channel>> todo;
+    todo.reserve(pending.size() + chanBySID.size() + creatingByCID.size());
     for(auto& pair : pending) {
         if(auto chan = pair.second.lock())
-            todo.insert(chan);
+            todo.push_back(std::move(chan));
     }
     for(auto& pair : chanBySID) {
         if(auto chan = pair.second.lock())
-            todo.insert(chan);
+            todo.push_back(std::move(chan));
     }
     for(auto& pair : creatingByCID) {
         if(auto chan = pair.second.lock())
-            todo.insert(chan);
+            todo.push_back(std::move(chan));
     }
 
     for(auto& chan : todo) {
@@ -222,6 +353,14 @@ void Connection::handle_CONNECTION_VALIDATION()
             selected = method;
     }
 
+    // optional QoS, appended by pvxs servers
+    uint16_t qos = 0u;
+    if(M.good() && M.ensure(2u))
+        from_wire(M, qos);
+    peerMultiCreate = qos&pva_qos::MultiCreate;
+    peerEarlyExec = qos&pva_qos::EarlyExec;
+    peerKeepAlive = (qos&pva_qos::KeepAlive) && context->effective.tcpKeepAlive;
+
     if(!M.good()) {
         log_err_printf(io, "%s:%d Server %s sends invalid CONNECTION_VALIDATION.  Disconnect...\n",
                        M.file(), M.line(), peerName.c_str());
@@ -271,8 +410,12 @@ void Connection::handle_CONNECTION_VALIDATION()
         to_wire(R, uint32_t(0x10000));
         // serverIntrospectionRegistryMaxSize, also not used
         to_wire(R, uint16_t(0x7fff));
-        // QoS, not used (quality?)
-        to_wire(R, uint16_t(0));
+        // QoS, otherwise unused.  Advertise that we can decode compressed replies, and array patches.
+        // Echo KeepAlive to agree that neither side will time out an idle connection.
+        uint16_t qos = pva_qos::LZ4|pva_qos::ArrayDelta;
+        if(peerKeepAlive)
+            qos |= pva_qos::KeepAlive;
+        to_wire(R, qos);
 
         to_wire(R, selected);
 
@@ -281,6 +424,15 @@ void Connection::handle_CONNECTION_VALIDATION()
             to_wire_full(R, cred);
     }
     enqueueTxBody(CMD_CONNECTION_VALIDATION);
+
+    if(peerKeepAlive && bev) {
+        // dead peer now detected by TCP keepalive.  Keep the write timeout for a stalled peer.
+        timeval tmo(totv(context->effective.tcpTimeout));
+        bufferevent_set_timeouts(bev.get(), nullptr, &tmo);
+        // periodic ECHO only to refresh the RTT estimate.
+        echoPeriod = rttPeriod;
+        log_debug_printf(io, "Server %s using TCP keepalive\n", peerName.c_str());
+    }
 }
 
 void Connection::handle_CONNECTION_VALIDATED()
@@ -306,6 +458,9 @@ void Connection::handle_CONNECTION_VALIDATED()
 
     ready = true;
 
+    // early round trip time sample
+    tickEcho();
+
     createChannels();
 
     if(nameserver) {
@@ -355,17 +510,26 @@ void Connection::handle_CREATE_CHANNEL()
                 }
                 enqueueTxBody(CMD_DESTROY_CHANNEL);
             }
+            createChannels();
             return;
         }
         creatingByCID.erase(it);
     }
     chan->statRx += rxlen;
 
+    createChannels();
+
     if(!sts.isSuccess()) {
         // server refuses to create a channel, but presumably responded positively to search
 
+        if(chan->hinted) {
+            chan->hinted = false;
+            if(context->nameCache)
+                context->nameCache->forget(chan->name);
+        }
+
         chan->state = Channel::Searching;
-        context->searchBuckets[context->currentBucket].push_back(chan);
+        context->searchAfter(chan.get(), 0u);
 
         log_warn_printf(io, "Server %s refuses channel to '%s' : %s\n", peerName.c_str(),
                         chan->name.c_str(), sts.msg.c_str());
@@ -373,6 +537,10 @@ void Connection::handle_CREATE_CHANNEL()
     } else {
         chan->state = Channel::Active;
         chan->sid = sid;
+        chan->hinted = false;
+
+        if(context->nameCache && !chan->forcedServer)
+            context->nameCache->learn(chan->name, chan->guid, chan->replyAddr);
 
         chanBySID[sid] = chan;
 
@@ -424,6 +592,22 @@ void Connection::handle_DESTROY_CHANNEL()
                      peerName.c_str(), chan->name.c_str(), unsigned(cid), unsigned(sid));
 }
 
+void Connection::handle_ECHO()
+{
+    // reply to our keep-alive ping.  Also a round trip time sample.
+    if(!echoPending)
+        return;
+    echoPending = false;
+
+    double sample = epicsTime::getCurrent() - echoSent;
+    if(sample < 0.0)
+        return;
+
+    rtt = rtt>0.0 ? 0.875*rtt + 0.125*sample : sample;
+
+    log_debug_printf(io, "Server %s RTT %.6f avg %.6f\n", peerName.c_str(), sample, rtt);
+}
+
 void Connection::handle_MESSAGE()
 {
     EvInBuf M(peerBE, segBuf.get(), 16);
@@ -463,9 +647,6 @@ void Connection::tickEcho()
     if(state==Holdoff) {
         log_debug_printf(io, "Server %s holdoff expires\n", peerName.c_str());
 
-        if(event_del(echoTimer.get()))
-            log_err_printf(io, "Server %s error Disabling echoTimer\n", peerName.c_str());
-
         startConnecting();
 
     } else {
@@ -478,19 +659,17 @@ void Connection::tickEcho()
 
         to_evbuf(tx, Header{CMD_ECHO, 0u, 0u}, sendBE);
 
+        if(!echoPending) {
+            echoSent = epicsTime::getCurrent();
+            echoPending = true;
+        }
+
         // maybe help reduce latency
         bufferevent_flush(bev.get(), EV_WRITE, BEV_FLUSH);
 
         statTx += 8;
-    }
-}
 
-void Connection::tickEchoS(evutil_socket_t fd, short evt, void *raw)
-{
-    try {
-        static_cast<Connection*>(raw)->tickEcho();
-    }catch(std::exception& e){
-        log_exc_printf(io, "Unhandled error in echo timer callback: %s\n", e.what());
+        echoTimer.start(echoPeriod);
     }
 }
 
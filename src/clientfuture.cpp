@@ -0,0 +1,214 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <epicsEvent.h>
+#include <epicsGuard.h>
+
+#include <pvxs/log.h>
+#include "utilpvt.h"
+#include "clientimpl.h"
+
+namespace pvxs {
+namespace client {
+
+DEFINE_LOGGER(setup, "pvxs.client.setup");
+
+typedef epicsGuard<epicsMutex> Guard;
+
+struct Future::Pvt {
+    epicsMutex lock;
+    // guarded by lock
+    bool complete = false;
+    Result result;
+    std::vector<std::function<void(const Result&)>> continuations;
+    // only allocated by wait() before completion
+    std::shared_ptr<epicsEvent> waiter;
+    // for whenAll()
+    size_t nremain = 0u;
+
+    // keep alive underlying operation or inputs.  Only references toward inputs,
+    // as completion callbacks hold weak references to dependents.
+    std::shared_ptr<Operation> op;
+    std::vector<std::shared_ptr<Pvt>> inputs;
+
+    static
+    const std::shared_ptr<Pvt>& of(const Future& fut)
+    {
+        if(!fut.pvt)
+            throw std::logic_error("Empty Future");
+        return fut.pvt;
+    }
+
+    void finish(Result&& res)
+    {
+        decltype (continuations) conts;
+        std::shared_ptr<epicsEvent> evt;
+        {
+            Guard G(lock);
+            if(complete)
+                return; // eg. whenAny()
+            complete = true;
+            result = std::move(res);
+            conts = std::move(continuations);
+            evt = waiter;
+        }
+        if(evt)
+            evt->signal();
+        // result is no longer modified
+        for(auto& cont : conts) {
+            try {
+                cont(result);
+            }catch(std::exception& e){
+                log_exc_printf(setup, "Unhandled exception in Future continuation: %s\n", e.what());
+            }
+        }
+    }
+
+    void onComplete(std::function<void(const Result&)>&& fn)
+    {
+        {
+            Guard G(lock);
+            if(!complete) {
+                continuations.push_back(std::move(fn));
+                return;
+            }
+        }
+        fn(result);
+    }
+};
+
+bool Future::ready() const
+{
+    auto& P = Pvt::of(*this);
+    Guard G(P->lock);
+    return P->complete;
+}
+
+Result Future::wait(double timeout) const
+{
+    auto& P = Pvt::of(*this);
+    std::shared_ptr<epicsEvent> evt;
+    {
+        Guard G(P->lock);
+        if(P->complete)
+            return P->result;
+        if(!P->waiter)
+            P->waiter = std::make_shared<epicsEvent>();
+        evt = P->waiter;
+    }
+
+    if(!evt->wait(timeout))
+        throw Timeout();
+    // wake any other waiters
+    evt->signal();
+
+    Guard G(P->lock);
+    assert(P->complete);
+    return P->result;
+}
+
+Future Future::then(std::function<Value(Result&&)>&& fn) const
+{
+    auto& P = Pvt::of(*this);
+
+    auto next(std::make_shared<Pvt>());
+    next->inputs.push_back(P);
+    std::weak_ptr<Pvt> wnext(next);
+
+    P->onComplete(std::bind([wnext](std::function<Value(Result&&)>& fn, const Result& result) {
+                      auto next(wnext.lock());
+                      if(!next)
+                          return; // no longer interested
+                      Result input(result);
+                      auto peer(input.peerName());
+                      Result output;
+                      try {
+                          output = Result(fn(std::move(input)), peer);
+                      } catch(...) {
+                          output = Result(std::current_exception());
+                      }
+                      next->finish(std::move(output));
+                  }, std::move(fn), std::placeholders::_1));
+
+    return Future(next);
+}
+
+Future whenAll(const std::vector<Future>& futures)
+{
+    auto all(std::make_shared<Future::Pvt>());
+    all->inputs.reserve(futures.size());
+    for(auto& fut : futures)
+        all->inputs.push_back(Future::Pvt::of(fut));
+    all->nremain = futures.size();
+
+    if(futures.empty()) {
+        all->finish(Result(Value(), std::string()));
+        return Future(all);
+    }
+
+    std::weak_ptr<Future::Pvt> wall(all);
+    for(auto& input : all->inputs) {
+        input->onComplete([wall](const Result&) {
+            auto all(wall.lock());
+            if(!all)
+                return;
+            {
+                Guard G(all->lock);
+                if(--all->nremain)
+                    return;
+            }
+            all->finish(Result(Value(), std::string()));
+        });
+    }
+
+    return Future(all);
+}
+
+Future whenAny(const std::vector<Future>& futures)
+{
+    if(futures.empty())
+        throw std::logic_error("whenAny() requires at least one Future");
+
+    auto any(std::make_shared<Future::Pvt>());
+    any->inputs.reserve(futures.size());
+    for(auto& fut : futures)
+        any->inputs.push_back(Future::Pvt::of(fut));
+
+    std::weak_ptr<Future::Pvt> wany(any);
+    for(auto& input : any->inputs) {
+        input->onComplete([wany](const Result& result) {
+            if(auto any = wany.lock())
+                any->finish(Result(result));
+        });
+    }
+
+    return Future(any);
+}
+
+namespace {
+template<typename Builder>
+Future execAsFuture(Builder& builder)
+{
+    auto fut(std::make_shared<Future::Pvt>());
+    std::weak_ptr<Future::Pvt> wfut(fut);
+
+    auto op(builder.result([wfut](Result&& result) {
+                       if(auto fut = wfut.lock())
+                           fut->finish(std::move(result));
+                   }).exec());
+
+    Guard G(fut->lock);
+    fut->op = std::move(op);
+    return Future(fut);
+}
+} // namespace
+
+Future GetBuilder::execFuture() { return execAsFuture(*this); }
+Future PutBuilder::execFuture() { return execAsFuture(*this); }
+Future RPCBuilder::execFuture() { return execAsFuture(*this); }
+
+} // namespace client
+} // namespace pvxs
@@ -3,7 +3,12 @@
  * pvxs is distributed subject to a Software License Agreement found
  * in file LICENSE that is included with this distribution.
  */
+#include <algorithm>
+#include <deque>
+#include <map>
+
 #include <epicsAssert.h>
+#include <epicsGuard.h>
 
 #include <pvxs/log.h>
 #include <pvxs/nt.h>
@@ -16,6 +21,8 @@ namespace client {
 DEFINE_LOGGER(setup, "pvxs.client.setup");
 DEFINE_LOGGER(io, "pvxs.client.io");
 
+typedef epicsGuard<epicsMutex> Guard;
+
 namespace detail {
 
 struct PRBase::Args
@@ -32,7 +39,7 @@ struct PRBase::Args
             if(auto fld = ret[pair.first]) {
                 try {
                     auto store = Value::Helper::store(pair.second.first);
-                    fld.copyIn(static_cast<const void*>(&store->store), store->code);
+                    Value::Helper::copyIn(fld, store.get());
                 }catch(NoConvert& e){
                     if(pair.second.second)
                         throw;
@@ -107,6 +114,29 @@ void PRBase::_set(const std::string& name, const void *ptr, StoreType type, bool
 
 namespace {
 
+// cf. Channel::typeHints
+Value findTypeHint(const Channel& chan, uint8_t op, const Value& pvRequest)
+{
+    for(auto& hint : chan.typeHints) {
+        if(hint.op==op && hint.pvRequest.equalType(pvRequest))
+            return hint.prototype;
+    }
+    return Value();
+}
+
+void saveTypeHint(Channel& chan, uint8_t op, const Value& pvRequest, const Value& prototype)
+{
+    for(auto& hint : chan.typeHints) {
+        if(hint.op==op && hint.pvRequest.equalType(pvRequest)) {
+            hint.prototype = prototype.cloneEmpty();
+            return;
+        }
+    }
+    if(chan.typeHints.size() >= Channel::maxTypeHints)
+        chan.typeHints.erase(chan.typeHints.begin()); // forget oldest
+    chan.typeHints.push_back(Channel::TypeHint{uint8_t(op), pvRequest, prototype.cloneEmpty()});
+}
+
 struct GPROp : public OperationBase
 {
     std::weak_ptr<GPROp> internal_self;
@@ -114,11 +144,30 @@ struct GPROp : public OperationBase
     std::function<Value(Value&&)> builder;
     std::function<void(Result&&)> done;
     std::function<void (const Value&)> onInit;
+    // with CommonBuilder::executor()
+    std::shared_ptr<SerialExecutor> serial;
     Value pvRequest;
     Value arg;
     Result result;
     bool getOput = false;
     bool autoExec = true;
+    // EXEC sent, with a type from Channel::typeHints, before the INIT reply.  cf. pva_qos::EarlyExec
+    bool initPending = false;
+    // INIT reply type differs from the guess, so expect the early PUT EXEC to be rejected, then resend
+    bool retryExec = false;
+    // when EXEC was sent.  cf. LatencyHistogram::now()
+    uint64_t execSent = 0u;
+
+    // reExecGet() of Get, or reExecPut() of Put, in order.  The first nExecSent have been sent.
+    struct QueuedExec {
+        std::function<void(Result&&)> cb;
+        uint64_t sent;
+        Value val; // PUT value
+    };
+    std::deque<QueuedExec> execQueue;
+    size_t nExecSent = 0u;
+    // max. EXECs in flight.  cf. GetBuilder::execPipeline() and PutBuilder::execPipeline()
+    size_t execDepth = 1u;
 
     enum state_t : uint8_t {
         Connecting, // waiting for an active Channel
@@ -172,11 +221,13 @@ struct GPROp : public OperationBase
     {
         decltype (done) junk;
         decltype (onInit) junkI;
+        decltype (execQueue) junkQ;
         bool ret = false;
-        (void)loop.tryCall([this, &junk, &junkI, &ret](){
+        (void)loop.tryCall([this, &junk, &junkI, &junkQ, &ret](){
             ret = _cancel(false);
             junk = std::move(done);
             junkI = std::move(onInit);
+            junkQ = std::move(execQueue);
             // leave opByIOID for GC
         });
         return ret;
@@ -210,7 +261,16 @@ struct GPROp : public OperationBase
         loop.dispatch([self, a, cb, put]() mutable {
             if(self->autoExec) {
                 client::Result ret(std::make_exception_ptr(std::invalid_argument("reExec() requires Operation creation with .autoExec(false)")));
-                cb(std::move(ret));
+                if(cb)
+                    cb(std::move(ret));
+                return;
+            }
+            if((!put && self->op==Get) || (put && self->op==Put)) {
+                // queued, and sent once INIT completes
+                if(self->state!=Done) {
+                    self->execQueue.push_back(QueuedExec{std::move(cb), 0u, std::move(a)});
+                    self->_pumpExec();
+                }
                 return;
             }
             if(self->state!=Idle)
@@ -218,13 +278,6 @@ struct GPROp : public OperationBase
 
             if(self->op==RPC) {
                 self->arg = std::move(a);
-
-            } else if(put && self->op==Put) {
-                self->builder = [a](Value&&) noexcept -> Value {
-                    // caller should be passing a Value of the correct prototype
-                    // given through onInit().
-                    return a;
-                };
             }
             self->done = std::move(cb);
 
@@ -237,7 +290,7 @@ struct GPROp : public OperationBase
         if(op!=Get && op!=Put)
             throw std::logic_error("reExecGet() only meaningful for .get() and .put()");
 
-        _reExecImpl(false, Value(), std::move(resultcb));
+        _reExecImpl(false, Value(), viaExecutor(serial, std::move(resultcb)));
     }
     void _reExecPut(const Value& arg, std::function<void(client::Result&&)>&& resultcb) override final
     {
@@ -247,7 +300,7 @@ struct GPROp : public OperationBase
         } else if(!arg) {
             throw std::invalid_argument("reExecPut() Put requires Value");
         }
-        _reExecImpl(true, arg, std::move(resultcb));
+        _reExecImpl(true, arg, viaExecutor(serial, std::move(resultcb)));
     }
 
     void _reExec(bool put)
@@ -265,6 +318,40 @@ struct GPROp : public OperationBase
         sendReply();
     }
 
+    // send queued Get/Put EXECs, with at most execDepth awaiting reply
+    void _pumpExec()
+    {
+        while((state==Idle || state==Exec) && nExecSent < execQueue.size() && nExecSent < execDepth) {
+            auto& ent = execQueue[nExecSent++];
+            if(op==Put) {
+                auto val(std::move(ent.val));
+                builder = [val](Value&&) noexcept -> Value {
+                    // caller should be passing a Value of the correct prototype
+                    // given through onInit().
+                    return val;
+                };
+                state = GPROp::BuildPut;
+            } else {
+                state = GPROp::Exec;
+            }
+            sendReply();
+            ent.sent = execSent;
+        }
+    }
+
+    // reply to EXEC when !autoExec
+    void _execDone()
+    {
+        if(nExecSent) {
+            done = std::move(execQueue.front().cb);
+            execQueue.pop_front();
+            nExecSent--;
+        }
+        state = nExecSent ? GPROp::Exec : GPROp::Idle;
+        notify();
+        _pumpExec();
+    }
+
     void sendReply()
     {
         Value temp;
@@ -294,18 +381,22 @@ struct GPROp : public OperationBase
 
             to_wire(R, chan->sid);
             to_wire(R, ioid);
+            // 0x04 pvxs extension, EXEC before INIT reply.  cf. pva_qos::EarlyExec
+            const uint8_t early = initPending ? 0x04 : 0x00;
             if(state==GPROp::GetOPut) {
-                to_wire(R, uint8_t(0x40));
+                to_wire(R, uint8_t(0x40|early));
 
             } else if(state==GPROp::Exec) {
-                to_wire(R, uint8_t(0x00));
+                to_wire(R, uint8_t(0x00|early));
                 if(op==Put) {
-                    to_wire_valid(R, temp);
+                    if(early)
+                        to_wire(R, Value::Helper::desc(temp), conn->txTypes);
+                    to_wire_valid(R, temp, nullptr, &conn->txTypes);
 
                 } else if(op==RPC) {
-                    to_wire(R, Value::Helper::desc(arg));
+                    to_wire(R, Value::Helper::desc(arg), conn->txTypes);
                     if(arg)
-                        to_wire_full(R, arg);
+                        to_wire_full(R, arg, &conn->txTypes);
                 }
 
             } else if(state==GPROp::Done) {
@@ -318,6 +409,9 @@ struct GPROp : public OperationBase
         }
         chan->statTx += chan->conn->enqueueTxBody(state==GPROp::Done ? CMD_DESTROY_REQUEST :  (pva_app_msg_t)op);
 
+        if(state==GPROp::Exec)
+            execSent = LatencyHistogram::now();
+
         if(state==GPROp::Done) {
             // CMD_DESTROY_REQUEST is not acknowledged (sigh...)
             // but at this point a server should not send further GET/PUT/RPC w/ this IOID
@@ -346,7 +440,7 @@ struct GPROp : public OperationBase
             to_wire(R, chan->sid);
             to_wire(R, ioid);
             to_wire(R, uint8_t(0x08)); // INIT
-            to_wire(R, Value::Helper::desc(pvRequest));
+            to_wire(R, Value::Helper::desc(pvRequest), conn->txTypes);
             to_wire_full(R, pvRequest);
         }
         chan->statTx += conn->enqueueTxBody(pva_app_msg_t(uint8_t(op)));
@@ -355,6 +449,17 @@ struct GPROp : public OperationBase
                          conn->peerName.c_str(), chan->name.c_str(), op);
 
         state = Creating;
+
+        // With the type learned by an earlier operation, send EXEC now instead of after the INIT reply.
+        if(autoExec && !onInit && op!=RPC && conn->peerEarlyExec) {
+            if(auto hint = findTypeHint(*chan, op, pvRequest)) {
+                log_debug_printf(io, "Server %s channel '%s' op%02x early EXEC\n",
+                                 conn->peerName.c_str(), chan->name.c_str(), op);
+                initPending = true;
+                arg = hint.cloneEmpty();
+                _reExec(!getOput);
+            }
+        }
     }
 
     virtual void disconnected(const std::shared_ptr<OperationBase> &self) override final
@@ -365,15 +470,28 @@ struct GPROp : public OperationBase
         } else if(state==Exec && op!=Get && !autoExec) {
             // can't restart as server side-effects may occur
             state = Done;
-            result = Result(std::make_exception_ptr(Disconnect()));
 
-            notify();
+            // fail all pipelined PUTs, sent or not
+            auto queue(std::move(execQueue));
+            nExecSent = 0u;
+            if(queue.empty()) {
+                result = Result(std::make_exception_ptr(Disconnect()), Event::Disconnect);
+                notify();
+            }
+            for(auto& ent : queue) {
+                done = std::move(ent.cb);
+                result = Result(std::make_exception_ptr(Disconnect()), Event::Disconnect);
+                notify();
+            }
 
         } else if(state==Creating || state==Idle || state==GetOPut || state==Exec) {
             // return to pending
 
             chan->pending.push_back(self);
             state = Connecting;
+            // queued Get EXECs are re-sent after INIT
+            nExecSent = 0u;
+            initPending = retryExec = false;
 
         } else {
             state = Done;
@@ -445,7 +563,7 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
 
             data = info->prototype.cloneEmpty();
             if(data)
-                from_wire_valid(M, rxRegistry, data);
+                from_wire_valid(M, rxRegistry, data, context->getArrays.get());
         }
     }
 
@@ -470,7 +588,7 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
             gpr = static_cast<GPROp*>(op.get());
 
             // check that subcmd is as expected based on operation state
-            if((gpr->state==GPROp::Creating) && init) {
+            if((gpr->state==GPROp::Creating || gpr->initPending) && init) {
 
             } else if((gpr->state==GPROp::GetOPut) && !init && get) {
 
@@ -495,15 +613,43 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
 
     decltype (gpr->state) prev = gpr->state;
 
-    if(!sts.isSuccess()) {
-        gpr->result = Result(std::make_exception_ptr(RemoteError(sts.msg)));
+    if(prev==GPROp::Exec && !init) {
+        auto& latency = gpr->chan->context->latency;
+        auto& hist = cmd==CMD_GET ? latency.get : cmd==CMD_PUT ? latency.put : latency.rpc;
+        hist.add(gpr->nExecSent ? gpr->execQueue.front().sent : gpr->execSent);
+    }
+
+    if(!sts.isSuccess() && gpr->retryExec && !init && prev==GPROp::Exec) {
+        // early PUT EXEC rejected, as expected.  Build again with the actual type.
+        gpr->retryExec = false;
+        gpr->state = GPROp::BuildPut;
+
+    } else if(!sts.isSuccess()) {
+        gpr->result = Result(std::make_exception_ptr(RemoteError(sts.msg)), Event::RemoteError);
         gpr->state = gpr->state==GPROp::Creating || gpr->autoExec ? GPROp::Done : GPROp::Idle;
 
+        if(prev==GPROp::Exec && gpr->state==GPROp::Idle) {
+            gpr->_execDone();
+            return;
+        }
+
+    } else if(init && gpr->initPending) {
+        // reply to INIT after early EXEC, or GET of PUT, was sent
+        gpr->initPending = false;
+        saveTypeHint(*gpr->chan, cmd, gpr->pvRequest, data);
+
+        if(cmd==CMD_PUT && prev==GPROp::Exec && !gpr->arg.equalType(data))
+            gpr->retryExec = true;
+        gpr->arg = data; // save for later use in sendReply()
+        return;
+
     } else if(gpr->state==GPROp::Creating) {
 
         gpr->state = GPROp::Idle;
-        if(cmd==CMD_PUT || cmd==CMD_GET)
+        if(cmd==CMD_PUT || cmd==CMD_GET) {
             gpr->arg = data; // save for later use in sendReply()
+            saveTypeHint(*gpr->chan, cmd, gpr->pvRequest, data);
+        }
 
         try {
             if(gpr->onInit)
@@ -518,6 +664,8 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
 
         if(gpr->state==GPROp::Idle && gpr->autoExec)
             gpr->_reExec(!gpr->getOput);
+        else if(gpr->state==GPROp::Idle)
+            gpr->_pumpExec();
         // reply may now be sent, or deferred
         return;
 
@@ -531,6 +679,8 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
             gpr->state = GPROp::Idle;
             gpr->result = Result(std::move(data), peerName);
             gpr->notify();
+            // then any PUTs queued meanwhile
+            gpr->_pumpExec();
             return;
         }
 
@@ -541,8 +691,7 @@ void Connection::handle_GPR(pva_app_msg_t cmd)
         gpr->result = Result(std::move(data), peerName);
 
         if(!gpr->autoExec) {
-            gpr->state = GPROp::Idle;
-            gpr->notify();
+            gpr->_execDone();
             return;
         }
         gpr->state = GPROp::Done;
@@ -567,7 +716,9 @@ std::shared_ptr<Operation> gpr_setup(const std::shared_ptr<ContextImpl>& context
                                      const std::string& name,
                                      const std::string& server,
                                      std::shared_ptr<GPROp>&& op,
-                                     bool syncCancel)
+                                     bool syncCancel,
+                                     bool bulk,
+                                     unsigned prio)
 {
     auto internal(std::move(op));
     internal->internal_self = internal;
@@ -587,10 +738,10 @@ std::shared_ptr<Operation> gpr_setup(const std::shared_ptr<ContextImpl>& context
                        }, std::move(temp)));
     });
 
-    context->tcp_loop.dispatch([internal, context, name, server]() {
+    context->tcp_loop.dispatch([internal, context, name, server, bulk, prio]() {
         // on worker
 
-        internal->chan = Channel::build(context, name, server);
+        internal->chan = Channel::build(context, name, server, bulk, prio);
 
         internal->chan->pending.push_back(internal);
         internal->chan->createOperations();
@@ -599,20 +750,218 @@ std::shared_ptr<Operation> gpr_setup(const std::shared_ptr<ContextImpl>& context
     return external;
 }
 
+namespace {
+
+// results of all operations of one Context::getMany()
+struct GetMany {
+    epicsMutex lock;
+    std::vector<Result> results;
+    size_t nremain;
+    std::function<void(std::vector<Result>&&)> done;
+    ResultWaiter waiter;
+
+    GetMany(size_t n, std::function<void(std::vector<Result>&&)>&& done)
+        :results(n)
+        ,nremain(n)
+        ,done(std::move(done))
+    {}
+
+    void complete(size_t idx, Result&& result)
+    {
+        {
+            Guard G(lock);
+            results[idx] = std::move(result);
+            if(--nremain)
+                return;
+        }
+        finish();
+    }
+
+    void finish()
+    {
+        decltype (done) cb;
+        decltype (results) res;
+        {
+            Guard G(lock);
+            cb = std::move(done);
+            res = std::move(results);
+        }
+        try {
+            if(cb)
+                cb(std::move(res));
+        } catch(...) {
+            waiter.complete(Result(), false);
+            throw;
+        }
+        waiter.complete(Result(), false);
+    }
+};
+
+struct GetManyOp : public Operation
+{
+    const std::string firstName;
+    const std::shared_ptr<GetMany> many;
+    // operations grouped by client worker
+    struct Shard {
+        evbase loop;
+        std::vector<std::shared_ptr<GPROp>> ops;
+    };
+    std::vector<Shard> shards;
+
+    GetManyOp(const std::string& firstName, const std::shared_ptr<GetMany>& many)
+        :Operation(Get)
+        ,firstName(firstName)
+        ,many(many)
+    {}
+    virtual ~GetManyOp() {
+        for(auto& shard : shards) {
+            auto loop(shard.loop);
+            // move internal refs to worker for dtor
+            loop.tryInvoke(true, std::bind([](std::vector<std::shared_ptr<GPROp>>& ops) {
+                               for(auto& op : ops) {
+                                   assert(op->chan);
+                                   op->_cancel(true);
+                               }
+                               ops.clear();
+                           }, std::move(shard.ops)));
+        }
+    }
+
+    virtual const std::string& name() override final { return firstName; }
+
+    virtual bool cancel() override final
+    {
+        bool ret = false;
+        for(auto& shard : shards) {
+            (void)shard.loop.tryCall([&shard, &ret](){
+                for(auto& op : shard.ops) {
+                    ret |= op->_cancel(false);
+                    op->done = nullptr;
+                }
+            });
+        }
+        return ret;
+    }
+
+    virtual Value wait(double timeout) override final
+    {
+        return many->waiter.wait(timeout);
+    }
+
+    virtual void interrupt() override final
+    {
+        many->waiter.complete(Result(), true);
+    }
+
+    virtual void _reExecGet(std::function<void(client::Result&&)>&& resultcb) override final
+    {
+        throw std::logic_error("reExecGet() not possible for getMany()");
+    }
+    virtual void _reExecPut(const Value& arg, std::function<void(client::Result&&)>&& resultcb) override final
+    {
+        throw std::logic_error("reExecPut() not possible for getMany()");
+    }
+};
+
+} // namespace
+
+std::shared_ptr<Operation> Context::getMany(const std::vector<std::string>& names,
+                                            std::function<void(std::vector<Result>&&)>&& done,
+                                            const std::string& request)
+{
+    if(!pvt)
+        throw std::logic_error("NULL Context");
+
+    Value pvRequest;
+    {
+        GetBuilder builder(pvt, std::string(), true);
+        if(!request.empty())
+            builder.pvRequest(request);
+        pvRequest = builder._buildReq();
+    }
+
+    auto many(std::make_shared<GetMany>(names.size(), std::move(done)));
+    std::shared_ptr<GetManyOp> ret(new GetManyOp(names.empty() ? std::string() : names.front(), many));
+
+    if(names.empty()) {
+        many->finish();
+        return ret;
+    }
+
+    // Group by client worker.  All operations of a worker are created by one
+    // callback, so INIT requests to each server are sent as one burst.
+    std::map<ContextImpl*, size_t> shardIdx;
+    std::vector<std::shared_ptr<ContextImpl>> contexts;
+    std::vector<std::vector<std::string>> shardNames;
+
+    for(auto i : range(names.size())) {
+        auto& context = pvt->shardFor(names[i]);
+
+        auto it(shardIdx.find(context.get()));
+        if(it==shardIdx.end()) {
+            it = shardIdx.emplace(context.get(), contexts.size()).first;
+            contexts.push_back(context);
+            shardNames.emplace_back();
+            ret->shards.push_back(GetManyOp::Shard{context->tcp_loop, {}});
+        }
+
+        auto op(impl::allocateOp<GPROp>(context->opSlab, Operation::Get, context->tcp_loop));
+        op->internal_self = op;
+        op->setDone([many, i](Result&& result) {
+            many->complete(i, std::move(result));
+        }, nullptr);
+        op->pvRequest = pvRequest;
+
+        ret->shards[it->second].ops.push_back(op);
+        shardNames[it->second].push_back(names[i]);
+    }
+
+    for(auto i : range(contexts.size())) {
+        auto& context = contexts[i];
+        context->tcp_loop.dispatch(std::bind([context](std::vector<std::shared_ptr<GPROp>>& ops,
+                                                       std::vector<std::string>& names) {
+                                       // on worker
+                                       for(auto n : range(ops.size())) {
+                                           ops[n]->chan = Channel::build(context, names[n], std::string());
+                                           ops[n]->chan->pending.push_back(ops[n]);
+                                       }
+                                       for(auto& op : ops) {
+                                           op->chan->createOperations();
+                                       }
+                                   }, ret->shards[i].ops, std::move(shardNames[i])));
+    }
+
+    return ret;
+}
+
+std::vector<Result> Context::getMany(const std::vector<std::string>& names,
+                                     double timeout,
+                                     const std::string& request)
+{
+    std::vector<Result> ret;
+    auto op(getMany(names, [&ret](std::vector<Result>&& results) {
+        ret = std::move(results);
+    }, request));
+    op->wait(timeout);
+    return ret;
+}
+
 std::shared_ptr<Operation> GetBuilder::_exec_get()
 {
     assert(_get);
     if(!ctx)
         throw std::logic_error("NULL Builder");
 
-    auto context(ctx->impl->shared_from_this());
+    auto context(ctx->shardFor(_name));
 
-    auto op(std::make_shared<GPROp>(Operation::Get, context->tcp_loop));
-    op->setDone(std::move(_result), std::move(_onInit));
+    auto op(impl::allocateOp<GPROp>(context->opSlab, Operation::Get, context->tcp_loop));
+    op->serial = SerialExecutor::build(_executor);
+    op->setDone(viaExecutor(op->serial, std::move(_result)), viaExecutor(op->serial, std::move(_onInit)));
     op->autoExec = _autoexec;
+    op->execDepth = std::max(1u, _execDepth);
     op->pvRequest = _buildReq();
 
-    return gpr_setup(context, _name, _server, std::move(op), _syncCancel);
+    return gpr_setup(context, _name, _server, std::move(op), _syncCancel, _bulk, _prio);
 }
 
 std::shared_ptr<Operation> PutBuilder::exec()
@@ -620,10 +969,11 @@ std::shared_ptr<Operation> PutBuilder::exec()
     if(!ctx)
         throw std::logic_error("NULL Builder");
 
-    auto context(ctx->impl->shared_from_this());
+    auto context(ctx->shardFor(_name));
 
-    auto op(std::make_shared<GPROp>(Operation::Put, context->tcp_loop));
-    op->setDone(std::move(_result), std::move(_onInit));
+    auto op(impl::allocateOp<GPROp>(context->opSlab, Operation::Put, context->tcp_loop));
+    op->serial = SerialExecutor::build(_executor);
+    op->setDone(viaExecutor(op->serial, std::move(_result)), viaExecutor(op->serial, std::move(_onInit)));
 
     if(_builder) {
         op->builder = std::move(_builder);
@@ -640,22 +990,25 @@ std::shared_ptr<Operation> PutBuilder::exec()
     }
     op->getOput = _doGet;
     op->autoExec = _autoexec;
+    op->execDepth = std::max(1u, _execDepth);
     op->pvRequest = _buildReq();
 
-    return gpr_setup(context, _name, _server, std::move(op), _syncCancel);
+    return gpr_setup(context, _name, _server, std::move(op), _syncCancel, _bulk, _prio);
 }
 
 std::shared_ptr<Operation> RPCBuilder::exec()
 {
     if(!ctx)
         throw std::logic_error("NULL Builder");
+    if(_chunk)
+        return _exec_stream();
     if(!_autoexec)
         throw std::logic_error("autoExec(false) not possible for rpc()");
 
-    auto context(ctx->impl->shared_from_this());
+    auto context(ctx->shardFor(_name));
 
-    auto op(std::make_shared<GPROp>(Operation::RPC, context->tcp_loop));
-    op->setDone(std::move(_result), nullptr);
+    auto op(impl::allocateOp<GPROp>(context->opSlab, Operation::RPC, context->tcp_loop));
+    op->setDone(viaExecutor(SerialExecutor::build(_executor), std::move(_result)), nullptr);
     if(_argument) {
         if(!_autoexec)
             throw std::invalid_argument("Pass RPC argument during reExec()");
@@ -667,7 +1020,7 @@ std::shared_ptr<Operation> RPCBuilder::exec()
     op->autoExec = _autoexec;
     op->pvRequest = _buildReq();
 
-    return gpr_setup(context, _name, _server, std::move(op), _syncCancel);
+    return gpr_setup(context, _name, _server, std::move(op), _syncCancel, _bulk, _prio);
 }
 
 } // namespace client
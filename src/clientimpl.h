@@ -6,7 +6,13 @@
 #ifndef CLIENTIMPL_H
 #define CLIENTIMPL_H
 
+#include <deque>
 #include <list>
+#include <map>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 #include <epicsTime.h>
 #include <epicsEvent.h>
@@ -19,12 +25,63 @@
 #include "utilpvt.h"
 #include "udp_collector.h"
 #include "conn.h"
+#include "opslab.h"
 
 namespace pvxs {
 namespace client {
 
 struct Channel;
 struct ContextImpl;
+struct SharedMonitor;
+
+/** Lists of Channels waiting for a search reply.  One list for each bucket of the search ring,
+ *  plus the initial list and a work list for the bucket being sent.
+ *  Urgent Channels have a ring and lists of their own.
+ *
+ *  Each Channel is a member of at most one list.  Lists are linked through indices
+ *  into one vector of nodes, so walking a bucket doesn't chase list nodes around the heap,
+ *  or lock a weak_ptr for each Channel.  A Channel knows its node (Channel::searchIdx),
+ *  and must remove() itself before being destroyed.
+ *
+ *  Only accessed from the TCP worker of a ContextImpl.
+ */
+struct SearchSched {
+    static constexpr uint32_t none = 0xffffffffu;
+
+    struct Node {
+        Channel* chan;
+        uint32_t prev, next;
+        uint32_t list;
+    };
+
+    explicit SearchSched(size_t nlists);
+
+    //! Append to list, first removing from any current list
+    void insert(Channel* chan, size_t list);
+    //! remove from current list, if any
+    void remove(Channel* chan);
+    //! Append all members of one list to another
+    void splice(size_t from, size_t to);
+
+    inline uint32_t head(size_t list) const { return lists[list].head; }
+    inline const Node& node(uint32_t idx) const { return nodes[idx]; }
+    inline size_t size(size_t list) const { return lists[list].count; }
+    //! Total number of Channels in all lists
+    inline size_t size() const { return nodes.size() - nfree; }
+
+private:
+    struct List {
+        uint32_t head = none, tail = none;
+        size_t count = 0u;
+    };
+    std::vector<Node> nodes;
+    std::vector<List> lists;
+    uint32_t freeHead = none;
+    size_t nfree = 0u;
+
+    void unlink(uint32_t idx);
+    void link(uint32_t idx, size_t list);
+};
 
 struct ResultWaiter {
     epicsMutex lock;
@@ -40,6 +97,36 @@ struct ResultWaiter {
     void complete(Result&& result, bool interrupt);
 };
 
+// Hands off the callbacks of one operation to a user Executor.
+// In order, and one batch at a time.
+struct SerialExecutor : public std::enable_shared_from_this<SerialExecutor> {
+    const Executor exec;
+    epicsMutex lock;
+    // guarded by lock
+    std::deque<std::function<void()>> pending;
+    bool scheduled = false;
+
+    explicit SerialExecutor(const Executor& exec) :exec(exec) {}
+    // nullptr if exec is empty
+    static
+    std::shared_ptr<SerialExecutor> build(const Executor& exec) {
+        return exec ? std::make_shared<SerialExecutor>(exec) : nullptr;
+    }
+
+    void post(std::function<void()>&& fn);
+private:
+    void submit();
+    void drain();
+};
+
+// Wrap callbacks to be run through serial, if not nullptr.
+std::function<void(Result&&)> viaExecutor(const std::shared_ptr<SerialExecutor>& serial,
+                                          std::function<void(Result&&)>&& cb);
+std::function<void(const Value&)> viaExecutor(const std::shared_ptr<SerialExecutor>& serial,
+                                              std::function<void(const Value&)>&& cb);
+std::function<void(Value&&)> viaExecutor(const std::shared_ptr<SerialExecutor>& serial,
+                                         std::function<void(Value&&)>&& cb);
+
 // internal actions on an Operation
 struct OperationBase : public Operation
 {
@@ -56,6 +143,8 @@ struct OperationBase : public Operation
 
     virtual void createOp() =0;
     virtual void disconnected(const std::shared_ptr<OperationBase>& self) =0;
+    // for subscriptions, approximate bytes of queued updates.  Call from loop worker.
+    virtual size_t queueBytes() const { return 0u; }
 
     virtual const std::string& name() override final;
     virtual Value wait(double timeout=-1.0) override final;
@@ -66,8 +155,25 @@ struct RequestFL {
     const size_t limit;
     epicsMutex lock;
     std::vector<Value> unused;
-
-    explicit RequestFL(size_t limit) :limit(limit) {}
+    // spare shared_ptr control blocks of Values handed out,
+    // all of size blockSize.  cf. FLAlloc in clientmon.cpp
+    std::vector<void*> blocks;
+    size_t blockSize = 0u;
+    // storage of large arrays.  (has its own lock)
+    const std::shared_ptr<impl::ArrayPool> arrays;
+    // retain received encoding of updates.  cf. MonitorBuilder::passThrough()
+    bool passThrough = false;
+
+    RequestFL(size_t limit, const std::shared_ptr<ArrayAllocator>& alloc)
+        :limit(limit)
+        ,arrays(std::make_shared<impl::ArrayPool>(2u, alloc))
+    {}
+    ~RequestFL() {
+        for(auto blk : blocks)
+            ::operator delete(blk);
+    }
+    RequestFL(const RequestFL&) = delete;
+    RequestFL& operator=(const RequestFL&) = delete;
 };
 
 struct RequestInfo {
@@ -76,6 +182,8 @@ struct RequestInfo {
     const std::weak_ptr<OperationBase> handle;
 
     Value prototype;
+    // flattened type of prototype.  Used to decode MONITOR updates
+    impl::WirePlan plan;
     std::shared_ptr<RequestFL> fl;
 
     RequestInfo(uint32_t sid, uint32_t ioid, std::shared_ptr<OperationBase>& handle);
@@ -83,42 +191,76 @@ struct RequestInfo {
 
 struct Connection final : public ConnBase, public std::enable_shared_from_this<Connection> {
     const std::shared_ptr<ContextImpl> context;
+    // which of the Config::tcpStreams connections to this server
+    const unsigned stream;
 
     // While HoldOff, the time until re-connection
     // While Connected, periodic Echo
-    const evevent echoTimer;
+    WheelTimer echoTimer;
+    // seconds.  set once connected
+    double echoPeriod = 15.0;
+    // seconds.  echoPeriod when peerKeepAlive
+    static constexpr double rttPeriod = 60.0;
 
     bool ready = false;
     bool nameserver = false;
 
+    // round trip time estimate from ECHO replies, in seconds.  Zero until the first reply.
+    double rtt = 0.0;
+    epicsTime echoSent;
+    bool echoPending = false;
+
+    // max. number of CREATE_CHANNEL requests awaiting a reply.
+    // Paces a restarted server, which may be busy while booting.
+    static constexpr size_t maxCreating = 256u;
+    // soft limit on the body size of one multi-channel CREATE_CHANNEL
+    static constexpr size_t maxCreateBody = 16384u;
+    // Server advertised pva_qos::MultiCreate
+    bool peerMultiCreate = false;
+    // Server advertised pva_qos::EarlyExec
+    bool peerEarlyExec = false;
+
     // channels to be created on this Connection in state==Connecting
     std::map<uint32_t, std::weak_ptr<Channel>> pending;
 
-    std::map<uint32_t, std::weak_ptr<Channel>> creatingByCID, // in state==Creating
-                                               chanBySID;     // in state==Active
+    std::unordered_map<uint32_t, std::weak_ptr<Channel>> creatingByCID, // in state==Creating
+                                                         chanBySID;     // in state==Active
 
     // entries always have matching entry in a Channel::opByIOID
-    std::map<uint32_t, RequestInfo> opByIOID;
+    // node based, so Channel::opByIOID may point to entries
+    std::unordered_map<uint32_t, RequestInfo> opByIOID;
 
     uint32_t nextIOID = 0x10002000u;
 
     INST_COUNTER(Connection);
 
+    // with local!=nullptr, first try to reach a Server in this process.  cf. Config::inProcess
     Connection(const std::shared_ptr<ContextImpl>& context,
                const SockAddr &peerAddr,
-               bool reconn);
+               bool reconn,
+               const ServerGUID* local=nullptr,
+               unsigned stream=0u);
     virtual ~Connection();
 
     static
     std::shared_ptr<Connection> build(const std::shared_ptr<ContextImpl>& context,
                                       const SockAddr& serv,
-                                      bool reconn=false);
+                                      bool reconn=false,
+                                      const ServerGUID* local=nullptr,
+                                      unsigned stream=0u);
 
 private:
     void startConnecting();
+    bool connectLocal(const ServerGUID& guid);
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    bool connectUnix();
+#endif
+    // use an already connected bev.  cf. connectLocal() and connectUnix()
+    void connectedLocal(bufferevent* bev);
 public:
 
     void createChannels();
+    void sendCreateChannels(std::vector<std::shared_ptr<Channel>>& batch);
 
     void sendDestroyRequest(uint32_t sid, uint32_t ioid);
 
@@ -128,6 +270,7 @@ public:
     virtual void cleanup() override final;
 
 #define CASE(Op) virtual void handle_##Op() override final;
+    CASE(ECHO);
     CASE(CONNECTION_VALIDATION);
     CASE(CONNECTION_VALIDATED);
 
@@ -148,7 +291,6 @@ public:
     void handle_GPR(pva_app_msg_t cmd);
 protected:
     void tickEcho();
-    static void tickEchoS(evutil_socket_t fd, short evt, void *raw);
 };
 
 struct ConnectImpl final : public Connect
@@ -185,27 +327,60 @@ struct Channel {
         Active,
     } state = Searching;
 
+    // set when found unused by ContextImpl::cacheCleanIdle().  Cleared when re-used by build()
     bool garbage = false;
 
+    // The shared_ptr handed out by build() to operations.  When the last of these is released,
+    // the Channel is queued to ContextImpl::idleChannels.
+    std::weak_ptr<Channel> users;
+
     std::shared_ptr<Connection> conn;
     uint32_t sid = 0u;
 
-    // channel created with .server() to bypass normal search process
-    SockAddr forcedServer;
+    // channel created with .server() to bypass normal search process.
+    // Allocated only in this uncommon case.
+    std::unique_ptr<SockAddr> forcedServer;
+    // with forcedServer, the server string of the ContextImpl::chanByName key
+    std::unique_ptr<const std::string> forcedServerKey;
+
+    // created with .bulk(), so connects through a separate Connection.  cf. ContextImpl::streamFor()
+    bool bulk = false;
+    // connecting to the server from ContextImpl::nameCache, without search.  Cleared when Active.
+    bool hinted = false;
 
+    // built by an operation with priority()>0.  Searched through separate lists,
+    // packed first, and retried more often.  Never cleared.
+    bool urgent = false;
     // when state==Searching, number of repetitions
     size_t nSearch = 0u;
+    // position in ContextImpl::searchSched
+    uint32_t searchIdx = SearchSched::none;
 
     // GUID of last positive reply when state!=Searching
     ServerGUID guid{};
     SockAddr replyAddr;
 
-    std::list<std::weak_ptr<OperationBase>> pending;
+    std::vector<std::weak_ptr<OperationBase>> pending;
 
-    // points to storage of Connection::opByIOID
+    // points to storage of Connection::opByIOID.
+    // Usually only a few entries, so a tree avoids the bucket array of a hash table.
     std::map<uint32_t, RequestInfo*> opByIOID;
 
-    std::list<ConnectImpl*> connectors;
+    std::vector<ConnectImpl*> connectors;
+
+    // type from the latest GET_FIELD reply.  Cleared on disconnect.
+    Value infoCache;
+
+    // prototypes from recent GET/PUT INIT replies, by operation and pvRequest type.
+    // Lets a one-shot operation send EXEC along with INIT.  Kept over reconnect,
+    // as the server will reject an EXEC with a changed type.  cf. pva_qos::EarlyExec
+    struct TypeHint {
+        uint8_t op;
+        Value pvRequest;
+        Value prototype;
+    };
+    std::vector<TypeHint> typeHints;
+    static constexpr size_t maxTypeHints = 4u;
 
     size_t statTx{}, statRx{};
 
@@ -220,7 +395,9 @@ struct Channel {
     static
     std::shared_ptr<Channel> build(const std::shared_ptr<ContextImpl>& context,
                                    const std::string& name,
-                                   const std::string& server);
+                                   const std::string& server,
+                                   bool bulk=false,
+                                   unsigned prio=0u);
 };
 
 struct Discovery final : public OperationBase
@@ -243,6 +420,38 @@ private:
     virtual void disconnected(const std::shared_ptr<OperationBase> &self) override final;
 };
 
+/** PV name to server mapping persisted across Context lifetimes.  cf. Config::nameCacheFile
+ *
+ *  Shared by all ContextImpl of one Context.  Read when created, and written by save().
+ *  File is text with one line for each name: "<name> 0x<GUID hex> <address:port>"
+ */
+struct NameCache {
+    const std::string fname;
+
+    struct Entry {
+        ServerGUID guid{};
+        SockAddr server;
+    };
+
+    epicsMutex lock;
+    // guarded by lock
+    std::unordered_map<std::string, Entry> names;
+    bool dirty = false;
+
+    INST_COUNTER(NameCache);
+
+    //! Read fname if it exists.  Errors are logged.
+    explicit NameCache(const std::string& fname);
+
+    bool lookup(const std::string& name, Entry& out);
+    //! a server has claimed name
+    void learn(const std::string& name, const ServerGUID& guid, const SockAddr& server);
+    //! server of a lookup() refused name
+    void forget(const std::string& name);
+    //! Write to fname if changed.  Errors are logged.
+    void save();
+};
+
 struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
 {
     SockAttach attach;
@@ -277,37 +486,113 @@ struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
 
     // map: endpoint+proto -> Beaconer
     typedef std::pair<SockAddr, std::string> BeaconServer;
+    struct BeaconServerHash {
+        size_t operator()(const BeaconServer& key) const;
+    };
     struct BeaconInfo {
         SockAddr sender;
         ServerGUID guid{};
         uint8_t peerVersion{};
         epicsTimeStamp time{};
+        // beacon tick (monotonic time / beaconCleanInterval) when last seen
+        epicsUInt64 tick = 0u;
     };
-    std::map<BeaconServer, BeaconInfo> beaconTrack;
+    std::unordered_map<BeaconServer, BeaconInfo, BeaconServerHash> beaconTrack;
+    // Timing wheel for beaconTrack expiry.  Slot tick%3 lists keys, and the tick during which each was seen.
+    // May include keys since erased, or seen again in a later tick.
+    std::vector<std::pair<BeaconServer, epicsUInt64>> beaconWheel[3];
+    // last tick for which tickBeaconClean() expired entries
+    epicsUInt64 beaconCleaned = 0u;
 
     std::vector<uint8_t> searchMsg;
+    // search_rx_batch slots of search_rx_slot bytes for received search replies.
+    // Not initialized, so pages are only touched as (large) datagrams arrive.
+    std::unique_ptr<uint8_t[]> searchRx;
+    // search message to name servers, built alongside UDP search packets
+    std::vector<uint8_t> searchMsgTCP;
 
     // search destination address and whether to set the unicast flag
     std::vector<std::pair<SockEndpoint, bool>> searchDest;
 
     size_t currentBucket = 0u;
-    // Channels where we have yet to send out an initial search request
-    std::list<std::weak_ptr<Channel>> initialSearchBucket;
-    // Channels where we are waiting for a search response
-    std::vector<std::list<std::weak_ptr<Channel>>> searchBuckets;
+    // spreads out reconnection of many clients after a server restart.  cf. reconnectJitter()
+    std::minstd_rand prng;
+    // Channels where we are waiting for a search response, in lists [0, nBuckets),
+    // or [nBuckets, 2*nBuckets) when urgent.
+    // Channels where we have yet to send out an initial search request in list initialBucket,
+    // or urgentInitialBucket.
+    SearchSched searchSched;
+    // number of names sent by the latest search tick, and in total
+    size_t searchLastTick = 0u;
+    size_t searchSent = 0u;
+    // number of search datagrams sent
+    size_t searchPackets = 0u;
+
+    // GET, PUT, and RPC round trip times of operations on this TCP worker
+    OpLatencies latency;
+
+    // with Config::arrayAllocator, for GET replies.  Retains no spares.
+    const std::shared_ptr<impl::ArrayPool> getArrays;
+
+    // recycled memory of the operations (and RequestFL) of this context
+    const std::shared_ptr<impl::OpSlab> opSlab{std::make_shared<impl::OpSlab>()};
 
     std::list<std::unique_ptr<UDPListener> > beaconRx;
 
-    std::map<uint32_t, std::weak_ptr<Channel>> chanByCID;
+    std::unordered_map<uint32_t, std::weak_ptr<Channel>> chanByCID;
     // strong ref. loop through Channel::context
     // explicitly broken by Context::close(), Context::cacheClear(), or ContextImpl::cacheClean()
-    // chanByName key'd by (pv, forceServer)
-    std::map<std::pair<std::string, std::string>, std::shared_ptr<Channel>> chanByName;
+    // chanByName key'd by (pv, forceServer).
+    // Stored keys point to Channel::name of the mapped Channel, which outlives its entry,
+    // so that each PV name is stored only once.
+    struct ChanNameKey {
+        const std::string* name;
+        std::string server;
+        bool bulk;
+        ChanNameKey(const std::string& name, const std::string& server, bool bulk=false) :name(&name), server(server), bulk(bulk) {}
+        bool operator==(const ChanNameKey& o) const { return *name==*o.name && server==o.server && bulk==o.bulk; }
+    };
+    struct ChanNameHash {
+        size_t operator()(const ChanNameKey& key) const {
+            std::hash<std::string> H;
+            return H(*key.name) ^ (H(key.server)*31u) ^ size_t(key.bulk);
+        }
+    };
+    std::unordered_map<ChanNameKey, std::shared_ptr<Channel>, ChanNameHash> chanByName;
+
+    // Channels whose last operation was released since the previous cacheCleanIdle().
+    // Appended from any thread.
+    epicsMutex idleLock;
+    std::vector<std::weak_ptr<Channel>> idleChannels; // guarded by idleLock
+    // set if an idle Channel could not be queued.  Forces a full cacheClean()
+    std::atomic<bool> idleLost{false};
+    // Channels found unused by the previous cacheCleanIdle(), to be removed by the next
+    std::vector<std::weak_ptr<Channel>> idleMarked;
 
-    std::map<SockAddr, std::weak_ptr<Connection>> connByAddr;
+    // key'd by server address and Connection::stream
+    std::map<std::pair<SockAddr, unsigned>, std::weak_ptr<Connection>> connByAddr;
 
+    // with Config::shareMonitors.  key'd by (pv, forceServer, pvRequest)
+    typedef std::tuple<std::string, std::string, std::string> SharedMonitorKey;
+    std::map<SharedMonitorKey, std::weak_ptr<SharedMonitor>> monitorsShared;
+
+    // entries with family()==AF_UNSPEC await lookup of a host name
     std::vector<std::pair<SockAddr, std::shared_ptr<Connection>>> nameServers;
 
+    // host names from Config::addressList and Config::nameServers.
+    // Looked up on resolver, and again periodically, so that a slow DNS server
+    // does not delay Context startup.
+    struct HostName {
+        std::string name;
+        // index in nameServers, otherwise in searchDest
+        size_t index;
+        bool nameserver;
+    };
+    std::vector<HostName> hostNames;
+
+    // with Config::nameCacheFile.  Set by Context::Pvt before any Channel is created.
+    std::shared_ptr<NameCache> nameCache;
+
     evbase tcp_loop;
     const evevent searchRx4, searchRx6;
     const evevent searchTimer;
@@ -322,6 +607,9 @@ struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
     const evevent beaconCleaner;
     const evevent cacheCleaner;
     const evevent nsChecker;
+    const evevent dnsRefresher;
+    // started only if hostNames not empty.  Makes blocking DNS lookups.
+    evbase resolver;
 
     INST_COUNTER(ClientContextImpl);
 
@@ -339,33 +627,61 @@ struct ContextImpl : public std::enable_shared_from_this<ContextImpl>
     void onBeacon(const UDPManager::Beacon& msg);
 
     void scheduleInitialSearch();
+    // (re)search for Channel after some ticks of the search ring.  holdoff==0 for the next tick.
+    void searchAfter(Channel* chan, size_t holdoff);
+    // uniformly distributed in [0, 1).  Call from tcp_loop
+    double reconnectJitter();
+    // Connection::stream for a Channel.  cf. Config::tcpStreams and CommonBuilder::bulk()
+    unsigned streamFor(const Channel& chan) const;
 
     bool onSearch(evutil_socket_t fd);
+    void onSearchOne(const uint8_t* buf, int nrx, const SockAddr& src);
     static void onSearchS(evutil_socket_t fd, short evt, void *raw);
-    enum class SearchKind { discover, initial, check };
-    void tickSearch(SearchKind kind, bool poked);
+    enum class SearchKind { discover, initial, check, targeted };
+    void tickSearch(SearchKind kind, bool poked, const SockAddr& target = SockAddr());
+    // unicast search to one (newly seen) server for all Channels waiting for a reply
+    void searchServer(const SockAddr& target);
     static void tickSearchS(evutil_socket_t fd, short evt, void *raw);
     static void initialSearchS(evutil_socket_t fd, short evt, void *raw);
     void tickBeaconClean();
     static void tickBeaconCleanS(evutil_socket_t fd, short evt, void *raw);
     void cacheClean(const std::string &name, Context::cacheAction force);
+    // periodic removal of unused Channels, without visiting every entry of chanByName
+    void cacheCleanIdle();
+    // called from any thread
+    void channelIdle(const std::shared_ptr<Channel>& chan) noexcept;
     static void cacheCleanS(evutil_socket_t fd, short evt, void *raw);
     void onNSCheck();
     static void onNSCheckS(evutil_socket_t fd, short evt, void *raw);
+    void lookupHostNames();
+    void onHostNames(const std::vector<SockEndpoint>& results);
+    static void onDNSRefreshS(evutil_socket_t fd, short evt, void *raw);
 };
 
 struct Context::Pvt {
-    // external ref to running loop.
-    // impl directly, and indirectly, contains internal refs
+    // external refs to running loops.
+    // impl and shards directly, and indirectly, contain internal refs
 private:
     evbase loop;
+    std::vector<evbase> extraLoops;
 public:
+    // first shard.  Also handles discover()
     const std::shared_ptr<ContextImpl> impl;
+    // All shards, including impl.  cf. Config::tcpWorkers
+    // Each has its own TCP worker, search socket, and Channel cache.
+    std::vector<std::shared_ptr<ContextImpl>> shards;
+    // set by Context::close().  A closed Context is not shared.  cf. Config::shareContext
+    std::atomic<bool> closed{false};
+    // with Config::nameCacheFile.  Shared by all shards.
+    std::shared_ptr<NameCache> nameCache;
 
     INST_COUNTER(ClientPvt);
 
     Pvt(const Config& conf);
     ~Pvt(); // I call ContextImpl::close()
+
+    // select the shard which will handle all Channels of this name
+    const std::shared_ptr<ContextImpl>& shardFor(const std::string& name) const;
 };
 
 } // namespace client
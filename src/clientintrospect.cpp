@@ -107,6 +107,34 @@ struct InfoOp : public OperationBase
             state = Connecting;
         }
     }
+
+    // complete from Channel::infoCache, without a GET_FIELD round trip
+    void fromCache(const std::shared_ptr<OperationBase>& self)
+    {
+        if(state!=Connecting) {
+            return; // canceled meanwhile
+
+        } else if(chan->state!=Channel::Active || !chan->infoCache) {
+            // disconnected meanwhile
+            chan->pending.push_back(self);
+            chan->createOperations();
+            return;
+        }
+
+        log_debug_printf(io, "Server %s channel '%s' GET_INFO from cache\n",
+                         chan->conn->peerName.c_str(), chan->name.c_str());
+
+        state = Done;
+
+        if(done) {
+            auto done = std::move(this->done);
+            try {
+                done(Result(chan->infoCache.cloneEmpty(), chan->conn->peerName));
+            }catch(std::exception& e){
+                log_exc_printf(setup, "Unhandled exception %s in Info result() callback: %s\n", typeid (e).name(), e.what());
+            }
+        }
+    }
 };
 DEFINE_INST_COUNTER(InfoOp);
 
@@ -150,6 +178,9 @@ void Connection::handle_GET_FIELD()
 
     info->chan->statRx += rxlen;
 
+    if(sts.isSuccess())
+        info->chan->infoCache = prototype.cloneEmpty();
+
     if(info->state!=InfoOp::Waiting) {
         log_warn_printf(io, "Server %s ignore second reply to GET_FIELD\n", peerName.c_str());
         return;
@@ -165,7 +196,7 @@ void Connection::handle_GET_FIELD()
         if(sts.isSuccess()) {
             res = Result(std::move(prototype), peerName);
         } else {
-            res = Result(std::make_exception_ptr(RemoteError(sts.msg)));
+            res = Result(std::make_exception_ptr(RemoteError(sts.msg)), Event::RemoteError);
         }
         try {
             done(std::move(res));
@@ -185,11 +216,11 @@ std::shared_ptr<Operation> GetBuilder::_exec_info()
     if(!_autoexec)
         throw std::logic_error("autoExec(false) not possible for info()");
 
-    auto context(ctx->impl->shared_from_this());
+    auto context(ctx->shardFor(_name));
 
     auto op(std::make_shared<InfoOp>(context->tcp_loop));
     if(_result) {
-        op->done = std::move(_result);
+        op->done = viaExecutor(SerialExecutor::build(_executor), std::move(_result));
     } else {
         auto waiter = op->waiter = std::make_shared<ResultWaiter>();
         op->done = [waiter](Result&& result) {
@@ -215,13 +246,23 @@ std::shared_ptr<Operation> GetBuilder::_exec_info()
 
     auto name(std::move(_name));
     auto server(std::move(_server));
-    context->tcp_loop.dispatch([op, context, name, server]() {
+    auto bulk(_bulk);
+    auto prio(_prio);
+    context->tcp_loop.dispatch([op, context, name, server, bulk, prio]() {
         // on worker
 
-        op->chan = Channel::build(context, name, server);
+        op->chan = Channel::build(context, name, server, bulk, prio);
+
+        if(op->chan->state==Channel::Active && op->chan->infoCache) {
+            // type already known.  Complete after any cancel() queued meanwhile.
+            context->tcp_loop.dispatch([op]() {
+                op->fromCache(op);
+            });
 
-        op->chan->pending.push_back(op);
-        op->chan->createOperations();
+        } else {
+            op->chan->pending.push_back(op);
+            op->chan->createOperations();
+        }
     });
 
     return external;
@@ -8,10 +8,15 @@
 #include <epicsMutex.h>
 #include <epicsGuard.h>
 
-#include <deque>
+#include <atomic>
+#include <map>
+#include <vector>
 
 #include <pvxs/log.h>
 #include "clientimpl.h"
+#include "wirecache.h"
+#include "mcastmon.h"
+#include "tracepoint.h"
 
 namespace pvxs {
 namespace client {
@@ -25,9 +30,60 @@ namespace {
 struct Entry {
     Value val;
     std::exception_ptr exc;
+    // classifies exc without rethrowing.  cf. Subscription::tryPop()
+    Event kind = Event::Data;
     Entry() = default;
     explicit Entry(Value&& v) :val(std::move(v)) {}
-    explicit Entry(const std::exception_ptr& e) :exc(e) {}
+    Entry(const std::exception_ptr& e, Event kind) :exc(e), kind(kind) {}
+};
+
+/* Allocator for the shared_ptr control block wrapping each Value handed out.
+ * Blocks are recycled through RequestFL, along with the Values themselves,
+ * so that steady state updates of a subscription do not allocate.
+ */
+template<typename T>
+struct FLAlloc {
+    typedef T value_type;
+
+    std::weak_ptr<RequestFL> wfl;
+
+    explicit FLAlloc(const std::weak_ptr<RequestFL>& wfl) :wfl(wfl) {}
+    template<typename U>
+    FLAlloc(const FLAlloc<U>& o) :wfl(o.wfl) {}
+
+    T* allocate(size_t n) {
+        if(n==1u) {
+            if(auto fl = wfl.lock()) {
+                Guard G(fl->lock);
+                if(fl->blockSize==sizeof(T) && !fl->blocks.empty()) {
+                    auto blk = fl->blocks.back();
+                    fl->blocks.pop_back();
+                    return static_cast<T*>(blk);
+                }
+            }
+        }
+        return static_cast<T*>(::operator new(n*sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        if(n==1u) {
+            // maybe on worker or user thread
+            if(auto fl = wfl.lock()) {
+                Guard G(fl->lock);
+                if(fl->blocks.empty())
+                    fl->blockSize = sizeof(T);
+                if(fl->blockSize==sizeof(T) && fl->blocks.size() < fl->limit) {
+                    fl->blocks.push_back(p);
+                    return;
+                }
+            }
+        }
+        ::operator delete(p);
+    }
+
+    template<typename U>
+    bool operator==(const FLAlloc<U>& o) const { return !wfl.owner_before(o.wfl) && !o.wfl.owner_before(wfl); }
+    template<typename U>
+    bool operator!=(const FLAlloc<U>& o) const { return !(*this==o); }
 };
 }
 
@@ -42,11 +98,30 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
     std::weak_ptr<SubscriptionImpl> self; // internal
     std::function<void (Subscription&, const Value&)> onInit;
     std::function<void(Subscription&)> event;
+    // with CommonBuilder::executor()
+    std::shared_ptr<SerialExecutor> serial;
+    std::weak_ptr<Subscription> external;
     Value pvRequest;
     bool pipeline = false;
+    // pipeline window sized from round trip time and consumer rate.  From record._options.autoWindow
+    bool autoWindow = false;
     bool autostart = true;
     bool maskConn = false, maskDiscon = true;
+    // cf. MonitorBuilder::passThrough()
+    bool passThrough = false;
+    // cf. MonitorBuilder::latestOnly()
+    bool latestOnly = false;
+    // cf. MonitorBuilder::sink()
+    std::shared_ptr<const DecodeMap> sinkMap;
+    std::shared_ptr<void> sinkDest;
+    std::function<void(const void*)> sinkCB;
+    // sinkMap entries resolved against the type from the latest INIT.  only access from loop
+    std::vector<FieldRef> sinkRefs;
+    // cf. MonitorBuilder::arrayAllocator()
+    std::shared_ptr<ArrayAllocator> arrayAlloc;
     uint32_t queueSize = 4u, ackAt=0u;
+    // with latestOnly.  data updates received.
+    std::atomic<uint64_t> latestVersion{0u};
 
     // only access from loop
     mutable std::weak_ptr<Subscription>     external_internal; // 'self' wrapped to be returned by shared_from_this()
@@ -63,12 +138,19 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
 
     // guarded by lock
 
-    std::deque<Entry> queue;
+    RingQueue<Entry> queue;
     uint32_t window =0u; // flow control window.  number of updates server may send to us
     uint32_t unack =0u;  // updates pop()'d, but not ack'd
+    // with autoWindow.  Total credit granted to server, including window, queued, and unack'd updates.
+    uint32_t credit =0u;
+    double drainRate =0.0; // average updates pop()'d per second
+    epicsTime lastAck;
     size_t nSrvSquash =0u;
     size_t nCliSquash =0u;
     size_t queueMax =0u;
+    // with latestOnly.  Most recent update, and whether latest() has returned it.
+    Value latestVal;
+    bool latestSeen = true;
     // user code has seen pop()==nullptr
     bool needNotify = true;
     bool ackPending = false; // ackTick scheduled
@@ -156,48 +238,60 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
         }
     }
 
-    void _pop(Value& ret, bool canthrow)
+    // caller must hold lock
+    void _popped(size_t n)
+    {
+        PVXS_TRACE2(client_mon_pop, this, queue.size());
+        if(pipeline) {
+            timeval tick{}; // immediate ACK
+
+            unack += n;
+
+            if(!ackPending && unack>=ackAt) {
+                if(event_add(ackTick.get(), &tick)) {
+                    log_err_printf(io, "Monitor '%s' unable to schedule ack\n", channelName.c_str());
+                } else {
+                    log_debug_printf(io, "Monitor '%s' sched ack %u/%u\n",
+                                     channelName.c_str(), unsigned(unack), unsigned(ackAt));
+                    ackPending = true;
+                }
+            }
+        }
+    }
+
+    // caller must hold lock.  With exc, an event or error is stored instead of thrown.
+    Event _pop(Value& ret, bool canthrow, std::exception_ptr* exc=nullptr)
     {
         {
             if(!queue.empty()) {
 
                 if(!canthrow && queue.front().exc)
-                    return;
+                    return Event::Empty;
 
                 auto ent(std::move(queue.front()));
                 queue.pop_front();
 
-                if(pipeline) {
-                    timeval tick{}; // immediate ACK
-
-                    unack++;
-
-                    if(!ackPending && unack>=ackAt) {
-                        if(event_add(ackTick.get(), &tick)) {
-                            log_err_printf(io, "Monitor '%s' unable to schedule ack\n", channelName.c_str());
-                        } else {
-                            log_debug_printf(io, "Monitor '%s' sched ack %u/%u\n",
-                                             channelName.c_str(), unsigned(unack), unsigned(ackAt));
-                            ackPending = true;
-                        }
-                    }
-                }
+                _popped(1u);
                 log_printf(monevt, ent.exc || ent.val ? Level::Info : Level::Err,
                            "channel '%s' monitor pop() %s %u,%u\n",
                            channelName.c_str(),
                            ent.exc ? "exception" : ent.val ? "data" : "null!",
                            unsigned(window), unsigned(unack));
 
-                if(ent.exc)
+                if(ent.exc && exc)
+                    *exc = std::move(ent.exc);
+                else if(ent.exc)
                     std::rethrow_exception(ent.exc);
                 else
                     ret = std::move(ent.val);
+                return ent.kind;
 
             } else {
                 needNotify = true;
 
                 log_info_printf(monevt, "channel '%s' monitor pop() empty\n",
                                 channelName.c_str());
+                return Event::Empty;
             }
         }
     }
@@ -212,6 +306,14 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
         return ret;
     }
 
+    virtual Event tryPop(Value& out, std::exception_ptr* err) override final
+    {
+        out = Value();
+        std::exception_ptr temp;
+        Guard G(lock);
+        return _pop(out, true, err ? err : &temp);
+    }
+
     virtual bool doPop(std::vector<Value>& out, size_t limit) override final
     {
         out.clear();
@@ -224,18 +326,86 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
 
         Guard G(lock);
 
-        while(out.size() < limit) {
+        if(!queue.empty() && queue.front().exc) {
+            // only throw if out is empty
             Value temp;
-            _pop(temp, out.empty()); // only throw if out is empty
-            if(!temp)
-                break;
+            _pop(temp, true);
+            // not reached
+        }
+
+        // move out Values, up to the next exception, with one ACK update for the batch
+        size_t n = 0u;
+        while(out.size() < limit && !queue.empty() && !queue.front().exc) {
+            out.emplace_back(std::move(queue.front().val));
+            queue.pop_front();
+            n++;
+        }
+
+        if(n) {
+            _popped(n);
+            log_info_printf(monevt, "channel '%s' monitor pop() %zu data %u,%u\n",
+                            channelName.c_str(), n, unsigned(window), unsigned(unack));
+        }
+
+        if(queue.empty()) {
+            needNotify = true;
 
-            out.emplace_back(std::move(temp));
+            log_info_printf(monevt, "channel '%s' monitor pop() empty\n",
+                            channelName.c_str());
         }
 
         return !needNotify;
     }
 
+    virtual Value _latest(uint64_t* version) override final
+    {
+        Guard G(lock);
+        if(version)
+            *version = latestVersion.load();
+        latestSeen = true;
+        return latestVal;
+    }
+
+    virtual uint64_t version() const override final
+    {
+        return latestVersion.load(std::memory_order_relaxed);
+    }
+
+    // caller must hold lock
+    void _setLatest(Value&& val)
+    {
+        if(!latestSeen && Value::Helper::desc(latestVal)==Value::Helper::desc(val)) {
+            // not yet seen through latest().  union the changed fields of both.
+            auto pstore = Value::Helper::store_ptr(latestVal);
+            auto ustore = Value::Helper::store_ptr(val);
+            for(auto i : range(Value::Helper::desc(val)->size()))
+                ustore[i].valid |= pstore[i].valid;
+            // the received encoding no longer matches
+            if(passThrough) {
+                if(auto wire = WireCache::find(ustore))
+                    wire->clear();
+            }
+        }
+        latestVal = std::move(val);
+        latestSeen = false;
+        latestVersion.fetch_add(1u);
+        // not queued, so already consumed as far as flow control is concerned
+        _popped(1u);
+    }
+
+    // on worker
+    void _applySink(const Value& val)
+    {
+        auto base = static_cast<char*>(sinkDest.get());
+        const auto& entries = sinkMap->entries();
+        for(auto i : range(entries.size())) {
+            auto fld(val[sinkRefs[i]]);
+            if(fld)
+                entries[i].copy(fld, base + entries[i].offset);
+        }
+        sinkCB(sinkDest.get());
+    }
+
     virtual std::shared_ptr<Subscription> shared_from_this() const override final {
         // on worker?
         std::shared_ptr<Subscription> ret;
@@ -274,10 +444,41 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
         decltype (event) junk;
         loop.call([this, &junk, &fn]() {
             junk = std::move(event);
-            this->event = std::move(fn);
+            this->event = wrapEvent(std::move(fn));
         });
     }
 
+    // with executor(), call user callbacks through serial, with the external ref
+    std::function<void(Subscription&)> wrapEvent(std::function<void(Subscription&)>&& fn) const {
+        if(!serial || !fn)
+            return std::move(fn);
+        auto cb(std::make_shared<std::function<void(Subscription&)>>(std::move(fn)));
+        auto serial(this->serial);
+        auto external(this->external);
+        return [serial, external, cb](Subscription&) {
+            serial->post([external, cb]() {
+                if(auto sub = external.lock())
+                    (*cb)(*sub);
+            });
+        };
+    }
+
+    std::function<void(Subscription&, const Value&)> wrapInit(std::function<void(Subscription&, const Value&)>&& fn) const {
+        if(!serial || !fn)
+            return std::move(fn);
+        auto cb(std::make_shared<std::function<void(Subscription&, const Value&)>>(std::move(fn)));
+        auto serial(this->serial);
+        auto external(this->external);
+        return [serial, external, cb](Subscription&, const Value& prototype) {
+            // the callback will run later, so give it a private copy
+            auto val(prototype.clone());
+            serial->post([external, cb, val]() {
+                if(auto sub = external.lock())
+                    (*cb)(*sub, val);
+            });
+        };
+    }
+
     virtual bool cancel() override final {
         decltype (event) junk;
         bool ret = false;
@@ -339,7 +540,7 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
             to_wire(R, chan->sid);
             to_wire(R, ioid);
             to_wire(R, subcmd);
-            to_wire(R, Value::Helper::desc(pvRequest));
+            to_wire(R, Value::Helper::desc(pvRequest), conn->txTypes);
             to_wire_full(R, pvRequest);
             if(pipeline)
                 to_wire(R, queueSize);
@@ -359,14 +560,18 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
             if(!maskConn) {
                 notify = queue.empty() && wantToNotify();
 
-                queue.emplace_back(std::make_exception_ptr(Connected(conn->peerName)));
+                queue.emplace_back(std::make_exception_ptr(Connected(conn->peerName)), Event::Connected);
 
                 log_debug_printf(io, "Server %s channel %s monitor PUSH Connected\n",
                                  chan->conn ? chan->conn->peerName.c_str() : "<disconnected>",
                                  chan->name.c_str());
             }
-            if(pipeline)
-                window = queueSize;
+            if(pipeline) {
+                window = credit = queueSize;
+                lastAck = epicsTime::getCurrent();
+                if(autoWindow)
+                    ackAt = std::max(1u, credit/2u);
+            }
         }
 
         if(notify)
@@ -395,7 +600,7 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
                 Guard G(lock);
                 notify = queue.empty() && wantToNotify();
 
-                queue.emplace_back(std::make_exception_ptr(Disconnect()));
+                queue.emplace_back(std::make_exception_ptr(Disconnect()), Event::Disconnect);
 
                 log_debug_printf(io, "Server %s channel %s monitor PUSH Disconnect\n",
                                  chan->conn ? chan->conn->peerName.c_str() : "<disconnected>",
@@ -412,6 +617,58 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
         }
     }
 
+    virtual size_t queueBytes() const override final
+    {
+        Guard G(lock);
+        size_t ret = 0u;
+        for(auto i : range(queue.size()))
+            ret += Value::Helper::approxBytes(queue[i].val);
+        return ret;
+    }
+
+    // caller must hold lock.
+    // Returns the number of updates to ack.  May differ from unack to grow or shrink the window.
+    uint32_t adaptWindow()
+    {
+        auto now(epicsTime::getCurrent());
+        double dt = now - lastAck;
+        lastAck = now;
+
+        if(dt>0.0 && dt<10.0) { // ignore long pauses
+            double sample = unack/dt;
+            drainRate = drainRate>0.0 ? 0.75*drainRate + 0.25*sample : sample;
+        }
+
+        double rtt = chan && chan->conn ? chan->conn->rtt : 0.0;
+        if(rtt<=0.0 || drainRate<=0.0)
+            return unack; // no estimate (yet).  keep current size
+
+        // enough credit to cover what the consumer can pop() in two round trips.
+        double want = std::max(2.0, std::min(2.0*drainRate*rtt + 1.0, 4.0*queueSize));
+        auto target = uint32_t(want);
+
+        // move half way to the target each time
+        uint32_t num2ack = unack;
+        if(target > credit) {
+            auto grow = (target - credit + 1u)/2u;
+            credit += grow;
+            num2ack += grow;
+
+        } else if(target < credit) {
+            auto shrink = std::min(unack, (credit - target + 1u)/2u);
+            credit -= shrink;
+            num2ack -= shrink;
+        }
+
+        ackAt = std::max(1u, credit/2u);
+
+        log_debug_printf(io, "Server %s channel %s monitor window %u rate %.1f RTT %.6f\n",
+                         chan->conn ? chan->conn->peerName.c_str() : "<disconnected>",
+                         chan->name.c_str(), unsigned(credit), drainRate, rtt);
+
+        return num2ack;
+    }
+
     void tickAck()
     {
         uint32_t num2ack = 0;
@@ -421,8 +678,8 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
             ackPending = false;
 
             if(((state==Idle) || (state==Running)) && pipeline && unack) {
-                num2ack = unack;
-                window += unack;
+                num2ack = autoWindow ? adaptWindow() : unack;
+                window += num2ack;
                 unack = 0u;
 
                 log_debug_printf(io, "Server %s channel %s monitor ACK %u\n",
@@ -461,6 +718,25 @@ struct SubscriptionImpl final : public OperationBase, public Subscription
 };
 DEFINE_INST_COUNTER(SubscriptionImpl);
 
+// A received encoding may be forwarded only if it can not contain references
+// to our peer's type cache.  Only Any (variant) fields may.
+static
+bool passThroughType(const FieldDesc* desc)
+{
+    if(!desc)
+        return false;
+    for(auto i : range(desc->size())) {
+        auto& fld = desc[i];
+        if(fld.code==TypeCode::Any || fld.code==TypeCode::AnyA)
+            return false;
+        for(size_t m=0u; m < fld.members.size(); m += fld.members[m].size()) {
+            if(!passThroughType(&fld.members[m]))
+                return false;
+        }
+    }
+    return true;
+}
+
 void Connection::handle_MONITOR()
 {
     auto rxlen = 8u + evbuffer_get_length(segBuf.get());
@@ -502,6 +778,7 @@ void Connection::handle_MONITOR()
 
         } else if(init) {
             info->prototype = std::move(data);
+            info->plan = WirePlan(Value::Helper::desc(info->prototype));
             // initialize info->fl later, with access to queueSize
 
         } else if(!final || !M.empty()) {
@@ -519,19 +796,28 @@ void Connection::handle_MONITOR()
                     raw = info->prototype.cloneEmpty();
                 }
             }
+            // With passThrough, the cache entry lives as long as this update Value.
+            // Not when array patches change the decoded Value.
+            // Nor when variant types may be references into the type cache of this connection.
+            std::shared_ptr<WireCache> wire;
             // Wrap Value for automatic return to our free-list
             {
                 std::weak_ptr<RequestFL> wfl(info->fl);
                 auto desc(Value::Helper::desc(raw));
                 auto store(Value::Helper::store_ptr(raw));
 
+                if(info->fl->passThrough && !(subcmd&0x20) && !info->plan.variant)
+                    wire = WireCache::lookup(store);
+
                 Value::Helper::store(data).reset(
                             store,
                             // ugly bind() to capture by move instead of copy to avoid extra ref-counts
                             std::bind(
-                            [](FieldStorage*, Value& data, std::weak_ptr<RequestFL>& wfl) mutable {
+                            [](FieldStorage*, Value& data, std::weak_ptr<RequestFL>& wfl, std::shared_ptr<WireCache>& wire) mutable {
                                 // maybe on worker or user thread
                                 auto real(std::move(data));
+                                // release before the storage may be re-used
+                                wire.reset();
                                 if(auto fl = wfl.lock()) {
                                     Guard G(fl->lock);
                                     if(fl->unused.size() < fl->limit) {
@@ -540,12 +826,46 @@ void Connection::handle_MONITOR()
                                     }
                                 }
 
-                }, std::placeholders::_1, std::move(raw), std::move(wfl))
+                }, std::placeholders::_1, std::move(raw), wfl, wire),
+                            FLAlloc<FieldStorage>(wfl)
                             );
 
                 Value::Helper::set_desc(data, desc);
             }
-            from_wire_valid(M, rxRegistry, data);
+
+            evbuf rxcopy;
+            size_t rxbefore = 0u;
+            if(wire) {
+                // copy the remaining body, as decoding consumes segBuf
+                (void)M.refill(0u);
+                rxbefore = evbuffer_get_length(segBuf.get());
+                rxcopy = evbuf(__FILE__, __LINE__, evbuffer_new());
+                auto n = evbuffer_peek(segBuf.get(), -1, nullptr, nullptr, 0);
+                std::vector<evbuffer_iovec> vecs(n);
+                n = evbuffer_peek(segBuf.get(), -1, nullptr, vecs.data(), n);
+                for(auto i : range(n)) {
+                    if(evbuffer_add(rxcopy.get(), vecs[i].iov_base, vecs[i].iov_len))
+                        throw std::bad_alloc();
+                }
+            }
+
+            from_wire_valid(M, rxRegistry, data, info->plan, info->fl->arrays.get());
+
+            if(wire && M.good()) {
+                // keep only the bytes just decoded: BitMask and marked fields
+                (void)M.refill(0u);
+                auto consumed = rxbefore - evbuffer_get_length(segBuf.get());
+                std::shared_ptr<evbuffer> bytes(evbuffer_new(), &evbuffer_free);
+                if(!bytes || evbuffer_remove_buffer(rxcopy.get(), bytes.get(), consumed)!=int(consumed))
+                    throw std::bad_alloc();
+
+                // encoding as to_wire_valid() would with the byte order of our peer,
+                // and a downstream pvRequest selecting all fields.
+                BitMask all(info->plan.mask.size());
+                for(auto i : range(all.wsize()))
+                    all.word(i) = info->plan.mask.word(i);
+                wire->seed(peerBE, std::move(all), bytes);
+            }
 
             /* co-iterate data and prototype.
              * copy   marked from data -> prototype
@@ -571,7 +891,7 @@ void Connection::handle_MONITOR()
                         memcpy(&dst->store, &src->store, sizeof(src->store));
                         break;
                     case StoreType::String:
-                        dst->as<std::string>() = src->as<std::string>();
+                        dst->as<CowString>() = src->as<CowString>();
                         break;
                     case StoreType::Array:
                         dst->as<shared_array<const void>>() = src->as<shared_array<const void>>();
@@ -600,6 +920,34 @@ void Connection::handle_MONITOR()
                     break;
                 }
             }
+
+            if(subcmd&0x20) {
+                // array patches, applied to the previous complete value.  cf. MonitorOp::encodeDelta()
+                auto desc = Value::Helper::desc(info->prototype);
+                auto delta = Value::Helper::store_ptr(data);
+                auto complete = Value::Helper::store_ptr(info->prototype);
+
+                Size npatch{};
+                from_wire(M, npatch);
+                for(auto n : range(npatch.size)) {
+                    (void)n;
+                    Size bit{};
+                    from_wire(M, bit);
+                    if(!M.good() || bit.size >= desc->size() || delta[bit.size].code!=StoreType::Array) {
+                        M.fault(__FILE__, __LINE__);
+                        break;
+                    }
+
+                    auto arr(complete[bit.size].as<shared_array<const void>>());
+                    from_wire_patch(M, desc + bit.size, arr);
+                    if(!M.good())
+                        break;
+
+                    delta[bit.size].as<shared_array<const void>>() = arr;
+                    delta[bit.size].valid = true;
+                    complete[bit.size].as<shared_array<const void>>() = std::move(arr);
+                }
+            }
         }
     }
 
@@ -646,9 +994,12 @@ void Connection::handle_MONITOR()
     mon->chan->statRx += rxlen;
 
     Entry update;
+    // data update consumed by sink()
+    bool sunk = false;
 
     if(!sts.isSuccess()) {
         update.exc = std::make_exception_ptr(RemoteError(sts.msg));
+        update.kind = Event::RemoteError;
         mon->state = SubscriptionImpl::Done;
 
     } else if(mon->state==SubscriptionImpl::Creating) {
@@ -664,14 +1015,34 @@ void Connection::handle_MONITOR()
         }catch(std::exception& e){
             mon->state = SubscriptionImpl::Done;
             update.exc = std::current_exception();
+            update.kind = Event::Error;
             log_debug_printf(io, "Server %s channel %s monitor Create error: %s\n",
                             peerName.c_str(),
                             mon->chan->name.c_str(), e.what());
         }
 
+        if(mon->sinkCB) {
+            mon->sinkRefs.clear();
+            for(auto& ent : mon->sinkMap->entries())
+                mon->sinkRefs.emplace_back(info->prototype, ent.name);
+        }
+
         if(mon->autostart && mon->state == SubscriptionImpl::Idle)
             mon->resume();
 
+    } else if(data && mon->sinkCB) { // Idle or Running
+        try {
+            mon->_applySink(data);
+            sunk = true;
+        }catch(std::exception& e){
+            update.exc = std::current_exception();
+            update.kind = Event::Error;
+            log_err_printf(io, "Server %s channel %s monitor sink error: %s\n",
+                           peerName.c_str(),
+                           mon->chan->name.c_str(), e.what());
+        }
+        // storage returned to free-list
+
     } else if(data) { // Idle or Running
         update.val = std::move(data);
 
@@ -698,7 +1069,8 @@ void Connection::handle_MONITOR()
             /* Allow enough for user to hold/process one full queue while
              * accumulate another.
              */
-            info->fl = std::make_shared<RequestFL>(2u*mon->queueSize);
+            info->fl = impl::allocateOp<RequestFL>(context->opSlab, 2u*mon->queueSize, mon->arrayAlloc);
+            info->fl->passThrough = mon->passThrough && passThroughType(Value::Helper::desc(info->prototype));
 
         } else {
 
@@ -719,12 +1091,38 @@ void Connection::handle_MONITOR()
             notify = mon->queue.empty();
 
             assert(mon->queueSize >= 1u);
-            if(update.val && mon->queue.size() >= mon->queueSize && mon->queue.back().val && !mon->pipeline) {
+            if(sunk) {
+                // not queued, so already consumed as far as flow control is concerned
+                mon->_popped(1u);
+
+            } else if(update.val && mon->latestOnly) {
+                mon->_setLatest(std::move(update.val));
+
+            } else if(update.val && mon->queue.size() >= mon->queueSize && mon->queue.back().val && !mon->pipeline) {
                 log_debug_printf(io, "Server %s channel %s monitor Squash\n",
                                  peerName.c_str(),
                                  mon->chan->name.c_str());
 
-                mon->queue.back().val.assign(update.val);
+                /* update.val is complete (unmarked fields filled from prototype).
+                 * So keep it in place of the queued Value, which is returned to
+                 * the free-list, and union the changed fields of both.
+                 */
+                auto& prev = mon->queue.back().val;
+                if(Value::Helper::desc(prev)==Value::Helper::desc(update.val)) {
+                    auto pstore = Value::Helper::store_ptr(prev);
+                    auto ustore = Value::Helper::store_ptr(update.val);
+                    for(auto i : range(Value::Helper::desc(prev)->size()))
+                        ustore[i].valid |= pstore[i].valid;
+                    prev = std::move(update.val);
+
+                } else {
+                    prev.assign(update.val);
+                }
+                // the received encoding no longer matches
+                if(mon->passThrough) {
+                    if(auto wire = WireCache::find(Value::Helper::store_ptr(prev)))
+                        wire->clear();
+                }
                 mon->nCliSquash++;
 
             } else if(update.exc || update.val) {
@@ -733,6 +1131,7 @@ void Connection::handle_MONITOR()
                                 mon->chan->name.c_str());
 
                 mon->queue.emplace_back(std::move(update));
+                PVXS_TRACE2(client_mon_push, mon.get(), mon->queue.size());
 
             }
 
@@ -741,12 +1140,13 @@ void Connection::handle_MONITOR()
                                 peerName.c_str(),
                                 mon->chan->name.c_str());
 
-                mon->queue.emplace_back(std::make_exception_ptr(Finished()));
+                mon->queue.emplace_back(std::make_exception_ptr(Finished()), Event::Finished);
             }
 
             if(mon->queue.empty()) {
-                log_err_printf(io, "Server %s channel '%s' monitor empty update!\n",
-                               peerName.c_str(), mon->chan->name.c_str());
+                if(!mon->latestOnly && !sunk)
+                    log_err_printf(io, "Server %s channel '%s' monitor empty update!\n",
+                                   peerName.c_str(), mon->chan->name.c_str());
                 notify = false;
             }
 
@@ -778,31 +1178,19 @@ void Connection::handle_MONITOR()
 }
 
 
-std::shared_ptr<Subscription> MonitorBuilder::exec()
+namespace {
+// apply pvRequest options
+void parseOptions(SubscriptionImpl& op)
 {
-    if(!ctx)
-        throw std::logic_error("NULL Builder");
-
-    auto context(ctx->impl->shared_from_this());
-
-    auto op(std::make_shared<SubscriptionImpl>(context->tcp_loop));
-    op->self = op;
-    op->channelName = std::move(_name);
-    op->event = std::move(_event);
-    op->onInit = std::move(_onInit);
-    op->pvRequest = _buildReq();
-    op->maskConn = _maskConn;
-    op->maskDiscon = _maskDisconn;
-    op->autostart = _autoexec;
-
-    auto options = op->pvRequest["record._options"];
+    auto options = op.pvRequest["record._options"];
 
     options["queueSize"].as<uint32_t>([&op](uint32_t Q) {
         if(Q>1)
-            op->queueSize = Q;
+            op.queueSize = Q;
     });
 
-    (void)options["pipeline"].as(op->pipeline);
+    (void)options["pipeline"].as(op.pipeline);
+    (void)options["autoWindow"].as(op.autoWindow);
 
     auto ackAny = options["ackAny"];
 
@@ -812,7 +1200,7 @@ std::shared_ptr<Subscription> MonitorBuilder::exec()
             try {
                 auto percent = parseTo<double>(sval.substr(0, sval.size()-1u));
                 if(percent>0.0 && percent<=100.0) {
-                    op->ackAt = uint32_t(percent * op->queueSize);
+                    op.ackAt = uint32_t(percent * op.queueSize);
                 } else {
                     throw std::invalid_argument("not in range (0%, 100%]");
                 }
@@ -823,22 +1211,26 @@ std::shared_ptr<Subscription> MonitorBuilder::exec()
 
     }
 
-    if(op->ackAt==0u){
+    if(op.ackAt==0u){
         uint32_t count=0u;
 
         if(ackAny.as(count)) {
-            op->ackAt = count;
+            op.ackAt = count;
         }
     }
 
-    if(op->ackAt==0u){
-        op->ackAt = op->queueSize/2u;
+    if(op.ackAt==0u){
+        op.ackAt = op.queueSize/2u;
     }
 
-    op->ackAt = std::max(1u, std::min(op->ackAt, op->queueSize));
+    op.ackAt = std::max(1u, std::min(op.ackAt, op.queueSize));
+}
 
-    auto syncCancel(_syncCancel);
-    std::shared_ptr<SubscriptionImpl> external(op.get(), [op, syncCancel](SubscriptionImpl*) mutable {
+// wrap internal ref to be returned to user code
+std::shared_ptr<SubscriptionImpl> makeExternal(const std::shared_ptr<SubscriptionImpl>& iop, bool syncCancel)
+{
+    auto op(iop);
+    return std::shared_ptr<SubscriptionImpl>(op.get(), [op, syncCancel](SubscriptionImpl*) mutable {
         // from user thread
         auto temp(std::move(op));
         auto loop(temp->loop);
@@ -852,12 +1244,657 @@ std::shared_ptr<Subscription> MonitorBuilder::exec()
                            op->_cancel(true);
                        }, std::move(temp)));
     });
+}
+} // namespace
+
+struct SharedMonitor;
+struct MulticastMonitor;
+
+namespace {
+// Copy all fields, and marks, to new storage.
+// Unlike Value::clone(), which copies only marked fields.
+// Strings, arrays, and Union/Any members are shared, not copied.
+Value cloneAll(const Value& src)
+{
+    auto ret(src.cloneEmpty());
+    auto desc = Value::Helper::desc(src);
+    auto sfld = Value::Helper::store_ptr(src);
+    auto dfld = Value::Helper::store_ptr(ret);
+    for(auto i : range(desc->size())) {
+        switch(sfld[i].code) {
+        case StoreType::Null:
+            break;
+        case StoreType::Bool:
+        case StoreType::UInteger:
+        case StoreType::Integer:
+        case StoreType::Real:
+            memcpy(&dfld[i].store, &sfld[i].store, sizeof(sfld[i].store));
+            break;
+        case StoreType::String:
+            dfld[i].as<CowString>() = sfld[i].as<CowString>();
+            break;
+        case StoreType::Array:
+            dfld[i].as<shared_array<const void>>() = sfld[i].as<shared_array<const void>>();
+            break;
+        case StoreType::Compound:
+            dfld[i].as<Value>() = sfld[i].as<Value>();
+            break;
+        }
+        dfld[i].valid = sfld[i].valid;
+    }
+    return ret;
+}
+} // namespace
+
+// One of the Subscriptions to a SharedMonitor.  With a private queue.
+struct SharedSubscription final : public Subscription
+{
+    const std::string channelName;
+    const evbase loop;
+
+    // const after exec()
+    std::weak_ptr<SharedSubscription> self;
+    std::shared_ptr<SerialExecutor> serial;
+    std::weak_ptr<Subscription> external;
+    bool maskConn = false, maskDiscon = true;
+    uint32_t queueSize = 4u;
+
+    // only access from loop
+    std::shared_ptr<SharedMonitor> shared;
+    std::shared_ptr<MulticastMonitor> mcast;
+    std::function<void(Subscription&)> event;
+    bool paused = false;
+
+    mutable epicsMutex lock;
+
+    // guarded by lock
+    RingQueue<Entry> queue;
+    size_t nSrvSquash =0u;
+    size_t nCliSquash =0u;
+    size_t queueMax =0u;
+    bool needNotify = true;
+
+    INST_COUNTER(SharedSubscription);
+
+    SharedSubscription(const std::string& channelName, const evbase& loop)
+        :channelName(channelName)
+        ,loop(loop)
+    {}
+    virtual ~SharedSubscription() {}
+
+    virtual const std::string& _name() override final {
+        return channelName;
+    }
+
+    virtual bool cancel() override final;
+    // on worker
+    bool _cancel();
+
+    virtual void pause(bool p) override final;
+
+    virtual Value pop() override final
+    {
+        Guard G(lock);
+        if(queue.empty()) {
+            needNotify = true;
+            return Value();
+        }
+        auto ent(std::move(queue.front()));
+        queue.pop_front();
+        if(ent.exc)
+            std::rethrow_exception(ent.exc);
+        return std::move(ent.val);
+    }
+
+    virtual Event tryPop(Value& out, std::exception_ptr* err) override final
+    {
+        out = Value();
+        Guard G(lock);
+        if(queue.empty()) {
+            needNotify = true;
+            return Event::Empty;
+        }
+        auto ent(std::move(queue.front()));
+        queue.pop_front();
+        if(err)
+            *err = std::move(ent.exc);
+        out = std::move(ent.val);
+        return ent.kind;
+    }
+
+    virtual bool doPop(std::vector<Value>& out, size_t limit) override final
+    {
+        out.clear();
+        if(!limit)
+            limit = queueSize;
+        out.reserve(limit);
+
+        Guard G(lock);
+
+        if(!queue.empty() && queue.front().exc) {
+            // only throw if out is empty
+            auto ent(std::move(queue.front()));
+            queue.pop_front();
+            std::rethrow_exception(ent.exc);
+        }
+
+        while(out.size() < limit && !queue.empty() && !queue.front().exc) {
+            out.emplace_back(std::move(queue.front().val));
+            queue.pop_front();
+        }
+
+        if(queue.empty())
+            needNotify = true;
+
+        return !needNotify;
+    }
+
+    virtual void stats(SubscriptionStat& ret, bool reset) override final {
+        Guard G(lock);
+        ret.limitQueue = queueSize;
+        ret.maxQueue = queueMax;
+        ret.nSrvSquash = nSrvSquash;
+        ret.nCliSquash = nCliSquash;
+        ret.nQueue = queue.size();
+        if(reset) {
+            nSrvSquash = nCliSquash = queueMax = 0u;
+        }
+    }
+
+    virtual void _onEvent(std::function<void(Subscription&)>&& fn) override final {
+        decltype (event) junk;
+        loop.call([this, &junk, &fn]() {
+            junk = std::move(event);
+            this->event = wrapEvent(std::move(fn));
+        });
+    }
+
+    // with executor(), call user callbacks through serial, with the external ref
+    std::function<void(Subscription&)> wrapEvent(std::function<void(Subscription&)>&& fn) const {
+        if(!serial || !fn)
+            return std::move(fn);
+        auto cb(std::make_shared<std::function<void(Subscription&)>>(std::move(fn)));
+        auto serial(this->serial);
+        auto external(this->external);
+        return [serial, external, cb](Subscription&) {
+            serial->post([external, cb]() {
+                if(auto sub = external.lock())
+                    (*cb)(*sub);
+            });
+        };
+    }
+
+    virtual std::shared_ptr<Subscription> shared_from_this() const override final {
+        return self.lock();
+    }
+
+    // on worker.  Queue an update or event, squashing a data update if our queue is full.
+    void push(const Entry& ent)
+    {
+        if(ent.kind==Event::Connected && maskConn)
+            return;
+        else if(ent.kind==Event::Disconnect && maskDiscon)
+            return;
+        // Finished, and errors, always delivered
+
+        bool notify;
+        {
+            Guard G(lock);
+
+            notify = queue.empty() && needNotify;
+
+            if(ent.val && queue.size() >= queueSize && queue.back().val) {
+                // ent.val is complete, so take it in place of the last queued,
+                // and union the changed fields of both.
+                auto& prev = queue.back().val;
+                auto val(ent.val);
+                if(Value::Helper::desc(prev)==Value::Helper::desc(val)) {
+                    auto pstore = Value::Helper::store_ptr(prev);
+                    auto ustore = Value::Helper::store_ptr(val);
+                    for(auto i : range(Value::Helper::desc(prev)->size()))
+                        ustore[i].valid |= pstore[i].valid;
+                    prev = std::move(val);
+                } else {
+                    prev.assign(val);
+                }
+                nCliSquash++;
+
+            } else {
+                queue.emplace_back(ent);
+            }
+
+            if(queueMax < queue.size())
+                queueMax = queue.size();
+
+            if(notify)
+                needNotify = false;
+        }
+
+        if(notify && event) {
+            try {
+                event(*this);
+            }catch(std::exception& e){
+                log_exc_printf(io, "Unhandled user exception in Monitor %s %s : %s\n",
+                                __func__, typeid (e).name(), e.what());
+            }
+        }
+    }
+};
+DEFINE_INST_COUNTER(SharedSubscription);
+
+/* One subscription to a server, fanned out to any number of SharedSubscription.
+ * Only accessed from the TCP worker.  cf. Config::shareMonitors
+ */
+struct SharedMonitor {
+    const std::weak_ptr<ContextImpl> context;
+    const ContextImpl::SharedMonitorKey key;
+    std::shared_ptr<SubscriptionImpl> upstream;
+    // SharedSubscription are kept alive by the handles returned to user code
+    std::vector<std::weak_ptr<SharedSubscription>> subs;
+    // latest complete update, for a new SharedSubscription
+    Value last;
+    // the Connected event from upstream, while connected
+    std::exception_ptr connected;
+    // upstream has Finished, or failed.
+    bool done = false;
+
+    INST_COUNTER(SharedMonitor);
+
+    SharedMonitor(const std::shared_ptr<ContextImpl>& context, const ContextImpl::SharedMonitorKey& key)
+        :context(context)
+        ,key(key)
+    {}
+
+    void forget()
+    {
+        if(auto ctxt = context.lock()) {
+            auto it(ctxt->monitorsShared.find(key));
+            if(it!=ctxt->monitorsShared.end() && (it->second.expired() || it->second.lock().get()==this))
+                ctxt->monitorsShared.erase(it);
+        }
+    }
+
+    void attach(const std::shared_ptr<SharedSubscription>& sub)
+    {
+        subs.push_back(sub);
+
+        if(connected)
+            sub->push(Entry(connected, Event::Connected));
+
+        if(last) {
+            // a late joiner sees the present value as complete
+            auto val(cloneAll(last));
+            val.mark();
+            sub->push(Entry(std::move(val)));
+        }
+
+        updatePause();
+    }
+
+    void detach(SharedSubscription* sub)
+    {
+        for(auto it(subs.begin()); it!=subs.end();) {
+            auto other(it->lock());
+            if(!other || other.get()==sub) {
+                it = subs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if(subs.empty()) {
+            forget();
+            if(auto up = std::move(upstream)) {
+                // maybe from within fanout().  Release (and cancel) after it returns
+                auto loop(up->loop);
+                (void)loop.tryDispatch(std::bind([](std::shared_ptr<SubscriptionImpl>& up) {
+                    up.reset();
+                }, std::move(up)));
+            }
+        } else {
+            updatePause();
+        }
+    }
+
+    // upstream runs while any SharedSubscription is not paused
+    void updatePause()
+    {
+        bool pause = true;
+        for(auto& wsub : subs) {
+            if(auto sub = wsub.lock())
+                pause &= sub->paused;
+        }
+        if(upstream)
+            upstream->pause(pause);
+    }
+
+    // upstream queue becomes not empty
+    void fanout()
+    {
+        while(!done && upstream) {
+            Entry ent;
+            ent.kind = upstream->tryPop(ent.val, &ent.exc);
+            switch(ent.kind) {
+            case Event::Empty:
+                break;
+            case Event::Data:
+                last = ent.val;
+                break;
+            case Event::Connected:
+                connected = ent.exc;
+                break;
+            case Event::Disconnect:
+                connected = nullptr;
+                break;
+            case Event::Finished:
+            case Event::RemoteError:
+            case Event::Error:
+                done = true;
+                break;
+            }
+            if(ent.kind==Event::Empty)
+                break;
+
+            if(done) // no longer available to new subscribers
+                forget();
+
+            // copy for iteration as an event callback may cancel()
+            auto targets(subs);
+            for(auto& wsub : targets) {
+                auto sub(wsub.lock());
+                if(!sub)
+                    continue;
+
+                if(ent.val) {
+                    // each SharedSubscription gets a private Value.
+                    // arrays are shared, not copied.
+                    Entry copy;
+                    copy.val = cloneAll(ent.val);
+                    sub->push(copy);
+                } else {
+                    sub->push(ent);
+                }
+            }
+        }
+    }
+};
+DEFINE_INST_COUNTER(SharedMonitor);
+
+/* Receives the updates of one PV sent by UDP, for one SharedSubscription.
+ * cf. MonitorBuilder::multicast() and server::SharedPV::multicast()
+ * Only accessed from the TCP worker, except for the UDP listener callback.
+ */
+struct MulticastMonitor : public std::enable_shared_from_this<MulticastMonitor> {
+    const evbase loop;
+    const std::string channelName;
+    const double timeout;
+    std::weak_ptr<SharedSubscription> sub;
+    std::unique_ptr<UDPListener> listener;
+    // expires when nothing has been received for timeout
+    const evevent timer;
+    // non-empty while receiving
+    std::string peerName;
+    // of the last update received
+    uint32_t seq = 0u;
+    // last update not delivered
+    bool skipped = false;
+
+    INST_COUNTER(MulticastMonitor);
+
+    MulticastMonitor(const evbase& loop, const std::string& channelName, double timeout)
+        :loop(loop)
+        ,channelName(channelName)
+        ,timeout(timeout)
+        ,timer(__FILE__, __LINE__,
+               event_new(loop.base, -1, EV_TIMEOUT, &expireS, this))
+    {}
+    ~MulticastMonitor() {
+        // no further callbacks once returned
+        listener.reset();
+    }
+
+    void start(const std::string& dest)
+    {
+        SockEndpoint ep(dest);
+        if(!ep.addr.port())
+            throw std::runtime_error(SB()<<"Multicast monitor destination '"<<dest<<"' must include a port number");
+
+        std::weak_ptr<MulticastMonitor> wself(shared_from_this());
+        auto loop(this->loop);
+        auto name(channelName);
+        listener = UDPManager::instance().onMonitor(ep, [wself, loop, name](const UDPManager::Monitor& msg) {
+            // on UDP worker.  Updates of other PVs sent to the same group are skipped before decoding.
+            std::string pvname;
+            if(!peekMCastUpdate(pvname, msg) || pvname!=name)
+                return;
+
+            auto update(std::make_shared<MCastUpdate>());
+            if(!decodeMCastUpdate(*update, msg)) {
+                log_debug_printf(io, "Ignore invalid multicast update of '%s' from %s\n",
+                                 name.c_str(), msg.src.tostring().c_str());
+                return;
+            }
+
+            auto src(msg.src.tostring());
+            (void)loop.tryDispatch([wself, update, src]() {
+                // on TCP worker
+                if(auto self = wself.lock())
+                    self->onUpdate(*update, src);
+            });
+        });
+        listener->start();
+    }
+
+    void onUpdate(MCastUpdate& update, const std::string& src)
+    {
+        auto sub(this->sub.lock());
+        if(!sub)
+            return;
+
+        timeval tmo(totv(timeout));
+        if(event_add(timer.get(), &tmo))
+            log_err_printf(io, "Unable to start multicast timeout for '%s'\n", channelName.c_str());
+
+        const bool first = peerName.empty();
+        if(first) {
+            peerName = src;
+            sub->push(Entry(std::make_exception_ptr(Connected(peerName)), Event::Connected));
+
+        } else if(update.seq==seq) {
+            return; // heartbeat
+
+        } else if(update.seq!=seq+1u && int32_t(update.seq-seq)>0) {
+            // lost some updates.  The latest is complete, but which fields changed is not known.
+            Guard G(sub->lock);
+            sub->nSrvSquash += update.seq-seq-1u;
+        }
+
+        if(first || skipped || update.seq!=seq+1u)
+            update.val.mark();
+        seq = update.seq;
+
+        // while paused, updates are not queued
+        skipped = sub->paused;
+        if(!skipped)
+            sub->push(Entry(std::move(update.val)));
+    }
+
+    static void expireS(evutil_socket_t fd, short evt, void *raw)
+    {
+        auto self = static_cast<MulticastMonitor*>(raw);
+        try {
+            if(self->peerName.empty())
+                return;
+            log_debug_printf(io, "Multicast timeout for '%s' from %s\n",
+                             self->channelName.c_str(), self->peerName.c_str());
+            self->peerName.clear();
+            if(auto sub = self->sub.lock())
+                sub->push(Entry(std::make_exception_ptr(Disconnect()), Event::Disconnect));
+        }catch(std::exception& e){
+            log_exc_printf(io, "Unhandled error in multicast timeout: %s\n", e.what());
+        }
+    }
+};
+DEFINE_INST_COUNTER(MulticastMonitor);
+
+bool SharedSubscription::cancel()
+{
+    decltype (event) junk;
+    bool ret = false;
+    (void)loop.tryCall([this, &junk, &ret](){
+        ret = _cancel();
+        junk = std::move(event);
+    });
+    return ret;
+}
+
+bool SharedSubscription::_cancel()
+{
+    if(auto mc = std::move(mcast))
+        return true;
+
+    auto mon(std::move(shared));
+    if(mon)
+        mon->detach(this);
+    return mon && !mon->done;
+}
+
+void SharedSubscription::pause(bool p)
+{
+    loop.call([this, p]() {
+        paused = p;
+        if(shared)
+            shared->updatePause();
+    });
+}
+
+std::shared_ptr<Subscription> MonitorBuilder::exec()
+{
+    if(!ctx)
+        throw std::logic_error("NULL Builder");
+
+    auto context(ctx->shardFor(_name));
+
+    const bool mcast = !_mcast.empty();
+    if(mcast && _latestOnly)
+        throw std::logic_error("MonitorBuilder::latestOnly() may not be combined with multicast()");
+    if(_sinkCB && (mcast || _latestOnly))
+        throw std::logic_error("MonitorBuilder::sink() may not be combined with latestOnly() or multicast()");
+
+    if((context->effective.shareMonitors || mcast) && !_onInit && _autoexec && !_latestOnly && !_sinkCB) {
+        auto pvRequest(_buildReq());
+        ContextImpl::SharedMonitorKey key(_name, _server,
+                                          SB()<<pvRequest<<(_passThrough ? "passThrough" : "")<<(_bulk ? "bulk" : ""));
+
+        auto sub(std::make_shared<SharedSubscription>(_name, context->tcp_loop));
+        sub->self = sub;
+        sub->maskConn = _maskConn;
+        sub->maskDiscon = _maskDisconn;
+        pvRequest["record._options.queueSize"].as<uint32_t>([&sub](uint32_t Q) {
+            if(Q>1)
+                sub->queueSize = Q;
+        });
+
+        auto syncCancel(_syncCancel);
+        std::shared_ptr<SharedSubscription> external(sub.get(), [sub, syncCancel](SharedSubscription*) mutable {
+            // from user thread
+            auto temp(std::move(sub));
+            auto loop(temp->loop);
+            loop.tryInvoke(syncCancel, std::bind([](std::shared_ptr<SharedSubscription>& sub) {
+                               // on worker
+                               sub->_cancel();
+                           }, std::move(temp)));
+        });
+        sub->serial = SerialExecutor::build(_executor);
+        sub->external = external;
+        sub->event = sub->wrapEvent(std::move(_event));
+
+        if(mcast) {
+            auto mc(std::make_shared<MulticastMonitor>(context->tcp_loop, _name, context->effective.tcpTimeout));
+            mc->sub = sub;
+            mc->start(_mcast);
+            context->tcp_loop.dispatch([sub, mc]() {
+                // on worker
+                sub->mcast = mc;
+            });
+            return external;
+        }
+
+        auto server(std::move(_server));
+        auto passThrough(_passThrough);
+        auto bulk(_bulk);
+        auto prio(_prio);
+        auto arrayAlloc(_arrayAlloc ? _arrayAlloc : context->effective.arrayAllocator);
+        context->tcp_loop.dispatch([sub, context, server, pvRequest, key, passThrough, bulk, prio, arrayAlloc]() {
+            // on worker
+
+            auto& ref = context->monitorsShared[key];
+            auto mon(ref.lock());
+            if(!mon) {
+                mon = std::make_shared<SharedMonitor>(context, key);
+                ref = mon;
+
+                auto op(impl::allocateOp<SubscriptionImpl>(context->opSlab, context->tcp_loop));
+                op->self = op;
+                op->channelName = sub->channelName;
+                op->pvRequest = pvRequest;
+                // sharing Subscriptions apply their own masks
+                op->maskConn = false;
+                op->maskDiscon = false;
+                op->passThrough = passThrough;
+                op->arrayAlloc = arrayAlloc;
+
+                parseOptions(*op);
+
+                mon->upstream = makeExternal(op, false);
+                op->external = mon->upstream;
+                std::weak_ptr<SharedMonitor> wmon(mon);
+                op->event = [wmon](Subscription&) {
+                    if(auto mon = wmon.lock())
+                        mon->fanout();
+                };
+
+                op->chan = Channel::build(context, op->channelName, server, bulk, prio);
+
+                op->chan->pending.push_back(op);
+                op->chan->createOperations();
+            }
+
+            sub->shared = mon;
+            mon->attach(sub);
+        });
+
+        return external;
+    }
+
+    auto op(impl::allocateOp<SubscriptionImpl>(context->opSlab, context->tcp_loop));
+    op->self = op;
+    op->channelName = std::move(_name);
+    op->pvRequest = _buildReq();
+    op->maskConn = _maskConn;
+    op->maskDiscon = _maskDisconn;
+    op->passThrough = _passThrough;
+    op->latestOnly = _latestOnly;
+    op->sinkMap = std::move(_sinkMap);
+    op->sinkDest = std::move(_sinkDest);
+    op->sinkCB = std::move(_sinkCB);
+    op->arrayAlloc = _arrayAlloc ? _arrayAlloc : context->effective.arrayAllocator;
+    op->autostart = _autoexec;
+
+    parseOptions(*op);
+
+    auto external(makeExternal(op, _syncCancel));
+    op->serial = SerialExecutor::build(_executor);
+    op->external = external;
+    op->event = op->wrapEvent(std::move(_event));
+    op->onInit = op->wrapInit(std::move(_onInit));
 
     auto server(std::move(_server));
-    context->tcp_loop.dispatch([op, context, server]() {
+    auto bulk(_bulk);
+    auto prio(_prio);
+    context->tcp_loop.dispatch([op, context, server, bulk, prio]() {
         // on worker
 
-        op->chan = Channel::build(context, op->channelName, server);
+        op->chan = Channel::build(context, op->channelName, server, bulk, prio);
 
         op->chan->pending.push_back(op);
         op->chan->createOperations();
@@ -866,5 +1903,203 @@ std::shared_ptr<Subscription> MonitorBuilder::exec()
     return external;
 }
 
+std::vector<std::shared_ptr<Subscription>> Context::monitorMany(const std::vector<std::string>& pvnames,
+                                                                const MonitorBuilder& proto)
+{
+    if(!pvt)
+        throw std::logic_error("NULL Context");
+    else if(proto._sinkCB)
+        throw std::logic_error("MonitorBuilder::sink() may not be used with monitorMany(), which would share one destination");
+
+    // shared by all
+    const auto pvRequest(proto._buildReq());
+
+    std::vector<std::shared_ptr<Subscription>> ret;
+    ret.reserve(pvnames.size());
+
+    typedef std::vector<std::shared_ptr<SubscriptionImpl>> ops_t;
+    std::map<std::shared_ptr<ContextImpl>, std::shared_ptr<ops_t>> byShard;
+
+    for(const auto& name : pvnames) {
+        auto& context(pvt->shardFor(name));
+
+        auto op(impl::allocateOp<SubscriptionImpl>(context->opSlab, context->tcp_loop));
+        op->self = op;
+        op->channelName = name;
+        op->pvRequest = pvRequest;
+        op->maskConn = proto._maskConn;
+        op->maskDiscon = proto._maskDisconn;
+        op->passThrough = proto._passThrough;
+        op->latestOnly = proto._latestOnly;
+        op->arrayAlloc = proto._arrayAlloc ? proto._arrayAlloc : context->effective.arrayAllocator;
+        op->autostart = proto._autoexec;
+
+        parseOptions(*op);
+
+        ret.push_back(makeExternal(op, proto._syncCancel));
+        op->serial = SerialExecutor::build(proto._executor);
+        op->external = ret.back();
+        op->event = op->wrapEvent(decltype (op->event)(proto._event));
+        op->onInit = op->wrapInit(decltype (op->onInit)(proto._onInit));
+
+        auto& ops = byShard[context];
+        if(!ops) {
+            ops = std::make_shared<ops_t>();
+            ops->reserve(pvnames.size());
+        }
+        ops->push_back(std::move(op));
+    }
+
+    auto server(proto._server);
+    auto bulk(proto._bulk);
+    auto prio(proto._prio);
+    for(auto& pair : byShard) {
+        auto context(pair.first);
+        auto ops(std::move(pair.second));
+
+        context->tcp_loop.dispatch([ops, context, server, bulk, prio]() {
+            // on worker
+
+            context->chanByName.reserve(context->chanByName.size() + ops->size());
+            context->chanByCID.reserve(context->chanByCID.size() + ops->size());
+
+            // new Channels join the initial search list, to be sent together
+            for(auto& op : *ops) {
+                op->chan = Channel::build(context, op->channelName, server, bulk, prio);
+
+                op->chan->pending.push_back(op);
+                op->chan->createOperations();
+            }
+        });
+    }
+
+    return ret;
+}
+
+namespace {
+// shared between a StreamOp and the event callback of its Subscription
+struct StreamState {
+    std::function<void(Value&&)> chunk;
+    std::function<void(Result&&)> result;
+    std::shared_ptr<ResultWaiter> waiter;
+    bool done = false; // only accessed from event callback
+
+    void complete(Result&& res)
+    {
+        done = true;
+        if(result) {
+            try {
+                result(std::move(res));
+            } catch(std::exception& e) {
+                log_err_printf(monevt, "Unhandled exception in stream result callback: %s\n", e.what());
+            }
+        } else {
+            waiter->complete(std::move(res), false);
+        }
+    }
+};
+
+// RPCBuilder::chunk().  A pipelined subscription with the RPC argument in its pvRequest.
+struct StreamOp : public Operation
+{
+    const std::string pvname;
+    const std::shared_ptr<StreamState> state;
+    std::shared_ptr<Subscription> sub;
+
+    StreamOp(const std::string& pvname, const std::shared_ptr<StreamState>& state)
+        :Operation(RPC)
+        ,pvname(pvname)
+        ,state(state)
+    {}
+    virtual ~StreamOp() {}
+
+    virtual const std::string& name() override final { return pvname; }
+
+    virtual bool cancel() override final { return sub->cancel(); }
+
+    virtual Value wait(double timeout) override final
+    {
+        if(!state->waiter)
+            throw std::logic_error("Operation has custom .result() callback");
+        return state->waiter->wait(timeout);
+    }
+
+    virtual void interrupt() override final
+    {
+        if(state->waiter)
+            state->waiter->complete(Result(), true);
+    }
+
+    virtual void _reExecGet(std::function<void(client::Result&&)>&& resultcb) override final
+    {
+        throw std::logic_error("reExecGet() not meaningful for rpc()");
+    }
+    virtual void _reExecPut(const Value& arg, std::function<void(client::Result&&)>&& resultcb) override final
+    {
+        throw std::logic_error("reExecPut() not meaningful for rpc()");
+    }
+};
+} // namespace
+
+std::shared_ptr<Operation> RPCBuilder::_exec_stream()
+{
+    using namespace pvxs::members;
+
+    if(!ctx)
+        throw std::logic_error("NULL Builder");
+
+    Value arg;
+    if(_argument) {
+        arg = _argument;
+    } else if(_args) {
+        arg = _uriArgs();
+        arg["path"] = _name;
+    }
+
+    // pvRequest with an extra "arg" member
+    record("pipeline", true);
+    auto req(_buildReq());
+    TypeDef def(req);
+    def += {Member(TypeCode::Any, "arg")};
+    auto pvRequest(def.create());
+    pvRequest.assign(req);
+    if(arg)
+        pvRequest["arg"].from(arg);
+
+    auto state(std::make_shared<StreamState>());
+    state->chunk = std::move(_chunk);
+    state->result = std::move(_result);
+    if(!state->result)
+        state->waiter = std::make_shared<ResultWaiter>();
+
+    std::shared_ptr<StreamOp> ret(new StreamOp(_name, state));
+    ret->sub = MonitorBuilder(ctx, _name)
+            .rawRequest(pvRequest)
+            .server(_server)
+            .priority(_prio)
+            .syncCancel(_syncCancel)
+            .executor(_executor)
+            .maskConnected(true)
+            .maskDisconnected(false)
+            .event([state](Subscription& sub) {
+                if(state->done)
+                    return;
+                try {
+                    while(auto val = sub.pop()) {
+                        state->chunk(std::move(val));
+                    }
+                } catch(Finished&) {
+                    state->complete(Result(Value(), std::string()));
+                } catch(std::exception&) {
+                    // remote error, disconnect, or from chunk()
+                    state->complete(Result(std::current_exception()));
+                    sub.cancel();
+                }
+            })
+            .exec();
+
+    return ret;
+}
+
 } // namespace client
 } // namespace pvxs
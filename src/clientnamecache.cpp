@@ -0,0 +1,152 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <epicsGuard.h>
+
+#include <pvxs/log.h>
+#include "utilpvt.h"
+#include "clientimpl.h"
+
+namespace pvxs {
+namespace client {
+
+DEFINE_LOGGER(setup, "pvxs.client.setup");
+
+DEFINE_INST_COUNTER(NameCache);
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+// as printed by operator<<(std::ostream&, const ServerGUID&)
+bool parseGUID(ServerGUID& guid, std::string hex)
+{
+    if(hex.size()>2u && hex[0]=='0' && hex[1]=='x')
+        hex = hex.substr(2u);
+    if(hex.size()!=2u*guid.size())
+        return false;
+    for(auto i : range(guid.size())) {
+        unsigned byte = 0u;
+        for(auto c : {hex[2u*i], hex[2u*i+1u]}) {
+            byte <<= 4u;
+            if(c>='0' && c<='9')
+                byte |= c-'0';
+            else if(c>='a' && c<='f')
+                byte |= c-'a'+10;
+            else if(c>='A' && c<='F')
+                byte |= c-'A'+10;
+            else
+                return false;
+        }
+        guid[i] = uint8_t(byte);
+    }
+    return true;
+}
+} // namespace
+
+NameCache::NameCache(const std::string& fname)
+    :fname(fname)
+{
+    std::ifstream in(fname);
+    if(!in.is_open()) {
+        log_debug_printf(setup, "No name cache %s\n", fname.c_str());
+        return;
+    }
+
+    std::string line;
+    size_t lineno = 0u;
+    while(std::getline(in, line)) {
+        lineno++;
+        if(line.empty() || line[0]=='#')
+            continue;
+
+        std::istringstream strm(line);
+        std::string name, hex, addr;
+        Entry ent;
+        strm>>name>>hex>>addr;
+
+        try {
+            if(!strm || !parseGUID(ent.guid, hex))
+                throw std::runtime_error("Malformed");
+            ent.server.setAddress(addr.c_str());
+            if(ent.server.port()==0)
+                throw std::runtime_error("Missing port");
+        }catch(std::exception& e){
+            log_warn_printf(setup, "%s:%zu %s.  Ignoring...\n", fname.c_str(), lineno, e.what());
+            continue;
+        }
+
+        names[name] = ent;
+    }
+
+    log_debug_printf(setup, "Read %zu names from %s\n", names.size(), fname.c_str());
+}
+
+bool NameCache::lookup(const std::string& name, Entry& out)
+{
+    Guard G(lock);
+    auto it(names.find(name));
+    if(it==names.end())
+        return false;
+    out = it->second;
+    return true;
+}
+
+void NameCache::learn(const std::string& name, const ServerGUID& guid, const SockAddr& server)
+{
+    Guard G(lock);
+    auto& ent = names[name];
+    if(ent.guid!=guid || ent.server!=server) {
+        ent.guid = guid;
+        ent.server = server;
+        dirty = true;
+    }
+}
+
+void NameCache::forget(const std::string& name)
+{
+    Guard G(lock);
+    if(names.erase(name))
+        dirty = true;
+}
+
+void NameCache::save()
+{
+    Guard G(lock);
+    if(!dirty)
+        return;
+
+    // replace as a whole, so that a reader never sees a partial file
+    std::string temp(SB()<<fname<<".tmp");
+    {
+        std::ofstream out(temp);
+        out<<"# PV name, server GUID, server address\n";
+        for(auto& pair : names) {
+            out<<pair.first<<' '<<pair.second.guid<<' '<<pair.second.server<<'\n';
+        }
+        out.close();
+        if(!out.good()) {
+            log_err_printf(setup, "Unable to write name cache %s\n", temp.c_str());
+            return;
+        }
+    }
+#ifdef _WIN32
+    (void)std::remove(fname.c_str());
+#endif
+    if(std::rename(temp.c_str(), fname.c_str())) {
+        log_err_printf(setup, "Unable to replace name cache %s\n", fname.c_str());
+        return;
+    }
+    dirty = false;
+
+    log_debug_printf(setup, "Wrote %zu names to %s\n", names.size(), fname.c_str());
+}
+
+} // namespace client
+} // namespace pvxs
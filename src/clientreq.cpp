@@ -5,9 +5,13 @@
  */
 
 #include <stdexcept>
+#include <list>
 #include <map>
 #include <string>
 
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
 #include <pvxs/version.h>
 #include <pvxs/client.h>
 #include "dataimpl.h"
@@ -17,6 +21,8 @@ namespace pvxs {
 namespace client {
 namespace detail {
 
+typedef epicsGuard<epicsMutex> Guard;
+
 struct CommonBase::Req {
     Value pvRequest;
 
@@ -24,27 +30,53 @@ struct CommonBase::Req {
 
     std::map<std::string, Value> options;
 
+    // Shared through ReqCache, with pvRequest built from fields and options.
+    // Must be copied before changing.
+    bool cached = false;
+    Value built;
+
     Req()
         :fields(TypeCode::Struct, "field")
     {}
+
+    // prepare to change *req
+    static
+    Req& change(std::shared_ptr<Req>& req) {
+        if(!req) {
+            req = std::make_shared<Req>();
+        } else if(req->cached) {
+            req = std::make_shared<Req>(*req);
+            req->cached = false;
+            req->built = Value();
+        }
+        return *req;
+    }
+
+    // Parsed pvRequest strings
+    struct Cache {
+        // Number of entries to keep
+        static constexpr size_t limit = 64u;
+
+        typedef std::pair<std::string, std::shared_ptr<Req>> Entry;
+
+        epicsMutex lock;
+        // most recently used first
+        std::list<Entry> lru;
+        std::map<std::string, std::list<Entry>::iterator> entries;
+    };
 };
 
 CommonBase::~CommonBase() {}
 
 void CommonBase::_rawRequest(const Value& raw)
 {
-    if(!req)
-        req = std::make_shared<Req>();
-    req->pvRequest = raw;
+    Req::change(req).pvRequest = raw;
 }
 void CommonBase::_field(const std::string& s)
 {
-    if(!req)
-        req = std::make_shared<Req>();
-
     size_t idx=0u;
 
-    decltype (req->fields) *cur = &req->fields;
+    decltype (req->fields) *cur = &Req::change(req).fields;
 
     while(idx<s.size()) {
         auto sep = s.find_first_of('.', idx);
@@ -84,10 +116,7 @@ void CommonBase::_field(const std::string& s)
 
 void CommonBase::_record(const std::string& key, const void* value, StoreType vtype)
 {
-    if(!req)
-        req = std::make_shared<Req>();
-
-    req->options[key] = Value::Helper::build(value, vtype);
+    Req::change(req).options[key] = Value::Helper::build(value, vtype);
 }
 
 struct PVRParser
@@ -282,10 +311,52 @@ struct PVRParser
     }
 };
 
-void CommonBase::_parse(const std::string& req)
+void CommonBase::_parse(const std::string& str)
 {
-    if(!req.empty())
-        PVRParser(*this, req.c_str()).parse();
+    if(str.empty()) {
+        return;
+
+    } else if(req) {
+        // combine with earlier field() or record()
+        PVRParser(*this, str.c_str()).parse();
+        return;
+    }
+
+    // Only a request string.  Commonly one of a few used by many operations.
+    static Req::Cache cache;
+    {
+        Guard G(cache.lock);
+        auto it(cache.entries.find(str));
+        if(it!=cache.entries.end()) {
+            cache.lru.splice(cache.lru.begin(), cache.lru, it->second);
+            req = it->second->second;
+            return;
+        }
+    }
+
+    // parse outside of lock.  May throw.
+    CommonBase temp;
+    PVRParser(temp, str.c_str()).parse();
+    Req::change(temp.req);
+    auto parsed(std::move(temp.req));
+    parsed->built = temp._buildReq();
+    parsed->cached = true;
+
+    Guard G(cache.lock);
+    auto it(cache.entries.find(str));
+    if(it!=cache.entries.end()) { // concurrent miss
+        cache.lru.splice(cache.lru.begin(), cache.lru, it->second);
+
+    } else {
+        cache.lru.emplace_front(str, parsed);
+        cache.entries[str] = cache.lru.begin();
+
+        if(cache.lru.size() > Req::Cache::limit) {
+            cache.entries.erase(cache.lru.back().first);
+            cache.lru.pop_back();
+        }
+    }
+    req = std::move(parsed);
 }
 
 Value CommonBase::_buildReq() const
@@ -293,6 +364,9 @@ Value CommonBase::_buildReq() const
     if(req && req->pvRequest) {
         return req->pvRequest;
 
+    } else if(req && req->cached) {
+        return req->built;
+
     } else if(!req) {
         using namespace pvxs::members;
         return TypeDef(TypeCode::Struct, {
@@ -5,6 +5,8 @@
  */
 
 #include <algorithm>
+#include <map>
+#include <tuple>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -16,6 +18,9 @@
 #include <epicsMath.h>
 #include <epicsStdlib.h>
 #include <epicsString.h>
+#include <epicsGuard.h>
+#include <epicsMutex.h>
+#include <epicsTime.h>
 
 #include <pvxs/log.h>
 #include "serverconn.h"
@@ -23,6 +28,10 @@
 #include "utilpvt.h"
 #include "evhelper.h"
 
+#if EPICS_VERSION_INT<VERSION_INT(7,0,3,1)
+#  define getMonotonic getCurrent
+#endif
+
 DEFINE_LOGGER(serversetup, "pvxs.server.setup");
 DEFINE_LOGGER(clientsetup, "pvxs.client.setup");
 DEFINE_LOGGER(config, "pvxs.config");
@@ -85,6 +94,16 @@ SockEndpoint::SockEndpoint(const char* ep, uint16_t defport)
     }
 }
 
+bool SockEndpoint::isHostName(const std::string& ep)
+{
+    SockAddr temp;
+    try {
+        return !temp.setNumericAddress(ep.substr(0u, ep.find_first_of(",@")).c_str());
+    }catch(std::exception&){
+        return false; // malformed.  Reported when actually parsed
+    }
+}
+
 MCastMembership SockEndpoint::resolve() const
 {
     if(!addr.isMCast())
@@ -149,7 +168,7 @@ namespace {
 constexpr double tmoScale = 4.0/3.0; // 40 second idle timeout / 30 configured
 
 void split_addr_into(const char* name, std::vector<std::string>& out, const std::string& inp,
-                     uint16_t defaultPort, bool required=false)
+                     uint16_t defaultPort, bool required=false, bool deferDNS=false)
 {
     size_t pos=0u;
 
@@ -162,6 +181,11 @@ void split_addr_into(const char* name, std::vector<std::string>& out, const std:
 
         if(start<end) {
             auto temp(inp.substr(start, end==std::string::npos ? end : end-start));
+            if(deferDNS && SockEndpoint::isHostName(temp)) {
+                // kept as written.  Looked up later, without blocking.  cf. ContextImpl::lookupHostNames()
+                out.push_back(temp);
+                continue;
+            }
             try {
                 SockEndpoint ep(temp);
                 if(ep.addr.port()==0)
@@ -284,8 +308,7 @@ void printAddresses(std::vector<std::string>& out, const std::vector<SockEndpoin
 void expandAddrList(const std::vector<SockEndpoint>& ifaces,
                     std::vector<SockEndpoint>& addrs)
 {
-    SockAttach attach;
-    evsocket dummy(AF_INET, SOCK_DGRAM, 0);
+    auto& ifmap = IfaceMap::instance();
 
     for(auto& saddr : ifaces) {
         auto matchAddr = &saddr.addr;
@@ -299,7 +322,7 @@ void expandAddrList(const std::vector<SockEndpoint>& ifaces,
             continue;
         }
 
-        for(auto& addr : dummy.broadcasts(matchAddr)) {
+        for(auto& addr : ifmap.broadcasts(matchAddr)) {
             addr.setPort(0u);
             addrs.emplace_back(addr);
         }
@@ -389,6 +412,138 @@ void enforceTimeout(double& tmo)
         tmo = 2.0;
 }
 
+void parse_uint(unsigned& dest, const std::string& name, const std::string& val)
+{
+    try {
+        auto temp = parseTo<uint64_t>(val);
+        if(temp > std::numeric_limits<unsigned>::max())
+            throw std::out_of_range("Out of range");
+        dest = unsigned(temp);
+    } catch(std::exception& e) {
+        log_err_printf(config, "%s invalid integer : %s\n", name.c_str(), e.what());
+    }
+}
+
+// TCP socket options common to server and client Config.
+// prefix is "EPICS_PVAS_" or "EPICS_PVA_"
+template<typename Conf>
+void tcpOptionsFromDefs(Conf& self, PickOne& pickone, const std::string& prefix)
+{
+    if(pickone({(prefix+"TCP_SEND_BUFFER").c_str()})) {
+        parse_uint(self.tcpSendBuffer, pickone.name, pickone.val);
+    }
+
+    if(pickone({(prefix+"TCP_RECV_BUFFER").c_str()})) {
+        parse_uint(self.tcpRecvBuffer, pickone.name, pickone.val);
+    }
+
+    if(pickone({(prefix+"TCP_NODELAY").c_str()})) {
+        parse_bool(self.tcpNoDelay, pickone.name, pickone.val);
+    }
+
+    if(pickone({(prefix+"TCP_BUSY_POLL").c_str()})) {
+        parse_uint(self.tcpBusyPoll, pickone.name, pickone.val);
+    }
+
+    if(pickone({(prefix+"TCP_NOTSENT_LOWAT").c_str()})) {
+        parse_uint(self.tcpNotSentLowat, pickone.name, pickone.val);
+    }
+
+    if(pickone({(prefix+"TCP_KEEPALIVE").c_str()})) {
+        parse_bool(self.tcpKeepAlive, pickone.name, pickone.val);
+    }
+
+    if(pickone({(prefix+"TCP_WORKER_CPUS").c_str()})) {
+        self.tcpWorkerCPUs = pickone.val;
+    }
+
+    if(pickone({(prefix+"TCP_WORKER_PRIORITY").c_str()})) {
+        parse_uint(self.tcpWorkerPriority, pickone.name, pickone.val);
+    }
+}
+
+template<typename Conf>
+void tcpOptionsToDefs(const Conf& self, std::map<std::string, std::string>& defs, const std::string& prefix)
+{
+    defs[prefix+"TCP_SEND_BUFFER"] = SB()<<self.tcpSendBuffer;
+    defs[prefix+"TCP_RECV_BUFFER"] = SB()<<self.tcpRecvBuffer;
+    defs[prefix+"TCP_NODELAY"] = self.tcpNoDelay ? "YES" : "NO";
+    defs[prefix+"TCP_BUSY_POLL"] = SB()<<self.tcpBusyPoll;
+    defs[prefix+"TCP_NOTSENT_LOWAT"] = SB()<<self.tcpNotSentLowat;
+    defs[prefix+"TCP_KEEPALIVE"] = self.tcpKeepAlive ? "YES" : "NO";
+    defs[prefix+"TCP_WORKER_CPUS"] = self.tcpWorkerCPUs;
+    defs[prefix+"TCP_WORKER_PRIORITY"] = SB()<<self.tcpWorkerPriority;
+}
+
+// validate thread placement options common to server and client Config.
+template<typename Conf>
+void expandThreadOptions(Conf& self)
+{
+    try {
+        (void)parseCPUGroups(self.tcpWorkerCPUs);
+    } catch(std::exception& e) {
+        log_err_printf(config, "Ignoring invalid TCP worker CPU list : %s\n", e.what());
+        self.tcpWorkerCPUs.clear();
+    }
+
+    if(self.tcpWorkerPriority > epicsThreadPriorityMax)
+        self.tcpWorkerPriority = epicsThreadPriorityMax;
+}
+
+/* Memo of the costly part of expand().  Parsing address lists, which may
+ * resolve host names, and enumerating interfaces.  Entries are
+ * dropped after a short time, or when IfaceMap sees a change to interfaces.
+ */
+struct ExpandMemo {
+    // (client or server, interfaces, address list, auto address list)
+    typedef std::tuple<char, std::vector<std::string>, std::vector<std::string>, bool> key_t;
+    struct Entry {
+        std::vector<std::string> ifaces, addrs;
+        epicsTime when;
+        uint64_t version;
+    };
+
+    epicsMutex lock;
+    std::map<key_t, Entry> entries;
+
+    static
+    ExpandMemo& instance() {
+        static ExpandMemo memo;
+        return memo;
+    }
+
+    // on hit, replace ifaces and addrs with expanded lists
+    bool lookup(const key_t& key,
+                std::vector<std::string>& ifaces,
+                std::vector<std::string>& addrs)
+    {
+        auto version(IfaceMap::instance().version());
+        auto now(epicsTime::getMonotonic());
+        epicsGuard<epicsMutex> G(lock);
+        auto it(entries.find(key));
+        if(it==entries.end())
+            return false;
+        if(it->second.version!=version || now - it->second.when >= 10.0) {
+            entries.erase(it);
+            return false;
+        }
+        ifaces = it->second.ifaces;
+        addrs = it->second.addrs;
+        return true;
+    }
+
+    void store(const key_t& key,
+               const std::vector<std::string>& ifaces,
+               const std::vector<std::string>& addrs)
+    {
+        Entry ent{ifaces, addrs, epicsTime::getMonotonic(), IfaceMap::instance().version()};
+        epicsGuard<epicsMutex> G(lock);
+        if(entries.size() >= 64u)
+            entries.clear();
+        entries[key] = std::move(ent);
+    }
+};
+
 } // namespace
 
 namespace server {
@@ -433,6 +588,63 @@ void _fromDefs(Config& self, const std::map<std::string, std::string>& defs, boo
     if(pickone({"EPICS_PVA_CONN_TMO"})) {
         parse_timeout(self.tcpTimeout, pickone.name, pickone.val);
     }
+
+    if(pickone({"EPICS_PVAS_TCP_WORKERS"})) {
+        try {
+            self.tcpWorkers = parseTo<uint64_t>(pickone.val);
+        }catch(std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if(pickone({"EPICS_PVAS_SEARCH_WORKERS"})) {
+        try {
+            self.searchWorkers = parseTo<uint64_t>(pickone.val);
+        }catch(std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    tcpOptionsFromDefs(self, pickone, "EPICS_PVAS_");
+
+    if(pickone({"EPICS_PVAS_TCP_REUSEPORT"})) {
+        parse_bool(self.tcpReusePort, pickone.name, pickone.val);
+    }
+
+    if(pickone({"EPICS_PVAS_SEARCH_FILTER"})) {
+        parse_bool(self.searchFilter, pickone.name, pickone.val);
+    }
+
+    if(pickone({"EPICS_PVAS_STATS_PV"})) {
+        self.statsPV = pickone.val;
+    }
+
+    if(pickone({"EPICS_PVAS_STATS_INTERVAL"})) {
+        try {
+            auto temp = parseTo<double>(pickone.val);
+            if(!std::isfinite(temp) || temp<=0.0)
+                throw std::out_of_range("Out of range");
+            self.statsInterval = temp;
+        }catch(std::exception& e) {
+            log_err_printf(serversetup, "%s invalid interval : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if(pickone({"EPICS_PVAS_CONN_MEM_LIMIT"})) {
+        try {
+            self.connMemoryLimit = parseTo<uint64_t>(pickone.val);
+        }catch(std::exception& e) {
+            log_err_printf(serversetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if(pickone({"EPICS_PVAS_UNIX_SOCKET_DIR", "EPICS_PVA_UNIX_SOCKET_DIR"})) {
+        self.unixSocketDir = pickone.val;
+    }
+
+    if(pickone({"EPICS_PVAS_PEER_BYTE_ORDER"})) {
+        parse_bool(self.peerByteOrder, pickone.name, pickone.val);
+    }
 }
 
 Config& Config::applyEnv()
@@ -479,12 +691,23 @@ void Config::updateDefs(defs_t& defs) const
     defs["EPICS_PVA_INTF_ADDR_LIST"] = defs["EPICS_PVAS_INTF_ADDR_LIST"]   = join_addr(interfaces);
     defs["EPICS_PVAS_IGNORE_ADDR_LIST"]   = join_addr(ignoreAddrs);
     defs["EPICS_PVA_CONN_TMO"] = SB()<<tcpTimeout/tmoScale;
+    defs["EPICS_PVAS_TCP_WORKERS"] = SB()<<tcpWorkers;
+    defs["EPICS_PVAS_SEARCH_WORKERS"] = SB()<<searchWorkers;
+    tcpOptionsToDefs(*this, defs, "EPICS_PVAS_");
+    defs["EPICS_PVAS_TCP_REUSEPORT"] = tcpReusePort ? "YES" : "NO";
+    defs["EPICS_PVAS_SEARCH_FILTER"] = searchFilter ? "YES" : "NO";
+    defs["EPICS_PVAS_STATS_PV"] = statsPV;
+    defs["EPICS_PVAS_STATS_INTERVAL"] = SB()<<statsInterval;
+    defs["EPICS_PVAS_CONN_MEM_LIMIT"] = SB()<<connMemoryLimit;
+    defs["EPICS_PVA_UNIX_SOCKET_DIR"] = defs["EPICS_PVAS_UNIX_SOCKET_DIR"] = unixSocketDir;
+    defs["EPICS_PVAS_PEER_BYTE_ORDER"] = peerByteOrder ? "YES" : "NO";
 }
 
-void Config::expand()
+static
+void expandAddrs(Config& self)
 {
-    auto ifaces(parseAddresses(interfaces));
-    auto bdest(parseAddresses(beaconDestinations));
+    auto ifaces(parseAddresses(self.interfaces));
+    auto bdest(parseAddresses(self.beaconDestinations));
 
     // empty interface address list implies the wildcard
     // (because no addresses isn't interesting...)
@@ -508,23 +731,42 @@ void Config::expand()
         // ep invalidated by emplace()
     }
 
-    if(auto_beacon) {
+    if(self.auto_beacon) {
         // use interface list add ipv4 broadcast addresses to beaconDestinations.
         // 0.0.0.0 -> adds all bcasts
         // otherwise add bcast for each iface address
         expandAddrList(ifaces, bdest);
         addGroups(ifaces, bdest);
-        auto_beacon = false;
+        self.auto_beacon = false;
     }
 
     removeDups(ifaces);
-    printAddresses(interfaces, ifaces);
+    printAddresses(self.interfaces, ifaces);
     removeDups(bdest);
-    printAddresses(beaconDestinations, bdest);
+    printAddresses(self.beaconDestinations, bdest);
+}
+
+void Config::expand()
+{
+    auto& memo = ExpandMemo::instance();
+    const ExpandMemo::key_t key{'S', interfaces, beaconDestinations, auto_beacon};
+    if(memo.lookup(key, interfaces, beaconDestinations)) {
+        auto_beacon = false;
+    } else {
+        expandAddrs(*this);
+        memo.store(key, interfaces, beaconDestinations);
+    }
+
     removeDups(ignoreAddrs);
 
     enforceTimeout(tcpTimeout);
 
+    if(tcpWorkers==0u)
+        tcpWorkers = 1u;
+    if(searchWorkers==0u)
+        searchWorkers = 1u;
+
+    expandThreadOptions(*this);
 }
 
 std::ostream& operator<<(std::ostream& strm, const Config& conf)
@@ -577,11 +819,11 @@ void _fromDefs(Config& self, const std::map<std::string, std::string>& defs, boo
     }
 
     if(pickone({"EPICS_PVA_ADDR_LIST"})) {
-        split_addr_into(pickone.name.c_str(), self.addressList, pickone.val, self.udp_port);
+        split_addr_into(pickone.name.c_str(), self.addressList, pickone.val, self.udp_port, false, true);
     }
 
     if(pickone({"EPICS_PVA_NAME_SERVERS"})) {
-        split_addr_into(pickone.name.c_str(), self.nameServers, pickone.val, self.tcp_port);
+        split_addr_into(pickone.name.c_str(), self.nameServers, pickone.val, self.tcp_port, false, true);
     }
 
     if(pickone({"EPICS_PVA_AUTO_ADDR_LIST"})) {
@@ -595,6 +837,36 @@ void _fromDefs(Config& self, const std::map<std::string, std::string>& defs, boo
     if(pickone({"EPICS_PVA_CONN_TMO"})) {
         parse_timeout(self.tcpTimeout, pickone.name, pickone.val);
     }
+
+    if(pickone({"EPICS_PVA_TCP_WORKERS"})) {
+        try {
+            self.tcpWorkers = parseTo<uint64_t>(pickone.val);
+        }catch(std::exception& e) {
+            log_warn_printf(clientsetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    if(pickone({"EPICS_PVA_TCP_STREAMS"})) {
+        try {
+            self.tcpStreams = parseTo<uint64_t>(pickone.val);
+        }catch(std::exception& e) {
+            log_warn_printf(clientsetup, "%s invalid integer : %s", pickone.name.c_str(), e.what());
+        }
+    }
+
+    tcpOptionsFromDefs(self, pickone, "EPICS_PVA_");
+
+    if(pickone({"EPICS_PVA_TCP_BULK_RECV_BUFFER"})) {
+        parse_uint(self.tcpBulkRecvBuffer, pickone.name, pickone.val);
+    }
+
+    if(pickone({"EPICS_PVA_UNIX_SOCKET_DIR"})) {
+        self.unixSocketDir = pickone.val;
+    }
+
+    if(pickone({"EPICS_PVA_NAME_CACHE"})) {
+        self.nameCacheFile = pickone.val;
+    }
 }
 
 Config& Config::applyEnv()
@@ -618,33 +890,66 @@ void Config::updateDefs(defs_t& defs) const
     defs["EPICS_PVA_INTF_ADDR_LIST"] = join_addr(interfaces);
     defs["EPICS_PVA_CONN_TMO"] = SB()<<tcpTimeout/tmoScale;
     defs["EPICS_PVA_NAME_SERVERS"] = join_addr(nameServers);
+    defs["EPICS_PVA_TCP_WORKERS"] = SB()<<tcpWorkers;
+    defs["EPICS_PVA_TCP_STREAMS"] = SB()<<tcpStreams;
+    defs["EPICS_PVA_TCP_BULK_RECV_BUFFER"] = SB()<<tcpBulkRecvBuffer;
+    tcpOptionsToDefs(*this, defs, "EPICS_PVA_");
+    defs["EPICS_PVA_UNIX_SOCKET_DIR"] = unixSocketDir;
+    defs["EPICS_PVA_NAME_CACHE"] = nameCacheFile;
 }
 
-void Config::expand()
+static
+void expandAddrs(Config& self)
 {
-    if(udp_port==0)
-        throw std::runtime_error("Client can't use UDP random port");
-
-    if(tcp_port==0)
-        tcp_port = 5075;
+    // host names are kept as written, and looked up later without blocking.
+    // cf. ContextImpl::lookupHostNames()
+    std::vector<std::string> hosts, numeric;
+    for(auto& addr : self.addressList)
+        (SockEndpoint::isHostName(addr) ? hosts : numeric).push_back(addr);
 
-    auto ifaces(parseAddresses(interfaces));
-    auto addrs(parseAddresses(addressList));
+    auto ifaces(parseAddresses(self.interfaces));
+    auto addrs(parseAddresses(numeric));
 
     if(ifaces.empty())
         ifaces.emplace_back(SockAddr::any(AF_INET));
 
-    if(autoAddrList) {
+    if(self.autoAddrList) {
         expandAddrList(ifaces, addrs);
         addGroups(ifaces, addrs);
-        autoAddrList = false;
+        self.autoAddrList = false;
     }
 
-    printAddresses(interfaces, ifaces);
+    printAddresses(self.interfaces, ifaces);
     removeDups(addrs);
-    printAddresses(addressList, addrs);
+    printAddresses(self.addressList, addrs);
+    self.addressList.insert(self.addressList.end(), hosts.begin(), hosts.end());
+}
+
+void Config::expand()
+{
+    if(udp_port==0)
+        throw std::runtime_error("Client can't use UDP random port");
+
+    if(tcp_port==0)
+        tcp_port = 5075;
+
+    auto& memo = ExpandMemo::instance();
+    const ExpandMemo::key_t key{'C', interfaces, addressList, autoAddrList};
+    if(memo.lookup(key, interfaces, addressList)) {
+        autoAddrList = false;
+    } else {
+        expandAddrs(*this);
+        memo.store(key, interfaces, addressList);
+    }
 
     enforceTimeout(tcpTimeout);
+
+    if(tcpWorkers==0u)
+        tcpWorkers = 1u;
+    if(tcpStreams==0u)
+        tcpStreams = 1u;
+
+    expandThreadOptions(*this);
 }
 
 std::ostream& operator<<(std::ostream& strm, const Config& conf)
@@ -4,12 +4,21 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <limits>
+#include <system_error>
+#include <vector>
+
+#include <stddef.h>
+#include <string.h>
 
 #include <epicsAssert.h>
 
 #include <pvxs/log.h>
+#include <pvxs/unittest.h>
 #include "conn.h"
+#include "tracepoint.h"
 
 DEFINE_LOGGER(connsetup, "pvxs.tcp.setup");
 DEFINE_LOGGER(connio, "pvxs.tcp.io");
@@ -26,6 +35,77 @@ namespace impl {
 static
 constexpr size_t tcp_readahead_mult = 2u;
 
+// Readahead is raised, up to this multiple of the initial readahead, while
+// many small messages arrive in each batch.  cf. ConnBase::adaptReadahead()
+#ifndef PVXS_SMALL_FOOTPRINT
+static
+constexpr size_t tcp_readahead_max_mult = 8u;
+#else
+static
+constexpr size_t tcp_readahead_max_mult = 1u; // not raised
+#endif
+
+// Messages, with header, averaging smaller than this are "small".
+static
+constexpr size_t tcp_small_msg = 1024u;
+
+// Upper bound on RX buffer space reserved for the remainder of a large message
+// whose header has arrived.  Limits the effect of a bogus length.
+#ifndef PVXS_SMALL_FOOTPRINT
+static
+constexpr size_t tcp_rx_presize_max = 64u*1024u*1024u;
+#else
+static
+constexpr size_t tcp_rx_presize_max = 256u*1024u;
+#endif
+
+// Message bodies up to this size are copied into the TX buffer.
+// Larger bodies are moved.  cf. ConnBase::enqueueTxBody()
+static
+constexpr size_t tcp_tx_copy_max = 1024u;
+
+// Message bodies at least this large may be compressed.  cf. ConnBase::enqueueTxBody()
+static
+constexpr size_t tcp_compress_min = 4096u;
+
+// With emulated loss, a TCP read is held for this much longer (ns), as for a retransmission
+// after the usual minimum retransmission timeout.  cf. testNetImpair()
+static
+constexpr uint64_t tcp_impair_rto = 200000000u;
+
+// Refill interval (us) of the token bucket emulating a bandwidth limit.  cf. testNetImpair()
+static
+constexpr long tcp_impair_tick = 10000;
+
+constexpr size_t LatencyHistogram::nBuckets;
+
+uint64_t LatencyHistogram::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyHistogram::add(uint64_t start)
+{
+    auto cur(now());
+    uint64_t usec = cur > start ? (cur - start)/1000u : 0u;
+    // bucket 0 is < 1 us, bucket i is [2^(i-1), 2^i) us, the last also includes anything longer
+    size_t bucket = 0u;
+    while(usec && bucket < nBuckets-1u) {
+        usec >>= 1u;
+        bucket++;
+    }
+    count[bucket].fetch_add(1u, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::take(size_t* out, bool zero)
+{
+    for(auto i : range(nBuckets)) {
+        out[i] += zero ? count[i].exchange(0u, std::memory_order_relaxed)
+                       : count[i].load(std::memory_order_relaxed);
+    }
+}
+
 ConnBase::ConnBase(bool isClient, bool sendBE, bufferevent* bev, const SockAddr& peerAddr)
     :peerAddr(peerAddr)
     ,peerName(peerAddr.tostring())
@@ -50,6 +130,22 @@ const char* ConnBase::peerLabel() const
     return isClient ? "Server" : "Client";
 }
 
+void ConnBase::memoryUsage(size_t& types, size_t& tx, size_t& rx) const
+{
+    types = txTypes.approxBytes() + approxBytes(rxRegistry);
+    tx = evbuffer_get_length(txBody.get());
+    rx = evbuffer_get_length(segBuf.get());
+    if(auto ev = bev.get()) {
+        tx += evbuffer_get_length(bufferevent_get_output(ev));
+        rx += evbuffer_get_length(bufferevent_get_input(ev));
+    }
+    if(rxDelay) {
+        rx += evbuffer_get_length(rxDelay->ready.get());
+        for(auto& chunk : rxDelay->pending)
+            rx += evbuffer_get_length(chunk.data.get());
+    }
+}
+
 void ConnBase::connect(bufferevent* bev)
 {
     if(!bev)
@@ -66,6 +162,7 @@ void ConnBase::connect(bufferevent* bev)
 #endif
 
     readahead *= tcp_readahead_mult;
+    readaheadBase = readahead;
 
 #if LIBEVENT_VERSION_NUMBER >= 0x02010000
     // allow attempt to write as much as is available
@@ -76,28 +173,127 @@ void ConnBase::connect(bufferevent* bev)
 
     // initially wait for at least a header
     bufferevent_setwatermark(this->bev.get(), EV_READ, 8, readahead);
+
+    capture = WireCapture::create(peerName);
+
+    NetImpairment imp;
+    if(netImpairment(imp)) {
+        if(imp.bandwidth) {
+            timeval tick{};
+            tick.tv_usec = tcp_impair_tick;
+            auto rate = std::max(size_t(1u), size_t(imp.bandwidth*(tcp_impair_tick*1e-6)));
+            rateLimit = evratelimit(__FILE__, __LINE__, ev_token_bucket_cfg_new(rate, rate, rate, rate, &tick));
+            if(bufferevent_set_rate_limit(bev, rateLimit.get()))
+                log_warn_printf(connsetup, "%s %s Unable to limit bandwidth\n", peerLabel(), peerName.c_str());
+        }
+        if(imp.latency>0.0 || imp.loss>0.0) {
+            rxDelay.reset(new RxDelay{uint64_t(imp.latency*1e9), {},
+                                      evbuf(__FILE__, __LINE__, evbuffer_new()),
+                                      evevent(__FILE__, __LINE__,
+                                              event_new(bufferevent_get_base(bev), -1, EV_TIMEOUT, &rxDelayS, this))});
+            // every read is moved to the delay queue, so wait for nothing
+            bufferevent_setwatermark(bev, EV_READ, 1, 0);
+        }
+    }
 }
 
 void ConnBase::disconnect()
 {
     bev.reset();
+    rxDelay.reset();
+    rateLimit.reset();
     state = Disconnected;
 }
 
-size_t ConnBase::enqueueTxBody(pva_app_msg_t cmd)
+size_t ConnBase::enqueueTxBody(pva_app_msg_t cmd, bool compress)
 {
-    auto blen = evbuffer_get_length(txBody.get());
+    uint8_t flags = isClient ? 0u : pva_flags::Server;
+
+    if(compress && peerLZ4 && evbuffer_get_length(txBody.get()) >= tcp_compress_min) {
+        const auto ulen = evbuffer_get_length(txBody.get());
+        // body is the uncompressed length, followed by an LZ4 block.
+        // Only worthwhile if at least 1/8th smaller.
+        std::vector<uint8_t> comp(4u + ulen - ulen/8u);
+        auto clen = lz4Compress(evbuffer_pullup(txBody.get(), -1), ulen,
+                                comp.data()+4u, comp.size()-4u);
+        if(clen) {
+            FixedBuf L(sendBE, comp.data(), 4u);
+            to_wire(L, uint32_t(ulen));
+            (void)evbuffer_drain(txBody.get(), ulen);
+            if(evbuffer_add(txBody.get(), comp.data(), 4u + clen))
+                throw BAD_ALLOC();
+            flags |= pva_flags::Compressed;
+        }
+    }
+
+    const auto blen = evbuffer_get_length(txBody.get());
     auto tx = bufferevent_get_output(bev.get());
-    to_evbuf(tx, Header{cmd,
-                        uint8_t(isClient ? 0u : pva_flags::Server),
-                        uint32_t(blen)},
-             sendBE);
-    auto err = evbuffer_add_buffer(tx, txBody.get());
-    assert(!err); // could only fail if frozen/pinned, which is not the case
+    const Header H{cmd,
+                   flags,
+                   uint32_t(blen)};
+    PVXS_TRACE4(tcp_tx, int(isClient), peerName.c_str(), uint8_t(cmd), blen);
+    if(capture) {
+        uint8_t header[8];
+        FixedBuf M(sendBE, header, sizeof(header));
+        to_wire(M, H);
+        capture->add(true, header, sizeof(header), txBody.get(), blen);
+    }
+    to_evbuf(tx, H, sendBE);
+    if(blen <= tcp_tx_copy_max) {
+        // Copy small bodies into the free space at the end of the TX buffer.
+        // Moving chains would result in (at least) one chain per message,
+        // and so one iovec per message when all queued in one loop iteration
+        // are written out together.
+        evbuffer_iovec vecs[4];
+        auto n = evbuffer_peek(txBody.get(), -1, nullptr, vecs, 4);
+        if(n>=0 && n<=4) {
+            for(auto i : range(n)) {
+                if(evbuffer_add(tx, vecs[i].iov_base, vecs[i].iov_len))
+                    throw BAD_ALLOC();
+            }
+            (void)evbuffer_drain(txBody.get(), blen);
+        }
+    }
+    if(evbuffer_get_length(txBody.get())) {
+        auto err = evbuffer_add_buffer(tx, txBody.get());
+        assert(!err); // could only fail if frozen/pinned, which is not the case
+    }
     statTx += 8u + blen;
     return 8u + blen;
 }
 
+bool ConnBase::decompressSegBuf()
+{
+    const auto clen = evbuffer_get_length(segBuf.get());
+    if(clen < 4u)
+        return false;
+    auto body = evbuffer_pullup(segBuf.get(), -1);
+
+    uint32_t ulen = 0u;
+    FixedBuf L(peerBE, body, 4u);
+    from_wire(L, ulen);
+    // LZ4 expands at most ~255x.  Refuse anything claiming more.
+    if(!L.good() || ulen/255u > clen)
+        return false;
+
+    evbuf out(__FILE__, __LINE__, evbuffer_new());
+    evbuffer_iovec vec{};
+    if(ulen && (evbuffer_reserve_space(out.get(), ulen, &vec, 1)!=1 || vec.iov_len < ulen))
+        throw BAD_ALLOC();
+
+    if(!lz4Decompress(body+4u, clen-4u, static_cast<uint8_t*>(vec.iov_base), ulen))
+        return false;
+
+    vec.iov_len = ulen;
+    if(ulen && evbuffer_commit_space(out.get(), &vec, 1))
+        throw BAD_ALLOC();
+
+    (void)evbuffer_drain(segBuf.get(), clen);
+    if(evbuffer_add_buffer(segBuf.get(), out.get()))
+        throw BAD_ALLOC();
+    return true;
+}
+
 #define CASE(Op) void ConnBase::handle_##Op() {}
     CASE(ECHO);
     CASE(CONNECTION_VALIDATION);
@@ -146,7 +342,11 @@ void ConnBase::bevEvent(short events)
 void ConnBase::bevRead()
 {
     auto rx = bufferevent_get_input(bev.get());
+    if(rxDelay)
+        rx = delayRx(rx);
     auto remaining = evbuffer_get_length(rx);
+    // application messages handled by this call
+    size_t nmsg = 0u;
 
     while(bev && remaining >= 8) {
         uint8_t header[8];
@@ -181,9 +381,19 @@ void ConnBase::bevRead()
                  *
                  * So we latch the byte order here, as the peer should ignore the MSB
                  * flag subsequent messages...
+                 *
+                 * ... unless 0xffffffff, which a PVXS server sends with server::Config::peerByteOrder.
+                 * Then keep our own byte order, which the server will adopt.
                  */
-                sendBE = header[2]&pva_flags::MSB;
+                if(isClient && header[4]==0xff && header[5]==0xff && header[6]==0xff && header[7]==0xff) {
+                    log_debug_printf(connio, "%s %s Keep byte order %s\n", peerLabel(), peerName.c_str(),
+                                     sendBE ? "BE" : "LE");
+                } else {
+                    sendBE = header[2]&pva_flags::MSB;
+                }
             }
+            if(capture)
+                capture->add(false, nullptr, 0u, rx, 8u);
             // Control messages are not actually useful
             evbuffer_drain(rx, 8);
             statRx += 8u;
@@ -195,6 +405,14 @@ void ConnBase::bevRead()
         peerBE = header[2]&pva_flags::MSB;
         peerVersion = header[1];
 
+        if(adoptPeerBE) {
+            // first reply to our SetEndian.  Send future messages in the peer's byte order.
+            adoptPeerBE = false;
+            sendBE = peerBE;
+            log_debug_printf(connio, "%s %s Adopt byte order %s\n", peerLabel(), peerName.c_str(),
+                             sendBE ? "BE" : "LE");
+        }
+
         // a bit verbose :P
         FixedBuf L(peerBE, header+4, 4);
         uint32_t len = 0;
@@ -207,10 +425,26 @@ void ConnBase::bevRead()
             size_t newmax = 8 + len;
             if(newmax < std::numeric_limits<size_t>::max()-readahead)
                 newmax += readahead;
-            bufferevent_setwatermark(bev.get(), EV_READ, 8 + len, newmax);
+            if(!rxDelay)
+                bufferevent_setwatermark(bev.get(), EV_READ, 8 + len, newmax);
+
+            // the length is known.  For a large message, reserve space for the remainder
+            // now, instead of accumulating many socket buffer sized chains.
+            auto shortfall = 8u + len - remaining;
+            if(len >= readahead)
+                (void)evbuffer_expand(rx, std::min(shortfall, tcp_rx_presize_max));
+
+            adaptReadahead(nmsg);
             return;
         }
 
+        if(capture)
+            capture->add(false, nullptr, 0u, rx, 8u + len);
+
+        nmsg++;
+        // moving average over ~16 messages
+        rxAvgSize += (double(8u + len) - rxAvgSize)/16.0;
+
         evbuffer_drain(rx, 8);
         {
             unsigned n = evbuffer_remove_buffer(rx, segBuf.get(), len);
@@ -218,10 +452,18 @@ void ConnBase::bevRead()
         }
         remaining -= 8u + len;
         statRx += 8u + len;
+        PVXS_TRACE4(tcp_rx, int(isClient), peerName.c_str(), header[3], len);
 
         // so far we do not use segmentation to support incremental processing
         // of long messages.  We instead accumulate all segments of a message
-        // prior to parsing.
+        // prior to parsing.  The (de)serialization code is not resumable,
+        // so parsing can not begin until the final segment arrives.
+        //
+        // This does not double memory usage.  evbuffer_remove_buffer() moves
+        // whole chains from rx into segBuf, copying only a partial chain at either
+        // end.  During parsing, EvInBuf drains (and frees) each chain as it
+        // is consumed, while large arrays are copied once into their final storage.
+        // So peak usage is about one message, plus one socket buffer.
 
         auto seg = header[2]&pva_flags::SegMask;
 
@@ -237,12 +479,21 @@ void ConnBase::bevRead()
         if(!seg || seg==pva_flags::SegFirst) {
             expectSeg = true;
             segCmd = header[3];
+            segCompressed = header[2]&pva_flags::Compressed;
         }
 
         if(!seg || seg==pva_flags::SegLast) {
             expectSeg = false;
 
+            if(segCompressed && !decompressSegBuf()) {
+                log_err_printf(connio, "%s %s Invalid compressed cmd 0x%02x.  Force disconnect.\n",
+                               peerLabel(), peerName.c_str(), segCmd);
+                bev.reset();
+                break;
+            }
+
             // ready to process segBuf
+            PVXS_TRACE3(tcp_dispatch_begin, int(isClient), peerName.c_str(), segCmd);
             try {
                 switch(segCmd) {
                 default:
@@ -278,6 +529,7 @@ void ConnBase::bevRead()
                                e.what());
                 bev.reset();
             }
+            PVXS_TRACE3(tcp_dispatch_end, int(isClient), peerName.c_str(), segCmd);
             // handlers may have cleared bev to force disconnect
             if(!bev)
                 break;
@@ -292,14 +544,63 @@ void ConnBase::bevRead()
     if(bev) {
         // incomplete body took earlier return
         assert(evbuffer_get_length(rx)<8);
+        adaptReadahead(nmsg);
         // wait for next header
-        bufferevent_setwatermark(bev.get(), EV_READ, 8, readahead);
+        if(!rxDelay)
+            bufferevent_setwatermark(bev.get(), EV_READ, 8, readahead);
 
     } else {
         cleanup();
     }
 }
 
+// Move data newly read into the delay queue, and data which is due into the ready buffer.
+// Returns the ready buffer
+evbuffer* ConnBase::delayRx(evbuffer* input)
+{
+    auto& D = *rxDelay;
+    auto now(LatencyHistogram::now());
+
+    if(evbuffer_get_length(input)) {
+        auto due = now + D.latency;
+        if(netImpairDrop())
+            due += tcp_impair_rto;
+        if(!D.pending.empty())
+            due = std::max(due, D.pending.back().due); // stream stays in order
+        D.pending.push_back(RxDelay::Chunk{due, evbuf(__FILE__, __LINE__, evbuffer_new())});
+        (void)evbuffer_add_buffer(D.pending.back().data.get(), input);
+    }
+
+    while(!D.pending.empty() && D.pending.front().due <= now) {
+        (void)evbuffer_add_buffer(D.ready.get(), D.pending.front().data.get());
+        D.pending.pop_front();
+    }
+
+    if(!D.pending.empty()) {
+        auto wait = D.pending.front().due - now;
+        timeval tv{};
+        tv.tv_sec = wait/1000000000u;
+        tv.tv_usec = (wait%1000000000u)/1000u;
+        if(event_add(D.timer.get(), &tv))
+            log_err_printf(connio, "%s %s Unable to start RX delay timer\n", peerLabel(), peerName.c_str());
+    }
+
+    return D.ready.get();
+}
+
+void ConnBase::adaptReadahead(size_t nmsg)
+{
+    if(nmsg >= 16u && rxAvgSize < tcp_small_msg) {
+        // a batch of many small messages.  Allow more to accumulate before reading
+        // pauses, so that each wakeup handles a larger batch.
+        readahead = std::min(2u*readahead, tcp_readahead_max_mult*readaheadBase);
+
+    } else if(readahead > readaheadBase && rxAvgSize >= tcp_small_msg) {
+        // large messages are awaited whole anyway
+        readahead = readaheadBase;
+    }
+}
+
 void ConnBase::bevWrite() {}
 
 void ConnBase::bevEventS(struct bufferevent *bev, short events, void *ptr)
@@ -324,6 +625,12 @@ void ConnBase::bevReadS(struct bufferevent *bev, void *ptr)
     }
 }
 
+void ConnBase::rxDelayS(evutil_socket_t fd, short evt, void *raw)
+{
+    if(static_cast<ConnBase*>(raw)->bev)
+        bevReadS(nullptr, raw);
+}
+
 void ConnBase::bevWriteS(struct bufferevent *bev, void *ptr)
 {
     auto conn = static_cast<ConnBase*>(ptr)->self_from_this();
@@ -335,5 +642,36 @@ void ConnBase::bevWriteS(struct bufferevent *bev, void *ptr)
     }
 }
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+std::string unixSocketPath(const std::string& dir, unsigned short port)
+{
+    return SB()<<dir<<"/pvxs-"<<port<<".sock";
+}
+
+socklen_t unixSocketAddr(sockaddr_un& addr, const std::string& path)
+{
+    if(path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error(SB()<<"Unix socket path too long \""<<escape(path)<<"\"");
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size()+1u);
+    return socklen_t(offsetof(sockaddr_un, sun_path) + path.size() + 1u);
+}
+
+evutil_socket_t unixSocket()
+{
+    auto sock(socket(AF_UNIX, SOCK_STREAM, 0));
+    if(sock==evutil_socket_t(-1))
+        throw std::system_error(evutil_socket_geterror(sock), std::system_category());
+
+    evutil_make_socket_closeonexec(sock);
+    if(evutil_make_socket_nonblocking(sock)) {
+        evutil_closesocket(sock);
+        throw std::runtime_error("Unable to make non-blocking socket");
+    }
+    return sock;
+}
+#endif // PVXS_HAVE_UNIX_SOCKET
+
 } // namespace impl
 } // namespace pvxs
@@ -6,21 +6,62 @@
 #ifndef CONN_H
 #define CONN_H
 
+#if !defined(_WIN32) && !defined(vxWorks) && !defined(__rtems__)
+#  define PVXS_HAVE_UNIX_SOCKET
+#  include <sys/un.h>
+#endif
+
+#include <deque>
+
 #include "evhelper.h"
 #include "dataimpl.h"
 #include "utilpvt.h"
+#include "wirecap.h"
 
 namespace pvxs {
 namespace impl {
 
+/* Accumulates a histogram of latencies, with logarithmic buckets in microseconds.
+ * cf. Report::Latency.  add() may be called concurrently from any thread.
+ */
+struct LatencyHistogram {
+    static constexpr size_t nBuckets = 24u;
+
+    LatencyHistogram() {
+        for(auto& c : count)
+            c.store(0u, std::memory_order_relaxed);
+    }
+
+    // monotonic time in nanoseconds, for use with add()
+    static uint64_t now();
+
+    // count the time elapsed since 'start', a value of now()
+    void add(uint64_t start);
+
+    // add counts to 'out', then maybe zero
+    void take(size_t* out, bool zero);
+
+private:
+    std::atomic<uint64_t> count[nBuckets];
+};
+
+// Latencies by operation type.  On a server, one for each Source.  On a client, one for each TCP worker.
+struct OpLatencies {
+    LatencyHistogram get, put, rpc, monitor;
+};
+
 struct ConnBase
 {
     const SockAddr peerAddr;
     const std::string peerName;
 protected:
+    // bandwidth limit, when emulating network impairment.  Must out-live bev.  cf. testNetImpair()
+    evratelimit rateLimit;
     evbufferevent bev;
 public:
     TypeStore rxRegistry;
+    // types previously sent to the peer
+    TypeCache txTypes;
     /* Flag if some received delta could not be decoded due to
      * a non-existent IOID, which *may* leave this rxRegistry out
      * of sync with the peer (if it contains Variant Unions).
@@ -34,14 +75,47 @@ public:
     const bool isClient;
     bool sendBE;
     bool peerBE;
+    // Server only.  Latch sendBE from the byte order of the next message received.  cf. server::Config::peerByteOrder
+    bool adoptPeerBE = false;
     bool expectSeg;
+    // segments of the current message have pva_flags::Compressed
+    bool segCompressed = false;
+    // peer can decode pva_flags::Compressed.  cf. pva_qos::LZ4
+    bool peerLZ4 = false;
+    // peer can decode MONITOR array patches.  cf. pva_qos::ArrayDelta
+    bool peerDelta = false;
+    // both ends rely on TCP keepalive.  No read timeout.  cf. pva_qos::KeepAlive
+    bool peerKeepAlive = false;
     uint8_t peerVersion;
 
     uint8_t segCmd;
     evbuf segBuf, txBody;
 
     size_t statTx{}, statRx{};
-    size_t readahead{};
+    // RX high watermark beyond the current message.  Adapted between readaheadBase,
+    // from the socket buffer size, and a multiple of that.  cf. adaptReadahead()
+    size_t readahead{}, readaheadBase{};
+    // moving average size of received messages, including header
+    double rxAvgSize = 0.0;
+
+    // recent messages, when enabled.  cf. wireCaptureSet()
+    std::unique_ptr<WireCapture> capture;
+
+    /* Emulated latency and loss of received data.  cf. testNetImpair()
+     * Data read from the socket is held in 'pending' until due, then moved to 'ready',
+     * which bevRead() then processes in place of the bufferevent input.
+     */
+    struct RxDelay {
+        uint64_t latency; // nanoseconds
+        struct Chunk {
+            uint64_t due; // cf. LatencyHistogram::now()
+            evbuf data;
+        };
+        std::deque<Chunk> pending;
+        evbuf ready;
+        evevent timer;
+    };
+    std::unique_ptr<RxDelay> rxDelay;
 
     enum {
         Holdoff,
@@ -57,7 +131,12 @@ public:
 
     const char* peerLabel() const;
 
-    size_t enqueueTxBody(pva_app_msg_t cmd);
+    // Approximate bytes held by type caches, by data waiting to be sent,
+    // and by data received but not yet decoded.
+    void memoryUsage(size_t& types, size_t& tx, size_t& rx) const;
+
+    // Send txBody.  If compress, and peerLZ4, then a large body may be sent compressed.
+    size_t enqueueTxBody(pva_app_msg_t cmd, bool compress=false);
 
     bufferevent* connection() { return bev.get(); }
 
@@ -88,16 +167,40 @@ protected:
     CASE(MESSAGE);
 #undef CASE
 
+    bool decompressSegBuf();
+
     virtual std::shared_ptr<ConnBase> self_from_this() =0;
     virtual void cleanup() =0;
     virtual void bevEvent(short events);
     virtual void bevRead();
+    void adaptReadahead(size_t nmsg);
+    evbuffer* delayRx(evbuffer* input);
     virtual void bevWrite();
     static void bevEventS(struct bufferevent *bev, short events, void *ptr);
     static void bevReadS(struct bufferevent *bev, void *ptr);
     static void bevWriteS(struct bufferevent *bev, void *ptr);
+    static void rxDelayS(evutil_socket_t fd, short evt, void *raw);
 };
 
+/* Hand one end of a connected stream socket to the running Server in this process with
+ * the given GUID, to be served as if accepted from peer.
+ * Returns false, and does not close sock, if there is no such Server.
+ * cf. client::Config::inProcess
+ */
+bool acceptLocalConnection(const ServerGUID& guid, evutil_socket_t sock, const SockAddr& peer);
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+// Path of the Unix domain socket through which a Server with this TCP port is also reached.
+// cf. server::Config::unixSocketDir
+std::string unixSocketPath(const std::string& dir, unsigned short port);
+// fill in addr.  Returns the address length.
+// @throws std::runtime_error if path is too long
+socklen_t unixSocketAddr(sockaddr_un& addr, const std::string& path);
+// new non-blocking Unix domain stream socket.
+// @throws std::system_error
+evutil_socket_t unixSocket();
+#endif
+
 } // namespace impl
 } // namespace pvxs
 
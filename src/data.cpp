@@ -4,7 +4,10 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
 #include <cstring>
+#include <functional>
+#include <new>
 #include <epicsAssert.h>
 
 #include "dataimpl.h"
@@ -93,13 +96,59 @@ Value Value::Helper::build(const void* ptr, StoreType type)
     return ret;
 }
 
+namespace {
+MemCount valueBytes("Value");
+
+/* Allocator for std::allocate_shared() which extends the single allocation
+ * holding the shared_ptr control block and StructTop with space for the
+ * FieldStorage array.  So one malloc() per Value::Value() instead of three.
+ */
+template<typename T>
+struct TopAlloc {
+    typedef T value_type;
+
+    size_t nmembers;
+    // receives location of FieldStorage array.  Only used by allocate()
+    FieldStorage** storage;
+
+    TopAlloc(size_t nmembers, FieldStorage** storage) :nmembers(nmembers), storage(storage) {}
+    template<typename U>
+    TopAlloc(const TopAlloc<U>& o) :nmembers(o.nmembers), storage(o.storage) {}
+
+    // round up to alignment of FieldStorage
+    size_t bytes(size_t n) const {
+        const size_t head = (n*sizeof(T) + alignof(FieldStorage)-1u) & ~(alignof(FieldStorage)-1u);
+        return head + nmembers*sizeof(FieldStorage);
+    }
+
+    T* allocate(size_t n) {
+        const auto total = bytes(n);
+        auto mem = static_cast<char*>(::operator new(total));
+        *storage = reinterpret_cast<FieldStorage*>(mem + total - nmembers*sizeof(FieldStorage));
+        valueBytes.add(total);
+        return reinterpret_cast<T*>(mem);
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        valueBytes.sub(bytes(n));
+        ::operator delete(p);
+    }
+
+    template<typename U>
+    bool operator==(const TopAlloc<U>& o) const { return nmembers==o.nmembers; }
+    template<typename U>
+    bool operator!=(const TopAlloc<U>& o) const { return !(*this==o); }
+};
+} // namespace
+
 Value::Value(const std::shared_ptr<const impl::FieldDesc>& desc)
     :desc(nullptr)
 {
     if(!desc)
         return;
 
-    auto top = std::make_shared<StructTop>(desc);
+    FieldStorage* storage = nullptr;
+    auto top = std::allocate_shared<StructTop>(TopAlloc<StructTop>(desc->size(), &storage),
+                                               desc, std::ref(storage));
 
     {
         auto& root = top->members[0];
@@ -108,9 +157,10 @@ Value::Value(const std::shared_ptr<const impl::FieldDesc>& desc)
     }
 
     if(desc->code==TypeCode::Struct) {
-        for(auto& pair : desc->mlookup) {
-            auto cfld = desc.get() + pair.second;
-            auto& mem = top->members.at(pair.second);
+        // mlookup has an entry for every descendant, so visit them in storage order
+        for(auto i : range(size_t(1u), desc->size())) {
+            auto cfld = desc.get() + i;
+            auto& mem = top->members[i];
             mem.top = top.get();
             mem.init(cfld->code.storedAs());
         }
@@ -129,6 +179,149 @@ Value::Value(const std::shared_ptr<const impl::FieldDesc>& desc, Value& parent)
 
 Value::~Value() {}
 
+namespace {
+// mark() the fields through which a Struct is enclosed by a Union or Any.  cf. Value::mark()
+void markEnclosing(StructTop* top)
+{
+    std::shared_ptr<FieldStorage> enc;
+    while(top && (enc=top->enclosing.lock())) {
+        enc->valid = true;
+        top = enc->top;
+    }
+}
+
+// copy the storage of field index of src, which has the same type as dest
+void copySameField(Value& dest, size_t index, const FieldStorage& S)
+{
+    auto& D = Value::Helper::store_ptr(dest)[index];
+
+    switch(S.code) {
+    case StoreType::Null:
+        break; // Struct
+    case StoreType::Bool:
+        D.as<bool>() = S.as<bool>();
+        break;
+    case StoreType::Integer:
+    case StoreType::UInteger:
+    case StoreType::Real:
+        D.as<uint64_t>() = S.as<uint64_t>(); // just copy 8 bytes
+        break;
+    case StoreType::String:
+        D.as<CowString>() = S.as<CowString>(); // share
+        break;
+    case StoreType::Array:
+        D.as<shared_array<const void>>() = S.as<shared_array<const void>>(); // share
+        break;
+    case StoreType::Compound: {
+        // a Union member is re-built as a child of dest
+        Value dfld;
+        Value::Helper::store(dfld) = std::shared_ptr<FieldStorage>(Value::Helper::store(dest), &D);
+        Value::Helper::set_desc(dfld, Value::Helper::desc(dest) + index);
+        Value::Helper::copyIn(dfld, &S);
+        break;
+    }
+    }
+    D.valid = true;
+}
+
+/* Copy each marked field of the Struct src, with all of its descendants, to dest
+ * and (optionally) dest2.  Which have exactly the same type.
+ * As with copyIn(), but without conversions, or field lookup.
+ */
+void copyMarkedSame(const Value& src, Value& dest, Value* dest2=nullptr)
+{
+    auto desc = Value::Helper::desc(src);
+    auto sstore = Value::Helper::store_ptr(src);
+    bool copied = false;
+
+    // when i<end, i is a descendant of a marked field
+    for(size_t i=1u, end=1u; i<desc->size(); i++) {
+        if(i>=end) {
+            if(!sstore[i].valid)
+                continue;
+            end = i + desc[i].size();
+        }
+        copySameField(dest, i, sstore[i]);
+        if(dest2)
+            copySameField(*dest2, i, sstore[i]);
+        copied = true;
+    }
+
+    const bool marked = src.isMarked();
+    for(auto D : {&dest, dest2}) {
+        if(!D)
+            continue;
+        if(copied)
+            markEnclosing(Value::Helper::store_ptr(*D)->top);
+        if(marked)
+            D->mark();
+    }
+}
+
+// mark a structure, and any structures held by its fields, as frozen
+void freezeTop(StructTop* top)
+{
+    if(top->frozen)
+        return;
+    top->frozen = true;
+
+    for(auto i : range(top->members.size())) {
+        auto& fld = top->members[i];
+        if(fld.code==StoreType::Compound) {
+            if(auto store = Value::Helper::store_ptr(fld.as<Value>()))
+                freezeTop(store->top);
+
+        } else if(fld.code==StoreType::Array) {
+            auto& arr = fld.as<shared_array<const void>>();
+            if(arr.original_type()==ArrayType::Value) {
+                for(auto& elem : arr.castTo<const Value>()) {
+                    if(auto store = Value::Helper::store_ptr(elem))
+                        freezeTop(store->top);
+                }
+            }
+        }
+    }
+}
+} // namespace
+
+Value& Value::freeze()
+{
+    if(!desc)
+        throw std::logic_error("Can't freeze() empty Value");
+    else if(desc!=store->top->desc.get())
+        throw std::logic_error("Can only freeze() the top of a structure");
+    else if(!store->top->frozen && store.use_count()!=1)
+        throw std::logic_error("Can't freeze() non-unique Value");
+
+    freezeTop(store->top);
+    return *this;
+}
+
+bool Value::frozen() const
+{
+    return desc && store->top->frozen;
+}
+
+void Value::_thaw()
+{
+    if(!desc || !store->top->frozen)
+        return;
+    else if(desc!=store->top->desc.get())
+        throw std::logic_error("Can't modify a field of a frozen Value.  Modify the top level Value instead.");
+
+    // copy all fields and marks, not only those marked as clone() does
+    Value copy(cloneEmpty());
+    auto sstore = store.get();
+    for(auto i : range(desc->size())) {
+        auto& S = sstore[i];
+        // an unselected Union is left unselected
+        if(S.code!=StoreType::Compound || S.as<Value>())
+            copySameField(copy, i, S);
+        copy.store.get()[i].valid = S.valid;
+    }
+    *this = std::move(copy);
+}
+
 Value Value::cloneEmpty() const
 {
     Value ret;
@@ -142,7 +335,10 @@ Value Value::cloneEmpty() const
 Value Value::clone() const
 {
     Value ret;
-    if(desc) {
+    if(desc && store->top->frozen && desc==store->top->desc.get()) {
+        ret = *this;
+
+    } else if(desc) {
         decltype (store->top->desc) fld(store->top->desc, desc);
         ret = Value(fld);
         ret.assign(*this);
@@ -160,11 +356,81 @@ Value& Value::assign(const Value& o)
         copyIn(&o, StoreType::Compound);
     } else {
         // unpack other field types
-        copyIn(o.store.get(), o.store->code);
+        Value::Helper::copyIn(*this, o.store.get());
     }
     return *this;
 }
 
+void Value::Helper::assignMarked(const Value& src, Value& a, Value& b)
+{
+    a._thaw();
+    b._thaw();
+    if(!src.desc || src.desc!=a.desc || src.desc!=b.desc || src.type()!=TypeCode::Struct) {
+        a.assign(src);
+        b.assign(src);
+        return;
+    }
+
+    // same type, so fields are found by offset.  cf. copyIn()
+    copyMarkedSame(src, a, &b);
+}
+
+size_t Value::Helper::approxBytes(const Value& v)
+{
+    auto store = v.store.get();
+    if(!store)
+        return 0u;
+
+    auto top = store->top;
+    size_t ret = sizeof(StructTop) + top->members.size()*sizeof(FieldStorage);
+
+    for(auto i : range(top->members.size())) {
+        auto& fld = top->members[i];
+        switch(fld.code) {
+        case StoreType::String:
+            ret += fld.as<CowString>().str().capacity();
+            break;
+        case StoreType::Compound:
+            ret += approxBytes(fld.as<Value>());
+            break;
+        case StoreType::Array: {
+            auto& arr = fld.as<shared_array<const void>>();
+            if(arr.original_type()==ArrayType::Value) {
+                for(auto& elem : arr.castTo<const Value>())
+                    ret += sizeof(Value) + approxBytes(elem);
+            } else if(arr.original_type()==ArrayType::String) {
+                for(auto& elem : arr.castTo<const std::string>())
+                    ret += sizeof(std::string) + elem.capacity();
+            } else if(arr.original_type()!=ArrayType::Null) {
+                ret += arr.size()*elementSize(arr.original_type());
+            }
+        }
+            break;
+        default:
+            break;
+        }
+    }
+    return ret;
+}
+
+void Value::Helper::copyIn(Value& dest, const impl::FieldStorage* src)
+{
+    dest._thaw();
+    if(src->code==StoreType::String) {
+        auto& sstr = src->as<CowString>();
+        auto dstore = dest.store.get();
+        if(dest.desc && dstore->code==StoreType::String) {
+            // share, instead of copy
+            dstore->as<CowString>() = sstr;
+            dest.mark();
+        } else {
+            dest.copyIn(&sstr.str(), StoreType::String);
+        }
+    } else {
+        dest.copyIn(src->buffer(), src->code);
+    }
+}
+
 Value Value::allocMember()
 {
     // allocate member type for Struct[] or Union[]
@@ -179,6 +445,7 @@ void Value::clear()
 {
     if(!desc)
         return;
+    _thaw();
 
     for(auto i : range(size_t(0u), desc->size())) {
         auto& s = store.get()[i];
@@ -196,7 +463,7 @@ void Value::clear()
         }
             break;
         case StoreType::String:
-            s.as<std::string>().clear();
+            s.as<CowString>().clear();
             break;
         case StoreType::Null:
             break; // nothing to do
@@ -257,23 +524,18 @@ void Value::mark(bool v)
 {
     if(!desc)
         return;
+    _thaw();
 
     store->valid = v;
-    if(!v)
-        return;
-
-    auto top = store->top;
-    std::shared_ptr<FieldStorage> enc;
-    while(top && (enc=top->enclosing.lock())) {
-        enc->valid = true;
-        top = enc->top;
-    }
+    if(v)
+        markEnclosing(store->top);
 }
 
 void Value::unmark(bool parents, bool children)
 {
     if(!desc)
         return;
+    _thaw();
 
     store->valid = false;
 
@@ -369,6 +631,156 @@ bool Value::_equal(const impl::FieldDesc* A, const impl::FieldDesc* B)
     return true;
 }
 
+namespace {
+bool equalFields(const Value& a, const Value& b);
+
+// compare the values of two Union or Any fields, or the elements of arrays of Struct, Union, or Any
+bool equalCompound(const FieldDesc* adesc, const Value& a, const FieldDesc* bdesc, const Value& b)
+{
+    if(!a || !b)
+        return !a && !b;
+
+    if(adesc->code==TypeCode::Union) {
+        // same member selected
+        if(Value::Helper::desc(a) - adesc->members.data() != Value::Helper::desc(b) - bdesc->members.data())
+            return false;
+
+    } else if(!a.equalType(b)) {
+        return false;
+    }
+
+    return equalFields(a, b);
+}
+
+bool equalArray(const FieldDesc* adesc, const shared_array<const void>& a,
+                const FieldDesc* bdesc, const shared_array<const void>& b)
+{
+    if(a.size()!=b.size() || a.original_type()!=b.original_type())
+        return false;
+    else if(a.data()==b.data() || a.empty())
+        return true;
+
+    switch(a.original_type()) {
+    case ArrayType::String: {
+        auto A(a.castTo<const std::string>());
+        auto B(b.castTo<const std::string>());
+        return std::equal(A.begin(), A.end(), B.begin());
+    }
+    case ArrayType::Value: {
+        auto A(a.castTo<const Value>());
+        auto B(b.castTo<const Value>());
+        for(auto i : range(A.size())) {
+            // member types of StructA and UnionA are fixed.  AnyA elements may differ.
+            if(!equalCompound(&adesc->members[0], A[i], &bdesc->members[0], B[i]))
+                return false;
+        }
+        return true;
+    }
+    default:
+        // all other elements compared bytewise, in one pass.
+        return memcmp(a.data(), b.data(), a.size()*elementSize(a.original_type()))==0;
+    }
+}
+
+// compare the value of one field, but not of any sub-fields
+bool equalStore(const FieldDesc* adesc, const FieldStorage* a, const FieldDesc* bdesc, const FieldStorage* b)
+{
+    if(a->code!=b->code)
+        return false;
+
+    switch(a->code) {
+    case StoreType::Null:
+        return true; // Struct, compared through its members
+    case StoreType::Bool:
+        return a->as<bool>()==b->as<bool>();
+    case StoreType::UInteger:
+    case StoreType::Integer:
+        return a->as<uint64_t>()==b->as<uint64_t>();
+    case StoreType::Real:
+        // bitwise, so NaN is unchanged when posted again
+        return memcmp(a->buffer(), b->buffer(), sizeof(double))==0;
+    case StoreType::String: {
+        auto& A = a->as<CowString>().str();
+        auto& B = b->as<CowString>().str();
+        return &A==&B || A==B;
+    }
+    case StoreType::Array:
+        return equalArray(adesc, a->as<shared_array<const void>>(), bdesc, b->as<shared_array<const void>>());
+    case StoreType::Compound: {
+        auto& A = a->as<Value>();
+        auto& B = b->as<Value>();
+        if(A && A.equalInst(B))
+            return true; // shared
+        return equalCompound(adesc, A, bdesc, B);
+    }
+    }
+    return false;
+}
+
+// compare all field values of a and b, which have the same type
+bool equalFields(const Value& a, const Value& b)
+{
+    auto adesc = Value::Helper::desc(a);
+    auto bdesc = Value::Helper::desc(b);
+    auto astore = Value::Helper::store_ptr(a);
+    auto bstore = Value::Helper::store_ptr(b);
+
+    for(auto i : range(adesc->size())) {
+        if(!equalStore(adesc+i, astore+i, bdesc+i, bstore+i))
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+void* Value::_scalarStorage(TypeCode expect, bool*& marked) const
+{
+    if(!desc)
+        throw NoField();
+    else if(desc->code!=expect)
+        throw NoConvert(SB()<<"Unable to bind "<<expect<<" to "<<desc->code);
+    else if(store->top->frozen)
+        throw std::logic_error("Unable to bind to a frozen Value");
+
+    marked = &store->valid;
+    return store->buffer();
+}
+
+bool Value::markChanged(const Value& prev, bool onlyMarked)
+{
+    if(!desc || !prev.desc)
+        throw std::logic_error("Can't markChanged() with empty Value");
+    else if(!equalType(prev))
+        throw std::logic_error("markChanged() requires Values of the same type");
+    _thaw();
+
+    const auto nfld = desc->size();
+    auto mine = store.get();
+    auto theirs = prev.store.get();
+
+    // with onlyMarked, compare fields which are marked, or have a marked parent
+    std::vector<bool> compare;
+    if(onlyMarked) {
+        compare.resize(nfld);
+        compare[0] = isMarked(true, false);
+        for(auto i : range(size_t(1u), nfld))
+            compare[i] = mine[i].valid || compare[i - desc[i].parent_index];
+    }
+
+    bool changed = false;
+    for(auto i : range(nfld)) {
+        bool differs = desc[i].code!=TypeCode::Struct
+                && (!onlyMarked || compare[i])
+                && !equalStore(desc+i, mine+i, prev.desc+i, theirs+i);
+        mine[i].valid = differs;
+        changed |= differs;
+    }
+
+    if(changed)
+        markEnclosing(store->top);
+    return changed;
+}
+
 const std::string &Value::nameOf(const Value& descendant) const
 {
     if(!store || !descendant.store)
@@ -379,6 +791,8 @@ const std::string &Value::nameOf(const Value& descendant) const
         doffset = descendant.desc - desc;
         if(doffset==0 || doffset > desc->mlookup.size())
             throw std::logic_error("not a descendant");
+        // names of descendants are listed in depth first order
+        return desc->mindex.nameAt(doffset-1u);
 
     } else if(desc->code==TypeCode::Union) {
         doffset = descendant.desc - desc->members.data();
@@ -387,7 +801,6 @@ const std::string &Value::nameOf(const Value& descendant) const
         throw std::logic_error("nameOf() only implemented for Struct and Union");
     }
 
-    // inefficient, but we don't keep a reverse mapping
     for(auto& it : desc->mlookup) {
         if(it.second == doffset)
             return it.first;
@@ -440,7 +853,7 @@ void Value::copyOut(void *ptr, StoreType type) const
         break;
     }
     case StoreType::String: {
-        auto& src = store->as<std::string>();
+        auto& src = store->as<CowString>().str();
 
         switch(type) {
         case StoreType::String: *reinterpret_cast<std::string*>(ptr) = src; return;
@@ -539,6 +952,7 @@ void Value::copyIn(const void *ptr, StoreType type)
 
     if(!desc)
         throw NoField();
+    _thaw();
 
     switch(store->code) {
     case StoreType::Real: {
@@ -593,7 +1007,7 @@ void Value::copyIn(const void *ptr, StoreType type)
         break;
     }
     case StoreType::String: {
-        auto& dest = store->as<std::string>();
+        auto& dest = store->as<CowString>();
 
         switch(type) {
         case StoreType::String:   dest = *reinterpret_cast<const std::string*>(ptr); break;
@@ -722,6 +1136,13 @@ void Value::copyIn(const void *ptr, StoreType type)
                 // copy struct to struct
                 // all marked source field may be mapped to destination fields
 
+                if(src.desc==desc) {
+                    // same type (eg. clone()), so storage is copied directly by offset,
+                    // instead of by name with conversion.
+                    copyMarkedSame(src, *this);
+                    return;
+                }
+
                 for(const auto& sfld : src.imarked()) {
                     if(sfld.type()==TypeCode::Struct) {
                         // entire sub-struct marked.
@@ -734,7 +1155,7 @@ void Value::copyIn(const void *ptr, StoreType type)
                         auto& name(src.nameOf(sfld));
                         if(auto dfld = (*this)[name]) {
                             try {
-                                dfld.copyIn(&sfld.store->store, sfld.store->code);
+                                Value::Helper::copyIn(dfld, sfld.store.get());
                             }catch(NoConvert& e){
                                 throw NoConvert(SB()<<"field \""<<name<<"\" : "<<e.what());
                             }
@@ -812,15 +1233,14 @@ void Value::traverse(const std::string &expr, bool modify, bool dothrow)
             }
 
             size_t sep = expr.find_first_of("<[-", pos);
+            size_t nlen = (sep==std::string::npos ? expr.size() : sep) - pos;
 
-            decltype (desc->mlookup)::const_iterator it;
+            size_t idx;
 
-            const auto& name = expr.substr(pos, sep-pos);
-
-            if(sep>0 && (it=desc->mlookup.find(name))!=desc->mlookup.end()) {
+            if(sep>0 && (idx=desc->mindex.find(expr.data()+pos, nlen))!=size_t(-1)) {
                 // found it
-                auto next = desc+it->second;
-                decltype(store) value(store, store.get()+it->second);
+                auto next = desc+idx;
+                decltype(store) value(store, store.get()+idx);
                 store = std::move(value);
                 desc = next;
                 pos = sep;
@@ -830,7 +1250,7 @@ void Value::traverse(const std::string &expr, bool modify, bool dothrow)
                 store.reset();
                 desc = nullptr;
                 if(dothrow)
-                    throw LookupError(SB()<<"no such member '"<<name<<"' in '"<<expr<<"'");
+                    throw LookupError(SB()<<"no such member '"<<expr.substr(pos, nlen)<<"' in '"<<expr<<"'");
             }
 
         } else if(desc->code.code==TypeCode::Union || desc->code.code==TypeCode::Any) {
@@ -850,17 +1270,18 @@ void Value::traverse(const std::string &expr, bool modify, bool dothrow)
                     // select member of Union
                     size_t sep = expr.find_first_of("<[-.", pos);
 
-                    decltype (desc->mlookup)::const_iterator it;
+                    size_t nlen = (sep==std::string::npos ? expr.size() : sep) - pos;
+                    size_t idx;
                     auto& fld = store->as<Value>();
 
-                    if(sep>0 && (it=desc->mlookup.find(expr.substr(pos, sep-pos)))!=desc->mlookup.end()) {
+                    if(sep>0 && (idx=desc->mindex.find(expr.data()+pos, nlen))!=size_t(-1)) {
                         // found it.
 
-                        if(modify || fld.desc==&desc->members[it->second]) {
+                        if(modify || fld.desc==&desc->members[idx]) {
                             // will select, or already selected
-                            if(fld.desc!=&desc->members[it->second]) {
+                            if(fld.desc!=&desc->members[idx]) {
                                 // select
-                                std::shared_ptr<const FieldDesc> mtype(store->top->desc, &desc->members[it->second]);
+                                std::shared_ptr<const FieldDesc> mtype(store->top->desc, &desc->members[idx]);
                                 fld = Value(mtype, *this);
                             }
                             pos = sep;
@@ -946,6 +1367,7 @@ void Value::traverse(const std::string &expr, bool modify, bool dothrow)
 
 Value Value::operator[](const std::string& name)
 {
+    _thaw();
     Value ret(*this);
     ret.traverse(name, true, false);
     return ret;
@@ -960,6 +1382,7 @@ const Value Value::operator[](const std::string& name) const
 
 Value Value::lookup(const std::string& name)
 {
+    _thaw();
     Value ret(*this);
     ret.traverse(name, true, true);
     return ret;
@@ -972,6 +1395,58 @@ const Value Value::lookup(const std::string& name) const
     return ret;
 }
 
+FieldRef::FieldRef(const std::string& name)
+    :_name(name)
+{}
+
+FieldRef::FieldRef(const Value& val, const std::string& name)
+    :base(Value::Helper::type(val))
+    ,_name(name)
+{
+    resolve();
+}
+
+FieldRef::FieldRef(const TypeDef& def, const std::string& name)
+    :base(def.desc)
+    ,_name(name)
+{
+    resolve();
+}
+
+void FieldRef::resolve()
+{
+    if(base && base->code==TypeCode::Struct)
+        offset = base->mindex.find(_name.data(), _name.size());
+}
+
+Value Value::operator[](const FieldRef& ref)
+{
+    _thaw();
+    if(!desc || desc!=ref.base.get() || !ref.resolved())
+        return (*this)[ref._name];
+
+    Value ret;
+    ret.store = decltype(store)(store, store.get()+ref.offset);
+    ret.desc = desc+ref.offset;
+    return ret;
+}
+
+const Value Value::operator[](const FieldRef& ref) const
+{
+    if(!desc || desc!=ref.base.get() || !ref.resolved())
+        return (*this)[ref._name];
+
+    Value ret;
+    ret.store = decltype(store)(store, store.get()+ref.offset);
+    ret.desc = desc+ref.offset;
+    return ret;
+}
+
+FieldRef Value::index(const std::string& name) const
+{
+    return FieldRef(*this, name);
+}
+
 size_t Value::nmembers() const
 {
     switch(desc ? desc->code.code : TypeCode::Null) {
@@ -986,6 +1461,139 @@ size_t Value::nmembers() const
     }
 }
 
+// advance pos to the next marked descendant of a Struct, or the end.
+// Descendants of a marked field, before nextcheck, are not checked.
+static
+void _next_marked_struct(const FieldDesc* base_desc, const FieldStorage* base_store, size_t& pos, size_t& nextcheck)
+{
+    if(pos < nextcheck)
+        return;
+
+    while(pos < base_desc->mlookup.size()) {
+        auto desc = base_desc + 1u + pos;
+        auto S = base_store + 1u + pos;
+        if(S->valid) {
+            nextcheck = pos + desc->size();
+            return;
+        }
+
+        ++pos;
+    }
+    nextcheck = pos;
+}
+
+Value ValueView::alias() const
+{
+    Value ret;
+    // aliasing an empty shared_ptr gives a pointer without a reference count
+    ret.store = std::shared_ptr<FieldStorage>(std::shared_ptr<FieldStorage>(), store);
+    ret.desc = desc;
+    return ret;
+}
+
+void ValueView::copyOut(void *ptr, StoreType type) const
+{
+    alias().copyOut(ptr, type);
+}
+
+bool ValueView::tryCopyOut(void *ptr, StoreType type) const
+{
+    return alias().tryCopyOut(ptr, type);
+}
+
+void ValueView::copyIn(const void *ptr, StoreType type)
+{
+    // selecting a Union member needs a reference to the enclosing structure
+    if(desc && desc->code==TypeCode::Union)
+        throw NoConvert("Unable to assign Union through ValueView");
+    else if(store && store->top->frozen)
+        throw std::logic_error("Unable to modify a frozen Value through ValueView");
+    auto temp(alias());
+    temp.copyIn(ptr, type);
+}
+
+TypeCode ValueView::type() const
+{
+    return desc ? desc->code : TypeCode::Null;
+}
+
+StoreType ValueView::storageType() const
+{
+    return store ? store->code : StoreType::Null;
+}
+
+size_t ValueView::nmembers() const
+{
+    return alias().nmembers();
+}
+
+bool ValueView::isMarked() const
+{
+    return store && store->valid;
+}
+
+void ValueView::mark(bool v)
+{
+    if(!desc)
+        return;
+    else if(store->top->frozen)
+        throw std::logic_error("Unable to modify a frozen Value through ValueView");
+
+    store->valid = v;
+    if(v)
+        markEnclosing(store->top);
+}
+
+ValueView ValueView::operator[](const std::string& name) const
+{
+    if(desc && desc->code==TypeCode::Struct) {
+        auto offset = desc->mindex.find(name.data(), name.size());
+        if(offset!=size_t(-1))
+            return ValueView(desc+offset, store+offset);
+    }
+    return ValueView();
+}
+
+ValueView ValueView::operator[](const FieldRef& ref) const
+{
+    if(!desc || desc!=ref.base.get() || !ref.resolved())
+        return (*this)[ref._name];
+
+    return ValueView(desc+ref.offset, store+ref.offset);
+}
+
+ValueView ValueView::iterator::operator*() const
+{
+    auto offset = kind==Children ? parent.desc->miter[pos].second : 1u + pos;
+    return ValueView(parent.desc+offset, parent.store+offset);
+}
+
+const std::string& ValueView::iterator::name() const
+{
+    return kind==Children ? parent.desc->miter[pos].first : parent.desc->mindex.nameAt(pos);
+}
+
+void ValueView::iterator::skipUnmarked()
+{
+    _next_marked_struct(parent.desc, parent.store, pos, nextcheck);
+}
+
+ValueView::iterator ValueView::Iterable::begin() const
+{
+    iterator ret(parent, 0u, kind);
+    if(kind==Marked && parent.desc && parent.desc->code==TypeCode::Struct)
+        ret.skipUnmarked();
+    return ret;
+}
+
+ValueView::iterator ValueView::Iterable::end() const
+{
+    size_t n = 0u;
+    if(parent.desc && parent.desc->code==TypeCode::Struct)
+        n = kind==Children ? parent.desc->miter.size() : parent.desc->mlookup.size();
+    return iterator(parent, n, kind);
+}
+
 template<>
 Value::Iterable<Value::_IAll>::iterator
 Value::Iterable<Value::_IAll>::end() const noexcept
@@ -1070,23 +1678,11 @@ Value::_Iterator<Value::_IChildren>::operator*() const noexcept
 static
 void _next_marked(const Value& ref, size_t& pos, size_t& nextcheck)
 {
-    if(pos < nextcheck)
-        return;
-
     if(ref.type()==TypeCode::Struct) {
-        auto base_desc = Value::Helper::desc(ref);
-
-        while(pos < base_desc->mlookup.size()) {
-            auto desc = base_desc + 1u + pos;
-            auto S = Value::Helper::store_ptr(ref) + 1u + pos;
-            if(S->valid) {
-                nextcheck = pos + desc->size();
-                return;
-            }
+        _next_marked_struct(Value::Helper::desc(ref), Value::Helper::store_ptr(ref), pos, nextcheck);
 
-            ++pos;
-        }
-        nextcheck = pos;
+    } else if(pos < nextcheck) {
+        return;
 
     } else if(ref.type()==TypeCode::Union) {
         auto desc = Value::Helper::desc(ref);
@@ -1197,7 +1793,7 @@ void FieldStorage::init(StoreType code)
         as<uint64_t>() = 0u;
         return;
     case StoreType::String:
-        new(&store) std::string();
+        new(&store) CowString();
         return;
     case StoreType::Compound:
         new(&store) std::shared_ptr<FieldStorage>();
@@ -1222,7 +1818,7 @@ void FieldStorage::deinit()
         as<shared_array<void>>().~shared_array();
         break;
     case StoreType::String:
-        as<std::string>().~basic_string();
+        as<CowString>().~CowString();
         break;
     case StoreType::Compound:
         as<Value>().~Value();
@@ -1238,6 +1834,20 @@ FieldStorage::~FieldStorage()
     deinit();
 }
 
+StructTop::StructTop(const std::shared_ptr<const FieldDesc>& desc, FieldStorage* storage)
+    :desc(desc)
+    ,members(storage, desc->size())
+{
+    for(size_t i=0u; i<members.size(); i++)
+        new(&storage[i]) FieldStorage();
+}
+
+StructTop::~StructTop()
+{
+    for(size_t i=members.size(); i; i--)
+        members[i-1u].~FieldStorage();
+}
+
 size_t FieldStorage::index() const
 {
     const size_t ret = this - top->members.data();
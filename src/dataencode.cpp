@@ -8,6 +8,7 @@
 #define DATAENCODE_H
 
 #include <cassert>
+#include <algorithm>
 
 #include <stdexcept>
 #include <functional>
@@ -66,6 +67,96 @@ void to_wire(Buffer& buf, const FieldDesc* cur)
     }
 }
 
+namespace {
+size_t descBytes(const std::vector<FieldDesc>& descs)
+{
+    size_t ret = descs.capacity()*sizeof(FieldDesc);
+    for(auto& desc : descs) {
+        ret += desc.id.capacity();
+        // tree/vector entries, not counting short names stored inline
+        ret += desc.mlookup.size()*(sizeof(std::string) + sizeof(size_t) + 4u*sizeof(void*));
+        ret += desc.miter.capacity()*sizeof(std::pair<std::string, size_t>);
+        ret += descBytes(desc.members);
+    }
+    return ret;
+}
+} // namespace
+
+size_t approxBytes(const TypeStore& store)
+{
+    size_t ret = 0u;
+    for(auto& pair : store)
+        ret += sizeof(pair) + 4u*sizeof(void*) + descBytes(pair.second);
+    return ret;
+}
+
+size_t TypeCache::approxBytes() const
+{
+    // hash node and lru list node for each entry
+    size_t ret = scratch.capacity();
+    for(auto& pair : entries)
+        ret += pair.first.capacity() + sizeof(pair) + sizeof(void*) + 3u*sizeof(void*);
+    return ret;
+}
+
+void to_wire(Buffer& buf, const FieldDesc* cur, TypeCache& cache)
+{
+    if(!cur) {
+        to_wire(buf, uint8_t(0xff));
+        return;
+    }
+
+    size_t elen;
+    {
+        if(cache.scratch.empty())
+            cache.scratch.resize(256u);
+        VectorOutBuf E(buf.be, cache.scratch);
+        to_wire(E, cur);
+        if(!E.good()) {
+            buf.fault(__FILE__, __LINE__);
+            return;
+        }
+        elen = E.consumed();
+    }
+    std::string encoded(reinterpret_cast<const char*>(cache.scratch.data()), elen);
+
+    auto it(cache.entries.find(encoded));
+    if(it!=cache.entries.end()) {
+        cache.hits++;
+        cache.lru.splice(cache.lru.begin(), cache.lru, it->second.use);
+
+        to_wire(buf, uint8_t(0xfe));
+        to_wire(buf, it->second.key);
+        return;
+    }
+
+    cache.misses++;
+
+    if(cache.limit && cache.nextKey<=0xffff) {
+        auto key = uint16_t(cache.nextKey++);
+
+        auto pair(cache.entries.emplace(std::move(encoded), TypeCache::Entry{key, {}}));
+        cache.lru.push_front(&pair.first->first);
+        pair.first->second.use = cache.lru.begin();
+
+        if(cache.entries.size() > cache.limit) {
+            cache.entries.erase(*cache.lru.back());
+            cache.lru.pop_back();
+            cache.evictions++;
+        }
+
+        to_wire(buf, uint8_t(0xfd));
+        to_wire(buf, key);
+    }
+
+    if(!buf.ensure(elen)) {
+        buf.fault(__FILE__, __LINE__);
+    } else {
+        memcpy(buf.save(), cache.scratch.data(), elen);
+        buf._skip(elen);
+    }
+}
+
 void from_wire(Buffer& buf, std::vector<FieldDesc>& descs, TypeStore& cache, unsigned depth)
 {
     if(!buf.good() || depth>20) {
@@ -90,9 +181,8 @@ void from_wire(Buffer& buf, std::vector<FieldDesc>& descs, TypeStore& cache, uns
             return;
 
         } else {
-            cache.emplace(std::piecewise_construct,
-                          std::make_tuple(key),
-                          std::make_tuple(descs.begin()+index, descs.end()));
+            // a peer may re-use a key, replacing any previous entry
+            cache[key] = std::vector<FieldDesc>(descs.begin()+index, descs.end());
 
             descs[index].parent_index = 0u; // our caller will set if actually is a parent.
         }
@@ -181,6 +271,8 @@ void from_wire(Buffer& buf, std::vector<FieldDesc>& descs, TypeStore& cache, uns
                     }
                 }
             }
+
+            descs[index].mindex.build(descs[index].mlookup);
         }
             break;
         default:
@@ -211,7 +303,7 @@ void from_wire(Buffer& buf, std::vector<FieldDesc>& descs, TypeStore& cache, uns
 
 // serialize a field and all children (if Compound)
 static
-void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<const FieldStorage>& store)
+void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<const FieldStorage>& store, TypeCache* types)
 {
     switch(store->code) {
     case StoreType::Null:
@@ -223,7 +315,7 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
                 if(cdesc->code==TypeCode::Struct) // skip sub-struct nodes.  Would be redundant
                     continue;
                 std::shared_ptr<const FieldStorage> cstore(store, store.get()+off); // TODO avoid shared_ptr/aliasing here
-                to_wire_field(buf, cdesc, cstore);
+                to_wire_field(buf, cdesc, cstore, types);
             }
         }
             return;
@@ -270,9 +362,9 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
     }
         break;
     case StoreType::String: {
-        auto& fld = store->as<std::string>();
+        auto& fld = store->as<CowString>();
         switch(desc->code.code) {
-        case TypeCode::String: to_wire(buf, fld); return;
+        case TypeCode::String: to_wire(buf, fld.str()); return;
         default: break;
         }
     }
@@ -295,7 +387,7 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
                 if(index>=desc->miter.size())
                     throw std::logic_error("Union contains non-member type");
                 to_wire(buf, Size{index});
-                to_wire_full(buf, fld);
+                to_wire_full(buf, fld, types);
             }
             return;
 
@@ -304,8 +396,12 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
                 to_wire(buf, uint8_t(0xff));
 
             } else {
-                to_wire(buf, Value::Helper::desc(fld));
-                to_wire_full(buf, fld);
+                // variant type, maybe as a reference to one previously sent
+                if(types)
+                    to_wire(buf, Value::Helper::desc(fld), *types);
+                else
+                    to_wire(buf, Value::Helper::desc(fld));
+                to_wire_full(buf, fld, types);
             }
             return;
         default: break;
@@ -360,7 +456,7 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
                 } else {
                     to_wire(buf, uint8_t(1u));
                     assert(Value::Helper::desc(elem)==&desc->members[0]);
-                    to_wire_full(buf, elem);
+                    to_wire_full(buf, elem, types);
                 }
             }
         }
@@ -374,7 +470,7 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
                 } else {
                     to_wire(buf, uint8_t(1u));
 
-                    to_wire_full(buf, elem);
+                    to_wire_full(buf, elem, types);
                 }
             }
         }
@@ -388,8 +484,11 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
                 } else {
                     to_wire(buf, uint8_t(1u));
 
-                    to_wire(buf, Value::Helper::desc(elem));
-                    to_wire_full(buf, elem);
+                    if(types)
+                        to_wire(buf, Value::Helper::desc(elem), *types);
+                    else
+                        to_wire(buf, Value::Helper::desc(elem));
+                    to_wire_full(buf, elem, types);
                 }
             }
         }
@@ -404,14 +503,14 @@ void to_wire_field(Buffer& buf, const FieldDesc* desc, const std::shared_ptr<con
     buf.fault(__FILE__, __LINE__);
 }
 
-void to_wire_full(Buffer& buf, const Value& val)
+void to_wire_full(Buffer& buf, const Value& val, TypeCache* types)
 {
     assert(!!val);
 
-    to_wire_field(buf, Value::Helper::desc(val), Value::Helper::store(val));
+    to_wire_field(buf, Value::Helper::desc(val), Value::Helper::store(val), types);
 }
 
-void to_wire_valid(Buffer& buf, const Value& val, const BitMask* mask)
+void to_wire_valid(Buffer& buf, const Value& val, const BitMask* mask, TypeCache* types)
 {
     auto desc = Value::Helper::desc(val);
     auto store = Value::Helper::store(val);
@@ -433,10 +532,206 @@ void to_wire_valid(Buffer& buf, const Value& val, const BitMask* mask)
 
     for(auto bit : valid.onlySet()) {
         std::shared_ptr<const FieldStorage> cstore(store, store.get()+bit);
-        to_wire_field(buf, desc+bit, cstore);
+        to_wire_field(buf, desc+bit, cstore, types);
+    }
+}
+
+// does this type include an Any or AnyA field.  Including through Union and arrays
+static
+bool hasVariant(const FieldDesc* desc)
+{
+    for(auto i : range(desc->size())) {
+        auto& fld = desc[i];
+        switch(fld.code.code) {
+        case TypeCode::Any:
+        case TypeCode::AnyA:
+            return true;
+        case TypeCode::StructA:
+        case TypeCode::UnionA:
+            if(hasVariant(&fld.members[0]))
+                return true;
+            break;
+        case TypeCode::Union:
+            for(auto& pair : fld.miter) {
+                if(hasVariant(&fld.members[pair.second]))
+                    return true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+WirePlan::WirePlan(const FieldDesc* desc, const BitMask* pmask)
+    :desc(desc)
+{
+    if(!desc)
+        return;
+
+    variant = hasVariant(desc);
+
+    const size_t N = desc->size();
+    if(pmask && pmask->size()!=N)
+        throw std::logic_error("WirePlan mask does not match type");
+
+    mask.resize(N);
+    kinds.reserve(N);
+
+    for(auto bit : range(N)) {
+        auto& fld = desc[bit];
+
+        Kind kind;
+        switch(fld.code.code) {
+        case TypeCode::Struct:  kind = SubStruct; break;
+        case TypeCode::Bool:    kind = Bool; break;
+        case TypeCode::Int8:    kind = Int8; break;
+        case TypeCode::Int16:   kind = Int16; break;
+        case TypeCode::Int32:   kind = Int32; break;
+        case TypeCode::Int64:   kind = Int64; break;
+        case TypeCode::UInt8:   kind = UInt8; break;
+        case TypeCode::UInt16:  kind = UInt16; break;
+        case TypeCode::UInt32:  kind = UInt32; break;
+        case TypeCode::UInt64:  kind = UInt64; break;
+        case TypeCode::Float32: kind = Float32; break;
+        case TypeCode::Float64: kind = Float64; break;
+        case TypeCode::String:  kind = String; break;
+        default:                kind = Other; break;
+        }
+        kinds.push_back(kind);
+
+        if(!pmask || (*pmask)[bit]) {
+            mask[bit] = true;
+            ops.push_back(Op{uint32_t(bit), uint32_t(fld.size())});
+        }
+    }
+}
+
+// serialize the field at offset bit, and all children, according to plan
+static
+void to_wire_planned(Buffer& buf, const WirePlan& plan, const std::shared_ptr<const FieldStorage>& store, size_t bit,
+                     TypeCache* types)
+{
+    auto fld = store.get()+bit;
+
+    switch(plan.kinds[bit]) {
+    case WirePlan::SubStruct:
+        // serialize entire sub-structure, skipping (redundant) sub-struct nodes
+        for(auto off : range(bit+1u, bit+plan.desc[bit].size())) {
+            if(plan.kinds[off]!=WirePlan::SubStruct)
+                to_wire_planned(buf, plan, store, off, types);
+        }
+        return;
+    case WirePlan::Bool:    to_wire(buf, uint8_t(fld->as<bool>())); return;
+    case WirePlan::Int8:    to_wire(buf, int8_t (fld->as<int64_t>())); return;
+    case WirePlan::Int16:   to_wire(buf, int16_t(fld->as<int64_t>())); return;
+    case WirePlan::Int32:   to_wire(buf, int32_t(fld->as<int64_t>())); return;
+    case WirePlan::Int64:   to_wire(buf, int64_t(fld->as<int64_t>())); return;
+    case WirePlan::UInt8:   to_wire(buf, uint8_t (fld->as<uint64_t>())); return;
+    case WirePlan::UInt16:  to_wire(buf, uint16_t(fld->as<uint64_t>())); return;
+    case WirePlan::UInt32:  to_wire(buf, uint32_t(fld->as<uint64_t>())); return;
+    case WirePlan::UInt64:  to_wire(buf, uint64_t(fld->as<uint64_t>())); return;
+    case WirePlan::Float32: to_wire(buf, float(fld->as<double>())); return;
+    case WirePlan::Float64: to_wire(buf, double(fld->as<double>())); return;
+    case WirePlan::String:  to_wire(buf, fld->as<CowString>().str()); return;
+    case WirePlan::Other:
+        to_wire_field(buf, plan.desc+bit, std::shared_ptr<const FieldStorage>(store, fld), types);
+        return;
+    }
+}
+
+void to_wire_valid(Buffer& buf, const Value& val, const WirePlan& plan, TypeCache* types)
+{
+    auto desc = Value::Helper::desc(val);
+    auto store = Value::Helper::store(val);
+
+    if(desc!=plan.desc) {
+        // plan built for some other type
+        to_wire_valid(buf, val, plan.desc ? &plan.mask : nullptr, types);
+        return;
+    }
+    assert(desc && desc->code==TypeCode::Struct);
+
+    BitMask valid(desc->size());
+
+    size_t next = 0u; // skip fields within a selected sub-struct
+    for(auto& op : plan.ops) {
+        if(op.bit >= next && store.get()[op.bit].valid) {
+            valid[op.bit] = true;
+            next = op.bit + op.size;
+        }
+    }
+
+    to_wire(buf, valid);
+
+    next = 0u;
+    for(auto& op : plan.ops) {
+        if(op.bit >= next && valid[op.bit]) {
+            to_wire_planned(buf, plan, store, op.bit, types);
+            next = op.bit + op.size;
+        }
+    }
+}
+
+typedef epicsGuard<epicsMutex> Guard;
+
+ArrayPool::~ArrayPool()
+{
+    for(auto& blk : blocks) {
+        if(alloc)
+            alloc->deallocate(blk.second, blk.first);
+        else
+            ::operator delete(blk.second);
     }
 }
 
+size_t ArrayPool::spares() const
+{
+    Guard G(lock);
+    return blocks.size();
+}
+
+void* ArrayPool::take(size_t nbytes)
+{
+    {
+        Guard G(lock);
+        for(auto it(blocks.begin()), end(blocks.end()); it!=end; ++it) {
+            if(it->first==nbytes) {
+                auto mem = it->second;
+                blocks.erase(it);
+                return mem;
+            }
+        }
+    }
+    return alloc ? alloc->allocate(nbytes) : ::operator new(nbytes);
+}
+
+void ArrayPool::Release::operator()(void* mem) const
+{
+    // maybe on worker or user thread
+    std::pair<size_t, void*> blk(nbytes, mem);
+    if(auto self = pool.lock()) {
+        Guard G(self->lock);
+        if(self->limit) {
+            decltype (blk) oldest(0u, nullptr);
+            if(self->blocks.size() >= self->limit) {
+                // the oldest spare is the least likely to match the next update
+                oldest = self->blocks.front();
+                self->blocks.erase(self->blocks.begin());
+            }
+            self->blocks.push_back(blk);
+            blk = oldest;
+        }
+    }
+    if(!blk.second)
+        return;
+    else if(alloc)
+        alloc->deallocate(blk.second, blk.first);
+    else
+        ::operator delete(blk.second);
+}
+
 namespace {
 template<typename T>
 T from_wire_as(Buffer& buf)
@@ -448,7 +743,8 @@ T from_wire_as(Buffer& buf)
 }
 
 static
-void from_wire_field(Buffer& buf, TypeStore& ctxt,  const FieldDesc* desc, const std::shared_ptr<FieldStorage>& store)
+void from_wire_field(Buffer& buf, TypeStore& ctxt,  const FieldDesc* desc, const std::shared_ptr<FieldStorage>& store,
+                     ArrayPool* pool=nullptr)
 {
     switch(store->code) {
     case StoreType::Null:
@@ -459,7 +755,7 @@ void from_wire_field(Buffer& buf, TypeStore& ctxt,  const FieldDesc* desc, const
                 auto cdesc = desc + off;
                 std::shared_ptr<FieldStorage> cstore(store, store.get()+off); // TODO avoid shared_ptr/aliasing here
                 if(cdesc->code!=TypeCode::Struct) {
-                    from_wire_field(buf, ctxt, cdesc, cstore);
+                    from_wire_field(buf, ctxt, cdesc, cstore, pool);
                     cstore->valid = true;
                 }
             }
@@ -508,9 +804,9 @@ void from_wire_field(Buffer& buf, TypeStore& ctxt,  const FieldDesc* desc, const
     }
         break;
     case StoreType::String: {
-        auto& fld = store->as<std::string>();
+        auto& fld = store->as<CowString>();
         switch(desc->code.code) {
-        case TypeCode::String: from_wire(buf, fld); return;
+        case TypeCode::String: from_wire(buf, fld.mut()); return;
         default: break;
         }
     }
@@ -566,37 +862,37 @@ void from_wire_field(Buffer& buf, TypeStore& ctxt,  const FieldDesc* desc, const
         auto& fld = store->as<shared_array<const void>>();
         switch (desc->code.code) {
         case TypeCode::BoolA:
-            from_wire<bool, uint8_t>(buf, fld);
+            from_wire<bool, uint8_t>(buf, fld, pool);
             return;
         case TypeCode::Int8A:
-            from_wire<int8_t>(buf, fld);
+            from_wire<int8_t>(buf, fld, pool);
             return;
         case TypeCode::UInt8A:
-            from_wire<uint8_t>(buf, fld);
+            from_wire<uint8_t>(buf, fld, pool);
             return;
         case TypeCode::Int16A:
-            from_wire<int16_t>(buf, fld);
+            from_wire<int16_t>(buf, fld, pool);
             return;
         case TypeCode::UInt16A:
-            from_wire<uint16_t>(buf, fld);
+            from_wire<uint16_t>(buf, fld, pool);
             return;
         case TypeCode::Int32A:
-            from_wire<int32_t>(buf, fld);
+            from_wire<int32_t>(buf, fld, pool);
             return;
         case TypeCode::UInt32A:
-            from_wire<uint32_t>(buf, fld);
+            from_wire<uint32_t>(buf, fld, pool);
             return;
         case TypeCode::Float32A:
-            from_wire<float>(buf, fld);
+            from_wire<float>(buf, fld, pool);
             return;
         case TypeCode::Int64A:
-            from_wire<int64_t>(buf, fld);
+            from_wire<int64_t>(buf, fld, pool);
             return;
         case TypeCode::UInt64A:
-            from_wire<uint64_t>(buf, fld);
+            from_wire<uint64_t>(buf, fld, pool);
             return;
         case TypeCode::Float64A:
-            from_wire<double>(buf, fld);
+            from_wire<double>(buf, fld, pool);
             return;
         case TypeCode::StringA:
             from_wire<std::string>(buf, fld);
@@ -693,7 +989,7 @@ void from_wire_full(Buffer& buf, TypeStore& ctxt, Value& val)
     from_wire_field(buf, ctxt, Value::Helper::desc(val), Value::Helper::store(val));
 }
 
-void from_wire_valid(Buffer& buf, TypeStore& ctxt, Value& val)
+void from_wire_valid(Buffer& buf, TypeStore& ctxt, Value& val, ArrayPool* pool)
 {
     auto desc = Value::Helper::desc(val);
     auto store = Value::Helper::store(val);
@@ -717,12 +1013,262 @@ void from_wire_valid(Buffer& buf, TypeStore& ctxt, Value& val)
     {
         std::shared_ptr<FieldStorage> cstore(store, store.get()+bit);
         auto cdesc = desc + bit;
-        from_wire_field(buf, ctxt, cdesc, cstore);
+        from_wire_field(buf, ctxt, cdesc, cstore, pool);
         cstore->valid = true;
         bit = valid.findSet(bit + cdesc->size());
     }
 }
 
+// deserialize the field at offset bit, and all children, according to plan
+static
+void from_wire_planned(Buffer& buf, TypeStore& ctxt, const WirePlan& plan, const std::shared_ptr<FieldStorage>& store,
+                       size_t bit, ArrayPool* pool)
+{
+    auto fld = store.get()+bit;
+
+    switch(plan.kinds[bit]) {
+    case WirePlan::SubStruct:
+        for(auto off : range(bit+1u, bit+plan.desc[bit].size())) {
+            if(plan.kinds[off]!=WirePlan::SubStruct) {
+                from_wire_planned(buf, ctxt, plan, store, off, pool);
+                store.get()[off].valid = true;
+            }
+        }
+        return;
+    case WirePlan::Bool:    fld->as<bool>() = 0!=from_wire_as<uint8_t>(buf); return;
+    case WirePlan::Int8:    fld->as<int64_t>() = from_wire_as<int8_t>(buf); return;
+    case WirePlan::Int16:   fld->as<int64_t>() = from_wire_as<int16_t>(buf); return;
+    case WirePlan::Int32:   fld->as<int64_t>() = from_wire_as<int32_t>(buf); return;
+    case WirePlan::Int64:   fld->as<int64_t>() = from_wire_as<int64_t>(buf); return;
+    case WirePlan::UInt8:   fld->as<uint64_t>() = from_wire_as<uint8_t>(buf); return;
+    case WirePlan::UInt16:  fld->as<uint64_t>() = from_wire_as<uint16_t>(buf); return;
+    case WirePlan::UInt32:  fld->as<uint64_t>() = from_wire_as<uint32_t>(buf); return;
+    case WirePlan::UInt64:  fld->as<uint64_t>() = from_wire_as<uint64_t>(buf); return;
+    case WirePlan::Float32: fld->as<double>() = from_wire_as<float>(buf); return;
+    case WirePlan::Float64: fld->as<double>() = from_wire_as<double>(buf); return;
+    case WirePlan::String:  from_wire(buf, fld->as<CowString>().mut()); return;
+    case WirePlan::Other:
+        from_wire_field(buf, ctxt, plan.desc+bit, std::shared_ptr<FieldStorage>(store, fld), pool);
+        return;
+    }
+}
+
+void from_wire_valid(Buffer& buf, TypeStore& ctxt, Value& val, const WirePlan& plan, ArrayPool* pool)
+{
+    auto desc = Value::Helper::desc(val);
+    auto store = Value::Helper::store(val);
+
+    if(!desc || !store) {
+        buf.fault(__FILE__, __LINE__);
+        return;
+
+    } else if(desc!=plan.desc) {
+        // plan built for some other type
+        from_wire_valid(buf, ctxt, val, pool);
+        return;
+    }
+
+    BitMask valid;
+    from_wire(buf, valid);
+    // encoding rounds # of bits to whole bytes, so we may trim
+    valid.resize(desc->size());
+    if(!buf.good())
+        return;
+
+    for(auto bit = valid.findSet(0u);
+        bit<desc->size() && buf.good();)
+    {
+        from_wire_planned(buf, ctxt, plan, store, bit, pool);
+        store.get()[bit].valid = true;
+        bit = valid.findSet(bit + desc[bit].size());
+    }
+}
+
+bool diffArray(ArrayRuns& runs, const shared_array<const void>& prev, const shared_array<const void>& cur)
+{
+    runs.clear();
+
+    const auto type = cur.original_type();
+    if(prev.original_type()!=type || prev.size()!=cur.size())
+        return false;
+
+    switch(type) {
+    case ArrayType::Bool:
+    case ArrayType::Int8:
+    case ArrayType::Int16:
+    case ArrayType::Int32:
+    case ArrayType::Int64:
+    case ArrayType::UInt8:
+    case ArrayType::UInt16:
+    case ArrayType::UInt32:
+    case ArrayType::UInt64:
+    case ArrayType::Float32:
+    case ArrayType::Float64:
+        break;
+    default:
+        return false;
+    }
+
+    const size_t esize = elementSize(type);
+    const size_t limit = cur.size()*esize/2u;
+    // join runs separated by fewer bytes than the overhead of another run
+    const size_t maxGap = std::max(size_t(1u), 8u/esize);
+    auto a = static_cast<const char*>(prev.data());
+    auto b = static_cast<const char*>(cur.data());
+
+    if(limit < 64u)
+        return false; // too short to bother
+    else if(a==b)
+        return true; // same storage, so no change
+
+    size_t cost = 0u;
+    for(auto i : range(cur.size())) {
+        if(!memcmp(a + i*esize, b + i*esize, esize))
+            continue;
+
+        if(!runs.empty() && i - (runs.back().first + runs.back().second) <= maxGap) {
+            auto end = runs.back().first + runs.back().second;
+            cost += (i + 1u - end)*esize;
+            runs.back().second = i + 1u - runs.back().first;
+        } else {
+            cost += 10u + esize; // start and count
+            runs.emplace_back(i, 1u);
+        }
+        if(cost >= limit)
+            return false;
+    }
+    return true;
+}
+
+namespace {
+template<typename E, typename C = E>
+void to_wire_runs(Buffer& buf, const shared_array<const void>& varr, const ArrayRuns& runs)
+{
+    auto arr(varr.castTo<const E>());
+    to_wire(buf, Size{runs.size()});
+    for(auto& run : runs) {
+        to_wire(buf, Size{run.first});
+        shared_array<const E> part(arr.dataPtr(), arr.data() + run.first, run.second);
+        to_wire<E, C>(buf, part.template castTo<const void>());
+    }
+}
+
+template<typename E, typename C = E>
+void from_wire_runs(Buffer& buf, shared_array<const void>& varr)
+{
+    auto arr(varr.castTo<const E>());
+    shared_array<E> patched(arr.begin(), arr.end());
+
+    Size nruns{};
+    from_wire(buf, nruns);
+    for(auto n : range(nruns.size)) {
+        (void)n;
+        Size start{};
+        from_wire(buf, start);
+        shared_array<const void> vpart;
+        from_wire<E, C>(buf, vpart);
+        auto part(vpart.castTo<const E>());
+
+        if(!buf.good() || start.size > patched.size() || part.size() > patched.size() - start.size) {
+            buf.fault(__FILE__, __LINE__);
+            return;
+        }
+        std::copy(part.begin(), part.end(), patched.begin() + start.size);
+    }
+    varr = patched.freeze().template castTo<const void>();
+}
+} // namespace
+
+void to_wire_patch(Buffer& buf, const FieldDesc* desc, const shared_array<const void>& cur, const ArrayRuns& runs)
+{
+    switch(desc->code.code) {
+    case TypeCode::BoolA:    to_wire_runs<bool, uint8_t>(buf, cur, runs); return;
+    case TypeCode::Int8A:    to_wire_runs<int8_t>(buf, cur, runs); return;
+    case TypeCode::Int16A:   to_wire_runs<int16_t>(buf, cur, runs); return;
+    case TypeCode::Int32A:   to_wire_runs<int32_t>(buf, cur, runs); return;
+    case TypeCode::Int64A:   to_wire_runs<int64_t>(buf, cur, runs); return;
+    case TypeCode::UInt8A:   to_wire_runs<uint8_t>(buf, cur, runs); return;
+    case TypeCode::UInt16A:  to_wire_runs<uint16_t>(buf, cur, runs); return;
+    case TypeCode::UInt32A:  to_wire_runs<uint32_t>(buf, cur, runs); return;
+    case TypeCode::UInt64A:  to_wire_runs<uint64_t>(buf, cur, runs); return;
+    case TypeCode::Float32A: to_wire_runs<float>(buf, cur, runs); return;
+    case TypeCode::Float64A: to_wire_runs<double>(buf, cur, runs); return;
+    default:
+        buf.fault(__FILE__, __LINE__);
+    }
+}
+
+void from_wire_patch(Buffer& buf, const FieldDesc* desc, shared_array<const void>& arr)
+{
+    switch(desc->code.code) {
+    case TypeCode::BoolA:    from_wire_runs<bool, uint8_t>(buf, arr); return;
+    case TypeCode::Int8A:    from_wire_runs<int8_t>(buf, arr); return;
+    case TypeCode::Int16A:   from_wire_runs<int16_t>(buf, arr); return;
+    case TypeCode::Int32A:   from_wire_runs<int32_t>(buf, arr); return;
+    case TypeCode::Int64A:   from_wire_runs<int64_t>(buf, arr); return;
+    case TypeCode::UInt8A:   from_wire_runs<uint8_t>(buf, arr); return;
+    case TypeCode::UInt16A:  from_wire_runs<uint16_t>(buf, arr); return;
+    case TypeCode::UInt32A:  from_wire_runs<uint32_t>(buf, arr); return;
+    case TypeCode::UInt64A:  from_wire_runs<uint64_t>(buf, arr); return;
+    case TypeCode::Float32A: from_wire_runs<float>(buf, arr); return;
+    case TypeCode::Float64A: from_wire_runs<double>(buf, arr); return;
+    default:
+        buf.fault(__FILE__, __LINE__);
+    }
+}
+
+namespace {
+// process wide table of received types, by encoding
+struct TypeIntern {
+    epicsMutex lock;
+    std::unordered_map<std::string, std::weak_ptr<const std::vector<FieldDesc>>> types;
+    // size() at which expired entries are next removed
+    size_t sweepAt = 64u;
+};
+} // namespace
+
+std::shared_ptr<const FieldDesc> internType(const std::shared_ptr<const std::vector<FieldDesc>>& descs)
+{
+    if(!descs || descs->empty())
+        return nullptr;
+
+    std::string key;
+    {
+        std::vector<uint8_t> scratch(256u);
+        VectorOutBuf E(true, scratch);
+        to_wire(E, descs->data());
+        if(!E.good())
+            throw std::logic_error("Unable to encode type");
+        key.assign(reinterpret_cast<const char*>(scratch.data()), E.consumed());
+    }
+
+    static TypeIntern intern;
+
+    std::shared_ptr<const std::vector<FieldDesc>> ret;
+    {
+        Guard G(intern.lock);
+
+        auto& ent = intern.types[key];
+        ret = ent.lock();
+        if(!ret) {
+            ent = descs;
+            ret = descs;
+
+            if(intern.types.size() >= intern.sweepAt) {
+                for(auto it = intern.types.begin(); it!=intern.types.end();) {
+                    if(it->second.expired())
+                        it = intern.types.erase(it);
+                    else
+                        ++it;
+                }
+                intern.sweepAt = std::max(size_t(64u), 2u*intern.types.size());
+            }
+        }
+    }
+
+    return std::shared_ptr<const FieldDesc>(ret, ret->data()); // alias
+}
+
 void from_wire_type(Buffer& buf, TypeStore& ctxt, Value& val)
 {
     auto descs(std::make_shared<std::vector<FieldDesc>>());
@@ -733,8 +1279,8 @@ void from_wire_type(Buffer& buf, TypeStore& ctxt, Value& val)
 
     if(!descs->empty()) {
 
-        std::shared_ptr<const FieldDesc> stype(descs, descs->data()); // alias
-        val = Value::Helper::build(stype);
+        // identical types received through any connection share one FieldDesc tree
+        val = Value::Helper::build(internType(descs));
 
     } else {
         val = Value();
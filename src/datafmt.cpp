@@ -4,14 +4,221 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
+#include <cmath>
+
+#include <stdio.h>
+
 #include "dataimpl.h"
 
 namespace pvxs {
 
 namespace {
 
-struct FmtDelta {
+/* The formatters below are written against one of two output adapters.
+ * StreamOut prints to a std::ostream, honoring its indent{} level and flags.
+ * StringOut appends to a std::string, producing the same bytes as a
+ * newly constructed std::ostream would, without any per-field ostream calls.
+ */
+
+struct StreamOut {
     std::ostream& strm;
+
+    struct Indent : public Indented {
+        explicit Indent(StreamOut& out) :Indented(out.strm) {}
+    };
+
+    void indent() { strm<<pvxs::indent{}; }
+    void put(char c) { strm<<c; }
+    void put(const char* s) { strm<<s; }
+    void put(const std::string& s) { strm<<s; }
+    void put(const char* s, size_t n) { strm.write(s, n); }
+    void escaped(const std::string& s) { strm<<escape(s); }
+    void typeName(TypeCode code) { strm<<code; }
+    void num(int64_t v) { strm<<v; }
+    void num(uint64_t v) { strm<<v; }
+    void num(double v) { strm<<v; }
+    // with enough digits to round trip
+    void real(double v) {
+        Restore R(strm);
+        strm.precision(17);
+        strm<<v;
+    }
+    template<typename T>
+    void value(T v) { strm<<v; }
+    void array(const shared_array<const void>& arr, size_t limit) { strm<<arr.format().limit(limit); }
+};
+
+struct StringOut {
+    std::string& buf;
+    unsigned depth = 0u;
+
+    explicit StringOut(std::string& buf) :buf(buf) {}
+
+    struct Indent {
+        StringOut& out;
+        explicit Indent(StringOut& out) :out(out) { out.depth++; }
+        ~Indent() { out.depth--; }
+    };
+
+    void indent() { buf.append(4u*depth, ' '); }
+    void put(char c) { buf.push_back(c); }
+    void put(const char* s) { buf += s; }
+    void put(const std::string& s) { buf += s; }
+    void put(const char* s, size_t n) { buf.append(s, n); }
+
+    // cf. detail::Escaper
+    void escaped(const std::string& s) {
+        for(char c : s) {
+            char next;
+            switch(c) {
+            case '\a': next = 'a'; break;
+            case '\b': next = 'b'; break;
+            case '\f': next = 'f'; break;
+            case '\n': next = 'n'; break;
+            case '\r': next = 'r'; break;
+            case '\t': next = 't'; break;
+            case '\v': next = 'v'; break;
+            case '\\': next = '\\'; break;
+            case '\'': next = '\''; break;
+            case '\"': next = '\"'; break;
+            default:
+                if(c>=' ' && c<='~') { // isprint()
+                    buf.push_back(c);
+                } else {
+                    static const char hex[] = "0123456789abcdef";
+                    buf += "\\x";
+                    buf.push_back(hex[(c>>4)&0xf]);
+                    buf.push_back(hex[c&0xf]);
+                }
+                continue;
+            }
+            buf.push_back('\\');
+            buf.push_back(next);
+        }
+    }
+
+    void typeName(TypeCode code) {
+        auto name = code.name();
+        if(name[0]!='?') {
+            buf += name;
+        } else {
+            static const char hex[] = "0123456789abcdef";
+            buf += "TypeCode(0x";
+            if(code.code>>4)
+                buf.push_back(hex[code.code>>4]);
+            buf.push_back(hex[code.code&0xf]);
+            buf.push_back(')');
+        }
+    }
+
+    void num(uint64_t v) {
+        char tmp[20];
+        size_t n = sizeof(tmp);
+        do {
+            tmp[--n] = char('0' + v%10u);
+            v /= 10u;
+        } while(v);
+        buf.append(tmp+n, sizeof(tmp)-n);
+    }
+    void num(int64_t v) {
+        if(v<0) {
+            buf.push_back('-');
+            num(uint64_t(0u) - uint64_t(v));
+        } else {
+            num(uint64_t(v));
+        }
+    }
+    // std::ostream default is equivalent to "%.6g"
+    void num(double v) {
+        char tmp[32];
+        auto n = snprintf(tmp, sizeof(tmp), "%g", v);
+        if(n>0)
+            buf.append(tmp, std::min(size_t(n), sizeof(tmp)-1u));
+    }
+    void real(double v) {
+        char tmp[32];
+        auto n = snprintf(tmp, sizeof(tmp), "%.17g", v);
+        if(n>0)
+            buf.append(tmp, std::min(size_t(n), sizeof(tmp)-1u));
+    }
+
+    // as with std::ostream, (u)int8_t are printed as characters.  float as double.
+    void value(int8_t v) { buf.push_back(char(v)); }
+    void value(uint8_t v) { buf.push_back(char(v)); }
+    void value(int16_t v) { num(int64_t(v)); }
+    void value(int32_t v) { num(int64_t(v)); }
+    void value(int64_t v) { num(int64_t(v)); }
+    void value(uint16_t v) { num(uint64_t(v)); }
+    void value(uint32_t v) { num(uint64_t(v)); }
+    void value(uint64_t v) { num(uint64_t(v)); }
+    void value(float v) { num(double(v)); }
+    void value(double v) { num(double(v)); }
+
+    // cf. detail::Print, array elements are printed as numbers
+    void elem(bool v) { buf.push_back(v ? '1' : '0'); }
+    void elem(int8_t v) { num(int64_t(v)); }
+    void elem(uint8_t v) { num(uint64_t(v)); }
+    void elem(const std::string& v) {
+        buf.push_back('"');
+        escaped(v);
+        buf.push_back('"');
+    }
+    template<typename T>
+    void elem(const T& v) { value(v); }
+
+    // cf. detail::showArr()
+    template<typename E>
+    void showArr(const shared_array<const void>& arr, size_t limit) {
+        auto base = static_cast<const E*>(arr.data());
+        auto count = arr.size();
+
+        if(limit==0)
+            limit=size_t(-1);
+
+        buf.push_back('{');
+        num(uint64_t(count));
+        buf += "}[";
+        for(auto i : range(count)) {
+            if(i!=0)
+                buf += ", ";
+            if(i>=limit) {
+                buf += "...";
+                break;
+            }
+            elem(base[i]);
+        }
+        buf.push_back(']');
+    }
+
+    void array(const shared_array<const void>& arr, size_t limit) {
+        switch(arr.original_type()) {
+#define CASE(CODE, Type) case ArrayType::CODE: showArr<Type>(arr, limit); break
+        CASE(Bool, bool);
+        CASE(UInt8, uint8_t);
+        CASE(UInt16, uint16_t);
+        CASE(UInt32, uint32_t);
+        CASE(UInt64, uint64_t);
+        CASE(Int8, int8_t);
+        CASE(Int16, int16_t);
+        CASE(Int32, int32_t);
+        CASE(Int64, int64_t);
+        CASE(Float32, float);
+        CASE(Float64, double);
+        CASE(String, std::string);
+#undef CASE
+        case ArrayType::Null:
+            buf += "{\?}[]";
+            break;
+        default:
+            buf += "[\?\?\?]";
+        }
+    }
+};
+
+template<typename Out>
+struct FmtDelta {
+    Out& out;
     const Value::Fmt& fmt;
 
     void field(const std::string& prefix, const Value& val, bool verytop)
@@ -19,27 +226,35 @@ struct FmtDelta {
         if(verytop && !val.isMarked(false))
             return;
 
-        strm<<indent{}<<prefix;
+        out.indent();
+        out.put(prefix);
         if(!verytop)
-            strm<<" ";
-        strm<<val.type().name();
+            out.put(' ');
+        out.put(val.type().name());
         if(val.type()==TypeCode::Struct && !val.id().empty()) {
-            strm<<" \""<<escape(val.id())<<'"';
+            out.put(" \"");
+            out.escaped(val.id());
+            out.put('"');
         }
 
         if(fmt._showValue) {
             auto store = Value::Helper::store_ptr(val);
 
             switch(val.storageType()) {
-            case StoreType::Real:     strm<<" = "<<store->as<double>(); break;
-            case StoreType::Integer:  strm<<" = "<<store->as<int64_t>(); break;
-            case StoreType::UInteger: strm<<" = "<<store->as<uint64_t>(); break;
-            case StoreType::Bool:     strm<<" = "<<(store->as<bool>() ? "true" : "false"); break;
-            case StoreType::String:   strm<<" = \""<<escape(store->as<std::string>())<<"\""; break;
+            case StoreType::Real:     out.put(" = "); out.num(store->as<double>()); break;
+            case StoreType::Integer:  out.put(" = "); out.num(int64_t(store->as<int64_t>())); break;
+            case StoreType::UInteger: out.put(" = "); out.num(uint64_t(store->as<uint64_t>())); break;
+            case StoreType::Bool:     out.put(" = "); out.put(store->as<bool>() ? "true" : "false"); break;
+            case StoreType::String:
+                out.put(" = \"");
+                out.escaped(store->as<CowString>().str());
+                out.put("\"");
+                break;
             case StoreType::Array: {
                 auto& varr = store->as<shared_array<const void>>();
                 if(varr.original_type()!=ArrayType::Value) {
-                    strm<<" = "<<varr.format().limit(fmt._limit);
+                    out.put(" = ");
+                    out.array(varr, fmt._limit);
                 }
             }
                 break;
@@ -48,7 +263,7 @@ struct FmtDelta {
             }
         }
 
-        strm<<"\n";
+        out.put("\n");
 
         switch(val.type().code) {
         case TypeCode::Union:
@@ -81,10 +296,12 @@ struct FmtDelta {
                 auto aval = rawval.castTo<const Value>();
 
                 for(auto idx : range(aval.size())) {
-                    std::ostringstream strm;
-                    strm<<indent{}<<prefix<<'['<<idx<<']';
+                    std::string cprefix(prefix);
+                    cprefix += '[';
+                    cprefix += std::to_string(idx);
+                    cprefix += ']';
 
-                    top(strm.str(), aval[idx], false);
+                    top(cprefix, aval[idx], false);
                 }
 
             } else {
@@ -100,10 +317,11 @@ struct FmtDelta {
     void top(const std::string& prefix, const Value& val, bool verytop)
     {
         if(!val) {
-            strm<<indent{}<<prefix;
+            out.indent();
+            out.put(prefix);
             if(!verytop)
-                strm<<' ';
-            strm<<"null\n";
+                out.put(' ');
+            out.put("null\n");
             return;
         }
 
@@ -121,8 +339,9 @@ struct FmtDelta {
     }
 };
 
+template<typename Out>
 struct FmtTree {
-    std::ostream& strm;
+    Out& out;
     const Value::Fmt& fmt;
 
     void show_value(const Value& fld) {
@@ -131,10 +350,10 @@ struct FmtTree {
 
         switch(type.code) {
         case TypeCode::Bool:
-            strm<<(fld.as<bool>() ? "true" : "false");
+            out.put(fld.as<bool>() ? "true" : "false");
             return;
 #define CASE(ENUM, TYPE) \
-        case TypeCode::ENUM : strm<<fld.as<TYPE>(); return
+        case TypeCode::ENUM : out.value(fld.as<TYPE>()); return
             CASE(Int8, int8_t);
             CASE(Int16, int16_t);
             CASE(Int32, int32_t);
@@ -147,7 +366,9 @@ struct FmtTree {
             CASE(Float64, double);
 #undef CASE
         case TypeCode::String:
-            strm<<"\""<<escape(fld.as<std::string>())<<"\"";
+            out.put("\"");
+            out.escaped(fld.as<CowString>().str());
+            out.put("\"");
             return;
         case TypeCode::BoolA:
         case TypeCode::Int8A:
@@ -163,7 +384,7 @@ struct FmtTree {
         case TypeCode::StringA:
         {
             auto varr = fld.as<shared_array<const void>>();
-            strm<<varr.format().limit(fmt._limit);
+            out.array(varr, fmt._limit);
         }
             return;
         case TypeCode::Any:
@@ -175,36 +396,43 @@ struct FmtTree {
             assert(false);
             break;
         default:
-            strm<<"!!Invalid TypeCode!! "<<int(type.code)<<"\n";
+            out.put("!!Invalid TypeCode!! ");
+            out.num(int64_t(type.code));
+            out.put("\n");
             return;
         }
     }
 
     // each invocation emits at least one complete line
     void show(const Value& fld, const std::string& member) {
-        // caller should indent{}
+        // caller should indent()
         if(!fld) {
-            strm<<"null\n";
+            out.put("null\n");
             return;
         }
 
         const auto type(fld.type());
 
-        strm<<type;
+        out.typeName(type);
         {
             auto id(fld.id());
-            if(!id.empty())
-                strm<<" \""<<id<<"\"";
+            if(!id.empty()) {
+                out.put(" \"");
+                out.put(id);
+                out.put("\"");
+            }
         }
 
         if(type.kind()!=Kind::Compound) {
-            if(!member.empty())
-                strm<<' '<<member;
+            if(!member.empty()) {
+                out.put(' ');
+                out.put(member);
+            }
             if(fmt._showValue) {
-                strm<<" = ";
+                out.put(" = ");
                 show_value(fld);
             }
-            strm<<"\n";
+            out.put("\n");
             return;
         }
 
@@ -218,18 +446,21 @@ struct FmtTree {
             if(fmt._showValue)
                 val = fld.as<Value>();
 
-            if(!member.empty())
-                strm<<' '<<member;
+            if(!member.empty()) {
+                out.put(' ');
+                out.put(member);
+            }
 
             if(type==TypeCode::Union && val) { // implied _showValue
                 auto mem(fld.nameOf(val));
-                strm<<'.'<<mem;
+                out.put('.');
+                out.put(mem);
             }
             if(fmt._showValue) {
-                strm<<" ";
+                out.put(" ");
                 show(val, std::string());
             } else {
-                strm<<"\n";
+                out.put("\n");
             }
             return;
 
@@ -251,45 +482,51 @@ struct FmtTree {
                 def = Value::Helper::build(fld); // not connection to fld (not parent)
             }
 
-            strm<<" {";
+            out.put(" {");
             bool first = true;
             {
-                Indented I(strm);
+                typename Out::Indent I(out);
                 for(auto mem : def.ichildren()) {
                     auto mname(def.nameOf(mem));
                     if(first)
-                        strm<<'\n';
-                    strm<<indent{};
+                        out.put('\n');
+                    out.indent();
                     show(mem, mname);
                     first = false;
                 }
             }
             if(!first)
-                strm<<indent{};
-            strm<<'}';
+                out.indent();
+            out.put('}');
 
-            if(!member.empty())
-                strm<<' '<<member;
-            strm<<"\n";
+            if(!member.empty()) {
+                out.put(' ');
+                out.put(member);
+            }
+            out.put("\n");
 
         } else {
             // struct[] NAME = [ ... ]
 
-            if(!member.empty())
-                strm<<' '<<member;
+            if(!member.empty()) {
+                out.put(' ');
+                out.put(member);
+            }
 
             auto arr(fld.as<shared_array<const Value>>());
-            strm<<" = {"<<arr.size()<<"}[";
+            out.put(" = {");
+            out.num(uint64_t(arr.size()));
+            out.put("}[");
             size_t shown = 0u;
             {
-                Indented I(strm);
+                typename Out::Indent I(out);
 
                 for(auto& elem : arr) {
                     if(!shown)
-                        strm<<'\n';
-                    strm<<indent{};
+                        out.put('\n');
+                    out.indent();
                     if(fmt._limit && shown>=fmt._limit) {
-                        strm<<"...\n";
+                        out.put("...\n");
                         break;
                     }
                     show(elem, std::string());
@@ -298,27 +535,191 @@ struct FmtTree {
             }
 
             if(shown)
-                strm<<indent{};
-            strm<<"]\n";
+                out.indent();
+            out.put("]\n");
         }
     }
 };
 
-} // namespace
+// compact JSON, read directly from field storage.  cf. json::Parse
+template<typename Out>
+struct FmtJSON {
+    Out& out;
+
+    void string(const std::string& s) {
+        out.put('"');
+        size_t start = 0u;
+        for(auto i : range(s.size())) {
+            auto c = s[i];
+            const char* esc = nullptr;
+            char uesc[8];
+            switch(c) {
+            case '"':  esc = "\\\""; break;
+            case '\\': esc = "\\\\"; break;
+            case '\b': esc = "\\b"; break;
+            case '\f': esc = "\\f"; break;
+            case '\n': esc = "\\n"; break;
+            case '\r': esc = "\\r"; break;
+            case '\t': esc = "\\t"; break;
+            default:
+                if(uint8_t(c) < 0x20u) {
+                    snprintf(uesc, sizeof(uesc), "\\u%04x", unsigned(c));
+                    esc = uesc;
+                }
+            }
+            if(esc) {
+                out.put(s.data()+start, i-start);
+                out.put(esc);
+                start = i+1u;
+            }
+        }
+        out.put(s.data()+start, s.size()-start);
+        out.put('"');
+    }
 
-std::ostream& operator<<(std::ostream& strm, const Value::Fmt& fmt)
+    void real(double v) {
+        if(std::isfinite(v))
+            out.real(v);
+        else
+            out.put("null");
+    }
+
+    void elem(bool v) { out.put(v ? "true" : "false"); }
+    void elem(int8_t v) { out.num(int64_t(v)); }
+    void elem(int16_t v) { out.num(int64_t(v)); }
+    void elem(int32_t v) { out.num(int64_t(v)); }
+    void elem(int64_t v) { out.num(int64_t(v)); }
+    void elem(uint8_t v) { out.num(uint64_t(v)); }
+    void elem(uint16_t v) { out.num(uint64_t(v)); }
+    void elem(uint32_t v) { out.num(uint64_t(v)); }
+    void elem(uint64_t v) { out.num(uint64_t(v)); }
+    void elem(float v) { real(v); }
+    void elem(double v) { real(v); }
+    void elem(const std::string& v) { string(v); }
+    void elem(const Value& v) { value(v); }
+
+    template<typename E>
+    void array(const shared_array<const void>& varr) {
+        auto arr(varr.castTo<const E>());
+        out.put('[');
+        bool first = true;
+        for(auto& e : arr) {
+            if(!first)
+                out.put(',');
+            first = false;
+            elem(e);
+        }
+        out.put(']');
+    }
+
+    void value(const Value& val) {
+        if(!val) {
+            out.put("null");
+            return;
+        }
+
+        auto store = Value::Helper::store_ptr(val);
+
+        switch(val.storageType()) {
+        case StoreType::Real:     real(store->as<double>()); break;
+        case StoreType::Integer:  out.num(int64_t(store->as<int64_t>())); break;
+        case StoreType::UInteger: out.num(uint64_t(store->as<uint64_t>())); break;
+        case StoreType::Bool:     out.put(store->as<bool>() ? "true" : "false"); break;
+        case StoreType::String:   string(store->as<CowString>().str()); break;
+        case StoreType::Array: {
+            auto& varr = store->as<shared_array<const void>>();
+            switch(varr.original_type()) {
+#define CASE(CODE, Type) case ArrayType::CODE: array<Type>(varr); break
+            CASE(Bool, bool);
+            CASE(UInt8, uint8_t);
+            CASE(UInt16, uint16_t);
+            CASE(UInt32, uint32_t);
+            CASE(UInt64, uint64_t);
+            CASE(Int8, int8_t);
+            CASE(Int16, int16_t);
+            CASE(Int32, int32_t);
+            CASE(Int64, int64_t);
+            CASE(Float32, float);
+            CASE(Float64, double);
+            CASE(String, std::string);
+            CASE(Value, Value);
+#undef CASE
+            default:
+                out.put("[]");
+            }
+        }
+            break;
+        case StoreType::Compound:
+            switch(val.type().code) {
+            case TypeCode::Struct: {
+                out.put('{');
+                bool first = true;
+                for(auto fld : val.ichildren()) {
+                    if(!first)
+                        out.put(',');
+                    first = false;
+                    string(val.nameOf(fld));
+                    out.put(':');
+                    value(fld);
+                }
+                out.put('}');
+            }
+                break;
+            case TypeCode::Union: {
+                auto mem(store->as<Value>());
+                if(mem) {
+                    out.put('{');
+                    string(val.nameOf(mem));
+                    out.put(':');
+                    value(mem);
+                    out.put('}');
+                } else {
+                    out.put("null");
+                }
+            }
+                break;
+            default: // Any
+                value(store->as<Value>());
+                break;
+            }
+            break;
+        default:
+            out.put("null");
+        }
+    }
+};
+
+template<typename Out>
+void showFmt(Out& out, const Value::Fmt& fmt)
 {
     switch (fmt._format) {
     case Value::Fmt::Tree:
-        strm<<indent{};
-        FmtTree{strm, fmt}.show(*fmt.top, std::string());
+        out.indent();
+        FmtTree<Out>{out, fmt}.show(*fmt.top, std::string());
         break;
     case Value::Fmt::Delta:
-        FmtDelta{strm, fmt}.top("", *fmt.top, true);
+        FmtDelta<Out>{out, fmt}.top("", *fmt.top, true);
+        break;
+    case Value::Fmt::JSON:
+        FmtJSON<Out>{out}.value(*fmt.top);
         break;
     default:
-        strm<<"<Unknown Value format()>\n";
+        out.put("<Unknown Value format()>\n");
     }
+}
+
+} // namespace
+
+void Value::Fmt::appendTo(std::string& buf) const
+{
+    StringOut out(buf);
+    showFmt(out, *this);
+}
+
+std::ostream& operator<<(std::ostream& strm, const Value::Fmt& fmt)
+{
+    StreamOut out{strm};
+    showFmt(out, fmt);
     return strm;
 }
 
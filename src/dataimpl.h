@@ -8,6 +8,10 @@
 
 #include <string>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <cstring>
 
 #include <pvxs/data.h>
 #include <pvxs/sharedArray.h>
@@ -39,10 +43,70 @@ struct Value::Helper {
     static inline                 const impl::FieldStorage*  store_ptr(const Value& v) { return v.store.get(); }
 
     static std::shared_ptr<const impl::FieldDesc> type(const Value& v);
+
+    // copyIn() from the storage of another field.  String storage is shared, not copied.
+    static void copyIn(Value& dest, const impl::FieldStorage* src);
+
+    // Equivalent to a.assign(src) and b.assign(src), with one pass over the marked fields of src.
+    // Only marked fields are copied when all three have the same type.
+    static void assignMarked(const Value& src, Value& a, Value& b);
+
+    // Approximate bytes held by the top level structure enclosing v, including strings and arrays.
+    // Arrays shared with other Values are counted in full.
+    static size_t approxBytes(const Value& v);
 };
 
 namespace impl {
 struct Buffer;
+struct ArrayPool;
+
+/** Open addressing hash index of the keys of FieldDesc::mlookup
+ *
+ * Allows field lookup by (sub-)string without constructing a std::string,
+ * and without the string compares of a tree walk.
+ */
+struct FieldIndex {
+    struct Slot {
+        std::string name;
+        uint64_t hash = 0u;
+        size_t index = size_t(-1); // size_t(-1) for unused slot
+    };
+    // empty, or size is a power of 2 and at least twice the number of entries
+    std::vector<Slot> slots;
+    // slot of each entry, in order of mlookup value.
+    // For a Struct, the depth first order of descendant fields.  So entry i names offset i+1.
+    std::vector<size_t> order;
+
+    void build(const std::map<std::string, size_t>& mlookup);
+
+    //! Name of the i-th entry, in order of mlookup value
+    inline const std::string& nameAt(size_t i) const { return slots[order[i]].name; }
+
+    static inline uint64_t hashOf(const char* name, size_t len) {
+        // FNV-1a
+        uint64_t h = 0xcbf29ce484222325ull;
+        for(size_t i=0u; i<len; i++) {
+            h ^= uint8_t(name[i]);
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    //! @returns the mlookup value for this name, or size_t(-1) if not found
+    inline size_t find(const char* name, size_t len) const {
+        if(slots.empty())
+            return size_t(-1);
+        const auto h = hashOf(name, len);
+        const size_t mask = slots.size()-1u;
+        for(size_t i = size_t(h)&mask; ; i = (i+1u)&mask) {
+            auto& slot = slots[i];
+            if(slot.index==size_t(-1))
+                return size_t(-1);
+            else if(slot.hash==h && slot.name.size()==len && memcmp(slot.name.data(), name, len)==0)
+                return slot.index;
+        }
+    }
+};
 
 /** Describes a single field, leaf or otherwise, in a nested structure.
  *
@@ -62,6 +126,8 @@ struct FieldDesc {
     // For Struct, relative to this (always >=1)
     // For Union, offset in members array (one entry will always be zero)
     std::map<std::string, size_t> mlookup;
+    // index of mlookup keys, built once mlookup is complete
+    FieldIndex mindex;
 
     // child iteration.  child# -> ("sub", rel index in enclosing vector<FieldDesc>)
     std::vector<std::pair<std::string, size_t>> miter;
@@ -87,13 +153,119 @@ struct FieldDesc {
 PVXS_API
 void to_wire(Buffer& buf, const FieldDesc* cur);
 
+// Receive side cache of type descriptions, by key as assigned by the peer.
+// Bounded by the 16-bit key space, as a peer re-using a key replaces the previous entry.
 typedef std::map<uint16_t, std::vector<FieldDesc>> TypeStore;
 
+// Approximate bytes held by the entries of a TypeStore
+PVXS_API
+size_t approxBytes(const TypeStore& store);
+
+struct TypeCache;
+
+//! Send a type description, or a reference to one previously sent.
+PVXS_API
+void to_wire(Buffer& buf, const FieldDesc* cur, TypeCache& cache);
+
+/** Send side cache of the type descriptions previously sent through one connection.
+ *
+ * The first time a type is sent, it is assigned a key (0xfd).
+ * Later, the same type is sent as a reference to this key (0xfe).
+ * Types are compared by their full encoding, so equivalent types which were
+ * built separately (eg. each RPC reply) share one entry.
+ *
+ * At most 'limit' entries are retained.  The least recently used is forgotten first.
+ * Keys are never re-used, as some peers will not replace an entry already in their cache.
+ * So once all keys are assigned, new types are sent in full.
+ */
+struct PVXS_API TypeCache {
+    explicit TypeCache(size_t limit=1024u) :limit(limit) {}
+
+    const size_t limit;
+    // types sent as a reference, and in full
+    size_t hits = 0u, misses = 0u;
+    // entries forgotten to stay within limit
+    size_t evictions = 0u;
+
+    inline size_t size() const { return entries.size(); }
+    // Approximate bytes held by entries
+    size_t approxBytes() const;
+
+private:
+    friend void to_wire(Buffer& buf, const FieldDesc* cur, TypeCache& cache);
+
+    struct Entry {
+        uint16_t key;
+        std::list<const std::string*>::iterator use;
+    };
+    // encoded type -> Entry
+    std::unordered_map<std::string, Entry> entries;
+    // keys of entries, most recently used first
+    std::list<const std::string*> lru;
+    uint32_t nextKey = 0u;
+    std::vector<uint8_t> scratch;
+};
+
 PVXS_API
 void from_wire(Buffer& buf, std::vector<FieldDesc>& descs, TypeStore& cache, unsigned depth=0);
 
 struct StructTop;
 
+/** Copy-on-write storage of a String field.
+ *
+ * Copies, as made by Value::clone() and Value::assign(), share one immutable std::string.
+ * The first modification of a shared string makes a private copy.
+ * Avoids re-allocating strings which are rarely changed. eg. display.units
+ */
+struct CowString {
+    CowString() = default;
+    explicit CowString(const std::string& s) :_ptr(s.empty() ? nullptr : std::make_shared<std::string>(s)) {}
+
+    inline const std::string& str() const { return _ptr ? *_ptr : empty(); }
+    inline operator const std::string&() const { return str(); }
+    inline bool shared() const { return _ptr && _ptr.use_count()>1; }
+
+    //! String which may be modified in place.  Copied if shared.
+    std::string& mut() {
+        if(!_ptr)
+            _ptr = std::make_shared<std::string>();
+        else if(_ptr.use_count()>1)
+            _ptr = std::make_shared<std::string>(*_ptr);
+        return *_ptr;
+    }
+
+    CowString& operator=(const std::string& s) {
+        if(_ptr && _ptr.use_count()==1)
+            *_ptr = s; // re-use existing allocation
+        else
+            _ptr = s.empty() ? nullptr : std::make_shared<std::string>(s);
+        return *this;
+    }
+    CowString& operator=(std::string&& s) {
+        if(_ptr && _ptr.use_count()==1)
+            *_ptr = std::move(s);
+        else
+            _ptr = s.empty() ? nullptr : std::make_shared<std::string>(std::move(s));
+        return *this;
+    }
+
+    void clear() {
+        if(_ptr && _ptr.use_count()==1)
+            _ptr->clear();
+        else
+            _ptr.reset();
+    }
+
+private:
+    // only modified while use_count()==1
+    std::shared_ptr<std::string> _ptr;
+
+    static const std::string& empty() {
+        static const std::string e;
+        return e;
+    }
+};
+
 struct FieldStorage {
     /* Storage for field value.  depends on StoreType.
      *
@@ -101,13 +273,13 @@ struct FieldStorage {
      * Integers promoted to either int64_t or uint64_t.
      * Bool promoted to uint64_t
      * Reals promoted to double.
-     * String stored as std::string
+     * String stored as CowString
      * Compound (Struct, Union, Any) stored as Value
      */
     aligned_union<8,
                        double, // Real
                        uint64_t, // Bool, Integer
-                       std::string, // String
+                       CowString, // String
                        Value, // Union, Any
                        shared_array<const void> // array of POD, std::string, or std::shared_ptr<Value>
     >::type store;
@@ -139,16 +311,34 @@ struct StructTop {
     // type of first top level struct.  always !NULL.
     // Actually the first element of a vector<const FieldDesc>
     std::shared_ptr<const FieldDesc> desc;
+
+    // fixed size array of FieldStorage, which is not owned
+    struct Members {
+        FieldStorage* const _data;
+        const size_t _size;
+
+        Members(FieldStorage* data, size_t size) :_data(data), _size(size) {}
+        inline size_t size() const { return _size; }
+        inline       FieldStorage* data()       { return _data; }
+        inline const FieldStorage* data() const { return _data; }
+        inline       FieldStorage& operator[](size_t i)       { return _data[i]; }
+        inline const FieldStorage& operator[](size_t i) const { return _data[i]; }
+    };
     // our members (inclusive).  always size()>=1
-    std::vector<FieldStorage> members;
+    // Storage allocated in the same block as this StructTop.  cf. Value::Value()
+    Members members;
 
     // empty, or the field of a structure which encloses this.
     std::weak_ptr<FieldStorage> enclosing;
 
-    StructTop(const std::shared_ptr<const FieldDesc>& desc)
-        :desc(desc)
-        ,members(desc->size())
-    {}
+    // set by Value::freeze() while unique.  Members are never modified afterwards.
+    bool frozen = false;
+
+    // storage for desc->size() members, which are constructed and destroyed by StructTop
+    StructTop(const std::shared_ptr<const FieldDesc>& desc, FieldStorage* storage);
+    ~StructTop();
+    StructTop(const StructTop&) = delete;
+    StructTop& operator=(const StructTop&) = delete;
 
     INST_COUNTER(StructTop);
 };
@@ -156,13 +346,67 @@ struct StructTop {
 using Type = std::shared_ptr<const FieldDesc>;
 
 
+/* The types of variant union (Any) fields are sent in full,
+ * or through a TypeCache when one is given.  Only the latter
+ * encoding depends on the state of one connection.
+ */
+
 //! serialize all Value fields
 PVXS_API
-void to_wire_full(Buffer& buf, const Value& val);
+void to_wire_full(Buffer& buf, const Value& val, TypeCache* types=nullptr);
 
 //! serialize BitMask and marked valid Value fields
 PVXS_API
-void to_wire_valid(Buffer& buf, const Value& val, const BitMask* mask=nullptr);
+void to_wire_valid(Buffer& buf, const Value& val, const BitMask* mask=nullptr, TypeCache* types=nullptr);
+
+/** Flattened form of one Struct type, and optional field mask.
+ *
+ * Lists the fields allowed by the mask in wire order, and selects the encoding of each field once.
+ * Built once (eg. for each subscription), so that each update is encoded and decoded
+ * without walking, and switching on, the FieldDesc tree.
+ */
+struct PVXS_API WirePlan {
+    enum Kind : uint8_t {
+        Other, // through the general to_wire_field()/from_wire_field()
+        SubStruct,
+        Bool,
+        Int8, Int16, Int32, Int64,
+        UInt8, UInt16, UInt32, UInt64,
+        Float32, Float64,
+        String,
+    };
+    struct Op {
+        // offset in FieldDesc and FieldStorage arrays
+        uint32_t bit;
+        // FieldDesc::size().  Fields covered when this field is selected
+        uint32_t size;
+    };
+
+    // top Struct, or nullptr if empty
+    const FieldDesc* desc = nullptr;
+    // mask this plan was built with.  All set if none was given
+    BitMask mask;
+    // each field allowed by mask, in wire order
+    std::vector<Op> ops;
+    // encoding of each field, by offset
+    std::vector<Kind> kinds;
+    // type includes a variant union (Any), perhaps nested.
+    bool variant = false;
+
+    WirePlan() = default;
+    explicit WirePlan(const FieldDesc* desc, const BitMask* mask=nullptr);
+};
+
+//! serialize BitMask and marked valid Value fields.  Same result as to_wire_valid(buf, val, &plan.mask, types)
+PVXS_API
+void to_wire_valid(Buffer& buf, const Value& val, const WirePlan& plan, TypeCache* types=nullptr);
+
+/** Find a previously received FieldDesc tree identical to descs, or remember descs.
+ *
+ * Identical types shared this way may be compared by pointer.
+ */
+PVXS_API
+std::shared_ptr<const FieldDesc> internType(const std::shared_ptr<const std::vector<FieldDesc>>& descs);
 
 //! deserialize type description
 PVXS_API
@@ -173,8 +417,32 @@ PVXS_API
 void from_wire_full(Buffer& buf, TypeStore& ctxt, Value& val);
 
 //! deserialize BitMask and partial Value
+//! @param pool If not nullptr, large arrays are allocated through this ArrayPool
+PVXS_API
+void from_wire_valid(Buffer& buf, TypeStore& ctxt, Value& val, ArrayPool* pool=nullptr);
+
+//! deserialize BitMask and partial Value, using a WirePlan built for the type of val.
+PVXS_API
+void from_wire_valid(Buffer& buf, TypeStore& ctxt, Value& val, const WirePlan& plan, ArrayPool* pool=nullptr);
+
+//! Runs of changed array elements, as (start, count).  cf. diffArray()
+typedef std::vector<std::pair<size_t, size_t>> ArrayRuns;
+
+/** Find the runs of elements of cur which differ from prev.  cf. pvRequest record._options.delta
+ *
+ * Only for arrays of Bool, Integer, or Real, when prev and cur have the same type and length.
+ * @returns false if not applicable, or if the runs would not encode to less than half the size of cur.
+ */
+PVXS_API
+bool diffArray(ArrayRuns& runs, const shared_array<const void>& prev, const shared_array<const void>& cur);
+
+//! serialize runs of elements of cur.  Size of runs, then for each run a Size start and an array of elements.
+PVXS_API
+void to_wire_patch(Buffer& buf, const FieldDesc* desc, const shared_array<const void>& cur, const ArrayRuns& runs);
+
+//! deserialize runs of elements, and apply them to a copy of arr.
 PVXS_API
-void from_wire_valid(Buffer& buf, TypeStore& ctxt, Value& val);
+void from_wire_patch(Buffer& buf, const FieldDesc* desc, shared_array<const void>& arr);
 
 //! deserialize type description and full value (a la. pvRequest)
 PVXS_API
@@ -11,10 +11,18 @@
 #  include <mswsock.h>
 #endif
 
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+#include <chrono>
 #include <cstring>
 #include <system_error>
 #include <deque>
+#include <atomic>
 #include <algorithm>
+#include <cmath>
 
 #include <event2/event.h>
 #include <event2/thread.h>
@@ -40,6 +48,10 @@ typedef epicsGuard<epicsMutex> Guard;
 static constexpr
 size_t min_slice_size = 1024u;
 
+// EvInBuf makes a backing buffer of no more than this length entirely contiguous
+static constexpr
+size_t max_pullup_size = 16384u;
+
 namespace pvxs {namespace impl {
 
 DEFINE_LOGGER(logerr, "pvxs.loop");
@@ -109,12 +121,129 @@ struct ThreadEvent
 };
 
 namespace {
+uint64_t nowNS()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void storeMax(std::atomic<uint64_t>& max, uint64_t val)
+{
+    auto cur(max.load(std::memory_order_relaxed));
+    while(val > cur && !max.compare_exchange_weak(cur, val, std::memory_order_relaxed)) {}
+}
+
 struct evbaseRunning {
     INST_COUNTER(evbaseRunning);
 };
 DEFINE_INST_COUNTER(evbaseRunning);
 }
 
+/* Single level hashed timing wheel.  Each slot is a list of WheelTimer,
+ * which expire after 'rounds' more full turns.  The ticker only runs while some
+ * WheelTimer is pending.  Only accessed from the worker.
+ */
+struct TimerWheel {
+    static constexpr size_t nSlots = 256u;
+    static constexpr double tick = 0.25; // seconds
+
+    evevent ticker;
+    // list heads
+    std::unique_ptr<WheelLink[]> slots;
+    size_t cursor = 0u;
+    size_t npending = 0u;
+    bool ticking = false;
+
+    explicit TimerWheel(event_base* base)
+        :ticker(__FILE__, __LINE__,
+                event_new(base, -1, EV_TIMEOUT|EV_PERSIST, &expireS, this))
+        ,slots(new WheelLink[nSlots])
+    {
+        for(auto i : range(nSlots))
+            slots[i].prev = slots[i].next = &slots[i];
+    }
+
+    static
+    void append(WheelLink& head, WheelLink* node)
+    {
+        node->prev = head.prev;
+        node->next = &head;
+        head.prev->next = node;
+        head.prev = node;
+    }
+    static
+    void remove(WheelLink* node)
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = node->next = nullptr;
+    }
+
+    void add(WheelTimer* timer, double delay)
+    {
+        size_t nticks = delay > 0.0 ? size_t(std::ceil(delay/tick)) : 0u;
+        if(nticks==0u)
+            nticks = 1u;
+        if(ticking)
+            nticks++; // current tick is partly elapsed.  Never expire early.
+
+        timer->rounds = (nticks-1u)/nSlots;
+        append(slots[(cursor + nticks)%nSlots], timer);
+
+        if(npending++==0u && !ticking) {
+            timeval period(totv(tick));
+            if(event_add(ticker.get(), &period))
+                log_err_printf(logtimer, "Unable to start timer wheel %p\n", this);
+            else
+                ticking = true;
+        }
+    }
+
+    void del(WheelTimer* timer)
+    {
+        remove(timer);
+        if(--npending==0u && ticking) {
+            (void)event_del(ticker.get());
+            ticking = false;
+        }
+    }
+
+    void expire()
+    {
+        cursor = (cursor+1u)%nSlots;
+
+        // detach those due, which may then be cancel()'d or start()'d by any callback.
+        WheelLink due;
+        due.prev = due.next = &due;
+        auto& head = slots[cursor];
+        for(auto node = head.next; node!=&head;) {
+            auto timer = static_cast<WheelTimer*>(node);
+            node = node->next;
+            if(timer->rounds) {
+                timer->rounds--;
+            } else {
+                remove(timer);
+                append(due, timer);
+            }
+        }
+
+        while(due.next!=&due) {
+            auto timer = static_cast<WheelTimer*>(due.next);
+            del(timer);
+            try {
+                timer->cb(); // may destroy timer
+            }catch(std::exception& e){
+                log_exc_printf(logtimer, "Unhandled error in WheelTimer callback: %s\n", e.what());
+            }
+        }
+    }
+    static
+    void expireS(evutil_socket_t sock, short evt, void *raw)
+    {
+        static_cast<TimerWheel*>(raw)->expire();
+    }
+};
+
 struct evbase::Pvt final : public epicsThreadRunable
 {
     SockAttach attach;
@@ -123,30 +252,80 @@ struct evbase::Pvt final : public epicsThreadRunable
 
     struct Work {
         mfunction fn;
-        std::exception_ptr *result;
-        epicsEvent *notify;
+        std::exception_ptr *result = nullptr;
+        epicsEvent *notify = nullptr;
+        uint64_t queued = 0u; // cf. nowNS()
+        Work() = default;
         Work(mfunction&& fn, std::exception_ptr *result, epicsEvent *notify)
-            :fn(std::move(fn)), result(result), notify(notify)
+            :fn(std::move(fn)), result(result), notify(notify), queued(nowNS())
         {}
     };
-    std::deque<Work> actions;
+
+    /* Work queued from any thread to the worker.  A bounded multi-producer, single consumer ring
+     * (cf. D. Vyukov's bounded MPMC queue).  Queueing takes one atomic compare-and-swap,
+     * and functors of mfunction are usually stored inline, so no allocation.
+     * When the ring is full, Work is appended to 'overflow' under lock.  Once 'overflowing',
+     * all Work goes to 'overflow' until the worker has emptied the ring, to preserve ordering.
+     */
+    struct Slot {
+        std::atomic<size_t> seq{0u};
+        Work work;
+    };
+    static constexpr size_t nSlots = 512u;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<size_t> enqPos{0u};
+    size_t deqPos = 0u; // only accessed by worker
+    std::atomic<bool> overflowing{false};
+    std::deque<Work> overflow; // guarded by lock
+    // Work taken from overflow, but not yet run.  'overflowing' remains set until empty.
+    std::deque<Work> backlog; // only accessed by worker
+    // max. time (seconds) doWork() spends running Work before allowing other events
+    static constexpr double workBudget = 0.002;
+    // dowork event is scheduled
+    std::atomic<bool> wakePending{false};
+
+    /* Health counters.  cf. evbase::stats()
+     * Updated by the worker, read (and maybe zeroed) from any thread.
+     * Times in nanoseconds.
+     */
+    std::atomic<size_t> statWork{0u};
+    std::atomic<uint64_t> statBusy{0u};
+    // Work queued, but not yet run
+    std::atomic<size_t> statQueued{0u};
+    std::atomic<uint64_t> statMaxQueued{0u};
+    std::atomic<uint64_t> statMaxLatency{0u};
+    std::atomic<uint64_t> statMaxLag{0u};
+    std::atomic<uint64_t> statSince{nowNS()};
+    // period of lag probe timer
+    static constexpr uint64_t probePeriod = 1000000000u;
+    // next expected expiration of probe.  only accessed by worker
+    uint64_t probeExpect = 0u;
 
     owned_ptr<event_base> base;
     evevent keepalive;
     evevent dowork;
+    evevent probe;
+    std::unique_ptr<TimerWheel> wheel;
     epicsEvent start_sync;
     epicsMutex lock;
 
     epicsThread worker;
-    bool running = true;
+    std::atomic<bool> running{true};
+    // CPU affinity of worker.  empty for any
+    const std::vector<unsigned> cpus;
 
     INST_COUNTER(evbase);
 
-    Pvt(const std::string& name, unsigned prio)
-        :worker(*this, name.c_str(),
+    Pvt(const std::string& name, unsigned prio, const std::vector<unsigned>& cpus)
+        :slots(new Slot[nSlots])
+        ,worker(*this, name.c_str(),
                 epicsThreadGetStackSize(epicsThreadStackBig),
                 prio)
+        ,cpus(cpus)
     {
+        for(size_t i=0u; i<nSlots; i++)
+            slots[i].seq.store(i, std::memory_order_relaxed);
+
         threadOnce(&evthread_once, &evthread_init, nullptr);
 
         worker.start();
@@ -162,7 +341,7 @@ struct evbase::Pvt final : public epicsThreadRunable
     {
         {
             Guard G(lock);
-            running = false;
+            running.store(false);
         }
         if(worker.isCurrentThread())
             log_crit_printf(logerr, "evbase self-joining: %s\n", worker.getNameSelf());
@@ -171,9 +350,30 @@ struct evbase::Pvt final : public epicsThreadRunable
         worker.exitWait();
     }
 
+    // from worker
+    void applyAffinity()
+    {
+        if(cpus.empty())
+            return;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(auto cpu : cpus) {
+            if(cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &set);
+        }
+        if(int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+            log_warn_printf(logerr, "Unable to set CPU affinity of %s : %s\n",
+                            worker.getNameSelf(), strerror(err));
+#else
+        log_warn_printf(logerr, "CPU affinity not supported for %s\n", worker.getNameSelf());
+#endif
+    }
+
     virtual void run() override final
     {
         evbaseRunning track;
+        applyAffinity();
         try {
             evconfig conf(__FILE__, __LINE__, event_config_new());
 #ifdef __rtems__
@@ -183,6 +383,14 @@ struct evbase::Pvt final : public epicsThreadRunable
              * poll() seems to work though.
              */
             event_config_avoid_method(conf.get(), "kqueue");
+#endif
+#ifdef __linux__
+            /* Defer epoll_ctl() changes until the next loop iteration, and then coalesce them.
+             * eg. bufferevent enabling and disabling EV_WRITE while a connection is busy
+             * costs at most one syscall per iteration.  This is unsafe with dup()'d sockets,
+             * which we do not use.
+             */
+            (void)event_config_set_flag(conf.get(), EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST);
 #endif
             decltype (base) tbase(__FILE__, __LINE__, event_base_new_with_config(conf.get()));
             if(evthread_make_base_notifiable(tbase.get())) {
@@ -193,15 +401,25 @@ struct evbase::Pvt final : public epicsThreadRunable
                            event_new(tbase.get(), -1, EV_TIMEOUT, &doWorkS, this));
             evevent ka(__FILE__, __LINE__,
                        event_new(tbase.get(), -1, EV_TIMEOUT|EV_PERSIST, &evkeepalive, this));
+            evevent pr(__FILE__, __LINE__,
+                       event_new(tbase.get(), -1, EV_TIMEOUT|EV_PERSIST, &evprobe, this));
+            std::unique_ptr<TimerWheel> wh(new TimerWheel(tbase.get()));
 
             base = std::move(tbase);
             dowork = std::move(handle);
             keepalive = std::move(ka);
+            probe = std::move(pr);
+            wheel = std::move(wh);
 
             timeval tick{1000,0};
             if(event_add(keepalive.get(), &tick))
                 throw std::runtime_error("Can't start keepalive timer");
 
+            timeval period{probePeriod/1000000000u, 0};
+            probeExpect = nowNS() + probePeriod;
+            if(event_add(probe.get(), &period))
+                throw std::runtime_error("Can't start probe timer");
+
             start_sync.signal();
 
             log_info_printf(logerr, "Enter loop worker for %p using %s\n", base.get(), event_base_get_method(base.get()));
@@ -218,29 +436,135 @@ struct evbase::Pvt final : public epicsThreadRunable
         }
     }
 
-    void doWork()
+    // from any thread.  Move from work and return true if queued.  Return false if full.
+    bool push(Work& work)
     {
-        decltype (actions) todo;
-        {
+        auto pos = enqPos.load(std::memory_order_relaxed);
+        while(true) {
+            auto& slot = slots[pos % nSlots];
+            auto seq = slot.seq.load(std::memory_order_acquire);
+            auto dif = intptr_t(seq) - intptr_t(pos);
+
+            if(dif==0) {
+                if(enqPos.compare_exchange_weak(pos, pos+1u, std::memory_order_relaxed)) {
+                    slot.work = std::move(work);
+                    slot.seq.store(pos+1u, std::memory_order_release);
+                    return true;
+                }
+            } else if(dif<0) {
+                return false;
+            } else {
+                pos = enqPos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // from worker.  Returns false if empty, or the next Work is not yet completely queued.
+    bool pop(Work& work)
+    {
+        auto& slot = slots[deqPos % nSlots];
+        auto seq = slot.seq.load(std::memory_order_acquire);
+        if(intptr_t(seq) - intptr_t(deqPos+1u) < 0)
+            return false;
+
+        work = std::move(slot.work);
+        slot.seq.store(deqPos + nSlots, std::memory_order_release);
+        deqPos++;
+        return true;
+    }
+
+    bool post(mfunction&& fn, std::exception_ptr *result, epicsEvent *notify, bool dothrow)
+    {
+        if(!running.load()) {
+            if(dothrow)
+                throw std::logic_error("Worker stopped");
+            return false;
+        }
+
+        Work work(std::move(fn), result, notify);
+
+        storeMax(statMaxQueued, 1u + statQueued.fetch_add(1u, std::memory_order_relaxed));
+
+        if(overflowing.load(std::memory_order_acquire) || !push(work)) {
             Guard G(lock);
-            todo = std::move(actions);
+            overflow.push_back(std::move(work));
+            overflowing.store(true, std::memory_order_release);
         }
-        for(auto& work : todo) {
-            try {
-                auto fn(std::move(work.fn));
-                fn();
-            }catch(std::exception& e){
-                if(work.result) {
-                    Guard G(lock);
-                    *work.result = std::current_exception();
-                } else {
-                    log_exc_printf(logerr, "Unhandled exception in event_base : %s : %s\n",
-                                    typeid(e).name(), e.what());
-                }
+
+        wakeup();
+        return true;
+    }
+
+    void wakeup()
+    {
+        if(!wakePending.exchange(true)) {
+            timeval now{};
+            if(event_add(dowork.get(), &now))
+                throw std::runtime_error("Unable to wakeup dispatch()");
+        }
+    }
+
+    void run(Work& work)
+    {
+        auto begin(nowNS());
+        statQueued.fetch_sub(1u, std::memory_order_relaxed);
+        storeMax(statMaxLatency, begin - work.queued);
+        try {
+            auto fn(std::move(work.fn));
+            fn();
+        }catch(std::exception& e){
+            if(work.result) {
+                Guard G(lock);
+                *work.result = std::current_exception();
+            } else {
+                log_exc_printf(logerr, "Unhandled exception in event_base : %s : %s\n",
+                                typeid(e).name(), e.what());
+            }
+        }
+        if(work.notify)
+            work.notify->signal();
+        statWork.fetch_add(1u, std::memory_order_relaxed);
+        statBusy.fetch_add(nowNS() - begin, std::memory_order_relaxed);
+    }
+
+    void doWork()
+    {
+        // Work queued after this point will either be seen below, or will wakeup() again.
+        (void)wakePending.exchange(false);
+
+        const auto start(epicsTime::getMonotonic());
+        size_t n=0u;
+
+        Work work;
+        while(true) {
+            if(pop(work)) {
+                // ring is always older than backlog
+            } else if(!backlog.empty()) {
+                work = std::move(backlog.front());
+                backlog.pop_front();
+            } else if(overflowing.load(std::memory_order_acquire)) {
+                Guard G(lock);
+                // only once the ring is empty is Work in overflow next.
+                // checked under lock as a producer may fill ring, then overflow.
+                if(enqPos.load(std::memory_order_acquire)!=deqPos)
+                    break; // a push to the ring is still completing.  retry after other events.
+                backlog.swap(overflow);
+                if(backlog.empty())
+                    overflowing.store(false, std::memory_order_release);
+                continue;
+            } else {
+                break; // idle
             }
-            if(work.notify)
-                work.notify->signal();
+
+            run(work);
+
+            // give I/O events a turn once our time budget is spent
+            if(++n%16u==0u && epicsTime::getMonotonic()-start >= workBudget)
+                break;
         }
+
+        if(!backlog.empty() || overflowing.load(std::memory_order_acquire) || enqPos.load(std::memory_order_acquire)!=deqPos)
+            wakeup(); // more to do
     }
     static
     void doWorkS(evutil_socket_t sock, short evt, void *raw)
@@ -260,12 +584,23 @@ struct evbase::Pvt final : public epicsThreadRunable
         log_debug_printf(logerr, "Look keepalive %p\n", self);
     }
 
+    // a periodic timer which expires late when some callback blocks the loop
+    static
+    void evprobe(evutil_socket_t sock, short evt, void *raw)
+    {
+        auto self = static_cast<Pvt*>(raw);
+        auto now(nowNS());
+        if(now > self->probeExpect)
+            storeMax(self->statMaxLag, now - self->probeExpect);
+        self->probeExpect = now + probePeriod;
+    }
+
 };
 DEFINE_INST_COUNTER2(evbase::Pvt, evbase);
 
-evbase::evbase(const std::string &name, unsigned prio)
+evbase::evbase(const std::string &name, unsigned prio, const std::vector<unsigned>& cpus)
 {
-    auto internal(std::make_shared<Pvt>(name, prio));
+    auto internal(std::make_shared<Pvt>(name, prio, cpus));
     internal->internal_self = internal;
 
     pvt.reset(internal.get(), [internal](Pvt*) mutable {
@@ -278,6 +613,31 @@ evbase::evbase(const std::string &name, unsigned prio)
 
 evbase::~evbase() {}
 
+WheelTimer::WheelTimer(const evbase& loop, std::function<void()>&& cb)
+    :loop(loop.internal())
+    ,wheel(loop.pvt->wheel.get())
+    ,cb(std::move(cb))
+{}
+
+WheelTimer::~WheelTimer()
+{
+    cancel();
+}
+
+void WheelTimer::start(double delay)
+{
+    cancel();
+    wheel->add(this, delay);
+}
+
+bool WheelTimer::cancel()
+{
+    bool ret = pending();
+    if(ret)
+        wheel->del(this);
+    return ret;
+}
+
 evbase evbase::internal() const
 {
     evbase ret;
@@ -298,23 +658,7 @@ void evbase::sync() const
 
 bool evbase::_dispatch(mfunction&& fn, bool dothrow) const
 {
-    bool empty;
-    {
-        Guard G(pvt->lock);
-        if(!pvt->running) {
-            if(dothrow)
-                throw std::logic_error("Worker stopped");
-            return false;
-        }
-        empty = pvt->actions.empty();
-        pvt->actions.emplace_back(std::move(fn), nullptr, nullptr);
-    }
-
-    timeval now{};
-    if(empty && event_add(pvt->dowork.get(), &now))
-        throw std::runtime_error("Unable to wakeup dispatch()");
-
-    return true;
+    return pvt->post(std::move(fn), nullptr, nullptr, dothrow);
 }
 
 bool evbase::_call(mfunction&& fn, bool dothrow) const
@@ -327,21 +671,8 @@ bool evbase::_call(mfunction&& fn, bool dothrow) const
     static ThreadEvent done;
 
     std::exception_ptr result;
-    bool empty;
-    {
-        Guard G(pvt->lock);
-        if(!pvt->running) {
-            if(dothrow)
-                throw std::logic_error("Worker stopped");
-            return false;
-        }
-        empty = pvt->actions.empty();
-        pvt->actions.emplace_back(std::move(fn), &result, done.get());
-    }
-
-    timeval now{};
-    if(empty && event_add(pvt->dowork.get(), &now))
-        throw std::runtime_error("Unable to wakeup call()");
+    if(!pvt->post(std::move(fn), &result, done.get(), dothrow))
+        return false;
 
     done->wait();
     Guard G(pvt->lock);
@@ -365,8 +696,7 @@ bool evbase::assertInRunningLoop() const
     if(pvt->worker.isCurrentThread())
         return true;
 
-    Guard G(pvt->lock);
-    if(!pvt->running)
+    if(!pvt->running.load())
         return false;
 
     char name[32];
@@ -376,6 +706,33 @@ bool evbase::assertInRunningLoop() const
     throw std::logic_error("Not in running evbase worker");
 }
 
+evbase::Stats evbase::stats(bool zero) const
+{
+    Stats ret;
+    char name[32];
+    pvt->worker.getName(name, sizeof(name));
+    ret.name = name;
+
+    auto now(nowNS());
+    ret.queued = pvt->statQueued.load(std::memory_order_relaxed);
+    if(zero) {
+        ret.nWork = pvt->statWork.exchange(0u, std::memory_order_relaxed);
+        ret.busy = pvt->statBusy.exchange(0u, std::memory_order_relaxed)*1e-9;
+        ret.maxQueued = pvt->statMaxQueued.exchange(ret.queued, std::memory_order_relaxed);
+        ret.maxDispatchLatency = pvt->statMaxLatency.exchange(0u, std::memory_order_relaxed)*1e-9;
+        ret.maxLag = pvt->statMaxLag.exchange(0u, std::memory_order_relaxed)*1e-9;
+        ret.interval = (now - pvt->statSince.exchange(now, std::memory_order_relaxed))*1e-9;
+    } else {
+        ret.nWork = pvt->statWork.load(std::memory_order_relaxed);
+        ret.busy = pvt->statBusy.load(std::memory_order_relaxed)*1e-9;
+        ret.maxQueued = pvt->statMaxQueued.load(std::memory_order_relaxed);
+        ret.maxDispatchLatency = pvt->statMaxLatency.load(std::memory_order_relaxed)*1e-9;
+        ret.maxLag = pvt->statMaxLag.load(std::memory_order_relaxed)*1e-9;
+        ret.interval = (now - pvt->statSince.load(std::memory_order_relaxed))*1e-9;
+    }
+    return ret;
+}
+
 bool evsocket::canIPv6;
 evsocket::ipstack_t evsocket::ipstack;
 
@@ -658,6 +1015,67 @@ size_t evsocket::get_buffer_size(evutil_socket_t sock, bool tx)
     return ret;
 }
 
+void evsocket::set_tcp_options(evutil_socket_t sock,
+                               unsigned sndbuf, unsigned rcvbuf,
+                               bool nodelay,
+                               unsigned busyPoll, unsigned notSentLowat,
+                               double keepAlive)
+{
+    auto setopt = [sock](int level, int opt, const char* optname, unsigned uval) {
+        int val = int(uval);
+        if(setsockopt(sock, level, opt, (char*)&val, sizeof(val)))
+            log_warn_printf(logerr, "Unable to set %s=%u : %s\n", optname, uval,
+                            evutil_socket_error_to_string(evutil_socket_geterror(sock)));
+    };
+
+    if(sndbuf)
+        setopt(SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF", sndbuf);
+    if(rcvbuf)
+        setopt(SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF", rcvbuf);
+    if(nodelay)
+        setopt(IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY", 1u);
+
+    if(busyPoll) {
+#ifdef SO_BUSY_POLL
+        setopt(SOL_SOCKET, SO_BUSY_POLL, "SO_BUSY_POLL", busyPoll);
+#else
+        log_debug_printf(logsock, "SO_BUSY_POLL not supported by this target%s", "\n");
+#endif
+    }
+
+    if(notSentLowat) {
+#ifdef TCP_NOTSENT_LOWAT
+        setopt(IPPROTO_TCP, TCP_NOTSENT_LOWAT, "TCP_NOTSENT_LOWAT", notSentLowat);
+#else
+        log_debug_printf(logsock, "TCP_NOTSENT_LOWAT not supported by this target%s", "\n");
+#endif
+    }
+
+    if(keepAlive>0.0) {
+        setopt(SOL_SOCKET, SO_KEEPALIVE, "SO_KEEPALIVE", 1u);
+        // first probe after half of keepAlive idle, then 4 probes over the remainder.
+        // eg. tcpTimeout(40) -> idle 20, interval 5, count 4
+        unsigned idle = unsigned(std::max(1.0, std::ceil(keepAlive/2.0)));
+        unsigned intvl = unsigned(std::max(1.0, std::ceil(keepAlive/8.0)));
+        (void)idle;
+        (void)intvl;
+#if defined(TCP_KEEPIDLE)
+        setopt(IPPROTO_TCP, TCP_KEEPIDLE, "TCP_KEEPIDLE", idle);
+#elif defined(TCP_KEEPALIVE)
+        // OSX spelling
+        setopt(IPPROTO_TCP, TCP_KEEPALIVE, "TCP_KEEPALIVE", idle);
+#else
+        log_debug_printf(logsock, "TCP_KEEPIDLE not supported by this target%s", "\n");
+#endif
+#ifdef TCP_KEEPINTVL
+        setopt(IPPROTO_TCP, TCP_KEEPINTVL, "TCP_KEEPINTVL", intvl);
+#endif
+#ifdef TCP_KEEPCNT
+        setopt(IPPROTO_TCP, TCP_KEEPCNT, "TCP_KEEPCNT", 4u);
+#endif
+    }
+}
+
 #if defined(_WIN32) && !defined(EAFNOSUPPORT)
 #  define EAFNOSUPPORT WSAESOCKTNOSUPPORT
 #endif
@@ -727,6 +1145,25 @@ IfaceMap::IfaceMap()
     refresh();
 }
 
+static
+bool sameIfaces(const std::map<uint64_t, IfaceMap::Iface>& lhs,
+                const std::map<uint64_t, IfaceMap::Iface>& rhs)
+{
+    if(lhs.size()!=rhs.size())
+        return false;
+    for(auto L(lhs.begin()), R(rhs.begin()); L!=lhs.end(); ++L, ++R) {
+        const auto& LI = L->second;
+        const auto& RI = R->second;
+        if(L->first!=R->first || LI.name!=RI.name || LI.isLO!=RI.isLO || LI.addrs.size()!=RI.addrs.size())
+            return false;
+        for(auto LA(LI.addrs.begin()), RA(RI.addrs.begin()); LA!=LI.addrs.end(); ++LA, ++RA) {
+            if(LA->first.compare(RA->first, false) || LA->second.compare(RA->second, false))
+                return false;
+        }
+    }
+    return true;
+}
+
 void IfaceMap::refresh(bool force)
 {
     auto now(epicsTime::getMonotonic());
@@ -736,6 +1173,11 @@ void IfaceMap::refresh(bool force)
         return;
     log_debug_printf(logiface, "refresh%s after %.1f sec\n", force?" forced":"", age);
     auto temp = _refresh();
+    if(!sameIfaces(byIndex, temp)) {
+        log_debug_printf(logiface, "%s\n", "interfaces changed");
+        changes++;
+        bcasts.clear();
+    }
     // cross-index
     decltype (byName) tempN;
     decltype (byAddr) tempA;
@@ -870,6 +1312,7 @@ SockAddr IfaceMap::address_of(const std::string& name)
         auto it(byName.find(name));
         if(it!=byName.end() && !it->second->addrs.empty()) {
             ret = it->second->addrs.begin()->first;
+            return true;
         }
         return false;
     });
@@ -887,6 +1330,26 @@ std::set<std::string> IfaceMap::all_external()
     return ret;
 }
 
+std::vector<SockAddr> IfaceMap::broadcasts(const SockAddr* match)
+{
+    auto key(match ? *match : SockAddr::any(AF_INET));
+    Guard G(lock);
+    refresh(true);
+    auto it(bcasts.find(key));
+    if(it==bcasts.end()) {
+        evsocket dummy(AF_INET, SOCK_DGRAM, 0);
+        it = bcasts.emplace(key, dummy.broadcasts(match)).first;
+    }
+    return it->second;
+}
+
+uint64_t IfaceMap::version()
+{
+    Guard G(lock);
+    refresh(true);
+    return changes;
+}
+
 
 void to_wire(Buffer& buf, const SockAddr& val)
 {
@@ -940,6 +1403,10 @@ void from_wire(Buffer &buf, SockAddr& val)
 
 bool Buffer::refill(size_t more) { return false; }
 
+bool Buffer::appendRef(const void* mem, size_t nbytes, const std::shared_ptr<const void>& hold) { return false; }
+
+bool Buffer::encodeAside(size_t nbytes, std::function<void(Buffer&)>&& fn) { return false; }
+
 FixedBuf::~FixedBuf() {}
 
 VectorOutBuf::~VectorOutBuf() {}
@@ -962,7 +1429,101 @@ bool VectorOutBuf::refill(size_t more) {
     return true;
 }
 
-EvOutBuf::~EvOutBuf() { refill(0); }
+// one array encoded by EvOutBuf::encodeAside(), and the bytes which follow it
+struct EvOutBuf::Aside {
+    const bool be;
+    const size_t nbytes;
+    std::function<void(Buffer&)> fn;
+    evbuf out;
+    // encoding continues here, until the next Aside
+    evbuf tail;
+    // run() by the first to claim(), either a helper thread or the owning EvOutBuf
+    std::atomic<bool> claimed{false};
+    epicsEvent done;
+    bool ok = false;
+
+    Aside(bool be, size_t nbytes, std::function<void(Buffer&)>&& fn)
+        :be(be)
+        ,nbytes(nbytes)
+        ,fn(std::move(fn))
+        ,out(__FILE__, __LINE__, evbuffer_new())
+        ,tail(__FILE__, __LINE__, evbuffer_new())
+    {}
+
+    bool claim() { return !claimed.exchange(true); }
+
+    void run() {
+        try {
+            EvOutBuf A(be, out.get(), nbytes);
+            fn(A);
+            ok = A.good();
+        } catch(std::exception& e) {
+            log_exc_printf(logerr, "Unhandled exception while encoding array: %s\n", e.what());
+        }
+        fn = nullptr; // release array
+        done.signal();
+    }
+};
+
+namespace {
+// helper threads for EvOutBuf::encodeAside()
+struct EncodeWorkers final : public epicsThreadRunable {
+    MPMCFIFO<std::shared_ptr<EvOutBuf::Aside>> queue;
+    std::vector<std::unique_ptr<epicsThread>> threads;
+
+    explicit EncodeWorkers(unsigned nworkers) {
+        threads.reserve(nworkers);
+        for(auto i : range(nworkers)) {
+            std::string name(SB()<<"PVXEnc"<<i);
+            threads.emplace_back(new epicsThread(*this, name.c_str(),
+                                                 epicsThreadGetStackSize(epicsThreadStackSmall),
+                                                 epicsThreadPriorityMedium));
+            threads.back()->start();
+        }
+    }
+    virtual ~EncodeWorkers() {}
+
+    virtual void run() override final {
+        // runs for the life of the process
+        while(auto job = queue.pop()) {
+            if(job->claim())
+                job->run();
+        }
+    }
+};
+
+// null if only one CPU
+EncodeWorkers* encodeWorkers;
+epicsThreadOnceId encodeOnce = EPICS_THREAD_ONCE_INIT;
+
+void encodeInit(void*)
+{
+    auto ncpu = epicsThreadGetCPUs();
+    if(ncpu > 1)
+        encodeWorkers = new EncodeWorkers(std::min(ncpu-1, 8));
+}
+} // namespace
+
+EvOutBuf::~EvOutBuf()
+{
+    refill(0);
+
+    for(auto& aside : asides) {
+        if(aside->claim()) {
+            // not started yet.  Do it ourselves rather than wait.
+            aside->run();
+        } else {
+            aside->done.wait();
+        }
+
+        if(!aside->ok) {
+            // the message will be incomplete, but not mis-ordered.
+            log_err_printf(logerr, "Unable to encode %zu byte array\n", aside->nbytes);
+        }
+        if(evbuffer_add_buffer(dest, aside->out.get()) || evbuffer_add_buffer(dest, aside->tail.get()))
+            log_crit_printf(logerr, "Unable to append %zu byte array\n", aside->nbytes);
+    }
+}
 
 bool EvOutBuf::refill(size_t more)
 {
@@ -989,6 +1550,46 @@ bool EvOutBuf::refill(size_t more)
     return true;
 }
 
+static
+void releaseRef(const void *data, size_t datalen, void *raw)
+{
+    delete static_cast<std::shared_ptr<const void>*>(raw);
+}
+
+bool EvOutBuf::appendRef(const void* mem, size_t nbytes, const std::shared_ptr<const void>& hold)
+{
+    // commit any partially filled reservation
+    if(!refill(0))
+        return false;
+
+    auto ref = new std::shared_ptr<const void>(hold);
+    if(evbuffer_add_reference(backing, mem, nbytes, &releaseRef, ref)) {
+        delete ref;
+        return false;
+    }
+    return true;
+}
+
+bool EvOutBuf::encodeAside(size_t nbytes, std::function<void(Buffer&)>&& fn)
+{
+    if(!parallel)
+        return false;
+
+    epicsThreadOnce(&encodeOnce, &encodeInit, nullptr);
+    if(!encodeWorkers)
+        return false;
+
+    // commit any partially filled reservation
+    if(!refill(0))
+        return false;
+
+    auto aside(std::make_shared<Aside>(be, nbytes, std::move(fn)));
+    backing = aside->tail.get();
+    asides.push_back(aside);
+    encodeWorkers->queue.push(std::move(aside));
+    return true;
+}
+
 EvInBuf::~EvInBuf() { refill(0); }
 
 bool EvInBuf::refill(size_t needed)
@@ -1003,9 +1604,11 @@ bool EvInBuf::refill(size_t needed)
 
     if(needed) {
         // expand request in an attempt to reduce the number of refill()s
-        // but limit to actual backing buffer length, or pullup() will error
-        size_t requesting = std::min(std::max(needed, size_t(min_slice_size)),
-                                     evbuffer_get_length(backing));
+        // but limit to actual backing buffer length, or pullup() will error.
+        // Pull up all of a small message, which is then decoded without another refill()
+        const size_t avail = evbuffer_get_length(backing);
+        size_t requesting = avail <= max_pullup_size ? avail
+                                                     : std::min(std::max(needed, size_t(min_slice_size)), avail);
 
 
         // ensure new segment contains at least the requested size (one element)
@@ -1043,7 +1646,7 @@ void to_evbuf(evbuffer *buf, const Header& H, bool be)
 
 } // namespace impl
 
-std::atomic<size_t> Timer::Pvt::cnt_Timer {0u};
+DEFINE_INST_COUNTER2(Timer::Pvt, Timer);
 
 Timer::~Timer() {}
 
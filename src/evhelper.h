@@ -13,6 +13,8 @@
 #include <string>
 #include <map>
 #include <set>
+#include <new>
+#include <type_traits>
 
 #include <event2/event.h>
 #include <event2/buffer.h>
@@ -52,6 +54,10 @@ template<>
 struct default_delete<evbuffer> {
     inline void operator()(evbuffer* ev) { evbuffer_free(ev); }
 };
+template<>
+struct default_delete<ev_token_bucket_cfg> {
+    inline void operator()(ev_token_bucket_cfg* ev) { ev_token_bucket_cfg_free(ev); }
+};
 }
 
 namespace pvxs {namespace impl {
@@ -94,6 +100,8 @@ struct PVXS_API VFunctor0 {
     VFunctor0& operator=(const VFunctor0&) = delete;
     virtual ~VFunctor0() =0;
     virtual void invoke() =0;
+    // move construct into storage of an mfunction
+    virtual VFunctor0* moveTo(void* mem) =0;
 };
 template<typename Fn>
 struct Functor0 final : public VFunctor0 {
@@ -102,30 +110,80 @@ struct Functor0 final : public VFunctor0 {
     virtual ~Functor0() {}
 
     void invoke() override final { fn(); }
+    VFunctor0* moveTo(void* mem) override final { return new(mem) Functor0(std::move(fn)); }
 private:
     Fn fn;
 };
 } // namespace detail
 
+/* Small functors (eg. a lambda capturing a few pointers)
+ * are stored inline, so that queueing work need not allocate.
+ */
 struct mfunction {
     mfunction() = default;
-    template<typename Fn>
+    template<typename Fn, typename = typename std::enable_if<!std::is_same<typename std::decay<Fn>::type, mfunction>::value>::type>
     mfunction(Fn&& fn)
-        :fn{new mdetail::Functor0<Fn>(std::move(fn))}
-    {}
+    {
+        typedef typename std::decay<Fn>::type T;
+        typedef mdetail::Functor0<T> F;
+        emplace(T(std::forward<Fn>(fn)),
+                std::integral_constant<bool, sizeof(F) <= sizeof(store_t)
+                                             && alignof(F) <= alignof(store_t)
+                                             && std::is_nothrow_move_constructible<T>::value>{});
+    }
+    mfunction(mfunction&& o) noexcept { take(o); }
+    mfunction& operator=(mfunction&& o) noexcept {
+        if(this!=&o) {
+            clear();
+            take(o);
+        }
+        return *this;
+    }
+    mfunction(const mfunction&) = delete;
+    mfunction& operator=(const mfunction&) = delete;
+    ~mfunction() { clear(); }
+
     void operator()() const {
         fn->invoke();
     }
     explicit operator bool() const {
-        return fn.operator bool();
+        return fn;
     }
 private:
-    std::unique_ptr<mdetail::VFunctor0> fn;
+    typedef typename std::aligned_storage<6u*sizeof(void*)>::type store_t;
+    store_t store;
+    mdetail::VFunctor0* fn = nullptr;
+
+    template<typename T>
+    void emplace(T&& fn, std::true_type) { this->fn = new(&store) mdetail::Functor0<T>(std::move(fn)); }
+    template<typename T>
+    void emplace(T&& fn, std::false_type) { this->fn = new mdetail::Functor0<T>(std::move(fn)); }
+
+    bool isInline() const { return (const void*)fn == (const void*)&store; }
+    void clear() {
+        if(isInline())
+            fn->~VFunctor0();
+        else
+            delete fn;
+        fn = nullptr;
+    }
+    void take(mfunction& o) {
+        if(o.isInline()) {
+            fn = o.fn->moveTo(&store);
+            o.clear();
+        } else {
+            fn = o.fn;
+            o.fn = nullptr;
+        }
+    }
 };
 
 struct PVXS_API evbase {
     evbase() = default;
-    explicit evbase(const std::string& name, unsigned prio=0);
+    //! @param prio EPICS thread priority of worker
+    //! @param cpus If not empty, restrict worker to these CPU numbers.  cf. parseCPUList()
+    explicit evbase(const std::string& name, unsigned prio=0,
+                    const std::vector<unsigned>& cpus=std::vector<unsigned>());
     ~evbase();
 
     evbase internal() const;
@@ -171,20 +229,94 @@ public:
     //! @returns true if working is running.
     bool assertInRunningLoop() const;
 
+    //! Health of the worker.  cf. Report::Worker
+    struct Stats {
+        std::string name;
+        size_t nWork = 0u;
+        double busy = 0.0;
+        size_t queued = 0u, maxQueued = 0u;
+        double maxDispatchLatency = 0.0;
+        double maxLag = 0.0;
+        double interval = 0.0;
+    };
+    //! Snapshot of worker health.  If zero, then restart accumulation.  May be called from any thread.
+    Stats stats(bool zero) const;
+
     inline void reset() { pvt.reset(); }
 
 private:
+    friend struct WheelTimer;
     struct Pvt;
     std::shared_ptr<Pvt> pvt;
 public:
     event_base* base = nullptr;
 };
 
+//! Start an event loop worker for TCP connections
+//! placed according to tcpWorkerPriority and tcpWorkerCPUs of a server or client Config.
+//! With several CPU groups, worker number 'index' is placed in group index%ngroups.
+template<typename Conf>
+evbase tcpWorkerLoop(const std::string& name, unsigned defprio, const Conf& conf, size_t index=0u)
+{
+    std::vector<unsigned> cpus;
+    try {
+        auto groups(parseCPUGroups(conf.tcpWorkerCPUs));
+        if(!groups.empty())
+            cpus = std::move(groups[index % groups.size()]);
+    } catch(std::exception&) {
+        // ignored.  Config::expand() will complain
+    }
+    unsigned prio = conf.tcpWorkerPriority ? conf.tcpWorkerPriority : defprio;
+    if(prio > epicsThreadPriorityMax)
+        prio = epicsThreadPriorityMax;
+    return evbase(name, prio, cpus);
+}
+
 typedef owned_ptr<event_config> evconfig;
 typedef owned_ptr<event> evevent;
 typedef owned_ptr<evconnlistener> evlisten;
 typedef owned_ptr<bufferevent> evbufferevent;
 typedef owned_ptr<evbuffer> evbuf;
+typedef owned_ptr<ev_token_bucket_cfg> evratelimit;
+
+struct WheelLink {
+    WheelLink *prev = nullptr, *next = nullptr;
+};
+
+struct TimerWheel;
+
+/** One-shot timer on the timer wheel shared by all WheelTimer of an evbase worker.
+ *
+ * For the numerous, and frequently restarted, PVXS internal timers (eg. echo and holdoff)
+ * which need only coarse resolution.  Expiration may be up to one wheel tick (0.25 sec.) late.
+ * Starting or cancelling is O(1), and does not touch the libevent timer heap,
+ * which remains for precise deadlines.
+ *
+ * All methods, and destruction, must be called from the worker, or after the worker has stopped.
+ *
+ * @since 1.3.0
+ */
+struct PVXS_API WheelTimer : private WheelLink {
+    WheelTimer(const evbase& loop, std::function<void()>&& cb);
+    ~WheelTimer();
+    WheelTimer(const WheelTimer&) = delete;
+    WheelTimer& operator=(const WheelTimer&) = delete;
+
+    //! (re)start to expire once after delay seconds.  Replaces any previous start().
+    void start(double delay);
+    //! @returns true if was pending
+    bool cancel();
+    inline bool pending() const { return next; }
+
+private:
+    friend struct TimerWheel;
+    // keeps wheel alive.  cf. evbase::internal()
+    const evbase loop;
+    TimerWheel* const wheel;
+    const std::function<void()> cb;
+    // remaining full turns of the wheel before expiration
+    size_t rounds = 0u;
+};
 
 PVXS_API
 void to_wire(Buffer& buf, const SockAddr& val);
@@ -252,6 +384,27 @@ struct PVXS_API evsocket
     static
     size_t get_buffer_size(evutil_socket_t sock, bool tx);
 
+    /** Apply optional TCP socket options.  Zero/false leaves the OS default.
+     *  keepAlive>0 enables SO_KEEPALIVE, with probing timed to detect a dead peer after about keepAlive seconds.
+     *  Failures are logged, but not fatal.
+     */
+    static
+    void set_tcp_options(evutil_socket_t sock,
+                         unsigned sndbuf, unsigned rcvbuf,
+                         bool nodelay,
+                         unsigned busyPoll, unsigned notSentLowat,
+                         double keepAlive=0.0);
+
+    //! Apply TCP socket options from a server::Config or client::Config
+    template<typename Conf>
+    static
+    void set_tcp_options(evutil_socket_t sock, const Conf& conf) {
+        set_tcp_options(sock, conf.tcpSendBuffer, conf.tcpRecvBuffer,
+                        conf.tcpNoDelay,
+                        conf.tcpBusyPoll, conf.tcpNotSentLowat,
+                        conf.tcpKeepAlive ? conf.tcpTimeout : 0.0);
+    }
+
     static
     bool canIPv6;
 
@@ -289,6 +442,10 @@ struct PVXS_API IfaceMap {
     SockAddr address_of(const std::string& name);
     // all interface names except LO
     std::set<std::string> all_external();
+    // cached evsocket::broadcasts() .  match==nullptr is treated as 0.0.0.0
+    std::vector<SockAddr> broadcasts(const SockAddr* match);
+    // incremented when refresh() finds that interfaces have changed
+    uint64_t version();
 
     // caller must hold lock
     void refresh(bool force=false);
@@ -308,7 +465,10 @@ struct PVXS_API IfaceMap {
     std::map<std::string, Iface*> byName;
     // map address to tuple of interface and broadcast?
     std::multimap<SockAddr, std::pair<Iface*, bool>, SockAddrOnlyLess> byAddr;
+    // match address -> broadcast addresses.  cleared on change
+    std::map<SockAddr, std::vector<SockAddr>, SockAddrOnlyLess> bcasts;
     epicsTime updated;
+    uint64_t changes = 0u;
 private:
     static
     decltype (byIndex) _refresh();
@@ -0,0 +1,419 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <string.h>
+
+#include <yajl_parse.h>
+
+#include <pvxs/json.h>
+#include "utilpvt.h"
+
+namespace pvxs {
+namespace json {
+
+namespace {
+
+// A Struct, Union, or array field being filled in
+struct Frame {
+    Value fld;
+    bool isArray = false;
+    // for Struct and Union.  member named by the most recent key
+    Value next;
+    // for arrays, elements accumulated by kind of fld
+    std::vector<bool> bools;
+    std::vector<int64_t> ints;
+    std::vector<uint64_t> uints;
+    std::vector<double> reals;
+    std::vector<std::string> strs;
+    std::vector<Value> vals;
+
+    Frame(const Value& fld, bool isArray) :fld(fld), isArray(isArray) {}
+};
+
+struct Parser {
+    Value root;
+    std::vector<Frame> stack;
+    bool done = false;
+    std::string err;
+
+    explicit Parser(const Value& root) :root(root) {}
+
+    // The field which the next JSON value will be assigned to.
+    // Not applicable when the top frame is an array.
+    Value& target() {
+        if(stack.empty()) {
+            if(done)
+                throw std::runtime_error("Trailing content");
+            return root;
+        }
+        auto& top = stack.back();
+        if(!top.next)
+            throw std::logic_error("JSON value without key");
+        return top.next;
+    }
+
+    // after a JSON value is assigned to target()
+    void consumed() {
+        if(stack.empty())
+            done = true;
+        else if(!stack.back().isArray)
+            stack.back().next = Value();
+    }
+
+    static
+    Value infer(const std::string& num) {
+        if(num.find_first_of(".eE")!=std::string::npos) {
+            auto ret(TypeDef(TypeCode::Float64).create());
+            ret = parseTo<double>(num);
+            return ret;
+        } else if(num[0]=='-') {
+            auto ret(TypeDef(TypeCode::Int64).create());
+            ret = parseTo<int64_t>(num);
+            return ret;
+        } else {
+            auto val(parseTo<uint64_t>(num));
+            Value ret;
+            if(val > uint64_t(0x7fffffffffffffffull)) {
+                ret = TypeDef(TypeCode::UInt64).create();
+            } else {
+                ret = TypeDef(TypeCode::Int64).create();
+            }
+            ret = val;
+            return ret;
+        }
+    }
+
+    void number(const std::string& num) {
+        if(!stack.empty() && stack.back().isArray) {
+            auto& top = stack.back();
+            auto type(top.fld.type());
+            switch(type.kind()) {
+            case Kind::Integer:
+                if(type.isunsigned())
+                    top.uints.push_back(parseTo<uint64_t>(num));
+                else
+                    top.ints.push_back(parseTo<int64_t>(num));
+                return;
+            case Kind::Real:
+                top.reals.push_back(parseTo<double>(num));
+                return;
+            case Kind::String:
+                top.strs.push_back(num);
+                return;
+            default:
+                if(type==TypeCode::AnyA) {
+                    top.vals.push_back(infer(num));
+                    return;
+                }
+                throw NoConvert(SB()<<"Can not append number to "<<type);
+            }
+        }
+
+        auto& fld = target();
+        switch(fld.storageType()) {
+        case StoreType::Integer:  fld = parseTo<int64_t>(num); break;
+        case StoreType::UInteger: fld = parseTo<uint64_t>(num); break;
+        case StoreType::Real:     fld = parseTo<double>(num); break;
+        case StoreType::String:   fld = num; break;
+        default:
+            if(fld.type()==TypeCode::Any) {
+                fld.from(infer(num));
+            } else {
+                fld.from(infer(num).as<double>());
+            }
+        }
+        consumed();
+    }
+
+    template<typename T>
+    void scalar(TypeCode infertype, const T& val) {
+        if(!stack.empty() && stack.back().isArray) {
+            auto& top = stack.back();
+            auto type(top.fld.type());
+            if(type==TypeCode::AnyA) {
+                auto elem(TypeDef(infertype).create());
+                elem = val;
+                top.vals.push_back(elem);
+            } else {
+                push(top, val);
+            }
+            return;
+        }
+
+        auto& fld = target();
+        if(fld.type()==TypeCode::Any) {
+            auto elem(TypeDef(infertype).create());
+            elem = val;
+            fld.from(elem);
+        } else {
+            fld = val;
+        }
+        consumed();
+    }
+
+    void push(Frame& top, bool val) {
+        if(top.fld.type()!=TypeCode::BoolA)
+            throw NoConvert(SB()<<"Can not append bool to "<<top.fld.type());
+        top.bools.push_back(val);
+    }
+
+    void push(Frame& top, const std::string& val) {
+        if(top.fld.type()!=TypeCode::StringA)
+            throw NoConvert(SB()<<"Can not append string to "<<top.fld.type());
+        top.strs.push_back(val);
+    }
+
+    void null() {
+        if(!stack.empty() && stack.back().isArray) {
+            auto& top = stack.back();
+            if(top.fld.type().kind()!=Kind::Compound)
+                throw NoConvert(SB()<<"Can not append null to "<<top.fld.type());
+            top.vals.emplace_back();
+            return;
+        }
+
+        auto& fld = target();
+        auto type(fld.type());
+        if(type==TypeCode::Union || type==TypeCode::Any)
+            fld.from(unselect);
+        // otherwise, leave unchanged
+        consumed();
+    }
+
+    void startMap() {
+        if(!stack.empty() && stack.back().isArray) {
+            auto& top = stack.back();
+            auto type(top.fld.type());
+            if(type!=TypeCode::StructA && type!=TypeCode::UnionA)
+                throw NoConvert(SB()<<"Can not append object to "<<type);
+            auto elem(top.fld.allocMember());
+            stack.emplace_back(elem, false);
+            return;
+        }
+
+        auto fld(target());
+        auto type(fld.type());
+        if(type!=TypeCode::Struct && type!=TypeCode::Union)
+            throw NoConvert(SB()<<"Can not assign object to "<<type);
+        stack.emplace_back(fld, false);
+    }
+
+    void key(const std::string& name) {
+        auto& top = stack.back();
+        if(top.fld.type()==TypeCode::Union) {
+            top.next = top.fld.lookup("->"+name);
+        } else {
+            top.next = top.fld.lookup(name);
+        }
+    }
+
+    void endMap() {
+        auto elem(std::move(stack.back().fld));
+        stack.pop_back();
+
+        if(!stack.empty() && stack.back().isArray) {
+            stack.back().vals.push_back(elem);
+        } else {
+            consumed();
+        }
+    }
+
+    void startArray() {
+        if(!stack.empty() && stack.back().isArray)
+            throw NoConvert("Nested arrays not supported");
+
+        auto fld(target());
+        if(!fld.type().isarray())
+            throw NoConvert(SB()<<"Can not assign array to "<<fld.type());
+        stack.emplace_back(fld, true);
+    }
+
+    void endArray() {
+        auto& top = stack.back();
+        auto type(top.fld.type());
+
+        switch(type.kind()) {
+        case Kind::Bool: {
+            shared_array<bool> arr(top.bools.size());
+            for(auto i : range(arr.size()))
+                arr[i] = top.bools[i];
+            top.fld = arr.freeze();
+        }
+            break;
+        case Kind::Integer:
+            if(type.isunsigned())
+                top.fld = shared_array<const uint64_t>(top.uints.begin(), top.uints.end());
+            else
+                top.fld = shared_array<const int64_t>(top.ints.begin(), top.ints.end());
+            break;
+        case Kind::Real:
+            top.fld = shared_array<const double>(top.reals.begin(), top.reals.end());
+            break;
+        case Kind::String:
+            top.fld = shared_array<const std::string>(top.strs.begin(), top.strs.end());
+            break;
+        default:
+            top.fld = shared_array<const Value>(top.vals.begin(), top.vals.end());
+            break;
+        }
+
+        stack.pop_back();
+        consumed();
+    }
+};
+
+// Run fn, translating exceptions for yajl
+template<typename Fn>
+int handle(void* raw, Fn&& fn)
+{
+    auto self = static_cast<Parser*>(raw);
+    try {
+        fn(*self);
+        return 1;
+    } catch(std::exception& e) {
+        if(self->err.empty())
+            self->err = e.what();
+        return 0;
+    }
+}
+
+int jnull(void* ctx)
+{
+    return handle(ctx, [](Parser& self) {
+        self.null();
+    });
+}
+
+int jboolean(void* ctx, int val)
+{
+    return handle(ctx, [val](Parser& self) {
+        self.scalar(TypeCode::Bool, bool(val));
+    });
+}
+
+int jnumber(void* ctx, const char* val, size_t len)
+{
+    return handle(ctx, [val, len](Parser& self) {
+        self.number(std::string(val, len));
+    });
+}
+
+int jstring(void* ctx, const unsigned char* val, size_t len)
+{
+    return handle(ctx, [val, len](Parser& self) {
+        self.scalar(TypeCode::String, std::string((const char*)val, len));
+    });
+}
+
+int jstartMap(void* ctx)
+{
+    return handle(ctx, [](Parser& self) {
+        self.startMap();
+    });
+}
+
+int jkey(void* ctx, const unsigned char* val, size_t len)
+{
+    return handle(ctx, [val, len](Parser& self) {
+        self.key(std::string((const char*)val, len));
+    });
+}
+
+int jendMap(void* ctx)
+{
+    return handle(ctx, [](Parser& self) {
+        self.endMap();
+    });
+}
+
+int jstartArray(void* ctx)
+{
+    return handle(ctx, [](Parser& self) {
+        self.startArray();
+    });
+}
+
+int jendArray(void* ctx)
+{
+    return handle(ctx, [](Parser& self) {
+        self.endArray();
+    });
+}
+
+// number replaces integer and double, so that we see the original text
+const yajl_callbacks jcallbacks{
+    &jnull,
+    &jboolean,
+    nullptr, // integer
+    nullptr, // double
+    &jnumber,
+    &jstring,
+    &jstartMap,
+    &jkey,
+    &jendMap,
+    &jstartArray,
+    &jendArray,
+};
+
+struct YajlHandle {
+    yajl_handle handle;
+    explicit YajlHandle(yajl_handle handle) :handle(handle) {
+        if(!handle)
+            throw std::bad_alloc();
+    }
+    ~YajlHandle() { yajl_free(handle); }
+};
+
+} // namespace
+
+void Parse::into(Value& val) const
+{
+    Parser parser(val);
+    auto bytes = reinterpret_cast<const unsigned char*>(base);
+
+#ifndef EPICS_YAJL_VERSION
+    yajl_parser_config conf;
+    memset(&conf, 0, sizeof(conf));
+    conf.allowComments = 1;
+    conf.checkUTF8 = 1;
+    YajlHandle H(yajl_alloc(&jcallbacks, &conf, nullptr, &parser));
+#else
+    YajlHandle H(yajl_alloc(&jcallbacks, nullptr, &parser));
+    yajl_config(H.handle, yajl_allow_comments, 1);
+#endif
+
+    auto sts = yajl_parse(H.handle, bytes, count);
+#ifndef EPICS_YAJL_VERSION
+    if(sts==yajl_status_ok || sts==yajl_status_insufficient_data)
+        sts = yajl_parse_complete(H.handle);
+#else
+    if(sts==yajl_status_ok)
+        sts = yajl_complete_parse(H.handle);
+#endif
+
+    switch(sts) {
+    case yajl_status_ok:
+        break;
+    case yajl_status_client_canceled:
+        throw std::runtime_error(parser.err);
+    default: {
+        std::string msg("Invalid JSON");
+        if(auto raw = yajl_get_error(H.handle, 1, bytes, count)) {
+            msg = (const char*)raw;
+            yajl_free_error(H.handle, raw);
+        }
+        throw std::runtime_error(msg);
+    }
+    }
+}
+
+} // namespace json
+} // namespace pvxs
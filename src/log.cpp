@@ -4,9 +4,13 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <list>
+#include <vector>
+#include <memory>
+#include <atomic>
 
 #include <assert.h>
 #include <stdlib.h>
@@ -26,6 +30,7 @@
 #include <epicsThread.h>
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsEvent.h>
 #include <epicsTime.h>
 
 #include "evhelper.h"
@@ -50,6 +55,208 @@ namespace pvxs {
 
 DEFINE_LOGGER(logerr, "pvxs.ev");
 
+namespace {
+
+// format a hex dump, passing each line to fn()
+template<typename Fn>
+void hexLines(const void *buf, size_t buflen, Fn&& fn)
+{
+    const auto cbuf = static_cast<const uint8_t*>(buf);
+    bool elipsis = buflen > 64u;
+    if(elipsis)
+        buflen = 64u;
+
+    // whole buffer
+    for(size_t pos=0; pos<buflen;)
+    {
+        // printed line (4 groups of 4 bytes)
+        // addr : AAAAAAAA BBBBBBBB CCCCCCCC DDDDDDDD
+        char buf[4][9] = {"","","",""};
+        const auto addr = unsigned(pos);
+
+        for(unsigned grp=0; grp<4 && pos<buflen ; grp++)
+        {
+            // group of 4 hex chars
+            unsigned chr=0;
+            for(; chr<8 && pos<buflen; pos++, chr+=2)
+            {
+                static const char hex[17]="0123456789ABCDEF";
+                uint8_t v = cbuf[pos];
+                buf[grp][chr+0] = hex[(v>>4)&0xf];
+                buf[grp][chr+1] = hex[(v>>0)&0xf];
+            }
+            for(; chr<8; chr+=2)
+            {
+                buf[grp][chr+0] = '\0';
+                buf[grp][chr+1] = '\0';
+            }
+            buf[grp][8] = '\0';
+        }
+
+        char line[48];
+        epicsSnprintf(line, sizeof(line), "%04x : %s %s %s %s\n", addr, buf[0], buf[1], buf[2], buf[3]);
+        fn(line);
+    }
+    if(elipsis)
+        fn("...\n");
+}
+
+/* Asynchronous logging.
+ *
+ * Each logging thread formats messages into its own ring of fixed size slots.
+ * Single producer (the owning thread) and single consumer (the drain thread),
+ * so no locking is needed except when a thread first logs.
+ * When a ring is full, messages are dropped and counted.
+ */
+struct LogRing {
+    static constexpr size_t nSlots = 128u;
+    static constexpr size_t slotSize = 512u;
+
+    // next slot to fill.  Only stored by the owning thread.
+    std::atomic<size_t> head{0u};
+    // next slot to drain.  Only stored by the drain thread.
+    std::atomic<size_t> tail{0u};
+    std::atomic<size_t> dropped{0u};
+    // owning thread has exited, or logger_shutdown().  Removed once drained.
+    std::atomic<bool> orphan{false};
+
+    char slots[nSlots][slotSize];
+};
+
+struct LogDrain final : public epicsThreadRunable {
+    epicsMutex lock;
+    std::vector<std::shared_ptr<LogRing>> rings; // guarded by lock
+    epicsEvent wakeup;
+    std::atomic<bool> running{true};
+    epicsThread worker;
+
+    LogDrain()
+        :worker(*this, "PVXLOG",
+                epicsThreadGetStackSize(epicsThreadStackSmall),
+                epicsThreadPriorityLow)
+    {
+        worker.start();
+    }
+    virtual ~LogDrain() {}
+
+    std::shared_ptr<LogRing> add()
+    {
+        auto ring(std::make_shared<LogRing>());
+        Guard G(lock);
+        rings.push_back(ring);
+        return ring;
+    }
+
+    void drain()
+    {
+        Guard G(lock);
+        for(auto it = rings.begin(); it!=rings.end();) {
+            auto& ring = **it;
+            // check before draining, so that messages of an orphan are never lost
+            bool orphan = ring.orphan.load(std::memory_order_acquire);
+
+            auto tail = ring.tail.load(std::memory_order_relaxed);
+            auto head = ring.head.load(std::memory_order_acquire);
+            for(; tail!=head; tail++) {
+                errlogPrintf("%s", ring.slots[tail%LogRing::nSlots]);
+            }
+            ring.tail.store(tail, std::memory_order_release);
+
+            if(auto ndrop = ring.dropped.exchange(0u, std::memory_order_relaxed))
+                errlogPrintf("pvxs: %zu log messages dropped\n", ndrop);
+
+            if(orphan) {
+                it = rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    virtual void run() override final
+    {
+        while(running.load(std::memory_order_relaxed)) {
+            (void)wakeup.wait(0.05);
+            drain();
+        }
+        drain();
+    }
+
+    void stop()
+    {
+        running = false;
+        wakeup.signal();
+        worker.exitWait();
+    }
+};
+
+std::atomic<bool> logAsync{false};
+
+// cf. logger_limit_set()
+std::atomic<unsigned> logLimitBurst{10u};
+std::atomic<uint64_t> logLimitInterval{10000000000ull}; // ns
+epicsMutex* logDrainLock;
+LogDrain* logDrain; // guarded by logDrainLock.  Never free'd while running
+
+struct LogRingHolder {
+    std::shared_ptr<LogRing> ring;
+    ~LogRingHolder() {
+        if(ring)
+            ring->orphan.store(true, std::memory_order_release);
+    }
+};
+thread_local LogRingHolder logRing;
+
+LogRing* currentRing()
+{
+    if(!logRing.ring || logRing.ring->orphan.load(std::memory_order_relaxed)) {
+        Guard G(*logDrainLock);
+        if(!logDrain)
+            logDrain = new LogDrain();
+        logRing.ring = logDrain->add();
+    }
+    return logRing.ring.get();
+}
+
+// queue one message, with an optional hex dump printed ahead
+void asyncLog(const void *buf, size_t buflen, const char *fmt, va_list args)
+{
+    auto ring = currentRing();
+
+    auto head = ring->head.load(std::memory_order_relaxed);
+    auto tail = ring->tail.load(std::memory_order_acquire);
+    if(head-tail >= LogRing::nSlots) {
+        ring->dropped.fetch_add(1u, std::memory_order_relaxed);
+        return;
+    }
+
+    auto slot = ring->slots[head%LogRing::nSlots];
+    size_t N = 0u;
+    if(buf) {
+        hexLines(buf, buflen, [slot, &N](const char* line) {
+            auto ret = epicsSnprintf(slot+N, LogRing::slotSize-N, "%s", line);
+            if(ret>0)
+                N = std::min(N+size_t(ret), LogRing::slotSize-1u);
+        });
+    }
+    auto ret = epicsVsnprintf(slot+N, LogRing::slotSize-N, fmt, args);
+    if(ret>=0 && N+size_t(ret) >= LogRing::slotSize) {
+        // truncated.  keep output line oriented.
+        strcpy(slot+LogRing::slotSize-5u, "...\n");
+    }
+
+    ring->head.store(head+1u, std::memory_order_release);
+
+    if(head+1u-tail == LogRing::nSlots/2u) {
+        // filling quickly.  Don't wait for the next poll.
+        Guard G(*logDrainLock);
+        if(logDrain)
+            logDrain->wakeup.signal();
+    }
+}
+
+} // namespace
+
 namespace detail {
 
 static
@@ -95,9 +302,44 @@ const char* log_prep(logger& log, unsigned rawlvl)
     return prefix;
 }
 
+const char* log_prep(logger& log, unsigned rawlvl, LogLimit& limit)
+{
+    auto lvl = (Level)(rawlvl&0xff);
+    if(!log.test(lvl))
+        return nullptr; // don't log
+
+    uint32_t nsuppressed = 0u;
+    auto burst = logLimitBurst.load(std::memory_order_relaxed);
+    if(burst && (lvl==Level::Err || lvl==Level::Warn) && !(rawlvl&0x1000)) {
+        auto now = epicsMonotonicGet();
+        auto start = limit.start.load(std::memory_order_relaxed);
+        if(now - start >= logLimitInterval.load(std::memory_order_relaxed)) {
+            // begin a new interval.  Only one of any racing threads resets the count.
+            if(limit.start.compare_exchange_strong(start, now))
+                limit.count.store(0u);
+        }
+        if(limit.count.fetch_add(1u) >= burst) {
+            limit.suppressed.fetch_add(1u, std::memory_order_relaxed);
+            return nullptr;
+        }
+        nsuppressed = limit.suppressed.exchange(0u);
+    }
+
+    auto prefix = log_prep(log, rawlvl);
+    if(prefix && nsuppressed)
+        _log_printf(rawlvl, "%s suppressed %u similar messages\n", prefix, unsigned(nsuppressed));
+    return prefix;
+}
+
 static
 void _log_vprintf(unsigned rawlvl, const char *fmt, va_list args)
 {
+    // critical and exception messages stay synchronous, as they may be followed by abort()
+    if(logAsync.load(std::memory_order_relaxed) && Level(rawlvl&0xff)!=Level::Crit && !(rawlvl&0x1000)) {
+        asyncLog(nullptr, 0u, fmt, args);
+        return;
+    }
+
     errlogVprintf(fmt, args);
 
     if(Level(rawlvl&0xff)==Level::Crit && abortOnCrit!=0) {
@@ -131,8 +373,12 @@ void _log_printf_hex(unsigned rawlvl, const void *buf, size_t buflen, const char
 {
     va_list args;
     va_start(args, fmt);
-    xerrlogHexPrintf(buf, buflen);
-    _log_vprintf(rawlvl, fmt, args);
+    if(logAsync.load(std::memory_order_relaxed) && Level(rawlvl&0xff)!=Level::Crit && !(rawlvl&0x1000)) {
+        asyncLog(buf, buflen, fmt, args);
+    } else {
+        xerrlogHexPrintf(buf, buflen);
+        _log_vprintf(rawlvl, fmt, args);
+    }
     va_end(args);
 }
 
@@ -250,6 +496,7 @@ struct logger_gbl_t {
 void logger_prepare(void *unused)
 {
     logger_gbl = new logger_gbl_t;
+    logDrainLock = new epicsMutex();
 
     if(auto env = getenv("_PVXS_ABORT_ON_CRIT")) {
         if(epicsStrCaseCmp(env, "YES")==0 || strcmp(env, "1")==0) {
@@ -286,42 +533,9 @@ Level logger::init()
 
 void xerrlogHexPrintf(const void *buf, size_t buflen)
 {
-    const auto cbuf = static_cast<const uint8_t*>(buf);
-    bool elipsis = buflen > 64u;
-    if(elipsis)
-        buflen = 64u;
-
-    // whole buffer
-    for(size_t pos=0; pos<buflen;)
-    {
-        // printed line (4 groups of 4 bytes)
-        // addr : AAAAAAAA BBBBBBBB CCCCCCCC DDDDDDDD
-        char buf[4][9] = {"","","",""};
-        const auto addr = unsigned(pos);
-
-        for(unsigned grp=0; grp<4 && pos<buflen ; grp++)
-        {
-            // group of 4 hex chars
-            unsigned chr=0;
-            for(; chr<8 && pos<buflen; pos++, chr+=2)
-            {
-                static const char hex[17]="0123456789ABCDEF";
-                uint8_t v = cbuf[pos];
-                buf[grp][chr+0] = hex[(v>>4)&0xf];
-                buf[grp][chr+1] = hex[(v>>0)&0xf];
-            }
-            for(; chr<8; chr+=2)
-            {
-                buf[grp][chr+0] = '\0';
-                buf[grp][chr+1] = '\0';
-            }
-            buf[grp][8] = '\0';
-        }
-
-        errlogPrintf("%04x : %s %s %s %s\n", addr, buf[0], buf[1], buf[2], buf[3]);
-    }
-    if(elipsis)
-        errlogPrintf("...\n");
+    hexLines(buf, buflen, [](const char* line) {
+        errlogPrintf("%s", line);
+    });
 }
 
 void logger_level_set(const char *name, int lvl)
@@ -342,8 +556,47 @@ void logger_level_clear()
     logger_gbl->config.clear();
 }
 
+void logger_async_set(bool enable)
+{
+    threadOnce(&logger_once, &logger_prepare, nullptr);
+    logAsync.store(enable, std::memory_order_relaxed);
+}
+
+void logger_limit_set(unsigned burst, double interval)
+{
+    logLimitBurst.store(burst, std::memory_order_relaxed);
+    if(interval>0.0)
+        logLimitInterval.store(uint64_t(interval*1e9), std::memory_order_relaxed);
+}
+
 void logger_config_env()
 {
+    if(auto env = getenv("PVXS_LOG_LIMIT")) {
+        try {
+            std::string val(env);
+            auto sep = val.find('/');
+            auto burst = parseTo<uint64_t>(val.substr(0, sep));
+            double interval = 10.0;
+            if(sep!=std::string::npos)
+                interval = parseTo<double>(val.substr(sep+1u));
+            if(!(interval>0.0) || burst > 0xffffffffu)
+                throw std::out_of_range("Out of range");
+            logger_limit_set(unsigned(burst), interval);
+        }catch(std::exception& e){
+            errlogPrintf("PVXS_LOG_LIMIT ignore invalid: '%s' : %s\n", env, e.what());
+        }
+    }
+
+    if(auto env = getenv("PVXS_LOG_ASYNC")) {
+        if(epicsStrCaseCmp(env, "YES")==0 || strcmp(env, "1")==0) {
+            logger_async_set(true);
+        } else if(epicsStrCaseCmp(env, "NO")==0 || strcmp(env, "0")==0) {
+            logger_async_set(false);
+        } else {
+            errlogPrintf("PVXS_LOG_ASYNC ignore invalid: '%s'\n", env);
+        }
+    }
+
     const char *env = getenv("PVXS_LOG");
     if(!env || !*env)
         return;
@@ -399,6 +652,23 @@ void logger_shutdown()
 {
     threadOnce(&logger_once, &logger_prepare, nullptr);
 
+    logAsync = false;
+    {
+        LogDrain* drain;
+        {
+            Guard G(*logDrainLock);
+            drain = logDrain;
+            logDrain = nullptr;
+        }
+        if(drain) {
+            // joins, after emptying all rings
+            drain->stop();
+            for(auto& ring : drain->rings)
+                ring->orphan = true;
+            delete drain;
+        }
+    }
+
     errlogFlush();
 
     delete logger_gbl;
@@ -0,0 +1,201 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <string.h>
+
+#include "utilpvt.h"
+
+/* A minimal implementation of the LZ4 block format.
+ * https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+ *
+ * A block is a sequence of:
+ *   token          - literal length (high nibble), match length - 4 (low nibble)
+ *   [length ext.]  - if literal length nibble is 15, add bytes until one is not 255
+ *   literals
+ *   offset         - 2 bytes, little endian.  Absent from the last sequence.
+ *   [length ext.]  - if match length nibble is 15
+ *
+ * Compression is greedy, with a single hash table of recent positions.
+ * Less effective than liblz4, but enough for the long runs of repeated,
+ * or slowly changing, values typical of waveforms and images.
+ */
+
+namespace pvxs {
+namespace impl {
+
+namespace {
+constexpr size_t minMatch = 4u;
+// the last 5 bytes are always literals
+constexpr size_t lastLiterals = 5u;
+// the last match must start at least 12 bytes before the end of the block
+constexpr size_t mfLimit = 12u;
+constexpr size_t maxOffset = 0xffffu;
+constexpr unsigned hashLog = 12u;
+
+inline
+uint32_t read32(const uint8_t* p)
+{
+    uint32_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+inline
+size_t hash32(uint32_t v)
+{
+    return (v*2654435761u) >> (32u - hashLog);
+}
+
+struct Encoder {
+    uint8_t* const out;
+    const size_t outmax;
+    size_t op = 0u;
+
+    Encoder(uint8_t* out, size_t outmax) :out(out), outmax(outmax) {}
+
+    void putLen(size_t n) {
+        while(n>=255u) {
+            out[op++] = 255u;
+            n -= 255u;
+        }
+        out[op++] = uint8_t(n);
+    }
+
+    // append one sequence.  mlen==0 for the last (literals only)
+    bool emit(const uint8_t* lit, size_t litlen, size_t mlen, size_t offset) {
+        // token + literal length ext. + literals + offset + match length ext.
+        if(outmax - op < 1u + litlen/255u + 1u + litlen + 2u + mlen/255u + 1u)
+            return false;
+
+        size_t mcode = mlen ? mlen - minMatch : 0u;
+        out[op++] = uint8_t((std::min(litlen, size_t(15u))<<4u) | std::min(mcode, size_t(15u)));
+        if(litlen>=15u)
+            putLen(litlen - 15u);
+        if(litlen)
+            memcpy(out + op, lit, litlen);
+        op += litlen;
+
+        if(mlen) {
+            out[op++] = uint8_t(offset);
+            out[op++] = uint8_t(offset>>8u);
+            if(mcode>=15u)
+                putLen(mcode - 15u);
+        }
+        return true;
+    }
+};
+
+// read a length extension.  false if truncated
+inline
+bool getLen(const uint8_t* in, size_t inlen, size_t& ip, size_t& len)
+{
+    uint8_t b;
+    do {
+        if(ip>=inlen)
+            return false;
+        b = in[ip++];
+        len += b;
+    } while(b==255u);
+    return true;
+}
+
+} // namespace
+
+size_t lz4Compress(const uint8_t* in, size_t inlen, uint8_t* out, size_t outmax)
+{
+    Encoder E(out, outmax);
+    size_t anchor = 0u;
+
+    if(inlen > mfLimit) {
+        // position+1 of the most recent occurrence of each hash.  0 for none
+        std::vector<uint32_t> table(1u<<hashLog);
+        const size_t limit = inlen - mfLimit;
+
+        for(size_t ip=0u; ip < limit;) {
+            auto seq(read32(in + ip));
+            auto& slot = table[hash32(seq)];
+            size_t ref = slot;
+            slot = uint32_t(ip + 1u);
+
+            if(!ref || ip - (ref-1u) > maxOffset || read32(in + ref - 1u)!=seq) {
+                ip++;
+                continue;
+            }
+            ref--;
+
+            // extend forward, leaving the last literals
+            size_t mlen = minMatch;
+            const size_t mmax = inlen - lastLiterals - ip;
+            while(mlen < mmax && in[ip+mlen]==in[ref+mlen])
+                mlen++;
+            // extend backward into pending literals
+            while(ip > anchor && ref > 0u && in[ip-1u]==in[ref-1u]) {
+                ip--;
+                ref--;
+                mlen++;
+            }
+
+            if(!E.emit(in + anchor, ip - anchor, mlen, ip - ref))
+                return 0u;
+            ip += mlen;
+            anchor = ip;
+        }
+    }
+
+    if(!E.emit(in + anchor, inlen - anchor, 0u, 0u))
+        return 0u;
+    return E.op;
+}
+
+bool lz4Decompress(const uint8_t* in, size_t inlen, uint8_t* out, size_t outlen)
+{
+    size_t ip = 0u, op = 0u;
+
+    while(ip < inlen) {
+        auto token = in[ip++];
+
+        size_t litlen = token>>4u;
+        if(litlen==15u && !getLen(in, inlen, ip, litlen))
+            return false;
+        if(litlen > inlen - ip || litlen > outlen - op)
+            return false;
+        if(litlen)
+            memcpy(out + op, in + ip, litlen);
+        ip += litlen;
+        op += litlen;
+
+        if(ip==inlen)
+            break; // last sequence has no match
+
+        if(inlen - ip < 2u)
+            return false;
+        size_t offset = in[ip] | size_t(in[ip+1u])<<8u;
+        ip += 2u;
+        if(offset==0u || offset > op)
+            return false;
+
+        size_t mlen = token&0xfu;
+        if(mlen==15u && !getLen(in, inlen, ip, mlen))
+            return false;
+        mlen += minMatch;
+        if(mlen > outlen - op)
+            return false;
+
+        // may overlap, so copy forward one byte at a time
+        const uint8_t* src = out + op - offset;
+        for(auto i : range(mlen))
+            out[op+i] = src[i];
+        op += mlen;
+    }
+
+    return op==outlen;
+}
+
+} // namespace impl
+} // namespace pvxs
@@ -0,0 +1,187 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <stdexcept>
+
+#include <epicsGuard.h>
+
+#include <pvxs/log.h>
+
+#include "mcastmon.h"
+#include "dataimpl.h"
+#include "pvaproto.h"
+#include "utilpvt.h"
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace pvxs {
+namespace impl {
+
+DEFINE_LOGGER(logmcast, "pvxs.mcast.mon");
+
+DEFINE_INST_COUNTER(MCastPublisher);
+
+void encodeMCastUpdate(std::vector<uint8_t>& buf, const std::string& name, uint32_t seq,
+                       const Value& full, const Value& changed)
+{
+    auto desc = Value::Helper::desc(full);
+    assert(desc && (!changed || Value::Helper::desc(changed)==desc));
+
+    BitMask mask(desc->size());
+    if(!changed) {
+        for(auto bit : range(desc->size()))
+            mask[bit] = true;
+    } else {
+        auto store = Value::Helper::store_ptr(changed);
+        for(auto bit : range(desc->size())) {
+            if(store[bit].valid)
+                mask[bit] = true;
+        }
+    }
+
+    buf.clear();
+    VectorOutBuf M(true, buf);
+    M.skip(8, __FILE__, __LINE__); // fill in header after body length known
+
+    to_wire(M, name);
+    to_wire(M, seq);
+    to_wire(M, desc);
+    to_wire_full(M, full);
+    to_wire(M, mask);
+
+    size_t pktlen = M.save()-buf.data();
+    buf.resize(pktlen);
+
+    FixedBuf H(true, buf.data(), 8);
+    to_wire(H, Header{CMD_MONITOR, pva_flags::Server, uint32_t(pktlen-8)});
+
+    if(!M.good() || !H.good())
+        throw std::logic_error("Error encoding multicast monitor update");
+}
+
+bool peekMCastUpdate(std::string& name, const UDPManager::Monitor& msg)
+{
+    FixedBuf M(msg.be, const_cast<uint8_t*>(msg.body), msg.len);
+    from_wire(M, name);
+    return M.good();
+}
+
+bool decodeMCastUpdate(MCastUpdate& out, const UDPManager::Monitor& msg)
+{
+    FixedBuf M(msg.be, const_cast<uint8_t*>(msg.body), msg.len);
+    TypeStore types;
+    BitMask mask;
+
+    from_wire(M, out.name);
+    from_wire(M, out.seq);
+    from_wire_type_value(M, types, out.val);
+    from_wire(M, mask);
+
+    if(!M.good() || !out.val || out.val.type()!=TypeCode::Struct)
+        return false;
+
+    // only those fields changed are marked
+    auto desc = Value::Helper::desc(out.val);
+    auto store = Value::Helper::store_ptr(out.val);
+    mask.resize(desc->size());
+    for(auto bit : range(desc->size()))
+        store[bit].valid = mask[bit];
+
+    return true;
+}
+
+MCastPublisher::MCastPublisher(const std::string& name, const std::string& dest, double period)
+    :name(name)
+    ,dest(dest)
+    ,manager(UDPManager::instance())
+    ,sock(this->dest.addr.family(), SOCK_DGRAM, 0)
+    ,heartbeat(__FILE__, __LINE__,
+               event_new(manager.loop().base, -1, EV_TIMEOUT|EV_PERSIST, &doHeartbeatS, this))
+    ,period(period)
+{
+    if(this->dest.addr.port()==0)
+        throw std::runtime_error(SB()<<"Multicast monitor destination '"<<dest<<"' must include a port number");
+
+    sock.mcast_prep_sendto(this->dest);
+    // local subscribers also receive
+    if(this->dest.addr.isMCast())
+        sock.mcast_loop(true);
+
+    if(period>0.0) {
+        manager.loop().call([this]() {
+            timeval interval(totv(this->period));
+            if(event_add(heartbeat.get(), &interval))
+                log_err_printf(logmcast, "Error enabling multicast heartbeat timer for %s\n", this->name.c_str());
+        });
+    }
+
+    log_debug_printf(logmcast, "Multicast %s to %s\n", name.c_str(), std::string(SB()<<this->dest).c_str());
+}
+
+MCastPublisher::~MCastPublisher()
+{
+    manager.loop().call([this]() {
+        (void)event_del(heartbeat.get());
+    });
+}
+
+void MCastPublisher::publish(const Value& full, const Value& changed)
+{
+    std::vector<uint8_t> msg;
+    {
+        Guard G(lock);
+        encodeMCastUpdate(last, name, ++seq, full, changed);
+        msg = last;
+    }
+    send(msg);
+}
+
+void MCastPublisher::clear()
+{
+    Guard G(lock);
+    last.clear();
+}
+
+void MCastPublisher::send(const std::vector<uint8_t>& msg)
+{
+    int ntx = sendto(sock.sock, (char*)msg.data(), msg.size(), 0, &dest.addr->sa, dest.addr.size());
+
+    if(ntx<0) {
+        int err = evutil_socket_geterror(sock.sock);
+        auto lvl = Level::Warn;
+        if(err==EINTR || err==EPERM)
+            lvl = Level::Debug;
+        log_printf(logmcast, lvl, "Multicast %s tx error (%d) %s\n",
+                   name.c_str(), err, evutil_socket_error_to_string(err));
+
+    } else if(unsigned(ntx)<msg.size()) {
+        log_warn_printf(logmcast, "Multicast %s truncated %u < %u\n",
+                        name.c_str(), unsigned(ntx), unsigned(msg.size()));
+    }
+}
+
+void MCastPublisher::doHeartbeat()
+{
+    std::vector<uint8_t> msg;
+    {
+        Guard G(lock);
+        msg = last;
+    }
+    if(!msg.empty())
+        send(msg);
+}
+
+void MCastPublisher::doHeartbeatS(evutil_socket_t fd, short evt, void *raw)
+{
+    try {
+        static_cast<MCastPublisher*>(raw)->doHeartbeat();
+    }catch(std::exception& e){
+        log_exc_printf(logmcast, "Unhandled error in multicast heartbeat: %s\n", e.what());
+    }
+}
+
+} // namespace impl
+} // namespace pvxs
@@ -0,0 +1,87 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef MCASTMON_H
+#define MCASTMON_H
+
+#include <string>
+#include <vector>
+
+#include <epicsMutex.h>
+
+#include <pvxs/data.h>
+
+#include "evhelper.h"
+#include "udp_collector.h"
+
+namespace pvxs {
+namespace impl {
+
+/* Multicast delivery of monitor updates.  cf. server::SharedPV::multicast()
+ * and client::MonitorBuilder::multicast()
+ *
+ * Each datagram is a CMD_MONITOR message, which is self-contained so that
+ * a lost datagram is recovered by the next one.
+ *
+ *   string   PV name
+ *   uint32   sequence number.  Incremented by each update.  Repeated by a heartbeat.
+ *   ...      type description and full value (cf. from_wire_type_value())
+ *   BitMask  fields changed since the previous sequence number
+ */
+
+//! Encode one datagram, including the header.  If changed is empty, then all fields are changed.
+PVXS_API
+void encodeMCastUpdate(std::vector<uint8_t>& buf, const std::string& name, uint32_t seq,
+                       const Value& full, const Value& changed);
+
+struct MCastUpdate {
+    std::string name;
+    uint32_t seq = 0u;
+    //! marked fields are those changed
+    Value val;
+};
+
+//! Decode only the PV name of a message body.  @returns false if not valid
+PVXS_API
+bool peekMCastUpdate(std::string& name, const UDPManager::Monitor& msg);
+//! Decode a message body.  @returns false if not valid
+PVXS_API
+bool decodeMCastUpdate(MCastUpdate& out, const UDPManager::Monitor& msg);
+
+//! Sends the updates of one PV to one destination.  Re-sends the latest as a heartbeat.
+struct PVXS_API MCastPublisher {
+    const std::string name;
+    const SockEndpoint dest;
+    UDPManager manager; // heartbeat timer runs on the UDP worker
+    evsocket sock;
+    evevent heartbeat;
+    const double period;
+
+    epicsMutex lock;
+    // guarded by lock
+    std::vector<uint8_t> last;
+    uint32_t seq = 0u;
+
+    INST_COUNTER(MCastPublisher);
+
+    //! @throws std::runtime_error if dest can not be parsed, or has no port number.
+    MCastPublisher(const std::string& name, const std::string& dest, double period);
+    ~MCastPublisher();
+
+    //! Send changed fields as the next sequence number.  full is encoded before returning.
+    void publish(const Value& full, const Value& changed);
+    //! Stop heartbeats until the next publish()
+    void clear();
+
+private:
+    void send(const std::vector<uint8_t>& msg);
+    void doHeartbeat();
+    static void doHeartbeatS(evutil_socket_t fd, short evt, void *raw);
+};
+
+} // namespace impl
+} // namespace pvxs
+
+#endif // MCASTMON_H
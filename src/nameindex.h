@@ -0,0 +1,74 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <string>
+#include <memory>
+#include <array>
+#include <vector>
+#include <unordered_map>
+
+#include "utilpvt.h"
+
+namespace pvxs {namespace impl {
+
+/** Server-wide index of PV names registered by IndexedSource instances.
+ *
+ *  Searches for names found here are claimed without calling Source::onSearch().
+ *  Each name is reference counted, to allow more than one IndexedSource to register it.
+ *  Sharded to reduce contention between the UDP worker, TCP workers,
+ *  and user threads adding or removing names.
+ */
+struct NameIndex {
+    void add(const std::string& name);
+    void remove(const std::string& name);
+    bool contains(const char* name);
+    size_t size();
+
+private:
+    struct Shard {
+        RWLock lock;
+        std::unordered_map<std::string, size_t> names;
+    };
+    std::array<Shard, 16u> shards;
+
+    Shard& shardOf(const char* name);
+};
+
+/** Bloom filter of the names which some Sources may claim.
+ *
+ *  mayContain() never returns false for a name which was add()ed,
+ *  and returns true for other names with a probability of about 1%.
+ *  Immutable once built, so may be shared between threads without locking.
+ */
+struct NameFilter {
+    explicit NameFilter(size_t nnames);
+    void add(const char* name);
+    bool mayContain(const char* name) const;
+
+private:
+    std::vector<uint64_t> bits;
+};
+
+/** Optional interface of a Source which knows all of the names it will claim.
+ *
+ *  A Server will call attachIndex() when the Source is added, and detachIndex()
+ *  when it is removed.  While attached, the Source must add() and remove()
+ *  names as they change.  In return, the Source::onSearch() is no longer called.
+ */
+struct IndexedSource {
+    virtual ~IndexedSource();
+    //! add() all current names, and retain idx to keep up to date
+    virtual void attachIndex(const std::shared_ptr<NameIndex>& idx) =0;
+    //! remove() all current names, and forget idx
+    virtual void detachIndex(const std::shared_ptr<NameIndex>& idx) =0;
+};
+
+}} // namespace pvxs::impl
+
+#endif // NAMEINDEX_H
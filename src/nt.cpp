@@ -4,20 +4,36 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <map>
+#include <stdexcept>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
 #include <pvxs/nt.h>
 
+#include "utilpvt.h"
+
+/* Each build() returns a copy of a TypeDef constructed on first use.
+ * TypeDef is immutable, and operator+=() appends to a new copy,
+ * so callers may extend the result without affecting the cache.
+ * create() then needs only to allocate the Value storage.
+ */
+
 namespace pvxs {
 namespace nt {
 
+typedef epicsGuard<epicsMutex> Guard;
+
 TypeDef TimeStamp::build()
 {
     using namespace pvxs::members;
 
-    TypeDef def(TypeCode::Struct, "time_t", {
-                    Int64("secondsPastEpoch"),
-                    Int32("nanoseconds"),
-                    Int32("userTag"),
-                });
+    static const TypeDef def(TypeCode::Struct, "time_t", {
+                                 Int64("secondsPastEpoch"),
+                                 Int32("nanoseconds"),
+                                 Int32("userTag"),
+                             });
     return def;
 }
 
@@ -25,18 +41,25 @@ TypeDef Alarm::build()
 {
     using namespace pvxs::members;
 
-    TypeDef def(TypeCode::Struct, "alarm_t", {
-                    Int32("severity"),
-                    Int32("status"),
-                    String("message"),
-                });
+    static const TypeDef def(TypeCode::Struct, "alarm_t", {
+                                 Int32("severity"),
+                                 Int32("status"),
+                                 String("message"),
+                             });
     return def;
 }
 
-TypeDef NTScalar::build() const
+namespace {
+TypeDef buildScalar(const NTScalar& opts)
 {
     using namespace pvxs::members;
 
+    auto& value = opts.value;
+    auto display = opts.display;
+    auto control = opts.control;
+    auto valueAlarm = opts.valueAlarm;
+    auto form = opts.form;
+
     if(!value.valid() || value.kind()==Kind::Compound)
         throw std::logic_error("NTScalar only permits (array of) primitive");
 
@@ -113,11 +136,41 @@ TypeDef NTScalar::build() const
     return def;
 }
 
+struct ScalarCache {
+    epicsMutex lock;
+    // key from value type code and option flags
+    std::map<uint32_t, TypeDef> defs;
+};
+} // namespace
+
+TypeDef NTScalar::build() const
+{
+    // one for each combination of arguments actually used.  Intentionally never free'd.
+    static ScalarCache* cache = new ScalarCache;
+
+    uint32_t key = uint32_t(value.code)<<8u
+            | (display ? 1u : 0u)
+            | (control ? 2u : 0u)
+            | (valueAlarm ? 4u : 0u)
+            | (form ? 8u : 0u);
+    {
+        Guard G(cache->lock);
+        auto it(cache->defs.find(key));
+        if(it!=cache->defs.end())
+            return it->second;
+    }
+
+    auto def(buildScalar(*this)); // may throw
+
+    Guard G(cache->lock);
+    return cache->defs.emplace(key, std::move(def)).first->second;
+}
+
 TypeDef NTEnum::build() const
 {
     using namespace pvxs::members;
 
-    TypeDef def(TypeCode::Struct, "epics:nt/NTEnum:1.0", {
+    static const TypeDef def(TypeCode::Struct, "epics:nt/NTEnum:1.0", {
                     Struct("value", "enum_t", {
                         Int32("index"),
                         StringA("choices"),
@@ -132,7 +185,8 @@ TypeDef NTEnum::build() const
     return def;
 }
 
-TypeDef NTNDArray::build() const
+namespace {
+TypeDef buildNDArray()
 {
     using namespace pvxs::members;
 
@@ -188,6 +242,13 @@ TypeDef NTNDArray::build() const
 
     return def;
 }
+} // namespace
+
+TypeDef NTNDArray::build() const
+{
+    static const TypeDef def(buildNDArray());
+    return def;
+}
 
 NTURI::NTURI(std::initializer_list<Member> args)
 {
@@ -201,4 +262,75 @@ NTURI::NTURI(std::initializer_list<Member> args)
     });
 }
 
+
+NTTable& NTTable::add_column(TypeCode code, const std::string& name, const std::string& label)
+{
+    _cols.push_back(Member(code, name));
+    _labels.push_back(label.empty() ? name : label);
+    return *this;
+}
+
+TypeDef NTTable::build() const
+{
+    using namespace pvxs::members;
+
+    TypeDef def(TypeCode::Struct, "epics:nt/NTTable:1.0", {
+                    StringA("labels"),
+                    Member(TypeCode::Struct, "value", _cols),
+                    String("descriptor"),
+                    Alarm{}.build().as("alarm"),
+                    TimeStamp{}.build().as("timeStamp"),
+                });
+    return def;
+}
+
+Value NTTable::create() const
+{
+    auto ret(build().create());
+    shared_array<std::string> labels(_labels.begin(), _labels.end());
+    ret["labels"] = labels.freeze();
+    return ret;
+}
+
+NTTableColumns::NTTableColumns(const Value& table)
+{
+    auto value(table["value"]);
+    for(auto col : value.ichildren()) {
+        _names.push_back(value.nameOf(col));
+        _refs.emplace_back(table, "value."+_names.back());
+    }
+}
+
+size_t NTTableColumns::index(const std::string& name) const
+{
+    for(auto i : range(_names.size())) {
+        if(_names[i]==name)
+            return i;
+    }
+    throw std::out_of_range(SB()<<"NTTable has no column "<<name);
+}
+
+size_t NTTableColumns::nrows(const Value& table) const
+{
+    size_t ret = 0u;
+    for(auto i : range(_refs.size())) {
+        auto n = field(table, i).as<shared_array<const void>>().size();
+        if(i==0u || n < ret)
+            ret = n;
+    }
+    return ret;
+}
+
+NTTableColumns::Rows NTTableColumns::rows(const Value& table) const
+{
+    Rows ret;
+    ret._cols.reserve(_refs.size());
+    for(auto i : range(_refs.size())) {
+        ret._cols.push_back(field(table, i).as<shared_array<const void>>());
+        if(i==0u || ret._cols.back().size() < ret._nrows)
+            ret._nrows = ret._cols.back().size();
+    }
+    return ret;
+}
+
 }} // namespace pvxs::nt
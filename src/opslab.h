@@ -0,0 +1,151 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef OPSLAB_H
+#define OPSLAB_H
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+namespace pvxs {
+namespace impl {
+
+/* Spare memory blocks for short lived operation objects, and their shared_ptr control blocks.
+ * eg. one per server connection, or client Context.
+ *
+ * Blocks are kept by size, with one list for each distinct size seen.
+ * Since operation objects are allocated through std::allocate_shared(),
+ * each type of operation has one size, so only a few lists are expected.
+ * Up to limit blocks of each size are kept.
+ *
+ * Blocks may be returned from any thread.
+ */
+struct OpSlab {
+    const size_t limit;
+
+    mutable epicsMutex lock;
+    // guarded by lock
+    struct Bin {
+        size_t size;
+        std::vector<void*> blocks;
+    };
+    std::vector<Bin> bins;
+
+    explicit OpSlab(size_t limit=64u) :limit(limit) {}
+    ~OpSlab() {
+        for(auto& bin : bins) {
+            for(auto blk : bin.blocks)
+                ::operator delete(blk);
+        }
+    }
+    OpSlab(const OpSlab&) = delete;
+    OpSlab& operator=(const OpSlab&) = delete;
+
+    void* allocate(size_t size) {
+        {
+            epicsGuard<epicsMutex> G(lock);
+            for(auto& bin : bins) {
+                if(bin.size==size) {
+                    if(!bin.blocks.empty()) {
+                        auto blk = bin.blocks.back();
+                        bin.blocks.pop_back();
+                        return blk;
+                    }
+                    break;
+                }
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void deallocate(void* blk, size_t size) noexcept {
+        try {
+            epicsGuard<epicsMutex> G(lock);
+            Bin* found = nullptr;
+            for(auto& bin : bins) {
+                if(bin.size==size) {
+                    found = &bin;
+                    break;
+                }
+            }
+            if(!found) {
+                bins.push_back(Bin{size, {}});
+                found = &bins.back();
+                found->blocks.reserve(limit);
+            }
+            if(found->blocks.size() < limit) {
+                found->blocks.push_back(blk);
+                return;
+            }
+        }catch(std::bad_alloc&){
+            // fall through to free
+        }
+        ::operator delete(blk);
+    }
+
+    // bytes held in spare blocks
+    size_t spareBytes() const {
+        epicsGuard<epicsMutex> G(lock);
+        size_t ret = 0u;
+        for(auto& bin : bins)
+            ret += bin.size*bin.blocks.size();
+        return ret;
+    }
+};
+
+/* Allocator, for std::allocate_shared(), through an OpSlab.
+ * Holds a weak reference, so an object may outlive the connection or Context
+ * which owns the OpSlab, in which case its block is simply freed.
+ */
+template<typename T>
+struct OpSlabAlloc {
+    typedef T value_type;
+
+    std::weak_ptr<OpSlab> wslab;
+
+    explicit OpSlabAlloc(const std::weak_ptr<OpSlab>& wslab) :wslab(wslab) {}
+    template<typename U>
+    OpSlabAlloc(const OpSlabAlloc<U>& o) :wslab(o.wslab) {}
+
+    T* allocate(size_t n) {
+        if(n==1u) {
+            if(auto slab = wslab.lock())
+                return static_cast<T*>(slab->allocate(sizeof(T)));
+        }
+        return static_cast<T*>(::operator new(n*sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        if(n==1u) {
+            if(auto slab = wslab.lock()) {
+                slab->deallocate(p, sizeof(T));
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+    template<typename U>
+    bool operator==(const OpSlabAlloc<U>& o) const { return !wslab.owner_before(o.wslab) && !o.wslab.owner_before(wslab); }
+    template<typename U>
+    bool operator!=(const OpSlabAlloc<U>& o) const { return !(*this==o); }
+};
+
+//! std::allocate_shared() through slab, which may be NULL
+template<typename T, typename... Args>
+std::shared_ptr<T> allocateOp(const std::shared_ptr<OpSlab>& slab, Args&&... args)
+{
+    if(slab)
+        return std::allocate_shared<T>(OpSlabAlloc<T>(slab), std::forward<Args>(args)...);
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+} // namespace impl
+} // namespace pvxs
+
+#endif // OPSLAB_H
@@ -137,6 +137,26 @@ int recvfromx::call()
     }
 }
 
+int recvfromx::call_many(recvfromx* rx, size_t n)
+{
+    size_t i;
+    for(i=0; i<n; i++) {
+        if((rx[i].nrx = rx[i].call())<0)
+            break;
+    }
+    return i ? int(i) : -1;
+}
+
+int sendtox::call_many(evutil_socket_t sock, const sendtox* tx, size_t n)
+{
+    size_t i;
+    for(i=0; i<n; i++) {
+        if(sendto(sock, (char*)tx[i].buf, tx[i].buflen, 0, &(*tx[i].dst)->sa, tx[i].dst->size()) < 0)
+            break;
+    }
+    return i ? int(i) : -1;
+}
+
 namespace impl {
 
 #ifndef GAA_FLAG_INCLUDE_ALL_INTERFACES
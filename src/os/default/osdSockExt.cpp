@@ -106,100 +106,194 @@ void evsocket::enable_IP_PKTINFO() const
     }
 }
 
-int recvfromx::call()
-{
-    msghdr msg{};
-
-    iovec iov = {buf, buflen};
-    msg.msg_iov = &iov;
-    msg.msg_iovlen = 1u;
+namespace {
 
-    msg.msg_name = &(*src)->sa;
-    msg.msg_namelen = src ? src->size() : 0u;
-
-    alignas (cmsghdr) char cbuf[0u
+constexpr size_t rx_cbuf_size = 0u
 #ifdef SO_RXQ_OVFL
-            + CMSG_SPACE(sizeof(ndrop))
+        + CMSG_SPACE(sizeof(recvfromx::ndrop))
 #endif
-            // only need space for IPv4 option(s) or IPv6 option, never both.
-            + impl::cmax(0
+        // only need space for IPv4 option(s) or IPv6 option, never both.
+        + impl::cmax(0
 #ifdef IP_PKTINFO
-            + CMSG_SPACE(sizeof(in_pktinfo))
+        + CMSG_SPACE(sizeof(in_pktinfo))
 #else
 #  if defined(IP_ORIGDSTADDR)
-            + CMSG_SPACE(sizeof(sockaddr_in))
+        + CMSG_SPACE(sizeof(sockaddr_in))
 #  endif
 #  if defined(IP_RECVIF)
-            + CMSG_SPACE(sizeof(sockaddr_dl))
+        + CMSG_SPACE(sizeof(sockaddr_dl))
 #  endif
 #endif
-                  ,0
-            + CMSG_SPACE(sizeof(in6_pktinfo))
-                  ) // cmax
-            ];
-    msg.msg_control = cbuf;
-    msg.msg_controllen = sizeof(cbuf);
-
-    if(dst)
-        *dst = SockAddr();
-    dstif = -1;
-    ndrop = 0u;
+              ,0
+        + CMSG_SPACE(sizeof(in6_pktinfo))
+              ) // cmax
+        ;
+
+// storage referenced by a msghdr for one recvfromx
+struct RxMsg {
+    iovec iov;
+    alignas (cmsghdr) char cbuf[rx_cbuf_size];
+
+    void prepare(recvfromx& rx, msghdr& msg)
+    {
+        iov = {rx.buf, rx.buflen};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1u;
+
+        msg.msg_name = &(*rx.src)->sa;
+        msg.msg_namelen = rx.src ? rx.src->size() : 0u;
+
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+
+        if(rx.dst)
+            *rx.dst = SockAddr();
+        rx.dstif = -1;
+        rx.ndrop = 0u;
+    }
+};
 
-    int ret = recvmsg(sock, &msg, 0);
+// on success, check for control messages
+void rx_complete(recvfromx& rx, msghdr& msg)
+{
+    auto dst = rx.dst;
+    auto& dstif = rx.dstif;
+    auto& ndrop = rx.ndrop;
 
-    if(ret>=0) { // on success, check for control messages
-        if(msg.msg_flags & MSG_CTRUNC)
-            log_warn_printf(log, "MSG_CTRUNC, expand buffer %zu <- %zu\n", size_t(msg.msg_controllen), sizeof(cbuf));
+    if(msg.msg_flags & MSG_CTRUNC)
+        log_warn_printf(log, "MSG_CTRUNC, expand buffer %zu <- %zu\n", size_t(msg.msg_controllen), rx_cbuf_size);
 
-        for(cmsghdr *hdr = CMSG_FIRSTHDR(&msg); hdr ; hdr = CMSG_NXTHDR(&msg, hdr)) {
-            if(0) {}
+    for(cmsghdr *hdr = CMSG_FIRSTHDR(&msg); hdr ; hdr = CMSG_NXTHDR(&msg, hdr)) {
+        if(0) {}
 #ifdef SO_RXQ_OVFL
-            else if(hdr->cmsg_level==SOL_SOCKET && hdr->cmsg_type==SO_RXQ_OVFL && hdr->cmsg_len>=CMSG_LEN(sizeof(ndrop))) {
-                memcpy(&ndrop, CMSG_DATA(hdr), sizeof(ndrop));
-            }
+        else if(hdr->cmsg_level==SOL_SOCKET && hdr->cmsg_type==SO_RXQ_OVFL && hdr->cmsg_len>=CMSG_LEN(sizeof(ndrop))) {
+            memcpy(&ndrop, CMSG_DATA(hdr), sizeof(ndrop));
+        }
 #endif
 #ifdef IP_PKTINFO
-            else if(hdr->cmsg_level==IPPROTO_IP && hdr->cmsg_type==IP_PKTINFO && hdr->cmsg_len>=CMSG_LEN(sizeof(in_pktinfo))) {
-                if(dst) {
-                    (*dst)->in.sin_family = AF_INET;
-                    memcpy(&(*dst)->in.sin_addr, CMSG_DATA(hdr) + offsetof(in_pktinfo, ipi_addr), sizeof(in_addr_t));
-                }
-
-                decltype(in_pktinfo::ipi_ifindex) idx;
-                memcpy(&idx, CMSG_DATA(hdr) + offsetof(in_pktinfo, ipi_ifindex), sizeof(idx));
-                dstif = idx;
+        else if(hdr->cmsg_level==IPPROTO_IP && hdr->cmsg_type==IP_PKTINFO && hdr->cmsg_len>=CMSG_LEN(sizeof(in_pktinfo))) {
+            if(dst) {
+                (*dst)->in.sin_family = AF_INET;
+                memcpy(&(*dst)->in.sin_addr, CMSG_DATA(hdr) + offsetof(in_pktinfo, ipi_addr), sizeof(in_addr_t));
             }
 
+            decltype(in_pktinfo::ipi_ifindex) idx;
+            memcpy(&idx, CMSG_DATA(hdr) + offsetof(in_pktinfo, ipi_ifindex), sizeof(idx));
+            dstif = idx;
+        }
+
 #else
 #  ifdef IP_ORIGDSTADDR
-            else if(dst && hdr->cmsg_level==IPPROTO_IP && hdr->cmsg_type==IP_ORIGDSTADDR && hdr->cmsg_len>=CMSG_LEN(sizeof(sockaddr_in))) {
-                memcpy(&(*dst)->in, CMSG_DATA(hdr), sizeof(sockaddr_in));
-            }
+        else if(dst && hdr->cmsg_level==IPPROTO_IP && hdr->cmsg_type==IP_ORIGDSTADDR && hdr->cmsg_len>=CMSG_LEN(sizeof(sockaddr_in))) {
+            memcpy(&(*dst)->in, CMSG_DATA(hdr), sizeof(sockaddr_in));
+        }
 #  endif
 #  ifdef IP_RECVIF
-            else if(dst && hdr->cmsg_level==IPPROTO_IP && hdr->cmsg_type==IP_RECVIF && hdr->cmsg_len>=CMSG_LEN(sizeof(sockaddr_dl))) {
-                decltype (sockaddr_dl::sdl_index) idx;
-                memcpy(&idx, CMSG_DATA(hdr) + offsetof(sockaddr_dl, sdl_index), sizeof(idx));
-                dstif = idx;
-            }
+        else if(dst && hdr->cmsg_level==IPPROTO_IP && hdr->cmsg_type==IP_RECVIF && hdr->cmsg_len>=CMSG_LEN(sizeof(sockaddr_dl))) {
+            decltype (sockaddr_dl::sdl_index) idx;
+            memcpy(&idx, CMSG_DATA(hdr) + offsetof(sockaddr_dl, sdl_index), sizeof(idx));
+            dstif = idx;
+        }
 #  endif
 #endif
-            else if(hdr->cmsg_level==IPPROTO_IPV6 && hdr->cmsg_type==IPV6_PKTINFO && hdr->cmsg_len>=CMSG_LEN(sizeof(in6_pktinfo))) {
-                if(dst) {
-                    (*dst)->in6.sin6_family = AF_INET6;
-                    memcpy(&(*dst)->in6.sin6_addr, CMSG_DATA(hdr) + offsetof(in6_pktinfo, ipi6_addr), sizeof(in6_addr));
-                }
-
-                decltype(in6_pktinfo::ipi6_ifindex) idx;
-                memcpy(&idx, CMSG_DATA(hdr) + offsetof(in6_pktinfo, ipi6_ifindex), sizeof(idx));
-                dstif = idx;
+        else if(hdr->cmsg_level==IPPROTO_IPV6 && hdr->cmsg_type==IPV6_PKTINFO && hdr->cmsg_len>=CMSG_LEN(sizeof(in6_pktinfo))) {
+            if(dst) {
+                (*dst)->in6.sin6_family = AF_INET6;
+                memcpy(&(*dst)->in6.sin6_addr, CMSG_DATA(hdr) + offsetof(in6_pktinfo, ipi6_addr), sizeof(in6_addr));
             }
+
+            decltype(in6_pktinfo::ipi6_ifindex) idx;
+            memcpy(&idx, CMSG_DATA(hdr) + offsetof(in6_pktinfo, ipi6_ifindex), sizeof(idx));
+            dstif = idx;
         }
     }
+}
+
+} // namespace
+
+int recvfromx::call()
+{
+    msghdr msg{};
+    RxMsg store;
+    store.prepare(*this, msg);
+
+    int ret = recvmsg(sock, &msg, 0);
+
+    if(ret>=0)
+        rx_complete(*this, msg);
 
+    nrx = ret;
     return ret;
 }
 
+int recvfromx::call_many(recvfromx* rx, size_t n)
+{
+#ifdef __linux__
+    constexpr size_t max_batch = 16u;
+    if(n > max_batch)
+        n = max_batch;
+
+    RxMsg store[max_batch];
+    mmsghdr msgs[max_batch];
+    memset(msgs, 0, sizeof(msgs[0])*n);
+
+    for(size_t i=0; i<n; i++)
+        store[i].prepare(rx[i], msgs[i].msg_hdr);
+
+    int ret = recvmmsg(rx[0].sock, msgs, n, MSG_DONTWAIT, nullptr);
+
+    for(int i=0; i<ret; i++) {
+        rx[i].nrx = int(msgs[i].msg_len);
+        rx_complete(rx[i], msgs[i].msg_hdr);
+    }
+    if(ret<=0) {
+        rx[0].nrx = -1;
+        ret = -1;
+    }
+    return ret;
+
+#else
+    size_t i;
+    for(i=0; i<n; i++) {
+        if(rx[i].call()<0)
+            break;
+    }
+    return i ? int(i) : -1;
+#endif
+}
+
+int sendtox::call_many(evutil_socket_t sock, const sendtox* tx, size_t n)
+{
+#ifdef __linux__
+    constexpr size_t max_batch = 16u;
+    if(n > max_batch)
+        n = max_batch;
+
+    iovec iov[max_batch];
+    mmsghdr msgs[max_batch];
+    memset(msgs, 0, sizeof(msgs[0])*n);
+
+    for(size_t i=0; i<n; i++) {
+        iov[i] = {const_cast<void*>(tx[i].buf), tx[i].buflen};
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1u;
+        msgs[i].msg_hdr.msg_name = const_cast<sockaddr*>(&(*tx[i].dst)->sa);
+        msgs[i].msg_hdr.msg_namelen = tx[i].dst->size();
+    }
+
+    int ret = sendmmsg(sock, msgs, n, MSG_DONTWAIT);
+    return ret<=0 ? -1 : ret;
+
+#else
+    size_t i;
+    for(i=0; i<n; i++) {
+        if(sendto(sock, (char*)tx[i].buf, tx[i].buflen, 0, &(*tx[i].dst)->sa, tx[i].dst->size()) < 0)
+            break;
+    }
+    return i ? int(i) : -1;
+#endif
+}
+
 namespace impl {
 
 decltype (IfaceMap::byIndex) IfaceMap::_refresh() {
@@ -48,6 +48,7 @@ struct PVXS_API SockAddr {
     };
 private:
     store_t  store;
+    bool parseAddress(const char *name, unsigned short defport, bool lookup);
 public:
 
     explicit SockAddr(int af = AF_UNSPEC);
@@ -72,6 +73,9 @@ public:
     inline void setAddress(const std::string& s, unsigned short port=0) {
         setAddress(s.c_str(), port);
     }
+    //! As setAddress(), but never a (slow) DNS lookup.
+    //! @returns false, with no change, if not a numeric IP address.
+    bool setNumericAddress(const char *, unsigned short port=0);
 
     bool isAny() const noexcept;
     bool isLO() const noexcept;
@@ -149,6 +153,9 @@ struct PVXS_API SockEndpoint {
     explicit SockEndpoint(const SockAddr& addr) :addr(addr) {}
 
     MCastMembership resolve() const;
+
+    //! If the address of this (unparsed) endpoint is a host name, which would need a DNS lookup.
+    static bool isHostName(const std::string& ep);
 };
 
 PVXS_API
@@ -209,9 +216,33 @@ struct recvfromx {
     SockAddr* dst;  // if enable_IP_PKTINFO()
     int64_t dstif;  // if enable_IP_PKTINFO(), destination interface index
     uint32_t ndrop; // if enable_SO_RXQ_OVFL()
+    int nrx;        // set by call_many()
 
     PVXS_API
     int call();
+
+    /** Receive up to n datagrams from one socket.  With one recvmmsg() where available,
+     *  otherwise by repeated call().  All rx[i].sock must be the same.
+     *
+     *  @returns The number of entries filled, each with rx[i].nrx set,
+     *           or -1 if none were received.
+     */
+    PVXS_API
+    static int call_many(recvfromx* rx, size_t n);
+};
+
+struct sendtox {
+    const void *buf;
+    size_t buflen;
+    const SockAddr* dst;
+
+    /** Send n datagrams from sock.  With one sendmmsg() where available,
+     *  otherwise by repeated sendto().
+     *
+     *  @returns The number of entries sent, or -1 if tx[0] could not be sent.
+     */
+    PVXS_API
+    static int call_many(evutil_socket_t sock, const sendtox* tx, size_t n);
 };
 
 } // namespace pvxs
@@ -10,6 +10,8 @@
 #include <compilerDependencies.h>
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <type_traits>
@@ -18,6 +20,7 @@
 #include <type_traits>
 
 #include <epicsEndian.h>
+#include <epicsMutex.h>
 
 #include <event2/buffer.h>
 #include <pvxs/version.h>
@@ -28,6 +31,79 @@ namespace pvxs {namespace impl {
 
 constexpr bool hostBE{EPICS_BYTE_ORDER==EPICS_ENDIAN_BIG};
 
+//! Arrays of at least this many bytes, already in the wire byte order,
+//! may be sent by reference instead of being copied.  cf. Buffer::appendRef()
+//! Also the smallest received array for which ArrayPool is consulted.
+constexpr size_t minRefBytes = 4096u;
+
+//! Largest initial EvOutBuf reservation predicted from the size of a previous message.
+constexpr size_t maxTxHint = 4u*minRefBytes;
+
+//! Arrays which must be copied, and which will occupy at least this many bytes,
+//! may be encoded concurrently.  cf. Buffer::encodeAside()
+constexpr size_t minAsideBytes = 256u*minRefBytes;
+
+/** Copy nbytes from src to dest, reversing the byte order of each element of esize bytes.
+ *
+ * esize must be 2, 4, or 8.  dest may be the same as src, but must not otherwise overlap.
+ * Uses SSSE3, AVX2, or NEON when available on the running CPU.
+ */
+PVXS_API
+void bswapArray(void* dest, const void* src, size_t nbytes, size_t esize);
+
+/** Recycles the storage of large received arrays.
+ *
+ * Successive updates of one subscription usually carry arrays of the same size.
+ * Allocating a fresh multi-megabyte block for each one costs page faults as
+ * the kernel supplies (and zeros) new pages.  Arrays allocated through
+ * an ArrayPool return their block to the pool when the last reference
+ * is released, from whichever thread that happens on.  Up to 'limit'
+ * spare blocks are retained.
+ *
+ * With an ArrayAllocator, blocks come from it, and all arrays of plain
+ * element types are allocated through the pool regardless of size.
+ */
+struct PVXS_API ArrayPool : public std::enable_shared_from_this<ArrayPool> {
+    const size_t limit;
+    const std::shared_ptr<ArrayAllocator> alloc;
+
+    explicit ArrayPool(size_t limit, const std::shared_ptr<ArrayAllocator>& alloc = nullptr)
+        :limit(limit)
+        ,alloc(alloc)
+    {}
+    ~ArrayPool();
+    ArrayPool(const ArrayPool&) = delete;
+    ArrayPool& operator=(const ArrayPool&) = delete;
+
+    //! Allocate an uninitialized array of count elements, re-using a spare block of the same size if available.
+    template<typename E>
+    shared_array<E> allocate(size_t count) {
+        static_assert(std::is_pod<E>::value, "Only for plain element types");
+        const size_t nbytes = count*sizeof(E);
+        return shared_array<E>(static_cast<E*>(take(nbytes)),
+                               Release{shared_from_this(), alloc, nbytes},
+                               count);
+    }
+
+    //! Number of spare blocks currently retained
+    size_t spares() const;
+
+private:
+    struct Release {
+        std::weak_ptr<ArrayPool> pool;
+        // may outlive the pool
+        std::shared_ptr<ArrayAllocator> alloc;
+        size_t nbytes;
+        void operator()(void* mem) const;
+    };
+
+    void* take(size_t nbytes);
+
+    mutable epicsMutex lock;
+    // spare blocks, as (size, ptr)
+    std::vector<std::pair<size_t, void*>> blocks;
+};
+
 //! view of a slice of a buffer.
 //! Don't use directly.  cf. FixedBuf
 struct PVXS_API Buffer {
@@ -47,6 +123,23 @@ protected:
     constexpr Buffer(bool be, uint8_t* buf, size_t n) :pos(buf), limit(buf+n), be(be) {}
     virtual ~Buffer() {}
 public:
+    /** Append nbytes from mem, which must remain valid and unchanged while 'hold' is alive, by reference.
+     *
+     * Returns false if appending by reference is not supported, in which case nothing is done
+     * and the caller must copy.
+     */
+    virtual bool appendRef(const void* mem, size_t nbytes, const std::shared_ptr<const void>& hold);
+
+    /** Arrange for fn() to encode approximately nbytes, in place of the current position,
+     *  possibly concurrently with further encoding into this buffer.
+     *
+     * fn() is passed a separate Buffer with the same byte order, and must capture
+     * by value anything it references.
+     * Returns false if not supported, in which case nothing is done
+     * and the caller must encode in place.
+     */
+    virtual bool encodeAside(size_t nbytes, std::function<void(Buffer&)>&& fn);
+
     Buffer(const Buffer&) = delete;
     Buffer& operator=(const Buffer&) = delete;
     bool be;
@@ -126,24 +219,46 @@ public:
     size_t consumed() const { return pos - backing.data(); }
 };
 
-//! serialize into an evbuffer, resizing as necessary
+/** serialize into an evbuffer, resizing as necessary
+ *
+ * isize is an initial reservation, which may be predicted from a previous message.
+ * Only the space actually used is committed.  cf. maxTxHint
+ *
+ * With parallel=true, large arrays are encoded by a process wide pool of helper threads
+ * into separate evbuffers, which are moved (not copied) into the destination,
+ * in order, by the destructor.  cf. encodeAside() and minAsideBytes
+ */
 class PVXS_API EvOutBuf : public Buffer
 {
     typedef Buffer base_type;
-    evbuffer * const backing;
+    evbuffer * const dest;
+    evbuffer * backing; // dest, or the tail of the last Aside
     uint8_t* base; // original pos
 public:
+    struct Aside;
+private:
+    const bool parallel;
+    std::vector<std::shared_ptr<Aside>> asides;
+public:
 
-    EvOutBuf(bool be, evbuffer *b, size_t isize=0)
+    EvOutBuf(bool be, evbuffer *b, size_t isize=0, bool parallel=false)
         :base_type(be, nullptr, 0)
+        ,dest(b)
         ,backing(b)
         ,base(nullptr)
+        ,parallel(parallel)
     {refill(isize);}
     virtual ~EvOutBuf();
     virtual bool refill(size_t more) override final;
+    virtual bool appendRef(const void* mem, size_t nbytes, const std::shared_ptr<const void>& hold) override final;
+    virtual bool encodeAside(size_t nbytes, std::function<void(Buffer&)>&& fn) override final;
 };
 
-//! deserialize from an evbuffer, possibly segmented
+/** deserialize from an evbuffer, possibly segmented
+ *
+ * A small backing buffer is made contiguous on the first refill(),
+ * so that decoding a typical message never needs another refill().
+ */
 class PVXS_API EvInBuf : public Buffer
 {
     typedef Buffer base_type;
@@ -315,9 +430,9 @@ void to_wire(Buffer& buf, const char *s)
     if(!buf.ensure(len.size)) {
         buf.fault(__FILE__, __LINE__);
 
-    } else {
-        for(size_t i=0; i<len.size; i++)
-            buf.push(s[i]);
+    } else if(len.size) {
+        memcpy(buf.save(), s, len.size);
+        buf._skip(len.size);
     }
 
 }
@@ -339,7 +454,8 @@ void from_wire(Buffer& buf, std::string& s)
         buf.fault(__FILE__, __LINE__);
 
     } else {
-        s = std::string((char*)buf.save(), len.size);
+        // re-uses capacity of s
+        s.assign((const char*)buf.save(), len.size);
         buf._skip(len.size);
     }
 }
@@ -411,13 +527,11 @@ void from_wire(Buffer& buf, Status& sts)
     }
 }
 
+// array elements, without the leading Size
 template<typename E, typename C = E>
 static inline
-void to_wire(Buffer& buf, const shared_array<const void>& varr)
+void to_wire_elements(Buffer& buf, const shared_array<const E>& arr)
 {
-    auto arr = varr.castTo<const E>();
-    to_wire(buf, Size{arr.size()});
-
     if(std::is_pod<C>::value) {
         // optimize handling of types with fixed element size
 
@@ -432,18 +546,11 @@ void to_wire(Buffer& buf, const shared_array<const void>& varr)
             // rounds down to element size.  requires sizeof(C) by a power of 2
             size_t nbytes = std::min(buf.size(), nremain)&~(sizeof(C)-1u);
 
-            if(buf.be==hostBE) { // already in native order, just copy
+            if(buf.be==hostBE || sizeof(C)==1u) { // already in native order, just copy
                 memcpy(buf.save(), src, nbytes);
 
             } else { // must swap byte order
-                auto dest = buf.save();
-
-                for(size_t i=0; i<nbytes; i+=sizeof(C)) {
-                    for(size_t n=0u; n<sizeof(C); n++) {
-                        dest[i + sizeof(C)-1-n] = src[i + n];
-
-                    }
-                }
+                bswapArray(buf.save(), src, nbytes, sizeof(C));
             }
 
             src += nbytes;
@@ -451,8 +558,13 @@ void to_wire(Buffer& buf, const shared_array<const void>& varr)
             nremain -= nbytes;
         }
 
+    } else if(std::is_same<E, C>::value) {
+        // handle variable size element types.  eg. std::string without a temporary copy
+        for(auto i : range(arr.size())) {
+            to_wire(buf, reinterpret_cast<const C&>(arr[i]));
+        }
+
     } else {
-        // handle variable size element types
         for(auto i : range(arr.size())) {
             to_wire(buf, C(arr[i]));
         }
@@ -461,11 +573,53 @@ void to_wire(Buffer& buf, const shared_array<const void>& varr)
 
 template<typename E, typename C = E>
 static inline
-void from_wire(Buffer& buf, shared_array<const void>& varr)
+void to_wire(Buffer& buf, const shared_array<const void>& varr)
+{
+    auto arr = varr.castTo<const E>();
+    to_wire(buf, Size{arr.size()});
+
+    // for variable size elements, a rough estimate
+    const size_t nbytes = arr.size()*sizeof(C);
+
+    if(std::is_pod<C>::value && std::is_same<E, C>::value && buf.be==hostBE
+            && nbytes >= minRefBytes
+            && buf.appendRef(arr.data(), nbytes, arr.dataPtr()))
+    {
+        // large array in native byte order sent without copying
+
+    } else if(nbytes >= minAsideBytes
+              && buf.encodeAside(nbytes, [arr](Buffer& aside) { to_wire_elements<E, C>(aside, arr); }))
+    {
+        // large array to be swapped, or converted, concurrently
+
+    } else {
+        to_wire_elements<E, C>(buf, arr);
+    }
+}
+
+template<typename E, typename std::enable_if<std::is_pod<E>::value, int>::type =0>
+static inline
+shared_array<E> allocRxArray(size_t count, ArrayPool* pool)
+{
+    if(pool && (pool->alloc || count*sizeof(E) >= minRefBytes))
+        return pool->allocate<E>(count);
+    return shared_array<E>(count);
+}
+
+template<typename E, typename std::enable_if<!std::is_pod<E>::value, int>::type =0>
+static inline
+shared_array<E> allocRxArray(size_t count, ArrayPool*)
+{
+    return shared_array<E>(count);
+}
+
+template<typename E, typename C = E>
+static inline
+void from_wire(Buffer& buf, shared_array<const void>& varr, ArrayPool* pool=nullptr)
 {
     Size slen{};
     from_wire(buf, slen);
-    shared_array<E> arr(slen.size);
+    shared_array<E> arr(allocRxArray<E>(slen.size, pool));
 
     if(std::is_pod<C>::value) {
         // optimize handling of types with fixed element size
@@ -481,18 +635,11 @@ void from_wire(Buffer& buf, shared_array<const void>& varr)
             // rounds down to element size.  requires sizeof(C) by a power of 2
             size_t nbytes = std::min(buf.size(), nremain)&~(sizeof(C)-1u);
 
-            if(buf.be==hostBE) { // already in native order, just copy
+            if(buf.be==hostBE || sizeof(C)==1u) { // already in native order, just copy
                 memcpy(dest, buf.save(), nbytes);
 
             } else { // must swap byte order
-                auto src = buf.save();
-
-                for(size_t i=0; i<nbytes; i+=sizeof(C)) {
-                    for(size_t n=0u; n<sizeof(C); n++) {
-                        dest[i + sizeof(C)-1-n] = src[i + n];
-
-                    }
-                }
+                bswapArray(dest, buf.save(), nbytes, sizeof(C));
             }
 
             dest += nbytes;
@@ -500,6 +647,14 @@ void from_wire(Buffer& buf, shared_array<const void>& varr)
             nremain -= nbytes;
         }
 
+    } else if(std::is_same<E, C>::value) {
+        // decode in place.  eg. each std::string allocated once, not copied from a temporary
+        for(auto i : range(arr.size())) {
+            from_wire(buf, reinterpret_cast<C&>(arr[i]));
+            if(!buf.good())
+                break;
+        }
+
     } else {
         for(auto i : range(arr.size())) {
             C temp{};
@@ -526,7 +681,8 @@ struct pva_version {
 
 /* values from flags field of header
  * flags[0] - 0 app, 1 control
- * flags[1:3] - unused
+ * flags[1:2] - unused
+ * flags[3] - 1 - body is LZ4 compressed (pvxs extension, only sent to peers advertising pva_qos::LZ4)
  * flags[4:5] - 00 - not segmented, 01 - first segment, 11 - middle segment, 10 - last segment
  * flags[6] - 0 - client, 1 - server
  * flags[7] - 0 - LSB, 1 - MSB
@@ -534,6 +690,7 @@ struct pva_version {
 struct pva_flags {
     enum type_t : uint8_t {
         Control = 0x01,
+        Compressed = 0x08,
         SegNone = 0x00,
         SegFirst= 0x10,
         SegLast = 0x20,
@@ -543,6 +700,28 @@ struct pva_flags {
     };
 };
 
+/* QoS bits of client CONNECTION_VALIDATION reply.
+ * Otherwise unused, and sent as zero by other implementations.
+ */
+struct pva_qos {
+    enum type_t : uint16_t {
+        // pvxs extension.  Client can decode pva_flags::Compressed
+        LZ4 = 0x4000,
+        // pvxs extension.  Client can decode MONITOR updates with array patches (subcmd 0x20)
+        ArrayDelta = 0x2000,
+        // pvxs extension.  Server accepts CREATE_CHANNEL with more than one channel.
+        // Sent by a server, after the auth. methods of CONNECTION_VALIDATION.
+        MultiCreate = 0x1000,
+        // pvxs extension.  Server accepts a GET/PUT EXEC sent before the INIT reply (subcmd 0x04),
+        // with a PUT value preceded by the type description the client expects.
+        EarlyExec = 0x0800,
+        // pvxs extension.  Peer relies on TCP keepalive to detect a dead connection.
+        // Sent by a server, and echoed by a client, when both have tcpKeepAlive.
+        // Then neither side times out an idle connection, and the client need not send periodic ECHO.
+        KeepAlive = 0x0400,
+    };
+};
+
 struct pva_ctrl_msg {
     enum type_t : uint8_t {
         SetMarker = 0,
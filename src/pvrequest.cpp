@@ -4,12 +4,20 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <list>
+#include <map>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
 #include "pvrequest.h"
 #include "dataimpl.h"
 
 namespace pvxs {
 namespace impl {
 
+typedef epicsGuard<epicsMutex> Guard;
+
 BitMask request2mask(const FieldDesc* desc, const Value& pvRequest)
 {
     auto fields = pvRequest["field"];
@@ -71,6 +79,61 @@ BitMask request2mask(const FieldDesc* desc, const Value& pvRequest)
     return ret;
 }
 
+namespace {
+struct MaskCache {
+    // Number of entries to keep
+    static constexpr size_t limit = 64u;
+
+    typedef std::pair<const FieldDesc*, const FieldDesc*> key_t;
+    struct Entry {
+        // hold references to the key types, so that their addresses are not re-used while cached
+        std::shared_ptr<const FieldDesc> type, reqType;
+        std::shared_ptr<const BitMask> mask;
+    };
+
+    epicsMutex lock;
+    // most recently used first
+    std::list<Entry> lru;
+    std::map<key_t, std::list<Entry>::iterator> entries;
+};
+} // namespace
+
+std::shared_ptr<const BitMask> request2maskCached(const std::shared_ptr<const FieldDesc>& desc, const Value& pvRequest)
+{
+    static MaskCache cache;
+
+    auto reqType(Value::Helper::type(pvRequest));
+    const MaskCache::key_t key(desc.get(), reqType.get());
+    {
+        Guard G(cache.lock);
+        auto it(cache.entries.find(key));
+        if(it!=cache.entries.end()) {
+            cache.lru.splice(cache.lru.begin(), cache.lru, it->second);
+            return it->second->mask;
+        }
+    }
+
+    // compute outside of lock.  May throw.
+    std::shared_ptr<const BitMask> mask(std::make_shared<BitMask>(request2mask(desc.get(), pvRequest)));
+
+    Guard G(cache.lock);
+    auto it(cache.entries.find(key));
+    if(it!=cache.entries.end()) { // concurrent miss
+        cache.lru.splice(cache.lru.begin(), cache.lru, it->second);
+
+    } else {
+        cache.lru.push_front(MaskCache::Entry{desc, reqType, mask});
+        cache.entries[key] = cache.lru.begin();
+
+        if(cache.lru.size() > MaskCache::limit) {
+            auto& last = cache.lru.back();
+            cache.entries.erase(MaskCache::key_t(last.type.get(), last.reqType.get()));
+            cache.lru.pop_back();
+        }
+    }
+    return mask;
+}
+
 bool testmask(const Value& update, const BitMask& mask)
 {
     auto desc = Value::Helper::desc(update);
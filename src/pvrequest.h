@@ -16,6 +16,13 @@ namespace impl {
 PVXS_API
 BitMask request2mask(const FieldDesc* desc, const Value& pvRequest);
 
+/* Memoized request2mask().  Recently used pairs of type and pvRequest type are remembered.
+ * Received pvRequest types are interned (cf. internType()), so identical requests
+ * on the same prototype share one result.
+ */
+PVXS_API
+std::shared_ptr<const BitMask> request2maskCached(const std::shared_ptr<const FieldDesc>& desc, const Value& pvRequest);
+
 PVXS_API
 bool testmask(const Value& update, const BitMask& mask);
 
@@ -76,15 +76,33 @@ struct PVXS_API Timeout : public std::runtime_error
     virtual ~Timeout();
 };
 
+/** Classification of a Result, or of an entry de-queued by Subscription::tryPop(),
+ *  which does not require (re)throwing an exception.
+ *
+ *  @since 1.3.0
+ */
+enum class Event : uint8_t {
+    Empty,       //!< Nothing.  eg. Subscription queue is empty
+    Data,        //!< Success.  A Value, which is empty for a put()
+    Connected,   //!< Subscription has (re)connected.  cf. Connected
+    Disconnect,  //!< Connection to server was lost.  cf. Disconnect
+    Finished,    //!< Subscription has completed normally.  cf. Finished
+    RemoteError, //!< Error signaled by server.  cf. RemoteError
+    Error,       //!< Some other error.
+};
+PVXS_API
+std::ostream& operator<<(std::ostream& strm, Event evt);
+
 //! Holder for a Value or an exception
 class Result {
     Value _result;
     std::exception_ptr _error;
     std::string _peerName;
+    Event _kind = Event::Empty;
 public:
     Result() = default;
-    Result(Value&& val, const std::string& peerName) :_result(std::move(val)), _peerName(peerName) {}
-    explicit Result(const std::exception_ptr& err) :_error(err) {}
+    Result(Value&& val, const std::string& peerName) :_result(std::move(val)), _peerName(peerName), _kind(Event::Data) {}
+    explicit Result(const std::exception_ptr& err, Event kind=Event::Error) :_error(err), _kind(err ? kind : Event::Empty) {}
 
     //! Access to the Value, or rethrow the exception
     Value& operator()() {
@@ -97,6 +115,26 @@ public:
 
     bool error() const { return !!_error; }
     explicit operator bool() const { return _result || _error; }
+
+    /** Access without throwing.  eg. when many operations may fail at once.
+     *
+     * @code
+     * switch(result.kind()) {
+     * case Event::Data: use(result.value()); break;
+     * case Event::Disconnect: ... break;
+     * default: ... // rethrow result.exception() only if details are needed
+     * }
+     * @endcode
+     *
+     * @since 1.3.0
+     */
+    Event kind() const { return _kind; }
+    //! The Value.  Empty on error.  Does not throw.
+    //! @since 1.3.0
+    const Value& value() const { return _result; }
+    //! The error.  nullptr on success.  Does not throw.
+    //! @since 1.3.0
+    const std::exception_ptr& exception() const { return _error; }
 };
 
 //! Handle for in-progress operation
@@ -150,13 +188,98 @@ protected:
 public:
 #ifdef PVXS_EXPERT_API_ENABLED
     // usable when Builder::autoExec(false)
-    // For GET/PUT, (re)issue request for current value
+    // For GET/PUT, (re)issue request for current value.
+    // For GET, requests made before INIT completes, or while a previous request is
+    // in progress, are queued and sent in order.  cf. GetBuilder::execPipeline()
     inline void reExecGet(std::function<void(client::Result&&)>&& resultcb) { this->_reExecGet(std::move(resultcb)); }
-    // For PUT (re)issue request to set current value
+    // For PUT (re)issue request to set current value.
+    // Requests made before INIT completes, or while a previous request is in progress,
+    // are queued and sent in order.  cf. PutBuilder::execPipeline()
+    // resultcb may be NULL when completion of this particular request is not of interest.
     inline void reExecPut(const Value& arg, std::function<void(client::Result&&)>&& resultcb) { this->_reExecPut(arg, std::move(resultcb)); }
 #endif
 };
 
+/** Handle for the eventual Result of an operation, or of a combination of operations.
+ *
+ * Created by the execFuture() method of GetBuilder, PutBuilder, or RPCBuilder,
+ * or by then(), whenAll(), or whenAny().
+ * Copies refer to the same Result.
+ * Completion is delivered by the callback of the underlying Operation,
+ * without an additional thread, and no OS synchronization primitive is allocated
+ * unless wait() is called before completion.
+ *
+ * An Operation is implicitly cancelled when the last Future referring to it,
+ * directly or through then(), whenAll(), or whenAny(), is destroyed.
+ *
+ * @code
+ * Context ctxt(...);
+ * std::vector<Future> gets;
+ * for(auto& name : names)
+ *     gets.push_back(ctxt.get(name).execFuture());
+ * whenAll(gets).wait(5.0);
+ * for(auto& get : gets)
+ *     std::cout<<get.wait()();
+ * @endcode
+ *
+ * @since 1.3.0
+ */
+class PVXS_API Future {
+public:
+    struct Pvt;
+    //! An empty/invalid Future
+    Future() = default;
+    explicit Future(const std::shared_ptr<Pvt>& pvt) :pvt(pvt) {}
+
+    //! true unless default constructed
+    explicit operator bool() const { return !!pvt; }
+
+    //! true if the Result is available
+    bool ready() const;
+
+    /** Block until completion
+     *
+     * @param timeout Time to wait prior to throwing Timeout.  cf. epicsEvent::wait(double)
+     * @return A copy of the Result.  Use Result::operator()() to access the Value or rethrow an error.
+     * @throws Timeout Timeout exceeded
+     */
+    Result wait(double timeout) const;
+    //! wait(double) without a timeout
+    Result wait() const { return wait(99999999.0); }
+
+    /** Continuation.  fn() is called once with the Result of this Future.
+     *
+     * fn() is called from the thread which completes this Future, usually a client worker
+     * or the Executor given to the builder.  Or, if already complete, from the calling thread.
+     *
+     * @return A Future which completes with the Value returned by fn(), or the exception thrown by fn().
+     */
+    Future then(std::function<Value(Result&&)>&& fn) const;
+
+private:
+    std::shared_ptr<Pvt> pvt;
+    friend struct Pvt;
+};
+
+/** A Future which completes, with an empty Value, when all of futures have completed.
+ *
+ * Errors are not propagated.  The Result of each of futures must be examined individually.
+ * If futures is empty, the returned Future is already complete.
+ *
+ * @throws std::logic_error if any of futures is empty
+ * @since 1.3.0
+ */
+PVXS_API
+Future whenAll(const std::vector<Future>& futures);
+
+/** A Future which completes with a copy of the Result of the first of futures to complete.
+ *
+ * @throws std::logic_error if futures is empty, or if any of futures is empty.
+ * @since 1.3.0
+ */
+PVXS_API
+Future whenAny(const std::vector<Future>& futures);
+
 //! Information about the state of a Subscription
 struct SubscriptionStat {
     //! Number of events in the queue
@@ -225,6 +348,32 @@ public:
      */
     virtual Value pop() =0;
 
+    /** De-queue update or event from subscription event queue, without throwing.
+     *
+     * As pop(), except that Connected, Disconnect, Finished, and errors are returned as an Event
+     * instead of being thrown.  eg. for a consumer of many Subscriptions,
+     * which may all be disconnected at once.
+     *
+     * @param out Set to the Value of an Event::Data entry.  Otherwise cleared.
+     * @param err If not nullptr, set to the exception of any other entry.  Which the caller may rethrow for details.
+     * @returns Event::Empty when the queue is empty.
+     *
+     * @code
+     * Value update;
+     * Event evt;
+     * while((evt = sub.tryPop(update))!=Event::Empty) {
+     *     if(evt==Event::Data) {
+     *         // have data update
+     *     } else if(evt==Event::Disconnect) {
+     *     ...
+     * }
+     * // queue empty
+     * @endcode
+     *
+     * @since 1.3.0
+     */
+    virtual Event tryPop(Value& out, std::exception_ptr* err=nullptr);
+
 protected:
     virtual bool doPop(std::vector<Value>& out, size_t limit=0u) =0;
 public:
@@ -248,6 +397,32 @@ public:
     //! @since 1.1.0
     virtual void stats(SubscriptionStat&, bool reset = false) =0;
 
+protected:
+    virtual Value _latest(uint64_t* version);
+public:
+    /** With MonitorBuilder::latestOnly(), return the most recent data update.
+     *
+     * The returned Value is complete.  Its marked fields are those changed by the updates
+     * received since the Value returned by a previous call with a different version.
+     * The returned Value may be shared with other callers, and should not be modified.
+     * clone() before modifying.
+     *
+     * @param version If not NULL, set to the version() of the returned Value.
+     * @returns The most recent update, or an empty Value before the first update,
+     *          or if latestOnly() was not selected.
+     * @since 1.3.0
+     */
+    inline Value latest(uint64_t* version=nullptr) { return _latest(version); }
+
+    /** With MonitorBuilder::latestOnly(), the number of data updates received.
+     *
+     * Does not lock, so may be polled frequently to detect a change before calling latest().
+     * Always zero if latestOnly() was not selected.
+     *
+     * @since 1.3.0
+     */
+    virtual uint64_t version() const;
+
 protected:
     virtual void _onEvent(std::function<void(Subscription&)>&&) =0;
 public:
@@ -379,6 +554,44 @@ public:
     inline
     GetBuilder info(const std::string& pvname);
 
+    /** Request the present values of many PVs with one call.
+     *
+     * Operations to the same server are created together, so that their requests
+     * are sent as one burst.  The done() callback is called once, from a client worker,
+     * after all operations have completed, with results in the order of names.
+     *
+     * @code
+     * Context ctxt(...);
+     * auto op = ctxt.getMany({"pv:a", "pv:b"}, [](std::vector<Result>&& results) {
+     *               for(auto& result : results) {
+     *                   try {
+     *                       std::cout<<result();
+     *                   }catch(std::exception& e){
+     *                       std::cout<<"Error: "<<e.what()<<"\n";
+     *                   }
+     *               }
+     *           });
+     * // store op until completion.  op->wait() may be used to block.
+     * @endcode
+     *
+     * @param names PV names
+     * @param done Completion callback
+     * @param pvRequest Applied to all operations.  Same syntax as GetBuilder::pvRequest()
+     * @since 1.3.0
+     */
+    std::shared_ptr<Operation> getMany(const std::vector<std::string>& names,
+                                       std::function<void(std::vector<Result>&&)>&& done,
+                                       const std::string& pvRequest = std::string());
+
+    /** Blocking getMany()
+     *
+     * @throws Timeout if all operations have not completed after timeout seconds.
+     * @since 1.3.0
+     */
+    std::vector<Result> getMany(const std::vector<std::string>& names,
+                                double timeout,
+                                const std::string& pvRequest = std::string());
+
     /** Request change/update of PV.
      *
      * Assign certain values to certain fields and block for completion.
@@ -490,6 +703,25 @@ public:
     inline
     MonitorBuilder monitor(const std::string& pvname);
 
+    /** Create a Subscription to each of many PVs, with the same options.
+     *
+     * Equivalent to calling monitor() and MonitorBuilder::exec() for each name,
+     * but crosses to the client worker(s) once, and all new Channels are
+     * searched for together.
+     * The PV name given to 'proto' is ignored.
+     *
+     * @code
+     * std::vector<std::string> names(...);
+     * auto subs(ctxt.monitorMany(names, ctxt.monitor("")
+     *                                        .event([](client::Subscription& sub) { ... })));
+     * // subs[i] is the Subscription to names[i]
+     * @endcode
+     *
+     * @since 1.3.0
+     */
+    std::vector<std::shared_ptr<Subscription>> monitorMany(const std::vector<std::string>& pvnames,
+                                                           const MonitorBuilder& proto);
+
     /** Manually add, and maintain, an entry in the Channel cache.
      *
      * This optional method may be used when it is known that a given PV
@@ -592,6 +824,17 @@ public:
     //! Compile report about peers and channels
     //! @since 0.2.0
     Report report(bool zero=true) const;
+    /** Compile report about peers, and maybe channels.
+     *
+     *  Each connection is visited separately, so a report does not block a worker
+     *  for longer than it takes to visit the channels of one connection.
+     *
+     *  @param zero If true, zero counters after reading
+     *  @param channels If false, omit Report::Connection::channels and Report::Connection::memQueue .
+     *                  Visits only connections, regardless of the number of channels.
+     *  @since 1.3.0
+     */
+    Report report(bool zero, bool channels) const;
 #endif
 
     explicit operator bool() const { return pvt.operator bool(); }
@@ -600,6 +843,14 @@ private:
     std::shared_ptr<Pvt> pvt;
 };
 
+/** Runs client callbacks.  cf. detail::CommonBuilder::executor()
+ *
+ *  Must arrange for the functor to be called once, or destroyed, eg. from a worker thread.
+ *
+ *  @since 1.3.0
+ */
+typedef std::function<void(std::function<void()>&&)> Executor;
+
 namespace detail {
 struct PVRParser;
 
@@ -610,9 +861,11 @@ protected:
     std::string _server;
     struct Req;
     std::shared_ptr<Req> req;
+    Executor _executor;
     unsigned _prio = 0u;
     bool _autoexec = true;
     bool _syncCancel = true;
+    bool _bulk = false;
 
     CommonBase() {}
     CommonBase(const std::shared_ptr<Context::Pvt>& ctx, const std::string& name) : ctx(ctx), _name(name) {}
@@ -661,6 +914,12 @@ public:
      * - block     : bool
      * - process   : bool or string "true", "false", or "passive"
      * - pipeline  : bool
+     * - autoWindow : bool.  With pipeline, size the flow control window from the
+     *                round trip time and the rate of pop() (since 1.3.0).
+     * - compress : string "lz4" or bool.  Monitor only.  A PVXS server will send large updates
+     *              LZ4 compressed, which is transparent to the client (since 1.3.0).
+     * - delta : bool.  Monitor only.  A PVXS server will send a changed numeric array as a patch
+     *           against the previous update when smaller, which is transparent to the client (since 1.3.0).
      *
      * A more efficient alternative to @code pvRequest("record[key=value]") @endcode
      */
@@ -684,9 +943,27 @@ public:
     //! Store raw pvRequest blob.
     SubBuilder& rawRequest(const Value& r) { this->_rawRequest(r); return _sb(); }
 
-    SubBuilder& priority(int p) { this->_prio = p; return _sb(); }
+    /** Channel priority.  Zero (default) or positive.
+     *
+     *  Since 1.3.0, the search for a Channel built by an operation with priority greater than zero
+     *  is urgent.  Urgent names are packed first into each search packet,
+     *  and are retried more often while no server claims them.
+     *  eg. so that interlock or alarm PVs are not delayed behind many other names
+     *  after a server restart.  A Channel shared with another operation is promoted if either is urgent.
+     */
+    SubBuilder& priority(int p) { this->_prio = p<0 ? 0u : unsigned(p); return _sb(); }
     SubBuilder& server(const std::string& s) { this->_server = s; return _sb(); }
 
+    /** Mark this operation as bulk traffic, eg. large arrays.
+     *
+     *  The Channel of a bulk operation connects to its server through a separate TCP connection,
+     *  shared only with other bulk operations.  So that other (latency critical) operations
+     *  to the same server do not queue behind large bulk updates.
+     *
+     *  @since 1.3.0
+     */
+    SubBuilder& bulk(bool b=true) { this->_bulk = b; return _sb(); }
+
 #ifdef PVXS_EXPERT_API_ENABLED
     // for GET/PUT control whether operations automatically proceed from INIT to EXEC
     // cf. Operation::reExec()
@@ -701,6 +978,30 @@ public:
      * @since 0.2.0
      */
     SubBuilder& syncCancel(bool b) { this->_syncCancel = b; return _sb(); }
+
+    /** Run the callbacks of this operation through an Executor,
+     *  instead of on the Context worker thread, which then only decodes and queues.
+     *
+     *  This includes result(), event(), onInit(), and RPC chunk() callbacks,
+     *  but not PutBuilder::build(), which must return a Value to be sent.
+     *  The callbacks of one operation are called in order, and never concurrently.
+     *  Callbacks queued together are handed to the Executor as one batch.
+     *  An exception thrown by a callback is logged.
+     *
+     *  syncCancel() does not apply to callbacks already handed to the Executor.
+     *
+     *  @code
+     *  MPMCFIFO<std::function<void()>> workqueue;
+     *  // ... start some worker threads running: while(auto work = workqueue.pop()) work();
+     *  auto sub(ctxt.monitor("pv:name")
+     *           .executor([&workqueue](std::function<void()>&& fn) { workqueue.push(std::move(fn)); })
+     *           .event([](Subscription& sub) { ... })
+     *           .exec());
+     *  @endcode
+     *
+     *  @since 1.3.0
+     */
+    SubBuilder& executor(const Executor& exec) { this->_executor = exec; return _sb(); }
 };
 
 } // namespace detail
@@ -711,6 +1012,7 @@ class GetBuilder : public detail::CommonBuilder<GetBuilder, detail::CommonBase>
     std::function<void (const Value&)> _onInit;
     std::function<void(Result&&)> _result;
     bool _get = false;
+    unsigned _execDepth = 1u;
     PVXS_API
     std::shared_ptr<Operation> _exec_info();
     PVXS_API
@@ -726,6 +1028,17 @@ public:
     // called during operation INIT phase for Get/Put/Monitor when remote type
     // description is available.
     GetBuilder& onInit(std::function<void (const Value&)>&& cb) { this->_onInit = std::move(cb); return *this; }
+
+    /** With autoExec(false), the number of Operation::reExecGet() requests which may
+     *  be sent before the reply to the first is received.  Default 1.
+     *
+     *  A depth greater than 1 lets a polling client pipeline requests on a single
+     *  operation, without waiting a round trip for each.  Requires a server which
+     *  accepts more than one outstanding EXEC per operation, such as PVXS >= 1.3.0.
+     *
+     *  @since 1.3.0
+     */
+    GetBuilder& execPipeline(unsigned depth) { this->_execDepth = depth; return *this; }
 #endif
 
     /** Execute the network operation.
@@ -736,6 +1049,15 @@ public:
         return _get ? _exec_get() : _exec_info();
     }
 
+    /** Execute the network operation, with completion delivered through a Future.
+     *  Replaces any result() callback.
+     *  The caller must keep the returned Future until completion
+     *  or the operation will be implicitly canceled.
+     *  @since 1.3.0
+     */
+    PVXS_API
+    Future execFuture();
+
     friend struct Context::Pvt;
     friend class Context;
 };
@@ -749,6 +1071,7 @@ class PutBuilder : public detail::CommonBuilder<PutBuilder, detail::PRBase> {
     std::function<Value(Value&&)> _builder;
     std::function<void(Result&&)> _result;
     bool _doGet = true;
+    unsigned _execDepth = 1u;
 public:
     PutBuilder() {}
     PutBuilder(const std::shared_ptr<Context::Pvt>& ctx, const std::string& name) :CommonBuilder{ctx,name} {}
@@ -802,6 +1125,17 @@ public:
     // called during operation INIT phase for Get/Put/Monitor when remote type
     // description is available.
     PutBuilder& onInit(std::function<void (const Value&)>&& cb) { this->_onInit = std::move(cb); return *this; }
+
+    /** With autoExec(false), the number of Operation::reExecPut() requests which may
+     *  be sent before the reply to the first is received.  Default 1.
+     *
+     *  A depth greater than 1 lets a client stream values to a single
+     *  operation, without waiting a round trip for each.  Requires a server which
+     *  accepts more than one outstanding EXEC per operation, such as PVXS >= 1.3.0.
+     *
+     *  @since 1.3.0
+     */
+    PutBuilder& execPipeline(unsigned depth) { this->_execDepth = depth; return *this; }
 #endif
 
     /** Execute the network operation.
@@ -811,6 +1145,15 @@ public:
     PVXS_API
     std::shared_ptr<Operation> exec();
 
+    /** Execute the network operation, with completion delivered through a Future.
+     *  Replaces any result() callback.
+     *  The caller must keep the returned Future until completion
+     *  or the operation will be implicitly canceled.
+     *  @since 1.3.0
+     */
+    PVXS_API
+    Future execFuture();
+
     friend struct Context::Pvt;
     friend class Context;
 };
@@ -821,6 +1164,9 @@ PutBuilder Context::put(const std::string& name) { return PutBuilder{pvt, name};
 class RPCBuilder : public detail::CommonBuilder<RPCBuilder, detail::PRBase> {
     Value _argument;
     std::function<void(Result&&)> _result;
+    std::function<void(Value&&)> _chunk;
+    PVXS_API
+    std::shared_ptr<Operation> _exec_stream();
 public:
     RPCBuilder() {}
     RPCBuilder(const std::shared_ptr<Context::Pvt>& ctx, const std::string& name) :CommonBuilder{ctx,name} {}
@@ -828,6 +1174,22 @@ public:
     //! The functor is stored in the Operation returned by exec().
     RPCBuilder& result(std::function<void(Result&&)>&& cb) { _result = std::move(cb); return *this; }
 
+    /** Receive the reply as a stream of chunks, with flow control.
+     *
+     *  Instead of CMD_RPC, a pipelined MONITOR is sent with the argument as the "arg" member
+     *  of the pvRequest.  Each update from the server is passed to chunk() as it is received.
+     *  The server must end the stream with MonitorControlOp::finish(), after which
+     *  the result() callback, or Operation::wait(), completes with an empty Value.
+     *  Remote errors, disconnection, or an exception thrown by chunk() end the stream with an error.
+     *  The number of chunks in flight may be set with eg. @code .record("queueSize", 8) @endcode
+     *
+     *  The server side is a Source which handles ChannelControl::onSubscribe(),
+     *  and finds the argument with @code setup->pvRequest()["arg"] @endcode
+     *
+     *  @since 1.3.0
+     */
+    RPCBuilder& chunk(std::function<void(Value&&)>&& cb) { _chunk = std::move(cb); return *this; }
+
     RPCBuilder& arg(const std::string& name, const void *ptr, StoreType type) {
         _set(name, ptr, type, true);
         return *this;
@@ -853,6 +1215,15 @@ public:
     PVXS_API
     std::shared_ptr<Operation> exec();
 
+    /** Execute the network operation, with completion delivered through a Future.
+     *  Replaces any result() callback.
+     *  The caller must keep the returned Future until completion
+     *  or the operation will be implicitly canceled.
+     *  @since 1.3.0
+     */
+    PVXS_API
+    Future execFuture();
+
     friend struct Context::Pvt;
     friend class Context;
 };
@@ -863,6 +1234,51 @@ RPCBuilder Context::rpc(const std::string& name, const Value &arg) {
     return ret;
 }
 
+/** Mapping from fields of received updates into members of a user struct.  cf. MonitorBuilder::sink()
+ *
+ *  Each field() is converted with Value::as<T>() .
+ *  So T may be a scalar, std::string, or a shared_array<const E>, which references received array data without copying.
+ *
+ *  @code
+ *  struct Reading {
+ *      double value = 0.0;
+ *      int32_t severity = 0;
+ *      shared_array<const double> waveform;
+ *  };
+ *  DecodeMap map;
+ *  map.field<double>("value", offsetof(Reading, value))
+ *     .field<int32_t>("alarm.severity", offsetof(Reading, severity))
+ *     .field<shared_array<const double>>("waveform", offsetof(Reading, waveform));
+ *  @endcode
+ *
+ *  @since 1.3.0
+ */
+class DecodeMap {
+public:
+    struct Entry {
+        //! Field name.  eg. "alarm.severity"
+        std::string name;
+        //! Offset of member in user struct
+        size_t offset;
+        //! Assign field to member
+        void (*copy)(const Value& fld, void* member);
+    };
+private:
+    std::vector<Entry> _entries;
+
+    template<typename T>
+    static void copyAs(const Value& fld, void* member) { *static_cast<T*>(member) = fld.as<T>(); }
+public:
+    //! Copy the named field, converted to T, to the member of type T at offset
+    template<typename T>
+    DecodeMap& field(const std::string& name, size_t offset) {
+        _entries.push_back(Entry{name, offset, &copyAs<T>});
+        return *this;
+    }
+
+    const std::vector<Entry>& entries() const { return _entries; }
+};
+
 //! Prepare a remote subscription
 //! See Context::monitor()
 class MonitorBuilder : public detail::CommonBuilder<MonitorBuilder, detail::CommonBase> {
@@ -870,6 +1286,13 @@ class MonitorBuilder : public detail::CommonBuilder<MonitorBuilder, detail::Comm
     std::function<void(Subscription&)> _event;
     bool _maskConn = true;
     bool _maskDisconn = false;
+    bool _passThrough = false;
+    bool _latestOnly = false;
+    std::shared_ptr<ArrayAllocator> _arrayAlloc;
+    std::string _mcast;
+    std::shared_ptr<const DecodeMap> _sinkMap;
+    std::shared_ptr<void> _sinkDest;
+    std::function<void(const void*)> _sinkCB;
 public:
     MonitorBuilder() {}
     MonitorBuilder(const std::shared_ptr<Context::Pvt>& ctx, const std::string& name) :CommonBuilder{ctx,name} {}
@@ -886,11 +1309,101 @@ public:
     MonitorBuilder& maskConnected(bool m = true) { _maskConn = m; return *this; }
     //! Include Disconnected exceptions in queue (default true).
     MonitorBuilder& maskDisconnected(bool m = true) { _maskDisconn = m; return *this; }
+    /** Allocate storage of received arrays of Bool, Integer, or Real elements
+     *  through this ArrayAllocator, instead of that of Config::arrayAllocator.
+     *  @since 1.3.0
+     */
+    MonitorBuilder& arrayAllocator(const std::shared_ptr<ArrayAllocator>& alloc) { _arrayAlloc = alloc; return *this; }
+    /** Receive updates sent by UDP to dest by a server::SharedPV::multicast() with the same PV name,
+     *  instead of subscribing through a TCP connection.
+     *
+     *  Each update is complete.  When updates have been lost, the next has all fields marked.
+     *  A Connected is queued when the first update is received,
+     *  and a Disconnect if no update (or heartbeat) is received for Config::tcpTimeout.
+     *  The pvRequest, except for record._options.queueSize, is not applied.
+     *
+     *  @param dest "<IP46>:<port#>" or "<IP46>:<port#>@iface".  An empty string restores TCP.
+     *  @throws std::runtime_error from exec() if dest is not valid.
+     *  @since 1.3.0
+     */
+    MonitorBuilder& multicast(const std::string& dest) { _mcast = dest; return *this; }
+    /** Keep only the most recent data update, for access with Subscription::latest() and Subscription::version().
+     *
+     *  Data updates are not queued, and do not cause event() callbacks.
+     *  Each is merged with any previous update not yet seen through Subscription::latest().
+     *  Exceptions (eg. Disconnect or Finished) are still queued for pop(),
+     *  according to maskConnected() and maskDisconnected().
+     *
+     *  A latestOnly() Subscription is not shared (cf. Config::shareMonitors),
+     *  and may not be combined with multicast().
+     *
+     *  @code
+     *  auto sub(ctxt.monitor("pv:name").latestOnly().exec());
+     *  uint64_t seen = 0u;
+     *  ...
+     *  if(sub->version()!=seen) { // periodically, from any thread
+     *      auto val(sub->latest(&seen));
+     *      ...
+     *  }
+     *  @endcode
+     *
+     *  @since 1.3.0
+     */
+    MonitorBuilder& latestOnly(bool b = true) { _latestOnly = b; return *this; }
+    /** Copy the fields of each data update selected by map into *dest, then call cb(*dest).
+     *
+     *  For high rate consumers of a few fields.
+     *  Data updates are not queued, do not cause event() callbacks, and are never squashed.
+     *  Fields are copied, and cb is called, from a worker thread, which must not be blocked.
+     *  *dest holds the complete state of the mapped fields after each update.
+     *  Field names not present in the PV type are skipped.
+     *
+     *  Exceptions (eg. Disconnect or Finished) are still queued for pop(),
+     *  according to maskConnected() and maskDisconnected().
+     *  As is any error thrown while copying or by cb.
+     *
+     *  A sink() Subscription is not shared (cf. Config::shareMonitors),
+     *  and may not be combined with latestOnly() or multicast().
+     *
+     *  @code
+     *  auto latest(std::make_shared<Reading>());
+     *  auto sub(ctxt.monitor("pv:name")
+     *           .sink<Reading>(map, latest, [](const Reading& r) {
+     *               // on worker.  use r.value ...
+     *           })
+     *           .exec());
+     *  @endcode
+     *
+     *  @since 1.3.0
+     */
+    template<typename S>
+    MonitorBuilder& sink(const DecodeMap& map,
+                         const std::shared_ptr<S>& dest,
+                         std::function<void(const S&)>&& cb)
+    {
+        _sinkMap = std::make_shared<const DecodeMap>(map);
+        _sinkDest = dest;
+        _sinkCB = [cb](const void* raw) { cb(*static_cast<const S*>(raw)); };
+        return *this;
+    }
 
 #ifdef PVXS_EXPERT_API_ENABLED
     // called during operation INIT phase for Get/Put/Monitor when remote type
     // description is available.
     MonitorBuilder& onInit(std::function<void (Subscription&, const Value&)>&& cb) { this->_onInit = std::move(cb); return *this; }
+
+    /** Retain the received encoding of each update.  eg. for a gateway.  (default false)
+     *
+     * When an update Value pop()'d from this Subscription is post()'d, unmodified,
+     * to a server::MonitorControlOp or server::SharedPV, the received encoding
+     * is sent to downstream subscribers which use the same byte order and request all fields,
+     * instead of encoding again.
+     *
+     * Not applied to types which include Any fields.
+     *
+     * @since 1.3.0
+     */
+    MonitorBuilder& passThrough(bool b = true) { _passThrough = b; return *this; }
 #endif
 
     //! Submit request to subscribe
@@ -922,6 +1435,7 @@ class ConnectBuilder
     std::string _server;
     std::function<void()> _onConn;
     std::function<void()> _onDis;
+    unsigned _prio = 0u;
     bool _syncCancel = true;
 public:
     ConnectBuilder() {}
@@ -946,6 +1460,10 @@ public:
 
     ConnectBuilder& server(const std::string& s) { this->_server = s; return *this; }
 
+    //! Channel priority.  cf. detail::CommonBuilder::priority()
+    //! @since 1.3.0
+    ConnectBuilder& priority(int p) { this->_prio = p<0 ? 0u : unsigned(p); return *this; }
+
     //! Submit request to connect
     PVXS_API
     std::shared_ptr<Connect> exec();
@@ -1034,6 +1552,122 @@ struct PVXS_API Config {
     //! @since 0.2.0
     double tcpTimeout = 40.0;
 
+    //! Number of worker threads which handle TCP connections.
+    //! Channels are assigned to a worker by PV name.
+    //! Each worker searches for, and maintains separate connections for, its own Channels.
+    //! Zero or one (default) handle all Channels with a single worker.
+    //! @since 1.3.0
+    unsigned tcpWorkers = 1u;
+
+    //! Number of parallel TCP connections to each server.
+    //! Channels are assigned to a connection by PV name, so that large transfers of different PVs
+    //! are not serialized behind one another through a single connection.
+    //! Zero or one (default) for a single connection to each server.
+    //! @since 1.3.0
+    unsigned tcpStreams = 1u;
+
+    //! TCP socket send buffer size (SO_SNDBUF) in bytes.  Zero (default) keeps the OS default.
+    //! @since 1.3.0
+    unsigned tcpSendBuffer = 0u;
+    //! TCP socket receive buffer size (SO_RCVBUF) in bytes.  Zero (default) keeps the OS default.
+    //! @since 1.3.0
+    unsigned tcpRecvBuffer = 0u;
+    /** TCP socket receive buffer size (SO_RCVBUF) in bytes of the connections used by
+     *  bulk operations.  cf. detail::CommonBuilder::bulk()
+     *  Zero (default) uses tcpRecvBuffer.
+     *  eg. a large TCP window, for large arrays over a link with a large bandwidth-delay product,
+     *  without also enlarging the buffers of every other connection.
+     *  @since 1.3.0
+     */
+    unsigned tcpBulkRecvBuffer = 0u;
+    //! Disable Nagle's algorithm (TCP_NODELAY) on TCP connections.
+    //! @since 1.3.0
+    bool tcpNoDelay = false;
+    //! Busy poll interval (SO_BUSY_POLL) in microseconds.  Zero (default) disables.
+    //! Only effective on Linux.
+    //! @since 1.3.0
+    unsigned tcpBusyPoll = 0u;
+    //! Limit of unsent bytes in the socket send buffer (TCP_NOTSENT_LOWAT).  Zero (default) keeps the OS default.
+    //! Only effective on Linux and OSX.
+    //! @since 1.3.0
+    unsigned tcpNotSentLowat = 0u;
+    /** Enable TCP keepalive (SO_KEEPALIVE) on TCP connections, with probing timed
+     *  so that a dead peer is detected after about tcpTimeout.
+     *  When the peer also enables this option, an idle connection is not timed out,
+     *  and the client does not send periodic ECHO to keep it open.
+     *  An occasional ECHO is still sent to sample the round trip time.
+     *  Peers without this option continue to exchange ECHO as before.
+     *  @since 1.3.0
+     */
+    bool tcpKeepAlive = false;
+
+    //! List of CPU numbers and ranges, eg. "2,4-5", to which TCP worker threads are restricted.
+    //! Empty (default) for no restriction.  Only effective on Linux.
+    //! Several groups separated by ';', eg. "0-7;8-15", place TCP worker N in group N%ngroups.
+    //! "numa" for one group per NUMA node.
+    //! @since 1.3.0
+    std::string tcpWorkerCPUs;
+    //! EPICS thread priority of TCP worker threads.  Zero (default) keeps the built-in priority.
+    //! Whether a real-time scheduling policy is used follows the EPICS OSI thread configuration.
+    //! @since 1.3.0
+    unsigned tcpWorkerPriority = 0u;
+
+    /** When true, build() returns a Context sharing the connections, searches,
+     *  and Channel cache of a Context built earlier, also with shareContext=true,
+     *  from a Config with the same effective configuration.
+     *  Provided that earlier Context is still referenced and not close()d.
+     *  Otherwise, or when false (default), build() creates a new Context.
+     *
+     *  A Context so shared is a copy of the first.  So close() affects both.
+     *  @since 1.3.0
+     */
+    bool shareContext = false;
+
+    /** When true, Subscriptions created by MonitorBuilder::exec() for the same PV name,
+     *  server, and pvRequest, share one subscription to the server.
+     *  Each Subscription keeps its own queue, and a copy of each update.
+     *  A later Subscription begins with the most recent update.
+     *
+     *  Not applied when MonitorBuilder::onInit() or autoExec(false) is used, or to Context::monitorMany().
+     *  pause() takes effect when all sharing Subscriptions are paused.
+     *  Default false.
+     *  @since 1.3.0
+     */
+    bool shareMonitors = false;
+
+    /** When true, a PV found on a server::Server running in this process is reached through
+     *  an in-process socketpair(), instead of a TCP connection through the network stack.
+     *  The Server is recognized by the GUID in its search reply.
+     *  Default false.
+     *  @since 1.3.0
+     */
+    bool inProcess = false;
+
+    /** When not empty, a directory in which servers on this host create Unix domain sockets.
+     *  cf. server::Config::unixSocketDir
+     *  A connection to a server with an address of this host is first tried
+     *  through the socket for its TCP port, and through TCP if that fails.
+     *  Only effective on Unix-like targets.
+     *  @since 1.3.0
+     */
+    std::string unixSocketDir;
+
+    /** When not empty, a file in which the server which claimed each PV name is remembered.
+     *  Read when the Context is created, and written when it is closed.
+     *  A Channel to a remembered name first connects directly to that server,
+     *  and searches as usual if the server does not claim the name.
+     *  @since 1.3.0
+     */
+    std::string nameCacheFile;
+
+    /** When not nullptr, storage of received arrays of Bool, Integer, or Real elements
+     *  for GET and monitor updates is allocated through this ArrayAllocator.
+     *  eg. ArrayAllocator::aligned(64)
+     *  cf. MonitorBuilder::arrayAllocator()
+     *  @since 1.3.0
+     */
+    std::shared_ptr<ArrayAllocator> arrayAllocator;
+
 private:
     bool BE = EPICS_BYTE_ORDER==EPICS_ENDIAN_BIG;
     bool UDP = true;
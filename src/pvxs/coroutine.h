@@ -0,0 +1,212 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef PVXS_COROUTINE_H
+#define PVXS_COROUTINE_H
+
+/** @file coroutine.h
+ *
+ * Optional C++20 coroutine support for client operations.
+ * Only defines anything when included by code compiled with coroutine support.
+ * The pvxs library itself does not require C++20.
+ *
+ * @since 1.3.0
+ */
+
+#include <pvxs/client.h>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+namespace pvxs {
+namespace client {
+
+/** Awaitable completion of a Get, Put, or RPC operation.
+ *
+ * Usually created implicitly by co_await of a GetBuilder, PutBuilder, or RPCBuilder.
+ * The coroutine is resumed, with the result Value, from the Context worker thread,
+ * or through the Executor given to detail::CommonBuilder::executor().
+ * Any error is thrown from the co_await expression, as by Result::operator()().
+ *
+ * The operation is stored in this awaiter, within the coroutine frame.
+ * So the operation is cancelled if the coroutine is destroyed while suspended.
+ *
+ * @code
+ * Context ctxt(...);
+ * Value val = co_await ctxt.get("pv:name");
+ * co_await ctxt.put("pv:name").set("value", 42);
+ * @endcode
+ *
+ * Any result() callback previously set on the builder is replaced.
+ *
+ * @since 1.3.0
+ */
+template<typename Builder>
+class ResultAwaiter {
+    Builder builder;
+    std::shared_ptr<Operation> op;
+    Result result;
+    std::coroutine_handle<> waiter;
+    enum state_t { Init, Suspended, Done };
+    std::atomic<int> state{Init};
+public:
+    explicit ResultAwaiter(Builder&& builder) :builder(std::move(builder)) {}
+    ResultAwaiter(const ResultAwaiter&) = delete;
+    ResultAwaiter& operator=(const ResultAwaiter&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        waiter = h;
+        op = builder.result([this](Result&& r) {
+            result = std::move(r);
+            // resume only if await_suspend() has returned true
+            if(state.exchange(Done)==Suspended)
+                waiter.resume();
+        }).exec();
+        // if already Done, then continue without suspending
+        int expect = Init;
+        return state.compare_exchange_strong(expect, Suspended);
+    }
+
+    Value await_resume() {
+        return result();
+    }
+};
+
+/** Awaitable updates of a Subscription.
+ *
+ * Creates a Subscription from a MonitorBuilder, and allows a coroutine to co_await next()
+ * for each Value, or exception, otherwise returned or thrown by Subscription::pop().
+ * The coroutine is resumed from the Context worker thread,
+ * or through the Executor given to detail::CommonBuilder::executor().
+ *
+ * Only one coroutine may await next() at a time.
+ * Not movable, as the Subscription event callback refers to this object.
+ *
+ * @code
+ * Context ctxt(...);
+ * Subscriber sub(ctxt.monitor("pv:name"));
+ * while(true) {
+ *     Value update = co_await sub.next();
+ *     ...
+ * }
+ * @endcode
+ *
+ * Any event() callback previously set on the builder is replaced.
+ *
+ * @since 1.3.0
+ */
+class Subscriber {
+    epicsMutex lock;
+    // guarded by lock
+    std::coroutine_handle<> waiter;
+    bool pending = false;
+    // after members used by the event callback
+    std::shared_ptr<Subscription> _sub;
+
+    void onEvent() {
+        std::coroutine_handle<> h;
+        {
+            epicsGuard<epicsMutex> G(lock);
+            h = waiter;
+            waiter = nullptr;
+            if(!h)
+                pending = true;
+        }
+        if(h)
+            h.resume();
+    }
+
+public:
+    class Awaiter {
+        Subscriber& self;
+        Value val;
+        std::exception_ptr exc;
+    public:
+        explicit Awaiter(Subscriber& self) :self(self) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            epicsGuard<epicsMutex> G(self.lock);
+            while(true) {
+                try {
+                    val = self._sub->pop();
+                } catch(...) {
+                    exc = std::current_exception();
+                    return false;
+                }
+                if(val) {
+                    return false;
+                } else if(self.pending) {
+                    // an event arrived before an empty pop().  Try again.
+                    self.pending = false;
+                } else {
+                    // the next event will resume
+                    self.waiter = h;
+                    return true;
+                }
+            }
+        }
+
+        Value await_resume() {
+            if(exc)
+                std::rethrow_exception(exc);
+            else if(!val)
+                val = self._sub->pop(); // resumed by event
+            return std::move(val);
+        }
+    };
+
+    explicit Subscriber(MonitorBuilder&& builder)
+        :_sub(builder.event([this](Subscription&) { onEvent(); }).exec())
+    {}
+    explicit Subscriber(MonitorBuilder& builder) :Subscriber(MonitorBuilder(builder)) {}
+    Subscriber(const Subscriber&) = delete;
+    Subscriber& operator=(const Subscriber&) = delete;
+    //! Cancels the Subscription.  Must not be destroyed while a coroutine awaits next().
+    ~Subscriber() {
+        // with syncCancel (the default) waits for any in progress event callback
+        _sub.reset();
+    }
+
+    //! Awaitable for the next update, or exception.
+    Awaiter next() { return Awaiter(*this); }
+
+    //! The underlying Subscription
+    const std::shared_ptr<Subscription>& subscription() const { return _sub; }
+};
+
+namespace detail {
+template<typename B>
+using IsAwaitableBuilder = std::integral_constant<bool,
+    std::is_same<typename std::decay<B>::type, GetBuilder>::value
+ || std::is_same<typename std::decay<B>::type, PutBuilder>::value
+ || std::is_same<typename std::decay<B>::type, RPCBuilder>::value>;
+} // namespace detail
+
+//! co_await of a GetBuilder, PutBuilder, or RPCBuilder.  cf. ResultAwaiter
+//! @since 1.3.0
+template<typename B, typename std::enable_if<detail::IsAwaitableBuilder<B>::value, int>::type = 0>
+ResultAwaiter<typename std::decay<B>::type> operator co_await(B&& builder)
+{
+    typedef typename std::decay<B>::type builder_t;
+    return ResultAwaiter<builder_t>(builder_t(std::forward<B>(builder)));
+}
+
+} // namespace client
+} // namespace pvxs
+
+#endif // __cpp_impl_coroutine
+
+#endif // PVXS_COROUTINE_H
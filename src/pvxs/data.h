@@ -21,6 +21,10 @@
 namespace pvxs {
 class Value;
 class TypeDef;
+class FieldRef;
+class ValueView;
+template<typename T>
+class ScalarRef;
 namespace client {
 namespace detail {
 class CommonBase;
@@ -382,6 +386,7 @@ class PVXS_API TypeDef
 public:
     struct Node;
 private:
+    friend class FieldRef;
     std::shared_ptr<const Member> top;
     std::shared_ptr<const impl::FieldDesc> desc;
 public:
@@ -487,6 +492,56 @@ struct PVXS_API LookupError : public std::runtime_error
     virtual ~LookupError();
 };
 
+/** A field name resolved once against a particular type.
+ *
+ * Accessing through a FieldRef, with Value::operator[](const FieldRef&),
+ * a Value of the type it was resolved against is an index offset
+ * without any string handling.  Any other Value falls back to
+ * a lookup by name, as with Value::operator[](const std::string&).
+ *
+ * Only names of (possibly nested) Struct members, eg. "alarm.severity",
+ * are pre-resolved.  Other expressions, eg. with "->" or "[0]", are accepted
+ * but always looked up by name.
+ *
+ * A FieldRef is immutable, and so may be shared between threads.
+ *
+ * @code
+ * Value top = nt::NTScalar{TypeCode::Int32}.create();
+ * FieldRef sevr(top.index("alarm.severity"));
+ * ...
+ * // later, with Values of the same type (eg. monitor updates)
+ * auto s = update[sevr].as<int32_t>();
+ * @endcode
+ *
+ * @since 1.3.0
+ */
+class PVXS_API FieldRef {
+    // type against which name was resolved.  Keeps the FieldDesc alive
+    std::shared_ptr<const impl::FieldDesc> base;
+    std::string _name;
+    // relative index from base of the named field, or size_t(-1)
+    size_t offset = size_t(-1);
+    friend class Value;
+    friend class ValueView;
+
+    void resolve();
+public:
+    //! Empty.  Matches no field.
+    FieldRef() = default;
+    //! Not pre-resolved.  Always looks up by name.
+    explicit FieldRef(const std::string& name);
+    //! Resolve against the type of a Value, which may be any field of a Struct.
+    FieldRef(const Value& val, const std::string& name);
+    //! Resolve against the type of a TypeDef
+    FieldRef(const TypeDef& def, const std::string& name);
+
+    //! Field name as given.
+    inline const std::string& name() const { return _name; }
+    //! True if this name was resolved to a Struct member.
+    //! Only then can access be an index offset.
+    inline bool resolved() const { return offset!=size_t(-1); }
+};
+
 /** Generic data container
  *
  * References a single data field, which may be free-standing (eg. "int x = 5;")
@@ -511,6 +566,9 @@ class PVXS_API Value {
 public:
     struct Helper;
     friend struct Helper;
+    template<typename T>
+    friend class ScalarRef;
+    friend class ValueView;
 
     //! default empty Value
     constexpr Value() :desc(nullptr) {}
@@ -538,7 +596,8 @@ public:
 
     //! allocate new storage, with default values
     Value cloneEmpty() const;
-    //! allocate new storage and copy in our values
+    //! allocate new storage and copy in our values.
+    //! @since 1.3.0 clone() of a frozen() Value is another reference to the same storage.
     Value clone() const;
     //! copy value(s) from other.
     //! Acts like from(o) for kind==Kind::Compound .
@@ -548,6 +607,37 @@ public:
     //! Use to allocate members for an array of Struct and array of Union
     Value allocMember();
 
+    /** Make the structure referenced by this Value immutable.
+     *
+     * A frozen structure is never modified, so it may be shared between threads without locking.
+     * clone() of a frozen Value does not copy.  It is a second reference to the same structure.
+     * Freezing includes any Values held in Union, Any, or arrays of Struct or Union fields.
+     *
+     * Modification through a Value which references the whole of a frozen structure,
+     * eg. with assign(), from(), mark(), or the non-const operator[] , first
+     * replaces that one Value with a reference to a private copy.
+     * Other references to the frozen structure are not affected.
+     * Modification through a Value which references a sub-field of a frozen structure,
+     * eg. from const operator[] or iteration, throws std::logic_error .
+     *
+     * So read through a const Value to avoid making a copy.
+     *
+     * @code
+     * Value snap(val.clone());
+     * snap.freeze();        // shared with other threads, which may then
+     * Value mine(snap.clone());  // no copy
+     * mine["value"] = 42;   // copy made here, snap unchanged
+     * @endcode
+     *
+     * @pre This Value references the top of a structure, and is its only reference.
+     * @throws std::logic_error if this Value is empty, or the pre-condition is not met.
+     * @since 1.3.0
+     */
+    Value& freeze();
+    //! True if the structure referenced by this Value has been freeze()'d
+    //! @since 1.3.0
+    bool frozen() const;
+
     /** Restore to newly allocated state.
      *
      * Free any allocation for array or string values, zero numeric values.
@@ -583,12 +673,41 @@ public:
 private:
     static
     bool _equal(const impl::FieldDesc* A, const impl::FieldDesc* B);
+    // storage of a scalar field of exactly the expected type, and its mark.  cf. ScalarRef
+    void* _scalarStorage(TypeCode expect, bool*& marked) const;
+    // before modification.  Replace a reference to a whole frozen structure with a private copy.
+    void _thaw();
 public:
     //! Test for instance equality.  aka. this==this
     inline bool equalInst(const Value& o) const { return store==o.store; }
     //! Test for equality of type only (including field names)
     inline bool equalType(const Value& o) const { return _equal(desc, o.desc); }
 
+    /** Mark only those fields whose values differ from the corresponding fields of prev.
+     *
+     * Each field of this Value is compared with the same field of prev.
+     * Those which differ are mark()ed.  All others are unmark()ed.
+     * Struct fields are themselves left unmarked, with their changed members marked.
+     * Arrays of numbers are compared as one block of memory.
+     * Union and Any fields are compared by selection, type, and value.
+     *
+     * @param prev A Value with the same type.  eg. the previous update.
+     * @param onlyMarked If true, then only fields which are already marked,
+     *                   or which have a marked parent, are compared.  Others are left unmarked.
+     * @returns true if any field is now marked.
+     * @throws std::logic_error if either Value is empty, or the types are not equal.
+     *
+     * @code
+     *   auto update(prev.cloneEmpty());
+     *   update["value"] = 5;
+     *   if(update.markChanged(prev, true))
+     *       pv.post(update); // only if value actually changed
+     * @endcode
+     *
+     * @since 1.3.0
+     */
+    bool markChanged(const Value& prev, bool onlyMarked=false);
+
     /** Return our name for a descendant field.
      * @code
      *   Value v = ...;
@@ -738,6 +857,20 @@ public:
     Value lookup(const std::string& name);
     const Value lookup(const std::string& name) const;
 
+    /** Access a descendant field via a pre-resolved field name.
+     *
+     * Acts like operator[](ref.name()) , but with no string handling
+     * when this Value has the type ref was resolved against.
+     *
+     * @since 1.3.0
+     */
+    Value operator[](const FieldRef& ref);
+    const Value operator[](const FieldRef& ref) const;
+
+    //! Resolve a field name against the type of this Value.  Shorthand for FieldRef(*this, name)
+    //! @since 1.3.0
+    FieldRef index(const std::string& name) const;
+
     //! Number of child fields.
     //! only Struct, StructA, Union, UnionA return non-zero
     //! \since 1.1.3 correctly return non-zero for StructA and UnionA
@@ -788,6 +921,8 @@ public:
         enum format_t {
             Tree,
             Delta,
+            //! @since 1.3.0
+            JSON,
         } _format = Tree;
         bool _showValue = true;
 
@@ -796,12 +931,35 @@ public:
         Fmt& tree() { _format = Tree; return *this; }
         //! Show Value in delta format
         Fmt& delta()  { _format = Delta ; return *this; }
+        /** Show Value as compact JSON, without a trailing newline.
+         *
+         * Union is an object with one member, or null when not selected.
+         * Any is its contained value, or null.  Non-finite reals are null.
+         * Ignores arrayLimit() and showValue().
+         * cf. json::Parse in pvxs/json.h
+         *
+         * @since 1.3.0
+         */
+        Fmt& json()  { _format = JSON ; return *this; }
         //! Explicitly select format_t
         Fmt& format(format_t f) { _format = f ; return *this; }
         //! Whether to show field values, or only type information
         Fmt& showValue(bool v) { _showValue = v; return *this; }
         //! When non-zero, arrays output will be truncated with "..." after cnt elements.
         Fmt& arrayLimit(size_t cnt) { _limit = cnt; return *this; }
+        /** Append output to a string, without going through std::ostream.
+         *
+         * Output is the same as printing to a newly constructed std::ostream.
+         * Re-using the same string for successive calls avoids re-allocation.
+         *
+         * @code
+         * std::string line;
+         * val.format().delta().appendTo(line);
+         * @endcode
+         *
+         * @since 1.3.0
+         */
+        PVXS_API void appendTo(std::string& buf) const;
     };
     /** Configurable printing via std::ostream
      *
@@ -934,6 +1092,252 @@ Value::imarked() const noexcept {
     return Iterable<Value::_IMarked>{this};
 }
 
+/** Typed access to one scalar field of one Value.
+ *
+ * The field type is checked once, when the ScalarRef is bound.
+ * Afterwards, reads and writes are through a pointer to the field storage,
+ * without the type checks and conversions of Value::as() and Value::from().
+ *
+ * T must be the C++ type of the field TypeCode exactly.  eg. int32_t for TypeCode::Int32 .
+ *
+ * Typically, several ScalarRef are grouped to describe a structure,
+ * and bound to each Value of that type.  Combined with FieldRef,
+ * field names are then resolved once for all Values of the same type.
+ *
+ * @code
+ * struct ScalarView {
+ *     ScalarRef<double> value;
+ *     ScalarRef<int32_t> severity;
+ *     explicit ScalarView(const Value& top)
+ *         :value(top["value"])
+ *         ,severity(top["alarm.severity"])
+ *     {}
+ * };
+ *
+ * Value top(nt::NTScalar{TypeCode::Float64}.create());
+ * ScalarView V(top);
+ * V.value = 4.2;     // assign and mark
+ * V.severity = 1;
+ * double x = V.value;
+ * @endcode
+ *
+ * Assignment marks the field, but not any enclosing Union or Any field.
+ * A ScalarRef keeps its Value alive.
+ *
+ * @since 1.3.0
+ */
+template<typename T>
+class ScalarRef {
+    static_assert(std::is_arithmetic<T>::value, "ScalarRef<T> requires a bool, integer, or floating point T");
+    // FieldStorage representation of T
+    typedef typename std::conditional<std::is_same<T, bool>::value,
+                                      bool,
+                                      typename impl::ScalarMap<T>::store_t>::type store_t;
+
+    Value fld;
+    store_t* ptr = nullptr;
+    bool* marked = nullptr;
+public:
+    //! Not bound.  Must not be read or assigned.
+    ScalarRef() = default;
+    /** Bind to a field.
+     * @throws NoField if fld is empty.
+     * @throws NoConvert if the field type is not exactly T.
+     */
+    explicit ScalarRef(const Value& fld)
+        :fld(fld)
+    {
+        ptr = static_cast<store_t*>(fld._scalarStorage(TypeCode(impl::ScalarMap<T>::code), marked));
+    }
+
+    inline explicit operator bool() const { return ptr; }
+    //! The bound field
+    inline const Value& value() const { return fld; }
+
+    //! Read field value
+    inline T get() const { return T(*ptr); }
+    inline operator T() const { return get(); }
+
+    //! Assign field value, and mark() field
+    inline ScalarRef& operator=(T val) {
+        *ptr = store_t(val);
+        *marked = true;
+        return *this;
+    }
+};
+
+/** Non-owning reference to one field of a Value.
+ *
+ * Each Value returned by Value::operator[] , or by iteration, holds a reference
+ * to the enclosing structure.  So every access costs atomic reference count updates,
+ * which may dominate in tight loops over large structures.
+ * A ValueView is only a pair of pointers.  Traversal, reads, and writes
+ * through a ValueView do not touch any reference count.
+ *
+ * A ValueView does not keep the structure alive.  It is valid only so long as
+ * some Value referencing the same structure exists, and must not be used afterwards.
+ *
+ * Traversal is limited to (possibly nested) Struct members, by name eg. "alarm.severity",
+ * or through a FieldRef.  Other expressions, eg. with "->" or "[0]", give an empty ValueView.
+ * The content of a Union, Any, or array of Struct is reached through as<Value>() .
+ * Assignment to a Union field is not supported.  Use Value instead.
+ *
+ * @code
+ * Value top(...);
+ * double sum = 0.0;
+ * for(auto fld : ValueView(top).iall()) {
+ *     if(fld.type()==TypeCode::Float64)
+ *         sum += fld.as<double>();
+ * }
+ * ValueView(top)["alarm.severity"] = 2;
+ * @endcode
+ *
+ * @since 1.3.0
+ */
+class PVXS_API ValueView {
+    impl::FieldStorage* store = nullptr;
+    const impl::FieldDesc* desc = nullptr;
+
+    ValueView(const impl::FieldDesc* desc, impl::FieldStorage* store) :store(store), desc(desc) {}
+    // A Value aliasing this field without holding a reference
+    Value alias() const;
+    void copyOut(void *ptr, StoreType type) const;
+    bool tryCopyOut(void *ptr, StoreType type) const;
+    void copyIn(const void *ptr, StoreType type);
+public:
+    //! Empty.
+    ValueView() = default;
+    //! View the same field as val.
+    ValueView(const Value& val) :store(val.store.get()), desc(val.desc) {}
+
+    //! Does this view reference some field
+    inline bool valid() const { return desc; }
+    inline explicit operator bool() const { return desc; }
+
+    //! Test for instance equality.  Same as Value::equalInst()
+    inline bool equalInst(const ValueView& o) const { return store==o.store; }
+
+    //! Type of the referenced field (or Null)
+    TypeCode type() const;
+    //! Type of value stored in referenced field
+    StoreType storageType() const;
+    //! Number of child fields.  cf. Value::nmembers()
+    size_t nmembers() const;
+
+    //! Test if this field is marked as valid/changed.  Parent and child fields are not considered.
+    bool isMarked() const;
+    //! Mark this field as valid/changed.  Same as Value::mark()
+    void mark(bool v=true);
+
+    //! Access a descendant Struct field by name.  eg. "alarm.severity"
+    ValueView operator[](const std::string& name) const;
+    //! Access a descendant Struct field through a pre-resolved name.
+    ValueView operator[](const FieldRef& ref) const;
+
+    //! Extract from field.  Same conversions as Value::as()
+    //! @throws NoField !this->valid()
+    //! @throws NoConvert if the field value can not be coerced to type T
+    template<typename T>
+    inline T as() const {
+        typename impl::StoreAs<T>::store_t ret;
+        copyOut(&ret, impl::StoreAs<T>::code);
+        return impl::StoreTransform<T>::out(ret);
+    }
+
+    //! Attempt to extract value from field.
+    //! @returns false if as<T>() would throw NoField or NoConvert
+    template<typename T>
+    inline bool as(T& val) const {
+        typename impl::StoreAs<T>::store_t temp;
+        auto ret = tryCopyOut(&temp, impl::StoreAs<T>::code);
+        if(ret) {
+            try {
+                val = impl::StoreTransform<T>::out(temp);
+            }catch(std::exception&){
+                ret = false;
+            }
+        }
+        return ret;
+    }
+
+    //! Assign to field, and mark().  Same conversions as Value::from()
+    //! @throws NoField !this->valid()
+    //! @throws NoConvert if the field can not be assigned from type T, or is a Union
+    template<typename T>
+    void from(const T& val) {
+        const typename impl::StoreAs<T>::store_t& norm(impl::StoreTransform<T>::in(val));
+        copyIn(&norm, impl::StoreAs<T>::code);
+    }
+
+    //! Shorthand for from<T>(const T&) except for T=Value or ValueView (re-targets the view)
+    template<typename T>
+#ifdef _DOXYGEN_
+    ValueView&
+#else
+    typename std::enable_if<!std::is_same<T,ValueView>::value && !std::is_same<T,Value>::value, ValueView&>::type
+#endif
+    operator=(const T& val) {
+        from<T>(val);
+        return *this;
+    }
+
+    enum IterKind {
+        Children,
+        All,
+        Marked,
+    };
+
+    struct PVXS_API iterator {
+        ValueView parent;
+        size_t pos;
+        // with Marked, descendants of a marked field before this position are visited without checking
+        size_t nextcheck;
+        IterKind kind;
+
+        iterator(const ValueView& parent, size_t pos, IterKind kind) :parent(parent), pos(pos), nextcheck(0u), kind(kind) {}
+        ValueView operator*() const;
+        //! Name of the current field, relative to the iterated Struct.  eg. "alarm.severity"
+        const std::string& name() const;
+        inline iterator& operator++() {
+            pos++;
+            if(kind==Marked)
+                skipUnmarked();
+            return *this;
+        }
+        inline bool operator==(const iterator& o) const { return pos==o.pos; }
+        inline bool operator!=(const iterator& o) const { return pos!=o.pos; }
+    private:
+        void skipUnmarked();
+        friend struct Iterable;
+    };
+
+    struct PVXS_API Iterable {
+        ValueView parent;
+        IterKind kind;
+
+        Iterable(const ValueView& parent, IterKind kind) :parent(parent), kind(kind) {}
+        iterator begin() const;
+        iterator end() const;
+    };
+
+    /** Depth-first iteration of all descendant fields of a Struct.  cf. Value::iall()
+     *
+     * A linear walk of the field storage, in the order of a list of names
+     * computed once for each type.  So iterator::name() is available without a lookup.
+     *
+     * @code
+     * for(auto it(ValueView(top).iall().begin()), end(ValueView(top).iall().end()); it!=end; ++it) {
+     *     std::cout<<it.name()<<" = "<<(*it).as<std::string>()<<"\n";
+     * }
+     * @endcode
+     */
+    inline Iterable iall() const { return Iterable(*this, All); }
+    //! Iteration of all child fields of a Struct.  cf. Value::ichildren()
+    inline Iterable ichildren() const { return Iterable(*this, Children); }
+    //! Depth-first iteration of all marked descendant fields of a Struct.  cf. Value::imarked()
+    inline Iterable imarked() const { return Iterable(*this, Marked); }
+};
+
 PVXS_API
 std::ostream& operator<<(std::ostream& strm, const Value::Fmt& fmt);
 
@@ -0,0 +1,60 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef PVXS_JSON_H
+#define PVXS_JSON_H
+
+#include <string>
+
+#include <string.h>
+
+#include <pvxs/version.h>
+#include <pvxs/data.h>
+
+namespace pvxs {
+namespace json {
+
+/** Parse JSON text into an existing Value, whose type is already known.
+ *
+ * The mapping is the same as used by Value::Fmt::json() .
+ *
+ * - A Struct is an object.  Members not present in the object are left unchanged.
+ * - A selected Union is an object with one member.  null de-selects.
+ * - An Any may be assigned a JSON scalar, which infers the type as
+ *   bool, int64_t, double, or string.
+ * - Arrays, including Struct[] and Union[], are JSON arrays.
+ *
+ * Each field assigned is marked as changed.
+ * Parsing is streaming, assigning fields as the text is consumed, without an intermediate document.
+ *
+ * @code
+ * auto val(nt::NTScalar{TypeCode::Float64}.create());
+ * json::Parse("{\"value\": 4.2, \"alarm\":{\"severity\":1}}").into(val);
+ * @endcode
+ *
+ * @since 1.3.0
+ */
+struct PVXS_API Parse {
+    const char* base;
+    size_t count;
+
+    //! Parse nil terminated string
+    explicit Parse(const char* s) :base(s), count(strlen(s)) {}
+    //! Parse count bytes of s
+    Parse(const char* s, size_t count) :base(s), count(count) {}
+    explicit Parse(const std::string& s) :base(s.c_str()), count(s.size()) {}
+
+    /** Assign to val
+     *
+     * @throws std::runtime_error on a syntax error, or a JSON value which can not be assigned to a field.
+     *         val may be partially updated.
+     */
+    void into(Value& val) const;
+};
+
+} // namespace json
+} // namespace pvxs
+
+#endif // PVXS_JSON_H
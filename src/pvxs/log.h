@@ -9,6 +9,7 @@
 #include <atomic>
 
 #include <cstddef>
+#include <cstdint>
 #include <stdarg.h>
 
 #include <compilerDependencies.h>
@@ -60,6 +61,23 @@ namespace detail {
 PVXS_API
 const char *log_prep(logger& log, unsigned lvl);
 
+/* Rate limit state of one log_printf() call site.  cf. logger_limit_set()
+ * Only accessed through atomics, as a call site may be reached from several threads.
+ */
+struct LogLimit {
+    // beginning of current interval.  from epicsMonotonicGet()
+    std::atomic<uint64_t> start{0u};
+    // messages from this call site during the current interval
+    std::atomic<uint32_t> count{0u};
+    // messages not printed since the last one printed
+    std::atomic<uint32_t> suppressed{0u};
+    constexpr LogLimit() {}
+};
+
+//! As log_prep(), but returns nullptr if the call site has exceeded its rate limit.
+PVXS_API
+const char *log_prep(logger& log, unsigned lvl, LogLimit& limit);
+
 PVXS_API
 void _log_printf(unsigned rawlvl, _Printf_format_string_ const char *fmt, ...) EPICS_PRINTF_STYLE(2,3);
 
@@ -80,6 +98,8 @@ void xerrlogHexPrintf(const void *buf, size_t buflen);
  *
  * Due to portability issues with MSVC, log formats must have at least one argument.
  *
+ * WARN and ERR messages are rate limited for each call site.  See logger_limit_set().
+ *
  *  @code
  *      DEFINE_LOGGER(blah, "myapp.blah");
  *      void blahfn(int x) {
@@ -87,7 +107,8 @@ void xerrlogHexPrintf(const void *buf, size_t buflen);
  *  @endcode
  */
 #define log_printf(LOGGER, LVL, FMT, ...) do{ \
-    if(auto _log_prefix = ::pvxs::detail::log_prep(LOGGER, unsigned(LVL))) \
+    static ::pvxs::detail::LogLimit _log_limit; \
+    if(auto _log_prefix = ::pvxs::detail::log_prep(LOGGER, unsigned(LVL), _log_limit)) \
         ::pvxs::detail:: _log_printf(unsigned(LVL), "%s " FMT, _log_prefix, __VA_ARGS__); \
 }while(0)
 
@@ -117,7 +138,8 @@ void xerrlogHexPrintf(const void *buf, size_t buflen);
 #define log_debug_printf(LOGGER, FMT, ...) log_printf(LOGGER, ::pvxs::Level::Debug, FMT, __VA_ARGS__)
 
 #define log_hex_printf(LOGGER, LVL, BUF, BUFLEN, FMT, ...) do{ \
-    if(auto _log_prefix = ::pvxs::detail::log_prep(LOGGER, unsigned(LVL))) \
+    static ::pvxs::detail::LogLimit _log_limit; \
+    if(auto _log_prefix = ::pvxs::detail::log_prep(LOGGER, unsigned(LVL), _log_limit)) \
         ::pvxs::detail:: _log_printf_hex(unsigned(LVL), BUF, BUFLEN, "%s " FMT, _log_prefix, __VA_ARGS__);\
     }while(0)
 
@@ -131,6 +153,35 @@ inline void logger_level_set(const char *name, Level lvl) {
 //! Use prior to re-applying new configuration.
 PVXS_API void logger_level_clear();
 
+/** Enable or disable asynchronous logging.
+ *
+ * When enabled, messages are formatted into a per-thread buffer by the logging thread,
+ * and printed through errlog by a background thread.
+ * If a buffer is full, messages are dropped, and a count of dropped messages is printed.
+ * Messages longer than ~500 characters are truncated.
+ * CRIT level messages are always printed synchronously.
+ *
+ * Also configured from environment variable **$PVXS_LOG_ASYNC** (YES or NO) by logger_config_env().
+ *
+ * @since 1.3.0
+ */
+PVXS_API void logger_async_set(bool enable);
+
+/** Limit the rate of WARN and ERR messages from each log_*_printf() call site.
+ *
+ * At most burst messages from one call site are printed during each interval (in seconds).
+ * Further messages are counted, and the count is printed as "suppressed N similar messages"
+ * ahead of the next message printed from that call site.
+ * A burst of zero disables limiting.
+ * CRIT, INFO, and DEBUG messages are never limited.
+ *
+ * Default is 10 messages each 10 seconds.
+ * Also configured from environment variable **$PVXS_LOG_LIMIT** ("burst/interval", eg. "10/10") by logger_config_env().
+ *
+ * @since 1.3.0
+ */
+PVXS_API void logger_limit_set(unsigned burst, double interval);
+
 /** Configure logging from environment variable **$PVXS_LOG**
  *
  * Value of the form "key=VAL,..."
@@ -140,6 +191,8 @@ PVXS_API void logger_level_clear();
  * all internal log messages.
  *
  * VAL may be one of "CRIT", "ERR", "WARN", "INFO", or "DEBUG"
+ *
+ * @since 1.3.0 Also applies **$PVXS_LOG_ASYNC** and **$PVXS_LOG_LIMIT**.  See logger_async_set() and logger_limit_set().
  */
 PVXS_API void logger_config_env();
 
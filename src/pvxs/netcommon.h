@@ -5,8 +5,10 @@
 #  error Include <pvxs/client.h> or <pvxs/server.h>  Do not include netcommon.h directly
 #endif
 
+#include <array>
 #include <string>
 #include <list>
+#include <map>
 #include <memory>
 
 #include <pvxs/version.h>
@@ -54,12 +56,150 @@ struct Report {
         std::shared_ptr<const server::ClientCredentials> credentials;
         //! transmit and receive counters in bytes
         size_t tx{}, rx{};
+        //! Type descriptions sent as a reference to the peer's type cache, and sent in full.
+        //! @since 1.3.0
+        size_t txTypeHit{}, txTypeMiss{};
+        //! Number of entries currently in the send and receive type caches.
+        //! @since 1.3.0
+        size_t txTypes{}, rxTypes{};
+        /** Approximate bytes of memory held by the send and receive type caches,
+         *  by data waiting to be sent, by data received but not yet decoded,
+         *  and by updates queued for subscriptions.
+         *  Arrays shared by several queued updates are counted for each.
+         *  @since 1.3.0
+         */
+        size_t memTypes{}, memTx{}, memRx{}, memQueue{};
+        //! Byte order (true for big endian) of messages sent to, and last received from, the peer.
+        //! @since 1.3.0
+        bool sendBE{}, peerBE{};
+        //! Number of channels currently connected through this socket.
+        //! Also filled in when report() omits the channels list.
+        //! @since 1.3.0
+        size_t nChannels{};
         //! Channels currently connected through this socket
         std::list<Channel> channels;
     };
 
     //! Currently open sockets
     std::list<Connection> connections;
+
+    //! Approximate bytes of memory held by process wide subsystems.  cf. memorySnapshot()
+    //! @since 1.3.0
+    std::map<std::string, size_t> memory;
+
+    //! Client only.  Number of Channels waiting for a search reply,
+    //! names sent by the latest tick of the search timer, and names sent in total.
+    //! @since 1.3.0
+    size_t searchPending{}, searchLastTick{}, searchSent{};
+    //! Client only.  Number of search datagrams sent in total.
+    //! @since 1.3.0
+    size_t searchPackets{};
+
+    /** Histogram of operation latencies, with logarithmic buckets.
+     *
+     * count[0] counts latencies less than 1 us.
+     * count[i] counts latencies of at least 2^(i-1) us, and less than 2^i us.
+     * The last bucket also counts any longer latencies.
+     *
+     * @since 1.3.0
+     */
+    struct Latency {
+        static constexpr size_t nBuckets = 24u;
+        std::array<size_t, nBuckets> count{};
+
+        //! Number of latencies counted in all buckets
+        size_t total() const {
+            size_t ret = 0u;
+            for(auto c : count)
+                ret += c;
+            return ret;
+        }
+    };
+
+    //! Latencies of each type of operation
+    //! @since 1.3.0
+    struct Latencies {
+        /** Server: from the time an ExecOp is passed to a Source until its reply() or error() is sent.
+         *  Client: from the time an operation sends its request until the reply is received.
+         */
+        Latency get, put, rpc;
+        //! Server only.  From MonitorControlOp::post() until the update is sent.
+        Latency monitor;
+    };
+
+    /** Operation latencies.
+     *
+     *  Server::report() has an entry for each Source, by name, which has accepted some channel.
+     *  Context::report() has one entry, with an empty name.
+     *
+     * @since 1.3.0
+     */
+    std::map<std::string, Latencies> latency;
+
+    /** Time spent in the callbacks of one Source.
+     *
+     * Measured as elapsed time on the calling worker thread, during which
+     * no other client of that worker is served.
+     *
+     * @since 1.3.0
+     */
+    struct SourceTime {
+        //! Order given to Server::addSource()
+        int order{};
+        //! Number of calls to, and total seconds spent in, Source::onSearch()
+        size_t nSearch{};
+        double search{};
+        //! Number of calls to, and total seconds spent in, Source::onCreate()
+        size_t nCreate{};
+        double create{};
+        /** Number of calls to, and total seconds spent in, the handlers of channels claimed by this Source.
+         *  eg. ChannelControl::onOp(), ConnectOp::onGet(), ChannelControl::onRPC(), and ChannelControl::onSubscribe()
+         */
+        size_t nOp{};
+        double op{};
+    };
+
+    /** Server only.  Callback time of each Source, by name.
+     *
+     *  Accumulated since the previous report(true), or since the Source was first added.
+     *
+     * @since 1.3.0
+     */
+    std::map<std::string, SourceTime> sourceTime;
+
+    /** Health of one event loop worker thread.
+     *
+     * Counters accumulate since the previous report(true), or since the worker started.
+     *
+     * @since 1.3.0
+     */
+    struct Worker {
+        //! Worker thread name
+        std::string name;
+        //! Number of queued work items which have been run
+        size_t nWork{};
+        //! Total time in seconds spent running queued work items
+        double busy{};
+        //! Number of work items currently queued, and the most queued at once
+        size_t queued{}, maxQueued{};
+        //! Longest time in seconds from queueing a work item until it is run
+        double maxDispatchLatency{};
+        /** Longest delay in seconds of a periodic timer of the worker.
+         *  Large values mean that some callback (not only queued work) has blocked the loop.
+         */
+        double maxLag{};
+        //! Time in seconds over which these counters were accumulated
+        double interval{};
+    };
+
+    /** Event loop workers.
+     *
+     *  Server::report() includes the acceptor and each TCP worker.
+     *  Context::report() includes each TCP worker.
+     *
+     * @since 1.3.0
+     */
+    std::list<Worker> workers;
 };
 
 struct PVXS_API ReportInfo {
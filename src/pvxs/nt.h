@@ -163,6 +163,162 @@ public:
     }
 };
 
+/** A table of named columns, each an array of the same length.
+ *
+ * @code
+ * auto table = pvxs::nt::NTTable{}
+ *                  .add_column(TypeCode::StringA, "name", "Name")
+ *                  .add_column(TypeCode::Float64A, "x", "X Position");
+ * auto value = table.create(); // instantiate a Value, with ".labels" filled in
+ * @endcode
+ *
+ * @since 1.3.0
+ */
+class PVXS_API NTTable {
+    std::vector<Member> _cols;
+    std::vector<std::string> _labels;
+public:
+    /** Append a column.
+     * @param code Array type of the column, eg. TypeCode::Float64A
+     * @param name Field name of the column, in ".value"
+     * @param label Column label.  Defaults to name if empty.
+     */
+    NTTable& add_column(TypeCode code, const std::string& name, const std::string& label = std::string());
+
+    //! A TypeDef which can be appended
+    TypeDef build() const;
+    //! Instantiate, with ".labels" filled in
+    Value create() const;
+};
+
+/** Access to the columns of an NTTable by index, with field lookups done once.
+ *
+ * Construct from one instance of a table type.
+ * Then re-use with any Value of that same type, eg. successive monitor updates,
+ * where each column access is an index offset.
+ * Any other type falls back to lookup by name.
+ *
+ * An NTTableColumns is immutable, and so may be shared between threads.
+ *
+ * @code
+ * nt::NTTableColumns cols(update);
+ * auto x = cols.index("x");
+ * // later, with Values of the same type
+ * shared_array<const double> xs(cols.column<double>(update, x));
+ * for(auto row : cols.rows(update)) {
+ *     double v = row.get<double>(x);
+ * }
+ * // build a table of nrows, allocating each column once
+ * shared_array<double> newx(nrows);
+ * ... fill in newx ...
+ * cols.assign(update, x, newx.freeze());
+ * @endcode
+ *
+ * @since 1.3.0
+ */
+class PVXS_API NTTableColumns {
+    std::vector<std::string> _names;
+    std::vector<FieldRef> _refs;
+public:
+    class Rows;
+
+    //! Empty.  No columns.
+    NTTableColumns() = default;
+    //! Resolve the columns (members of ".value") of a table, in order.
+    explicit NTTableColumns(const Value& table);
+
+    //! Number of columns
+    inline size_t size() const { return _refs.size(); }
+    //! Column names, in order
+    inline const std::vector<std::string>& names() const { return _names; }
+    //! Index of named column.  @throws std::out_of_range if no such column
+    size_t index(const std::string& name) const;
+
+    //! The field of column col in table.  @throws std::out_of_range if col>=size()
+    inline
+    const Value field(const Value& table, size_t col) const { return table[_refs.at(col)]; }
+    inline
+    Value field(Value& table, size_t col) const { return table[_refs.at(col)]; }
+
+    /** Column col of table, without copying.
+     *
+     * @throws std::logic_error if the column element type is not T
+     * @throws std::out_of_range if col>=size()
+     */
+    template<typename T>
+    shared_array<const T> column(const Value& table, size_t col) const {
+        return field(table, col).template as<shared_array<const void>>().template castTo<const T>();
+    }
+
+    /** Store column col of table, without copying.
+     *
+     * @throws std::out_of_range if col>=size()
+     */
+    template<typename T>
+    void assign(Value& table, size_t col, const shared_array<const T>& arr) const {
+        field(table, col).from(arr);
+    }
+
+    //! Number of rows.  The length of the shortest column.
+    size_t nrows(const Value& table) const;
+
+    //! Iterate the rows of table
+    Rows rows(const Value& table) const;
+};
+
+/** The rows of an NTTable, as returned by NTTableColumns::rows()
+ *
+ * Holds a reference to each column array, so remains valid even if the table
+ * is later changed.
+ *
+ * @since 1.3.0
+ */
+class NTTableColumns::Rows {
+    friend class NTTableColumns;
+    std::vector<shared_array<const void>> _cols;
+    size_t _nrows = 0u;
+public:
+    //! One row.  Element of each column at the same index.
+    class Row {
+        const Rows* _rows;
+        size_t _idx;
+    public:
+        constexpr Row(const Rows* rows, size_t idx) :_rows(rows), _idx(idx) {}
+        //! Index of this row
+        inline size_t index() const { return _idx; }
+        /** Element of column col in this row.
+         *
+         * @throws std::logic_error if the column element type is not T
+         * @throws std::out_of_range if col is not a column index
+         */
+        template<typename T>
+        const T& get(size_t col) const {
+            auto& arr = _rows->_cols.at(col);
+            if(arr.original_type()!=detail::CaptureBase<T>::code)
+                detail::_throw_bad_cast(arr.original_type(), detail::CaptureBase<T>::code);
+            return static_cast<const T*>(arr.data())[_idx];
+        }
+    };
+
+    class iterator {
+        const Rows* _rows;
+        size_t _idx;
+    public:
+        constexpr iterator(const Rows* rows, size_t idx) :_rows(rows), _idx(idx) {}
+        inline Row operator*() const { return Row(_rows, _idx); }
+        inline iterator& operator++() { _idx++; return *this; }
+        inline iterator operator++(int) { iterator ret(*this); _idx++; return ret; }
+        inline bool operator==(const iterator& o) const { return _idx==o._idx; }
+        inline bool operator!=(const iterator& o) const { return _idx!=o._idx; }
+    };
+
+    //! Number of rows
+    inline size_t size() const { return _nrows; }
+    inline Row operator[](size_t idx) const { return Row(this, idx); }
+    inline iterator begin() const { return iterator(this, 0u); }
+    inline iterator end() const { return iterator(this, _nrows); }
+};
+
 }} // namespace pvxs::nt
 
 #endif // PVXS_NT_H
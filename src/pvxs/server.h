@@ -129,6 +129,17 @@ public:
     //! @param zero If true, zero counters after reading
     //! @since 0.2.0
     Report report(bool zero=true) const;
+    /** Compile report about peers, and maybe channels.
+     *
+     *  Each connection is visited separately, so a report does not block a worker
+     *  for longer than it takes to visit the channels of one connection.
+     *
+     *  @param zero If true, zero counters after reading
+     *  @param channels If false, omit Report::Connection::channels and Report::Connection::memQueue .
+     *                  Visits only connections, regardless of the number of channels.
+     *  @since 1.3.0
+     */
+    Report report(bool zero, bool channels) const;
 #endif
 
     explicit operator bool() const { return !!pvt; }
@@ -171,6 +182,114 @@ struct PVXS_API Config {
     //! @since 0.2.0
     double tcpTimeout = 40.0;
 
+    //! Number of worker threads which handle TCP connections.
+    //! Each new connection is assigned to the worker with the fewest connections,
+    //! and remains on that worker until closed.
+    //! Zero or one (default) handle all connections on the same thread which
+    //! accepts connections and sends beacons.
+    //! @since 1.3.0
+    unsigned tcpWorkers = 1u;
+
+    /** With more than one tcpWorkers, each worker listens on its own socket bound, with SO_REUSEPORT,
+     *  to the same address.  The OS then spreads new connections between workers,
+     *  which accept them in parallel.  Otherwise, all connections are accepted by one thread.
+     *  Only effective on Linux.
+     *
+     *  Another process of the same user, which also sets SO_REUSEPORT, may then bind the same port.
+     *  @since 1.3.0
+     */
+    bool tcpReusePort = false;
+
+    //! Number of worker threads which handle Search requests.
+    //! Each client reply address is assigned to one worker by hash,
+    //! so the searches of one client are handled in order.
+    //! Zero or one (default) handle all searches on the thread which receives UDP.
+    //! With more than one, Source::onSearch() may be called concurrently.
+    //! @since 1.3.0
+    unsigned searchWorkers = 1u;
+
+    //! TCP socket send buffer size (SO_SNDBUF) in bytes.  Zero (default) keeps the OS default.
+    //! @since 1.3.0
+    unsigned tcpSendBuffer = 0u;
+    //! TCP socket receive buffer size (SO_RCVBUF) in bytes.  Zero (default) keeps the OS default.
+    //! @since 1.3.0
+    unsigned tcpRecvBuffer = 0u;
+    //! Disable Nagle's algorithm (TCP_NODELAY) on TCP connections.
+    //! @since 1.3.0
+    bool tcpNoDelay = false;
+    //! Busy poll interval (SO_BUSY_POLL) in microseconds.  Zero (default) disables.
+    //! Only effective on Linux.
+    //! @since 1.3.0
+    unsigned tcpBusyPoll = 0u;
+    //! Limit of unsent bytes in the socket send buffer (TCP_NOTSENT_LOWAT).  Zero (default) keeps the OS default.
+    //! Only effective on Linux and OSX.
+    //! @since 1.3.0
+    unsigned tcpNotSentLowat = 0u;
+    /** Enable TCP keepalive (SO_KEEPALIVE) on TCP connections, with probing timed
+     *  so that a dead peer is detected after about tcpTimeout.
+     *  When the peer also enables this option, an idle connection is not timed out,
+     *  and the client does not send periodic ECHO to keep it open.
+     *  An occasional ECHO is still sent to sample the round trip time.
+     *  Peers without this option continue to exchange ECHO as before.
+     *  @since 1.3.0
+     */
+    bool tcpKeepAlive = false;
+
+    //! List of CPU numbers and ranges, eg. "2,4-5", to which acceptor and TCP worker threads are restricted.
+    //! Empty (default) for no restriction.  Only effective on Linux.
+    //! Several groups separated by ';', eg. "0-7;8-15", place TCP worker N in group N%ngroups,
+    //! and the acceptor in the first.  "numa" for one group per NUMA node.
+    //! Buffers allocated by a worker are then (by the OS first touch policy) usually local to its node.
+    //! @since 1.3.0
+    std::string tcpWorkerCPUs;
+    //! EPICS thread priority of acceptor and TCP worker threads.  Zero (default) keeps the built-in priority.
+    //! Whether a real-time scheduling policy is used follows the EPICS OSI thread configuration.
+    //! @since 1.3.0
+    unsigned tcpWorkerPriority = 0u;
+
+    //! Reject searches for names which no Source will claim, before calling Source::onSearch().
+    //! Built from the Source::onList() of each added Source, and rebuilt when Sources are added or removed.
+    //! Any Source with a dynamic list disables this filter while it is added.
+    //! @since 1.3.0
+    bool searchFilter = false;
+
+    //! Name of a PV, served by this server, with periodically updated statistics.
+    //! Per-connection TX/RX rates and backlog, per-subscription queue fill, Source callback times,
+    //! and InstCounter totals.
+    //! Empty (default) disables.
+    //! @since 1.3.0
+    std::string statsPV;
+    //! Interval between updates of statsPV.  (seconds)
+    //! @since 1.3.0
+    double statsInterval = 1.0;
+
+    /** Approximate limit on the bytes which the subscription queues of one client connection may hold.
+     *  Estimated as queue size times the size of the subscription type.
+     *  Subscriptions created while near this limit are given smaller queues,
+     *  so updates are squashed sooner.  Once the limit is reached, new subscriptions are refused.
+     *  Zero (default) for no limit.
+     *  @since 1.3.0
+     */
+    size_t connMemoryLimit = 0u;
+
+    /** When not empty, a directory in which a Unix domain socket is also created.
+     *  Clients on this host with the same client::Config::unixSocketDir
+     *  connect through this socket instead of TCP.
+     *  The socket is named for the TCP port, so only one Server on a host may use each port.
+     *  Only effective on Unix-like targets.
+     *  @since 1.3.0
+     */
+    std::string unixSocketDir;
+
+    /** Send to each client in the byte order which that client uses,
+     *  instead of this server's native byte order.
+     *  So clients of a different byte order than the server need not swap received data.
+     *  Negotiated with each client when it connects.  Clients which do not support this,
+     *  including PVXS prior to 1.3.0, continue to receive the server's byte order.
+     *  @since 1.3.0
+     */
+    bool peerByteOrder = false;
+
     //! Server unique ID.  Only meaningful in readback via Server::config()
     ServerGUID guid{};
 
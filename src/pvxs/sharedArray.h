@@ -54,6 +54,37 @@ size_t elementSize(ArrayType type);
 PVXS_API
 shared_array<void> allocArray(ArrayType type, size_t count);
 
+/** Source of storage for arrays of plain element types.
+ *
+ * eg. to receive arrays in memory aligned for SIMD, or pinned for DMA.
+ *
+ * @since 1.3.0
+ */
+struct PVXS_API ArrayAllocator {
+    virtual ~ArrayAllocator();
+    //! Return uninitialized storage for at least nbytes.
+    //! @throws std::bad_alloc
+    virtual void* allocate(size_t nbytes) =0;
+    //! Release storage returned by allocate() with the same nbytes.
+    //! May be called from any thread.
+    virtual void deallocate(void* mem, size_t nbytes) noexcept =0;
+
+    //! Allocator of storage aligned to a multiple of 'align' bytes.
+    //! @pre align is a power of 2
+    static
+    std::shared_ptr<ArrayAllocator> aligned(size_t align);
+};
+
+/** Return a void array usable for the given storage type.
+ *
+ * Arrays of Bool, Integer, or Real elements are allocated through alloc,
+ * and are zero'd.  Other types, or a nullptr alloc, as allocArray(type, count).
+ *
+ * @since 1.3.0
+ */
+PVXS_API
+shared_array<void> allocArray(ArrayType type, size_t count, const std::shared_ptr<ArrayAllocator>& alloc);
+
 namespace detail {
 template<typename T>
 struct CaptureCode;
@@ -22,6 +22,36 @@ namespace server {
 struct ChannelControl;
 struct Source;
 
+/** Worker threads to run SharedPV onPut() and onRPC() handlers,
+ *  instead of the Server worker, so that a slow handler does not delay other clients.
+ *
+ *  Copies share the same threads.  Workers stop when the last copy is destroyed,
+ *  after running any queued handlers.  Later handlers are run on the Server worker.
+ *
+ *  @code
+ *  HandlerPool pool(4u);
+ *  auto pv(SharedPV::buildMailbox());
+ *  pv.handlerPool(pool);
+ *  @endcode
+ *
+ *  @since 1.3.0
+ */
+struct PVXS_API HandlerPool
+{
+    //! Empty pool.  Handlers run on the Server worker.
+    HandlerPool() = default;
+    //! Start nworkers threads.
+    explicit HandlerPool(unsigned nworkers);
+    ~HandlerPool();
+
+    inline explicit operator bool() const { return !!impl; }
+
+    struct Impl;
+private:
+    std::shared_ptr<Impl> impl;
+    friend struct SharedPV;
+};
+
 /** A SharedPV is a single data value which may be accessed by multiple clients through a Server.
  *
  * On creation a SharedPV has no associated data structure, or data type.
@@ -61,6 +91,52 @@ struct PVXS_API SharedPV
     //! @note RPC operations are allowed even when the SharedPV is not opened (isOpen()==false)
     void onRPC(std::function<void(SharedPV&, std::unique_ptr<ExecOp>&&, Value&&)>&& fn);
 
+    /** Run onPut() and onRPC() handlers with a HandlerPool.
+     *
+     * @param pool The pool of workers.  An empty HandlerPool restores the default,
+     *             of running handlers on the Server worker.
+     * @param serialize If true, handlers of this SharedPV run one at a time, in order received.
+     *                  If false, they may run concurrently.
+     *
+     * @since 1.3.0
+     */
+    void handlerPool(const HandlerPool& pool, bool serialize=true);
+
+    /** "Latest wins" for Puts waiting on a busy onPut() handler.
+     *
+     * When enabled, and handlers are serialized through a HandlerPool,
+     * a Put from a client which already has a Put to this SharedPV waiting
+     * takes the place of the waiting Put.  The superseded Put completes with
+     * an error "Superseded".  So a stream of setpoints sees bounded latency.
+     *
+     * Has no effect when handlers run on the Server worker, where Puts do not queue.
+     *
+     * @since 1.3.0
+     */
+    void coalescePuts(bool latestWins=true);
+
+    /** When enabled, post() sends to subscribers only those marked fields
+     *  whose values differ from the current value.  A post() which changes
+     *  no field is not sent at all.  cf. Value::markChanged()
+     *
+     *  @since 1.3.0
+     */
+    void postOnlyChanged(bool onlyChanged=true);
+
+    /** Also send each update to a UDP multicast group, where it may be received
+     *  by any number of clients with client::MonitorBuilder::multicast().
+     *  Each datagram includes the full value, so a lost datagram is recovered by the next.
+     *  The latest value is re-sent every heartbeat seconds.  After close(), nothing is sent.
+     *
+     *  @param name PV name included in each datagram.  Subscribers select updates by this name.
+     *  @param dest Destination "<IP46>:<port#>[,<ttl#>][@iface]".  An empty string stops sending.
+     *  @param heartbeat Period of re-sending.  Zero disables.
+     *  @throws std::runtime_error if dest is not valid.
+     *
+     *  @since 1.3.0
+     */
+    void multicast(const std::string& name, const std::string& dest, double heartbeat=1.0);
+
     /** Provide data type and initial value.  Allows clients to begin connecting.
      * @pre !isOpen()
      * @param initial Defines data type, and initial value
@@ -73,6 +149,14 @@ struct PVXS_API SharedPV
 
     //! Update the internal data value, and dispatch subscription updates to any clients.
     void post(const Value& val);
+    /** As post(const Value&), taking ownership of val.
+     *
+     *  The caller must not keep any other reference to val, which is queued to subscribers
+     *  without a copy.  val is left empty.
+     *
+     *  @since 1.3.0
+     */
+    void post(Value&& val);
     //! query the internal data value and update the provided Value.
     void fetch(Value& val) const;
     //! Return a (shallow) copy of the internal data value
@@ -107,6 +191,26 @@ struct PVXS_API StaticSource
     //! Remove a single name
     StaticSource& remove(const std::string& name);
 
+    /** Add a name through which a client may read the current values of many
+     *  of the PVs of this StaticSource with a single RPC.
+     *
+     *  The RPC argument must have a field "query.names" (eg. NTURI) or "names",
+     *  which is either a string array, or a comma separated string.
+     *  The reply is an NTTable with columns "name", "value" (array of any), and "error".
+     *  Each value is read under the lock of its SharedPV, without creating a channel.
+     *  "error" is empty for a successful read.
+     *
+     *  @since 1.3.0
+     */
+    StaticSource& addSnapshot(const std::string& name);
+
+    /** SharedPV::handlerPool() for all PVs of this StaticSource,
+     *  including those add()ed later.
+     *
+     *  @since 1.3.0
+     */
+    StaticSource& handlerPool(const HandlerPool& pool, bool serialize=true);
+
     typedef std::map<std::string, SharedPV> list_t;
     list_t list() const;
 
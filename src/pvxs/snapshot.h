@@ -0,0 +1,88 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef PVXS_SNAPSHOT_H
+#define PVXS_SNAPSHOT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pvxs/version.h>
+#include <pvxs/data.h>
+
+namespace pvxs {
+
+/** Write a file of named Values, for later random access through Snapshot.
+ *
+ * Each distinct type is stored once.  Each Value is stored with the PVA encoding,
+ * and is found through an index sorted by name.
+ *
+ * @code
+ * SnapshotWriter W("pvs.snap");
+ * for(auto& pv : pvs)
+ *     W.add(pv.first, pv.second);
+ * W.close();
+ * @endcode
+ *
+ * @since 1.3.0
+ */
+class PVXS_API SnapshotWriter {
+    struct Pvt;
+    std::unique_ptr<Pvt> pvt;
+public:
+    //! Create, or overwrite, file
+    //! @throws std::runtime_error if the file can not be opened
+    explicit SnapshotWriter(const std::string& fname);
+    //! close() if not already done.  Errors are logged.
+    ~SnapshotWriter();
+
+    /** Append a Value.
+     *
+     * All fields are stored, whether marked or not.
+     * If name was previously added, then it is replaced.
+     * @pre val must not be empty
+     */
+    void add(const std::string& name, const Value& val);
+
+    //! Write index and finish file.
+    //! @throws std::runtime_error on I/O error
+    void close();
+};
+
+/** Read access to a file written by SnapshotWriter.
+ *
+ * Opening reads only the file header and index.  On targets which support it,
+ * the file is memory mapped, and each Value is decoded on demand by get().
+ *
+ * get() may be called concurrently.
+ *
+ * @since 1.3.0
+ */
+class PVXS_API Snapshot {
+    struct Pvt;
+    std::shared_ptr<const Pvt> pvt;
+public:
+    Snapshot() = default;
+    //! @throws std::runtime_error if the file can not be read, or is not valid.
+    explicit Snapshot(const std::string& fname);
+    ~Snapshot();
+
+    //! Number of Values
+    size_t size() const;
+    //! Names of all Values, sorted.
+    std::vector<std::string> names() const;
+
+    /** Decode one Value.
+     *
+     * @returns A new Value, or an empty Value if name is not present.
+     * @throws std::runtime_error if the stored Value can not be decoded.
+     */
+    Value get(const std::string& name) const;
+};
+
+} // namespace pvxs
+
+#endif // PVXS_SNAPSHOT_H
@@ -26,6 +26,18 @@ protected:
 public:
     const Value& pvRequest() const { return _pvRequest; }
 
+    /** The fields of prototype which the client pvRequest() selects.
+     *
+     *  Returns prototype.cloneEmpty() with the selected fields marked.
+     *  Test with eg. ``selected(prototype)["display"].isMarked(true, true)``.
+     *  Un-selected fields will not be sent to this client,
+     *  so a Source may skip reading or copying them.
+     *
+     *  @throws std::runtime_error if pvRequest() does not select any fields of prototype.
+     *  @since 1.3.0
+     */
+    Value selected(const Value& prototype) const;
+
     //! For GET_FIELD, GET, or PUT.  Inform peer of our data-type.
     //! @throws std::runtime_error if the client pvRequest() field mask does not select any fields of prototype.
     virtual void connect(const Value& prototype) =0;
@@ -81,6 +93,9 @@ struct PVXS_API MonitorControlOp : public OpBase {
 
 protected:
     virtual bool doPost(const Value& val, bool maybe, bool force) =0;
+    //! Take ownership of val.  Default calls doPost()
+    //! @since 1.3.0
+    virtual bool doPostMove(Value&& val, bool maybe, bool force) { return doPost(val, maybe, force); }
 public:
 
     //! Add a new entry to the monitor queue.
@@ -90,6 +105,11 @@ public:
     bool forcePost(const Value& val) {
         return doPost(val, false, true);
     }
+    //! As forcePost(const Value&), taking ownership of val.
+    //! @since 1.3.0
+    bool forcePost(Value&& val) {
+        return doPostMove(std::move(val), false, true);
+    }
 
     //! Add a new entry to the monitor queue.
     //! If nFree()<=0 this element will be "squashed" to the last element in the queue
@@ -98,6 +118,11 @@ public:
     bool post(const Value& val) {
         return doPost(val, false, false);
     }
+    //! As post(const Value&), taking ownership of val.
+    //! @since 1.3.0
+    bool post(Value&& val) {
+        return doPostMove(std::move(val), false, false);
+    }
 
     //! Add a new entry to the monitor queue.
     //! If nFree()<=0 return false and take no other action
@@ -106,6 +131,11 @@ public:
     bool tryPost(const Value& val) {
         return doPost(val, true, false);
     }
+    //! As tryPost(const Value&), taking ownership of val.
+    //! @since 1.3.0
+    bool tryPost(Value&& val) {
+        return doPostMove(std::move(val), true, false);
+    }
 
     //! Signal to subscriber that this subscription will not yield any further events.
     //! This is not an error.  Client should not retry.
@@ -127,6 +157,17 @@ public:
      */
     virtual void setWatermarks(size_t low, size_t high) =0;
 
+    /** Set the share of a busy connection given to updates of this subscription.
+     *
+     *  When the server must delay updates because a client is not reading fast enough,
+     *  updates of higher priority subscriptions are sent more often than those of lower priority.
+     *  Priority is in the range [0, 3], and is initially taken from the client pvRequest "record._options.priority".
+     *  The default is zero.  Larger values are treated as 3.
+     *
+     *  @since 1.3.0
+     */
+    virtual void setPriority(unsigned priority);
+
     //! Callback when client resumes/pauses updates
     virtual void onStart(std::function<void(bool start)>&&) =0;
     virtual void onHighMark(std::function<void()>&&) =0;
@@ -140,6 +181,18 @@ protected:
 public:
     const Value& pvRequest() const { return _pvRequest; }
 
+    /** The fields of prototype which the client pvRequest() selects.
+     *
+     *  Returns prototype.cloneEmpty() with the selected fields marked.
+     *  Test with eg. ``selected(prototype)["display"].isMarked(true, true)``.
+     *  Un-selected fields will not be sent to this client,
+     *  so a Source may skip reading or copying them.
+     *
+     *  @throws std::runtime_error if pvRequest() does not select any fields of prototype.
+     *  @since 1.3.0
+     */
+    Value selected(const Value& prototype) const;
+
     //! Inform peer of our data-type and acquire control of subscription queue.
     //! The queue is initially stopped.
     //! @throws std::runtime_error if the client pvRequest() field mask does not select any fields of prototype.
@@ -215,11 +268,26 @@ struct PVXS_API Source {
      *   }
      * @endcode
      */
+    /** Handle for a claim decided after onSearch() has returned.  cf. Search::Name::defer()
+     *
+     *  @since 1.3.0
+     */
+    struct PVXS_API SearchClaim {
+        virtual ~SearchClaim();
+        /** Claim the name, and send a positive search reply to the client.
+         *
+         *  Only the first call has any effect.  May be called from any thread.
+         *  If never called, no reply is sent, and the client will search again later.
+         */
+        virtual void claim() =0;
+    };
+
     struct Search {
         //! A single name being searched
         class Name {
             const char* _name = nullptr;
             bool _claim = false;
+            std::shared_ptr<SearchClaim> _defer;
             friend struct Server::Pvt;
             friend struct impl::ServerConn;
         public:
@@ -227,6 +295,17 @@ struct PVXS_API Source {
             inline const char* name() const { return _name; }
             //! The caller claims to be able to respond to an onCreate() for this name.
             inline void claim() { _claim = true; }
+            /** Decide later whether to claim this name.
+             *
+             *  eg. a gateway which must first search upstream.
+             *  SearchClaim::claim() may then be called after onSearch() returns,
+             *  which sends a separate search reply for this name.
+             *  Has no effect if claim() is also called.
+             *
+             *  @since 1.3.0
+             */
+            PVXS_API
+            std::shared_ptr<SearchClaim> defer();
             // TODO claim w/ redirect
         };
     private:
@@ -252,7 +331,9 @@ struct PVXS_API Source {
      *
      * A Source may only Search::Name::claim() a Channel name if it is prepared to
      * immediately accept an onCreate() call for that Channel name.
-     * In other situations it should wait for the client to retry.
+     * In other situations it should Search::Name::defer(), or wait for the client to retry.
+     *
+     * Called from a server worker thread, which should not be blocked.
      */
     virtual void onSearch(Search& op) =0;
 
@@ -283,6 +364,19 @@ struct PVXS_API Source {
 
     //! Print status information.
     virtual void show(std::ostream& strm);
+
+    /** Several Channels are being created together.  eg. those named by one CREATE_CHANNEL message.
+     *
+     *  Each non-NULL entry is to be handled as if passed to onCreate().
+     *  Entries left non-NULL, and not accepted or rejected, are offered to the next Source.
+     *  NULL entries have already been handled, and should be skipped.
+     *
+     *  The default calls onCreate() for each non-NULL entry.
+     *  A Source may override to amortize eg. locking and lookups over all entries.
+     *
+     *  @since 1.3.0
+     */
+    virtual void onCreateMany(std::vector<std::unique_ptr<ChannelControl>>& ops);
 };
 
 }} // namespace pvxs::server
@@ -29,6 +29,35 @@ namespace pvxs {
 PVXS_API
 void testSetup();
 
+/** Emulated network impairment.  cf. testNetImpair()
+ *
+ * @since 1.3.0
+ */
+struct NetImpairment {
+    //! Delay, in seconds, added to data received by each TCP connection.
+    double latency = 0.0;
+    //! Limit, in bytes per second, on each TCP connection in each direction.  Zero for no limit.
+    size_t bandwidth = 0u;
+    /** Probability, in [0, 1], of loss.
+     *
+     *  UDP datagrams received are dropped.
+     *  TCP can not lose data, so a read is instead held for a further 200 ms, as for a retransmission.
+     */
+    double loss = 0.0;
+};
+
+/** Emulate network impairment for all clients and servers in this process.
+ *
+ * Allows flow control to be exercised over loopback.  eg. with server::Config::isolated() .
+ * Latency and bandwidth apply to TCP connections opened later.  Loss of UDP applies immediately.
+ *
+ * @param imp A default constructed NetImpairment to disable.
+ *
+ * @since 1.3.0
+ */
+PVXS_API
+void testNetImpair(const NetImpairment& imp);
+
 /** Free some internal global allocations to avoid false positives in
  *  valgrind (or similar) tools looking for memory leaks.
  *
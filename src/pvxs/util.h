@@ -9,6 +9,7 @@
 
 #include <map>
 #include <array>
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <iosfwd>
@@ -16,6 +17,8 @@
 #include <stdexcept>
 #include <memory>
 
+#include <stddef.h>
+
 #include <osiSock.h>
 #include <epicsEvent.h>
 #include <epicsMutex.h>
@@ -122,10 +125,58 @@ public:
 
 #endif // !defined(__rtems__) && !defined(vxWorks)
 
-//! return a snapshot of internal instance counters
+/** return a snapshot of internal instance counters
+ *
+ * Empty if PVXS was built with -DPVXS_DISABLE_INST_COUNTER
+ */
 PVXS_API
 std::map<std::string, size_t> instanceSnapshot();
 
+/** return a snapshot of the approximate bytes of memory held by some subsystems.
+ *
+ * - "Value" storage of all Values (not including strings and arrays),
+ * - "UDP" receive buffers.
+ *
+ * Memory held by each connection is reported by Server::report() and Context::report().
+ * Empty if PVXS was built with -DPVXS_DISABLE_INST_COUNTER
+ *
+ * @since 1.3.0
+ */
+PVXS_API
+std::map<std::string, size_t> memorySnapshot();
+
+/** Enable or disable capture of recent PVA messages on each TCP connection.
+ *
+ * When enabled, each new TCP connection, of any client or server in this process,
+ * keeps a circular buffer of the most recent messages sent and received.
+ * At most the first 4096 bytes of each message are kept.
+ * Captured messages are written out by wireCaptureDump().
+ *
+ * Also enabled by environment variable **$PVXS_WIRE_CAPTURE** (buffer size in bytes).
+ *
+ * @param nbytes Buffer size of each connection.  Zero to disable.  Only affects connections opened later.
+ *
+ * @since 1.3.0
+ */
+PVXS_API
+void wireCaptureSet(size_t nbytes);
+
+/** Write messages captured on current TCP connections to a file in pcap format.
+ *
+ * Records of all connections are interleaved by time, and use link type LINKTYPE_USER0 (147).
+ * Each record begins with a pseudo header of a direction byte (0 received, 1 sent),
+ * a peer name length byte, and the peer name.
+ * This is followed by the PVA message header and body, which may be truncated.
+ *
+ * @param fname Output file name.  Overwritten if it exists.
+ * @returns The number of messages written.
+ * @throws std::runtime_error if the file can not be written.
+ *
+ * @since 1.3.0
+ */
+PVXS_API
+size_t wireCaptureDump(const std::string& fname);
+
 //! See Indented
 struct indent {};
 
@@ -210,14 +261,100 @@ std::ostream& version_information(std::ostream&);
  */
 template<typename T>
 class MPMCFIFO {
-    mutable epicsMutex lock;
+    // One slot of the bounded ring.  For the ring position pos, with turn==pos/nlimit,
+    // seq==2*turn when empty and ready for the writer, seq==2*turn+1 when filled
+    // and ready for the reader.
+    struct Cell {
+        std::atomic<size_t> seq{0u};
+        T val;
+    };
+
+    const size_t nlimit;
+
+    // bounded queue (nlimit!=0).  Lock-free ring after D. Vyukov.
+    std::unique_ptr<Cell[]> ring;
+    char pad0[64];
+    std::atomic<size_t> wpos{0u};
+    char pad1[64];
+    std::atomic<size_t> rpos{0u};
+    char pad2[64];
+    // number of threads blocked, or about to block, in emplace() or pop()
+    std::atomic<unsigned> nwaitW{0u}, nwaitR{0u};
     epicsEvent notifyW, notifyR;
+
+    // unbounded queue (nlimit==0)
+    mutable epicsMutex lock;
     std::deque<T> Q;
-    const size_t nlimit;
-    unsigned nwriters=0u, nreaders=0u;
+    unsigned nreaders=0u;
 
     typedef epicsGuard<epicsMutex> Guard;
     typedef epicsGuardRelease<epicsMutex> UnGuard;
+
+    bool tryPush(T& ent) {
+        auto pos(wpos.load(std::memory_order_relaxed));
+        while(true) {
+            auto& cell = ring[pos % nlimit];
+            auto turn(2u*(pos/nlimit));
+            auto dif = ptrdiff_t(cell.seq.load(std::memory_order_acquire) - turn);
+            if(dif==0) {
+                if(wpos.compare_exchange_weak(pos, pos+1u, std::memory_order_relaxed)) {
+                    cell.val = std::move(ent);
+                    cell.seq.store(turn+1u, std::memory_order_release);
+                    return true;
+                }
+            } else if(dif<0) {
+                return false; // full
+            } else {
+                pos = wpos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& ret) {
+        auto pos(rpos.load(std::memory_order_relaxed));
+        while(true) {
+            auto& cell = ring[pos % nlimit];
+            auto turn(2u*(pos/nlimit));
+            auto dif = ptrdiff_t(cell.seq.load(std::memory_order_acquire) - (turn+1u));
+            if(dif==0) {
+                if(rpos.compare_exchange_weak(pos, pos+1u, std::memory_order_relaxed)) {
+                    ret = std::move(cell.val);
+                    cell.val = T(); // release any resources now, as std::deque::pop_front() would
+                    cell.seq.store(turn+2u, std::memory_order_release);
+                    return true;
+                }
+            } else if(dif<0) {
+                return false; // empty
+            } else {
+                pos = rpos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Retry fn() until success, blocking on evt in between.
+    template<typename Fn>
+    static void blockUntil(Fn&& fn, std::atomic<unsigned>& nwait, epicsEvent& evt) {
+        while(true) {
+            // announce before re-checking, so that a concurrent wake() sees us
+            nwait.fetch_add(1u);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ok = fn();
+            if(!ok)
+                evt.wait();
+            nwait.fetch_sub(1u);
+            if(ok)
+                break;
+        }
+        // pass along a wakeup which may have been meant for another waiter
+        wake(nwait, evt);
+    }
+
+    static void wake(std::atomic<unsigned>& nwait, epicsEvent& evt) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(nwait.load(std::memory_order_relaxed))
+            evt.signal();
+    }
+
 public:
     //! Template parameter
     typedef T value_type;
@@ -225,14 +362,23 @@ public:
     //! Construct a new queue
     //! @param limit If non-zero, then emplace()/push() will block while while
     //!              queue size is greater than or equal to this limit.
+    //!              A bounded queue does not lock a mutex, except to block.
     explicit MPMCFIFO(size_t limit=0u)
         :nlimit(limit)
-    {}
+    {
+        if(nlimit)
+            ring.reset(new Cell[nlimit]);
+    }
     //! Destructor is not re-entrant
     ~MPMCFIFO() {}
 
     //! Poll number of elements in the work queue at this moment.
     size_t size() const {
+        if(nlimit) {
+            auto R(rpos.load(std::memory_order_acquire));
+            auto W(wpos.load(std::memory_order_acquire));
+            return ptrdiff_t(W-R) > 0 ? W-R : 0u;
+        }
         Guard G(lock);
         return Q.size();
     }
@@ -246,28 +392,25 @@ public:
      */
     template<typename ...Args>
     void emplace(Args&&... args) {
-        bool wakeupR, wakeupW;
+        if(nlimit) {
+            T ent(std::forward<Args>(args)...);
+            if(!tryPush(ent)) {
+                // while full, wait for reader to consume an entry
+                blockUntil([this, &ent]() { return tryPush(ent); }, nwaitW, notifyW);
+            }
+            wake(nwaitR, notifyR);
+            return;
+        }
+
+        bool wakeupR;
         {
             Guard G(lock);
-            // while full, wait for reader to consume an entry
-            while(nlimit && Q.size()>=nlimit) {
-                nwriters++;
-                {
-                    UnGuard U(G);
-                    notifyW.wait();
-                }
-                nwriters--;
-            }
             // notify reader when queue becomes not empty
             wakeupR = Q.empty() && nreaders;
             Q.emplace_back(std::forward<Args>(args)...);
-            // wakeup next writer if there is still space
-            wakeupW = nwriters && Q.size()<nlimit;
         }
         if(wakeupR)
             notifyR.signal();
-        if(wakeupW)
-            notifyW.signal();
     }
 
     //! Move a new element to the queue
@@ -287,8 +430,18 @@ public:
      * Blocks while queue is empty.
      */
     T pop() {
-        bool wakeupW, wakeupR;
         T ret;
+        if(nlimit) {
+            if(!tryPop(ret)) {
+                // wait for queue to become not empty
+                blockUntil([this, &ret]() { return tryPop(ret); }, nwaitR, notifyR);
+            }
+            // wakeup a writer since the queue will have an empty entry
+            wake(nwaitW, notifyW);
+            return ret;
+        }
+
+        bool wakeupR;
         {
             Guard G(lock);
             // wait for queue to become not empty
@@ -300,8 +453,6 @@ public:
                 }
                 nreaders--;
             }
-            // wakeup a writer since the queue will have an empty entry
-            wakeupW = nwriters;
             ret = std::move(Q.front());
             Q.pop_front();
             // wakeup next reader if entries remain
@@ -309,8 +460,6 @@ public:
         }
         if(wakeupR)
             notifyR.signal();
-        if(wakeupW)
-            notifyW.signal();
         return ret;
     }
 };
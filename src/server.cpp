@@ -24,10 +24,15 @@
 #include <pvxs/server.h>
 #include <pvxs/client.h>
 #include <pvxs/log.h>
+#include <pvxs/nt.h>
 #include "evhelper.h"
 #include "serverconn.h"
+#include "pvrequest.h"
 #include "utilpvt.h"
 #include "udp_collector.h"
+#include "tracepoint.h"
+
+typedef epicsGuard<epicsMutex> Guard;
 
 namespace pvxs {
 namespace impl {
@@ -42,9 +47,34 @@ DEFINE_LOGGER(serversearch, "pvxs.server.search");
 
 // mimic pvAccessCPP server (almost)
 // send a "burst" of beacons, then fallback to a longer interval
+// max. number of PV IDs in one SEARCH_RESPONSE.  Keeps replies within a 1500 byte MTU
+static constexpr size_t maxSearchReplyIDs = 320u;
+
+// key of Server::Pvt::ignoreList for an IPv4 address.  Port zero matches any sender port.
+static inline
+uint64_t ignoreKey(const SockAddr& addr, bool withPort)
+{
+    return (uint64_t(addr->in.sin_addr.s_addr)<<16u) | (withPort ? addr->in.sin_port : 0u);
+}
+
 static constexpr timeval beaconIntervalShort{15, 0};
 static constexpr timeval beaconIntervalLong{180, 0};
 
+namespace {
+// Running Servers, by GUID.  cf. acceptLocalConnection()
+struct LocalServers {
+    epicsMutex lock;
+    std::map<ServerGUID, std::weak_ptr<Server::Pvt>> byGUID;
+};
+
+LocalServers* localServers()
+{
+    // Intentionally never free'd
+    static LocalServers* ret = new LocalServers;
+    return ret;
+}
+} // namespace
+
 Server Server::fromEnv()
 {
     return Config::fromEnv().build();
@@ -88,10 +118,10 @@ Server& Server::addSource(const std::string& name,
     {
         auto G(pvt->sourcesLock.lockWriter());
 
-        auto& ent = pvt->sources[std::make_pair(order, name)];
-        if(ent)
+        auto key(std::make_pair(order, name));
+        if(pvt->sources.find(key)!=pvt->sources.end())
             throw std::runtime_error(SB()<<"Source already registered : ("<<name<<", "<<order<<")");
-        ent = src;
+        pvt->addSourceLocked(key, src);
         pvt->beaconChange++;
     }
     return *this;
@@ -104,12 +134,7 @@ std::shared_ptr<Source> Server::removeSource(const std::string& name,  int order
 
     auto G(pvt->sourcesLock.lockWriter());
 
-    std::shared_ptr<Source> ret;
-    auto it = pvt->sources.find(std::make_pair(order, name));
-    if(it!=pvt->sources.end()) {
-        ret = it->second;
-        pvt->sources.erase(it);
-    }
+    auto ret(pvt->removeSourceLocked(std::make_pair(order, name)));
     pvt->beaconChange++;
 
     return ret;
@@ -167,6 +192,7 @@ client::Config Server::clientConfig() const
     ret.interfaces = pvt->effective.interfaces;
     ret.addressList = pvt->effective.interfaces;
     ret.autoAddrList = false;
+    ret.unixSocketDir = pvt->effective.unixSocketDir;
 
     return ret;
 }
@@ -233,50 +259,175 @@ Server& Server::interrupt()
     return *this;
 }
 
+static
+void reportWorker(Report& report, const evbase& loop, bool zero)
+{
+    auto stats(loop.stats(zero));
+    report.workers.emplace_back();
+    auto& worker = report.workers.back();
+    worker.name = stats.name;
+    worker.nWork = stats.nWork;
+    worker.busy = stats.busy;
+    worker.queued = stats.queued;
+    worker.maxQueued = stats.maxQueued;
+    worker.maxDispatchLatency = stats.maxDispatchLatency;
+    worker.maxLag = stats.maxLag;
+    worker.interval = stats.interval;
+}
+
+static
+void showWorker(std::ostream& strm, const evbase& loop)
+{
+    auto stats(loop.stats(false));
+    Restore R(strm);
+    strm.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    strm.precision(3);
+    strm<<indent{}<<"Worker: "<<stats.name
+        <<" work="<<stats.nWork
+        <<" busy="<<(stats.interval>0.0 ? 100.0*stats.busy/stats.interval : 0.0)<<"%"
+        <<" queued="<<stats.queued<<" maxQueued="<<stats.maxQueued
+        <<" maxLatency="<<stats.maxDispatchLatency*1e3<<"ms"
+        <<" maxLag="<<stats.maxLag*1e3<<"ms\n";
+}
+
 Report Server::report(bool zero) const
+{
+    return report(zero, true);
+}
+
+Report Server::report(bool zero, bool channels) const
 {
     if(!pvt)
         throw std::logic_error("NULL Server");
 
     Report ret;
 
-    pvt->acceptor_loop.call([this, &ret, zero](){
+    for(auto& worker : pvt->workers) {
+        // Visit each connection with a separate call(), so that a report of many
+        // connections, or channels, does not stall the worker for the whole walk.
+        std::vector<std::shared_ptr<ServerConn>> conns;
+        worker->loop.call([&worker, &conns](){
+            conns.reserve(worker->connections.size());
+            for(auto& pair : worker->connections)
+                conns.push_back(pair.second);
+        });
+
+        for(auto& conn : conns) {
+            Report::Connection sconn;
+            bool open = false;
+
+            worker->loop.call([&conn, &sconn, &open, zero, channels](){
+                if(!conn->bev)
+                    return; // closed since listed
+
+                open = true;
+                sconn.peer = conn->peerName;
+                sconn.credentials = conn->cred;
+                sconn.tx = conn->statTx;
+                sconn.rx = conn->statRx;
+                sconn.txTypeHit = conn->txTypes.hits;
+                sconn.txTypeMiss = conn->txTypes.misses;
+                sconn.txTypes = conn->txTypes.size();
+                sconn.rxTypes = conn->rxRegistry.size();
+                conn->memoryUsage(sconn.memTypes, sconn.memTx, sconn.memRx);
+                sconn.sendBE = conn->sendBE;
+                sconn.peerBE = conn->peerBE;
+                sconn.nChannels = conn->chanBySID.size();
 
-        for(auto& pair : pvt->connections) {
-            auto conn = pair.first;
+                if(zero) {
+                    conn->statTx = conn->statRx = 0u;
+                    conn->txTypes.hits = conn->txTypes.misses = 0u;
+                }
 
-            ret.connections.emplace_back();
-            auto& sconn = ret.connections.back();
-            sconn.peer = conn->peerName;
-            sconn.credentials = conn->cred;
-            sconn.tx = conn->statTx;
-            sconn.rx = conn->statRx;
+                if(!channels)
+                    return;
 
-            if(zero) {
-                conn->statTx = conn->statRx = 0u;
-            }
+                for(auto& pair : conn->opByIOID)
+                    sconn.memQueue += pair.second->queueBytes();
 
-            for(auto& pair : conn->chanBySID) {
-                auto& chan = pair.second;
+                for(auto& pair : conn->chanBySID) {
+                    auto& chan = pair.second;
 
-                sconn.channels.emplace_back();
-                auto& schan = sconn.channels.back();
-                schan.name = chan->name;
-                schan.tx = chan->statTx;
-                schan.rx = chan->statRx;
-                schan.info = chan->reportInfo;
+                    sconn.channels.emplace_back();
+                    auto& schan = sconn.channels.back();
+                    schan.name = chan->name;
+                    schan.tx = chan->statTx;
+                    schan.rx = chan->statRx;
+                    schan.info = chan->reportInfo;
 
-                if(zero) {
-                    chan->statTx = chan->statRx = 0u;
+                    if(zero) {
+                        chan->statTx = chan->statRx = 0u;
+                    }
                 }
-            }
+            });
+
+            if(open)
+                ret.connections.push_back(std::move(sconn));
         }
+    }
 
-    });
+    pvt->reportLatency(ret, zero);
+    pvt->reportSourceTime(ret, zero);
+    ret.memory = memorySnapshot();
+
+    reportWorker(ret, pvt->acceptor_loop, zero);
+    for(auto& worker : pvt->workers) {
+        if(worker->loop.base!=pvt->acceptor_loop.base) // a single worker shares acceptor_loop
+            reportWorker(ret, worker->loop, zero);
+    }
 
     return ret;
 }
 
+static_assert(Report::Latency::nBuckets==LatencyHistogram::nBuckets, "Latency bucket count mismatch");
+
+OpLatencies* Server::Pvt::latencyOf(const std::string& source)
+{
+    Guard G(latencyLock);
+    auto& ent = latency[source];
+    if(!ent)
+        ent.reset(new OpLatencies());
+    return ent.get();
+}
+
+void Server::Pvt::reportLatency(Report& report, bool zero)
+{
+    Guard G(latencyLock);
+    for(auto& pair : latency) {
+        auto& ent = report.latency[pair.first];
+        pair.second->get.take(ent.get.count.data(), zero);
+        pair.second->put.take(ent.put.count.data(), zero);
+        pair.second->rpc.take(ent.rpc.count.data(), zero);
+        pair.second->monitor.take(ent.monitor.count.data(), zero);
+    }
+}
+
+void SourceCallTime::Counter::take(size_t& n, double& sec, bool zero)
+{
+    uint64_t c, t;
+    if(zero) {
+        c = count.exchange(0u, std::memory_order_relaxed);
+        t = ns.exchange(0u, std::memory_order_relaxed);
+    } else {
+        c = count.load(std::memory_order_relaxed);
+        t = ns.load(std::memory_order_relaxed);
+    }
+    n += size_t(c);
+    sec += t*1e-9;
+}
+
+void Server::Pvt::reportSourceTime(Report& report, bool zero)
+{
+    auto L(sourcesLock.lockReader());
+    for(auto& pair : sourceTime) {
+        auto& ent = report.sourceTime[pair.first];
+        ent.order = pair.second->order;
+        pair.second->search.take(ent.nSearch, ent.search, zero);
+        pair.second->create.take(ent.nCreate, ent.create, zero);
+        pair.second->op.take(ent.nOp, ent.op, zero);
+    }
+}
+
 std::ostream& operator<<(std::ostream& strm, const Server& serv)
 {
     auto detail = Detailed::level(strm);
@@ -304,10 +455,23 @@ std::ostream& operator<<(std::ostream& strm, const Server& serv)
             }
         }
 
+        if(detail>0) {
+            strm<<indent{}<<"Memory:";
+            for(auto& pair : memorySnapshot())
+                strm<<" "<<pair.first<<"="<<pair.second;
+            strm<<"\n";
+
+            showWorker(strm, serv.pvt->acceptor_loop);
+            for(auto& worker : serv.pvt->workers) {
+                if(worker->loop.base!=serv.pvt->acceptor_loop.base)
+                    showWorker(strm, worker->loop);
+            }
+        }
+
         if(detail<2)
             return strm;
 
-        serv.pvt->acceptor_loop.call([&serv, &strm, detail](){
+        serv.pvt->acceptor_loop.call([&serv, &strm](){
             strm<<indent{}<<"State: ";
             switch(serv.pvt->state) {
 #define CASE(STATE) case Server::Pvt::STATE: strm<< #STATE; break
@@ -318,57 +482,70 @@ std::ostream& operator<<(std::ostream& strm, const Server& serv)
 #undef CASE
             }
             strm<<"\n";
+        });
 
-            Indented I(strm);
-
-            for(auto& pair : serv.pvt->connections) {
-                auto conn = pair.first;
+        Indented I(strm);
+
+        for(auto& worker : serv.pvt->workers) {
+            worker->loop.call([&worker, &strm, detail](){
+                for(auto& pair : worker->connections) {
+                    auto conn = pair.first;
+
+                    strm<<indent{}<<"Peer"<<conn->peerName
+                        <<" backlog="<<conn->backlogSize()
+                        <<" TX="<<conn->statTx<<" RX="<<conn->statRx
+                        <<" types TX="<<conn->txTypes.size()<<" RX="<<conn->rxRegistry.size()
+                        <<" auth="<<conn->cred->method<<"\n";
+                    {
+                        size_t types, tx, rx, queue = 0u;
+                        conn->memoryUsage(types, tx, rx);
+                        for(auto& pair : conn->opByIOID)
+                            queue += pair.second->queueBytes();
+                        Indented I(strm);
+                        strm<<indent{}<<"Memory types="<<types<<" TX="<<tx<<" RX="<<rx<<" queue="<<queue<<"\n";
+                    }
+                    if(detail>2)
+                        strm<<*conn->cred;
 
-                strm<<indent{}<<"Peer"<<conn->peerName
-                    <<" backlog="<<conn->backlog.size()
-                    <<" TX="<<conn->statTx<<" RX="<<conn->statRx
-                    <<" auth="<<conn->cred->method<<"\n";
-                if(detail>2)
-                    strm<<*conn->cred;
+                    if(detail<=2)
+                        continue;
 
-                if(detail<=2)
-                    continue;
+                    Indented I(strm);
 
-                Indented I(strm);
+                    for(auto& pair : conn->chanBySID) {
+                        auto& chan = pair.second;
+                        strm<<indent{}<<chan->name<<" TX="<<chan->statTx<<" RX="<<chan->statRx<<' ';
 
-                for(auto& pair : conn->chanBySID) {
-                    auto& chan = pair.second;
-                    strm<<indent{}<<chan->name<<" TX="<<chan->statTx<<" RX="<<chan->statRx<<' ';
-
-                    if(chan->state==ServerChan::Creating) {
-                        strm<<"CREATING sid="<<chan->sid<<" cid="<<chan->cid<<"\n";
-                    } else if(chan->state==ServerChan::Destroy) {
-                        strm<<"DESTROY  sid="<<chan->sid<<" cid="<<chan->cid<<"\n";
-                    } else if(chan->opByIOID.empty()) {
-                        strm<<"IDLE     sid="<<chan->sid<<" cid="<<chan->cid<<"\n";
-                    }
+                        if(chan->state==ServerChan::Creating) {
+                            strm<<"CREATING sid="<<chan->sid<<" cid="<<chan->cid<<"\n";
+                        } else if(chan->state==ServerChan::Destroy) {
+                            strm<<"DESTROY  sid="<<chan->sid<<" cid="<<chan->cid<<"\n";
+                        } else if(chan->opByIOID.empty()) {
+                            strm<<"IDLE     sid="<<chan->sid<<" cid="<<chan->cid<<"\n";
+                        }
 
-                    for(auto& pair : chan->opByIOID) {
-                        auto& op = pair.second;
-                        if(!op) {
-                            strm<<"NULL ioid="<<pair.first<<"\n";
-                        } else {
-                            strm<<indent{};
-                            switch (op->state) {
+                        for(auto& pair : chan->opByIOID) {
+                            auto& op = pair.second;
+                            if(!op) {
+                                strm<<"NULL ioid="<<pair.first<<"\n";
+                            } else {
+                                strm<<indent{};
+                                switch (op->state) {
 #define CASE(STATE) case ServerOp::STATE: strm<< #STATE; break
-                            CASE(Creating);
-                            CASE(Idle);
-                            CASE(Executing);
-                            CASE(Dead);
+                                CASE(Creating);
+                                CASE(Idle);
+                                CASE(Executing);
+                                CASE(Dead);
 #undef CASE
+                                }
+                                strm<<" ioid="<<pair.first<<" ";
+                                op->show(strm);
                             }
-                            strm<<" ioid="<<pair.first<<" ";
-                            op->show(strm);
                         }
                     }
                 }
-            }
-        });
+            });
+        }
     }
 
     return strm;
@@ -377,17 +554,38 @@ std::ostream& operator<<(std::ostream& strm, const Server& serv)
 Server::Pvt::Pvt(const Config &conf)
     :effective(conf)
     ,beaconMsg(128)
-    ,acceptor_loop("PVXTCP", epicsThreadPriorityCAServerLow-2)
+    ,acceptor_loop(tcpWorkerLoop("PVXTCP", epicsThreadPriorityCAServerLow-2, conf))
     ,beaconSender4(AF_INET, SOCK_DGRAM, 0)
     ,beaconSender6(AF_INET6, SOCK_DGRAM, 0)
     ,beaconTimer(__FILE__, __LINE__,
                  event_new(acceptor_loop.base, -1, EV_TIMEOUT, doBeaconsS, this))
     ,searchReply(0x10000)
     ,builtinsrc(StaticSource::build())
+    ,nameIndex(std::make_shared<NameIndex>())
     ,state(Stopped)
 {
     effective.expand();
 
+    if(effective.tcpWorkers<=1u) {
+        workers.emplace_back(new ServerWorker(acceptor_loop));
+
+    } else {
+        workers.reserve(effective.tcpWorkers);
+        for(auto i : range(effective.tcpWorkers)) {
+            workers.emplace_back(new ServerWorker(tcpWorkerLoop(SB()<<"PVXTCP-"<<i,
+                                                                epicsThreadPriorityCAServerLow-2,
+                                                                effective, i)));
+        }
+    }
+
+    if(effective.searchWorkers>1u) {
+        searchWorkers.reserve(effective.searchWorkers);
+        for(auto i : range(effective.searchWorkers)) {
+            searchWorkers.emplace_back(new SearchWorker(evbase(SB()<<"PVXSRCH-"<<i,
+                                                               epicsThreadPriorityCAServerLow-4)));
+        }
+    }
+
     beaconSender4.set_broadcast(true);
 
     auto manager = UDPManager::instance(effective.shareUDP());
@@ -395,6 +593,7 @@ Server::Pvt::Pvt(const Config &conf)
     evsocket dummy(AF_INET, SOCK_DGRAM, 0);
 
     const auto cb(std::bind(&Pvt::onSearch, this, std::placeholders::_1));
+    const auto done(std::bind(&Pvt::onSearchDone, this, std::placeholders::_1));
 
     bool bindAny = false;
     std::vector<SockAddr> tcpifaces; // may have port zero
@@ -412,7 +611,7 @@ Server::Pvt::Pvt(const Config &conf)
 
         addr.addr.setPort(effective.udp_port);
 
-        listeners.push_back(manager.onSearch(addr, cb));
+        listeners.push_back(manager.onSearch(addr, cb, done));
 
         // update to allow udp_port==0
         effective.udp_port = addr.addr.port();
@@ -427,14 +626,14 @@ Server::Pvt::Pvt(const Config &conf)
             auto any6(addr);
             any6.addr = SockAddr::any(AF_INET6);
 
-            listeners.push_back(manager.onSearch(any6, cb));
+            listeners.push_back(manager.onSearch(any6, cb, done));
 
         } else if(addr.addr.family()==AF_INET6 && addr.addr.isAny()) {
             // if listening on [::], also listen on 0.0.0.0
             auto any4(addr);
             any4.addr = SockAddr::any(AF_INET);
 
-            listeners.push_back(manager.onSearch(any4, cb));
+            listeners.push_back(manager.onSearch(any4, cb, done));
         }
 
         if(evsocket::ipstack!=evsocket::Winsock
@@ -447,7 +646,7 @@ Server::Pvt::Pvt(const Config &conf)
              */
             for(auto bcast : dummy.broadcasts(&addr.addr)) {
                 bcast.setPort(addr.addr.port());
-                listeners.push_back(manager.onSearch(bcast, cb));
+                listeners.push_back(manager.onSearch(bcast, cb, done));
             }
         }
     }
@@ -478,10 +677,13 @@ Server::Pvt::Pvt(const Config &conf)
         log_err_printf(serversetup, "Server Unreachable.  Interface address list includes not TCP interfaces.%s", "\n");
     }
 
-    ignoreList.reserve(effective.ignoreAddrs.size());
     for(const auto& addr : effective.ignoreAddrs) {
         SockAddr temp(addr.c_str());
-        ignoreList.push_back(temp);
+        if(temp.family()!=AF_INET) {
+            log_warn_printf(serversetup, "Ignoring non-IPv4 ignore address '%s'\n", addr.c_str());
+            continue;
+        }
+        ignoreList.insert(ignoreKey(temp, true));
     }
 
 
@@ -500,6 +702,17 @@ Server::Pvt::Pvt(const Config &conf)
             firstiface = false;
         }
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+        if(!effective.unixSocketDir.empty() && !interfaces.empty()) {
+            auto path(unixSocketPath(effective.unixSocketDir, effective.tcp_port));
+            try {
+                interfaces.emplace_back(path, this);
+            }catch(std::exception& e){
+                log_err_printf(serversetup, "Unable to listen on %s : %s\n", path.c_str(), e.what());
+            }
+        }
+#endif
+
         for(const auto& addr : effective.beaconDestinations) {
             beaconDest.emplace_back(addr.c_str(), effective.udp_port);
             log_debug_printf(serversetup, "Will send beacons to %s\n",
@@ -551,11 +764,45 @@ Server::Pvt::Pvt(const Config &conf)
         std::copy(pun.b.begin(), pun.b.end(), effective.guid.begin());
     }
 
+    if(!effective.statsPV.empty()) {
+        statsProto = TypeDef(TypeCode::Struct, {
+                                 Member(TypeCode::Struct, "connections", {
+                                     Member(TypeCode::StringA, "peer"),
+                                     Member(TypeCode::Float64A, "txRate"),
+                                     Member(TypeCode::Float64A, "rxRate"),
+                                     Member(TypeCode::UInt64A, "backlog"),
+                                 }),
+                                 Member(TypeCode::Struct, "monitors", {
+                                     Member(TypeCode::StringA, "peer"),
+                                     Member(TypeCode::StringA, "channel"),
+                                     Member(TypeCode::UInt64A, "queued"),
+                                     Member(TypeCode::UInt64A, "limit"),
+                                 }),
+                                 Member(TypeCode::Struct, "sources", {
+                                     Member(TypeCode::StringA, "name"),
+                                     Member(TypeCode::Int32A, "order"),
+                                     Member(TypeCode::Float64A, "search"),
+                                     Member(TypeCode::Float64A, "create"),
+                                     Member(TypeCode::Float64A, "op"),
+                                 }),
+                                 Member(TypeCode::Struct, "counters", {
+                                     Member(TypeCode::StringA, "name"),
+                                     Member(TypeCode::UInt64A, "count"),
+                                 }),
+                                 nt::TimeStamp{}.build().as("timeStamp"),
+                             }).create();
+        statsPV = SharedPV::buildReadonly();
+        statsPV.open(statsProto.cloneEmpty());
+        statsTimer = evevent(__FILE__, __LINE__,
+                             event_new(acceptor_loop.base, -1, EV_TIMEOUT|EV_PERSIST, doStatsS, this));
+    }
+
     // Add magic "server" PV
     {
         auto L = sourcesLock.lockWriter();
-        sources[std::make_pair(-1, "__server")] = std::make_shared<ServerSource>(this);
-        sources[std::make_pair(-1, "__builtin")] = builtinsrc.source();
+        addSourceLocked(std::make_pair(-1, "__server"), std::make_shared<ServerSource>(this));
+        addSourceLocked(std::make_pair(-1, "__builtin"), builtinsrc.source());
+        rebuildSearchFilterLocked();
     }
 }
 
@@ -582,7 +829,7 @@ void Server::Pvt::start()
         log_debug_printf(serversetup, "Server starting\n%s", "");
 
         for(auto& iface : interfaces) {
-            if(evconnlistener_enable(iface.listener.get())) {
+            if(!iface.enable(true)) {
                 log_err_printf(serversetup, "Error enabling listener on %s\n", iface.name.c_str());
             }
             log_debug_printf(serversetup, "Server enabled listener on %s\n", iface.name.c_str());
@@ -600,20 +847,39 @@ void Server::Pvt::start()
     acceptor_loop.call([this]()
     {
         timeval immediate = {0,0};
-        // send first beacon immediately
+        // send first beacon immediately, and re-encode
+        beaconEncoded = 0x10000u;
         if(event_add(beaconTimer.get(), &immediate))
             log_err_printf(serversetup, "Error enabling beacon timer on\n%s", "");
 
+        if(statsTimer) {
+            timeval interval(totv(effective.statsInterval));
+            if(event_add(statsTimer.get(), &interval))
+                log_err_printf(serversetup, "Error enabling statistics timer on\n%s", "");
+        }
+
         state = Running;
     });
 
-
+    {
+        auto reg(localServers());
+        Guard G(reg->lock);
+        reg->byGUID[effective.guid] = internal_self;
+    }
 }
 
 void Server::Pvt::stop()
 {
     log_debug_printf(serversetup, "Server Stopping\n%s", "");
 
+    {
+        auto reg(localServers());
+        Guard G(reg->lock);
+        auto it(reg->byGUID.find(effective.guid));
+        if(it!=reg->byGUID.end() && it->second.lock().get()==this)
+            reg->byGUID.erase(it);
+    }
+
     // Stop sending Beacons
     state_t prev_state;
     acceptor_loop.call([this, &prev_state]()
@@ -627,6 +893,9 @@ void Server::Pvt::stop()
 
         if(event_del(beaconTimer.get()))
             log_err_printf(serversetup, "Error disabling beacon timer on\n%s", "");
+
+        if(statsTimer && event_del(statsTimer.get()))
+            log_err_printf(serversetup, "Error disabling statistics timer on\n%s", "");
     });
     if(prev_state!=Running)
         return;
@@ -635,24 +904,41 @@ void Server::Pvt::stop()
     for(auto& L : listeners) {
         L->stop();
     }
+    for(auto& worker : searchWorkers) {
+        worker->loop.sync();
+    }
 
     acceptor_loop.call([this]()
     {
         // stop accepting new TCP connections
         for(auto& iface : interfaces) {
-            if(evconnlistener_disable(iface.listener.get())) {
+            if(!iface.enable(false)) {
                 log_err_printf(serversetup, "Error disabling listener on %s\n", iface.name.c_str());
             }
             log_debug_printf(serversetup, "Server disabled listener on %s\n", iface.name.c_str());
         }
 
-        // close current TCP connections
-        auto conns = std::move(connections);
-        for(auto& pair : conns) {
-            pair.second->disconnect();
-            pair.second->cleanup();
-        }
+    });
 
+    // close current TCP connections.
+    // Any connection accepted prior to disabling listeners has already been queued to its worker,
+    // or with tcpReusePort, accepted on its worker.
+    for(auto& worker : workers) {
+        worker->loop.call([&worker]()
+        {
+            auto conns = std::move(worker->connections);
+            worker->nconn -= conns.size();
+            for(auto& pair : conns) {
+                pair.second->disconnect();
+                pair.second->cleanup();
+            }
+            // complete any incremental teardown before Server::stop() returns
+            worker->teardownSome(size_t(-1));
+        });
+    }
+
+    acceptor_loop.call([this]()
+    {
         state = Stopped;
     });
 
@@ -660,29 +946,307 @@ void Server::Pvt::stop()
      * TODO: this is partly a crutch as eg. SharedPV::attach() binds strong self references
      *       into on*() lambdas, which indirectly hold references keeping acceptor_loop alive.
      */
+    for(auto& worker : workers) {
+        worker->loop.sync();
+    }
     acceptor_loop.sync();
 }
 
-void Server::Pvt::onSearch(const UDPManager::Search& msg)
+ServerWorker* Server::Pvt::pickWorker()
 {
-    // on UDPManager worker
+    // least loaded, with ties broken round-robin
+    ServerWorker* best = nullptr;
+    for(auto i : range(workers.size())) {
+        auto worker = workers[(nextWorker + i) % workers.size()].get();
+        if(!best || worker->nconn < best->nconn)
+            best = worker;
+    }
+    nextWorker = (nextWorker + 1u) % workers.size();
+    best->nconn++;
+    return best;
+}
 
-    for(const auto& addr : ignoreList) { // expected to be a short list
-        if(msg.src.family()!=addr.family()) {
-            // skip
-        } else if(msg.src->in.sin_addr.s_addr != addr->in.sin_addr.s_addr) {
-            // skip
-        } else if(addr->in.sin_port==0) {
-            // ignore all ports
+bool Server::Pvt::acceptLocal(evutil_socket_t sock, const SockAddr& peer)
+{
+    bool accepted = false;
+    acceptor_loop.call([this, sock, &peer, &accepted]()
+    {
+        if(state!=Running || interfaces.empty())
             return;
-        } else if(msg.src->in.sin_port == addr->in.sin_port) {
-            // ignore specific sender port
+
+        // attribute to the interface the client would otherwise have connected through
+        auto iface(&interfaces.front());
+        for(auto& cand : interfaces) {
+            if(cand.bind_addr.family()==peer.family()
+                    && (cand.bind_addr.isAny() || cand.bind_addr.withPort(0)==peer)) {
+                iface = &cand;
+                break;
+            }
+        }
+
+        auto worker = pickWorker();
+        SockAddr peerAddr(peer);
+        accepted = true;
+
+        // ServerConn is created, and lives, on its worker
+        worker->loop.dispatch([iface, worker, sock, peerAddr]() mutable {
+            try {
+                auto conn(std::make_shared<ServerConn>(iface, worker, sock, &peerAddr->sa, int(peerAddr.size())));
+                worker->connections[conn.get()] = std::move(conn);
+            }catch(std::exception& e){
+                log_exc_printf(serversetup, "Interface %s Unhandled error in local accept: %s\n", iface->name.c_str(), e.what());
+                worker->nconn--;
+                evutil_closesocket(sock);
+            }
+        });
+    });
+    return accepted;
+}
+
+void Server::Pvt::addSourceLocked(const std::pair<int, std::string>& key, const std::shared_ptr<Source>& src)
+{
+    sources[key] = src;
+
+    auto& time = sourceTime[key.second];
+    if(!time)
+        time.reset(new SourceCallTime());
+    time->order = key.first;
+
+    if(auto isrc = dynamic_cast<IndexedSource*>(src.get())) {
+        isrc->attachIndex(nameIndex);
+    } else {
+        searchSources.clear();
+        for(auto& pair : sources) {
+            if(!dynamic_cast<IndexedSource*>(pair.second.get()))
+                searchSources.emplace_back(pair.first.second, pair.second);
+        }
+        rebuildSearchFilterLocked();
+    }
+}
+
+std::shared_ptr<Source> Server::Pvt::removeSourceLocked(const std::pair<int, std::string>& key)
+{
+    std::shared_ptr<Source> ret;
+    auto it = sources.find(key);
+    if(it!=sources.end()) {
+        ret = it->second;
+        sources.erase(it);
+
+        if(auto isrc = dynamic_cast<IndexedSource*>(ret.get())) {
+            isrc->detachIndex(nameIndex);
+        } else {
+            for(auto it = searchSources.begin(); it!=searchSources.end(); ++it) {
+                if(it->second==ret) {
+                    searchSources.erase(it);
+                    break;
+                }
+            }
+            rebuildSearchFilterLocked();
+        }
+    }
+    return ret;
+}
+
+void Server::Pvt::rebuildSearchFilterLocked()
+{
+    if(!effective.searchFilter)
+        return;
+
+    std::vector<decltype (Source::List::names)> lists;
+    lists.reserve(searchSources.size());
+    size_t nnames = 0u;
+    bool dynamic = false;
+
+    for(auto& pair : searchSources) {
+        auto list(pair.second->onList());
+        if(list.dynamic || !list.names) {
+            // this Source may claim names which it can not list
+            log_debug_printf(serversearch, "Source '%s' disables search filter\n", pair.first.c_str());
+            dynamic = true;
+            break;
+        }
+        nnames += list.names->size();
+        lists.push_back(std::move(list.names));
+    }
+
+    std::shared_ptr<NameFilter> filter;
+    if(!dynamic) {
+        filter = std::make_shared<NameFilter>(nnames);
+        for(auto& names : lists) {
+            for(auto& name : *names) {
+                filter->add(name.c_str());
+            }
+        }
+    }
+
+    Guard G(searchFilterLock);
+    searchFilter = std::move(filter);
+}
+
+void Server::Pvt::doSearch(Source::Search& op)
+{
+    bool unclaimed = false;
+    for(auto& name : op._names) {
+        if(nameIndex->contains(name._name))
+            name._claim = true;
+        else
+            unclaimed = true;
+    }
+
+    if(!unclaimed)
+        return;
+
+    if(effective.searchFilter) {
+        std::shared_ptr<const NameFilter> filter;
+        {
+            Guard G(searchFilterLock);
+            filter = searchFilter;
+        }
+
+        if(filter) {
+            bool maybe = false;
+            for(auto& name : op._names) {
+                if(!name._claim && filter->mayContain(name._name)) {
+                    maybe = true;
+                    break;
+                }
+            }
+            if(!maybe)
+                return; // no Source will claim any remaining name
+        }
+    }
+
+    auto G(sourcesLock.lockReader());
+    for(const auto& pair : searchSources) {
+        try {
+            auto it(sourceTime.find(pair.first));
+            SourceCallTime::Timer T(it!=sourceTime.end() ? &it->second->search : nullptr);
+            pair.second->onSearch(op);
+        }catch(std::exception& e){
+            log_exc_printf(serversetup, "Unhandled error in Source::onSearch for '%s' : %s\n",
+                       pair.first.c_str(), e.what());
+        }
+    }
+}
+
+Server::Pvt::PendingReply& Server::Pvt::PendingReplies::find(const SockAddr& dest, uint32_t searchID)
+{
+    for(auto& P : *this) { // expected to be a short list
+        if(P.dest==dest)
+            return P;
+    }
+    if(count==entries.size())
+        entries.emplace_back();
+    auto& P = entries[count++];
+    P.dest = dest;
+    P.searchID = searchID;
+    P.ids.clear();
+    return P;
+}
+
+Source::SearchClaim::~SearchClaim() {}
+
+std::shared_ptr<Source::SearchClaim> Source::Search::Name::defer()
+{
+    if(!_defer)
+        _defer = std::make_shared<DeferredClaim>();
+    return _defer;
+}
+
+DEFINE_INST_COUNTER(DeferredClaim);
+
+DeferredClaim::~DeferredClaim() {}
+
+void DeferredClaim::claim()
+{
+    decltype (reply) fn;
+    {
+        Guard G(lock);
+        if(claimed)
+            return;
+        claimed = true;
+        fn = std::move(reply);
+    }
+    if(fn) // else claim() before arm()
+        fn();
+}
+
+void DeferredClaim::arm(std::function<void()>&& fn)
+{
+    {
+        Guard G(lock);
+        if(!claimed) {
+            reply = std::move(fn);
             return;
         }
     }
+    fn();
+}
+
+void Server::Pvt::armDeferred(Source::Search::Name& name, const SockAddr& dest, uint32_t searchID, uint32_t id)
+{
+    auto claim(std::static_pointer_cast<DeferredClaim>(name._defer));
+    name._defer.reset();
+    if(name._claim)
+        return; // already claimed in the usual way
+
+    std::weak_ptr<Server::Pvt> wself(internal_self);
+    std::string pvname(name._name);
+    claim->arm([wself, dest, searchID, id, pvname]() {
+        // on any thread
+        auto self(wself.lock());
+        if(!self)
+            return;
+
+        std::vector<uint8_t> buf(0x100);
+        auto pktlen = self->buildSearchReply(buf, searchID, true, &id, 1u);
+        if(!pktlen)
+            return;
+
+        // any UDP socket will do, as clients take the server port from the reply body
+        auto& sock = dest.family()==AF_INET ? self->beaconSender4 : self->beaconSender6;
+        auto ret = sendto(sock.sock, (char*)buf.data(), pktlen, 0, &dest->sa, dest.size());
+        if(ret < 0) {
+            int err = evutil_socket_geterror(sock.sock);
+            log_warn_printf(serverio, "Deferred search reply TX Error to %s : (%d) %s\n",
+                            dest.tostring().c_str(), err, evutil_socket_error_to_string(err));
+        } else {
+            log_debug_printf(serversearch, "Search deferred claim '%s'\n", pvname.c_str());
+        }
+    });
+}
+
+void Server::Pvt::onSearch(const UDPManager::Search& msg)
+{
+    // on UDPManager worker
+
+    if(!ignoreList.empty() && msg.src.family()==AF_INET) {
+        if(ignoreList.count(ignoreKey(msg.src, false)) // ignore all ports
+                || ignoreList.count(ignoreKey(msg.src, true))) // ignore specific sender port
+            return;
+    }
 
     log_debug_printf(serverio, "%s searching\n", msg.src.tostring().c_str());
 
+    if(!searchWorkers.empty()) {
+        // hand off to the worker for this client, with the rest of the current batch
+        size_t hash = 0u;
+        auto raw = reinterpret_cast<const uint8_t*>(&msg.server->sa);
+        for(auto i : range(msg.server.size()))
+            hash = hash*31u + raw[i];
+        auto& worker = *searchWorkers[hash % searchWorkers.size()];
+
+        worker.queued.emplace_back();
+        auto& S = worker.queued.back();
+        S.server = msg.server;
+        S.searchID = msg.searchID;
+        S.mustReply = msg.mustReply;
+        S.names.reserve(msg.names.size());
+        for(auto& name : msg.names)
+            S.names.emplace_back(name.name, name.id);
+        return;
+    }
+
     searchOp._names.resize(msg.names.size());
     for(auto i : range(msg.names.size())) {
         searchOp._names[i]._name = msg.names[i].name;
@@ -690,16 +1254,11 @@ void Server::Pvt::onSearch(const UDPManager::Search& msg)
     }
     ipAddrToDottedIP(&msg.server->in, searchOp._src, sizeof(searchOp._src));
 
-    {
-        auto G(sourcesLock.lockReader());
-        for(const auto& pair : sources) {
-            try {
-                pair.second->onSearch(searchOp);
-            }catch(std::exception& e){
-                log_exc_printf(serversetup, "Unhandled error in Source::onSearch for '%s' : %s\n",
-                           pair.first.second.c_str(), e.what());
-            }
-        }
+    doSearch(searchOp);
+
+    for(auto i : range(msg.names.size())) {
+        if(searchOp._names[i]._defer)
+            armDeferred(searchOp._names[i], msg.server, msg.searchID, msg.names[i].id);
     }
 
     uint16_t nreply = 0;
@@ -712,69 +1271,236 @@ void Server::Pvt::onSearch(const UDPManager::Search& msg)
     }
 
     // "pvlist" breaks unless we honor mustReply flag
-    if(nreply==0 && !msg.mustReply)
+    if(nreply==0) {
+        if(msg.mustReply)
+            sendSearchReply(msg, msg.server, msg.searchID, false, nullptr, 0u);
         return;
+    }
 
-    VectorOutBuf M(true, searchReply);
+    /* Clients identify PVs in a reply by ID, and only look at searchID for
+     * discovery (not found, no IDs).  So positive replies to one client may be
+     * combined with those for other search requests received in the same batch.
+     */
+    auto pending = &pendingReplies.find(msg.server, msg.searchID);
+
+    for(auto i : range(msg.names.size())) {
+        if(searchOp._names[i]._claim) {
+            if(pending->ids.size()>=maxSearchReplyIDs) {
+                sendSearchReply(msg, pending->dest, pending->searchID, true,
+                                pending->ids.data(), pending->ids.size());
+                pending->ids.clear();
+                pending->searchID = msg.searchID;
+            }
+            pending->ids.push_back(msg.names[i].id);
+            log_debug_printf(serversearch, "Search claimed '%s'\n", msg.names[i].name);
+        }
+    }
+}
+
+void Server::Pvt::onSearchDone(const UDPManager::Search& msg)
+{
+    // on UDPManager worker
+
+    for(auto& worker : searchWorkers) {
+        if(worker->queued.empty())
+            continue;
+
+        auto W = worker.get();
+        W->loop.dispatch(std::bind([this, W](std::vector<QueuedSearch>& batch) {
+            onSearchBatch(*W, batch);
+        }, std::move(W->queued)));
+        W->queued.clear(); // moved from
+    }
+
+    for(auto& P : pendingReplies) {
+        if(!P.ids.empty())
+            sendSearchReply(msg, P.dest, P.searchID, true, P.ids.data(), P.ids.size());
+    }
+    pendingReplies.clear();
+}
+
+size_t Server::Pvt::buildSearchReply(std::vector<uint8_t>& buf, uint32_t searchID,
+                                     bool found, const uint32_t* ids, size_t nids)
+{
+    VectorOutBuf M(true, buf);
 
     M.skip(8, __FILE__, __LINE__); // fill in header after body length known
 
     _to_wire<12>(M, effective.guid.data(), false, __FILE__, __LINE__);
-    to_wire(M, msg.searchID);
+    to_wire(M, searchID);
     to_wire(M, SockAddr::any(AF_INET));
     to_wire(M, uint16_t(effective.tcp_port));
     to_wire(M, "tcp");
     // "found" flag
-    to_wire(M, uint8_t(nreply!=0 ? 1 : 0));
+    to_wire(M, uint8_t(found ? 1 : 0));
 
-    to_wire(M, uint16_t(nreply));
-    for(auto i : range(msg.names.size())) {
-        if(searchOp._names[i]._claim) {
-            to_wire(M, uint32_t(msg.names[i].id));
-            log_debug_printf(serversearch, "Search claimed '%s'\n", msg.names[i].name);
-        }
+    to_wire(M, uint16_t(nids));
+    for(auto i : range(nids)) {
+        to_wire(M, ids[i]);
     }
-    auto pktlen = M.save()-searchReply.data();
+    auto pktlen = M.save()-buf.data();
 
     // now going back to fill in header
-    FixedBuf H(true, searchReply.data(), 8);
+    FixedBuf H(true, buf.data(), 8);
     to_wire(H, Header{CMD_SEARCH_RESPONSE, pva_flags::Server, uint32_t(pktlen-8)});
 
     if(!M.good() || !H.good()) {
         log_crit_printf(serverio, "Logic error in Search buffer fill\n%s", "");
-    } else {
-        (void)msg.reply(searchReply.data(), pktlen);
+        return 0u;
+    }
+    PVXS_TRACE2(server_search_reply, searchID, nids);
+    return pktlen;
+}
+
+void Server::Pvt::sendSearchReply(const UDPManager::Search& msg, const SockAddr& dest, uint32_t searchID,
+                                  bool found, const uint32_t* ids, size_t nids)
+{
+    if(auto pktlen = buildSearchReply(searchReply, searchID, found, ids, nids))
+        (void)msg.replyTo(dest, searchReply.data(), pktlen);
+}
+
+void Server::Pvt::sendSearchReply(SearchWorker& worker, const SockAddr& dest, uint32_t searchID,
+                                  bool found, const uint32_t* ids, size_t nids)
+{
+    auto pktlen = buildSearchReply(worker.searchReply, searchID, found, ids, nids);
+    if(!pktlen)
+        return;
+
+    auto& sock = dest.family()==AF_INET ? worker.tx4 : worker.tx6;
+    if(!sock)
+        return;
+
+    auto ret = sendto(sock.sock, (char*)worker.searchReply.data(), pktlen, 0, &dest->sa, dest.size());
+    if(ret < 0) {
+        int err = evutil_socket_geterror(sock.sock);
+        if(err!=SOCK_EWOULDBLOCK && err!=EAGAIN && err!=SOCK_EINTR) {
+            log_warn_printf(serverio, "Search reply TX Error to %s : (%d) %s\n",
+                            dest.tostring().c_str(), err, evutil_socket_error_to_string(err));
+        }
+    }
+}
+
+Server::Pvt::SearchWorker::SearchWorker(const evbase& loop)
+    :loop(loop)
+    ,tx4(AF_INET, SOCK_DGRAM, 0)
+    ,searchReply(0x10000)
+{
+    if(evsocket::canIPv6)
+        tx6 = evsocket(AF_INET6, SOCK_DGRAM, 0);
+}
+
+// on SearchWorker
+void Server::Pvt::onSearchBatch(SearchWorker& worker, std::vector<QueuedSearch>& batch)
+{
+    auto& op = worker.searchOp;
+
+    for(auto& S : batch) {
+        op._names.resize(S.names.size());
+        for(auto i : range(S.names.size())) {
+            op._names[i]._name = S.names[i].first.c_str();
+            op._names[i]._claim = false;
+        }
+        ipAddrToDottedIP(&S.server->in, op._src, sizeof(op._src));
+
+        doSearch(op);
+
+        for(auto i : range(S.names.size())) {
+            if(op._names[i]._defer)
+                armDeferred(op._names[i], S.server, S.searchID, S.names[i].second);
+        }
+
+        bool claimed = false;
+        for(const auto& name : op._names) {
+            log_debug_printf(serverio, "  %sclaim %s\n",
+                             name._claim ? "" : "dis",
+                             name._name);
+            claimed |= name._claim;
+        }
+
+        if(!claimed) {
+            if(S.mustReply)
+                sendSearchReply(worker, S.server, S.searchID, false, nullptr, 0u);
+            continue;
+        }
+
+        // as in onSearch(), combine positive replies to the same client
+        auto pending = &worker.pendingReplies.find(S.server, S.searchID);
+
+        for(auto i : range(S.names.size())) {
+            if(op._names[i]._claim) {
+                if(pending->ids.size()>=maxSearchReplyIDs) {
+                    sendSearchReply(worker, pending->dest, pending->searchID, true,
+                                    pending->ids.data(), pending->ids.size());
+                    pending->ids.clear();
+                    pending->searchID = S.searchID;
+                }
+                pending->ids.push_back(S.names[i].second);
+                log_debug_printf(serversearch, "Search claimed '%s'\n", op._names[i]._name);
+            }
+        }
     }
+
+    for(auto& P : worker.pendingReplies) {
+        if(!P.ids.empty())
+            sendSearchReply(worker, P.dest, P.searchID, true, P.ids.data(), P.ids.size());
+    }
+    worker.pendingReplies.clear();
 }
 
 void Server::Pvt::doBeacons(short evt)
 {
     log_debug_printf(serversetup, "Server beacon timer expires\n%s", "");
 
-    VectorOutBuf M(true, beaconMsg);
-    M.skip(8, __FILE__, __LINE__); // fill in header after body length known
+    const uint16_t change = beaconChange;
 
-    _to_wire<12>(M, effective.guid.data(), false, __FILE__, __LINE__);
-    to_wire(M, uint8_t(0u)); // flags (aka. QoS, aka. undefined)
-    to_wire(M, uint8_t(beaconSeq++)); // sequence
-    to_wire(M, uint16_t(beaconChange));// change count
+    if(beaconEncoded!=change) {
+        beaconMsg.resize(128u);
+        VectorOutBuf M(true, beaconMsg);
+        M.skip(8, __FILE__, __LINE__); // fill in header after body length known
 
-    to_wire(M, SockAddr::any(AF_INET));
-    to_wire(M, uint16_t(effective.tcp_port));
-    to_wire(M, "tcp");
-    // "NULL" serverStatus
-    to_wire(M, uint8_t(0xff));
+        _to_wire<12>(M, effective.guid.data(), false, __FILE__, __LINE__);
+        to_wire(M, uint8_t(0u)); // flags (aka. QoS, aka. undefined)
+        to_wire(M, uint8_t(0u)); // sequence.  filled in below
+        to_wire(M, change);      // change count
 
-    size_t pktlen = M.save()-beaconMsg.data();
+        to_wire(M, SockAddr::any(AF_INET));
+        to_wire(M, uint16_t(effective.tcp_port));
+        to_wire(M, "tcp");
+        // "NULL" serverStatus
+        to_wire(M, uint8_t(0xff));
 
-    // now going back to fill in header
-    FixedBuf H(true, beaconMsg.data(), 8);
-    to_wire(H, Header{CMD_BEACON, pva_flags::Server, uint32_t(pktlen-8)});
+        size_t pktlen = M.save()-beaconMsg.data();
+        beaconMsg.resize(pktlen);
+
+        // now going back to fill in header
+        FixedBuf H(true, beaconMsg.data(), 8);
+        to_wire(H, Header{CMD_BEACON, pva_flags::Server, uint32_t(pktlen-8)});
+
+        assert(M.good() && H.good());
+
+        if(beaconEncoded<=0xffffu) {
+            log_debug_printf(serversetup, "Server beacon change count %u\n", unsigned(change));
+        }
+        beaconEncoded = change;
+        // (re)start with short interval so that clients notice quickly
+        beaconInterval = beaconIntervalShort;
+    }
+
+    // only the sequence number differs between beacons with the same change count
+    beaconMsg[8u + 12u + 1u] = beaconSeq++;
 
-    assert(M.good() && H.good());
+    const size_t pktlen = beaconMsg.size();
+    // multicast destinations each need socket options set, and are sent individually.
+    // all others are sent in batches.
+    std::vector<sendtox> batch4, batch6;
 
     for(const auto& dest : beaconDest) {
-        auto& sender = dest.addr.family()==AF_INET ? beaconSender4 : beaconSender6;
+        const bool v4 = dest.addr.family()==AF_INET;
+        if(!dest.addr.isMCast()) {
+            (v4 ? batch4 : batch6).push_back(sendtox{beaconMsg.data(), pktlen, &dest.addr});
+            continue;
+        }
+        auto& sender = v4 ? beaconSender4 : beaconSender6;
         sender.mcast_prep_sendto(dest);
 
         int ntx = sendto(sender.sock, (char*)beaconMsg.data(), pktlen, 0, &dest.addr->sa, dest.addr.size());
@@ -796,13 +1522,34 @@ void Server::Pvt::doBeacons(short evt)
         }
     }
 
-    // mimic pvAccessCPP server (almost)
-    // send a "burst" of beacons, then fallback to a longer interval
-    timeval interval(beaconIntervalLong);
-    if(beaconCnt<10u) {
-        interval = beaconIntervalShort;
-        beaconCnt++;
+    for(auto pass : range(2u)) {
+        const auto& sender = pass==0u ? beaconSender4 : beaconSender6;
+        const auto& batch = pass==0u ? batch4 : batch6;
+
+        for(size_t i=0u; i<batch.size(); ) {
+            auto nsent = sendtox::call_many(sender.sock, &batch[i], batch.size()-i);
+            if(nsent>0) {
+                i += size_t(nsent);
+                continue;
+            }
+
+            int err = evutil_socket_geterror(sender.sock);
+            auto lvl = Level::Warn;
+            if(err==EINTR || err==EPERM)
+                lvl = Level::Debug;
+            log_printf(serverio, lvl, "Beacon tx to %s error (%d) %s\n",
+                       batch[i].dst->tostring().c_str(), err, evutil_socket_error_to_string(err));
+            i++; // skip failed destination
+        }
+        if(!batch.empty())
+            log_debug_printf(serverio, "Beacon tx batch of %u\n", unsigned(batch.size()));
     }
+
+    // Send beacons quickly after startup, or a change, then back off while nothing changes.
+    // The interval doubles up to beaconIntervalLong, which clients rely on to detect
+    // a server which has stopped.  cf. beaconCleanInterval in client.cpp
+    timeval interval(beaconInterval);
+    beaconInterval.tv_sec = std::min(2*beaconInterval.tv_sec, beaconIntervalLong.tv_sec);
     if(event_add(beaconTimer.get(), &interval))
         log_err_printf(serversetup, "Error re-enabling beacon timer on\n%s", "");
 }
@@ -816,12 +1563,187 @@ void Server::Pvt::doBeaconsS(evutil_socket_t fd, short evt, void *raw)
     }
 }
 
+namespace {
+// Statistics gathered from each worker.  The last to finish posts the update.
+struct StatsGather {
+    struct Conn {
+        std::string peer;
+        double txRate, rxRate;
+        size_t backlog;
+    };
+    struct Mon {
+        std::string peer, channel;
+        size_t queued, limit;
+    };
+
+    SharedPV pv;
+    Value proto;
+
+    epicsMutex lock;
+    size_t pending;
+    std::vector<Conn> conns;
+    std::vector<Mon> mons;
+    std::map<std::string, Report::SourceTime> sourceTime;
+
+    void post()
+    {
+        auto val(proto.cloneEmpty());
+
+        shared_array<std::string> cpeer(conns.size());
+        shared_array<double> txRate(conns.size()), rxRate(conns.size());
+        shared_array<uint64_t> backlog(conns.size());
+        for(auto i : range(conns.size())) {
+            cpeer[i] = conns[i].peer;
+            txRate[i] = conns[i].txRate;
+            rxRate[i] = conns[i].rxRate;
+            backlog[i] = conns[i].backlog;
+        }
+        val["connections.peer"] = cpeer.freeze();
+        val["connections.txRate"] = txRate.freeze();
+        val["connections.rxRate"] = rxRate.freeze();
+        val["connections.backlog"] = backlog.freeze();
+
+        shared_array<std::string> mpeer(mons.size()), channel(mons.size());
+        shared_array<uint64_t> queued(mons.size()), limit(mons.size());
+        for(auto i : range(mons.size())) {
+            mpeer[i] = mons[i].peer;
+            channel[i] = mons[i].channel;
+            queued[i] = mons[i].queued;
+            limit[i] = mons[i].limit;
+        }
+        val["monitors.peer"] = mpeer.freeze();
+        val["monitors.channel"] = channel.freeze();
+        val["monitors.queued"] = queued.freeze();
+        val["monitors.limit"] = limit.freeze();
+
+        shared_array<std::string> sname(sourceTime.size());
+        shared_array<int32_t> sorder(sourceTime.size());
+        shared_array<double> ssearch(sourceTime.size()), screate(sourceTime.size()), sop(sourceTime.size());
+        {
+            size_t i=0u;
+            for(auto& pair : sourceTime) {
+                sname[i] = pair.first;
+                sorder[i] = pair.second.order;
+                ssearch[i] = pair.second.search;
+                screate[i] = pair.second.create;
+                sop[i] = pair.second.op;
+                i++;
+            }
+        }
+        val["sources.name"] = sname.freeze();
+        val["sources.order"] = sorder.freeze();
+        val["sources.search"] = ssearch.freeze();
+        val["sources.create"] = screate.freeze();
+        val["sources.op"] = sop.freeze();
+
+        auto counts(instanceSnapshot());
+        shared_array<std::string> cname(counts.size());
+        shared_array<uint64_t> count(counts.size());
+        size_t i=0u;
+        for(auto& pair : counts) {
+            cname[i] = pair.first;
+            count[i] = pair.second;
+            i++;
+        }
+        val["counters.name"] = cname.freeze();
+        val["counters.count"] = count.freeze();
+
+        epicsTimeStamp now;
+        if(!epicsTimeGetCurrent(&now)) {
+            val["timeStamp.secondsPastEpoch"] = now.secPastEpoch + POSIX_TIME_AT_EPICS_EPOCH;
+            val["timeStamp.nanoseconds"] = now.nsec;
+        }
+
+        pv.post(val);
+    }
+};
+} // namespace
+
+void Server::Pvt::doStats()
+{
+    // Workers only read their own connections, and are never waited on from here.
+    auto gather(std::make_shared<StatsGather>());
+    gather->pv = statsPV;
+    gather->proto = statsProto;
+    gather->pending = workers.size();
+    {
+        Report report;
+        reportSourceTime(report, false);
+        gather->sourceTime = std::move(report.sourceTime);
+    }
+
+    for(auto& worker : workers) {
+        auto W(worker.get());
+        // if a worker is stopping, its part is dropped, and no update is posted.
+        (void)W->loop.tryDispatch([W, gather]() {
+            std::vector<StatsGather::Conn> conns;
+            std::vector<StatsGather::Mon> mons;
+            auto now(epicsMonotonicGet());
+
+            for(auto& pair : W->connections) {
+                auto conn = pair.first;
+
+                // counters may have been zero'd by Server::report()
+                size_t tx = conn->statTx, rx = conn->statRx;
+                auto dtx = tx>=conn->statsPrevTx ? tx-conn->statsPrevTx : tx;
+                auto drx = rx>=conn->statsPrevRx ? rx-conn->statsPrevRx : rx;
+                double dt = (now - conn->statsPrevAt)*1e-9;
+                conn->statsPrevTx = tx;
+                conn->statsPrevRx = rx;
+                conn->statsPrevAt = now;
+
+                conns.push_back(StatsGather::Conn{conn->peerName,
+                                                  dt>0.0 ? dtx/dt : 0.0,
+                                                  dt>0.0 ? drx/dt : 0.0,
+                                                  conn->backlogSize()});
+
+                for(auto& op : conn->opByIOID) {
+                    size_t queued, limit;
+                    if(!op.second->queueStats(queued, limit))
+                        continue;
+                    auto chan(op.second->chan.lock());
+                    mons.push_back(StatsGather::Mon{conn->peerName,
+                                                    chan ? chan->name : std::string(),
+                                                    queued, limit});
+                }
+            }
+
+            bool last;
+            {
+                Guard G(gather->lock);
+                gather->conns.insert(gather->conns.end(), conns.begin(), conns.end());
+                gather->mons.insert(gather->mons.end(), mons.begin(), mons.end());
+                last = --gather->pending==0u;
+            }
+            if(last)
+                gather->post();
+        });
+    }
+}
+
+void Server::Pvt::doStatsS(evutil_socket_t fd, short evt, void *raw)
+{
+    try {
+        static_cast<Pvt*>(raw)->doStats();
+    }catch(std::exception& e){
+        log_exc_printf(serverio, "Unhandled error in statistics timer callback: %s\n", e.what());
+    }
+}
+
 Source::~Source() {}
 
 Source::List Source::onList() {
     return Source::List{};
 }
 
+void Source::onCreateMany(std::vector<std::unique_ptr<ChannelControl>>& ops)
+{
+    for(auto& op : ops) {
+        if(op)
+            onCreate(std::move(op));
+    }
+}
+
 void Source::show(std::ostream& strm)
 {
     auto list(onList());
@@ -838,10 +1760,57 @@ OpBase::~OpBase() {}
 
 ChannelControl::~ChannelControl() {}
 
+namespace {
+Value selectFields(const Value& prototype, const Value& pvRequest)
+{
+    auto ret(prototype.cloneEmpty());
+    auto desc(Value::Helper::desc(ret));
+    if(!desc)
+        throw std::logic_error("Can't select fields of empty prototype");
+
+    auto mask(request2mask(desc, pvRequest));
+    auto store(Value::Helper::store_ptr(ret));
+    for(auto bit : range(desc->size())) {
+        if(mask[bit])
+            store[bit].valid = true;
+    }
+    return ret;
+}
+} // namespace
+
 ConnectOp::~ConnectOp() {}
+
+Value ConnectOp::selected(const Value& prototype) const
+{
+    return selectFields(prototype, _pvRequest);
+}
 ExecOp::~ExecOp() {}
 
 MonitorControlOp::~MonitorControlOp() {}
+void MonitorControlOp::setPriority(unsigned) {}
 MonitorSetupOp::~MonitorSetupOp() {}
 
+Value MonitorSetupOp::selected(const Value& prototype) const
+{
+    return selectFields(prototype, _pvRequest);
+}
+
 }} // namespace pvxs::server
+
+namespace pvxs {
+namespace impl {
+
+bool acceptLocalConnection(const ServerGUID& guid, evutil_socket_t sock, const SockAddr& peer)
+{
+    std::shared_ptr<server::Server::Pvt> serv;
+    {
+        auto reg(server::localServers());
+        Guard G(reg->lock);
+        auto it(reg->byGUID.find(guid));
+        if(it!=reg->byGUID.end())
+            serv = it->second.lock();
+    }
+    return serv && serv->acceptLocal(sock, peer);
+}
+
+}} // namespace pvxs::impl
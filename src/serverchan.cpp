@@ -62,6 +62,7 @@ void ServerChan::cleanup()
 ServerChannelControl::ServerChannelControl(const std::shared_ptr<ServerConn> &conn, const std::shared_ptr<ServerChan>& channel)
     :server::ChannelControl(channel->name, conn->cred, None)
     ,server(conn->iface->server->internal_self)
+    ,loop(conn->loop)
     ,chan(channel)
 {}
 
@@ -73,7 +74,7 @@ void ServerChannelControl::onOp(std::function<void(std::unique_ptr<server::Conne
     if(!serv)
         return;
 
-    serv->acceptor_loop.call([this, &fn](){
+    loop.call([this, &fn](){
         auto ch = chan.lock();
         if(!ch)
             return;
@@ -88,7 +89,7 @@ void ServerChannelControl::onRPC(std::function<void(std::unique_ptr<server::Exec
     if(!serv)
         return;
 
-    serv->acceptor_loop.call([this, &fn](){
+    loop.call([this, &fn](){
         auto ch = chan.lock();
         if(!ch)
             return;
@@ -103,7 +104,7 @@ void ServerChannelControl::onSubscribe(std::function<void(std::unique_ptr<server
     if(!serv)
         return;
 
-    serv->acceptor_loop.call([this, &fn](){
+    loop.call([this, &fn](){
         auto ch = chan.lock();
         if(!ch)
             return;
@@ -118,7 +119,7 @@ void ServerChannelControl::onClose(std::function<void(const std::string&)>&& fn)
     if(!serv)
         return;
 
-    serv->acceptor_loop.call([this, &fn](){
+    loop.call([this, &fn](){
         auto ch = chan.lock();
         if(!ch || ch->state==ServerChan::Destroy)
             return;
@@ -134,7 +135,7 @@ void ServerChannelControl::close()
     if(!serv)
         return;
 
-    serv->acceptor_loop.call([this](){
+    loop.call([this](){
         auto ch = chan.lock();
         if(!ch)
             return;
@@ -162,7 +163,7 @@ void ServerChannelControl::_updateInfo(const std::shared_ptr<const ReportInfo>&
     if(!serv)
         return;
 
-    serv->acceptor_loop.call([this, &info](){
+    loop.call([this, &info](){
         auto ch = chan.lock();
         if(!ch)
             return;
@@ -209,25 +210,41 @@ void ServerConn::handle_SEARCH()
     if(!M.good())
         throw std::runtime_error(SB()<<M.file()<<':'<<M.line()<<" TCP Search decode error");
 
-    {
-        auto G(iface->server->sourcesLock.lockReader());
-        for(const auto& pair : iface->server->sources) {
-            try {
-                pair.second->onSearch(op);
-            }catch(std::exception& e){
-                log_exc_printf(serversearch, "Unhandled error in Source::onSearch for '%s' : %s\n",
-                           pair.first.second.c_str(), e.what());
-            }
+    iface->server->doSearch(op);
+
+    std::vector<uint32_t> ids;
+    for(auto i : range(op._names.size())) {
+        auto& name = op._names[i];
+        if(name._claim) {
+            ids.push_back(nameStorage[i].first);
+            log_debug_printf(serversearch, "Search claimed '%s'\n", name._name);
+
+        } else if(name._defer) {
+            // reply through this connection if later claimed
+            std::weak_ptr<ServerConn> wself(shared_from_this());
+            auto id(nameStorage[i].first);
+            std::static_pointer_cast<server::DeferredClaim>(name._defer)->arm([wself, searchID, id]() {
+                // on any thread
+                if(auto self = wself.lock()) {
+                    self->loop.dispatch([wself, searchID, id]() {
+                        if(auto self = wself.lock())
+                            self->sendSearchReply(searchID, {id});
+                    });
+                }
+            });
         }
+        name._defer.reset();
     }
 
-    uint16_t nreply = 0;
-    for(const auto& name : op._names) {
-        if(name._claim)
-            nreply++;
-    }
+    if(ids.empty() && !mustReply)
+        return;
 
-    if(nreply==0 && !mustReply)
+    sendSearchReply(searchID, ids);
+}
+
+void ServerConn::sendSearchReply(uint32_t searchID, const std::vector<uint32_t>& ids)
+{
+    if(!connection())
         return;
 
     {
@@ -241,14 +258,11 @@ void ServerConn::handle_SEARCH()
         to_wire(R, iface->bind_addr.port());
         to_wire(R, "tcp");
         // "found" flag
-        to_wire(R, uint8_t(nreply!=0 ? 1 : 0));
+        to_wire(R, uint8_t(ids.empty() ? 0 : 1));
 
-        to_wire(R, uint16_t(nreply));
-        for(auto i : range(op._names.size())) {
-            if(op._names[i]._claim) {
-                to_wire(R, uint32_t(nameStorage[i].first));
-                log_debug_printf(serversearch, "Search claimed '%s'\n", op._names[i]._name);
-            }
+        to_wire(R, uint16_t(ids.size()));
+        for(auto id : ids) {
+            to_wire(R, id);
         }
     }
 
@@ -268,9 +282,25 @@ void ServerConn::handle_CREATE_CHANNEL()
 
     uint16_t count = 0;
     from_wire(M, count);
+
+    struct Creating {
+        uint32_t cid = -1, sid = -1;
+        std::shared_ptr<ServerChan> chan;
+        Status sts{Status::Ok};
+        bool claimed = false;
+        bool decided = false;
+    };
+    std::vector<Creating> creating;
+    creating.reserve(count);
+    // parallel to 'creating'.  Offered to each Source in turn through onCreateMany().
+    // NULL for entries already decided.
+    std::vector<std::unique_ptr<server::ChannelControl>> ops;
+    ops.reserve(count);
+    size_t undecided = 0u;
+
     for(auto i : range(count)) {
         (void)i;
-        uint32_t cid = -1, sid = -1;
+        uint32_t cid = -1;
         std::string name;
         from_wire(M, cid);
         from_wire(M, name);
@@ -278,77 +308,106 @@ void ServerConn::handle_CREATE_CHANNEL()
         if(!M.good() || name.empty())
             break;
 
-        Status sts{Status::Ok};
-
-        bool claimed = false;
+        creating.emplace_back();
+        auto& ent = creating.back();
+        ent.cid = cid;
 
-        if(chanBySID.size()==0xffffffff) {
-            sts.code = Status::Error;
-            sts.msg = "Too many Server channels";
-            sts.trace = "pvx:serv:chanidoverflow:";
+        if(uint64_t(chanBySID.size()) + creating.size() > 0xffffffffu) {
+            ent.sts.code = Status::Error;
+            ent.sts.msg = "Too many Server channels";
+            ent.sts.trace = "pvx:serv:chanidoverflow:";
+            ops.emplace_back();
 
         } else {
             do {
-                sid = nextSID++;
-            } while(chanBySID.find(sid)!=chanBySID.end());
-
-            auto chan(std::make_shared<ServerChan>(self, sid, cid, name));
-            std::unique_ptr<server::ChannelControl> op(new ServerChannelControl(self, chan));
-
-            for(auto& pair : iface->server->sources) {
-                try {
-                    pair.second->onCreate(std::move(op));
-                    const char* msg = nullptr;
-
-                    if(chan->state!=ServerChan::Creating) {
-                        msg = "rejected";
-
-                    } else if(chan->onOp || chan->onRPC || chan->onSubscribe || chan->onClose) {
-                        msg = "accepted";
-                        claimed = true;
-
-                    } else if(!op) {
-                        msg = "discarded";
-                    }
-
-                    log_debug_printf(serversearch, "Client %s %s channel to %s through %s\n",
-                                     peerName.c_str(),
-                                     msg ? msg : "ignored",
-                                     name.c_str(), pair.first.second.c_str());
-
-                    if(msg)
-                        break;
-                }catch(std::exception& e){
-                    log_exc_printf(serversearch, "Client %s Unhandled error in onCreate %s,%d %s : %s\n", peerName.c_str(),
-                               pair.first.second.c_str(), pair.first.first,
-                               typeid(&e).name(), e.what());
-                }
-            }
+                ent.sid = nextSID++;
+            } while(chanBySID.find(ent.sid)!=chanBySID.end());
 
-            if(claimed && chan->state==ServerChan::Creating) {
-                chanBySID[sid] = chan;
-                chan->state = ServerChan::Active;
+            ent.chan = std::make_shared<ServerChan>(self, ent.sid, cid, name);
+            ops.emplace_back(new ServerChannelControl(self, ent.chan));
+            undecided++;
+        }
+    }
 
-            } else {
-                sts.code = Status::Fatal;
-                sts.msg = "Refused to create Channel";
-                sts.trace = "pvx:serv:refusechan:";
-                chan->state = ServerChan::Destroy;
+    // offer all undecided channels to each Source in order
+    for(auto& pair : iface->server->sources) {
+        if(!undecided)
+            break;
+
+        auto it(iface->server->sourceTime.find(pair.first.second));
+        auto callTime(it!=iface->server->sourceTime.end() ? it->second.get() : nullptr);
+        OpLatencies* latency = nullptr;
+
+        try {
+            SourceCallTime::Timer T(callTime ? &callTime->create : nullptr);
+            pair.second->onCreateMany(ops);
+        }catch(std::exception& e){
+            log_exc_printf(serversearch, "Client %s Unhandled error in onCreate %s,%d %s : %s\n", peerName.c_str(),
+                       pair.first.second.c_str(), pair.first.first,
+                       typeid(&e).name(), e.what());
+        }
+
+        for(auto i : range(creating.size())) {
+            auto& ent = creating[i];
+            if(!ent.chan || ent.decided)
+                continue;
+            auto& chan = ent.chan;
+
+            const char* msg = nullptr;
+
+            if(chan->state!=ServerChan::Creating) {
+                msg = "rejected";
 
-                sid = -1;
+            } else if(chan->onOp || chan->onRPC || chan->onSubscribe || chan->onClose) {
+                msg = "accepted";
+                ent.claimed = true;
+                if(!latency)
+                    latency = iface->server->latencyOf(pair.first.second);
+                chan->latency = latency;
+                chan->callTime = callTime;
+
+            } else if(!ops[i]) {
+                msg = "discarded";
             }
 
-            // ServerChannelControl destroyed it not saved by claiming Source
+            log_debug_printf(serversearch, "Client %s %s channel to %s through %s\n",
+                             peerName.c_str(),
+                             msg ? msg : "ignored",
+                             chan->name.c_str(), pair.first.second.c_str());
+
+            if(msg) {
+                ent.decided = true;
+                undecided--;
+                // ServerChannelControl destroyed it not saved by claiming Source
+                ops[i].reset();
+            }
         }
+    }
+    ops.clear();
+
+    for(auto& ent : creating) {
+        if(ent.chan) {
+            if(ent.claimed && ent.chan->state==ServerChan::Creating) {
+                chanBySID[ent.sid] = ent.chan;
+                ent.chan->state = ServerChan::Active;
 
+            } else {
+                ent.sts.code = Status::Fatal;
+                ent.sts.msg = "Refused to create Channel";
+                ent.sts.trace = "pvx:serv:refusechan:";
+                ent.chan->state = ServerChan::Destroy;
+
+                ent.sid = -1;
+            }
+        }
 
         {
             (void)evbuffer_drain(txBody.get(), evbuffer_get_length(txBody.get()));
 
             EvOutBuf R(sendBE, txBody.get());
-            to_wire(R, cid);
-            to_wire(R, sid);
-            to_wire(R, sts);
+            to_wire(R, ent.cid);
+            to_wire(R, ent.sid);
+            to_wire(R, ent.sts);
             // "spec" calls for uint16_t Access Rights here, but pvAccessCPP don't include this (it's useless anyway)
             if(!R.good()) {
                 M.fault(__FILE__, __LINE__);
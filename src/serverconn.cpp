@@ -8,6 +8,8 @@
 #include <system_error>
 #include <utility>
 
+#include <errno.h>
+
 #include <osiSock.h>
 #include <epicsGuard.h>
 #include <epicsAssert.h>
@@ -15,10 +17,18 @@
 #include <pvxs/log.h>
 #include "serverconn.h"
 
+#ifdef PVXS_HAVE_UNIX_SOCKET
+#  include <unistd.h>
+#endif
+
 // limit on size of TX buffer above which we suspend RX.
 // defined as multiple of OS socket TX buffer size
 static constexpr size_t tcp_tx_limit_mult = 2u;
 
+// deferred replies expected to be smaller than this are sent
+// ahead of larger ones.  eg. an alarm update ahead of an image.
+static constexpr size_t tcp_tx_small = 16u*1024u;
+
 namespace pvxs {
 namespace impl {
 DEFINE_INST_COUNTER(ServerChannelControl);
@@ -53,12 +63,15 @@ DEFINE_LOGGER(connio, "pvxs.tcp.io");
 
 DEFINE_LOGGER(remote, "pvxs.remote.log");
 
-ServerConn::ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *peer, int socklen)
+ServerConn::ServerConn(ServIface* iface, ServerWorker *worker, evutil_socket_t sock, struct sockaddr *peer, int socklen)
     :ConnBase(false, iface->server->effective.sendBE(),
-              bufferevent_socket_new(iface->server->acceptor_loop.base, sock, BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS),
+              bufferevent_socket_new(worker->loop.base, sock, BEV_OPT_CLOSE_ON_FREE|BEV_OPT_DEFER_CALLBACKS),
               SockAddr(peer))
     ,iface(iface)
+    ,worker(worker)
+    ,loop(worker->loop.internal())
     ,tcp_tx_limit(evsocket::get_buffer_size(sock, true) * tcp_tx_limit_mult)
+    ,statsPrevAt(epicsMonotonicGet())
 {
     log_debug_printf(connio, "Client %s connects, RX readahead %zu TX limit %zu\n",
                      peerName.c_str(), readahead, tcp_tx_limit);
@@ -84,7 +97,13 @@ ServerConn::ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *
     // queue connection validation message
     {
         VectorOutBuf M(sendBE, buf);
-        to_wire(M, Header{pva_ctrl_msg::SetEndian, pva_flags::Control|pva_flags::Server, 0});
+        /* With peerByteOrder, invite the client to send in its own byte order (size 0xffffffff),
+         * and adopt whichever order it sends.  Older clients ignore the size field,
+         * and send in our byte order, which is then kept.
+         */
+        adoptPeerBE = iface->server->effective.peerByteOrder;
+        to_wire(M, Header{pva_ctrl_msg::SetEndian, pva_flags::Control|pva_flags::Server,
+                          adoptPeerBE ? 0xffffffffu : 0u});
 
         auto save = M.save();
         M.skip(8, __FILE__, __LINE__); // placeholder for header
@@ -102,6 +121,11 @@ ServerConn::ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *
         to_wire(M, Size{2});
         to_wire(M, "anonymous");
         to_wire(M, "ca");
+        // QoS, appended.  Ignored by older clients.
+        uint16_t qos = pva_qos::MultiCreate|pva_qos::EarlyExec;
+        if(iface->server->effective.tcpKeepAlive)
+            qos |= pva_qos::KeepAlive;
+        to_wire(M, qos);
         auto bend = M.save();
 
         FixedBuf H(sendBE, save, 8);
@@ -174,8 +198,20 @@ void ServerConn::handle_CONNECTION_VALIDATION()
 
     std::string selected;
     {
-        M.skip(4+2+2, __FILE__, __LINE__); // ignore unused buffer, introspection size, and QoS
+        M.skip(4+2, __FILE__, __LINE__); // ignore unused buffer and introspection size
+        uint16_t qos = 0u;
+        from_wire(M, qos);
         from_wire(M, selected);
+        peerLZ4 = qos&pva_qos::LZ4;
+        peerDelta = qos&pva_qos::ArrayDelta;
+        // only echoed by a client when we advertised
+        if(!peerKeepAlive && (qos&pva_qos::KeepAlive) && iface->server->effective.tcpKeepAlive) {
+            peerKeepAlive = true;
+            // dead peer now detected by TCP keepalive.  Keep the write timeout for a stalled peer.
+            timeval tmo(totv(iface->server->effective.tcpTimeout));
+            bufferevent_set_timeouts(bev.get(), nullptr, &tmo);
+            log_debug_printf(connsetup, "Client %s using TCP keepalive\n", peerName.c_str());
+        }
 
         Value auth;
         from_wire_type_value(M, rxRegistry, auth);
@@ -340,17 +376,71 @@ void ServerConn::cleanup()
 {
     log_debug_printf(connsetup, "Client %s Cleanup TCP Connection\n", peerName.c_str());
 
-    iface->server->connections.erase(this);
+    if(worker->connections.erase(this))
+        worker->nconn--;
+
+    if(opByIOID.empty() && chanBySID.empty())
+        return;
 
     // grab maps before cleanup()s would modify
-    auto ops(std::move(opByIOID));
-    auto chans(std::move(chanBySID));
+    worker->teardown.emplace_back();
+    auto& todo = worker->teardown.back();
+    todo.ops = std::move(opByIOID);
+    todo.chans = std::move(chanBySID);
+    opByIOID.clear();
+    chanBySID.clear();
+
+    // usually complete immediately.  A connection with very many channels
+    // should not stall other connections handled by this worker.
+    if(worker->teardownSome(ServerWorker::teardownSlice))
+        worker->scheduleTeardown();
+}
+
+bool ServerWorker::teardownSome(size_t limit)
+{
+    size_t n = 0u;
+    while(!teardown.empty() && n < limit) {
+        auto& todo = teardown.front();
+        // operations before their channels
+        if(!todo.ops.empty()) {
+            auto it(todo.ops.begin());
+            auto op(std::move(it->second));
+            todo.ops.erase(it);
+            op->cleanup();
+
+        } else if(!todo.chans.empty()) {
+            auto it(todo.chans.begin());
+            auto chan(std::move(it->second));
+            todo.chans.erase(it);
+            chan->cleanup();
 
-    for(auto& op : ops) {
-        op.second->cleanup();
+        } else {
+            teardown.pop_front();
+            continue;
+        }
+        n++;
     }
-    for(auto& pair : chans) {
-        pair.second->cleanup();
+
+    while(!teardown.empty() && teardown.front().ops.empty() && teardown.front().chans.empty())
+        teardown.pop_front();
+
+    return !teardown.empty();
+}
+
+void ServerWorker::scheduleTeardown()
+{
+    if(teardownQueued)
+        return;
+
+    teardownQueued = loop.tryDispatch([this]() {
+        teardownQueued = false;
+        if(teardownSome(teardownSlice))
+            scheduleTeardown();
+    });
+
+    if(!teardownQueued) {
+        // loop stopping.  Finish now.
+        teardownSome(size_t(-1));
     }
 }
 
@@ -371,18 +461,62 @@ void ServerConn::bevRead()
     }
 }
 
+bool ServerConn::txFull() const
+{
+    if(!bev)
+        return false;
+    return !(bufferevent_get_enabled(bev.get())&EV_READ)
+            || evbuffer_get_length(bufferevent_get_output(bev.get()))>=tcp_tx_limit;
+}
+
+void ServerConn::defer(std::function<void()>&& fn, size_t expected, unsigned priority)
+{
+    if(!backlogSize() && bev) {
+        // wake bevWrite() once some of the TX buffer has been sent
+        bufferevent_setwatermark(bev.get(), EV_WRITE, tcp_tx_limit/2, 0);
+    }
+
+    auto& B = backlog[std::min(priority, nPriorities-1u)];
+    if(expected < tcp_tx_small)
+        B.small.emplace_back(std::move(fn));
+    else
+        B.large.emplace_back(std::move(fn));
+}
+
+size_t ServerConn::backlogSize() const
+{
+    size_t ret = 0u;
+    for(auto& B : backlog)
+        ret += B.size();
+    return ret;
+}
+
 void ServerConn::bevWrite()
 {
     log_debug_printf(connio, "%s process backlog\n", peerName.c_str());
 
     auto tx = bufferevent_get_output(bev.get());
-    // handle pending monitors
+    // handle pending monitors.  Weighted round robin between priorities,
+    // with each pass sending up to 2**priority replies of each priority.
+    // Within a priority, small replies first so that they
+    // need not wait behind several large replies.
 
-    while(!backlog.empty() && evbuffer_get_length(tx)<tcp_tx_limit) {
-        auto fn = std::move(backlog.front());
-        backlog.pop_front();
+    for(bool more = true; more && evbuffer_get_length(tx)<tcp_tx_limit;) {
+        more = false;
 
-        fn();
+        for(auto prio = nPriorities; prio--;) {
+            auto& B = backlog[prio];
+
+            for(size_t n = 1u<<prio; n && !B.empty() && evbuffer_get_length(tx)<tcp_tx_limit; n--) {
+                auto& Q = B.small.empty() ? B.large : B.small;
+                auto fn = std::move(Q.front());
+                Q.pop_front();
+
+                fn();
+            }
+
+            more |= !B.empty();
+        }
     }
 
     // TODO configure
@@ -406,6 +540,30 @@ ServIface::ServIface(const SockAddr &addr, server::Server::Pvt *server, bool fal
     if(evutil_make_listen_socket_reuseable(sock.sock))
         log_warn_printf(connsetup, "Unable to make socket reusable%s", "\n");
 
+    bool reusePort = server->effective.tcpReusePort && server->workers.size()>1u;
+    // elsewhere, SO_REUSEPORT does not spread connections between sockets
+#if defined(SO_REUSEPORT) && defined(__linux__)
+    if(reusePort) {
+        if(evutil_make_listen_socket_reuseable_port(sock.sock)) {
+            log_warn_printf(connsetup, "Unable to set SO_REUSEPORT.  Single listener for %s\n",
+                            bind_addr.tostring().c_str());
+            reusePort = false;
+        }
+    }
+#else
+    if(reusePort) {
+        log_debug_printf(connsetup, "SO_REUSEPORT not supported by this target%s", "\n");
+        reusePort = false;
+    }
+#endif
+
+    {
+        // Accepted sockets inherit buffer sizes from the listener.
+        // Setting SO_RCVBUF prior to listen() allows a larger TCP window scale.
+        auto& conf = server->effective;
+        evsocket::set_tcp_options(sock.sock, conf.tcpSendBuffer, conf.tcpRecvBuffer, false, 0u, 0u);
+    }
+
     // try to bind to requested port, then fallback to a random port
     while(true) {
         try {
@@ -438,21 +596,167 @@ ServIface::ServIface(const SockAddr &addr, server::Server::Pvt *server, bool fal
 #endif
 
     const int backlog = 4;
-    listener = evlisten(__FILE__, __LINE__,
-                        evconnlistener_new(server->acceptor_loop.base, onConnS, this, LEV_OPT_DISABLED|LEV_OPT_CLOSE_ON_EXEC, backlog, sock.sock));
+
+    if(!reusePort) {
+        listener = evlisten(__FILE__, __LINE__,
+                            evconnlistener_new(server->acceptor_loop.base, onConnS, this, LEV_OPT_DISABLED|LEV_OPT_CLOSE_ON_EXEC, backlog, sock.sock));
+
+        if(!LEV_OPT_DISABLED)
+            evconnlistener_disable(listener.get());
+        return;
+    }
+
+    /* One listening socket for each worker, all bound to the same (now known) address.
+     * The kernel spreads new connections between them, and each worker accepts
+     * its own connections without a hand-off through acceptor_loop.
+     * The first worker listens on sock.
+     * Enabled and disabled from acceptor_loop, so LEV_OPT_THREADSAFE.
+     */
+    workerListeners.reserve(server->workers.size());
+    for(auto& worker : server->workers) {
+        evsocket wsock;
+        evutil_socket_t fd = sock.sock;
+        unsigned flags = LEV_OPT_DISABLED|LEV_OPT_CLOSE_ON_EXEC|LEV_OPT_THREADSAFE;
+        if(!workerListeners.empty()) {
+            wsock = evsocket(bind_addr.family(), SOCK_STREAM, 0);
+            (void)evutil_make_listen_socket_reuseable(wsock.sock);
+            if(evutil_make_listen_socket_reuseable_port(wsock.sock))
+                throw std::runtime_error(SB()<<"Unable to set SO_REUSEPORT for "<<name);
+            evsocket::set_tcp_options(wsock.sock, server->effective.tcpSendBuffer, server->effective.tcpRecvBuffer, false, 0u, 0u);
+            wsock.bind(bind_addr);
+            fd = wsock.sock;
+            flags |= LEV_OPT_CLOSE_ON_FREE;
+        }
+
+        std::unique_ptr<WorkerListener> wl{new WorkerListener{this, worker.get(), evlisten()}};
+        wl->listener = evlisten(__FILE__, __LINE__,
+                                evconnlistener_new(worker->loop.base, onConnWorkerS, wl.get(), flags, backlog, fd));
+        if(flags&LEV_OPT_CLOSE_ON_FREE)
+            wsock.sock = evutil_socket_t(-1); // now owned by listener
+
+        if(!LEV_OPT_DISABLED)
+            evconnlistener_disable(wl->listener.get());
+
+        workerListeners.push_back(std::move(wl));
+    }
+
+    log_debug_printf(connsetup, "Server %s with %zu SO_REUSEPORT listeners\n", name.c_str(), workerListeners.size());
+}
+
+#ifdef PVXS_HAVE_UNIX_SOCKET
+ServIface::ServIface(const std::string& path, server::Server::Pvt *server)
+    :server(server)
+    // as seen by clients.  eg. in search replies sent through this connection
+    ,bind_addr(SockAddr::loopback(AF_INET, server->effective.tcp_port))
+    ,name(path)
+{
+    server->acceptor_loop.assertInLoop();
+
+    sockaddr_un addr;
+    auto alen(unixSocketAddr(addr, path));
+
+    auto sock(unixSocket());
+    try {
+        while(::bind(sock, (sockaddr*)&addr, alen)) {
+            int err = evutil_socket_geterror(sock);
+            if(err!=SOCK_EADDRINUSE)
+                throw std::system_error(err, std::system_category());
+
+            // left behind by a server which exited, or in use?
+            auto probe(unixSocket());
+            bool live = ::connect(probe, (sockaddr*)&addr, alen)==0;
+            evutil_closesocket(probe);
+            if(live)
+                throw std::runtime_error("In use by another server");
+
+            log_debug_printf(connsetup, "Removing stale %s\n", path.c_str());
+            if(unlink(path.c_str()))
+                throw std::system_error(errno, std::system_category());
+        }
+        unixPath = path;
+
+        const int backlog = 4;
+        listener = evlisten(__FILE__, __LINE__,
+                            evconnlistener_new(server->acceptor_loop.base, onConnS, this,
+                                               LEV_OPT_DISABLED|LEV_OPT_CLOSE_ON_EXEC|LEV_OPT_CLOSE_ON_FREE,
+                                               backlog, sock));
+    }catch(...){
+        evutil_closesocket(sock);
+        if(!unixPath.empty())
+            unlink(unixPath.c_str());
+        throw;
+    }
 
     if(!LEV_OPT_DISABLED)
         evconnlistener_disable(listener.get());
+
+    log_debug_printf(connsetup, "Server listening on %s\n", name.c_str());
+}
+#endif // PVXS_HAVE_UNIX_SOCKET
+
+ServIface::~ServIface()
+{
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    if(!unixPath.empty())
+        unlink(unixPath.c_str());
+#endif
+}
+
+bool ServIface::enable(bool ena)
+{
+    bool ok = true;
+    auto fn = ena ? &evconnlistener_enable : &evconnlistener_disable;
+    if(listener)
+        ok &= (*fn)(listener.get())==0;
+    for(auto& wl : workerListeners)
+        ok &= (*fn)(wl->listener.get())==0;
+    return ok;
+}
+
+void ServIface::onConnWorkerS(struct evconnlistener *listener, evutil_socket_t sock, struct sockaddr *peer, int socklen, void *raw)
+{
+    // already on the worker loop, which will own this connection
+    auto wl = static_cast<WorkerListener*>(raw);
+    auto self = wl->iface;
+    auto worker = wl->worker;
+    worker->nconn++;
+    try {
+        evsocket::set_tcp_options(sock, self->server->effective);
+        auto conn(std::make_shared<ServerConn>(self, worker, sock, peer, socklen));
+        worker->connections[conn.get()] = std::move(conn);
+    }catch(std::exception& e){
+        log_exc_printf(connsetup, "Interface %s Unhandled error in accept callback: %s\n", self->name.c_str(), e.what());
+        worker->nconn--;
+        evutil_closesocket(sock);
+    }
 }
 
 void ServIface::onConnS(struct evconnlistener *listener, evutil_socket_t sock, struct sockaddr *peer, int socklen, void *raw)
 {
     auto self = static_cast<ServIface*>(raw);
+    auto worker = self->server->pickWorker();
     try {
-        auto conn(std::make_shared<ServerConn>(self, sock, peer, socklen));
-        self->server->connections[conn.get()] = std::move(conn);
+        // peer is only valid during this callback.
+        // A Unix domain socket peer is on this host.
+        const bool local = !self->unixPath.empty();
+        SockAddr peerAddr(local ? SockAddr::loopback(AF_INET) : SockAddr(peer, socklen));
+
+        // ServerConn is created, and lives, on its worker
+        worker->loop.dispatch([self, worker, sock, peerAddr, local]() mutable {
+            try {
+                if(!local)
+                    evsocket::set_tcp_options(sock, self->server->effective);
+                auto conn(std::make_shared<ServerConn>(self, worker, sock, &peerAddr->sa, int(peerAddr.size())));
+                worker->connections[conn.get()] = std::move(conn);
+            }catch(std::exception& e){
+                log_exc_printf(connsetup, "Interface %s Unhandled error in accept callback: %s\n", self->name.c_str(), e.what());
+                worker->nconn--;
+                evutil_closesocket(sock);
+            }
+        });
     }catch(std::exception& e){
         log_exc_printf(connsetup, "Interface %s Unhandled error in accept callback: %s\n", self->name.c_str(), e.what());
+        worker->nconn--;
         evutil_closesocket(sock);
     }
 }
@@ -491,7 +795,7 @@ void ServerOp::cleanup()
             conn->opByIOID.erase(ioid);
 
             if(notify) {
-                conn->iface->server->acceptor_loop.dispatch([closer](){
+                conn->loop.dispatch([closer](){
                     closer("");
                 });
                 notify = false;
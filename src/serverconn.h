@@ -7,12 +7,16 @@
 #ifndef SERVERCONN_H
 #define SERVERCONN_H
 
+#include <array>
 #include <list>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <atomic>
 
 #include <epicsEvent.h>
+#include <epicsTime.h>
 
 #include <pvxs/server.h>
 #include <pvxs/source.h>
@@ -22,12 +26,15 @@
 #include "dataimpl.h"
 #include "udp_collector.h"
 #include "conn.h"
+#include "nameindex.h"
+#include "opslab.h"
 
 namespace pvxs {namespace impl {
 
 struct ServIface;
 struct ServerConn;
 struct ServerChan;
+struct ServerWorker;
 
 // base for tracking in-progress operations.  cf. ServerConn::opByIOID and ServerChan::opByIOID
 struct ServerOp
@@ -53,6 +60,10 @@ struct ServerOp
 
     void cleanup();
     virtual void show(std::ostream& strm) const =0;
+    // for subscriptions, current and maximum length of the update queue.  Call from worker.
+    virtual bool queueStats(size_t& queued, size_t& limit) const { return false; }
+    // for subscriptions, approximate bytes of queued updates.  Call from worker.
+    virtual size_t queueBytes() const { return 0u; }
 };
 
 struct ServerChannelControl : public server::ChannelControl
@@ -70,11 +81,40 @@ struct ServerChannelControl : public server::ChannelControl
     virtual void _updateInfo(const std::shared_ptr<const ReportInfo>& info) override final;
 
     const std::weak_ptr<server::Server::Pvt> server;
+    const evbase loop;
     const std::weak_ptr<ServerChan> chan;
 
     INST_COUNTER(ServerChannelControl);
 };
 
+// Time spent in the callbacks of one Source.  cf. Server::Pvt::sourceTime
+struct SourceCallTime {
+    struct Counter {
+        std::atomic<uint64_t> count{0u}, ns{0u};
+
+        // add counts to 'n' and 'sec', then maybe zero
+        void take(size_t& n, double& sec, bool zero);
+    };
+
+    // accumulate the time from construction until destruction.  No-op if cnt==nullptr
+    struct Timer {
+        Counter* const cnt;
+        const uint64_t start;
+        explicit Timer(Counter* cnt) :cnt(cnt), start(cnt ? LatencyHistogram::now() : 0u) {}
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+        ~Timer() {
+            if(cnt) {
+                cnt->count.fetch_add(1u, std::memory_order_relaxed);
+                cnt->ns.fetch_add(LatencyHistogram::now() - start, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    int order = 0;
+    Counter search, create, op;
+};
+
 struct ServerChan
 {
     const std::weak_ptr<ServerConn> conn;
@@ -90,13 +130,19 @@ struct ServerChan
 
     size_t statTx{}, statRx{};
     std::shared_ptr<const ReportInfo> reportInfo;
+    // latencies of the Source which claimed this channel.  Set once claimed.
+    OpLatencies* latency = nullptr;
+    // callback time of the Source which claimed this channel.  Set once claimed.
+    SourceCallTime* callTime = nullptr;
 
     std::function<void(std::unique_ptr<server::ConnectOp>&&)> onOp;
     std::function<void(std::unique_ptr<server::ExecOp>&&, Value&&)> onRPC;
     std::function<void(std::unique_ptr<server::MonitorSetupOp>&&)> onSubscribe;
     std::function<void(const std::string&)> onClose;
 
-    std::map<uint32_t, std::shared_ptr<ServerOp> > opByIOID; // our subset of ServerConn::opByIOID
+    // our subset of ServerConn::opByIOID.  Usually only a few entries, so a tree
+    // avoids the bucket array of a hash table.
+    std::map<uint32_t, std::shared_ptr<ServerOp> > opByIOID;
 
     INST_COUNTER(ServerChan);
 
@@ -106,30 +152,66 @@ struct ServerChan
     ~ServerChan();
 
     void cleanup();
+
+    SourceCallTime::Counter* opTime() const { return callTime ? &callTime->op : nullptr; }
 };
 
 struct ServerConn final : public ConnBase, public std::enable_shared_from_this<ServerConn>
 {
     ServIface* const iface;
+    ServerWorker* const worker;
+    // (internal) reference to worker->loop.  All access to this connection,
+    // and its channels and operations, must be from this loop.
+    const evbase loop;
     const size_t tcp_tx_limit;
 
     std::shared_ptr<const server::ClientCredentials> cred;
 
     uint32_t nextSID=0x07050301;
-    std::map<uint32_t, std::shared_ptr<ServerChan> > chanBySID;
-    std::map<uint32_t, std::shared_ptr<ServerOp> > opByIOID;
-
-    std::list<std::function<void()>> backlog;
+    std::unordered_map<uint32_t, std::shared_ptr<ServerChan> > chanBySID;
+    std::unordered_map<uint32_t, std::shared_ptr<ServerOp> > opByIOID;
+    // recycled memory of the ServerOp of this connection
+    const std::shared_ptr<OpSlab> opSlab{std::make_shared<OpSlab>()};
+
+    // replies deferred while the TX buffer is "full", by priority.
+    // Within one priority, those expected to be small are sent ahead of larger ones.
+    static constexpr unsigned nPriorities = 4u;
+    struct Backlog {
+        std::list<std::function<void()>> small, large;
+        inline bool empty() const { return small.empty() && large.empty(); }
+        inline size_t size() const { return small.size() + large.size(); }
+    };
+    std::array<Backlog, nPriorities> backlog;
+
+    // approximate bytes reserved by the subscription queues of this connection.
+    // cf. Config::connMemoryLimit.  Released by ~MonitorOp(), from any thread.
+    std::atomic<size_t> monReserved{0u};
+
+    // counters at the previous update of the statistics PV.  cf. Server::Pvt::doStats()
+    size_t statsPrevTx{}, statsPrevRx{};
+    epicsUInt64 statsPrevAt;
 
     INST_COUNTER(ServerConn);
 
-    ServerConn(ServIface* iface, evutil_socket_t sock, struct sockaddr *peer, int socklen);
+    ServerConn(ServIface* iface, ServerWorker* worker, evutil_socket_t sock, struct sockaddr *peer, int socklen);
     ServerConn(const ServerConn&) = delete;
     ServerConn& operator=(const ServerConn&) = delete;
     ~ServerConn();
 
     const std::shared_ptr<ServerChan>& lookupSID(uint32_t sid);
 
+    //! Queue a SEARCH_RESPONSE for the client IDs of claimed names, or a negative reply if empty.
+    void sendSearchReply(uint32_t searchID, const std::vector<uint32_t>& ids);
+
+    //! true when the TX buffer holds at least tcp_tx_limit bytes, or RX is suspended for that reason.
+    bool txFull() const;
+    //! Queue fn() to run once the TX buffer drains.
+    //! @param expected Approximate size of the reply fn() will queue
+    //! @param priority In range [0, nPriorities).  Higher priorities are given a larger share of the TX buffer.
+    void defer(std::function<void()>&& fn, size_t expected, unsigned priority=0u);
+    //! Number of deferred replies
+    size_t backlogSize() const;
+
 private:
 #define CASE(Op) virtual void handle_##Op() override final;
     CASE(ECHO);
@@ -171,21 +253,76 @@ struct ServIface
     std::string name;
 
     evsocket sock;
+    // on acceptor_loop.  NULL when workerListeners is used.
     evlisten listener;
+    // non-empty for a Unix domain socket, which is removed by the dtor.  cf. Config::unixSocketDir
+    std::string unixPath;
+
+    //! With Config::tcpReusePort, a listener with its own SO_REUSEPORT socket on the loop of each worker.
+    struct WorkerListener {
+        ServIface* iface;
+        ServerWorker* worker;
+        evlisten listener;
+    };
+    std::vector<std::unique_ptr<WorkerListener>> workerListeners;
 
     ServIface(const SockAddr &addr, server::Server::Pvt *server, bool fallback);
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    ServIface(const std::string& path, server::Server::Pvt *server);
+#endif
+    ~ServIface();
+
+    //! Enable or disable accepting new connections.  Returns false on error.
+    bool enable(bool ena);
 
     static void onConnS(struct evconnlistener *listener, evutil_socket_t sock, struct sockaddr *peer, int socklen, void *raw);
+    static void onConnWorkerS(struct evconnlistener *listener, evutil_socket_t sock, struct sockaddr *peer, int socklen, void *raw);
+};
+
+//! Channels and operations of a closed connection, awaiting cleanup().  cf. ServerWorker::teardownSome()
+struct ConnTeardown
+{
+    std::unordered_map<uint32_t, std::shared_ptr<ServerOp> > ops;
+    std::unordered_map<uint32_t, std::shared_ptr<ServerChan> > chans;
+};
+
+//! One of the event loops handling TCP connections.  cf. server::Config::tcpWorkers
+struct ServerWorker
+{
+    // max. number of channels and operations cleanup()'d before yielding to other events
+    static constexpr size_t teardownSlice = 1024u;
+
+    const evbase loop;
+
+    // only accessed from loop worker
+    std::map<ServerConn*, std::shared_ptr<ServerConn> > connections;
+    // closed connections with very many channels are torn down over several loop iterations
+    std::list<ConnTeardown> teardown;
+    bool teardownQueued = false;
+    // number of connections assigned to this worker.
+    // incremented by acceptor_loop when assigned, decremented from loop worker on close.
+    std::atomic<size_t> nconn{0u};
+
+    explicit ServerWorker(const evbase& loop) :loop(loop) {}
+    ServerWorker(const ServerWorker&) = delete;
+    ServerWorker& operator=(const ServerWorker&) = delete;
+
+    //! cleanup() at most limit channels and operations.  Returns true if more remain.
+    bool teardownSome(size_t limit);
+    //! Continue teardown on a later loop iteration
+    void scheduleTeardown();
 };
 
 
 //! Home of the magic "server" PV used by "pvinfo"
-struct ServerSource : public server::Source
+// our "server" PV is never claimed by search, so nothing to index
+struct ServerSource : public server::Source, public IndexedSource
 {
     const std::string name;
     server::Server::Pvt* const serv;
 
     const Value info;
+    const Value latency;
 
     INST_COUNTER(ServerSource);
 
@@ -194,6 +331,10 @@ struct ServerSource : public server::Source
     virtual void onSearch(Search &op) override final;
 
     virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final;
+
+    // our "server" PV is not advertised.  Only the statistics PV, if any.
+    virtual void attachIndex(const std::shared_ptr<NameIndex>& idx) override final;
+    virtual void detachIndex(const std::shared_ptr<NameIndex>& idx) override final;
 };
 
 } // namespace impl
@@ -201,6 +342,23 @@ struct ServerSource : public server::Source
 namespace server {
 using namespace impl;
 
+// Returned by Source::Search::Name::defer()
+struct DeferredClaim final : public Source::SearchClaim
+{
+    epicsMutex lock;
+    // guarded by lock.  Set by arm()
+    std::function<void()> reply;
+    bool claimed = false;
+
+    INST_COUNTER(DeferredClaim);
+
+    virtual ~DeferredClaim();
+    virtual void claim() override final;
+    // Called once after Source::onSearch() returns, with the function which sends the reply.
+    // Calls fn() now if already claim()'d
+    void arm(std::function<void()>&& fn);
+};
+
 struct Server::Pvt
 {
     SockAttach attach;
@@ -212,35 +370,110 @@ struct Server::Pvt
 
     epicsEvent done;
 
+    // encoded beacon, re-encoded only when beaconChange differs from beaconEncoded
     std::vector<uint8_t> beaconMsg;
+    uint32_t beaconEncoded = 0x10000u; // never a valid change count
     uint8_t beaconSeq = 0u;
-    uint8_t beaconCnt = 0u;
+    // current interval, doubled from beaconIntervalShort after each beacon while beaconChange is stable
+    timeval beaconInterval{};
     std::atomic<uint16_t> beaconChange{0u};
 
     // handle server "background" tasks.
     // accept new connections and send beacons
     evbase acceptor_loop;
 
+    // handle TCP connections.  With a single worker, shares acceptor_loop.
+    std::vector<std::unique_ptr<ServerWorker> > workers;
+    // only accessed from acceptor_loop
+    size_t nextWorker = 0u;
+
     std::list<std::unique_ptr<UDPListener> > listeners;
     std::vector<SockEndpoint> beaconDest;
-    std::vector<SockAddr> ignoreList;
+    // IPv4 address and port of search senders to ignore.  cf. ignoreKey() in server.cpp
+    std::unordered_set<uint64_t> ignoreList;
 
     std::list<ServIface> interfaces;
-    std::map<ServerConn*, std::shared_ptr<ServerConn> > connections;
 
     evsocket beaconSender4, beaconSender6;
     evevent beaconTimer;
 
+    // When effective.statsPV is not empty, served by ServerSource and updated by statsTimer.
+    SharedPV statsPV;
+    Value statsProto;
+    evevent statsTimer;
+
     std::vector<uint8_t> searchReply;
 
+    // Positive search replies to each client, accumulated from one batch of received
+    // datagrams, then sent by onSearchDone().  Only accessed from the UDP worker.
+    struct PendingReply {
+        SockAddr dest;
+        uint32_t searchID;
+        std::vector<uint32_t> ids;
+    };
+    // Reused for each batch, so that no allocation is needed in the steady state
+    struct PendingReplies {
+        // entries beyond count are spare, and retain the capacity of their ids
+        std::vector<PendingReply> entries;
+        size_t count = 0u;
+
+        //! Find, or add, the entry for dest
+        PendingReply& find(const SockAddr& dest, uint32_t searchID);
+        inline PendingReply* begin() { return entries.data(); }
+        inline PendingReply* end() { return entries.data()+count; }
+        inline void clear() { count = 0u; }
+    };
+    PendingReplies pendingReplies;
+
     // properly a local of Pvt::onSearch() on the UDP worker.
     // made a member to avoid re-alloc of _names vector.
     Source::Search searchOp;
 
+    // A Search copied from the UDP worker to a SearchWorker
+    struct QueuedSearch {
+        SockAddr server;
+        uint32_t searchID;
+        bool mustReply;
+        std::vector<std::pair<std::string, uint32_t>> names; // PV name and client ID
+    };
+    //! One of the threads handling Search requests.  cf. server::Config::searchWorkers
+    struct SearchWorker {
+        const evbase loop;
+        // sends replies
+        evsocket tx4, tx6;
+        // only accessed from loop worker.  cf. Pvt members of the same name
+        Source::Search searchOp;
+        PendingReplies pendingReplies;
+        std::vector<uint8_t> searchReply;
+        // received during the current batch.  Only accessed from the UDP worker
+        std::vector<QueuedSearch> queued;
+
+        explicit SearchWorker(const evbase& loop);
+    };
+    // empty when searches are handled by the UDP worker
+    std::vector<std::unique_ptr<SearchWorker>> searchWorkers;
+
     StaticSource builtinsrc;
 
     RWLock sourcesLock;
     std::map<std::pair<int, std::string>, std::shared_ptr<Source> > sources;
+    // Names of all IndexedSource in 'sources'
+    const std::shared_ptr<NameIndex> nameIndex;
+    // Other Sources, in order, with onSearch() called from doSearch().  Guarded by sourcesLock.
+    std::vector<std::pair<std::string, std::shared_ptr<Source>>> searchSources;
+    // When effective.searchFilter, names which searchSources may claim.
+    // nullptr if any of searchSources has a dynamic list.  Rebuilt when searchSources changes.
+    epicsMutex searchFilterLock;
+    std::shared_ptr<const NameFilter> searchFilter;
+
+    // Operation latencies by Source name.  Entries are added when a Source first claims a channel,
+    // and never removed, so pointers remain valid.
+    epicsMutex latencyLock;
+    std::map<std::string, std::unique_ptr<OpLatencies>> latency;
+
+    // Time spent in callbacks by Source name.  Entries are added by addSourceLocked(),
+    // and never removed, so pointers remain valid.  Guarded by sourcesLock.
+    std::map<std::string, std::unique_ptr<SourceCallTime>> sourceTime;
 
     enum state_t {
         Stopped,
@@ -257,10 +490,43 @@ struct Server::Pvt
     void start();
     void stop();
 
+    // called from acceptor_loop to assign a new connection
+    ServerWorker* pickWorker();
+
+    // serve one end of a socketpair() from a client in this process.  cf. acceptLocalConnection()
+    bool acceptLocal(evutil_socket_t sock, const SockAddr& peer);
+
+    // call with sourcesLock held for writing
+    void addSourceLocked(const std::pair<int, std::string>& key, const std::shared_ptr<Source>& src);
+    std::shared_ptr<Source> removeSourceLocked(const std::pair<int, std::string>& key);
+    void rebuildSearchFilterLocked();
+
+    // claim names from nameIndex, then through any other Sources
+    void doSearch(Source::Search& op);
+    // After doSearch(), arrange for a UDP reply if a deferred name is later claimed.
+    void armDeferred(Source::Search::Name& name, const SockAddr& dest, uint32_t searchID, uint32_t id);
+
+    // latencies of the named Source
+    OpLatencies* latencyOf(const std::string& source);
+    // copy latencies into a Report, and maybe zero
+    void reportLatency(Report& report, bool zero);
+    // copy callback times into a Report, and maybe zero
+    void reportSourceTime(Report& report, bool zero);
+
 private:
     void onSearch(const UDPManager::Search& msg);
+    void onSearchDone(const UDPManager::Search& msg);
+    void sendSearchReply(const UDPManager::Search& msg, const SockAddr& dest, uint32_t searchID,
+                         bool found, const uint32_t* ids, size_t nids);
+    void onSearchBatch(SearchWorker& worker, std::vector<QueuedSearch>& batch);
+    void sendSearchReply(SearchWorker& worker, const SockAddr& dest, uint32_t searchID,
+                         bool found, const uint32_t* ids, size_t nids);
+    size_t buildSearchReply(std::vector<uint8_t>& buf, uint32_t searchID,
+                            bool found, const uint32_t* ids, size_t nids);
     void doBeacons(short evt);
     static void doBeaconsS(evutil_socket_t fd, short evt, void *raw);
+    void doStats();
+    static void doStatsS(evutil_socket_t fd, short evt, void *raw);
 };
 
 }} // namespace pvxs::server
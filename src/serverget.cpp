@@ -5,11 +5,13 @@
  */
 
 #include <cassert>
+#include <deque>
 
 #include <pvxs/log.h>
 #include "dataimpl.h"
 #include "serverconn.h"
 #include "pvrequest.h"
+#include "wirecache.h"
 
 namespace pvxs { namespace impl {
 DEFINE_LOGGER(connsetup, "pvxs.tcp.setup");
@@ -26,6 +28,9 @@ cmd2op(pva_app_msg_t cmd){
     }
 }
 
+struct ServerGPR;
+void execNextGPR(ServerConn* conn, const std::shared_ptr<ServerGPR>& op);
+
 // generalized Get/Put/RPC
 struct ServerGPR : public ServerOp
 {
@@ -71,14 +76,28 @@ struct ServerGPR : public ServerOp
             }
         }
 
+        if(state==Executing && ch->latency) {
+            auto& hist = cmd==CMD_GET ? ch->latency->get : cmd==CMD_PUT ? ch->latency->put : ch->latency->rpc;
+            hist.add(execStart);
+        }
+
         Status sts{};
         if(!msg.empty())
             sts = Status::error(msg);
 
+        /* A frozen Value with an existing WireCache (eg. a SharedPV snapshot) is unchanged
+         * until released, so its encoding may be shared by every GET with the same byte order and mask.
+         */
+        std::shared_ptr<evbuffer> encoded;
+        if(sts.isSuccess() && state==Executing && cmd==CMD_GET && !plan.variant && value.frozen()) {
+            if(auto wire = WireCache::find(Value::Helper::store_ptr(value)))
+                encoded = wire->encode(conn->sendBE, value, plan, lastBodySize);
+        }
+
         {
             (void)evbuffer_drain(conn->txBody.get(), evbuffer_get_length(conn->txBody.get()));
 
-            EvOutBuf R(conn->sendBE, conn->txBody.get());
+            EvOutBuf R(conn->sendBE, conn->txBody.get(), std::min(lastBodySize, maxTxHint), true);
             to_wire(R, uint32_t(ioid));
             to_wire(R, subcmd);
             to_wire(R, sts);
@@ -94,19 +113,22 @@ struct ServerGPR : public ServerOp
             } else if(state==Creating) {
                 // connect()
                 if(cmd!=CMD_RPC) {
-                    to_wire(R, type.get());
+                    to_wire(R, type.get(), conn->txTypes);
                 }
                 state = Idle;
 
             } else if(state==Executing) {
-                if(cmd==CMD_GET || (cmd==CMD_PUT && (subcmd&0x40))) {
-                    to_wire_valid(R, value, &pvMask); // GET and PUT/Get reply with bitmask and partial value
+                if(encoded) {
+                    // appended below, after R is flushed
+
+                } else if(cmd==CMD_GET || (cmd==CMD_PUT && (subcmd&0x40))) {
+                    to_wire_valid(R, value, pvMask.get(), &conn->txTypes); // GET and PUT/Get reply with bitmask and partial value
 
                 } else if(cmd==CMD_RPC) {
                     auto type = Value::Helper::desc(value);
-                    to_wire(R, type);
+                    to_wire(R, type, conn->txTypes);
                     if(value)
-                        to_wire_full(R, value);
+                        to_wire_full(R, value, &conn->txTypes);
                 }
                 state = lastRequest ? Dead : Idle;
 
@@ -115,11 +137,31 @@ struct ServerGPR : public ServerOp
             }
             assert(R.good());
         }
+        if(encoded)
+            WireCache::append(conn->sendBE, conn->txBody.get(), encoded);
+        lastBodySize = evbuffer_get_length(conn->txBody.get());
 
         ch->statTx += conn->enqueueTxBody(cmd);
 
         if(state == ServerOp::Dead) {
+            pendingExec.clear();
             cleanup();
+
+        } else if(state==Idle && !pendingExec.empty()) {
+            // start next pipelined EXEC once this reply has been queued.
+            std::weak_ptr<ServerConn> wconn(conn);
+            auto id(ioid);
+            conn->loop.dispatch([wconn, id]() {
+                auto conn(wconn.lock());
+                if(!conn)
+                    return;
+                auto it(conn->opByIOID.find(id));
+                if(it==conn->opByIOID.end())
+                    return;
+                auto oper(std::dynamic_pointer_cast<ServerGPR>(it->second));
+                if(oper && oper->state==Idle && !oper->pendingExec.empty())
+                    execNextGPR(conn.get(), oper);
+            });
         }
     }
 
@@ -141,10 +183,25 @@ struct ServerGPR : public ServerOp
     pva_app_msg_t cmd = pva_app_msg_t(-1); //spoil
     uint8_t subcmd = 0u; // valid when state==Executing or Creating
     bool lastRequest=false;
+    // when the current EXEC was passed to the Source.  cf. LatencyHistogram::now()
+    uint64_t execStart = 0u;
+    // length of previous reply body.  Used to reserve TX buffer space for the next.
+    size_t lastBodySize = 0u;
+
+    // EXECs received, but not yet passed to the Source.
+    // A client may send another EXEC before the reply to the previous arrives.
+    struct PendingExec {
+        uint8_t subcmd;
+        Value val; // PUT or RPC argument.  With subcmd&0x04, the type expected by the client
+        std::vector<uint8_t> raw; // with subcmd&0x04, the PUT value, decoded once type is known
+    };
+    std::deque<PendingExec> pendingExec;
+    static constexpr size_t maxPendingExec = 16u;
 
     std::shared_ptr<const FieldDesc> type;
     Value pvRequest;
-    BitMask pvMask; // mask computed from pvRequest .fields
+    std::shared_ptr<const BitMask> pvMask; // mask computed from pvRequest .fields
+    WirePlan plan; // with CMD_GET.  from type and pvMask
 
     std::function<void(std::unique_ptr<server::ExecOp>&&, Value&&)> onPut;
 
@@ -165,6 +222,7 @@ struct ServerGPRConnect : public server::ConnectOp
                      const std::weak_ptr<ServerGPR>& op)
         :server::ConnectOp(name, conn->cred, cmd2op(cmd), request)
         ,server(server)
+        ,loop(conn->loop)
         ,op(op)
     {}
     virtual ~ServerGPRConnect() {
@@ -176,7 +234,7 @@ struct ServerGPRConnect : public server::ConnectOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &prototype](){
+        loop.call([this, &prototype](){
             if(auto oper = op.lock()) {
                 if(oper->state!=ServerOp::Creating)
                     return;
@@ -189,7 +247,9 @@ struct ServerGPRConnect : public server::ConnectOp
 
                 if(prototype) {
                     oper->type = Value::Helper::type(prototype);
-                    oper->pvMask = request2mask(oper->type.get(), _pvRequest);
+                    oper->pvMask = request2maskCached(oper->type, _pvRequest);
+                    if(oper->cmd==CMD_GET)
+                        oper->plan = WirePlan(oper->type.get(), oper->pvMask.get());
                 }
 
                 oper->doReply(Value(), std::string());
@@ -204,7 +264,7 @@ struct ServerGPRConnect : public server::ConnectOp
         if(!serv)
             return;
         auto op(this->op);
-        serv->acceptor_loop.dispatch([op, msg](){
+        loop.dispatch([op, msg](){
             if(auto oper = op.lock()) {
                 if(oper->state==ServerOp::Creating)
                     oper->doReply(Value(), msg);
@@ -217,7 +277,7 @@ struct ServerGPRConnect : public server::ConnectOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onGet = std::move(fn);
         });
@@ -227,7 +287,7 @@ struct ServerGPRConnect : public server::ConnectOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onPut = std::move(fn);
         });
@@ -237,13 +297,14 @@ struct ServerGPRConnect : public server::ConnectOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onClose = std::move(fn);
         });
     }
 
     const std::weak_ptr<server::Server::Pvt> server;
+    const evbase loop;
     const std::weak_ptr<ServerGPR> op;
 
     INST_COUNTER(ServerGPRConnect);
@@ -260,6 +321,7 @@ struct ServerGPRExec : public server::ExecOp
                   const std::shared_ptr<ServerGPR>& op)
         :server::ExecOp(name, conn->cred, cmd2op(cmd), op->pvRequest)
         ,server(server)
+        ,loop(conn->loop)
         ,op(op)
     {}
     virtual ~ServerGPRExec() {}
@@ -275,7 +337,7 @@ struct ServerGPRExec : public server::ExecOp
         if(!serv)
             return;
         auto op(this->op);
-        serv->acceptor_loop.dispatch([op, val](){
+        loop.dispatch([op, val](){
             if(auto oper = op.lock()) {
                 oper->doReply(val, std::string());
             }
@@ -290,7 +352,7 @@ struct ServerGPRExec : public server::ExecOp
         if(!serv)
             return;
         auto op(this->op);
-        serv->acceptor_loop.dispatch([op, msg](){
+        loop.dispatch([op, msg](){
             if(auto oper = op.lock()) {
                 oper->doReply(Value(), msg);
             }
@@ -302,7 +364,7 @@ struct ServerGPRExec : public server::ExecOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onCancel = std::move(fn);
         });
@@ -314,16 +376,91 @@ struct ServerGPRExec : public server::ExecOp
         if(!serv)
             throw std::logic_error("Can't start timer on deal server");
 
-        return Timer::Pvt::buildOneShot(delay, serv->acceptor_loop.internal(), std::move(fn));
+        return Timer::Pvt::buildOneShot(delay, loop, std::move(fn));
     }
 
     const std::weak_ptr<server::Server::Pvt> server;
+    const evbase loop;
     const std::weak_ptr<ServerGPR> op;
 
     INST_COUNTER(ServerGPRExec);
 };
 DEFINE_INST_COUNTER(ServerGPRExec);
 
+constexpr size_t ServerGPR::maxPendingExec;
+
+// pass the oldest pending EXEC to the Source.  op must be Idle.
+void execNextGPR(ServerConn* conn, const std::shared_ptr<ServerGPR>& op)
+{
+    auto chan = op->chan.lock();
+    if(!chan)
+        return;
+
+    auto cmd(op->cmd);
+    auto subcmd(op->pendingExec.front().subcmd);
+    auto val(std::move(op->pendingExec.front().val));
+    auto raw(std::move(op->pendingExec.front().raw));
+    op->pendingExec.pop_front();
+    bool isput = cmd!=CMD_GET && !(subcmd&0x40);
+
+    if(!op->lastRequest)
+        op->lastRequest = subcmd&0x10;
+
+    std::unique_ptr<ServerGPRExec> ctrl{new ServerGPRExec(conn, cmd, conn->iface->server->internal_self, chan->name, op)};
+
+    op->subcmd = subcmd;
+    op->state = ServerOp::Executing;
+    op->execStart = LatencyHistogram::now();
+
+    log_debug_printf(connsetup, "Client %s op%x executing\n", conn->peerName.c_str(), cmd);
+
+    if(cmd==CMD_PUT && isput && (subcmd&0x04)) {
+        // sent before our INIT reply, so encoded with the type the client expected.  cf. pva_qos::EarlyExec
+        auto expect(std::move(val));
+        val = Value::Helper::build(op->type);
+        FixedBuf F(conn->peerBE, raw);
+        if(expect.equalType(val))
+            from_wire_valid(F, conn->rxRegistry, val);
+
+        if(!expect.equalType(val) || !F.good()) {
+            log_debug_printf(connio, "Client %s op%x early EXEC with wrong type\n", conn->peerName.c_str(), cmd);
+            ctrl->error("Type changed");
+            return;
+        }
+    }
+
+    try {
+        SourceCallTime::Timer T(chan->opTime());
+        if(cmd==CMD_RPC && isput) {
+            if(chan->onRPC)
+                chan->onRPC(std::move(ctrl), std::move(val));
+            else
+                ctrl->error("RPC Not Implemented");
+
+        } else if(cmd==CMD_PUT && isput) {
+            if(op->onPut)
+                op->onPut(std::move(ctrl), std::move(val));
+            else
+                ctrl->error("PUT Not Implemented");
+
+        } else if(cmd!=CMD_RPC && !isput) {
+            if(op->onGet)
+                op->onGet(std::move(ctrl));
+            else
+                ctrl->error("GET Not Implemented");
+
+        } else {
+            log_err_printf(connsetup, "Client %s Get exec in incorrect command %d\n",
+                       conn->peerName.c_str(), subcmd);
+        }
+    } catch(std::exception& e) {
+        log_err_printf(connsetup, "Client %s Unhandled exception in onGet/Put/RPC %s : %s\n",
+                   conn->peerName.c_str(), typeid(e).name(), e.what());
+        if(ctrl)
+            ctrl->error(e.what());
+    }
+}
+
 } // namespace
 
 void ServerConn::handle_GPR(pva_app_msg_t cmd)
@@ -339,6 +476,7 @@ void ServerConn::handle_GPR(pva_app_msg_t cmd)
     from_wire(M, subcmd);
 
     // subcmd bitmask
+    // 0x04 - pvxs extension.  EXEC sent before INIT reply.  cf. pva_qos::EarlyExec
     // 0x08 - Init
     // 0x10 - Destroy
     // 0x40 - Get
@@ -367,7 +505,7 @@ void ServerConn::handle_GPR(pva_app_msg_t cmd)
         }
         chan->statRx += rxlen;
 
-        auto op(std::make_shared<ServerGPR>(chan, ioid));
+        auto op(allocateOp<ServerGPR>(opSlab, chan, ioid));
         op->cmd = cmd;
         op->pvRequest = pvRequest;
         std::unique_ptr<ServerGPRConnect> ctrl(new ServerGPRConnect(this, cmd, iface->server->internal_self, chan->name, pvRequest, op));
@@ -387,6 +525,7 @@ void ServerConn::handle_GPR(pva_app_msg_t cmd)
 
         } else if(chan->onOp) { // GET, PUT
             try {
+                SourceCallTime::Timer T(chan->opTime());
                 chan->onOp(std::move(ctrl));
             }catch(std::exception& e){
                 // a remote error will be signaled from ~ServerGPRConnect
@@ -400,6 +539,7 @@ void ServerConn::handle_GPR(pva_app_msg_t cmd)
 
     } else { // EXEC, maybe Get or Put
 
+        const bool early = subcmd&0x04;
         std::shared_ptr<ServerGPR> op;
         auto it = opByIOID.find(ioid);
         if(it==opByIOID.end() || it->second->state==ServerOp::Dead) {
@@ -408,7 +548,7 @@ void ServerConn::handle_GPR(pva_app_msg_t cmd)
                        peerName.c_str(), unsigned(ioid));
             return;
 
-        } else if(!(op=std::dynamic_pointer_cast<ServerGPR>(it->second)) || op->state==ServerOp::Creating) {
+        } else if(!(op=std::dynamic_pointer_cast<ServerGPR>(it->second)) || (op->state==ServerOp::Creating && !early)) {
             log_err_printf(connio, "Client %s Gets invalid IOID %u state=%d\n", peerName.c_str(),
                        unsigned(ioid),
                        op ? op->state : ServerOp::Dead);
@@ -416,17 +556,30 @@ void ServerConn::handle_GPR(pva_app_msg_t cmd)
             return;
         }
 
-        if(cmd!=CMD_RPC && !op->type) {
+        if(cmd!=CMD_RPC && !op->type && !early) {
             log_err_printf(connsetup, "Client %s tries to Exec to early\n", peerName.c_str());
             bev.reset();
             return;
         }
 
         Value val;
+        std::vector<uint8_t> raw;
         if(cmd==CMD_RPC) {
             // type and full value
             from_wire_type_value(M, rxRegistry, val);
 
+        } else if(isput && early) {
+            // expected type, then bitmask and partial value.  cf. execNextGPR()
+            from_wire_type(M, rxRegistry, val);
+            if(M.good() && !val)
+                M.fault(__FILE__, __LINE__);
+            if(M.good()) {
+                M.refill(0u); // segBuf now holds only the remainder
+                raw.resize(evbuffer_get_length(segBuf.get()));
+                if(evbuffer_remove(segBuf.get(), raw.data(), raw.size())!=int(raw.size()))
+                    M.fault(__FILE__, __LINE__);
+            }
+
         } else if(isput) {
             // bitmask and partial value
             val = Value::Helper::build(op->type);
@@ -446,52 +599,19 @@ void ServerConn::handle_GPR(pva_app_msg_t cmd)
 
         chan->statRx += rxlen;
 
-        if(op->state==ServerOp::Idle) {
-            // all set
-
-            if(!op->lastRequest)
-                op->lastRequest = subcmd&0x10;
-
-            std::unique_ptr<ServerGPRExec> ctrl{new ServerGPRExec(this, cmd, iface->server->internal_self, chan->name, op)};
-
-            op->subcmd = subcmd;
-            op->state = ServerOp::Executing;
-
-            log_debug_printf(connsetup, "Client %s op%x executing\n", peerName.c_str(), cmd);
+        if(op->state!=ServerOp::Idle && op->state!=ServerOp::Executing && !(early && op->state==ServerOp::Creating)) {
+            log_err_printf(connsetup, "CLient %s Get exec in incorrect state %d\n",
+                       peerName.c_str(), op->state);
 
-            try {
-                if(cmd==CMD_RPC && isput) {
-                    if(chan->onRPC)
-                        chan->onRPC(std::move(ctrl), std::move(val));
-                    else
-                        ctrl->error("RPC Not Implemented");
-
-                } else if(cmd==CMD_PUT && isput) {
-                    if(op->onPut)
-                        op->onPut(std::move(ctrl), std::move(val));
-                    else
-                        ctrl->error("PUT Not Implemented");
-
-                } else if(cmd!=CMD_RPC && !isput) {
-                    if(op->onGet)
-                        op->onGet(std::move(ctrl));
-                    else
-                        ctrl->error("GET Not Implemented");
-
-                } else {
-                    log_err_printf(connsetup, "Client %s Get exec in incorrect command %d\n",
-                               peerName.c_str(), subcmd);
-                }
-            } catch(std::exception& e) {
-                log_err_printf(connsetup, "Client %s Unhandled exception in onGet/Put/RPC %s : %s\n",
-                           peerName.c_str(), typeid(e).name(), e.what());
-                if(ctrl)
-                    ctrl->error(e.what());
-            }
+        } else if(op->pendingExec.size() >= ServerGPR::maxPendingExec) {
+            log_err_printf(connsetup, "Client %s exceeds %zu pipelined EXEC for ioid %u.  Ignoring\n",
+                           peerName.c_str(), ServerGPR::maxPendingExec, unsigned(ioid));
 
         } else {
-            log_err_printf(connsetup, "CLient %s Get exec in incorrect state %d\n",
-                       peerName.c_str(), op->state);
+            // EXECs are passed to the Source one at a time, in order.
+            op->pendingExec.push_back(ServerGPR::PendingExec{subcmd, std::move(val), std::move(raw)});
+            if(op->state==ServerOp::Idle)
+                execNextGPR(this, op);
         }
     }
 
@@ -39,7 +39,7 @@ struct ServerIntrospect : public ServerOp
             to_wire(R, uint32_t(ioid));
             to_wire(R, sts);
             if(type)
-                to_wire(R, type);
+                to_wire(R, type, conn->txTypes);
         }
 
         ch->statTx += conn->enqueueTxBody(CMD_GET_FIELD);
@@ -65,6 +65,7 @@ struct ServerIntrospectControl : public server::ConnectOp
                             const std::weak_ptr<ServerIntrospect>& op)
         :server::ConnectOp(chan->name, conn->cred, Info, Value()) // TODO: pvRequest?
         ,server(server)
+        ,loop(conn->loop)
         ,op(op)
     {}
     virtual ~ServerIntrospectControl() {
@@ -92,7 +93,7 @@ struct ServerIntrospectControl : public server::ConnectOp
         if(!serv)
             return; // soft fail if already completed, canceled, disconnected, ....
 
-        serv->acceptor_loop.call([this, type, &sts](){
+        loop.call([this, type, &sts](){
             if(auto oper = op.lock())
                 oper->doReply(type, sts);
         });
@@ -103,7 +104,7 @@ struct ServerIntrospectControl : public server::ConnectOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onClose = std::move(fn);
         });
@@ -114,6 +115,7 @@ struct ServerIntrospectControl : public server::ConnectOp
     virtual void onPut(std::function<void(std::unique_ptr<server::ExecOp>&& fn, Value&&)>&& fn) override final {}
 
     const std::weak_ptr<server::Server::Pvt> server;
+    const evbase loop;
     const std::weak_ptr<ServerIntrospect> op;
 
     INST_COUNTER(ServerIntrospectControl);
@@ -156,6 +158,7 @@ void ServerConn::handle_GET_FIELD()
 
     if(chan->onOp) {
         try {
+            SourceCallTime::Timer T(chan->opTime());
             chan->onOp(std::move(ctrl));
         }catch(std::exception& e){
             // a remote error will be signaled from ~ServerIntrospectControl
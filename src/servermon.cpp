@@ -5,30 +5,113 @@
  */
 
 #include <cassert>
+#include <cmath>
+#include <typeinfo>
 
-#include <deque>
+#include <map>
 
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsTime.h>
 
 #include <pvxs/log.h>
 #include "dataimpl.h"
+#include "wirecache.h"
 #include "serverconn.h"
 #include "pvrequest.h"
+#include "tracepoint.h"
 
 namespace pvxs { namespace impl {
 DEFINE_LOGGER(connsetup, "pvxs.tcp.setup");
 DEFINE_LOGGER(connio, "pvxs.tcp.io");
 
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+// lookup table of WireCache, divided into independently locked shards
+// so that post()s from different threads to different PVs seldom contend.
+struct WireCacheShard {
+    epicsMutex lock;
+    // weak refs so that an entry lives only as long as some MonitorOp::queue,
+    // or pass-through client Value, references it.
+    // A key can not be re-used while its entry is alive, as the entry is always held along
+    // with a Value referencing the same storage.
+    std::map<const FieldStorage*, std::weak_ptr<WireCache>> caches;
+    size_t pruneAt = 256u;
+};
+constexpr size_t nWireCacheShards = 16u;
+}
+
+static
+WireCacheShard& wireCacheShard(const FieldStorage* key)
+{
+    static WireCacheShard shards[nWireCacheShards];
+
+    // low bits of a heap address carry little information
+    return shards[(reinterpret_cast<size_t>(key)>>6u) % nWireCacheShards];
+}
+
+std::shared_ptr<WireCache> WireCache::find(const FieldStorage* key)
+{
+    auto& shard = wireCacheShard(key);
+
+    Guard G(shard.lock);
+
+    auto it(shard.caches.find(key));
+    return it!=shard.caches.end() ? it->second.lock() : nullptr;
+}
+
+std::shared_ptr<WireCache> WireCache::lookup(const FieldStorage* key)
+{
+    auto& shard = wireCacheShard(key);
+
+    Guard G(shard.lock);
+
+    auto& ent = shard.caches[key];
+    auto ret(ent.lock());
+    if(!ret) {
+        ret = std::make_shared<WireCache>(key);
+        ent = ret;
+
+        if(shard.caches.size() >= shard.pruneAt) {
+            for(auto it(shard.caches.begin()), end(shard.caches.end()); it!=end;) {
+                if(it->second.expired())
+                    it = shard.caches.erase(it);
+                else
+                    ++it;
+            }
+            shard.pruneAt = std::max(size_t(256u), 2u*shard.caches.size());
+        }
+    }
+    return ret;
+}
+
 namespace {
 
-typedef epicsGuard<epicsMutex> Guard;
+
+struct QueueEntry {
+    Value val;
+    std::shared_ptr<WireCache> wire;
+    // when posted.  cf. LatencyHistogram::now()
+    uint64_t posted = 0u;
+
+    QueueEntry() = default;
+    explicit QueueEntry(const Value& val)
+        :val(val)
+        ,wire(val ? WireCache::lookup(val) : nullptr)
+    {}
+    explicit QueueEntry(Value&& val)
+        :val(std::move(val))
+        ,wire(this->val ? WireCache::lookup(this->val) : nullptr)
+    {}
+};
 
 struct MonitorOp : public ServerOp,
                    public std::enable_shared_from_this<MonitorOp>
 {
     MonitorOp(const std::shared_ptr<ServerChan>& chan, uint32_t ioid)
         :ServerOp(chan, ioid)
+        ,conn(chan->conn)
     {
         // ServerOp::onCancel isn't exposed to users for MONITOR
         // so we can (ab)use for internal cleanup.
@@ -40,7 +123,18 @@ struct MonitorOp : public ServerOp,
             }
         };
     }
-    virtual ~MonitorOp() {}
+    virtual ~MonitorOp() {
+        if(reserved) {
+            if(auto c = conn.lock())
+                c->monReserved.fetch_sub(reserved, std::memory_order_relaxed);
+        }
+    }
+
+    // cf. ServerConn::monReserved
+    const std::weak_ptr<ServerConn> conn;
+    size_t reserved = 0u;
+    // upper bound on 'limit' from Config::connMemoryLimit
+    size_t maxLimit = size_t(-1);
 
     // only access from accepter worker thread
     std::function<void(bool)> onStart;
@@ -51,7 +145,9 @@ struct MonitorOp : public ServerOp,
 
     // const after setup phase
     std::shared_ptr<const FieldDesc> type;
-    BitMask pvMask;
+    std::shared_ptr<const BitMask> pvMask;
+    // pvMask applied to type
+    WirePlan plan;
     std::string msg;
 
     // Further members can only be changed from the accepter worker thread with this lock held.
@@ -68,21 +164,138 @@ struct MonitorOp : public ServerOp,
     size_t ackAt=1u;
     size_t maxQueue=0u;
     size_t nSquash=0u;
-
-    std::deque<Value> queue;
+    // size of previous reply.  Used to guess the size of the next.
+    size_t lastTxSize=0u;
+    // length of previous encoded update.  cf. WireCache::encode()
+    size_t lastEncSize=0u;
+    // cf. ServerConn::defer()
+    unsigned priority=0u;
+    // minimum time between updates, in seconds.  From pvRequest record._options.maxRate.
+    // Zero to send each update.  When non-zero, updates posted during the interval are squashed.
+    double minInterval=0.0;
+    // From pvRequest record._options.compress.  Compress large updates if the client supports this.
+    bool compress=false;
+    // From pvRequest record._options.delta.  Send changed arrays as patches if the client supports this.
+    bool delta=false;
+    // With delta, each array field as last sent to the client, by offset
+    std::map<size_t, shared_array<const void>> lastArrays;
+    // From pvRequest record._options.deadband.  eg. 0.5 or "1%".
+    // Updates which only change a numeric "value" field by no more than this are dropped.
+    double deadband=0.0;
+    bool deadbandPercent=false;
+    // "value" of the latest update queued, with deadband
+    double deadbandLast=0.0;
+    bool deadbandHave=false;
+    epicsTime lastSent;
+    // while holding an update until minInterval has passed.  Created on first use.
+    evevent rateTimer;
+
+    RingQueue<QueueEntry> queue;
 
     INST_COUNTER(MonitorOp);
 
+    // caller must hold lock.
+    // With deadband, true if this update should be dropped, before it is queued or encoded.
+    // As with a record MDEL, changes to fields other than "value" and "timeStamp" are always sent.
+    bool deadbandFilter(const Value& val)
+    {
+        auto fld(val["value"]);
+        if(!fld || (fld.type().kind()!=Kind::Integer && fld.type().kind()!=Kind::Real))
+            return false; // not applicable
+
+        bool onlyValue = true;
+        for(auto child : val.ichildren()) {
+            if(!child.isMarked(true, true))
+                continue;
+            auto& name = val.nameOf(child);
+            if(name!="value" && name!="timeStamp") {
+                onlyValue = false; // eg. alarm change
+                break;
+            }
+        }
+
+        const bool changed = fld.isMarked(true, true);
+
+        if(onlyValue && deadbandHave) {
+            double cur = changed ? fld.as<double>() : deadbandLast;
+            double band = deadbandPercent ? deadband/100.0*std::fabs(deadbandLast) : deadband;
+            if(std::fabs(cur - deadbandLast) <= band)
+                return true;
+        }
+
+        if(changed) {
+            deadbandLast = fld.as<double>();
+            deadbandHave = true;
+        }
+        return false;
+    }
+
     // caller must hold lock.
     // only used after State==Idle
+    /* Encode an update as with to_wire_valid(), except that some changed arrays are
+     * sent as patches against the previous array sent.  Not shared through WireCache.
+     *
+     * After the usual overrun mask, append Size of patches, then for each
+     * the Size field offset and the runs.  cf. to_wire_patch()
+     */
+    void encodeDelta(Buffer& R, const Value& val, TypeCache& types)
+    {
+        auto desc = Value::Helper::desc(val);
+        auto store = Value::Helper::store_ptr(val);
+
+        BitMask mask(plan.mask.size());
+        for(auto i : range(mask.wsize()))
+            mask.word(i) = plan.mask.word(i);
+
+        std::vector<std::pair<size_t, ArrayRuns>> patches;
+
+        // walk selected fields, as to_wire_valid()
+        for(size_t bit=0u, N=desc->size(); bit<N;) {
+            if(!store[bit].valid || !mask[bit]) {
+                bit++;
+                continue;
+            }
+
+            if(store[bit].code==StoreType::Array) {
+                auto& cur = store[bit].as<shared_array<const void>>();
+                auto& prev = lastArrays[bit];
+                ArrayRuns runs;
+                if(diffArray(runs, prev, cur)) {
+                    mask[bit] = false;
+                    patches.emplace_back(bit, std::move(runs));
+                }
+                prev = cur;
+
+            } else {
+                // arrays within a selected sub-structure are sent in full
+                for(auto i : range(bit+1u, bit+desc[bit].size())) {
+                    if(store[i].code==StoreType::Array)
+                        lastArrays[i] = store[i].as<shared_array<const void>>();
+                }
+            }
+            bit += desc[bit].size();
+        }
+
+        to_wire_valid(R, val, &mask, &types);
+        // TODO: placeholder for overrun mask
+        to_wire(R, uint8_t(0u));
+
+        to_wire(R, Size{patches.size()});
+        for(auto& patch : patches) {
+            to_wire(R, Size{patch.first});
+            to_wire_patch(R, desc + patch.first,
+                          store[patch.first].as<shared_array<const void>>(), patch.second);
+        }
+    }
+
     static
-    void maybeReply(server::Server::Pvt* server, const std::shared_ptr<MonitorOp>& op)
+    void maybeReply(const evbase& loop, const std::shared_ptr<MonitorOp>& op)
     {
         // can we send a reply?
         if(!op->scheduled && op->state==Executing && !op->queue.empty() && (!op->pipeline || op->window))
         {
             // based on operation state, yes
-            server->acceptor_loop.dispatch([op](){
+            loop.dispatch([op](){
                 auto ch(op->chan.lock());
                 if(!ch)
                     return;
@@ -90,11 +303,11 @@ struct MonitorOp : public ServerOp,
                 if(!conn || conn->state==ConnBase::Disconnected)
                     return;
 
-                if(conn->connection() && (bufferevent_get_enabled(conn->connection())&EV_READ)) {
+                if(conn->connection() && !conn->txFull()) {
                     op->doReply();
                 } else {
                     // connection TX queue is too full
-                    conn->backlog.emplace_back([op]() { op->doReply(); });
+                    conn->defer([op]() { op->doReply(); }, op->lastTxSize, op->priority);
                 }
             });
 
@@ -132,18 +345,39 @@ struct MonitorOp : public ServerOp,
                                  conn->peerName.c_str(), unsigned(ioid));
                 return; // nothing to do
 
-            } else if(!queue.front()) {
+            } else if(!queue.front().val) {
                 subcmd = 0x10;
                 state = Dead;
                 log_debug_printf(connio, "Client %s IOID %u finishes\n",
                                  conn->peerName.c_str(), unsigned(ioid));
+
+            } else if(minInterval>0.0) {
+                auto now(epicsTime::getCurrent());
+                double remaining = minInterval - (now - lastSent);
+                if(remaining>0.0) {
+                    // too soon.  hold until the interval has passed
+                    if(!rateTimer)
+                        rateTimer = evevent(__FILE__, __LINE__,
+                                            event_new(conn->loop.base, -1, EV_TIMEOUT, &onRateTimerS, this));
+                    timeval tmo(totv(remaining));
+                    if(event_add(rateTimer.get(), &tmo))
+                        log_err_printf(connio, "Client %s IOID %u unable to start rate timer\n",
+                                       conn->peerName.c_str(), unsigned(ioid));
+                    scheduled = true; // doReply() will be called from onRateTimerS()
+                    return;
+                }
+                lastSent = now;
             }
         }
 
+        if(subcmd==0u && delta && conn->peerDelta && !queue.empty() && queue.front().val)
+            subcmd |= 0x20; // update with array patches
+
+        std::shared_ptr<evbuffer> encoded;
         {
             (void)evbuffer_drain(conn->txBody.get(), evbuffer_get_length(conn->txBody.get()));
 
-            EvOutBuf R(conn->sendBE, conn->txBody.get());
+            EvOutBuf R(conn->sendBE, conn->txBody.get(), 0u, true);
             to_wire(R, uint32_t(ioid));
             to_wire(R, subcmd);
             if(subcmd&0x08) {
@@ -152,25 +386,50 @@ struct MonitorOp : public ServerOp,
 
                 } else {
                     to_wire(R, Status{});
-                    to_wire(R, type.get());
+                    to_wire(R, type.get(), conn->txTypes);
                 }
 
             } else if(!queue.empty()) {
                 auto& ent = queue.front();
-                if(ent) {
-                    to_wire_valid(R, ent, &pvMask);
-                    // TODO: placeholder for overrun mask
-                    to_wire(R, uint8_t(0u));
+                if(subcmd&0x20) {
+                    encodeDelta(R, ent.val, conn->txTypes);
+                    if(ch->latency)
+                        ch->latency->monitor.add(ent.posted);
+
+                } else if(ent.val && plan.variant) {
+                    // Variant types are sent through the type cache of this connection,
+                    // so the encoding can not be shared with other connections.
+                    to_wire_valid(R, ent.val, plan, &conn->txTypes);
+                    to_wire(R, uint8_t(0u)); // TODO: placeholder for overrun mask
+                    if(ch->latency)
+                        ch->latency->monitor.add(ent.posted);
+
+                } else if(ent.val) {
+                    // appended below, after R is flushed
+                    encoded = ent.wire->encode(conn->sendBE, ent.val, plan, lastEncSize);
+                    lastEncSize = evbuffer_get_length(encoded.get());
+                    if(ch->latency)
+                        ch->latency->monitor.add(ent.posted);
 
                 } else { // finish (could be used to send an error)
                     to_wire(R, Status{});
                 }
 
                 queue.pop_front();
+                PVXS_TRACE2(server_mon_pop, this, queue.size());
             }
         }
 
-        ch->statTx += conn->enqueueTxBody(pva_app_msg_t::CMD_MONITOR);
+        if(encoded) {
+            WireCache::append(conn->sendBE, conn->txBody.get(), encoded);
+
+            EvOutBuf R(conn->sendBE, conn->txBody.get());
+            // TODO: placeholder for overrun mask
+            to_wire(R, uint8_t(0u));
+        }
+
+        lastTxSize = conn->enqueueTxBody(pva_app_msg_t::CMD_MONITOR, compress);
+        ch->statTx += lastTxSize;
 
         if(state == ServerOp::Dead) {
             cleanup();
@@ -185,7 +444,7 @@ struct MonitorOp : public ServerOp,
 
             if(!lowMarkPending && window <= low && onLowMark) {
                 lowMarkPending = true;
-                conn->iface->server->acceptor_loop.dispatch([self]() {
+                conn->loop.dispatch([self]() {
                     decltype (self->onLowMark) fn;
                     {
                         Guard G(self->lock);
@@ -202,17 +461,83 @@ struct MonitorOp : public ServerOp,
             // reschedule myself
             assert(!scheduled); // we've been holding the lock, so this should not have changed
 
-            conn->iface->server->acceptor_loop.dispatch([self]() {
+            conn->loop.dispatch([self]() {
                 self->doReply();
             });
             scheduled = true;
         }
     }
 
+    static
+    void onRateTimerS(evutil_socket_t fd, short evt, void *raw)
+    {
+        try {
+            auto op = static_cast<MonitorOp*>(raw);
+            auto ch(op->chan.lock());
+            auto conn(ch ? ch->conn.lock() : nullptr);
+            if(conn && conn->connection() && conn->txFull()) {
+                // connection TX queue is too full
+                auto self(op->shared_from_this());
+                conn->defer([self]() { self->doReply(); }, op->lastTxSize, op->priority);
+            } else {
+                op->doReply();
+            }
+        }catch(std::exception& e) {
+            log_exc_printf(connio, "Unhandled exception in %s %s : %s\n",
+                           __func__, typeid (e).name(), e.what());
+        }
+    }
+
     void show(std::ostream& strm) const override final
     {
         strm<<"MONITOR\n";
     }
+
+    /* Reserve queue space for updates of about entryBytes each within Config::connMemoryLimit,
+     * reducing the queue size as necessary.  At least one entry is always reserved.
+     * Call from worker, once the type is known.
+     */
+    void reserve(size_t entryBytes)
+    {
+        auto c(conn.lock());
+        if(!c)
+            return;
+        auto budget = c->iface->server->effective.connMemoryLimit;
+        if(!budget)
+            return;
+
+        entryBytes = std::max(entryBytes, size_t(1u));
+        auto used = c->monReserved.load(std::memory_order_relaxed);
+        auto fit = std::max(size_t(1u), used < budget ? (budget-used)/entryBytes : 0u);
+
+        Guard G(lock);
+        if(limit > fit) {
+            log_debug_printf(connsetup, "Client %s ioid=%u queueSize %zu -> %zu to fit connMemoryLimit\n",
+                             c->peerName.c_str(), unsigned(ioid), limit, fit);
+            limit = fit;
+            ackAt = std::max<size_t>(1u, std::min(ackAt, limit));
+        }
+        maxLimit = fit;
+        reserved = limit*entryBytes;
+        c->monReserved.fetch_add(reserved, std::memory_order_relaxed);
+    }
+
+    bool queueStats(size_t& queued, size_t& qlimit) const override final
+    {
+        Guard G(lock);
+        queued = queue.size();
+        qlimit = limit;
+        return true;
+    }
+
+    size_t queueBytes() const override final
+    {
+        Guard G(lock);
+        size_t ret = 0u;
+        for(auto i : range(queue.size()))
+            ret += Value::Helper::approxBytes(queue[i].val);
+        return ret;
+    }
 };
 DEFINE_INST_COUNTER(MonitorOp);
 
@@ -229,6 +554,16 @@ struct ServerMonitorControl : public server::MonitorControlOp
     }
 
     virtual bool doPost(const Value& val, bool maybe, bool force) override final
+    {
+        return postOwned(Value(val), maybe, force);
+    }
+
+    virtual bool doPostMove(Value&& val, bool maybe, bool force) override final
+    {
+        return postOwned(std::move(val), maybe, force);
+    }
+
+    bool postOwned(Value&& val, bool maybe, bool force)
     {
         auto mon(op.lock());
         if(!mon)
@@ -238,27 +573,50 @@ struct ServerMonitorControl : public server::MonitorControlOp
             throw std::logic_error("Type change not allowed in post().  Recommend pvxs::Value::cloneEmpty()");
 
         // pvMask is const at this point, so no need to lock
-        bool real = testmask(val, mon->pvMask);
+        bool real = testmask(val, *mon->pvMask);
+        bool fin = !val;
+
+        // deadband is const at this point
+        if(real && mon->deadband>0.0) {
+            Guard G(mon->lock);
+            real = !mon->deadbandFilter(val);
+        }
+
+        QueueEntry ent;
+        if(real) {
+            ent = QueueEntry(std::move(val));
+            ent.posted = LatencyHistogram::now();
+        }
 
         Guard G(mon->lock);
         if(mon->finished)
             throw std::logic_error("Already finish()'d"); // TODO fail soft
 
-        if(real || !val) {
+        if(real || fin) {
+
+            // with a rate limit, further updates are squashed into one which is waiting
+            bool coalesce = mon->minInterval>0.0 && !fin && !mon->queue.empty() && mon->queue.back().val;
 
-            if((mon->queue.size() < mon->limit) || force || !val) {
+            if(!coalesce && ((mon->queue.size() < mon->limit) || force || fin)) {
 
-                mon->finished = !val;
-                mon->queue.push_back(val);
+                mon->finished = fin;
+                mon->queue.push_back(std::move(ent));
+                PVXS_TRACE2(server_mon_push, mon.get(), mon->queue.size());
 
                 if(mon->maxQueue < mon->queue.size())
                     mon->maxQueue = mon->queue.size();
 
-            } else if(!maybe) {
+            } else if(coalesce || !maybe) {
                 // squash
                 assert(mon->limit>0 && !mon->queue.empty());
 
-                mon->queue.back().assign(val);
+                // the queued Value may be shared with other subscribers,
+                // and its encoding cached, so squash into a private copy.
+                auto squashed(mon->queue.back().val.clone());
+                squashed.assign(ent.val);
+                auto posted(mon->queue.back().posted); // latency from the oldest update squashed
+                mon->queue.back() = QueueEntry(squashed);
+                mon->queue.back().posted = posted;
                 mon->nSquash++;
 
             } else {
@@ -266,7 +624,7 @@ struct ServerMonitorControl : public server::MonitorControlOp
             }
 
             if(auto serv = server.lock())
-                MonitorOp::maybeReply(serv.get(), mon);
+                MonitorOp::maybeReply(loop, mon);
         }
 
         return mon->queue.size() < mon->limit;
@@ -302,7 +660,7 @@ struct ServerMonitorControl : public server::MonitorControlOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, low, high](){
+        loop.call([this, low, high](){
             if(auto oper = op.lock()) {
                 Guard G(oper->lock);
                 oper->low = std::min(low, oper->ackAt-1u);
@@ -312,12 +670,24 @@ struct ServerMonitorControl : public server::MonitorControlOp
             }
         });
     }
+    virtual void setPriority(unsigned priority) override final
+    {
+        auto serv = server.lock();
+        if(!serv)
+            return;
+        loop.call([this, priority](){
+            if(auto oper = op.lock()) {
+                Guard G(oper->lock);
+                oper->priority = std::min(priority, ServerConn::nPriorities-1u);
+            }
+        });
+    }
     virtual void onStart(std::function<void (bool)> &&fn) override final
     {
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onStart = std::move(fn);
         });
@@ -327,7 +697,7 @@ struct ServerMonitorControl : public server::MonitorControlOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onHighMark = std::move(fn);
         });
@@ -337,13 +707,14 @@ struct ServerMonitorControl : public server::MonitorControlOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onLowMark = std::move(fn);
         });
     }
 
     const std::weak_ptr<server::Server::Pvt> server;
+    const evbase loop;
     const std::weak_ptr<MonitorOp> op;
 
     INST_COUNTER(ServerMonitorControl);
@@ -359,6 +730,7 @@ struct ServerMonitorSetup : public server::MonitorSetupOp
                      const std::weak_ptr<MonitorOp>& op)
         :MonitorSetupOp(name, conn->cred, Info, request)
         ,server(server)
+        ,loop(conn->loop)
         ,op(op)
     {}
     virtual ~ServerMonitorSetup() {
@@ -370,18 +742,20 @@ struct ServerMonitorSetup : public server::MonitorSetupOp
         if(!prototype)
             throw std::invalid_argument("Must provide prototype");
         auto type = Value::Helper::type(prototype);
-        auto mask = request2mask(type.get(), _pvRequest);
+        auto mask = request2maskCached(type, _pvRequest);
 
         std::unique_ptr<server::MonitorControlOp> ret;
 
         auto serv = server.lock();
         if(!serv)
             return ret;
-        serv->acceptor_loop.call([this, &type, &ret, &mask](){
+        loop.call([this, &type, &ret, &mask, &prototype](){
             if(auto oper = op.lock()) {
                 if(oper->state!=ServerOp::Creating)
                     return;
                 oper->type = type;
+                oper->reserve(Value::Helper::approxBytes(prototype));
+                oper->plan = WirePlan(type.get(), mask.get());
                 oper->pvMask = std::move(mask);
                 ret.reset(new ServerMonitorControl(this, server, _name, oper));
                 oper->doReply();
@@ -400,7 +774,7 @@ struct ServerMonitorSetup : public server::MonitorSetupOp
         if(!serv)
             return;
         auto op(this->op);
-        serv->acceptor_loop.dispatch([op, msg]() mutable {
+        loop.dispatch([op, msg]() mutable {
             if(auto oper = op.lock()) {
                 if(oper->state==ServerOp::Creating) {
                     oper->msg = std::move(msg);
@@ -414,13 +788,14 @@ struct ServerMonitorSetup : public server::MonitorSetupOp
         auto serv = server.lock();
         if(!serv)
             return;
-        serv->acceptor_loop.call([this, &fn](){
+        loop.call([this, &fn](){
             if(auto oper = op.lock())
                 oper->onClose = std::move(fn);
         });
     }
 
     const std::weak_ptr<server::Server::Pvt> server;
+    const evbase loop;
     const std::weak_ptr<MonitorOp> op;
 
     INST_COUNTER(ServerMonitorSetup);
@@ -434,6 +809,7 @@ ServerMonitorControl::ServerMonitorControl(ServerMonitorSetup* setup,
                                            const std::weak_ptr<MonitorOp>& op)
     :server::MonitorControlOp(name, setup->credentials(), Info)
     ,server(server)
+    ,loop(setup->loop)
     ,op(op)
 {}
 
@@ -478,7 +854,7 @@ void ServerConn::handle_MONITOR()
         }
         chan->statRx += rxlen;
 
-        auto op(std::make_shared<MonitorOp>(chan, ioid));
+        auto op(allocateOp<MonitorOp>(opSlab, chan, ioid));
         op->window = nack;
         (void)pvRequest["record._options.pipeline"].as(op->pipeline);
 
@@ -486,6 +862,53 @@ void ServerConn::handle_MONITOR()
             op->limit = qSize;
         });
 
+        pvRequest["record._options.priority"].as<uint32_t>([&op](uint32_t prio){
+            op->priority = std::min(prio, ServerConn::nPriorities-1u);
+        });
+
+        pvRequest["record._options.maxRate"].as<double>([&op](double rate){
+            if(rate>0.0)
+                op->minInterval = 1.0/rate;
+        });
+
+        {
+            auto compress = pvRequest["record._options.compress"];
+            if(compress.type()==TypeCode::String) {
+                auto method(compress.as<std::string>());
+                if(method=="lz4") {
+                    op->compress = true;
+                } else {
+                    log_debug_printf(connio, "Client %s unsupported compression \"%s\"\n",
+                                     peerName.c_str(), method.c_str());
+                }
+            } else {
+                (void)compress.as(op->compress);
+            }
+        }
+
+        (void)pvRequest["record._options.delta"].as(op->delta);
+
+        {
+            auto deadband = pvRequest["record._options.deadband"];
+            std::string sval;
+            if(deadband.type()==TypeCode::String && deadband.as(sval) && !sval.empty() && sval.back()=='%') {
+                try {
+                    op->deadband = parseTo<double>(sval.substr(0, sval.size()-1u));
+                    op->deadbandPercent = true;
+                }catch(std::exception&){
+                    log_warn_printf(connio, "Error parsing as percent deadband: \"%s\"\n", sval.c_str());
+                }
+            } else if(deadband) {
+                double val = 0.0;
+                if(deadband.as(val))
+                    op->deadband = val;
+                else
+                    log_warn_printf(connio, "Error parsing deadband\n%s", "");
+            }
+            if(!std::isfinite(op->deadband) || op->deadband<0.0)
+                op->deadband = 0.0;
+        }
+
         if(op->limit < op->window)
             op->limit = op->window;
 
@@ -531,7 +954,13 @@ void ServerConn::handle_MONITOR()
                    peerName.c_str(), op->pipeline ? " pipeline" : "", unsigned(ioid),
                    std::string(SB()<<pvRequest).c_str());
 
-        if(chan->onSubscribe) {
+        auto budget = iface->server->effective.connMemoryLimit;
+        if(budget && monReserved.load(std::memory_order_relaxed) >= budget) {
+            log_debug_printf(connsetup, "Client %s refuse Monitor ioid=%u beyond connMemoryLimit\n",
+                             peerName.c_str(), unsigned(ioid));
+            ctrl->error("Connection memory limit exceeded");
+        } else if(chan->onSubscribe) {
+            SourceCallTime::Timer T(chan->opTime());
             chan->onSubscribe(std::move(ctrl));
         } else {
             ctrl->error("Monitor operation not implemented by this PV");
@@ -595,9 +1024,13 @@ void ServerConn::handle_MONITOR()
 
             op->window += nack;
 
+            // a client adapting its window may grant more than the queueSize it initially requested
+            if(op->limit < op->window)
+                op->limit = std::max(op->limit, std::min(op->window, op->maxLimit));
+
             if(!op->highMarkPending && op->window > op->high && op->onHighMark && !op->finished) {
                 op->highMarkPending = true;
-                iface->server->acceptor_loop.dispatch([op](){
+                loop.dispatch([op](){
                     decltype(op->onHighMark) fn;
                     {
                         Guard G(op->lock);
@@ -622,12 +1055,14 @@ void ServerConn::handle_MONITOR()
                 op->state = start ? ServerOp::Executing : ServerOp::Idle;
             }
 
-            if(op->onStart)
+            if(op->onStart) {
+                SourceCallTime::Timer T(chan->opTime());
                 op->onStart(start);
+            }
 
             {
                 Guard G(op->lock);
-                MonitorOp::maybeReply(iface->server, op);
+                MonitorOp::maybeReply(loop, op);
             }
         }
 
@@ -640,7 +1075,7 @@ void ServerConn::handle_MONITOR()
                 auto self(it->second);
                 opByIOID.erase(it);
 
-                iface->server->acceptor_loop.dispatch([self](){
+                loop.dispatch([self](){
                     self->cleanup();
                 });
 
@@ -4,6 +4,8 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <epicsString.h>
+
 #include <pvxs/log.h>
 #include <pvxs/nt.h>
 #include "serverconn.h"
@@ -20,6 +22,13 @@ ServerSource::ServerSource(server::Server::Pvt* serv)
                       Member(TypeCode::String, "implLang"),
                       Member(TypeCode::String, "version"),
                   }).create())
+    ,latency(TypeDef(TypeCode::Struct, {
+                         Member(TypeCode::StructA, "value", {
+                             Member(TypeCode::String, "source"),
+                             Member(TypeCode::String, "op"),
+                             Member(TypeCode::UInt64A, "count"),
+                         }),
+                     }).create())
 {}
 
 void ServerSource::onSearch(Search &op)
@@ -29,6 +38,11 @@ void ServerSource::onSearch(Search &op)
 
 void ServerSource::onCreate(std::unique_ptr<server::ChannelControl> &&op)
 {
+    if(!serv->effective.statsPV.empty() && op->name()==serv->effective.statsPV) {
+        serv->statsPV.attach(std::move(op));
+        return;
+    }
+
     if(op->name()!=name)
         return;
 
@@ -53,6 +67,20 @@ void ServerSource::onCreate(std::unique_ptr<server::ChannelControl> &&op)
         auto op = args["op"].as<std::string>();
 
         if(op=="channels") {
+            /* Optional server-side filtering and paging.
+             *   pattern - glob of names to include.
+             *   after   - only names which sort after this.  eg. the last name of the previous page.
+             *   limit   - max. number of names in reply.  Zero for no limit.
+             * Names are returned in sorted order.  A reply with fewer than limit names is the last page.
+             */
+            std::string pattern, after;
+            uint64_t limit = 0u;
+            (void)args["pattern"].as(pattern);
+            (void)args["after"].as(after);
+            (void)args["limit"].as(limit);
+
+            // names matching pattern must begin with its literal prefix
+            const auto prefix(pattern.substr(0u, pattern.find_first_of("*?[\\")));
 
             std::set<std::string> names;
             {
@@ -60,10 +88,25 @@ void ServerSource::onCreate(std::unique_ptr<server::ChannelControl> &&op)
 
                 for(auto& pair : serv->sources) {
                     auto list = pair.second->onList();
-                    if(list.names) {
-                        for(auto& name : *list.names) {
-                            names.insert(name);
-                        }
+                    if(!list.names)
+                        continue;
+                    auto& lnames = *list.names;
+
+                    auto it(after.empty() || after < prefix ? lnames.lower_bound(prefix) : lnames.upper_bound(after));
+
+                    for(auto end(lnames.end()); it!=end; ++it) {
+                        auto& name = *it;
+
+                        if(name.compare(0u, prefix.size(), prefix)!=0)
+                            break; // past names with prefix
+                        if(limit && names.size()>=limit && name > *names.rbegin())
+                            break; // all later names of this Source would be dropped
+                        if(!pattern.empty() && !epicsStrGlobMatch(name.c_str(), pattern.c_str()))
+                            continue;
+
+                        names.insert(name);
+                        if(limit && names.size()>limit)
+                            names.erase(std::prev(names.end()));
                     }
                 }
             }
@@ -86,6 +129,34 @@ void ServerSource::onCreate(std::unique_ptr<server::ChannelControl> &&op)
             ret["implLang"] = "cpp";
             ret["version"] = version_str();
 
+            eop->reply(ret);
+            return;
+
+        } else if(op=="latency") {
+            Report report;
+            serv->reportLatency(report, false);
+
+            auto ret = latency.cloneEmpty();
+            shared_array<Value> entries(4u*report.latency.size());
+            size_t i=0;
+            for(auto& pair : report.latency) {
+                const std::pair<const char*, const Report::Latency*> kinds[] = {
+                    {"get", &pair.second.get},
+                    {"put", &pair.second.put},
+                    {"rpc", &pair.second.rpc},
+                    {"monitor", &pair.second.monitor},
+                };
+                for(auto& kind : kinds) {
+                    shared_array<uint64_t> count(kind.second->count.begin(), kind.second->count.end());
+                    auto& ent = entries[i++];
+                    ent = ret["value"].allocMember();
+                    ent["source"] = pair.first;
+                    ent["op"] = kind.first;
+                    ent["count"] = count.freeze();
+                }
+            }
+            ret["value"] = entries.freeze();
+
             eop->reply(ret);
             return;
         }
@@ -94,6 +165,89 @@ void ServerSource::onCreate(std::unique_ptr<server::ChannelControl> &&op)
     });
 }
 
+void ServerSource::attachIndex(const std::shared_ptr<NameIndex>& idx)
+{
+    if(!serv->effective.statsPV.empty())
+        idx->add(serv->effective.statsPV);
+}
+
+void ServerSource::detachIndex(const std::shared_ptr<NameIndex>& idx)
+{
+    if(!serv->effective.statsPV.empty())
+        idx->remove(serv->effective.statsPV);
+}
+
+NameIndex::Shard& NameIndex::shardOf(const char* name)
+{
+    return shards[epicsStrHash(name, 0u) % shards.size()];
+}
+
+void NameIndex::add(const std::string& name)
+{
+    auto& shard = shardOf(name.c_str());
+    auto G(shard.lock.lockWriter());
+    shard.names[name]++;
+}
+
+void NameIndex::remove(const std::string& name)
+{
+    auto& shard = shardOf(name.c_str());
+    auto G(shard.lock.lockWriter());
+    auto it(shard.names.find(name));
+    if(it!=shard.names.end() && --it->second==0u)
+        shard.names.erase(it);
+}
+
+bool NameIndex::contains(const char* name)
+{
+    auto& shard = shardOf(name);
+    auto G(shard.lock.lockReader());
+    return shard.names.find(name)!=shard.names.end();
+}
+
+size_t NameIndex::size()
+{
+    size_t ret = 0u;
+    for(auto& shard : shards) {
+        auto G(shard.lock.lockReader());
+        ret += shard.names.size();
+    }
+    return ret;
+}
+
+IndexedSource::~IndexedSource() {}
+
+// 10 bits per name, with 7 probes, gives a false positive rate of ~1%
+static constexpr size_t nameFilterBitsPerName = 10u;
+static constexpr unsigned nameFilterProbes = 7u;
+
+NameFilter::NameFilter(size_t nnames)
+    :bits((nnames*nameFilterBitsPerName + 63u)/64u + 1u, 0u)
+{}
+
+void NameFilter::add(const char* name)
+{
+    const size_t nbits = bits.size()*64u;
+    auto h1 = epicsStrHash(name, 0u);
+    auto h2 = epicsStrHash(name, 0x9e3779b9u) | 1u;
+    for(auto i : range(nameFilterProbes)) {
+        size_t bit = (h1 + i*h2) % nbits;
+        bits[bit/64u] |= uint64_t(1u)<<(bit%64u);
+    }
+}
+
+bool NameFilter::mayContain(const char* name) const
+{
+    const size_t nbits = bits.size()*64u;
+    auto h1 = epicsStrHash(name, 0u);
+    auto h2 = epicsStrHash(name, 0x9e3779b9u) | 1u;
+    for(auto i : range(nameFilterProbes)) {
+        size_t bit = (h1 + i*h2) % nbits;
+        if(!(bits[bit/64u] & (uint64_t(1u)<<(bit%64u))))
+            return false;
+    }
+    return true;
+}
 
 } // namespace impl
 } // namespace pvxs
@@ -4,6 +4,7 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <stdexcept>
 #include <string>
 
 #include <string.h>
@@ -89,6 +90,58 @@ shared_array<void> allocArray(ArrayType type, size_t count)
     throw std::logic_error("Invalid ArrayType");
 }
 
+ArrayAllocator::~ArrayAllocator() {}
+
+namespace {
+struct AlignedAllocator final : public ArrayAllocator {
+    const size_t align;
+    explicit AlignedAllocator(size_t align) :align(std::max(align, sizeof(void*))) {}
+    virtual ~AlignedAllocator() {}
+
+    // over-allocate, and store the original pointer just before the aligned block
+    virtual void* allocate(size_t nbytes) override final {
+        auto raw = static_cast<char*>(::operator new(nbytes + align + sizeof(void*)));
+        auto addr = (reinterpret_cast<size_t>(raw) + sizeof(void*) + align - 1u) & ~(align - 1u);
+        auto mem = reinterpret_cast<char*>(addr);
+        memcpy(mem - sizeof(void*), &raw, sizeof(void*));
+        return mem;
+    }
+    virtual void deallocate(void* mem, size_t nbytes) noexcept override final {
+        if(!mem)
+            return;
+        void* raw;
+        memcpy(&raw, static_cast<char*>(mem) - sizeof(void*), sizeof(void*));
+        ::operator delete(raw);
+    }
+};
+
+struct AllocRelease {
+    std::shared_ptr<ArrayAllocator> alloc;
+    size_t nbytes;
+    void operator()(void* mem) const {
+        alloc->deallocate(mem, nbytes);
+    }
+};
+} // namespace
+
+std::shared_ptr<ArrayAllocator> ArrayAllocator::aligned(size_t align)
+{
+    if(!align || (align & (align-1u)))
+        throw std::invalid_argument("Alignment must be a power of 2");
+    return std::make_shared<AlignedAllocator>(align);
+}
+
+shared_array<void> allocArray(ArrayType type, size_t count, const std::shared_ptr<ArrayAllocator>& alloc)
+{
+    if(!alloc || type==ArrayType::Null || type==ArrayType::String || type==ArrayType::Value)
+        return allocArray(type, count);
+
+    auto nbytes = count*elementSize(type);
+    auto mem = alloc->allocate(nbytes);
+    memset(mem, 0, nbytes);
+    return shared_array<void>(mem, AllocRelease{alloc, nbytes}, count, type);
+}
+
 namespace detail {
 
 namespace {
@@ -157,13 +210,21 @@ void _throw_bad_cast(ArrayType from, ArrayType to)
 
 namespace {
 
+template<typename Src, typename Dest>
+struct Cast { static inline Dest op(const Src& val) { return Dest(val); } };
+// compare, instead of converting to bool, so that the loop below may be vectorized
+template<typename Src>
+struct Cast<Src, bool> { static inline bool op(const Src& val) { return val!=Src(0); } };
+
+// Instantiated for each (Src, Dest) pair.  Source and destination never overlap,
+// so the compiler may vectorize without a runtime alias check.
 template<typename Src, typename Dest>
 void convertCast(const void *sbase, void *dbase, size_t count)
 {
-    auto S = static_cast<const Src*>(sbase);
-    auto D = static_cast<Dest*>(dbase);
-    for(auto i : range(count))
-        D[i] = Dest(S[i]);
+    auto * __restrict S = static_cast<const Src*>(sbase);
+    auto * __restrict D = static_cast<Dest*>(dbase);
+    for(size_t i=0u; i<count; i++)
+        D[i] = Cast<Src, Dest>::op(S[i]);
 }
 
 void printValue(std::string& dest, const bool& src)
@@ -4,20 +4,28 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
+#include <deque>
 #include <set>
 #include <map>
+#include <vector>
 
 #include <epicsTime.h>
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsThread.h>
 
 #include <pvxs/log.h>
 #include <pvxs/sharedpv.h>
 #include <pvxs/source.h>
 #include <pvxs/server.h>
+#include <pvxs/util.h>
 
 #include "utilpvt.h"
 #include "dataimpl.h"
+#include "wirecache.h"
+#include "nameindex.h"
+#include "mcastmon.h"
 
 typedef epicsGuard<epicsMutex> Guard;
 typedef epicsGuardRelease<epicsMutex> UnGuard;
@@ -32,6 +40,80 @@ namespace server {
 template<typename T>
 using ptr_set = std::set<T, std::owner_less<T>>;
 
+namespace {
+// threads of a HandlerPool
+struct PoolWorkers final : public epicsThreadRunable {
+    MPMCFIFO<std::function<void()>> queue;
+    epicsMutex lock;
+    bool running = true; // guarded by lock
+    std::vector<std::unique_ptr<epicsThread>> threads;
+
+    explicit PoolWorkers(unsigned nworkers) {
+        threads.reserve(nworkers);
+        for(auto i : range(nworkers)) {
+            std::string name(SB()<<"PVXHandler"<<i);
+            threads.emplace_back(new epicsThread(*this, name.c_str(),
+                                                 epicsThreadGetStackSize(epicsThreadStackBig),
+                                                 epicsThreadPriorityMedium));
+            threads.back()->start();
+        }
+    }
+    virtual ~PoolWorkers() {}
+
+    virtual void run() override final {
+        // queue.push(nullptr) to stop
+        while(auto work = queue.pop()) {
+            try {
+                work();
+            } catch(std::exception& e) {
+                log_exc_printf(logshared, "Unhandled exception in handler worker: %s\n", e.what());
+            }
+        }
+    }
+
+    // run work on a worker, or immediately once stopped
+    void submit(std::function<void()>&& work) {
+        {
+            Guard G(lock);
+            if(running) {
+                queue.push(std::move(work));
+                return;
+            }
+        }
+        work();
+    }
+
+    void stop() {
+        {
+            Guard G(lock);
+            running = false;
+            // run any remaining work, then stop
+            for(auto i : range(threads.size())) {
+                (void)i;
+                queue.push(nullptr);
+            }
+        }
+        for(auto& thread : threads) {
+            thread->exitWait();
+        }
+    }
+};
+} // namespace
+
+struct HandlerPool::Impl {
+    const std::shared_ptr<PoolWorkers> workers;
+    explicit Impl(unsigned nworkers) :workers(std::make_shared<PoolWorkers>(nworkers)) {}
+    ~Impl() {
+        workers->stop();
+    }
+};
+
+HandlerPool::HandlerPool(unsigned nworkers)
+    :impl(std::make_shared<Impl>(std::max(1u, nworkers)))
+{}
+
+HandlerPool::~HandlerPool() {}
+
 struct SharedPV::Impl : public std::enable_shared_from_this<Impl>
 {
     mutable epicsMutex lock;
@@ -41,16 +123,165 @@ struct SharedPV::Impl : public std::enable_shared_from_this<Impl>
     std::function<void(SharedPV&)> onFirstConnect;
     std::function<void(SharedPV&)> onLastDisconnect;
 
+    // from handlerPool()
+    std::shared_ptr<PoolWorkers> pool;
+    bool serialize = true;
+    // from postOnlyChanged()
+    bool onlyChanged = false;
+    // from multicast()
+    std::shared_ptr<impl::MCastPublisher> mcast;
+    // from coalescePuts()
+    bool coalesce = false;
+    // with serialize, handlers waiting to run, in order
+    struct Queued {
+        std::function<void()> work;
+        // with coalesce, a waiting Put which a later Put from the same peer may replace
+        std::string peer;
+        std::shared_ptr<std::unique_ptr<ExecOp>> op;
+        std::shared_ptr<Value> val;
+    };
+    std::deque<Queued> handlers;
+    bool handlerBusy = false;
+
     ptr_set<std::weak_ptr<ChannelControl>> channels;
 
     std::set<std::shared_ptr<ConnectOp>> pending;
     std::set<std::shared_ptr<MonitorSetupOp>> mpending;
-    std::set<std::shared_ptr<MonitorControlOp>> subscribers;
+    typedef std::set<std::shared_ptr<MonitorControlOp>> subscribers_t;
+    // Copy on write.  Replaced, but never modified, while lock is held.
+    // So post() can fan out to a snapshot without holding lock.
+    std::shared_ptr<const subscribers_t> subscribers;
+
+    // serialize post() fan out, so that subscribers see updates in order.
+    // Order: postLock, then lock
+    epicsMutex postLock;
 
     Value current;
+    // frozen copy of current, made on demand, and shared by GET replies and initial monitor updates.
+    // Reset whenever current is modified.
+    Value snapshot;
+    // keeps alive the encodings of snapshot, so that consecutive GETs re-use them.  cf. ServerGPR::doReply()
+    std::shared_ptr<WireCache> snapshotWire;
+
+    // call with lock held
+    Value currentSnapshot()
+    {
+        if(!snapshot && current) {
+            snapshot = current.clone();
+            snapshot.freeze();
+            snapshotWire = WireCache::lookup(snapshot);
+        }
+        return snapshot;
+    }
+
+    // call with lock held
+    void resetSnapshot()
+    {
+        snapshot = Value();
+        snapshotWire.reset();
+    }
+
+    // call with lock held
+    void addSubscriber(std::shared_ptr<MonitorControlOp>&& sub)
+    {
+        auto next(subscribers ? std::make_shared<subscribers_t>(*subscribers) : std::make_shared<subscribers_t>());
+        next->emplace(std::move(sub));
+        subscribers = std::move(next);
+    }
+
+    // call with lock held
+    void removeSubscriber(const std::shared_ptr<MonitorControlOp>& sub)
+    {
+        if(!subscribers || subscribers->find(sub)==subscribers->end())
+            return;
+        auto next(std::make_shared<subscribers_t>(*subscribers));
+        next->erase(sub);
+        subscribers = std::move(next);
+    }
 
     INST_COUNTER(SharedPVImpl);
 
+    typedef std::function<void(SharedPV&, std::unique_ptr<ExecOp>&&, Value&&)> handler_t;
+
+    // run an onPut() or onRPC() handler.  call with lock held.
+    void dispatch(Guard& G, const char* what, const handler_t& cb, std::unique_ptr<ExecOp>&& op, Value&& val,
+                  bool isPut=false)
+    {
+        G.assertIdenticalMutex(lock);
+        auto self(shared_from_this());
+        // copyable for std::function.  With coalesce, may be replaced while queued.
+        auto sop(std::make_shared<std::unique_ptr<ExecOp>>(std::move(op)));
+        auto sval(std::make_shared<Value>(std::move(val)));
+        std::function<void()> work([self, what, cb, sop, sval]() {
+            try {
+                SharedPV pv;
+                pv.impl = self;
+                cb(pv, std::move(*sop), std::move(*sval));
+            }catch(std::exception& e){
+                log_err_printf(logshared, "error in %s cb: %s\n", what, e.what());
+            }
+        });
+
+        auto workers(pool);
+        if(!workers) {
+            UnGuard U(G);
+            work();
+
+        } else if(!serialize) {
+            UnGuard U(G);
+            workers->submit(std::move(work));
+
+        } else {
+            if(isPut && coalesce) {
+                auto peer((*sop)->peerName());
+                for(auto& ent : handlers) {
+                    if(!ent.op || ent.peer!=peer)
+                        continue;
+                    // take the place of a waiting Put from this client
+                    std::unique_ptr<ExecOp> superseded(std::move(*ent.op));
+                    *ent.op = std::move(*sop);
+                    *ent.val = std::move(*sval);
+
+                    UnGuard U(G);
+                    superseded->error("Superseded");
+                    return;
+                }
+                handlers.push_back(Queued{std::move(work), std::move(peer), sop, sval});
+
+            } else {
+                handlers.push_back(Queued{std::move(work), std::string(), nullptr, nullptr});
+            }
+            if(!handlerBusy) {
+                handlerBusy = true;
+                UnGuard U(G);
+                workers->submit([self, workers]() { self->runHandler(workers); });
+            }
+        }
+    }
+
+    // with serialize, on pool worker.  Run the oldest handler, then queue the next.
+    void runHandler(const std::shared_ptr<PoolWorkers>& workers)
+    {
+        std::function<void()> work;
+        {
+            Guard G(lock);
+            work = std::move(handlers.front().work);
+            handlers.pop_front();
+        }
+
+        work();
+
+        bool more;
+        {
+            Guard G(lock);
+            more = handlerBusy = !handlers.empty();
+        }
+        if(more) {
+            auto self(shared_from_this());
+            workers->submit([self, workers]() { self->runHandler(workers); });
+        }
+    }
+
     static
     void connectOp(const std::shared_ptr<Impl>& self, const std::shared_ptr<ConnectOp>& conn, const Value& current)
     {
@@ -84,12 +315,12 @@ struct SharedPV::Impl : public std::enable_shared_from_this<Impl>
                 conn->onClose([self, sub](const std::string& msg) {
                     log_debug_printf(logshared, "%s on %s Monitor onClose\n", sub->peerName().c_str(), sub->name().c_str());
                     Guard G(self->lock);
-                    self->subscribers.erase(sub);
+                    self->removeSubscriber(sub);
                 });
 
                 sub->post(current);
             }
-            self->subscribers.emplace(std::move(sub));
+            self->addSubscriber(std::move(sub));
 
         }catch(std::exception& e){
             UnGuard U(G);
@@ -100,6 +331,9 @@ struct SharedPV::Impl : public std::enable_shared_from_this<Impl>
             conn->error(e.what());
         }
     }
+
+    // owned if the caller has given up val
+    void post(const Value& val, bool owned);
 };
 DEFINE_INST_COUNTER2(SharedPV::Impl, SharedPVImpl);
 
@@ -124,7 +358,8 @@ SharedPV SharedPV::buildMailbox()
                          op->peerName().c_str(), op->name().c_str(),
                          std::string(SB()<<val).c_str());
 
-        pv.post(val);
+        // val is not referenced elsewhere
+        pv.post(std::move(val));
 
         op->reply();
     });
@@ -167,14 +402,7 @@ void SharedPV::attach(std::unique_ptr<ChannelControl>&& ctrlop)
         Guard G(self->lock);
         auto cb(self->onRPC);
         if(cb) {
-            SharedPV pv;
-            pv.impl = self;
-            try {
-                UnGuard U(G);
-                cb(pv, std::move(op), std::move(arg));
-            }catch(std::exception& e){
-                log_err_printf(logshared, "error in RPC cb: %s\n", e.what());
-            }
+            self->dispatch(G, "RPC", cb, std::move(op), std::move(arg));
         } else {
             op->error("RPC not implemented by this PV");
         }
@@ -195,8 +423,7 @@ void SharedPV::attach(std::unique_ptr<ChannelControl>&& ctrlop)
             Value got;
             {
                 Guard G(self->lock);
-                if(self->current)
-                    got = self->current.clone();
+                got = self->currentSnapshot();
             }
             if(got) {
                 op->reply(got);
@@ -214,14 +441,7 @@ void SharedPV::attach(std::unique_ptr<ChannelControl>&& ctrlop)
             Guard G(self->lock);
             auto cb(self->onPut);
             if(cb) {
-                try {
-                    SharedPV pv;
-                    pv.impl = self;
-                    UnGuard U(G);
-                    cb(pv, std::move(op), std::move(val));
-                }catch(std::exception& e){
-                    log_err_printf(logshared, "error in Put cb: %s\n", e.what());
-                }
+                self->dispatch(G, "Put", cb, std::move(op), std::move(val), true);
             } else {
                 op->error("RPC not implemented by this PV");
             }
@@ -271,7 +491,7 @@ void SharedPV::attach(std::unique_ptr<ChannelControl>&& ctrlop)
             self->mpending.insert(std::move(conn));
 
         } else {
-            Impl::connectSub(G, self, conn, self->current.clone());
+            Impl::connectSub(G, self, conn, self->currentSnapshot());
         }
     });
 
@@ -345,6 +565,52 @@ void SharedPV::onRPC(std::function<void(SharedPV&, std::unique_ptr<ExecOp>&&, Va
     impl->onRPC = std::move(fn);
 }
 
+void SharedPV::handlerPool(const HandlerPool& pool, bool serialize)
+{
+    if(!impl)
+        throw std::logic_error("Empty SharedPV");
+    Guard G(impl->lock);
+    impl->pool = pool.impl ? pool.impl->workers : nullptr;
+    impl->serialize = serialize;
+}
+
+void SharedPV::coalescePuts(bool latestWins)
+{
+    if(!impl)
+        throw std::logic_error("Empty SharedPV");
+    Guard G(impl->lock);
+    impl->coalesce = latestWins;
+}
+
+void SharedPV::postOnlyChanged(bool onlyChanged)
+{
+    if(!impl)
+        throw std::logic_error("Empty SharedPV");
+    Guard G(impl->lock);
+    impl->onlyChanged = onlyChanged;
+}
+
+void SharedPV::multicast(const std::string& name, const std::string& dest, double heartbeat)
+{
+    if(!impl)
+        throw std::logic_error("Empty SharedPV");
+
+    std::shared_ptr<impl::MCastPublisher> mcast;
+    if(!dest.empty())
+        mcast = std::make_shared<impl::MCastPublisher>(name, dest, heartbeat);
+
+    Guard P(impl->postLock);
+    Value full;
+    {
+        Guard G(impl->lock);
+        impl->mcast = mcast;
+        full = impl->current;
+    }
+    // current is only modified with postLock held
+    if(mcast && full)
+        mcast->publish(full, Value());
+}
+
 void SharedPV::open(const Value& initial)
 {
     if(!impl)
@@ -355,7 +621,11 @@ void SharedPV::open(const Value& initial)
     decltype (impl->pending) pending;
     decltype (impl->mpending) mpending;
 
+    // orders the initial multicast before any post()
+    Guard P(impl->postLock);
+
     Value temp;
+    std::shared_ptr<impl::MCastPublisher> mcast;
     {
         Guard G(impl->lock);
 
@@ -366,8 +636,10 @@ void SharedPV::open(const Value& initial)
         mpending = std::move(impl->mpending);
 
         impl->current = initial.clone();
-        // make a second copy as 'temp' will be queued
-        temp = initial.clone();
+        impl->resetSnapshot();
+        mcast = impl->mcast;
+        // 'temp' will be queued, so must not be modified
+        temp = impl->currentSnapshot();
 
         // TODO these loops will be really inefficient if we aren't on a worker.
         //      API to batch?
@@ -378,6 +650,9 @@ void SharedPV::open(const Value& initial)
         }
     }
 
+    if(mcast)
+        mcast->publish(temp, Value());
+
     for(auto& op : pending) {
         Impl::connectOp(impl, op, temp);
     }
@@ -403,9 +678,13 @@ void SharedPV::close()
 
         if(impl->current)
             impl->current = Value();
+        impl->resetSnapshot();
 
-        impl->subscribers.clear();
+        impl->subscribers.reset();
         channels = std::move(impl->channels);
+
+        if(impl->mcast)
+            impl->mcast->clear();
     }
 
     for(auto& ch : channels) {
@@ -414,32 +693,92 @@ void SharedPV::close()
     }
 }
 
-void SharedPV::post(const Value& val)
+void SharedPV::Impl::post(const Value& val, bool owned)
 {
-    if(!impl)
-        throw std::logic_error("Empty SharedPV");
-    else if(!val)
+    if(!val)
         throw std::logic_error("Can't post() empty Value");
 
-    Guard G(impl->lock);
+    Guard P(postLock);
+
+    // a single copy queued to all subscribers is encoded once for each distinct pvRequest mask
+    Value copy;
+    bool remarked = false;
+    std::shared_ptr<const subscribers_t> subs;
+    Value full;
+    std::shared_ptr<impl::MCastPublisher> pub;
+    {
+        Guard G(lock);
+
+        if(!current)
+            throw std::logic_error("Must open() before post()ing");
+        else if(Value::Helper::desc(current)!=Value::Helper::desc(val))
+            throw std::logic_error("post() requires the exact type of open().  Recommend pvxs::Value::cloneEmpty()");
+
+        subs = subscribers;
+        resetSnapshot();
+
+        if(!subs || subs->empty()) {
+            current.assign(val);
+        } else if(onlyChanged) {
+            // send only those marked fields which differ from current, if any
+            copy = owned ? val : val.clone();
+            if(!copy.markChanged(current, true))
+                return;
+            current.assign(copy);
+            remarked = true;
+        } else if(owned) {
+            // caller gave up val, so it may be queued without a copy
+            current.assign(val);
+            copy = val;
+        } else {
+            // visit only the marked fields of val, once for both
+            copy = val.cloneEmpty();
+            Value::Helper::assignMarked(val, current, copy);
+        }
 
-    if(!impl->current)
-        throw std::logic_error("Must open() before post()ing");
-    else if(Value::Helper::desc(impl->current)!=Value::Helper::desc(val))
-        throw std::logic_error("post() requires the exact type of open().  Recommend pvxs::Value::cloneEmpty()");
+        pub = mcast;
+        full = current;
+    }
 
-    impl->current.assign(val);
+    // current is only modified with postLock held, so may be encoded without lock
+    if(pub)
+        pub->publish(full, copy ? copy : val);
 
-    if(impl->subscribers.empty())
+    if(!copy)
         return;
 
-    auto copy(val.clone());
+    // Unless remarked, copy has the same marked fields and values as val, so may re-use
+    // any received encoding of val.  cf. client::MonitorBuilder::passThrough()
+    std::shared_ptr<WireCache> wire;
+    if(!remarked && !owned) {
+        if(auto src = WireCache::find(Value::Helper::store_ptr(val))) {
+            wire = WireCache::lookup(copy);
+            wire->inherit(*src);
+        }
+    }
 
-    for(auto& sub : impl->subscribers) {
+    for(auto& sub : *subs) {
         sub->post(copy);
     }
 }
 
+void SharedPV::post(const Value& val)
+{
+    if(!impl)
+        throw std::logic_error("Empty SharedPV");
+
+    impl->post(val, false);
+}
+
+void SharedPV::post(Value&& val)
+{
+    if(!impl)
+        throw std::logic_error("Empty SharedPV");
+
+    impl->post(val, true);
+    val = Value();
+}
+
 void SharedPV::fetch(Value& val) const
 {
     if(!impl)
@@ -468,12 +807,54 @@ Value SharedPV::fetch() const
     }
 }
 
-struct StaticSource::Impl final : public Source
+struct StaticSource::Impl final : public Source, public impl::IndexedSource
 {
     mutable RWLock lock;
 
     list_t pvs;
     decltype (List::names) list;
+    // from handlerPool()
+    HandlerPool pool;
+    bool poolSerialize = true;
+    // of each Server to which we have been added
+    std::vector<std::weak_ptr<impl::NameIndex>> indexes;
+
+    virtual void attachIndex(const std::shared_ptr<impl::NameIndex>& idx) override final
+    {
+        auto G(lock.lockWriter());
+        for(auto& pair : pvs) {
+            idx->add(pair.first);
+        }
+        indexes.push_back(idx);
+    }
+
+    virtual void detachIndex(const std::shared_ptr<impl::NameIndex>& idx) override final
+    {
+        auto G(lock.lockWriter());
+        for(auto it = indexes.begin(); it!=indexes.end(); ++it) {
+            if(it->lock()==idx) {
+                indexes.erase(it);
+                for(auto& pair : pvs) {
+                    idx->remove(pair.first);
+                }
+                break;
+            }
+        }
+    }
+
+    // call with lock held for writing
+    template<typename Fn>
+    void eachIndex(Fn&& fn)
+    {
+        for(auto it = indexes.begin(); it!=indexes.end(); ) {
+            if(auto idx = it->lock()) {
+                fn(*idx);
+                ++it;
+            } else {
+                it = indexes.erase(it); // Server destroyed
+            }
+        }
+    }
 
     virtual void onSearch(Search &op) override
     {
@@ -504,6 +885,27 @@ struct StaticSource::Impl final : public Source
         pv.attach(std::move(op));
     }
 
+    virtual void onCreateMany(std::vector<std::unique_ptr<ChannelControl>>& ops) override
+    {
+        // lookup all names with one lock, then attach without
+        std::vector<SharedPV> found(ops.size());
+        {
+            auto G(lock.lockReader());
+            for(auto i : range(ops.size())) {
+                if(!ops[i])
+                    continue;
+                auto it(pvs.find(ops[i]->name()));
+                if(it!=pvs.end())
+                    found[i] = it->second;
+            }
+        }
+
+        for(auto i : range(ops.size())) {
+            if(found[i])
+                found[i].attach(std::move(ops[i]));
+        }
+    }
+
     virtual List onList() override
     {
         List ret;
@@ -577,6 +979,27 @@ StaticSource& StaticSource::add(const std::string& name, const SharedPV &pv)
 
     impl->pvs[name] = pv;
     impl->list.reset();
+    if(impl->pool) {
+        auto temp(pv);
+        temp.handlerPool(impl->pool, impl->poolSerialize);
+    }
+    impl->eachIndex([&name](impl::NameIndex& idx) { idx.add(name); });
+
+    return *this;
+}
+
+StaticSource& StaticSource::handlerPool(const HandlerPool& pool, bool serialize)
+{
+    if(!impl)
+        throw std::logic_error("Empty StaticSource");
+
+    auto G(impl->lock.lockWriter());
+
+    impl->pool = pool;
+    impl->poolSerialize = serialize;
+    for(auto& pair : impl->pvs) {
+        pair.second.handlerPool(pool, serialize);
+    }
 
     return *this;
 }
@@ -596,6 +1019,7 @@ StaticSource& StaticSource::remove(const std::string& name)
         pv = it->second;
         impl->pvs.erase(it);
         impl->list.reset();
+        impl->eachIndex([&name](impl::NameIndex& idx) { idx.remove(name); });
     }
 
     pv.close();
@@ -603,6 +1027,91 @@ StaticSource& StaticSource::remove(const std::string& name)
     return *this;
 }
 
+StaticSource& StaticSource::addSnapshot(const std::string& name)
+{
+    using namespace pvxs::members;
+
+    if(!impl)
+        throw std::logic_error("Empty StaticSource");
+
+    std::weak_ptr<Impl> wself(impl);
+    auto pv(SharedPV::buildReadonly());
+    pv.onRPC([wself](SharedPV&, std::unique_ptr<ExecOp>&& op, Value&& arg) {
+        auto self(wself.lock());
+        if(!self) {
+            op->error("StaticSource destroyed");
+            return;
+        }
+
+        shared_array<const std::string> names;
+        auto fld(arg["query.names"]);
+        if(!fld)
+            fld = arg["names"];
+        if(fld.type()==TypeCode::String) {
+            // comma separated list.  eg. from pvxcall
+            std::vector<std::string> temp;
+            auto list(fld.as<std::string>());
+            for(size_t pos = 0u; pos < list.size();) {
+                auto sep(list.find(',', pos));
+                if(sep==std::string::npos)
+                    sep = list.size();
+                if(sep > pos)
+                    temp.push_back(list.substr(pos, sep-pos));
+                pos = sep+1u;
+            }
+            names = shared_array<const std::string>(temp.begin(), temp.end());
+
+        } else if(!fld || !fld.as(names)) {
+            op->error("Snapshot expects argument with string array, or comma separated string, 'names' or 'query.names'");
+            return;
+        }
+
+        std::vector<SharedPV> pvs(names.size());
+        {
+            auto G(self->lock.lockReader());
+            for(auto i : range(names.size())) {
+                auto it(self->pvs.find(names[i]));
+                if(it!=self->pvs.end())
+                    pvs[i] = it->second;
+            }
+        }
+
+        // each read under the lock of one SharedPV, without creating a channel
+        shared_array<Value> values(names.size());
+        shared_array<std::string> errors(names.size());
+        for(auto i : range(names.size())) {
+            if(!pvs[i]) {
+                errors[i] = "No such PV";
+            } else if(!pvs[i].isOpen()) {
+                errors[i] = "Not open";
+            } else {
+                try {
+                    values[i] = pvs[i].fetch();
+                } catch(std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }
+        }
+
+        auto ret(TypeDef(TypeCode::Struct, "epics:nt/NTTable:1.0", {
+                             StringA("labels"),
+                             Struct("value", {
+                                 StringA("name"),
+                                 Member(TypeCode::AnyA, "value"),
+                                 StringA("error"),
+                             }),
+                         }).create());
+        ret["labels"] = shared_array<const std::string>({"name", "value", "error"});
+        ret["value.name"] = names;
+        ret["value.value"] = values.freeze();
+        ret["value.error"] = errors.freeze();
+
+        op->reply(ret);
+    });
+
+    return add(name, pv);
+}
+
 StaticSource::list_t StaticSource::list() const
 {
     list_t ret;
@@ -0,0 +1,396 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(__rtems__) && !defined(vxWorks)
+#  define USE_MMAP
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <pvxs/log.h>
+#include <pvxs/snapshot.h>
+#include "dataimpl.h"
+#include "pvaproto.h"
+#include "utilpvt.h"
+
+/* File layout.  Integers in the byte order given by the header.
+ *
+ *   char     magic[8]   "PVXSSNAP"
+ *   uint8_t  be         1 if big endian
+ *   uint8_t  version    1
+ *   uint8_t  pad[2]
+ *   uint32_t ntypes
+ *   uint32_t nentries
+ *   uint32_t pad
+ *   uint64_t typesOffset
+ *   uint64_t indexOffset
+ *   ...      values      Each the PVA full encoding (to_wire_full())
+ *   types    at typesOffset, ntypes of: uint32_t length, PVA type encoding
+ *   index    at indexOffset, nentries of: string name, uint32_t type, uint64_t offset, uint64_t length
+ *            sorted by name
+ */
+
+namespace pvxs {
+using namespace impl;
+
+DEFINE_LOGGER(logsnap, "pvxs.snapshot");
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+constexpr char snapMagic[8] = {'P', 'V', 'X', 'S', 'S', 'N', 'A', 'P'};
+constexpr size_t snapHeaderSize = 40u;
+
+struct SnapEntry {
+    std::string name;
+    uint32_t type;
+    uint64_t offset, length;
+};
+
+} // namespace
+
+struct SnapshotWriter::Pvt {
+    const std::string fname;
+    std::ofstream out;
+    uint64_t pos = snapHeaderSize;
+    std::vector<uint8_t> scratch;
+
+    // keep the first Value of each type, so that FieldDesc* is not re-used
+    std::map<const FieldDesc*, std::pair<Value, uint32_t>> byDesc;
+    std::map<std::vector<uint8_t>, uint32_t> byEncoding;
+    std::vector<const std::vector<uint8_t>*> types;
+
+    std::map<std::string, SnapEntry> index;
+    bool closed = false;
+
+    explicit Pvt(const std::string& fname)
+        :fname(fname)
+        ,out(fname, std::ios::binary|std::ios::trunc)
+    {
+        if(!out.is_open())
+            throw std::runtime_error(SB()<<"Unable to open "<<fname);
+        // placeholder, re-written by close()
+        std::vector<char> zeros(snapHeaderSize, 0);
+        out.write(zeros.data(), zeros.size());
+    }
+
+    uint32_t typeOf(const Value& val) {
+        auto desc = Value::Helper::desc(val);
+        auto it = byDesc.find(desc);
+        if(it!=byDesc.end())
+            return it->second.second;
+
+        scratch.clear();
+        {
+            VectorOutBuf buf(hostBE, scratch);
+            to_wire(buf, desc);
+            if(!buf.good())
+                throw std::logic_error("Unable to encode type");
+            scratch.resize(buf.consumed());
+        }
+
+        auto ins = byEncoding.emplace(scratch, uint32_t(types.size()));
+        if(ins.second)
+            types.push_back(&ins.first->first);
+        auto idx = ins.first->second;
+        byDesc.emplace(desc, std::make_pair(val, idx));
+        return idx;
+    }
+
+    void write(const std::vector<uint8_t>& bytes) {
+        out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        pos += bytes.size();
+    }
+};
+
+SnapshotWriter::SnapshotWriter(const std::string& fname)
+    :pvt(new Pvt(fname))
+{}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    try {
+        close();
+    } catch(std::exception& e) {
+        log_err_printf(logsnap, "Error writing %s : %s\n", pvt->fname.c_str(), e.what());
+    }
+}
+
+void SnapshotWriter::add(const std::string& name, const Value& val)
+{
+    if(pvt->closed)
+        throw std::logic_error("SnapshotWriter closed");
+    if(!val)
+        throw std::logic_error("Can not add empty Value");
+
+    SnapEntry ent{name, pvt->typeOf(val), pvt->pos, 0u};
+
+    pvt->scratch.clear();
+    {
+        VectorOutBuf buf(hostBE, pvt->scratch);
+        to_wire_full(buf, val);
+        if(!buf.good())
+            throw std::logic_error(SB()<<"Unable to encode "<<name);
+        pvt->scratch.resize(buf.consumed());
+    }
+    ent.length = pvt->scratch.size();
+    pvt->write(pvt->scratch);
+
+    pvt->index[name] = std::move(ent);
+}
+
+void SnapshotWriter::close()
+{
+    if(pvt->closed)
+        return;
+    pvt->closed = true;
+
+    auto& scratch = pvt->scratch;
+
+    const uint64_t typesOffset = pvt->pos;
+    scratch.clear();
+    {
+        VectorOutBuf buf(hostBE, scratch);
+        for(auto type : pvt->types) {
+            to_wire(buf, uint32_t(type->size()));
+            for(auto b : *type)
+                to_wire(buf, b);
+        }
+        scratch.resize(buf.consumed());
+    }
+    pvt->write(scratch);
+
+    const uint64_t indexOffset = pvt->pos;
+    scratch.clear();
+    {
+        VectorOutBuf buf(hostBE, scratch);
+        for(auto& pair : pvt->index) {
+            auto& ent = pair.second;
+            to_wire(buf, ent.name);
+            to_wire(buf, ent.type);
+            to_wire(buf, ent.offset);
+            to_wire(buf, ent.length);
+        }
+        scratch.resize(buf.consumed());
+    }
+    pvt->write(scratch);
+
+    scratch.clear();
+    {
+        VectorOutBuf buf(hostBE, scratch);
+        for(auto c : snapMagic)
+            to_wire(buf, uint8_t(c));
+        to_wire(buf, uint8_t(hostBE ? 1u : 0u));
+        to_wire(buf, uint8_t(1u));
+        to_wire(buf, uint16_t(0u));
+        to_wire(buf, uint32_t(pvt->types.size()));
+        to_wire(buf, uint32_t(pvt->index.size()));
+        to_wire(buf, uint32_t(0u));
+        to_wire(buf, typesOffset);
+        to_wire(buf, indexOffset);
+        scratch.resize(buf.consumed());
+    }
+    assert(scratch.size()==snapHeaderSize);
+    pvt->out.seekp(0);
+    pvt->out.write(reinterpret_cast<const char*>(scratch.data()), scratch.size());
+
+    pvt->out.close();
+    if(pvt->out.fail())
+        throw std::runtime_error(SB()<<"Error writing "<<pvt->fname);
+
+    log_debug_printf(logsnap, "Wrote %zu Values with %zu types to %s\n",
+                     pvt->index.size(), pvt->types.size(), pvt->fname.c_str());
+
+    pvt->byDesc.clear();
+}
+
+struct Snapshot::Pvt {
+    const std::string fname;
+    const uint8_t* base = nullptr;
+    size_t size = 0u;
+#ifdef USE_MMAP
+    void* mapped = MAP_FAILED;
+#endif
+    std::vector<uint8_t> backing;
+    bool be = false;
+
+    // (start, length) of type encodings
+    std::vector<std::pair<size_t, size_t>> types;
+    std::vector<SnapEntry> index;
+
+    mutable epicsMutex lock;
+    // decoded types, by index.  guarded by lock
+    mutable std::vector<Value> prototypes;
+
+    explicit Pvt(const std::string& fname)
+        :fname(fname)
+    {
+#ifdef USE_MMAP
+        int fd = ::open(fname.c_str(), O_RDONLY);
+        if(fd<0)
+            throw std::runtime_error(SB()<<"Unable to open "<<fname);
+        struct stat info;
+        if(fstat(fd, &info)==0 && info.st_size>0) {
+            size = size_t(info.st_size);
+            mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if(mapped!=MAP_FAILED) {
+            base = static_cast<const uint8_t*>(mapped);
+        } else
+#endif
+        {
+            std::ifstream in(fname, std::ios::binary);
+            if(!in.is_open())
+                throw std::runtime_error(SB()<<"Unable to open "<<fname);
+            backing.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            if(in.bad())
+                throw std::runtime_error(SB()<<"Error reading "<<fname);
+            base = backing.data();
+            size = backing.size();
+        }
+    }
+
+    ~Pvt() {
+#ifdef USE_MMAP
+        if(mapped!=MAP_FAILED)
+            munmap(mapped, size);
+#endif
+    }
+
+    // read header and index
+    void parse() {
+        if(size < snapHeaderSize || memcmp(base, snapMagic, sizeof(snapMagic))!=0)
+            throw std::runtime_error(SB()<<fname<<" is not a PVXS snapshot");
+        be = base[8]!=0u;
+        if(base[9]!=1u)
+            throw std::runtime_error(SB()<<fname<<" has unsupported snapshot version "<<unsigned(base[9]));
+
+        uint32_t ntypes=0u, nentries=0u, pad=0u;
+        uint64_t typesOffset=0u, indexOffset=0u;
+        {
+            FixedBuf buf(be, const_cast<uint8_t*>(base)+12u, snapHeaderSize-12u);
+            from_wire(buf, ntypes);
+            from_wire(buf, nentries);
+            from_wire(buf, pad);
+            from_wire(buf, typesOffset);
+            from_wire(buf, indexOffset);
+            if(!buf.good() || typesOffset>indexOffset || indexOffset>size)
+                throw std::runtime_error(SB()<<fname<<" has invalid header");
+        }
+
+        {
+            FixedBuf buf(be, const_cast<uint8_t*>(base)+typesOffset, indexOffset-typesOffset);
+            types.reserve(ntypes);
+            for(auto i : range(ntypes)) {
+                (void)i;
+                uint32_t len = 0u;
+                from_wire(buf, len);
+                if(!buf.good() || buf.size()<len)
+                    throw std::runtime_error(SB()<<fname<<" has truncated type table");
+                types.emplace_back(size_t(buf.save()-base), size_t(len));
+                buf._skip(len);
+            }
+        }
+        prototypes.resize(types.size());
+
+        {
+            FixedBuf buf(be, const_cast<uint8_t*>(base)+indexOffset, size-indexOffset);
+            index.reserve(nentries);
+            for(auto i : range(nentries)) {
+                (void)i;
+                SnapEntry ent;
+                from_wire(buf, ent.name);
+                from_wire(buf, ent.type);
+                from_wire(buf, ent.offset);
+                from_wire(buf, ent.length);
+                if(!buf.good() || ent.type>=types.size()
+                        || ent.offset<snapHeaderSize || ent.offset>typesOffset || ent.length>typesOffset-ent.offset)
+                    throw std::runtime_error(SB()<<fname<<" has invalid index");
+                index.push_back(std::move(ent));
+            }
+        }
+    }
+
+    Value prototype(uint32_t type) const {
+        Guard G(lock);
+        auto& proto = prototypes[type];
+        if(!proto) {
+            auto& loc = types[type];
+            FixedBuf buf(be, const_cast<uint8_t*>(base)+loc.first, loc.second);
+            TypeStore ctxt;
+            from_wire_type(buf, ctxt, proto);
+            if(!buf.good() || !proto)
+                throw std::runtime_error(SB()<<fname<<" has invalid type "<<type);
+        }
+        return proto;
+    }
+};
+
+Snapshot::Snapshot(const std::string& fname)
+{
+    auto temp(std::make_shared<Pvt>(fname));
+    temp->parse();
+    pvt = std::move(temp);
+}
+
+Snapshot::~Snapshot() {}
+
+size_t Snapshot::size() const
+{
+    return pvt ? pvt->index.size() : 0u;
+}
+
+std::vector<std::string> Snapshot::names() const
+{
+    std::vector<std::string> ret;
+    if(pvt) {
+        ret.reserve(pvt->index.size());
+        for(auto& ent : pvt->index)
+            ret.push_back(ent.name);
+    }
+    return ret;
+}
+
+Value Snapshot::get(const std::string& name) const
+{
+    Value ret;
+    if(!pvt)
+        return ret;
+
+    auto it = std::lower_bound(pvt->index.begin(), pvt->index.end(), name,
+                               [](const SnapEntry& ent, const std::string& name) {
+        return ent.name < name;
+    });
+    if(it==pvt->index.end() || it->name!=name)
+        return ret;
+
+    ret = pvt->prototype(it->type).cloneEmpty();
+
+    FixedBuf buf(pvt->be, const_cast<uint8_t*>(pvt->base)+it->offset, it->length);
+    TypeStore ctxt;
+    from_wire_full(buf, ctxt, ret);
+    if(!buf.good() || !buf.empty())
+        throw std::runtime_error(SB()<<pvt->fname<<" has invalid Value for "<<name);
+
+    return ret;
+}
+
+} // namespace pvxs
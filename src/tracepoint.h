@@ -0,0 +1,38 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#ifndef TRACEPOINT_H
+#define TRACEPOINT_H
+
+/* Static tracepoints (USDT) in provider "pvxs", for use with eg. bpftrace, perf, or SystemTap.
+ *
+ *   bpftrace -l 'usdt:/path/to/libpvxs.so:pvxs:*'
+ *
+ * Where <sys/sdt.h> is available, each PVXS_TRACE*() expands to a single nop instruction,
+ * with the locations of its arguments recorded in an ELF note.
+ * Otherwise, or when built with -DPVXS_DISABLE_TRACEPOINTS, expands to nothing.
+ *
+ * Arguments should be cheap to compute, as they are evaluated even when no tracer is attached.
+ */
+
+#if !defined(PVXS_DISABLE_TRACEPOINTS) && defined(__linux__) && defined(__has_include)
+#  if __has_include(<sys/sdt.h>)
+#    include <sys/sdt.h>
+#    define PVXS_HAVE_TRACEPOINTS
+#  endif
+#endif
+
+#ifdef PVXS_HAVE_TRACEPOINTS
+#  define PVXS_TRACE2(NAME, A, B) DTRACE_PROBE2(pvxs, NAME, A, B)
+#  define PVXS_TRACE3(NAME, A, B, C) DTRACE_PROBE3(pvxs, NAME, A, B, C)
+#  define PVXS_TRACE4(NAME, A, B, C, D) DTRACE_PROBE4(pvxs, NAME, A, B, C, D)
+#else
+#  define PVXS_TRACE2(NAME, A, B) do{}while(0)
+#  define PVXS_TRACE3(NAME, A, B, C) do{}while(0)
+#  define PVXS_TRACE4(NAME, A, B, C, D) do{}while(0)
+#endif
+
+#endif // TRACEPOINT_H
@@ -230,6 +230,36 @@ void Member::addChild(const Member& mem)
     children.push_back(mem);
 }
 
+void impl::FieldIndex::build(const std::map<std::string, size_t>& mlookup)
+{
+    slots.clear();
+    order.clear();
+    if(mlookup.empty())
+        return;
+
+    size_t nslots = 4u;
+    while(nslots < 2u*mlookup.size())
+        nslots <<= 1u;
+
+    slots.resize(nslots);
+    const size_t mask = nslots-1u;
+
+    for(auto& pair : mlookup) {
+        auto h = hashOf(pair.first.data(), pair.first.size());
+        size_t i = size_t(h)&mask;
+        while(slots[i].index!=size_t(-1))
+            i = (i+1u)&mask;
+        slots[i].name = pair.first;
+        slots[i].hash = h;
+        slots[i].index = pair.second;
+        order.push_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return slots[a].index < slots[b].index;
+    });
+}
+
 void Member::Helper::build_tree(std::vector<FieldDesc>& desc, const Member& node)
 {
     auto code = node.code;
@@ -279,6 +309,8 @@ void Member::Helper::build_tree(std::vector<FieldDesc>& desc, const Member& node
         }
     }
 
+    desc[index].mindex.build(desc[index].mlookup);
+
     assert(desc.size()==index+desc[index].size());
 }
 
@@ -5,16 +5,21 @@
  */
 
 #include <cstring>
+#include <cstdlib>
 
+#include <fstream>
 #include <set>
+#include <sstream>
 #include <map>
 #include <vector>
 #include <tuple>
 #include <memory>
+#include <algorithm>
 
 #include <epicsThread.h>
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsTime.h>
 #include <osiSock.h>
 
 #include <event2/util.h>
@@ -22,6 +27,7 @@
 #include <pvxs/log.h>
 #include "udp_collector.h"
 #include "pvaproto.h"
+#include "tracepoint.h"
 
 typedef epicsGuard<epicsMutex> Guard;
 
@@ -33,6 +39,22 @@ DEFINE_LOGGER(logsetup, "pvxs.udp.setup");
 
 DEFINE_INST_COUNTER(UDPListener);
 
+// size of a CMD_ORIGIN_TAG prefix header
+static constexpr size_t cmd_origin_tag_size = 8 + 16;
+// RX buffer for one datagram, with headroom for a CMD_ORIGIN_TAG prefix,
+// and one extra byte for a nil after the last PV name of a Search.
+static constexpr size_t udp_rx_slot = cmd_origin_tag_size + 0x10000 + 1;
+// max. datagrams received, or replies sent, with one syscall
+#ifndef PVXS_SMALL_FOOTPRINT
+static constexpr size_t udp_rx_batch = 8u;
+static constexpr size_t udp_tx_batch = 16u;
+#else
+static constexpr size_t udp_rx_batch = 1u;
+static constexpr size_t udp_tx_batch = 4u;
+#endif
+
+static MemCount udpBytes("UDP");
+
 struct UDPCollector final : public UDPManager::Search,
                             public std::enable_shared_from_this<UDPCollector>
 {
@@ -46,7 +68,24 @@ struct UDPCollector final : public UDPManager::Search,
     evevent rx;
     uint32_t prevndrop{};
 
-    std::vector<uint8_t> buf;
+    // udp_rx_batch slots of udp_rx_slot bytes.  Not initialized,
+    // so pages are only touched as (large) datagrams arrive.
+    const std::unique_ptr<uint8_t[]> buf;
+    SockAddr rxsrc[udp_rx_batch], rxdest[udp_rx_batch];
+
+    // replies queued during handle_batch()
+    struct TxEntry {
+        SockAddr dest;
+        size_t offset, len;
+    };
+    mutable std::vector<uint8_t> txbuf;
+    mutable std::vector<TxEntry> txq;
+    // any Search delivered during the current batch
+    bool searched = false;
+
+    // cf. soleListener()
+    epicsUInt64 soleChecked = 0u;
+    bool sole = false;
 
     UDPManager::Beacon beaconMsg;
 
@@ -58,7 +97,10 @@ struct UDPCollector final : public UDPManager::Search,
     void addListener(UDPListener *l);
     void delListener(UDPListener *l);
 
-    bool handle_one();
+    bool handle_batch();
+    void handle_one(recvfromx& rx);
+    void batchDone();
+    void flushTx() const;
 
     enum origin_t {
         Remote,    // non-local sender
@@ -76,22 +118,85 @@ struct UDPCollector final : public UDPManager::Search,
             if(!(ev&EV_READ))
                 return;
 
-            // handle up to 4 packets before going back to the reactor
-            for(unsigned i=0; i<4 && self->handle_one(); i++) {}
+            // handle up to 4 batches of packets before going back to the reactor
+            for(unsigned i=0; i<4 && self->handle_batch(); i++) {}
 
         }catch(std::exception& e) {
             log_crit_printf(logio, "Ignoring unhandled exception in UDPManager::handle(): %s\n", e.what());
+            // don't leave replies queued until the next event
+            try {
+                self->batchDone();
+            }catch(std::exception& e) {
+                log_crit_printf(logio, "Ignoring unhandled exception in UDPManager::batchDone(): %s\n", e.what());
+            }
         }
     }
 
     void forwardM(const SockAddr& origin, const uint8_t* buf, size_t len);
+    bool soleListener();
 
     // Search interface
 public:
     virtual bool reply(const void *msg, size_t msglen) const override;
+    virtual bool replyTo(const SockAddr& dest, const void *msg, size_t msglen) const override;
 };
 
 
+namespace {
+// re-check whether another socket shares our port at most once per interval
+constexpr epicsUInt64 soleCheckInterval = 1000000000u; // ns
+
+#ifdef __linux__
+// Number of UDP sockets, in any process, bound to this port
+size_t countUDPBound(uint16_t port)
+{
+    size_t n = 0u;
+    for(auto fname : {"/proc/net/udp", "/proc/net/udp6"}) {
+        std::ifstream F(fname);
+        std::string line;
+        std::getline(F, line); // column headings
+        while(std::getline(F, line)) {
+            // "   sl  local_address rem_address ..." where local_address is "<hex addr>:<hex port>"
+            std::istringstream strm(line);
+            std::string sl, local;
+            strm>>sl>>local;
+            auto sep = local.rfind(':');
+            if(sep!=std::string::npos && strtoul(local.c_str()+sep+1u, nullptr, 16)==port)
+                n++;
+        }
+    }
+    return n;
+}
+#endif
+
+// The UDP worker is shared by all servers and clients in a process,
+// so its placement is taken only from the environment.
+evbase udpWorkerLoop()
+{
+    unsigned prio = epicsThreadPriorityCAServerLow-4;
+    std::vector<unsigned> cpus;
+
+    if(auto env = getenv("EPICS_PVA_UDP_WORKER_PRIORITY")) {
+        try {
+            if(auto temp = parseTo<uint64_t>(env))
+                prio = unsigned(std::min(temp, uint64_t(epicsThreadPriorityMax)));
+        } catch(std::exception& e) {
+            log_err_printf(logsetup, "EPICS_PVA_UDP_WORKER_PRIORITY invalid integer : %s\n", e.what());
+        }
+    }
+
+    if(auto env = getenv("EPICS_PVA_UDP_WORKER_CPUS")) {
+        try {
+            cpus = parseCPUList(env);
+        } catch(std::exception& e) {
+            log_err_printf(logsetup, "Ignoring invalid EPICS_PVA_UDP_WORKER_CPUS : %s\n", e.what());
+        }
+    }
+
+    return evbase("PVXUDP", prio, cpus);
+}
+} // namespace
+
 struct UDPManager::Pvt {
     SockAttach attach;
 
@@ -103,7 +208,7 @@ struct UDPManager::Pvt {
     std::map<std::pair<int, uint16_t>, UDPCollector*> collectors;
 
     Pvt()
-        :loop("PVXUDP", epicsThreadPriorityCAServerLow-4)
+        :loop(udpWorkerLoop())
         ,ifmap(IfaceMap::instance())
     {}
     ~Pvt()
@@ -142,6 +247,7 @@ UDPCollector::UDPCollector(UDPManager::Pvt *manager, int af, uint16_t requested_
     ,sock(af, SOCK_DGRAM, 0)
     ,rx(__FILE__, __LINE__,
         event_new(manager->loop.base, sock.sock, EV_READ|EV_PERSIST, &handle_static, this))
+    ,buf(new uint8_t[udp_rx_batch*udp_rx_slot])
     ,beaconMsg(src)
 {
     manager->loop.assertInLoop();
@@ -183,11 +289,13 @@ UDPCollector::UDPCollector(UDPManager::Pvt *manager, int af, uint16_t requested_
         throw std::runtime_error("Unable to create collector Rx event");
 
     manager->collectors[std::make_pair(af, bind_addr.port())] = this;
+    udpBytes.add(udp_rx_batch*udp_rx_slot);
 }
 
 UDPCollector::~UDPCollector()
 {
     manager->loop.assertInLoop();
+    udpBytes.sub(udp_rx_batch*udp_rx_slot);
 
     manager->collectors.erase(std::make_pair(bind_addr.family(), bind_addr.port()));
 
@@ -221,44 +329,61 @@ void UDPCollector::delListener(UDPListener *l)
     // TODO: bother to cleanup mcast group membership?
 }
 
-// size of a CMD_ORIGIN_TAG prefix header
-static constexpr size_t cmd_origin_tag_size = 8 + 16;
-
-bool UDPCollector::handle_one()
+// returns true if a full batch was received, and more may be waiting
+bool UDPCollector::handle_batch()
 {
-    SockAddr dest;
-
-    buf.resize(cmd_origin_tag_size + 0x10000 + 1);
-    auto rxbuf = &buf[cmd_origin_tag_size];
-    auto rxlen = buf.size()-cmd_origin_tag_size-1;
+    recvfromx rx[udp_rx_batch];
 
     // For Search messages, we use PV name strings in-place by adding nils.
     // Ensure one extra byte at the end of the buffer for a nil after the last PV name
-    recvfromx rx{sock.sock, (char*)rxbuf, rxlen, &src, &dest};
-    const int nrx = rx.call();
-
-    if(nrx>=0 && rx.ndrop!=0u && prevndrop!=rx.ndrop) {
-        log_debug_printf(logio, "UDP collector socket buffer overflowed %u -> %u\n", unsigned(prevndrop), unsigned(rx.ndrop));
-        prevndrop = rx.ndrop;
+    for(auto i : range(udp_rx_batch)) {
+        rx[i] = recvfromx{sock.sock, (char*)&buf[i*udp_rx_slot + cmd_origin_tag_size],
+                          udp_rx_slot-cmd_origin_tag_size-1u, &rxsrc[i], &rxdest[i]};
     }
 
-    if(nrx<0) {
+    const int nbatch = recvfromx::call_many(rx, udp_rx_batch);
+
+    if(nbatch<0) {
         int err = evutil_socket_geterror(sock.sock);
         if(err!=SOCK_EWOULDBLOCK && err!=EAGAIN && err!=SOCK_EINTR) {
             log_warn_printf(logio, "UDP RX Error on %s : %s\n", name.c_str(),
                             evutil_socket_error_to_string(err));
         }
         return false; // wait for more I/O
+    }
+
+    for(auto i : range(size_t(nbatch))) {
+        if(rx[i].ndrop!=0u && prevndrop!=rx[i].ndrop) {
+            log_debug_printf(logio, "UDP collector socket buffer overflowed %u -> %u\n", unsigned(prevndrop), unsigned(rx[i].ndrop));
+            prevndrop = rx[i].ndrop;
+        }
 
+        if(netImpairDrop())
+            continue; // emulated loss.  cf. testNetImpair()
+
+        handle_one(rx[i]);
     }
 
+    batchDone();
+
+    return size_t(nbatch)==udp_rx_batch;
+}
+
+void UDPCollector::handle_one(recvfromx& rx)
+{
+    auto& dest = *rx.dst;
+    auto rxbuf = static_cast<const uint8_t*>(rx.buf);
+    const int nrx = rx.nrx;
+    // used by our reply()
+    src = *rx.src;
+
     if(dest.family()!=AF_UNSPEC)
         dest.setPort(bind_addr.port());
 
     if(src.isMCast()) {
         // should never happen.  It it does, we won't be tricked into amplifying a DDoS.
         log_debug_printf(logio, "Ignoring UDP with mcast source %s.\n", src.tostring().c_str());
-        return true;
+        return;
     }
 
     log_hex_printf(logio, Level::Debug, rxbuf, nrx, "UDP Rx %d, %s -> %s @%u (%s)\n",
@@ -267,7 +392,19 @@ bool UDPCollector::handle_one()
     origin_t origin = manager->ifmap.is_iface(src) ? Local : Remote;
 
     process_one(dest, rxbuf, nrx, origin);
-    return true;
+}
+
+void UDPCollector::batchDone()
+{
+    if(searched) {
+        searched = false;
+        for(auto L : listeners) {
+            if(L->searchDoneCB)
+                (L->searchDoneCB)(*this);
+        }
+    }
+
+    flushTx();
 }
 
 void UDPCollector::process_one(const SockAddr &dest, const uint8_t *buf, size_t nrx, origin_t origin)
@@ -323,7 +460,7 @@ void UDPCollector::process_one(const SockAddr &dest, const uint8_t *buf, size_t
             // invalid, bcast, or not ipv4
 
         } else if(dest.compare(lo_mcast_addr.addr,false)!=0) {
-            assert(buf==&this->buf[cmd_origin_tag_size]);
+            assert(size_t(buf - this->buf.get()) % udp_rx_slot == cmd_origin_tag_size);
             // clear unicast flag in forwarded message
             *save_flags &= ~pva_search_flags::Unicast;
             // recipient of forwarded message must use, and trust, replyAddr in body :(
@@ -332,7 +469,12 @@ void UDPCollector::process_one(const SockAddr &dest, const uint8_t *buf, size_t
                 to_wire(R, server);
                 assert(R.good());
             }
-            forwardM(dest, buf, nrx);
+            if(soleListener()) {
+                // no other process could receive the forwarded copy.  Deliver as if we had.
+                process_one(dest, buf, nrx, OriginTag);
+            } else {
+                forwardM(dest, buf, nrx);
+            }
             return;
 
         } else {
@@ -386,9 +528,11 @@ void UDPCollector::process_one(const SockAddr &dest, const uint8_t *buf, size_t
         if(M.good()) {
             // ensure nil for final PV name
             *M.save() = '\0';
+            PVXS_TRACE2(udp_search_rx, searchID, names.size());
 
             for(auto L : listeners) {
                 if(L->searchCB && (L->dest.addr.isAny() || L->dest.addr==dest)) {
+                    searched = true;
                     (L->searchCB)(*this);
                 }
             }
@@ -429,6 +573,18 @@ void UDPCollector::process_one(const SockAddr &dest, const uint8_t *buf, size_t
         break;
     }
 
+    case CMD_MONITOR: {
+        // only multicast monitor updates are sent by UDP.  Decoded by the listener
+        UDPManager::Monitor msg{src, M.save(), head.len, M.be};
+
+        for(auto L : listeners) {
+            if(L->monitorCB && (L->dest.addr.isAny() || L->dest.addr==dest)) {
+                (L->monitorCB)(msg);
+            }
+        }
+        break;
+    }
+
     case CMD_ORIGIN_TAG: {
         SockAddr originaddr; // aka. original destination
         from_wire(M, originaddr);
@@ -464,43 +620,101 @@ void UDPCollector::forwardM(const SockAddr& origin, const uint8_t *pbuf, size_t
     log_debug_printf(logio, "Forward as originated for %s\n",
                      origin.tostring().c_str());
 
-    assert(buf.size() > cmd_origin_tag_size);
-    assert(pbuf==&buf[cmd_origin_tag_size]);
+    // prefix is written into the headroom of this RX slot
+    auto head = const_cast<uint8_t*>(pbuf) - cmd_origin_tag_size;
+    assert(size_t(head - buf.get()) % udp_rx_slot == 0u);
 
     {
-        FixedBuf M(true, &buf[0], cmd_origin_tag_size);
+        FixedBuf M(true, head, cmd_origin_tag_size);
 
         to_wire(M, Header{CMD_ORIGIN_TAG, 0, 16u});
         to_wire(M, origin);
         assert(M.good());
-        assert(M.save()==&buf[cmd_origin_tag_size]);
+        assert(M.save()==pbuf);
     }
 
+    // only forwarded messages are sent to mcast destinations,
+    // so this setting applies to any still queued when flushed.
     sock.mcast_prep_sendto(lo_mcast_addr);
     src = lo_mcast_addr.addr;
-    reply(&buf[0], cmd_origin_tag_size+plen);
+    reply(head, cmd_origin_tag_size+plen);
+}
+
+/* True if our socket is the only one bound to its port, so that a forwarded
+ * unicast would only be received by ourselves.  Only determined on Linux,
+ * and may lag the start of another process by up to soleCheckInterval.
+ */
+bool UDPCollector::soleListener()
+{
+#ifdef __linux__
+    auto now(epicsMonotonicGet());
+    if(now - soleChecked >= soleCheckInterval) {
+        soleChecked = now;
+        auto prev = sole;
+        sole = countUDPBound(bind_addr.port())==1u;
+        if(sole!=prev)
+            log_debug_printf(logio, "%s %s\n", name.c_str(),
+                             sole ? "is sole listener.  Deliver unicast in-process" : "shares port.  Forward unicast");
+    }
+#endif
+    return sole;
 }
 
 bool UDPCollector::reply(const void *msg, size_t msglen) const
+{
+    return replyTo(src, msg, msglen);
+}
+
+bool UDPCollector::replyTo(const SockAddr& dest, const void *msg, size_t msglen) const
 {
     manager->loop.assertInLoop();
 
     log_hex_printf(logio, Level::Debug, msg, msglen, "Send %s -> %s\n",
-                   bind_addr.tostring().c_str(), src.tostring().c_str());
+                   bind_addr.tostring().c_str(), dest.tostring().c_str());
+
+    // queue to be sent with the rest of the current batch
+    if(txq.size()>=udp_tx_batch)
+        flushTx();
+
+    auto offset = txbuf.size();
+    auto pmsg = static_cast<const uint8_t*>(msg);
+    txbuf.insert(txbuf.end(), pmsg, pmsg+msglen);
+    txq.push_back(TxEntry{dest, offset, msglen});
+    return true;
+}
+
+void UDPCollector::flushTx() const
+{
+    manager->loop.assertInLoop();
+
+    const size_t ntx = txq.size();
+    sendtox tx[udp_tx_batch];
+    assert(ntx<=udp_tx_batch);
+
+    for(auto i : range(ntx)) {
+        tx[i] = sendtox{&txbuf[txq[i].offset], txq[i].len, &txq[i].dest};
+    }
+
+    for(size_t i=0; i<ntx; ) {
+        auto nsent = sendtox::call_many(sock.sock, &tx[i], ntx-i);
+        if(nsent>0) {
+            i += size_t(nsent);
+            continue;
+        }
 
-    auto ntx = sendto(sock.sock, (char*)msg, msglen, 0, &src->sa, src.size());
-    if(ntx<0) {
         int err = evutil_socket_geterror(sock.sock);
         if(err==SOCK_EWOULDBLOCK || err==EAGAIN || err==SOCK_EINTR) {
             // nothing to do here
         } else {
             log_warn_printf(logio, "UDP TX Error on %s -> %s : (%d) %s\n",
-                            name.c_str(), src.tostring().c_str(),
+                            name.c_str(), tx[i].dst->tostring().c_str(),
                             err, evutil_socket_error_to_string(err));
         }
-        return false; // wait for more I/O
+        i++; // skip failed message
     }
-    return size_t(ntx)==msglen;
+
+    txq.clear();
+    txbuf.clear();
 }
 
 static struct udp_gbl_t {
@@ -585,18 +799,20 @@ std::unique_ptr<UDPListener> UDPManager::onBeacon(SockAddr& dest,
 }
 
 std::unique_ptr<UDPListener> UDPManager::onSearch(SockEndpoint &dest,
-                                                  std::function<void(const Search&)>&& cb)
+                                                  std::function<void(const Search&)>&& cb,
+                                                  std::function<void(const Search&)>&& batchDone)
 {
     if(!pvt)
         throw std::invalid_argument("UDPManager null");
 
     std::unique_ptr<UDPListener> ret;
 
-    pvt->loop.call([this, &ret, &dest, &cb](){
+    pvt->loop.call([this, &ret, &dest, &cb, &batchDone](){
         // from event loop worker
 
         ret.reset(new UDPListener(pvt, dest));
         ret->searchCB = std::move(cb);
+        ret->searchDoneCB = std::move(batchDone);
     });
 
     log_debug_printf(logsetup, "Listening for SEARCH on %s\n", std::string(SB()<<dest).c_str());
@@ -605,14 +821,35 @@ std::unique_ptr<UDPListener> UDPManager::onSearch(SockEndpoint &dest,
 }
 
 std::unique_ptr<UDPListener> UDPManager::onSearch(SockAddr& dest,
-                                                  std::function<void(const Search&)>&& cb)
+                                                  std::function<void(const Search&)>&& cb,
+                                                  std::function<void(const Search&)>&& batchDone)
 {
     SockEndpoint ep(dest);
-    auto ret(onSearch(ep, std::move(cb)));
+    auto ret(onSearch(ep, std::move(cb), std::move(batchDone)));
     dest = ep.addr;
     return ret;
 }
 
+std::unique_ptr<UDPListener> UDPManager::onMonitor(SockEndpoint &dest,
+                                                   std::function<void(const Monitor&)>&& cb)
+{
+    if(!pvt)
+        throw std::invalid_argument("UDPManager null");
+
+    std::unique_ptr<UDPListener> ret;
+
+    pvt->loop.call([this, &ret, &dest, &cb](){
+        // from event loop worker
+
+        ret.reset(new UDPListener(pvt, dest));
+        ret->monitorCB = std::move(cb);
+    });
+
+    log_debug_printf(logsetup, "Listening for MONITOR on %s\n", std::string(SB()<<dest).c_str());
+
+    return ret;
+}
+
 void UDPManager::sync()
 {
     if(!pvt)
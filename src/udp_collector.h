@@ -65,18 +65,37 @@ struct PVXS_API UDPManager
         decltype (names)::const_iterator begin() const { return names.begin(); }
         decltype (names)::const_iterator end() const   { return names.end(); }
 
+        //! Send to src
         virtual bool reply(const void *msg, size_t msglen) const =0;
+        //! Send to arbitrary destination via. the same socket
+        virtual bool replyTo(const SockAddr& dest, const void *msg, size_t msglen) const =0;
         Search() = default;
         Search(const Search&) = delete;
         Search& operator=(const Search&) = delete;
         virtual ~Search();
     };
     //! Create subscription for Search messages.
+    //! If provided, batchDone is called after each batch of received datagrams
+    //! which included at least one Search, and may use Search::replyTo().
     //! Must call UDPListener::start()
     std::unique_ptr<UDPListener> onSearch(SockEndpoint& dest,
-                                          std::function<void(const Search&)>&& cb);
+                                          std::function<void(const Search&)>&& cb,
+                                          std::function<void(const Search&)>&& batchDone = {});
     std::unique_ptr<UDPListener> onSearch(SockAddr& dest,
-                                          std::function<void(const Search&)>&& cb);
+                                          std::function<void(const Search&)>&& cb,
+                                          std::function<void(const Search&)>&& batchDone = {});
+
+    struct Monitor {
+        const SockAddr& src;
+        // message body, following the header
+        const uint8_t* body;
+        size_t len;
+        bool be;
+    };
+    //! Create subscription for multicast monitor updates.  cf. mcastmon.h
+    //! Must call UDPListener::start()
+    std::unique_ptr<UDPListener> onMonitor(SockEndpoint& dest,
+                                           std::function<void(const Monitor&)>&& cb);
 
     void sync();
 
@@ -95,7 +114,9 @@ private:
 class PVXS_API UDPListener
 {
     std::function<void(UDPManager::Search&)> searchCB;
+    std::function<void(UDPManager::Search&)> searchDoneCB;
     std::function<void(UDPManager::Beacon&)> beaconCB;
+    std::function<void(const UDPManager::Monitor&)> monitorCB;
     const std::shared_ptr<UDPManager::Pvt> manager;
     std::shared_ptr<UDPCollector> collector;
     const SockEndpoint dest;
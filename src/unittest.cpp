@@ -4,6 +4,7 @@
  * in file LICENSE that is included with this distribution.
  */
 
+#include <algorithm>
 #include <atomic>
 
 #include "pvxs/version.h"
@@ -46,12 +47,42 @@ void testSetup()
     thisIsATest = true;
 }
 
+static std::atomic<double> impairLatency{0.0}, impairLoss{0.0};
+static std::atomic<size_t> impairBandwidth{0u};
+static std::atomic<uint32_t> impairSeed{1u};
+
+void testNetImpair(const NetImpairment& imp)
+{
+    impairLatency = std::max(0.0, imp.latency);
+    impairBandwidth = imp.bandwidth;
+    impairLoss = std::min(1.0, std::max(0.0, imp.loss));
+}
+
 namespace impl {
 bool inUnitTest()
 {
     return thisIsATest;
 }
 
+bool netImpairment(NetImpairment& imp)
+{
+    imp.latency = impairLatency.load(std::memory_order_relaxed);
+    imp.bandwidth = impairBandwidth.load(std::memory_order_relaxed);
+    imp.loss = impairLoss.load(std::memory_order_relaxed);
+    return imp.latency>0.0 || imp.bandwidth || imp.loss>0.0;
+}
+
+bool netImpairDrop()
+{
+    auto loss = impairLoss.load(std::memory_order_relaxed);
+    if(loss<=0.0)
+        return false;
+    // a racy LCG is random enough for this
+    uint32_t seed = impairSeed.load(std::memory_order_relaxed)*1103515245u + 12345u;
+    impairSeed.store(seed, std::memory_order_relaxed);
+    return (seed>>8u) < uint32_t(loss*double(1u<<24u));
+}
+
 loc_bad_alloc::loc_bad_alloc(const char *file, int line)
 {
     if(auto sep = strrchr(file, '/')) {
@@ -17,10 +17,12 @@
 #include <signal.h>
 
 #include <iomanip>
+#include <fstream>
 #include <cstring>
 #include <sstream>
 #include <stdexcept>
 #include <atomic>
+#include <algorithm>
 
 #include <ctype.h>
 
@@ -76,11 +78,14 @@ unsigned long version_abi_int()
     return PVXS_ABI_VERSION;
 }
 
+#ifndef PVXS_DISABLE_INST_COUNTER
+
 namespace {
 epicsThreadOnceId ICountOnce = EPICS_THREAD_ONCE_INIT;
 struct ICountGbl_t {
     RWLock lock;
-    std::map<std::string, std::atomic<size_t>*> counters;
+    std::map<std::string, ICount*> counters;
+    std::map<std::string, MemCount*> memory;
 } *ICountGbl;
 
 void ICountInit(void*)
@@ -88,21 +93,44 @@ void ICountInit(void*)
     ICountGbl = new ICountGbl_t;
 }
 
+std::atomic<size_t> ICountNextShard{0u};
+
 } // namespace
 
-void registerICount(const char *name, std::atomic<size_t>& Cnt)
+constexpr size_t ICount::nshards;
+
+void registerICount(const char *name, ICount& Cnt)
 {
     epicsThreadOnce(&ICountOnce, &ICountInit, nullptr);
     auto& gbl = *ICountGbl;
     try {
         auto L(gbl.lock.lockWriter());
-        if(!gbl.counters.emplace(name, &Cnt).second) { // duplicate name
-            return;
-        }
+        // ignore duplicate name, or concurrent registration
+        (void)gbl.counters.emplace(name, &Cnt);
+    } catch(std::exception& e) { // bad_alloc
+        return;
+    }
+    Cnt.registered.store(true, std::memory_order_relaxed);
+}
+
+void registerMemCount(MemCount& Cnt)
+{
+    epicsThreadOnce(&ICountOnce, &ICountInit, nullptr);
+    auto& gbl = *ICountGbl;
+    try {
+        auto L(gbl.lock.lockWriter());
+        (void)gbl.memory.emplace(Cnt.name, &Cnt);
     } catch(std::exception& e) { // bad_alloc
         return;
     }
-    Cnt++; // bias by +1 to indicate initialization
+    Cnt.registered.store(true, std::memory_order_relaxed);
+}
+
+size_t ICountShard()
+{
+    // assign shards to threads round robin
+    thread_local size_t idx = ICountNextShard.fetch_add(1u, std::memory_order_relaxed) % ICount::nshards;
+    return idx;
 }
 
 std::map<std::string, size_t> instanceSnapshot()
@@ -114,14 +142,46 @@ std::map<std::string, size_t> instanceSnapshot()
         auto& gbl = *ICountGbl;
         auto L(gbl.lock.lockReader());
         for(auto& pair : gbl.counters) {
-            // remove -1 bias for initialized counter
-            ret.emplace(pair.first, pair.second->load(std::memory_order_relaxed)-1u);
+            // shards are read one by one, so a racing create+destroy may appear as -1
+            auto cnt = pair.second->sum();
+            ret.emplace(pair.first, cnt > size_t(-1)/2u ? 0u : cnt);
         }
     }
 
     return ret;
 }
 
+std::map<std::string, size_t> memorySnapshot()
+{
+    std::map<std::string, size_t> ret;
+
+    {
+        epicsThreadOnce(&ICountOnce, &ICountInit, nullptr);
+        auto& gbl = *ICountGbl;
+        auto L(gbl.lock.lockReader());
+        for(auto& pair : gbl.memory) {
+            auto cnt = pair.second->sum();
+            ret.emplace(pair.first, cnt > size_t(-1)/2u ? 0u : cnt);
+        }
+    }
+
+    return ret;
+}
+
+#else // PVXS_DISABLE_INST_COUNTER
+
+std::map<std::string, size_t> instanceSnapshot()
+{
+    return std::map<std::string, size_t>();
+}
+
+std::map<std::string, size_t> memorySnapshot()
+{
+    return std::map<std::string, size_t>();
+}
+
+#endif // PVXS_DISABLE_INST_COUNTER
+
 // _assume_ only positive indices will be used
 static
 std::atomic<int> indentIndex{INT_MIN};
@@ -441,6 +501,16 @@ void SockAddr::setPort(unsigned short port)
 }
 
 void SockAddr::setAddress(const char *name, unsigned short defport)
+{
+    (void)parseAddress(name, defport, true);
+}
+
+bool SockAddr::setNumericAddress(const char *name, unsigned short defport)
+{
+    return parseAddress(name, defport, false);
+}
+
+bool SockAddr::parseAddress(const char *name, unsigned short defport, bool lookup)
 {
     assert(name);
     // too bad evutil_parse_sockaddr_port() treats ":0" as an error...
@@ -521,6 +591,8 @@ void SockAddr::setAddress(const char *name, unsigned short defport)
 
     if(evutil_inet_pton(temp->sa.sa_family, addr, sockaddr)<=0) {
         // not a plain IP4/6 address.
+        if(!lookup)
+            return false;
         // Fall back to synchronous DNS lookup (could be sloooow)
 
         GetAddrInfo info(addr);
@@ -546,6 +618,7 @@ void SockAddr::setAddress(const char *name, unsigned short defport)
         temp.setPort(defport);
 
     (*this) = temp;
+    return true;
 }
 
 bool SockAddr::isAny() const noexcept
@@ -804,6 +877,62 @@ int64_t parseTo<int64_t>(const std::string& s) {
     return ret;
 }
 
+std::vector<unsigned> parseCPUList(const std::string& s)
+{
+    std::vector<unsigned> ret;
+    for(size_t pos=0u; !s.empty() && pos<=s.size(); ) {
+        auto sep = s.find(',', pos);
+        if(sep==std::string::npos)
+            sep = s.size();
+        auto item(s.substr(pos, sep-pos));
+        pos = sep+1u;
+
+        auto dash = item.find('-');
+        auto first = parseTo<uint64_t>(item.substr(0u, dash));
+        auto last = dash==std::string::npos ? first : parseTo<uint64_t>(item.substr(dash+1u));
+        if(first>last || last>=1024u)
+            throw NoConvert(SB()<<"Invalid CPU range : \""<<escape(item)<<"\"");
+        for(auto cpu : range(first, last+1u))
+            ret.push_back(unsigned(cpu));
+    }
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    return ret;
+}
+
+std::vector<std::vector<unsigned>> parseCPUGroups(const std::string& s)
+{
+    std::vector<std::vector<unsigned>> ret;
+
+    if(s=="numa") {
+        // one group for each NUMA node with CPUs
+#ifdef __linux__
+        for(unsigned node=0u; ; node++) {
+            std::ifstream strm((SB()<<"/sys/devices/system/node/node"<<node<<"/cpulist").str());
+            std::string line;
+            if(!strm.is_open() || !std::getline(strm, line))
+                break;
+            auto cpus(parseCPUList(line));
+            if(!cpus.empty())
+                ret.push_back(std::move(cpus));
+        }
+#endif
+        return ret;
+    }
+
+    for(size_t pos=0u; !s.empty() && pos<=s.size(); ) {
+        auto sep = s.find(';', pos);
+        if(sep==std::string::npos)
+            sep = s.size();
+        auto cpus(parseCPUList(s.substr(pos, sep-pos)));
+        if(cpus.empty())
+            throw NoConvert(SB()<<"Empty CPU group in : \""<<escape(s)<<"\"");
+        ret.push_back(std::move(cpus));
+        pos = sep+1u;
+    }
+    return ret;
+}
+
 static
 std::vector<std::string>
 splitLines(const char *inp)
@@ -25,6 +25,8 @@
 #include <sstream>
 #include <type_traits>
 #include <limits>
+#include <vector>
+#include <algorithm>
 
 #include <event2/util.h>
 
@@ -47,7 +49,9 @@
 
 #include <epicsThread.h>
 
-namespace pvxs {namespace impl {
+namespace pvxs {
+struct NetImpairment;
+namespace impl {
 
 template<typename T>
 struct promote_print { static T op(const T& v) { return v; }};
@@ -59,6 +63,11 @@ struct promote_print<uint8_t> { static unsigned op(const char& v) { return v; }}
 PVXS_API
 bool inUnitTest();
 
+// Current emulated network impairment.  Returns true if any.  cf. testNetImpair()
+bool netImpairment(NetImpairment& imp);
+// Decide if a UDP datagram received should be dropped as lost.
+bool netImpairDrop();
+
 /* specialization of bad_alloc which notes the location from which
  * the exception originates.
  */
@@ -138,6 +147,26 @@ template<>
 PVXS_API
 int64_t parseTo<int64_t>(const std::string& s);
 
+//! Parse a list of CPU numbers and ranges.  eg. "0,2-3".  Returns sorted unique CPU numbers.
+//! @throws NoConvert on invalid input
+PVXS_API
+std::vector<unsigned> parseCPUList(const std::string& s);
+
+//! Parse a list of CPU groups separated by ';'.  eg. "0-7;8-15".  Each as parseCPUList().
+//! "numa" for one group per NUMA node, where this can be discovered (Linux).  Otherwise no groups.
+//! @throws NoConvert on invalid input
+PVXS_API
+std::vector<std::vector<unsigned>> parseCPUGroups(const std::string& s);
+
+/* Compress with the LZ4 block format (no frame header).  cf. ConnBase::enqueueTxBody()
+ * @returns compressed length, or zero if more than outmax bytes would be needed.
+ */
+PVXS_API
+size_t lz4Compress(const uint8_t* in, size_t inlen, uint8_t* out, size_t outmax);
+//! @returns true if input is valid, and decompresses to exactly outlen bytes.
+PVXS_API
+bool lz4Decompress(const uint8_t* in, size_t inlen, uint8_t* out, size_t outlen);
+
 #ifdef _WIN32
 #  define RWLOCK_TYPE SRWLOCK
 #  define RWLOCK_INIT(PLOCK)    InitializeSRWLock(PLOCK)
@@ -232,6 +261,46 @@ template <size_t Len, typename... Types>
 using aligned_union = std::aligned_union<Len, Types...>;
 #endif
 
+/* FIFO stored in a ring, which only allocates when growing.
+ * Unlike std::deque, which (de)allocates blocks as entries cycle through.
+ * T must be default constructible and move assignable.
+ */
+template<typename T>
+class RingQueue {
+    std::vector<T> ring; // size() is zero or a power of 2
+    size_t head = 0u, count = 0u;
+
+    void grow() {
+        std::vector<T> bigger(std::max(size_t(4u), 2u*ring.size()));
+        for(size_t i=0u; i<count; i++)
+            bigger[i] = std::move(ring[(head+i) & (ring.size()-1u)]);
+        ring.swap(bigger);
+        head = 0u;
+    }
+public:
+    inline bool empty() const { return !count; }
+    inline size_t size() const { return count; }
+    inline T& front() { return ring[head]; }
+    inline T& back() { return ring[(head + count - 1u) & (ring.size()-1u)]; }
+    // i-th entry from front()
+    inline const T& operator[](size_t i) const { return ring[(head + i) & (ring.size()-1u)]; }
+
+    void pop_front() {
+        ring[head] = T();
+        head = (head+1u) & (ring.size()-1u);
+        count--;
+    }
+
+    template<typename... Args>
+    void emplace_back(Args&&... args) {
+        if(count==ring.size())
+            grow();
+        ring[(head + count) & (ring.size()-1u)] = T(std::forward<Args>(args)...);
+        count++;
+    }
+    inline void push_back(T&& v) { emplace_back(std::move(v)); }
+};
+
 } // namespace impl
 using namespace impl;
 
@@ -246,6 +315,7 @@ timeval totv(double t)
 
 namespace ioc {
 void IOCGroupConfigCleanup();
+void IOCOpWorkersCleanup();
 }
 
 //! Scoped restore of std::ostream state (format flags, fill char, and field width)
@@ -269,28 +339,90 @@ struct Restore {
     }
 };
 
+#ifndef PVXS_DISABLE_INST_COUNTER
+
+/* Count of live instances of one class.  Spread over several cache lines,
+ * so that threads concurrently creating and destroying instances
+ * do not contend.  Individual shards may wrap around, their sum will not.
+ */
+struct ICount {
+    static constexpr size_t nshards = 16u;
+    struct alignas(64) Shard {
+        std::atomic<size_t> cnt{0u};
+    };
+    Shard shards[nshards];
+    std::atomic<bool> registered{false};
+
+    size_t sum() const {
+        size_t ret = 0u;
+        for(auto& shard : shards)
+            ret += shard.cnt.load(std::memory_order_relaxed);
+        return ret;
+    }
+};
+
+PVXS_API
+void registerICount(const char* name, ICount& Cnt);
+
+// index of the ICount::shards used by the calling thread
 PVXS_API
-void registerICount(const char* name, std::atomic<size_t>& Cnt);
+size_t ICountShard();
 
 // Name and Cnt must have global lifetime
-template<std::atomic<size_t>& Cnt>
+template<ICount& Cnt>
 struct InstCounter {
     explicit InstCounter(const char* Name) {
-        if(0u==Cnt.fetch_add(1u, std::memory_order_relaxed)) { // first
+        if(!Cnt.registered.load(std::memory_order_relaxed)) // first
             registerICount(Name, Cnt);
-        }
+        Cnt.shards[ICountShard()].cnt.fetch_add(1u, std::memory_order_relaxed);
     }
     InstCounter(const InstCounter&) = delete;
     InstCounter& operator=(const InstCounter&) = delete;
     ~InstCounter() {
-        Cnt.fetch_sub(1u, std::memory_order_relaxed);
+        Cnt.shards[ICountShard()].cnt.fetch_sub(1u, std::memory_order_relaxed);
     }
 };
 
 #define INST_COUNTER(KLASS) \
-                    static std::atomic<size_t> cnt_ ## KLASS; \
+                    static ICount cnt_ ## KLASS; \
                     InstCounter<cnt_ ## KLASS> instances{#KLASS}
-#define DEFINE_INST_COUNTER2(KLASS, NAME) std::atomic<size_t> KLASS::cnt_ ## NAME {0u}
+#define DEFINE_INST_COUNTER2(KLASS, NAME) ICount KLASS::cnt_ ## NAME
+
+struct MemCount;
+
+PVXS_API
+void registerMemCount(MemCount& Cnt);
+
+/* Approximate bytes of memory held by one subsystem.  cf. memorySnapshot()
+ * Must have global lifetime.  constexpr so that use during static
+ * initialization of other globals is safe.
+ */
+struct MemCount : public ICount {
+    const char* const name;
+    constexpr explicit MemCount(const char* name) :name(name) {}
+
+    void add(size_t n) {
+        if(!registered.load(std::memory_order_relaxed)) // first
+            registerMemCount(*this);
+        shards[ICountShard()].cnt.fetch_add(n, std::memory_order_relaxed);
+    }
+    void sub(size_t n) {
+        shards[ICountShard()].cnt.fetch_sub(n, std::memory_order_relaxed);
+    }
+};
+
+#else // PVXS_DISABLE_INST_COUNTER
+
+#define INST_COUNTER(KLASS) static_assert(true, #KLASS)
+#define DEFINE_INST_COUNTER2(KLASS, NAME) static_assert(true, #NAME)
+
+struct MemCount {
+    constexpr explicit MemCount(const char*) {}
+    void add(size_t) {}
+    void sub(size_t) {}
+};
+
+#endif // PVXS_DISABLE_INST_COUNTER
 #define DEFINE_INST_COUNTER(KLASS) DEFINE_INST_COUNTER2(KLASS, KLASS)
 
 } // namespace pvxs
@@ -0,0 +1,145 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef WIRECACHE_H
+#define WIRECACHE_H
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+
+#include <event2/buffer.h>
+
+#include "dataimpl.h"
+#include "pvaproto.h"
+
+namespace pvxs {
+namespace impl {
+
+/* Serialized form of one post()'d Value, shared by every MonitorOp (subscriber)
+ * which has queued that same Value.  eg. each SharedPV::post() is encoded at most
+ * once for each distinct combination of byte order and pvRequest mask.
+ *
+ * Relies on the post() requirement that a queued Value is not modified.
+ */
+struct WireCache {
+    const FieldStorage* const key;
+
+    struct Encoding {
+        bool be;
+        BitMask mask;
+        // immutable once encoded.  May contain references to array storage.
+        std::shared_ptr<evbuffer> bytes;
+    };
+
+    mutable epicsMutex lock;
+    // guarded by lock
+    std::vector<Encoding> encodings;
+
+    explicit WireCache(const FieldStorage* key) :key(key) {}
+
+    // find, or create, the cache entry for this Value storage
+    static
+    std::shared_ptr<WireCache> lookup(const FieldStorage* key);
+    static inline
+    std::shared_ptr<WireCache> lookup(const Value& val) {
+        return lookup(Value::Helper::store_ptr(val));
+    }
+
+    // find an existing cache entry, or nullptr
+    static
+    std::shared_ptr<WireCache> find(const FieldStorage* key);
+
+    // remember an existing serialization.  eg. as received by a client.  cf. MonitorBuilder::passThrough()
+    void seed(bool be, BitMask&& mask, const std::shared_ptr<evbuffer>& bytes)
+    {
+        epicsGuard<epicsMutex> G(lock);
+        encodings.push_back(Encoding{be, std::move(mask), bytes});
+    }
+
+    // copy serializations of another Value with the same type, marked fields, and field values.
+    void inherit(const WireCache& o)
+    {
+        std::vector<Encoding> temp;
+        {
+            epicsGuard<epicsMutex> G(o.lock);
+            for(auto& enc : o.encodings) {
+                BitMask maskcopy(enc.mask.size());
+                for(auto i : range(enc.mask.wsize()))
+                    maskcopy.word(i) = enc.mask.word(i);
+                temp.push_back(Encoding{enc.be, std::move(maskcopy), enc.bytes});
+            }
+        }
+        epicsGuard<epicsMutex> G(lock);
+        for(auto& enc : temp)
+            encodings.push_back(std::move(enc));
+    }
+
+    // forget previous serializations.  eg. after the Value is changed.
+    void clear()
+    {
+        epicsGuard<epicsMutex> G(lock);
+        encodings.clear();
+    }
+
+    // serialize val through to_wire_valid(), or re-use a previous serialization.
+    // hint is the predicted length.  eg. of the previous encoding.
+    std::shared_ptr<evbuffer> encode(bool be, const Value& val, const WirePlan& plan, size_t hint=0u)
+    {
+        auto& mask = plan.mask;
+        epicsGuard<epicsMutex> G(lock);
+
+        for(auto& enc : encodings) {
+            if(enc.be==be && enc.mask==mask)
+                return enc.bytes;
+        }
+
+        std::shared_ptr<evbuffer> bytes(evbuffer_new(), &evbuffer_free);
+        if(!bytes)
+            throw std::bad_alloc();
+        {
+            EvOutBuf M(be, bytes.get(), std::min(hint, maxTxHint), true);
+            to_wire_valid(M, val, plan);
+            if(!M.good())
+                throw std::bad_alloc();
+        }
+
+        BitMask maskcopy(mask.size());
+        for(auto i : range(mask.wsize()))
+            maskcopy.word(i) = mask.word(i);
+
+        encodings.push_back(Encoding{be, std::move(maskcopy), bytes});
+        return bytes;
+    }
+
+    // append previously encoded bytes to a TX buffer.
+    // Larger extents are appended by reference.
+    static
+    void append(bool be, evbuffer* buf, const std::shared_ptr<evbuffer>& bytes)
+    {
+        auto n = evbuffer_peek(bytes.get(), -1, nullptr, nullptr, 0);
+        std::vector<evbuffer_iovec> vecs(n);
+        n = evbuffer_peek(bytes.get(), -1, nullptr, vecs.data(), n);
+
+        for(auto i : range(n)) {
+            auto& vec = vecs[i];
+            if(vec.iov_len >= minRefBytes) {
+                EvOutBuf R(be, buf);
+                if(R.appendRef(vec.iov_base, vec.iov_len, bytes))
+                    continue;
+            }
+            if(evbuffer_add(buf, vec.iov_base, vec.iov_len))
+                throw std::bad_alloc();
+        }
+    }
+};
+
+} // namespace impl
+} // namespace pvxs
+
+#endif // WIRECACHE_H
@@ -0,0 +1,246 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <epicsGuard.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/log.h>
+#include <pvxs/util.h>
+#include "wirecap.h"
+#include "utilpvt.h"
+
+namespace pvxs {
+namespace impl {
+
+DEFINE_LOGGER(logcap, "pvxs.tcp.capture");
+
+typedef epicsGuard<epicsMutex> Guard;
+
+namespace {
+
+// prefix of each record in WireCapture::ring
+struct RecHead {
+    uint32_t sec, nsec; // POSIX time
+    uint32_t origLen, capLen;
+    uint8_t tx;
+};
+
+// pcap link type for private use
+constexpr uint32_t linkUser0 = 147u;
+
+struct CaptureGbl {
+    epicsMutex lock;
+    std::set<const WireCapture*> active; // guarded by lock
+} *captureGbl;
+
+// per-connection buffer size for new connections.  Zero when disabled.
+std::atomic<size_t> captureSize{0u};
+
+epicsThreadOnceId captureOnce = EPICS_THREAD_ONCE_INIT;
+
+void captureInit(void*)
+{
+    captureGbl = new CaptureGbl;
+    if(auto env = getenv("PVXS_WIRE_CAPTURE")) {
+        try {
+            captureSize = parseTo<uint64_t>(env);
+        } catch(std::exception& e) {
+            log_err_printf(logcap, "Ignoring invalid PVXS_WIRE_CAPTURE=%s : %s\n", env, e.what());
+        }
+    }
+}
+
+} // namespace
+
+constexpr size_t WireCapture::snapLen;
+
+WireCapture::WireCapture(size_t nbytes, const std::string& peer)
+    :peer(peer)
+    ,ring(std::max(nbytes, sizeof(RecHead) + snapLen))
+{
+    scratch.reserve(snapLen);
+    Guard G(captureGbl->lock);
+    captureGbl->active.insert(this);
+}
+
+WireCapture::~WireCapture()
+{
+    Guard G(captureGbl->lock);
+    captureGbl->active.erase(this);
+}
+
+std::unique_ptr<WireCapture> WireCapture::create(const std::string& peer)
+{
+    threadOnce(&captureOnce, &captureInit, nullptr);
+    std::unique_ptr<WireCapture> ret;
+    if(auto nbytes = captureSize.load(std::memory_order_relaxed))
+        ret.reset(new WireCapture(nbytes, peer));
+    return ret;
+}
+
+void WireCapture::copyIn(uint64_t pos, const void* src, size_t n)
+{
+    auto offset = size_t(pos % ring.size());
+    auto first = std::min(n, ring.size()-offset);
+    memcpy(&ring[offset], src, first);
+    if(n > first)
+        memcpy(&ring[0], static_cast<const uint8_t*>(src)+first, n-first);
+}
+
+void WireCapture::copyOut(uint64_t pos, void* dst, size_t n) const
+{
+    auto offset = size_t(pos % ring.size());
+    auto first = std::min(n, ring.size()-offset);
+    memcpy(dst, &ring[offset], first);
+    if(n > first)
+        memcpy(static_cast<uint8_t*>(dst)+first, &ring[0], n-first);
+}
+
+void WireCapture::add(bool tx, const uint8_t* prefix, size_t plen, evbuffer* buf, size_t blen)
+{
+    RecHead rec{};
+    rec.tx = tx;
+    rec.origLen = uint32_t(plen + blen);
+    rec.capLen = uint32_t(std::min(plen + blen, snapLen));
+
+    scratch.resize(rec.capLen);
+    auto npre = std::min(plen, size_t(rec.capLen));
+    if(npre)
+        memcpy(scratch.data(), prefix, npre);
+    if(rec.capLen > npre) {
+        auto want = rec.capLen - npre;
+        auto ret = evbuffer_copyout(buf, scratch.data() + npre, want);
+        if(ret < 0 || size_t(ret)!=want)
+            return;
+    }
+
+    epicsTimeStamp now;
+    if(!epicsTimeGetCurrent(&now)) {
+        rec.sec = now.secPastEpoch + POSIX_TIME_AT_EPICS_EPOCH;
+        rec.nsec = now.nsec;
+    }
+
+    const size_t rlen = sizeof(rec) + rec.capLen;
+
+    Guard G(lock);
+    // discard oldest records to make space
+    while(head + rlen - tail > ring.size()) {
+        RecHead old;
+        copyOut(tail, &old, sizeof(old));
+        tail += sizeof(old) + old.capLen;
+    }
+    copyIn(head, &rec, sizeof(rec));
+    copyIn(head + sizeof(rec), scratch.data(), rec.capLen);
+    head += rlen;
+}
+
+std::vector<uint8_t> WireCapture::snapshot() const
+{
+    Guard G(lock);
+    std::vector<uint8_t> ret(size_t(head - tail));
+    if(!ret.empty())
+        copyOut(tail, ret.data(), ret.size());
+    return ret;
+}
+
+} // namespace impl
+
+using namespace impl;
+
+void wireCaptureSet(size_t nbytes)
+{
+    threadOnce(&captureOnce, &captureInit, nullptr);
+    captureSize = nbytes;
+}
+
+size_t wireCaptureDump(const std::string& fname)
+{
+    threadOnce(&captureOnce, &captureInit, nullptr);
+
+    struct Capture {
+        std::string peer;
+        std::vector<uint8_t> recs;
+    };
+    std::vector<Capture> caps;
+    {
+        Guard G(captureGbl->lock);
+        caps.reserve(captureGbl->active.size());
+        for(auto cap : captureGbl->active) {
+            caps.push_back(Capture{cap->peer, cap->snapshot()});
+        }
+    }
+
+    // interleave records of all connections by time
+    struct Ref {
+        uint64_t time;
+        const Capture* cap;
+        size_t offset;
+    };
+    std::vector<Ref> refs;
+    for(auto& cap : caps) {
+        for(size_t pos=0u; pos + sizeof(RecHead) <= cap.recs.size();) {
+            RecHead rec;
+            memcpy(&rec, &cap.recs[pos], sizeof(rec));
+            refs.push_back(Ref{uint64_t(rec.sec)*1000000000u + rec.nsec, &cap, pos});
+            pos += sizeof(rec) + rec.capLen;
+        }
+    }
+    std::stable_sort(refs.begin(), refs.end(), [](const Ref& lhs, const Ref& rhs) {
+        return lhs.time < rhs.time;
+    });
+
+    std::ofstream out(fname, std::ios::binary);
+    if(!out.is_open())
+        throw std::runtime_error(SB()<<"Unable to open "<<fname);
+
+    auto put32 = [&out](uint32_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+    auto put16 = [&out](uint16_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+
+    // pcap file header, in host byte order
+    put32(0xa1b2c3d4u);
+    put16(2u);
+    put16(4u);
+    put32(0u); // thiszone
+    put32(0u); // sigfigs
+    put32(uint32_t(2u + 255u + WireCapture::snapLen));
+    put32(linkUser0);
+
+    for(auto& ref : refs) {
+        RecHead rec;
+        memcpy(&rec, &ref.cap->recs[ref.offset], sizeof(rec));
+        auto plen = std::min(ref.cap->peer.size(), size_t(255u));
+
+        put32(rec.sec);
+        put32(rec.nsec/1000u);
+        put32(uint32_t(2u + plen + rec.capLen));
+        put32(uint32_t(2u + plen + rec.origLen));
+        // pseudo header
+        out.put(char(rec.tx));
+        out.put(char(plen));
+        out.write(ref.cap->peer.data(), plen);
+        out.write(reinterpret_cast<const char*>(&ref.cap->recs[ref.offset + sizeof(rec)]), rec.capLen);
+    }
+
+    out.close();
+    if(out.fail())
+        throw std::runtime_error(SB()<<"Error writing "<<fname);
+
+    log_info_printf(logcap, "Wrote %zu messages from %zu connections to %s\n",
+                    refs.size(), caps.size(), fname.c_str());
+    return refs.size();
+}
+
+} // namespace pvxs
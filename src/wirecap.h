@@ -0,0 +1,61 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+#ifndef WIRECAP_H
+#define WIRECAP_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <epicsMutex.h>
+
+#include "evhelper.h"
+
+namespace pvxs {
+namespace impl {
+
+/* Circular capture of the most recent messages sent and received on one TCP connection.
+ * cf. wireCaptureSet() and wireCaptureDump()
+ *
+ * add() is only called from the connection worker.
+ * snapshot() may be called from any thread.
+ */
+struct WireCapture {
+    // per-message limit of captured bytes, including header
+    static constexpr size_t snapLen = 4096u;
+
+    const std::string peer;
+
+    WireCapture(size_t nbytes, const std::string& peer);
+    WireCapture(const WireCapture&) = delete;
+    WireCapture& operator=(const WireCapture&) = delete;
+    ~WireCapture();
+
+    // capture one message of plen bytes from prefix, followed by the first blen bytes of buf
+    void add(bool tx, const uint8_t* prefix, size_t plen, evbuffer* buf, size_t blen);
+
+    // copy out all captured records, oldest first
+    std::vector<uint8_t> snapshot() const;
+
+    // a new capture if enabled, or nullptr
+    static std::unique_ptr<WireCapture> create(const std::string& peer);
+
+private:
+    void copyIn(uint64_t pos, const void* src, size_t n);
+    void copyOut(uint64_t pos, void* dst, size_t n) const;
+
+    mutable epicsMutex lock;
+    std::vector<uint8_t> ring;
+    // ring offsets, modulo ring.size(), of the next record to write, and of the oldest record
+    uint64_t head = 0u, tail = 0u; // guarded by lock
+    // message being captured.  Only accessed from add()
+    std::vector<uint8_t> scratch;
+};
+
+} // namespace impl
+} // namespace pvxs
+
+#endif // WIRECAP_H
@@ -144,6 +144,43 @@ void benchArraySerDes(bool be, const shared_array<const E>& arr)
     testShow()<<" Des "<<Tdes;
 }
 
+template<typename Src, typename Dest>
+void benchConvert(size_t nelem)
+{
+    testDiag("%s<%s, %s>()", __func__, typeid (Src).name(), typeid (Dest).name());
+
+    constexpr size_t niter = 1000u;
+
+    shared_array<Src> src(nelem);
+    for(auto n : range(nelem))
+        src[n] = Src(n%100u);
+    shared_array<Dest> dest(nelem);
+
+    const auto stype = detail::CaptureBase<Src>::code;
+    const auto dtype = detail::CaptureBase<Dest>::code;
+
+    Sampler Telem, Tbulk;
+
+    for(auto n : range(niter)) {
+        (void)n;
+        StopWatch W;
+
+        // dispatch for each element, as for a loop over ArrayType pairs
+        (void)W.click();
+        for(auto i : range(nelem))
+            detail::convertArr(dtype, &dest[i], stype, &src[i], 1u);
+        Telem.sample(W.click());
+
+        // one dispatch, then the kernel for this pair
+        (void)W.click();
+        detail::convertArr(dtype, dest.data(), stype, src.data(), nelem);
+        Tbulk.sample(W.click());
+    }
+
+    testShow()<<" Element "<<Telem;
+    testShow()<<" Bulk    "<<Tbulk;
+}
+
 } // namespace
 
 MAIN(benchdata)
@@ -172,5 +209,11 @@ MAIN(benchdata)
         benchArraySerDes<std::string>(hostBE, arr);
         benchArraySerDes<std::string>(!hostBE, arr);
     }
+    testDiag("array type conversions");
+    benchConvert<int16_t, double>(nelem);
+    benchConvert<int32_t, double>(nelem);
+    benchConvert<uint16_t, float>(nelem);
+    benchConvert<double, int32_t>(nelem);
+    benchConvert<int32_t, bool>(nelem);
     return testDone();
 }
@@ -0,0 +1,97 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Time IOC boot with many group PVs defined through info(Q:group, ...).
+ * Number of groups from $BENCHGROUP_N (default 10000).
+ */
+
+#include <fstream>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <testMain.h>
+#include <dbAccess.h>
+#include <epicsTime.h>
+
+#include "testioc.h"
+#include "utilpvt.h"
+
+extern "C" {
+extern int testioc_registerRecordDeviceDriver(struct dbBase*);
+}
+
+using namespace pvxs;
+
+namespace {
+
+struct StopWatch {
+    epicsUInt64 start = 0u;
+
+    double click() {
+        epicsUInt64 now(epicsMonotonicGet());
+        epicsUInt64 ret = now-start;
+        start = now;
+        return ret*1e-9;
+    }
+};
+
+// each group maps two records into three fields.  All groups have the same shape.
+void writeGroups(const char* fname, size_t ngroups)
+{
+    std::ofstream out(fname);
+    for(auto i : range(ngroups)) {
+        out<<"record(ai, \"bg:"<<i<<":A\") {\n"
+             "    info(Q:group, {\n"
+             "        \"bg:"<<i<<":grp\":{\n"
+             "            \"a\": {+channel:\"VAL\", +trigger:\"*\"},\n"
+             "            \"\": {+type:\"meta\", +channel:\"VAL\"}\n"
+             "        }\n"
+             "    })\n"
+             "}\n"
+             "record(longin, \"bg:"<<i<<":B\") {\n"
+             "    info(Q:group, {\n"
+             "        \"bg:"<<i<<":grp\":{\n"
+             "            \"b.c\": {+type:\"plain\", +channel:\"VAL\"}\n"
+             "        }\n"
+             "    })\n"
+             "}\n";
+    }
+    if(!out.good())
+        testAbort("Unable to write %s", fname);
+}
+
+} // namespace
+
+MAIN(benchgroup)
+{
+    testPlan(0);
+    testSetup();
+
+    size_t ngroups = 10000u;
+    if(auto env = getenv("BENCHGROUP_N"))
+        ngroups = strtoul(env, nullptr, 0);
+
+    const char* fname = "benchgroup.db";
+    writeGroups(fname, ngroups);
+    {
+        TestIOC ioc;
+        testdbReadDatabase("testioc.dbd", nullptr, nullptr);
+        testOk1(!testioc_registerRecordDeviceDriver(pdbbase));
+
+        StopWatch W;
+        (void)W.click();
+        testdbReadDatabase(fname, nullptr, nullptr);
+        auto tload(W.click());
+        ioc.init();
+        auto tinit(W.click());
+
+        testDiag("%zu groups: dbLoadRecords %.3f s, iocInit %.3f s", ngroups, tload, tinit);
+    }
+    remove(fname);
+    cleanup_for_valgrind();
+    return testDone();
+}
@@ -0,0 +1,271 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Throughput and latency of QSRV subscriptions through SingleSource and GroupSource.
+ *
+ * Generates a .db with N records, the first M of which are also mapped into one group PV each.
+ * Each record is processed in turn, at a rate of R rounds per second, with its VAL set to the
+ * current monotonic time.  A subscription to every record, and to every group,
+ * measures the latency from processing to client delivery, and the rate of updates delivered.
+ *
+ * $BENCHQSRV_RECORDS  N.  default 1000
+ * $BENCHQSRV_GROUPS   M.  default 100
+ * $BENCHQSRV_RATE     R.  default 100
+ * $BENCHQSRV_SECONDS  Duration of each measurement.  default 5
+ * $BENCHQSRV_OUT      If set, write results as JSON to this file.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <testMain.h>
+#include <dbAccess.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/util.h>
+
+#include "testioc.h"
+#include "utilpvt.h"
+
+extern "C" {
+extern int testioc_registerRecordDeviceDriver(struct dbBase*);
+}
+
+using namespace pvxs;
+
+namespace {
+
+struct Sampler
+{
+    size_t nsamp =0;
+    double min=0.0, max=0.0;
+    double sum=0.0, sum2=0.0;
+
+    void sample(double val) {
+        if(nsamp==0u) {
+            min = max = val;
+
+        } else {
+            if(max < val)
+                max = val;
+            else if(min > val)
+                min = val;
+        }
+        sum += val;
+        sum2 += val*val;
+        nsamp++;
+    }
+
+    double mean() const {
+        return nsamp ? sum/nsamp : 0.0;
+    }
+
+    double std() const {
+        return nsamp ? sqrt(std::max(0.0, sum2/nsamp - mean()*mean())) : 0.0;
+    }
+};
+
+struct Result {
+    std::string name;
+    double rate = 0.0;  // updates/s delivered
+    Sampler latency;    // us
+};
+
+std::vector<Result> results;
+
+size_t envSize(const char* name, size_t def)
+{
+    auto env = getenv(name);
+    return env && *env ? strtoul(env, nullptr, 0) : def;
+}
+
+void writeDB(const char* fname, size_t nrec, size_t ngroup)
+{
+    std::ofstream out(fname);
+    for(auto i : range(nrec)) {
+        out<<"record(ai, \"bq:"<<i<<"\") {\n";
+        if(i<ngroup) {
+            out<<"    info(Q:group, {\n"
+                 "        \"bq:grp:"<<i<<"\":{\n"
+                 "            \"value\": {+channel:\"VAL\", +trigger:\"*\"},\n"
+                 "            \"\": {+type:\"meta\", +channel:\"VAL\"}\n"
+                 "        }\n"
+                 "    })\n";
+        }
+        out<<"}\n";
+    }
+    if(!out.good())
+        testAbort("Unable to write %s", fname);
+}
+
+// Collects latency and count of updates delivered to a set of subscriptions
+struct Collector {
+    epicsMutex lock;
+    Sampler latency;
+    size_t nrx = 0u;
+    bool active = false;
+
+    std::vector<std::shared_ptr<client::Subscription>> subs;
+
+    void subscribe(client::Context& ctxt, const std::string& name, const char* field) {
+        std::string fld(field);
+        subs.push_back(ctxt.monitor(name)
+                       .maskConnected(true)
+                       .maskDisconnected(true)
+                       .event([this, fld](client::Subscription& sub) {
+            while(auto val = sub.pop()) {
+                auto now = double(epicsMonotonicGet());
+                auto sent = val[fld].as<double>();
+                epicsGuard<epicsMutex> G(lock);
+                if(active && sent>0.0) {
+                    latency.sample((now - sent)*1e-3);
+                    nrx++;
+                }
+            }
+        })
+                       .exec());
+    }
+
+    void start() {
+        epicsGuard<epicsMutex> G(lock);
+        latency = Sampler();
+        nrx = 0u;
+        active = true;
+    }
+
+    void stop(const std::string& name, double duration) {
+        Result res;
+        {
+            epicsGuard<epicsMutex> G(lock);
+            active = false;
+            res.name = name;
+            res.rate = nrx/duration;
+            res.latency = latency;
+        }
+        testDiag("%-16s %12.1f updates/s  latency %10.1f +- %10.1f us  [%.1f, %.1f] N=%zu",
+                 name.c_str(), res.rate, res.latency.mean(), res.latency.std(),
+                 res.latency.min, res.latency.max, res.latency.nsamp);
+        results.push_back(res);
+    }
+};
+
+void writeJSON(const char* fname)
+{
+    std::ofstream out(fname);
+    Restore R(out);
+    out.precision(17);
+    out<<"{\"version\": \""<<version_str()<<"\",\n \"results\": [";
+    bool first = true;
+    for(auto& res : results) {
+        out<<(first ? "\n" : ",\n")
+           <<"  {\"name\": \""<<res.name<<"\""
+           <<", \"updates_per_s\": "<<res.rate
+           <<", \"n\": "<<res.latency.nsamp
+           <<", \"latency_mean_us\": "<<res.latency.mean()
+           <<", \"latency_std_us\": "<<res.latency.std()
+           <<", \"latency_min_us\": "<<res.latency.min
+           <<", \"latency_max_us\": "<<res.latency.max<<"}";
+        first = false;
+    }
+    out<<"\n ]\n}\n";
+    if(!out.good())
+        testAbort("Unable to write %s", fname);
+}
+
+} // namespace
+
+MAIN(benchqsrv)
+{
+    testPlan(0);
+    testSetup();
+
+    const size_t nrec = envSize("BENCHQSRV_RECORDS", 1000u);
+    const size_t ngroup = std::min(nrec, envSize("BENCHQSRV_GROUPS", 100u));
+    const size_t rate = std::max(size_t(1u), envSize("BENCHQSRV_RATE", 100u));
+    const double duration = double(std::max(size_t(1u), envSize("BENCHQSRV_SECONDS", 5u)));
+
+    const char* fname = "benchqsrv.db";
+    writeDB(fname, nrec, ngroup);
+    {
+        TestIOC ioc;
+        testdbReadDatabase("testioc.dbd", nullptr, nullptr);
+        testOk1(!testioc_registerRecordDeviceDriver(pdbbase));
+        testdbReadDatabase(fname, nullptr, nullptr);
+        ioc.init();
+
+        std::vector<DBADDR> addrs(nrec);
+        for(auto i : range(nrec)) {
+            if(dbNameToAddr(SB()<<"bq:"<<i<<".VAL", &addrs[i]))
+                testAbort("No record bq:%zu", i);
+        }
+
+        TestClient ctxt;
+        Collector single, group;
+        for(auto i : range(nrec))
+            single.subscribe(ctxt, SB()<<"bq:"<<i, "value");
+        for(auto i : range(ngroup))
+            group.subscribe(ctxt, SB()<<"bq:grp:"<<i, "value");
+
+        testDiag("%zu records, %zu groups, %zu rounds/s", nrec, ngroup, rate);
+
+        // let subscriptions connect and deliver initial updates
+        epicsThreadSleep(1.0);
+
+        single.start();
+        group.start();
+
+        const double period = 1.0/rate;
+        auto begin = epicsMonotonicGet();
+        size_t nround = 0u;
+        size_t nlate = 0u;
+        while(true) {
+            auto now = epicsMonotonicGet();
+            auto elapsed = (now-begin)*1e-9;
+            if(elapsed >= duration)
+                break;
+
+            auto wait = nround*period - elapsed;
+            if(wait > 0.0)
+                epicsThreadSleep(wait);
+            else if(nround)
+                nlate++;
+
+            for(auto& addr : addrs) {
+                double val = double(epicsMonotonicGet());
+                (void)dbPutField(&addr, DBR_DOUBLE, &val, 1);
+            }
+            nround++;
+        }
+        auto actual = (epicsMonotonicGet()-begin)*1e-9;
+
+        // drain
+        epicsThreadSleep(0.5);
+
+        testDiag("%zu rounds in %.3f s, %zu behind schedule", nround, actual, nlate);
+        single.stop("single", actual);
+        group.stop("group", actual);
+
+        single.subs.clear();
+        group.subs.clear();
+        ctxt.close();
+    }
+    remove(fname);
+
+    if(auto out = getenv("BENCHQSRV_OUT"))
+        writeJSON(out);
+
+    cleanup_for_valgrind();
+    return testDone();
+}
@@ -0,0 +1,379 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Scalability benchmark.  As test1000, but sweeping the number of channels,
+ * client Contexts, and Servers.
+ *
+ * For each combination, measure the time to connect all channels,
+ * the number of search datagrams and names sent, the growth of resident memory per channel,
+ * the rate of monitor updates delivered, and the time to tear down.
+ *
+ * $BENCHSCALE_CHANNELS  Channel counts.  default "1000,10000,100000,1000000"
+ * $BENCHSCALE_CLIENTS   Client Context counts.  default "1,4"
+ * $BENCHSCALE_SERVERS   Server counts.  default "1,2"
+ * $BENCHSCALE_MONITORS  Maximum number of channels subscribed for the monitor rate.  default 1000
+ * $BENCHSCALE_OUT       If set, write results to this file.  As CSV if the name ends with ".csv", otherwise as JSON.
+ */
+
+#define PVXS_ENABLE_EXPERT_API
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#  include <unistd.h>
+#endif
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/client.h>
+#include <pvxs/nt.h>
+#include <pvxs/server.h>
+#include <pvxs/source.h>
+#include <pvxs/unittest.h>
+#include <pvxs/util.h>
+
+#include "utilpvt.h"
+
+namespace {
+using namespace pvxs;
+
+struct StopWatch {
+    epicsUInt64 start = epicsMonotonicGet();
+
+    // seconds since previous click(), or construction
+    double click() {
+        epicsUInt64 now(epicsMonotonicGet());
+        epicsUInt64 ret = now-start;
+        start = now;
+        return double(ret)*1e-9;
+    }
+};
+
+// Resident set size in bytes, or zero if not known
+size_t residentBytes()
+{
+    size_t ret = 0u;
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t vsize = 0u, rss = 0u;
+    if(statm>>vsize>>rss)
+        ret = rss*size_t(sysconf(_SC_PAGESIZE));
+#endif
+    return ret;
+}
+
+std::vector<size_t> envList(const char* name, const char* def)
+{
+    auto env = getenv(name);
+    std::string s(env && *env ? env : def);
+    std::vector<size_t> ret;
+    for(size_t pos=0u; pos<=s.size(); ) {
+        auto sep = s.find(',', pos);
+        if(sep==std::string::npos)
+            sep = s.size();
+        ret.push_back(parseTo<uint64_t>(s.substr(pos, sep-pos)));
+        pos = sep+1u;
+    }
+    return ret;
+}
+
+/* Claims names "scale:<N>" where N%nserv==index.
+ * Every channel accepts subscriptions, which are retained for post().
+ */
+struct ScaleSource : public server::Source
+{
+    const size_t index, nserv;
+    const Value prototype;
+
+    epicsMutex lock;
+    std::vector<std::unique_ptr<server::ChannelControl>> chans;
+    std::vector<std::shared_ptr<server::MonitorControlOp>> subs;
+
+    ScaleSource(size_t index, size_t nserv)
+        :index(index)
+        ,nserv(nserv)
+        ,prototype(nt::NTScalar{TypeCode::UInt32}.create())
+    {}
+
+    bool mine(const char* name) const
+    {
+        if(strncmp(name, "scale:", 6u)!=0)
+            return false;
+        char *end = nullptr;
+        auto n = strtoul(name+6u, &end, 10);
+        return end!=name+6u && !*end && n%nserv==index;
+    }
+
+    virtual void onSearch(Search& op) override final
+    {
+        for(auto& pv : op) {
+            if(mine(pv.name()))
+                pv.claim();
+        }
+    }
+
+    virtual void onCreate(std::unique_ptr<server::ChannelControl>&& op) override final
+    {
+        if(!mine(op->name().c_str()))
+            return;
+
+        op->onSubscribe([this](std::unique_ptr<server::MonitorSetupOp>&& setup) {
+            std::shared_ptr<server::MonitorControlOp> sub(setup->connect(prototype));
+            auto initial(prototype.cloneEmpty());
+            initial["value"] = 0u;
+            sub->post(std::move(initial));
+
+            epicsGuard<epicsMutex> G(lock);
+            subs.push_back(std::move(sub));
+        });
+
+        epicsGuard<epicsMutex> G(lock);
+        chans.push_back(std::move(op));
+    }
+
+    // post one update to each subscription
+    void postAll(uint32_t tag)
+    {
+        decltype(subs) targets;
+        {
+            epicsGuard<epicsMutex> G(lock);
+            targets = subs;
+        }
+        for(auto& sub : targets) {
+            auto update(prototype.cloneEmpty());
+            update["value"] = tag;
+            sub->post(std::move(update));
+        }
+    }
+
+    size_t nsubs()
+    {
+        epicsGuard<epicsMutex> G(lock);
+        return subs.size();
+    }
+};
+
+struct Result {
+    size_t nchan = 0u, nserv = 0u, ncli = 0u;
+    double connect = 0.0;       // seconds to connect all channels
+    size_t searchPackets = 0u;  // search datagrams sent by all clients
+    size_t searchNames = 0u;    // names sent in those datagrams
+    double rssPerChan = 0.0;    // bytes, client and server sides
+    double monitorRate = 0.0;   // updates/s delivered
+    double teardown = 0.0;      // seconds to close all channels, clients, and servers
+};
+
+std::vector<Result> results;
+
+void benchScale(size_t nchan, size_t nserv, size_t ncli, size_t maxmon)
+{
+    Result res;
+    res.nchan = nchan;
+    res.nserv = nserv;
+    res.ncli = ncli;
+    // CI runner, or 1M channels, may take a loooong time
+    const double timeout = 30.0 + 1e-4*nchan;
+
+    std::vector<std::shared_ptr<ScaleSource>> srcs;
+    std::vector<server::Server> servs;
+    client::Config cconf;
+    for(auto s : range(nserv)) {
+        srcs.push_back(std::make_shared<ScaleSource>(s, nserv));
+        servs.push_back(server::Config::isolated()
+                        .build()
+                        .addSource("scale", srcs.back())
+                        .start());
+        if(s==0u) {
+            cconf = servs.back().clientConfig();
+            cconf.addressList.clear();
+        }
+        for(auto& iface : servs.back().config().interfaces)
+            cconf.addressList.push_back(SB()<<iface<<":"<<servs.back().config().udp_port);
+    }
+
+    std::vector<client::Context> clis;
+    for(auto c : range(ncli)) {
+        (void)c;
+        clis.push_back(cconf.build());
+    }
+
+    auto before(residentBytes());
+
+    std::atomic<size_t> nconn{0u};
+    epicsEvent done;
+    std::vector<std::shared_ptr<client::Connect>> conns;
+    conns.reserve(nchan);
+
+    StopWatch W;
+    for(auto i : range(nchan)) {
+        conns.push_back(clis[i%ncli].connect(SB()<<"scale:"<<i)
+                        .onConnect([&nconn, &done, nchan]() {
+                            if(++nconn==nchan)
+                                done.signal();
+                        })
+                        .exec());
+    }
+    for(auto& cli : clis)
+        cli.hurryUp();
+    if(!done.wait(timeout))
+        testAbort("%zu channels, %zu servers, %zu clients : connect timeout with %zu connected",
+                  nchan, nserv, ncli, nconn.load());
+    res.connect = W.click();
+
+    for(auto& cli : clis) {
+        auto rpt(cli.report(false));
+        res.searchPackets += rpt.searchPackets;
+        res.searchNames += rpt.searchSent;
+    }
+
+    auto after(residentBytes());
+    res.rssPerChan = after>before ? double(after-before)/nchan : 0.0;
+
+    // steady state monitor throughput on a subset of channels
+    const size_t nmon = std::min(nchan, maxmon);
+    const uint32_t nround = 100u;
+    std::atomic<size_t> nrx{0u}, ndone{0u};
+    std::atomic<uint32_t> target{0u};
+    std::vector<std::shared_ptr<client::Subscription>> subs;
+    subs.reserve(nmon);
+    for(auto i : range(nmon)) {
+        subs.push_back(clis[i%ncli].monitor(SB()<<"scale:"<<i)
+                       .maskConnected(true)
+                       .maskDisconnected(true)
+                       .event([&nrx, &ndone, &target, &done, nmon](client::Subscription& sub) {
+            while(auto val = sub.pop()) {
+                nrx++;
+                auto tag = val["value"].as<uint32_t>();
+                if(tag && tag==target.load() && ++ndone==nmon)
+                    done.signal();
+            }
+        })
+                       .exec());
+    }
+
+    for(auto i : range(size_t(100u*timeout))) {
+        (void)i;
+        size_t nsub = 0u;
+        for(auto& src : srcs)
+            nsub += src->nsubs();
+        if(nsub>=nmon && nrx.load()>=nmon)
+            break;
+        epicsThreadSleep(0.01);
+    }
+    if(nrx.load()<nmon)
+        testAbort("%zu channels, %zu servers, %zu clients : subscriptions not connected",
+                  nchan, nserv, ncli);
+
+    nrx = 0u;
+    target = nround;
+    W.click();
+    for(auto tag : range(1u, nround+1u)) {
+        for(auto& src : srcs)
+            src->postAll(tag);
+    }
+    if(!done.wait(timeout))
+        testAbort("%zu channels, %zu servers, %zu clients : monitor timeout",
+                  nchan, nserv, ncli);
+    res.monitorRate = nrx.load()/W.click();
+
+    W.click();
+    subs.clear();
+    conns.clear();
+    for(auto& cli : clis)
+        cli.close();
+    clis.clear();
+    for(auto& serv : servs)
+        serv.stop();
+    servs.clear();
+    srcs.clear();
+    res.teardown = W.click();
+
+    testDiag("%8zu chan %2zu serv %2zu cli : connect %8.3f s  search %8zu pkt %9zu names"
+             "  %8.1f B/chan  monitor %10.1f updates/s  teardown %8.3f s",
+             res.nchan, res.nserv, res.ncli, res.connect, res.searchPackets, res.searchNames,
+             res.rssPerChan, res.monitorRate, res.teardown);
+    results.push_back(res);
+}
+
+void writeResults(const std::string& fname)
+{
+    std::ofstream out(fname);
+    Restore R(out);
+    out.precision(17);
+    bool csv = fname.size()>=4u && fname.compare(fname.size()-4u, 4u, ".csv")==0;
+
+    if(csv) {
+        out<<"channels,servers,clients,connect_s,search_packets,search_names,"
+             "rss_per_channel,monitor_updates_per_s,teardown_s\n";
+        for(auto& res : results) {
+            out<<res.nchan<<','<<res.nserv<<','<<res.ncli<<','<<res.connect<<','
+               <<res.searchPackets<<','<<res.searchNames<<','<<res.rssPerChan<<','
+               <<res.monitorRate<<','<<res.teardown<<'\n';
+        }
+
+    } else {
+        out<<"{\"version\": \""<<version_str()<<"\",\n \"results\": [";
+        bool first = true;
+        for(auto& res : results) {
+            out<<(first ? "\n" : ",\n")
+               <<"  {\"channels\": "<<res.nchan
+               <<", \"servers\": "<<res.nserv
+               <<", \"clients\": "<<res.ncli
+               <<", \"connect_s\": "<<res.connect
+               <<", \"search_packets\": "<<res.searchPackets
+               <<", \"search_names\": "<<res.searchNames
+               <<", \"rss_per_channel\": "<<res.rssPerChan
+               <<", \"monitor_updates_per_s\": "<<res.monitorRate
+               <<", \"teardown_s\": "<<res.teardown<<"}";
+            first = false;
+        }
+        out<<"\n ]\n}\n";
+    }
+    if(!out.good())
+        testAbort("Unable to write %s", fname.c_str());
+}
+
+} // namespace
+
+MAIN(benchscale)
+{
+    testPlan(0);
+    testSetup();
+
+    auto chans(envList("BENCHSCALE_CHANNELS", "1000,10000,100000,1000000"));
+    auto clients(envList("BENCHSCALE_CLIENTS", "1,4"));
+    auto servers(envList("BENCHSCALE_SERVERS", "1,2"));
+    size_t maxmon = 1000u;
+    if(auto env = getenv("BENCHSCALE_MONITORS"))
+        maxmon = parseTo<uint64_t>(env);
+
+    for(auto nchan : chans) {
+        for(auto nserv : servers) {
+            for(auto ncli : clients) {
+                if(nchan && nserv && ncli)
+                    benchScale(nchan, nserv, ncli, maxmon);
+            }
+        }
+    }
+
+    if(auto out = getenv("BENCHSCALE_OUT"))
+        writeResults(out);
+
+    cleanup_for_valgrind();
+    return testDone();
+}
@@ -0,0 +1,476 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+/* Benchmarks of encode/decode, Value operations, and of monitor delivery over loopback.
+ *
+ * Select benchmarks by name with a glob pattern from $BENCHSUITE_FILTER (default "*").
+ * Results are printed, and also written as JSON to the file named by $BENCHSUITE_OUT, if set.
+ * eg. to compare with a previous release.
+ *
+ * Loopback traffic may be impaired to emulate a WAN.  cf. testNetImpair()
+ * $BENCHSUITE_LATENCY (seconds), $BENCHSUITE_BANDWIDTH (bytes per second), and $BENCHSUITE_LOSS (probability).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#ifdef __linux__
+#  include <unistd.h>
+#endif
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+#include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsString.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/client.h>
+#include <pvxs/data.h>
+#include <pvxs/nt.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/source.h>
+#include <pvxs/unittest.h>
+#include <pvxs/util.h>
+
+#include "dataimpl.h"
+#include "pvaproto.h"
+#include "utilpvt.h"
+
+namespace {
+using namespace pvxs;
+using namespace pvxs::impl;
+
+struct Sampler
+{
+    size_t nsamp =0;
+    double min=0.0, max=0.0;
+    double sum=0.0, sum2=0.0;
+
+    void sample(double val) {
+        if(nsamp==0u) {
+            min = max = val;
+
+        } else {
+            if(max < val)
+                max = val;
+            else if(min > val)
+                min = val;
+        }
+        sum += val;
+        sum2 += val*val;
+        nsamp++;
+    }
+
+    double mean() const {
+        return nsamp ? sum/nsamp : 0.0;
+    }
+
+    double std() const {
+        return nsamp ? sqrt(std::max(0.0, sum2/nsamp - mean()*mean())) : 0.0;
+    }
+};
+
+struct StopWatch {
+    epicsUInt64 start = epicsMonotonicGet();
+
+    // nanoseconds since previous click(), or construction
+    double click() {
+        epicsUInt64 now(epicsMonotonicGet());
+        epicsUInt64 ret = now-start;
+        start = now;
+        return double(ret);
+    }
+};
+
+struct Result {
+    std::string name, unit;
+    Sampler samp;
+};
+
+std::vector<Result> results;
+
+bool selected(const std::string& name)
+{
+    auto filter = getenv("BENCHSUITE_FILTER");
+    return !filter || !*filter || epicsStrGlobMatch(name.c_str(), filter);
+}
+
+void record(const std::string& name, const char* unit, const Sampler& samp)
+{
+    testDiag("%-32s %12.1f +- %10.1f %s  [%.1f, %.1f] N=%zu",
+             name.c_str(), samp.mean(), samp.std(), unit, samp.min, samp.max, samp.nsamp);
+    results.push_back(Result{name, unit, samp});
+}
+
+// time each call of fn(), in nanoseconds
+template<typename Fn>
+void timeEach(const std::string& name, size_t niter, Fn&& fn)
+{
+    if(!selected(name))
+        return;
+
+    Sampler S;
+    for(auto n : range(niter)) {
+        (void)n;
+        StopWatch W;
+        fn();
+        S.sample(W.click());
+    }
+    record(name, "ns", S);
+}
+
+void writeJSON(const char* fname)
+{
+    std::ofstream out(fname);
+    Restore R(out);
+    out.precision(17);
+    out<<"{\"version\": \""<<version_str()<<"\",\n \"results\": [";
+    bool first = true;
+    for(auto& res : results) {
+        out<<(first ? "\n" : ",\n")
+           <<"  {\"name\": \""<<res.name<<"\", \"unit\": \""<<res.unit<<"\""
+           <<", \"n\": "<<res.samp.nsamp
+           <<", \"mean\": "<<res.samp.mean()
+           <<", \"std\": "<<res.samp.std()
+           <<", \"min\": "<<res.samp.min
+           <<", \"max\": "<<res.samp.max<<"}";
+        first = false;
+    }
+    out<<"\n ]\n}\n";
+    if(!out.good())
+        testAbort("Unable to write %s", fname);
+}
+
+Value makeScalar()
+{
+    auto val(nt::NTScalar{TypeCode::Float64, true, true, true}.create());
+    val["value"] = 42.0;
+    val["alarm.severity"] = 1;
+    val["alarm.message"] = "HIGH";
+    val["timeStamp.secondsPastEpoch"] = 1234567890;
+    val["timeStamp.nanoseconds"] = 123456789;
+    val["display.limitHigh"] = 100.0;
+    val["display.units"] = "mm";
+    return val;
+}
+
+Value makeNDArray(size_t width, size_t height)
+{
+    auto val(nt::NTNDArray{}.create());
+    shared_array<uint8_t> pixels(width*height);
+    for(auto i : range(pixels.size()))
+        pixels[i] = uint8_t(i);
+    val["value->ubyteValue"] = pixels.freeze();
+
+    shared_array<Value> dims(2u);
+    dims[0] = val["dimension"].allocMember();
+    dims[0]["size"] = int32_t(width);
+    dims[1] = val["dimension"].allocMember();
+    dims[1]["size"] = int32_t(height);
+    val["dimension"] = dims.freeze();
+
+    val["uniqueId"] = 1;
+    val["timeStamp.secondsPastEpoch"] = 1234567890;
+    return val;
+}
+
+Value makeTable(size_t ncol, size_t nrow)
+{
+    std::vector<Member> cols;
+    shared_array<std::string> labels(ncol);
+    for(auto c : range(ncol)) {
+        labels[c] = SB()<<"col"<<c;
+        cols.push_back(Member(TypeCode::Float64A, labels[c]));
+    }
+    auto val(TypeDef(TypeCode::Struct, "epics:nt/NTTable:1.0", {
+                         Member(TypeCode::StringA, "labels"),
+                         Member(TypeCode::Struct, "value", cols),
+                     }).create());
+    val["labels"] = labels.freeze();
+    for(auto c : range(ncol)) {
+        shared_array<double> col(nrow);
+        for(auto r : range(nrow))
+            col[r] = double(r*ncol + c);
+        val["value"][std::string(SB()<<"col"<<c)] = col.freeze();
+    }
+    return val;
+}
+
+void benchCodec(const std::string& name, const Value& val, size_t niter)
+{
+    auto full(val.clone());
+    full.mark();
+
+    std::vector<uint8_t> buf;
+    size_t nbytes;
+    {
+        VectorOutBuf S(hostBE, buf);
+        to_wire_valid(S, full);
+        if(!S.good())
+            testAbort("%s encode fails", name.c_str());
+        nbytes = S.consumed();
+    }
+    buf.resize(nbytes);
+    testDiag("%s is %zu bytes", name.c_str(), nbytes);
+
+    std::vector<uint8_t> scratch(nbytes);
+    timeEach(name+"/encode", niter, [&full, &scratch]() {
+        VectorOutBuf S(hostBE, scratch);
+        to_wire_valid(S, full);
+    });
+
+    const WirePlan plan(Value::Helper::desc(full));
+    timeEach(name+"/encode_plan", niter, [&full, &scratch, &plan]() {
+        VectorOutBuf S(hostBE, scratch);
+        to_wire_valid(S, full, plan);
+    });
+
+    TypeStore ctxt;
+    auto out(val.cloneEmpty());
+    timeEach(name+"/decode", niter, [&buf, &ctxt, &out]() {
+        FixedBuf S(hostBE, buf.data(), buf.size());
+        from_wire_valid(S, ctxt, out);
+    });
+
+    timeEach(name+"/decode_plan", niter, [&buf, &ctxt, &out, &plan]() {
+        FixedBuf S(hostBE, buf.data(), buf.size());
+        from_wire_valid(S, ctxt, out, plan);
+    });
+}
+
+void benchValue(const std::string& name, const Value& val, const char* field, size_t niter)
+{
+    timeEach(name+"/lookup", niter, [&val, field]() {
+        auto fld(val[field]);
+        if(!fld)
+            testAbort("Missing %s", field);
+    });
+
+    timeEach(name+"/cloneEmpty", niter, [&val]() {
+        (void)val.cloneEmpty();
+    });
+
+    timeEach(name+"/clone", niter, [&val]() {
+        (void)val.clone();
+    });
+}
+
+/* Post nupdate updates to a SharedPV with nsub subscribers, spread over (at most) 4 TCP connections.
+ * Updates may be squashed when a subscriber falls behind, so report both
+ * the time to post each update, and the rate of updates delivered.
+ */
+void benchMonitor(const std::string& name, const Value& initial, size_t nsub, uint32_t nupdate)
+{
+    if(!selected(name+"/post") && !selected(name+"/delivered"))
+        return;
+
+    auto pv(server::SharedPV::buildReadonly());
+    pv.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("bench", pv)
+              .start());
+
+    std::vector<client::Context> clis;
+    for(auto i : range(std::min(nsub, size_t(4u)))) {
+        (void)i;
+        clis.push_back(serv.clientConfig().build());
+    }
+
+    // last userTag posted
+    std::atomic<uint32_t> target{0u};
+    std::atomic<size_t> nrx{0u}, ndone{0u};
+    epicsEvent done;
+
+    std::vector<std::shared_ptr<client::Subscription>> subs;
+    for(auto i : range(nsub)) {
+        subs.push_back(clis[i%clis.size()].monitor("bench")
+                       .maskConnected(true)
+                       .maskDisconnected(true)
+                       .event([&target, &nrx, &ndone, &done, nsub](client::Subscription& sub) {
+            while(auto val = sub.pop()) {
+                nrx++;
+                auto tag = val["timeStamp.userTag"].as<uint32_t>();
+                if(tag && tag==target.load() && ++ndone==nsub)
+                    done.signal();
+            }
+        })
+                       .exec());
+    }
+
+    // wait for initial updates
+    for(auto i : range(500u)) {
+        (void)i;
+        if(nrx.load()>=nsub)
+            break;
+        epicsThreadSleep(0.01);
+    }
+    if(nrx.load()<nsub)
+        testAbort("%s subscriptions not connected", name.c_str());
+
+    Sampler Spost, Srate;
+    uint32_t tag = 0u;
+    for(auto round : range(3u)) {
+        (void)round;
+        nrx = 0u;
+        ndone = 0u;
+        target = tag + nupdate;
+
+        StopWatch W;
+        for(auto n : range(nupdate)) {
+            (void)n;
+            auto update(initial.cloneEmpty());
+            update["timeStamp.userTag"] = ++tag;
+            StopWatch P;
+            pv.post(update);
+            Spost.sample(P.click());
+        }
+        if(!done.wait(30.0))
+            testAbort("%s timeout", name.c_str());
+        Srate.sample(nrx.load()/(W.click()*1e-9));
+    }
+
+    if(selected(name+"/post"))
+        record(name+"/post", "ns", Spost);
+    if(selected(name+"/delivered"))
+        record(name+"/delivered", "updates/s", Srate);
+
+    subs.clear();
+    clis.clear();
+    serv.stop();
+}
+
+// Accepts every channel, with no operations
+struct AcceptAll : public server::Source
+{
+    epicsMutex lock;
+    std::vector<std::unique_ptr<server::ChannelControl>> chans;
+
+    virtual void onSearch(Search& op) override final
+    {
+        for(auto& pv : op)
+            pv.claim();
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl>&& op) override final
+    {
+        epicsGuard<epicsMutex> G(lock);
+        chans.push_back(std::move(op));
+    }
+};
+
+// Resident set size in bytes, or zero if not known
+size_t residentBytes()
+{
+    size_t ret = 0u;
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t vsize = 0u, rss = 0u;
+    if(statm>>vsize>>rss)
+        ret = rss*size_t(sysconf(_SC_PAGESIZE));
+#endif
+    return ret;
+}
+
+/* Growth of process memory while nchan client Channels are connected to server channels,
+ * per channel pair.  Includes both client and server sides.
+ */
+void benchChannels(const std::string& name, size_t nchan)
+{
+    if(!selected(name) || !residentBytes())
+        return;
+
+    Sampler S;
+    for(auto round : range(3u)) {
+        auto src(std::make_shared<AcceptAll>());
+        auto serv(server::Config::isolated()
+                  .build()
+                  .addSource("bench", src)
+                  .start());
+        auto cli(serv.clientConfig().build());
+
+        std::atomic<size_t> nconn{0u};
+        epicsEvent done;
+
+        auto before(residentBytes());
+
+        std::vector<std::shared_ptr<client::Connect>> conns;
+        conns.reserve(nchan);
+        for(auto i : range(nchan)) {
+            conns.push_back(cli.connect(SB()<<"bench:"<<round<<":"<<i)
+                            .onConnect([&nconn, &done, nchan]() {
+                                if(++nconn==nchan)
+                                    done.signal();
+                            })
+                            .exec());
+        }
+        if(!done.wait(30.0))
+            testAbort("%s timeout", name.c_str());
+
+        auto after(residentBytes());
+        S.sample(after>before ? double(after-before)/nchan : 0.0);
+
+        conns.clear();
+        cli.close();
+        serv.stop();
+    }
+    record(name, "bytes", S);
+}
+
+} // namespace
+
+MAIN(benchsuite)
+{
+    testPlan(0);
+    testSetup();
+
+    {
+        NetImpairment imp;
+        if(auto env = getenv("BENCHSUITE_LATENCY"))
+            imp.latency = parseTo<double>(env);
+        if(auto env = getenv("BENCHSUITE_BANDWIDTH"))
+            imp.bandwidth = parseTo<uint64_t>(env);
+        if(auto env = getenv("BENCHSUITE_LOSS"))
+            imp.loss = parseTo<double>(env);
+        testNetImpair(imp);
+    }
+
+    const auto scalar(makeScalar());
+    const auto image(makeNDArray(1024u, 1024u));
+    const auto table(makeTable(10u, 1000u));
+
+    benchCodec("codec/NTScalar", scalar, 10000u);
+    benchCodec("codec/NTNDArray_1M", image, 100u);
+    benchCodec("codec/NTTable_10x1000", table, 1000u);
+
+    benchValue("value/NTScalar", scalar, "alarm.severity", 10000u);
+    benchValue("value/NTNDArray_1M", image, "timeStamp.nanoseconds", 1000u);
+    benchValue("value/NTTable_10x1000", table, "value.col9", 1000u);
+
+    for(size_t nsub : {1u, 10u, 100u}) {
+        benchMonitor(SB()<<"monitor/NTScalar/"<<nsub, scalar, nsub, 10000u);
+    }
+    benchMonitor("monitor/NTNDArray_1M/1", image, 1u, 100u);
+
+    benchChannels("channel/memory", 10000u);
+
+    if(auto out = getenv("BENCHSUITE_OUT"))
+        writeJSON(out);
+
+    cleanup_for_valgrind();
+    return testDone();
+}
@@ -84,6 +84,40 @@ void testBasic3()
     testEq(std::string(SB()<<M), "{63, 64, 67}");
 }
 
+void testLarge()
+{
+    testDiag("%s", __func__);
+
+    // sparse, and beyond inline storage
+    BitMask M({2, 1000, 1500}, 2000u);
+    testEq(M.size(), 2000u);
+    testEq(M.wsize(), 32u);
+
+    testEq(M.findSet(0u), 2u);
+    testEq(M.findSet(3u), 1000u);
+    testEq(M.findSet(1001u), 1500u);
+    testEq(M.findSet(1501u), M.size());
+
+    testEq(std::string(SB()<<M), "{2, 1000, 1500}");
+
+    BitMask N(std::move(M));
+    testEq(M.size(), 0u);
+    testEq(std::string(SB()<<N), "{2, 1000, 1500}");
+
+    // shrink to inline storage, then grow
+    N.resize(100u);
+    testEq(std::string(SB()<<N), "{2}");
+    N[99] = true;
+    N.resize(300u);
+    N[299] = true;
+    testEq(std::string(SB()<<N), "{2, 99, 299}");
+
+    // bits beyond size() are not reported
+    BitMask Not(!BitMask({0}, 70u));
+    testEq(Not.findSet(69u), 69u);
+    testEq(Not.findSet(70u), 70u);
+}
+
 void testOp()
 {
     testDiag("%s", __func__);
@@ -199,12 +233,13 @@ void testSer()
 
 MAIN(testbitmask)
 {
-    testPlan(76);
+    testPlan(89);
     testSetup();
     testEmpty();
     testBasic1();
     testBasic2();
     testBasic3();
+    testLarge();
     testOp();
     testExpr();
     testSer();
@@ -9,10 +9,13 @@
 #include <epicsUnitTest.h>
 
 #include <envDefs.h>
+#include <epicsThread.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/client.h>
 #include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
 #include <pvxs/log.h>
 
 #if EPICS_VERSION_INT>=VERSION_INT(3,15,6,0) && EPICS_VERSION_INT<VERSION_INT(7,0,0,0)
@@ -70,6 +73,24 @@ void testParse()
 #endif
 }
 
+void testHostNames()
+{
+    testShow()<<__func__;
+
+    // host names are kept as written, not looked up by fromEnv() or expand()
+    client::Config conf;
+    conf.addressList = {"1.2.3.4", "pvxs-test.invalid"};
+    conf.nameServers = {"pvxs-ns.invalid:5075"};
+    conf.autoAddrList = false;
+    conf.expand();
+
+    if(testEq(conf.addressList.size(), 2u)) {
+        testEq(conf.addressList[0], "1.2.3.4:5076");
+        testEq(conf.addressList[1], "pvxs-test.invalid");
+    }
+    testEq(conf.nameServers, std::vector<std::string>({"pvxs-ns.invalid:5075"}));
+}
+
 void testDefs()
 {
     testShow()<<__func__;
@@ -145,6 +166,119 @@ void testDefs()
     }
 }
 
+void testTcpOptions()
+{
+    testShow()<<__func__;
+
+    {
+        server::Config::defs_t defs;
+        server::Config conf;
+
+        defs["EPICS_PVAS_TCP_SEND_BUFFER"] = "1048576";
+        defs["EPICS_PVAS_TCP_RECV_BUFFER"] = "2097152";
+        defs["EPICS_PVAS_TCP_NODELAY"] = "YES";
+        defs["EPICS_PVAS_TCP_BUSY_POLL"] = "50";
+        defs["EPICS_PVAS_TCP_NOTSENT_LOWAT"] = "16384";
+        defs["EPICS_PVAS_TCP_KEEPALIVE"] = "YES";
+        defs["EPICS_PVAS_TCP_REUSEPORT"] = "YES";
+        defs["EPICS_PVAS_SEARCH_FILTER"] = "YES";
+        defs["EPICS_PVAS_CONN_MEM_LIMIT"] = "1000000";
+        defs["EPICS_PVA_UNIX_SOCKET_DIR"] = "/tmp";
+        conf.applyDefs(defs);
+        testEq(conf.tcpSendBuffer, 1048576u);
+        testEq(conf.tcpRecvBuffer, 2097152u);
+        testTrue(conf.tcpNoDelay);
+        testEq(conf.tcpBusyPoll, 50u);
+        testEq(conf.tcpNotSentLowat, 16384u);
+        testTrue(conf.tcpKeepAlive);
+        testTrue(conf.tcpReusePort);
+        testTrue(conf.searchFilter);
+        testEq(conf.connMemoryLimit, 1000000u);
+        testEq(conf.unixSocketDir, "/tmp");
+
+        defs.clear();
+        conf.updateDefs(defs);
+        testEq(defs["EPICS_PVAS_TCP_SEND_BUFFER"], "1048576");
+        testEq(defs["EPICS_PVAS_TCP_NODELAY"], "YES");
+        testEq(defs["EPICS_PVAS_SEARCH_FILTER"], "YES");
+        testEq(defs["EPICS_PVAS_TCP_REUSEPORT"], "YES");
+        testEq(defs["EPICS_PVAS_CONN_MEM_LIMIT"], "1000000");
+    }
+
+    {
+        client::Config::defs_t defs;
+        client::Config conf;
+
+        defs["EPICS_PVA_TCP_RECV_BUFFER"] = "4194304";
+        defs["EPICS_PVA_TCP_NODELAY"] = "YES";
+        defs["EPICS_PVA_TCP_BUSY_POLL"] = "invalid";
+        defs["EPICS_PVA_UNIX_SOCKET_DIR"] = "/tmp";
+        defs["EPICS_PVA_TCP_STREAMS"] = "3";
+        defs["EPICS_PVA_TCP_BULK_RECV_BUFFER"] = "8388608";
+        defs["EPICS_PVA_NAME_CACHE"] = "names.cache";
+        conf.applyDefs(defs);
+        testEq(conf.tcpSendBuffer, 0u);
+        testEq(conf.tcpRecvBuffer, 4194304u);
+        testTrue(conf.tcpNoDelay);
+        testEq(conf.tcpBusyPoll, 0u);
+        testEq(conf.unixSocketDir, "/tmp");
+        testEq(conf.tcpStreams, 3u);
+        testEq(conf.tcpBulkRecvBuffer, 8388608u);
+        testEq(conf.nameCacheFile, "names.cache");
+
+        defs.clear();
+        conf.updateDefs(defs);
+        testEq(defs["EPICS_PVA_TCP_RECV_BUFFER"], "4194304");
+        testEq(defs["EPICS_PVA_TCP_STREAMS"], "3");
+        testEq(defs["EPICS_PVA_NAME_CACHE"], "names.cache");
+        testEq(defs["EPICS_PVA_TCP_NOTSENT_LOWAT"], "0");
+        testEq(defs["EPICS_PVA_TCP_KEEPALIVE"], "NO");
+    }
+
+    {
+        server::Config::defs_t defs;
+        server::Config conf;
+
+        defs["EPICS_PVAS_TCP_WORKER_CPUS"] = "0-1,3";
+        defs["EPICS_PVAS_TCP_WORKER_PRIORITY"] = "150";
+        conf.applyDefs(defs);
+        testEq(conf.tcpWorkerCPUs, "0-1,3");
+        conf.expand();
+        testEq(conf.tcpWorkerPriority, unsigned(epicsThreadPriorityMax));
+
+        conf.tcpWorkerCPUs = "3-1";
+        conf.expand();
+        testEq(conf.tcpWorkerCPUs, "");
+    }
+
+    {
+        // options applied to both ends of a connection
+        auto sconf(server::Config::isolated());
+        sconf.tcpSendBuffer = sconf.tcpRecvBuffer = 1u<<18u;
+        sconf.tcpNoDelay = true;
+        sconf.tcpNotSentLowat = 1u<<14u;
+        sconf.tcpKeepAlive = true;
+        sconf.tcpWorkers = 2u;
+        sconf.tcpReusePort = true;
+        sconf.tcpWorkerCPUs = "0";
+        auto serv(sconf.build());
+        auto pv(server::SharedPV::buildReadonly());
+        pv.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+        serv.addPV("tcpopts", pv);
+        serv.start();
+
+        auto cconf(serv.clientConfig());
+        cconf.tcpSendBuffer = cconf.tcpRecvBuffer = 1u<<18u;
+        cconf.tcpNoDelay = true;
+        cconf.tcpKeepAlive = true;
+        cconf.tcpWorkerCPUs = "0";
+        auto cli(cconf.build());
+
+        auto val(cli.get("tcpopts").exec()->wait(5.0));
+        testEq(val["value"].as<int32_t>(), 42);
+    }
+}
+
 void testServerAuto()
 {
     testShow()<<__func__;
@@ -179,11 +313,13 @@ void testClientAuto()
 
 MAIN(testconfig)
 {
-    testPlan(31);
+    testPlan(67);
     testSetup();
     testDefs();
+    testTcpOptions();
     logger_config_env();
     testParse();
+    testHostNames();
     testServerAuto();
     testClientAuto();
     cleanup_for_valgrind();
@@ -47,6 +47,161 @@ void testTraverse()
     testFalse(top.equalType(top["value"]));
 }
 
+void testFieldIndex()
+{
+    testDiag("%s", __func__);
+
+    auto top = nt::NTScalar{TypeCode::Int32, true, true, true}.create();
+    auto desc = Value::Helper::desc(top);
+
+    size_t nbad = 0u;
+    for(auto& pair : desc->mlookup) {
+        if(desc->mindex.find(pair.first.data(), pair.first.size())!=pair.second) {
+            testDiag("Mis-match for '%s'", pair.first.c_str());
+            nbad++;
+        }
+    }
+    testEq(nbad, 0u);
+
+    testEq(desc->mindex.find("valu", 4u), size_t(-1));
+    testEq(desc->mindex.find("alarm.severityX", 15u), size_t(-1));
+    testEq(desc->mindex.find("alarm.severityX", 14u), desc->mlookup.at("alarm.severity"));
+}
+
+void testFieldRef()
+{
+    testDiag("%s", __func__);
+
+    auto top = nt::NTScalar{TypeCode::Int32}.create();
+    top["alarm.severity"] = 3;
+
+    auto sevr(top.index("alarm.severity"));
+    testTrue(sevr.resolved());
+    testEq(top[sevr].as<int32_t>(), 3);
+    testTrue(top[sevr].equalInst(top["alarm.severity"]));
+
+    // same type
+    auto copy(top.clone());
+    testEq(copy[sevr].as<int32_t>(), 3);
+    testTrue(copy[sevr].equalInst(copy["alarm.severity"]));
+
+    // different type falls back to lookup by name
+    auto other = nt::NTScalar{TypeCode::Float64}.create();
+    other["alarm.severity"] = 5;
+    testEq(other[sevr].as<int32_t>(), 5);
+
+    FieldRef complex(top, "value<alarm.severity");
+    testFalse(complex.resolved());
+    testEq(top[complex].as<int32_t>(), 3);
+
+    TypeDef def(TypeCode::Struct, {members::Int32("x")});
+    FieldRef x(def, "x");
+    auto val(def.create());
+    testTrue(val[x].equalInst(val["x"]));
+
+    FieldRef missing(top, "nonexistent");
+    testFalse(top[missing].valid());
+}
+
+void testValueView()
+{
+    testDiag("%s", __func__);
+
+    auto top = nt::NTScalar{TypeCode::Float64}.create();
+    top["value"] = 4.5;
+    top["alarm.severity"] = 1;
+    top.unmark();
+    auto before = Value::Helper::store(top).use_count();
+
+    ValueView V(top);
+    testTrue(V.valid());
+    testTrue(V["value"].equalInst(top["value"]));
+    testEq(V["value"].as<double>(), 4.5);
+    testEq(V["value"].as<std::string>(), "4.5");
+    testEq(V["alarm"]["severity"].as<int32_t>(), 1);
+
+    // assign and mark
+    auto sevr(top.index("alarm.severity"));
+    V[sevr] = 3;
+    testEq(top["alarm.severity"].as<int32_t>(), 3);
+    testTrue(top["alarm.severity"].isMarked(false));
+    testTrue(V[sevr].isMarked());
+    testThrows<NoConvert>([&V]() { V["value"] = "invalid"; });
+
+    // only Struct members
+    testFalse(V["nonexistent"].valid());
+    testFalse(V["value<alarm"].valid());
+    testFalse(ValueView()["value"].valid());
+    testThrows<NoField>([]() { ValueView().as<double>(); });
+
+    // same fields, in the same order, as Value iteration
+    size_t nmatch = 0u, nall = 0u;
+    auto viter(V.iall().begin());
+    for(auto fld : top.iall()) {
+        nmatch += (*viter).equalInst(fld);
+        ++viter;
+        nall++;
+    }
+    testTrue(viter==V.iall().end());
+    testEq(nmatch, nall);
+
+    nmatch = nall = 0u;
+    auto citer(V.ichildren().begin());
+    for(auto fld : top.ichildren()) {
+        nmatch += (*citer).equalInst(fld);
+        ++citer;
+        nall++;
+    }
+    testTrue(citer==V.ichildren().end());
+    testEq(nmatch, nall);
+    testEq(V.nmembers(), top.nmembers());
+
+    // no references taken
+    testEq(Value::Helper::store(top).use_count(), before);
+}
+
+void testValueViewIter()
+{
+    testDiag("%s", __func__);
+
+    auto top = nt::NTScalar{TypeCode::Float64, true}.create();
+    top["value"] = 1.0;
+    top["alarm"].mark();
+    top["display.units"] = "mm";
+
+    // names from the flattened order, the same as nameOf()
+    ValueView V(top);
+    size_t nall = 0u, nname = 0u;
+    auto it(V.iall().begin());
+    for(auto fld : top.iall()) {
+        nname += it.name()==top.nameOf(fld);
+        ++it;
+        nall++;
+    }
+    testEq(nname, nall);
+    testEq(nall, Value::Helper::desc(top)->size()-1u);
+
+    std::string children, expectChildren;
+    for(auto fld : top.ichildren())
+        expectChildren += top.nameOf(fld)+" ";
+    for(auto cit(V.ichildren().begin()), end(V.ichildren().end()); cit!=end; ++cit)
+        children += cit.name()+" ";
+    testEq(children, expectChildren);
+
+    // marked fields, and all descendants of a marked Struct
+    std::string expect, actual;
+    for(auto fld : top.imarked())
+        expect += top.nameOf(fld)+" ";
+    for(auto mit(V.imarked().begin()), end(V.imarked().end()); mit!=end; ++mit)
+        actual += mit.name()+" ";
+    testEq(actual, expect);
+    testTrue(actual.find("alarm.severity ")!=std::string::npos);
+    testTrue(actual.find("display.units ")!=std::string::npos);
+
+    top.unmark();
+    testTrue(V.imarked().begin()==V.imarked().end());
+}
+
 void testAssign()
 {
     testDiag("%s", __func__);
@@ -441,13 +596,276 @@ void testClear()
     testFalse(val.isMarked(true, true));
 }
 
+void testCloneString()
+{
+    testShow()<<__func__;
+
+    auto val(nt::NTScalar{TypeCode::Float64, true}.create());
+    val["display.units"] = "furlongs per fortnight";
+    val["display.description"] = "speed";
+
+    auto units = [](const Value& v) -> const impl::CowString& {
+        return Value::Helper::store_ptr(v["display.units"])->as<impl::CowString>();
+    };
+
+    auto copy(val.clone());
+    // storage is shared, not copied
+    testEq(&units(copy).str(), &units(val).str());
+    testEq(copy["display.units"].as<std::string>(), "furlongs per fortnight");
+
+    // modification does not affect other copies
+    copy["display.units"] = "m/s";
+    testEq(copy["display.units"].as<std::string>(), "m/s");
+    testEq(val["display.units"].as<std::string>(), "furlongs per fortnight");
+    testFalse(units(val).shared());
+
+    // assign() between Values also shares
+    auto other(val.cloneEmpty());
+    other.assign(val);
+    testEq(&units(other).str(), &units(val).str());
+    testEq(other["display.description"].as<std::string>(), "speed");
+
+    // conversion from a shared string
+    auto conv(TypeDef(TypeCode::Struct, {members::Int32("value")}).create());
+    auto src(TypeDef(TypeCode::Struct, {members::String("value")}).create());
+    src["value"] = "42";
+    conv.assign(src);
+    testEq(conv["value"].as<int32_t>(), 42);
+}
+
+void testCloneMarked()
+{
+    testShow()<<__func__;
+
+    auto val(nt::NTScalar{TypeCode::Float64A, true}.create());
+    val["display.units"] = "V";
+    val["value"] = shared_array<const double>({1.0, 2.0});
+    val.unmark();
+
+    shared_array<const double> arr({3.0, 4.0, 5.0});
+    val["value"] = arr;
+    val["alarm.severity"] = 2;
+
+    // only marked fields are copied
+    auto copy(val.clone());
+    testTrue(copy["value"].isMarked());
+    testTrue(copy["alarm.severity"].isMarked());
+    testFalse(copy["display.units"].isMarked());
+    testEq(copy["display.units"].as<std::string>(), "");
+    testEq(copy["alarm.severity"].as<int32_t>(), 2);
+    // array storage is shared
+    testEq(copy["value"].as<shared_array<const double>>().data(), arr.data());
+}
+
+void testAssignMarked()
+{
+    testShow()<<__func__;
+
+    auto current(nt::NTScalar{TypeCode::Float64, true}.create());
+    current["value"] = 1.0;
+    current["display.units"] = "V";
+
+    auto update(current.cloneEmpty());
+    update["value"] = 2.0;
+
+    auto copy(update.cloneEmpty());
+    Value::Helper::assignMarked(update, current, copy);
+
+    testEq(current["value"].as<double>(), 2.0);
+    testEq(current["display.units"].as<std::string>(), "V");
+    testEq(copy["value"].as<double>(), 2.0);
+    testTrue(copy["value"].isMarked());
+    testFalse(copy["display.units"].isMarked());
+}
+
+void testAssignSame()
+{
+    testShow()<<__func__;
+
+    auto src(TypeDef(TypeCode::Struct, {
+                         members::Struct("s", {
+                             members::Int32("a"),
+                             members::String("b"),
+                         }),
+                         members::Union("u", {
+                             members::Float64("x"),
+                         }),
+                         members::Any("y"),
+                         members::Float32("f"),
+                     }).create());
+    src["s.a"] = 4;
+    src["s.b"] = "hello";
+    src["u->x"] = 1.5;
+    src["y"] = int32_t(7);
+    src["f"] = 2.5;
+    src.unmark();
+    src["s"].mark(); // entire sub-struct
+    src["u"].mark();
+    src["y"].mark();
+
+    auto dst(src.cloneEmpty());
+    dst.assign(src);
+    testEq(dst["s.a"].as<int32_t>(), 4);
+    testEq(dst["s.b"].as<std::string>(), "hello");
+    testTrue(dst["s.b"].isMarked(false));
+    testEq(dst["u->x"].as<double>(), 1.5);
+    testEq(dst["y"].as<int32_t>(), 7);
+    testFalse(dst["f"].isMarked());
+    testEq(dst["f"].as<double>(), 0.0);
+    // union member re-built, not shared
+    testFalse(dst["u"].as<Value>().equalInst(src["u"].as<Value>()));
+}
+
+void testFreeze()
+{
+    testDiag("%s", __func__);
+
+    auto val = nt::NTScalar{TypeCode::Float64}.create();
+    val["value"] = 4.5;
+    val["alarm.message"] = "hello";
+    val["alarm.message"].unmark();
+
+    {
+        Value alias(val);
+        testThrows<std::logic_error>([&val]() { val.freeze(); });
+        testThrows<std::logic_error>([&alias]() { alias["value"].freeze(); });
+    }
+
+    const Value snap(val.freeze());
+    testTrue(snap.frozen());
+    testTrue(snap.clone().equalInst(snap))<<" clone() does not copy";
+
+    // read through const
+    testEq(snap["value"].as<double>(), 4.5);
+    auto fld(snap["value"]);
+    testThrows<std::logic_error>([&fld]() { fld = 1.0; });
+    testThrows<std::logic_error>([&fld]() { ScalarRef<double> ref(fld); });
+
+    // write through a clone
+    Value mine(snap.clone());
+    mine["value"] = 5.5;
+    testFalse(mine.equalInst(snap));
+    testFalse(mine.frozen());
+    testEq(mine["value"].as<double>(), 5.5);
+    testEq(snap["value"].as<double>(), 4.5);
+    // unmarked fields also copied, and marks preserved
+    testEq(mine["alarm.message"].as<std::string>(), "hello");
+    testFalse(mine["alarm.message"].isMarked(false));
+    testTrue(mine["value"].isMarked(false));
+}
+
+void testScalarRef()
+{
+    testShow()<<__func__;
+
+    auto top(nt::NTScalar{TypeCode::Float32, true}.create());
+
+    struct View {
+        ScalarRef<float> value;
+        ScalarRef<int32_t> severity;
+        ScalarRef<bool> active;
+        explicit View(const Value& top)
+            :value(top["value"])
+            ,severity(top["alarm.severity"])
+        {}
+    } V(top);
+
+    testFalse(V.active);
+    testFalse(top["value"].isMarked());
+    V.value = 1.5f;
+    V.severity = 2;
+    testTrue(top["value"].isMarked());
+    testEq(top["value"].as<double>(), 1.5);
+    testEq(top["alarm.severity"].as<int32_t>(), 2);
+
+    top["value"] = 2.5;
+    testEq(float(V.value), 2.5f);
+    testEq(V.severity.get(), 2);
+
+    testThrows<NoConvert>([&top]() {
+        ScalarRef<double> wrong(top["value"]); // Float32
+    });
+    testThrows<NoField>([&top]() {
+        ScalarRef<double> missing(top["nosuch"]);
+    });
+}
+
+void testMarkChanged()
+{
+    testShow()<<__func__;
+
+    auto prev(nt::NTScalar{TypeCode::Float64A, true}.create());
+    prev["value"] = shared_array<const double>({1.0, 2.0});
+    prev["display.units"] = "V";
+    prev["alarm.severity"] = 1;
+
+    auto cur(prev.clone());
+    testFalse(cur.markChanged(prev));
+    testFalse(cur.isMarked(true, true));
+
+    // equal contents, different storage
+    cur["value"] = shared_array<const double>({1.0, 2.0});
+    cur["display.units"] = "mV";
+    testTrue(cur.markChanged(prev));
+    testFalse(cur["value"].isMarked());
+    testTrue(cur["display.units"].isMarked());
+    testFalse(cur["display"].isMarked(false));
+    testFalse(cur["alarm.severity"].isMarked());
+
+    // only compare marked fields
+    cur.unmark(false, true);
+    cur["value"] = shared_array<const double>({1.0, 3.0});
+    cur["alarm.severity"] = 1;
+    testTrue(cur.markChanged(prev, true));
+    testTrue(cur["value"].isMarked());
+    testFalse(cur["alarm.severity"].isMarked());
+    testFalse(cur["display.units"].isMarked());
+
+    auto other(nt::NTScalar{TypeCode::Int32}.create());
+    testThrows<std::logic_error>([&cur, &other]() {
+        cur.markChanged(other);
+    });
+}
+
+void testMarkChangedUnion()
+{
+    testShow()<<__func__;
+
+    auto prev(TypeDef(TypeCode::Struct, {
+                          members::Union("u", {
+                              members::Int32("a"),
+                              members::Int32("b"),
+                          }),
+                          members::Any("x"),
+                      }).create());
+    prev["u->a"] = 1;
+    prev["x"] = 1.5;
+
+    auto cur(prev.cloneEmpty());
+    cur["u->b"] = 1; // same type and value, but different selection
+    cur["x"] = 1.5;
+    testTrue(cur.markChanged(prev));
+    testTrue(cur["u"].isMarked());
+    testFalse(cur["x"].isMarked());
+
+    cur["x"] = int32_t(1); // Any with different type
+    cur["u->a"] = 1;
+    testTrue(cur.markChanged(prev));
+    testFalse(cur["u"].isMarked());
+    testTrue(cur["x"].isMarked());
+}
+
 } // namespace
 
 MAIN(testdata)
 {
-    testPlan(148);
+    testPlan(256);
     testSetup();
     testTraverse();
+    testFieldIndex();
+    testFieldRef();
+    testValueView();
+    testValueViewIter();
     testAssign();
     testAssignArray();
     testAssignUnion();
@@ -455,6 +873,14 @@ MAIN(testdata)
     testName();
     testIterStruct();
     testIterUnion();
+    testCloneString();
+    testCloneMarked();
+    testAssignMarked();
+    testAssignSame();
+    testFreeze();
+    testScalarRef();
+    testMarkChanged();
+    testMarkChangedUnion();
 
     testConvertScalar<bool, bool>(true, true);
     testConvertScalar<bool, uint32_t>(true, 1u);
@@ -22,11 +22,12 @@
 namespace {
 using namespace pvxs;
 
-void testEndian(bool srvBE, bool cliBE)
+void testEndian(bool srvBE, bool cliBE, bool peerOrder=false)
 {
-    testDiag("%s(%c, %c)", __func__,
+    testDiag("%s(%c, %c%s)", __func__,
              srvBE ? 'B' : 'L',
-             cliBE ? 'B' : 'L');
+             cliBE ? 'B' : 'L',
+             peerOrder ? ", peer" : "");
 
     const auto proto = nt::NTScalar{TypeCode::UInt32}
             .create()
@@ -36,7 +37,9 @@ void testEndian(bool srvBE, bool cliBE)
 
     mbox.open(proto);
 
-    auto srv = server::Config::isolated()
+    auto conf(server::Config::isolated());
+    conf.peerByteOrder = peerOrder;
+    auto srv = conf
             .overrideSendBE(srvBE)
             .build()
             .addPV("dut", mbox)
@@ -55,19 +58,31 @@ void testEndian(bool srvBE, bool cliBE)
     }catch(std::exception& e){
         testFail("Unexpected exception: %s\n", e.what());
     }
+
+    // with peerByteOrder, the server adopts the byte order of the client
+    auto rpt(srv.report(false));
+    if(testEq(rpt.connections.size(), 1u)) {
+        testEq(rpt.connections.front().sendBE, peerOrder ? cliBE : srvBE);
+    } else {
+        testSkip(1, "No connection");
+    }
 }
 
 } // namespace
 
 MAIN(testendian)
 {
-    testPlan(4);
+    testPlan(24);
     testSetup();
     logger_config_env();
     testEndian(false, false);
     testEndian(false, true);
     testEndian(true, false);
     testEndian(true, true);
+    testEndian(false, false, true);
+    testEndian(false, true, true);
+    testEndian(true, false, true);
+    testEndian(true, true, true);
     cleanup_for_valgrind();
     return testDone();
 }
@@ -142,15 +142,89 @@ void test_fill_evbuf()
     testEq(evbuffer_get_length(buf.get()), 0u);
 }
 
+void test_mfunction()
+{
+    testDiag("%s", __func__);
+
+    auto small(std::make_shared<int>(0));
+    {
+        // captures one pointer, stored inline
+        mfunction fn([small]() { (*small)++; });
+        testEq(small.use_count(), 2);
+
+        mfunction other(std::move(fn));
+        testFalse(!!fn);
+        testEq(small.use_count(), 2);
+        other();
+        testEq(*small, 1);
+
+        fn = std::move(other);
+        fn();
+        testEq(*small, 2);
+    }
+    testEq(small.use_count(), 1);
+
+    auto big(std::make_shared<int>(0));
+    {
+        // too large to store inline
+        char pad[128] = "";
+        mfunction fn([big, pad]() { (*big) += 1 + pad[0]; });
+        testEq(big.use_count(), 2);
+
+        mfunction other(std::move(fn));
+        other();
+        testEq(*big, 1);
+        testEq(big.use_count(), 2);
+
+        other = mfunction([small]() {});
+        testEq(big.use_count(), 1);
+        testEq(small.use_count(), 2);
+    }
+    testEq(small.use_count(), 1);
+}
+
+void test_dispatch_order()
+{
+    testDiag("%s", __func__);
+
+    evbase base("TEST");
+
+    // more than fit in the work queue ring at once
+    constexpr unsigned N = 5000u;
+
+    unsigned expect = 0u;
+    bool inorder = true;
+
+    base.call([&base, &expect, &inorder]() {
+        // from the worker, so that none run until this call() returns
+        for(unsigned i=0u; i<N; i++) {
+            base.dispatch([i, &expect, &inorder]() {
+                inorder &= i==expect++;
+            });
+        }
+    });
+    for(unsigned i=N; i<2u*N; i++) {
+        base.dispatch([i, &expect, &inorder]() {
+            inorder &= i==expect++;
+        });
+    }
+    base.sync();
+
+    testEq(expect, 2u*N);
+    testTrue(inorder);
+}
+
 } // namespace
 
 MAIN(testev)
 {
     SockAttach attach;
-    testPlan(20);
+    testPlan(34);
     testSetup();
     test_call();
     test_fill_evbuf();
+    test_mfunction();
+    test_dispatch_order();
     cleanup_for_valgrind();
     return testDone();
 }
@@ -6,12 +6,21 @@
 #define PVXS_ENABLE_EXPERT_API
 
 #include <atomic>
+#include <fstream>
+#include <sstream>
+
+#include <stdio.h>
+#include <string.h>
 
 #include <testMain.h>
 
 #include <epicsUnitTest.h>
 
 #include <epicsEvent.h>
+#include <epicsGuard.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/log.h>
@@ -21,6 +30,7 @@
 #include <pvxs/source.h>
 #include <pvxs/nt.h>
 #include "evhelper.h"
+#include "conn.h"
 
 namespace {
 using namespace pvxs;
@@ -118,6 +128,8 @@ struct Tester {
 
         auto sreport(serv.report());
         auto creport(cli.report());
+        auto ssummary(serv.report(false, false));
+        auto csummary(cli.report(false, false));
 
         testDiag("Stop server");
         serv.stop();
@@ -132,6 +144,7 @@ struct Tester {
                 auto& conn = report.connections.front();
                 testNotEq(conn.tx, 0u);
                 testNotEq(conn.rx, 0u);
+                testEq(conn.nChannels, 1u);
                 if(testEq(conn.channels.size(), 1u)) {
                     auto& chan = conn.channels.front();
                     testNotEq(chan.tx, 0u);
@@ -142,6 +155,32 @@ struct Tester {
         };
         checkReport(sreport);
         checkReport(creport);
+        auto checkSummary = [](const impl::Report& report) {
+            if(testEq(report.connections.size(), 1u)) {
+                auto& conn = report.connections.front();
+                testEq(conn.nChannels, 1u);
+                testTrue(conn.channels.empty());
+            } else {
+                testSkip(2, "no connection");
+            }
+        };
+        checkSummary(ssummary);
+        checkSummary(csummary);
+        // the one GET above, through the builtin Source
+        testEq(sreport.latency["__builtin"].get.total(), 1u);
+        testEq(creport.latency[""].get.total(), 1u);
+        // channel created by, and GET INIT and EXEC handled through, the builtin Source
+        testEq(sreport.sourceTime["__builtin"].order, -1);
+        testOk1(sreport.sourceTime["__builtin"].nCreate>=1u);
+        testEq(sreport.sourceTime["__builtin"].nOp, 2u);
+        // event loop workers, which have run some queued work
+        testNotEq(sreport.workers.size(), 0u);
+        size_t nWork = 0u;
+        for(auto& worker : creport.workers)
+            nWork += worker.nWork;
+        testNotEq(nWork, 0u);
+        testNotEq(creport.searchSent, 0u);
+        testEq(creport.searchPending, 0u);
     }
 
     void testWaiter()
@@ -233,6 +272,39 @@ struct Tester {
         testOk1(!!onLD.load());
     }
 
+    void infoCache()
+    {
+        testShow()<<__func__;
+
+        mbox.open(initial);
+        serv.start();
+
+        epicsEvent discd;
+        auto ctor(cli.connect("mailbox")
+                  .onDisconnect([&discd]() {
+                      discd.signal();
+                  })
+                  .exec());
+
+        auto op(cli.info("mailbox").exec());
+        cli.hurryUp();
+        auto first(op->wait(5.0));
+
+        // from Channel cache
+        auto second(cli.info("mailbox").exec()->wait(5.0));
+        testTrue(second.equalType(first));
+        testFalse(second.equalInst(first));
+        testEq(serv.report().sourceTime["__builtin"].nOp, 1u)<<" one GET_FIELD to server";
+
+        // close() disconnects the Channel, and forgets the cached type
+        mbox.close();
+        testTrue(discd.wait(5.0));
+        mbox.open(nt::NTScalar{TypeCode::String}.create());
+
+        auto third(cli.info("mailbox").exec()->wait(5.0));
+        testEq(third["value"].type(), TypeCode::String);
+    }
+
     void timeout()
     {
         testShow()<<__func__;
@@ -367,6 +439,51 @@ struct Tester {
         testOk1(done.wait(5.0));
     }
 
+    void pipelineExec()
+    {
+        testShow()<<__func__;
+
+        mbox.open(initial);
+        serv.start();
+
+        auto op = cli.get("mailbox")
+                .autoExec(false)
+                .execPipeline(4u)
+                .exec();
+
+        // queued before INIT completes, then sent four at a time
+        const size_t nexec = 10u;
+        std::atomic<size_t> ndone{0u}, nbad{0u};
+        epicsEvent done;
+        for(auto i : range(nexec)) {
+            op->reExecGet([i, &ndone, &nbad, &done](client::Result&& result) {
+                if(!result() || ndone.load()!=i)
+                    nbad++;
+                if(++ndone==nexec)
+                    done.signal();
+            });
+        }
+
+        testOk1(done.wait(5.0));
+        testEq(nbad.load(), 0u);
+    }
+
+    void getMany()
+    {
+        testShow()<<__func__;
+
+        mbox.open(initial);
+        serv.start();
+
+        testEq(cli.getMany({}, 5.0).size(), 0u);
+
+        auto results(cli.getMany({"mailbox", "mailbox"}, 5.0, "field(value)"));
+        testEq(results.size(), 2u);
+        for(auto& result : results) {
+            testEq(result()["value"].as<int32_t>(), 42);
+        }
+    }
+
     void badRequest()
     {
         testShow()<<__func__;
@@ -512,11 +629,903 @@ void testError(bool phase)
     }
 }
 
+// reports the fields selected by each GET through the userTag of the reply
+struct SelectSource : public server::Source
+{
+    const Value type;
+    SelectSource()
+        :type(nt::NTScalar{TypeCode::Float64, true}.create())
+    {}
+
+    virtual void onSearch(Search &op) override final
+    {
+        for(auto& name : op) {
+            name.claim();
+        }
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final
+    {
+        auto chan = std::move(op);
+
+        chan->onOp([this](std::unique_ptr<server::ConnectOp>&& op) {
+            auto sel(op->selected(type));
+            op->onGet([this, sel](std::unique_ptr<server::ExecOp>&& op) {
+                auto val(type.cloneEmpty());
+                val["value"] = 1.0;
+                val["timeStamp.userTag"] = (sel["value"].isMarked(true, true) ? 1 : 0)
+                                           | (sel["display"].isMarked(true, true) ? 2 : 0);
+                op->reply(val);
+            });
+            op->connect(type);
+        });
+    }
+};
+
+void testSelected()
+{
+    testShow()<<__func__;
+
+    auto serv = server::Config::isolated()
+            .build()
+            .addSource("sel", std::make_shared<SelectSource>())
+            .start();
+
+    auto cli = serv.clientConfig().build();
+
+    auto val(cli.get("sel").exec()->wait(5.0));
+    testEq(val["timeStamp.userTag"].as<int32_t>(), 3);
+
+    val = cli.get("sel").field("value").field("timeStamp").exec()->wait(5.0);
+    testEq(val["timeStamp.userTag"].as<int32_t>(), 1);
+}
+
+// accepts names beginning "many:", through onCreateMany()
+struct ManySource : public server::Source
+{
+    const Value type;
+    std::atomic<size_t> ncalls{0u}, naccepted{0u};
+    ManySource()
+        :type(nt::NTScalar{TypeCode::Int32}.create())
+    {}
+
+    virtual void onSearch(Search &op) override final
+    {
+        for(auto& name : op) {
+            if(strncmp(name.name(), "many:", 5)==0)
+                name.claim();
+        }
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final
+    {
+        testFail("Unexpected onCreate(%s)", op->name().c_str());
+    }
+    virtual void onCreateMany(std::vector<std::unique_ptr<server::ChannelControl>>& ops) override final
+    {
+        ncalls++;
+        for(auto& op : ops) {
+            if(!op || op->name().compare(0u, 5u, "many:")!=0)
+                continue; // leave for next Source
+
+            auto chan = std::move(op);
+            naccepted++;
+
+            chan->onOp([this](std::unique_ptr<server::ConnectOp>&& op) {
+                op->onGet([this](std::unique_ptr<server::ExecOp>&& op) {
+                    auto val(type.cloneEmpty());
+                    val["value"] = 42;
+                    op->reply(val);
+                });
+                op->connect(type);
+            });
+        }
+    }
+};
+
+void testCreateMany()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 43;
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+    auto other(server::StaticSource::build());
+    other.add("other", mbox);
+
+    auto src(std::make_shared<ManySource>());
+    auto serv = server::Config::isolated()
+            .build()
+            .addSource("many", src, 0)
+            .addSource("other", other.source(), 1)
+            .start();
+
+    auto cli = serv.clientConfig().build();
+
+    std::vector<std::shared_ptr<client::Operation>> ops;
+    for(auto i : range(8u)) {
+        ops.push_back(cli.get(SB()<<"many:"<<i).exec());
+    }
+    ops.push_back(cli.get("other").exec());
+
+    cli.hurryUp();
+
+    for(auto i : range(8u)) {
+        testEq(ops[i]->wait(5.0)["value"].as<int32_t>(), 42);
+    }
+    // offered to, and left by, ManySource
+    testEq(ops[8]->wait(5.0)["value"].as<int32_t>(), 43);
+
+    testEq(src->naccepted.load(), 8u);
+    size_t ncalls = src->ncalls.load();
+    testOk(ncalls>=1u && ncalls<=9u, "onCreateMany() called %zu times", ncalls);
+}
+
+void testWorkers()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 42;
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto conf(server::Config::isolated());
+    conf.tcpWorkers = 3u;
+    auto serv = conf.build()
+            .addPV("mailbox", mbox)
+            .start();
+    testEq(serv.config().tcpWorkers, 3u);
+
+    // each client Context opens a separate TCP connection
+    std::vector<client::Context> clis;
+    for(auto i : range(4u)) {
+        (void)i;
+        clis.push_back(serv.clientConfig().build());
+    }
+
+    for(auto& cli : clis) {
+        auto val = cli.get("mailbox").exec()->wait(5.0);
+        testEq(val["value"].as<int32_t>(), 42);
+    }
+
+    testEq(serv.report(false).connections.size(), clis.size());
+    {
+        std::ostringstream strm;
+        Detailed D(strm, 3);
+        strm<<serv;
+        testShow()<<strm.str();
+    }
+
+    clis.clear();
+    serv.stop();
+}
+
+void testSearchWorkers()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 42;
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto conf(server::Config::isolated());
+    conf.searchWorkers = 3u;
+    auto serv = conf.build()
+            .addPV("mailbox", mbox)
+            .start();
+    testEq(serv.config().searchWorkers, 3u);
+
+    // each client Context searches from a different reply address
+    std::vector<client::Context> clis;
+    for(auto i : range(4u)) {
+        (void)i;
+        clis.push_back(serv.clientConfig().build());
+    }
+
+    for(auto& cli : clis) {
+        auto val = cli.get("mailbox").exec()->wait(5.0);
+        testEq(val["value"].as<int32_t>(), 42);
+    }
+
+    clis.clear();
+    serv.stop();
+}
+
+void testShareContext()
+{
+    testShow()<<__func__;
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+
+    auto serv = server::Config::isolated().build()
+            .addPV("mailbox", mbox)
+            .start();
+
+    auto conf(serv.clientConfig());
+    conf.shareContext = true;
+    auto cli1(conf.build());
+    auto cli2(conf.build());
+
+    testEq(cli1.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+    testEq(cli2.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+    // one connection for both
+    testEq(serv.report(false).connections.size(), 1u);
+
+    // a closed Context is not shared
+    cli1.close();
+    auto cli3(conf.build());
+    testEq(cli3.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+
+    cli3.close();
+    serv.stop();
+}
+
+void testBulk()
+{
+    testShow()<<__func__;
+
+    auto mbox(server::SharedPV::buildMailbox());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+
+    auto serv = server::Config::isolated().build()
+            .addPV("mailbox", mbox)
+            .start();
+
+    auto cconf(serv.clientConfig());
+    cconf.tcpBulkRecvBuffer = 1u<<20u;
+    auto cli(cconf.build());
+
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+    testEq(serv.report(false).connections.size(), 1u);
+
+    // bulk operations connect separately
+    testEq(cli.get("mailbox").bulk().exec()->wait(5.0)["value"].as<int32_t>(), 42);
+    testEq(serv.report(false).connections.size(), 2u);
+    testEq(cli.report(false).connections.size(), 2u);
+
+    cli.close();
+    serv.stop();
+}
+
+void testFuture()
+{
+    testShow()<<__func__;
+
+    auto mbox(server::SharedPV::buildMailbox());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+
+    auto serv = server::Config::isolated().build()
+            .addPV("mailbox", mbox)
+            .start();
+
+    auto cli(serv.clientConfig().build());
+
+    std::vector<client::Future> gets;
+    for(size_t i=0; i<4u; i++)
+        gets.push_back(cli.get("mailbox").execFuture());
+    // mailbox does not implement RPC
+    gets.push_back(cli.rpc("mailbox").execFuture());
+
+    auto plus1(gets.front().then([](client::Result&& result) -> Value {
+        auto val(result());
+        val["value"] = val["value"].as<int32_t>()+1;
+        return val;
+    }));
+
+    testEq(plus1.wait(5.0)()["value"].as<int32_t>(), 43);
+    testEq(client::whenAny({gets[1], gets[2]}).wait(5.0)()["value"].as<int32_t>(), 42);
+
+    auto all(client::whenAll(gets));
+    all.wait(5.0);
+    testTrue(all.ready());
+    testEq(gets[3].wait(0.0)()["value"].as<int32_t>(), 42);
+    testTrue(gets.back().wait(0.0).error())<<" RPC error";
+
+    testTrue(client::whenAll({}).ready());
+
+    cli.close();
+    serv.stop();
+}
+
+void testNameCache()
+{
+    testShow()<<__func__;
+
+    const char fname[] = "testget-names.cache";
+    (void)remove(fname);
+
+    auto mbox(server::SharedPV::buildMailbox());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+
+    auto serv = server::Config::isolated().build()
+            .addPV("mailbox", mbox)
+            .start();
+
+    auto conf(serv.clientConfig());
+    conf.nameCacheFile = fname;
+
+    auto readEntry = [&fname]() -> std::string {
+        std::ifstream in(fname);
+        std::string line;
+        while(std::getline(in, line)) {
+            if(!line.empty() && line[0]!='#')
+                break;
+        }
+        return line;
+    };
+
+    {
+        auto cli(conf.build());
+        testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+        cli.close();
+    }
+    auto learned(readEntry());
+    testTrue(learned.find("mailbox ")==0u)<<" "<<learned;
+
+    // a stale entry, where nothing listens, falls back to search
+    {
+        std::ofstream out(fname);
+        out<<"mailbox 0x000000000000000000000000 127.0.0.1:1\n";
+    }
+    {
+        auto cli(conf.build());
+        testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+        cli.close();
+    }
+    testEq(readEntry(), learned);
+
+    serv.stop();
+    (void)remove(fname);
+}
+
+void testInProcess()
+{
+    testShow()<<__func__;
+
+    auto mbox(server::SharedPV::buildMailbox());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+
+    auto serv = server::Config::isolated().build()
+            .addPV("mailbox", mbox)
+            .start();
+
+    auto conf(serv.clientConfig());
+    conf.inProcess = true;
+    auto cli(conf.build());
+
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+    cli.put("mailbox").set("value", 43).exec()->wait(5.0);
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 43);
+
+    auto conns(serv.report(false).connections);
+    testEq(conns.size(), 1u);
+    // a local peer has no port number
+    if(!conns.empty())
+        testStrEq(conns.front().peer, "127.0.0.1");
+    else
+        testFail("no connection");
+
+    cli.close();
+    serv.stop();
+}
+
+void testUnixSocket()
+{
+    testShow()<<__func__;
+#ifdef PVXS_HAVE_UNIX_SOCKET
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+
+    auto conf(server::Config::isolated());
+    conf.unixSocketDir = ".";
+    auto serv = conf.build()
+            .addPV("mailbox", mbox)
+            .start();
+
+    auto cli(serv.clientConfig().build());
+
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+
+    auto conns(serv.report(false).connections);
+    testEq(conns.size(), 1u);
+    if(!conns.empty() && conns.front().credentials)
+        testStrEq(conns.front().credentials->iface,
+                  std::string(SB()<<"./pvxs-"<<serv.config().tcp_port<<".sock"));
+    else
+        testFail("no connection");
+
+    cli.close();
+    serv.stop();
+#else
+    testSkip(3, "No Unix domain sockets");
+#endif
+}
+
+// runs queued work on its own thread
+struct ExecWorker : public epicsThreadRunable
+{
+    MPMCFIFO<std::function<void()>> Q;
+    epicsThread worker;
+    ExecWorker()
+        :worker(*this, "executor", epicsThreadGetStackSize(epicsThreadStackSmall))
+    {
+        worker.start();
+    }
+    ~ExecWorker() {
+        Q.push(nullptr);
+        worker.exitWait();
+    }
+
+    void run() override final {
+        while(auto work = Q.pop())
+            work();
+    }
+
+    client::Executor executor() {
+        return [this](std::function<void()>&& fn) {
+            Q.push(std::move(fn));
+        };
+    }
+};
+
+void testExecutor()
+{
+    testShow()<<__func__;
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+
+    auto serv = server::Config::isolated().build()
+            .addPV("mailbox", mbox)
+            .start();
+    auto cli(serv.clientConfig().build());
+
+    ExecWorker exec;
+    epicsEvent done;
+    std::atomic<bool> onWorker{false};
+    int32_t value = 0;
+
+    auto op(cli.get("mailbox")
+            .executor(exec.executor())
+            .result([&](client::Result&& result) {
+                onWorker = exec.worker.isCurrentThread();
+                value = result()["value"].as<int32_t>();
+                done.signal();
+            })
+            .exec());
+
+    testTrue(done.wait(5.0))<<" result() called";
+    testTrue(onWorker.load())<<" on executor thread";
+    testEq(value, 42);
+
+    op.reset();
+    cli.close();
+    serv.stop();
+}
+
+void testClientWorkers()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    auto serv = server::Config::isolated().build();
+
+    std::vector<server::SharedPV> pvs;
+    for(auto i : range(8)) {
+        pvs.push_back(server::SharedPV::buildReadonly());
+        initial["value"] = i;
+        pvs.back().open(initial.clone());
+        serv.addPV(SB()<<"pv"<<i, pvs.back());
+    }
+    serv.start();
+
+    auto conf(serv.clientConfig());
+    conf.tcpWorkers = 3u;
+    auto cli(conf.build());
+    testEq(cli.config().tcpWorkers, 3u);
+
+    std::vector<std::shared_ptr<client::Operation>> ops;
+    for(auto i : range(pvs.size())) {
+        ops.push_back(cli.get(SB()<<"pv"<<i).exec());
+    }
+
+    bool ok = true;
+    for(auto i : range(ops.size())) {
+        auto val = ops[i]->wait(5.0);
+        ok &= val["value"].as<size_t>()==i;
+    }
+    testTrue(ok)<<" all values received";
+
+    // each worker has its own connection to the server
+    auto rpt(cli.report(false));
+    size_t nchan = 0u;
+    for(auto& conn : rpt.connections)
+        nchan += conn.channels.size();
+    testEq(nchan, pvs.size());
+    testOk(rpt.connections.size()>1u && rpt.connections.size()<=3u,
+           "connections %zu", rpt.connections.size());
+
+    ops.clear();
+    cli.close();
+    serv.stop();
+}
+
+void testIndexedSource()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    auto serv = server::Config::isolated().build();
+
+    auto src1(server::StaticSource::build());
+    auto src2(server::StaticSource::build());
+    serv.addSource("src1", src1.source())
+        .addSource("src2", src2.source())
+        .start();
+
+    auto cli(serv.clientConfig().build());
+
+    // names added to a StaticSource after it is added to a Server
+    auto pv1(server::SharedPV::buildReadonly());
+    initial["value"] = 1;
+    pv1.open(initial.clone());
+    src1.add("pv", pv1);
+    src2.add("pv", pv1);
+
+    testEq(cli.get("pv").exec()->wait(5.0)["value"].as<int32_t>(), 1);
+
+    // still claimed through src2
+    src1.remove("pv");
+    cli.cacheClear("pv");
+    testEq(cli.get("pv").exec()->wait(5.0)["value"].as<int32_t>(), 1);
+
+    // no longer claimed after removing src2 from the Server
+    serv.removeSource("src2");
+    cli.cacheClear("pv");
+
+    epicsEvent done;
+    auto op = cli.get("pv")
+            .result([&done](client::Result&&) {
+                done.signal();
+            })
+            .exec();
+
+    cli.hurryUp();
+
+    testOk1(!done.wait(1.1));
+
+    op.reset();
+    cli.close();
+    serv.stop();
+}
+
+// Source with a fixed list of names, which counts calls to onSearch()
+struct ListedSource : public server::Source
+{
+    const std::shared_ptr<const std::set<std::string>> names;
+    server::SharedPV pv;
+    std::atomic<size_t> nsearch{0u};
+
+    ListedSource(const std::set<std::string>& names, const server::SharedPV& pv)
+        :names(std::make_shared<std::set<std::string>>(names))
+        ,pv(pv)
+    {}
+
+    virtual void onSearch(Search &op) override final
+    {
+        nsearch++;
+        for(auto& name : op) {
+            if(names->count(name.name()))
+                name.claim();
+        }
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final
+    {
+        if(names->count(op->name()))
+            pv.attach(std::move(op));
+    }
+    virtual List onList() override final
+    {
+        return List{names, false};
+    }
+};
+
+void testSearchFilter()
+{
+    testShow()<<__func__;
+
+    auto pv(server::SharedPV::buildReadonly());
+    pv.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+    auto src(std::make_shared<ListedSource>(std::set<std::string>{"listed"}, pv));
+
+    auto conf(server::Config::isolated());
+    conf.searchFilter = true;
+    auto serv(conf.build()
+              .addSource("listed", src)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    testEq(cli.get("listed").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+    testOk(src->nsearch>0u, "nsearch %zu", size_t(src->nsearch));
+
+    src->nsearch = 0u;
+
+    epicsEvent done;
+    auto op = cli.get("unlisted")
+            .result([&done](client::Result&&) {
+                done.signal();
+            })
+            .exec();
+
+    cli.hurryUp();
+
+    testOk1(!done.wait(1.1));
+    testEq(size_t(src->nsearch), 0u)<<" unlisted name not passed to onSearch()";
+
+    op.reset();
+    cli.close();
+    serv.stop();
+}
+
+struct DeferSource : public server::Source
+{
+    server::SharedPV pv;
+    epicsMutex lock;
+    std::vector<std::shared_ptr<SearchClaim>> pending;
+    epicsEvent searched;
+
+    explicit DeferSource(const server::SharedPV& pv) :pv(pv) {}
+
+    virtual void onSearch(Search &op) override final
+    {
+        for(auto& name : op) {
+            if(std::string(name.name())=="deferred") {
+                epicsGuard<epicsMutex> G(lock);
+                pending.push_back(name.defer());
+                searched.signal();
+            }
+        }
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final
+    {
+        if(op->name()=="deferred")
+            pv.attach(std::move(op));
+    }
+};
+
+void testDeferredSearch()
+{
+    testShow()<<__func__;
+
+    auto pv(server::SharedPV::buildReadonly());
+    pv.open(nt::NTScalar{TypeCode::Int32}.create().update("value", 42));
+    auto src(std::make_shared<DeferSource>(pv));
+
+    auto serv(server::Config::isolated().build()
+              .addSource("defer", src)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent done;
+    int32_t value = 0;
+    auto op = cli.get("deferred")
+            .result([&done, &value](client::Result&& result) {
+                value = result()["value"].as<int32_t>();
+                done.signal();
+            })
+            .exec();
+
+    testTrue(src->searched.wait(5.0))<<" onSearch() called";
+    testFalse(done.wait(0.5))<<" not claimed yet";
+
+    decltype (src->pending) claims;
+    {
+        epicsGuard<epicsMutex> G(src->lock);
+        claims = src->pending;
+    }
+    for(auto& claim : claims)
+        claim->claim();
+
+    testTrue(done.wait(5.0))<<" claimed later";
+    testEq(value, 42);
+
+    op.reset();
+    cli.close();
+    serv.stop();
+}
+
+// records the order in which names are searched
+struct OrderSource : public server::Source
+{
+    epicsMutex lock;
+    std::vector<std::string> names;
+    epicsEvent searched;
+
+    virtual void onSearch(Search &op) override final
+    {
+        epicsGuard<epicsMutex> G(lock);
+        for(auto& name : op)
+            names.push_back(name.name());
+        searched.signal();
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final {}
+};
+
+void testSearchPriority()
+{
+    testShow()<<__func__;
+
+    auto src(std::make_shared<OrderSource>());
+
+    auto serv(server::Config::isolated().build()
+              .addSource("order", src)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    // created within one initial search delay, so sent together
+    std::vector<std::shared_ptr<client::Connect>> conns;
+    for(auto i : range(20u))
+        conns.push_back(cli.connect(SB()<<"normal:"<<i).exec());
+    conns.push_back(cli.connect("urgent").priority(1).exec());
+
+    testTrue(src->searched.wait(5.0))<<" onSearch() called";
+
+    std::vector<std::string> names;
+    {
+        epicsGuard<epicsMutex> G(src->lock);
+        names = src->names;
+    }
+    testTrue(!names.empty() && names.front()=="urgent")<<" urgent name searched first of "<<names.size();
+
+    conns.clear();
+    cli.close();
+    serv.stop();
+}
+
+void testStatsPV()
+{
+    testShow()<<__func__;
+
+    auto conf(server::Config::isolated());
+    conf.statsPV = "stats";
+    conf.statsInterval = 0.1;
+    auto serv(conf.build().start());
+    testEq(serv.config().statsPV, "stats");
+
+    auto cli(serv.clientConfig().build());
+
+    // our own connection appears after the first update following connect
+    Value val;
+    for(auto i : range(50u)) {
+        (void)i;
+        val = cli.get("stats").exec()->wait(5.0);
+        if(val["connections.peer"].as<shared_array<const std::string>>().size()>=1u)
+            break;
+        epicsThreadSleep(0.1);
+    }
+    testShow()<<val;
+
+    testEq(val["connections.peer"].as<shared_array<const std::string>>().size(), 1u);
+    testOk1(!val["counters.name"].as<shared_array<const std::string>>().empty());
+
+    cli.close();
+    serv.stop();
+}
+
+void testWireCapture()
+{
+    testShow()<<__func__;
+
+    wireCaptureSet(0x10000);
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 42;
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+    auto cli(serv.clientConfig().build());
+
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 42);
+
+    // at least validation, create channel, and get init+exec, on both client and server sides
+    auto nmsg(wireCaptureDump("testget.pcap"));
+    testOk(nmsg>=8u, "captured %zu messages", nmsg);
+    remove("testget.pcap");
+
+    wireCaptureSet(0u);
+    cli.close();
+    serv.stop();
+}
+
+void testNetImpairment()
+{
+    testShow()<<__func__;
+
+    NetImpairment imp;
+    imp.latency = 0.05;
+    imp.bandwidth = 400000u;
+    testNetImpair(imp);
+
+    auto initial(nt::NTScalar{TypeCode::UInt8A}.create());
+    initial["value"] = shared_array<uint8_t>(100000u).freeze();
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+    auto cli(serv.clientConfig().build());
+
+    // connect
+    (void)cli.get("mailbox").field("alarm").exec()->wait(5.0);
+
+    // request and reply are each delayed
+    auto start(epicsMonotonicGet());
+    (void)cli.get("mailbox").field("alarm").exec()->wait(5.0);
+    auto small((epicsMonotonicGet()-start)*1e-9);
+    testOk(small>=0.09, "small GET round trip %.3f s", small);
+
+    // plus ~100 KB at 400 KB/s
+    start = epicsMonotonicGet();
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<shared_array<const void>>().size(), 100000u);
+    auto large((epicsMonotonicGet()-start)*1e-9);
+    testOk(large>=0.3, "large GET round trip %.3f s", large);
+
+    testNetImpair(NetImpairment());
+    cli.close();
+    serv.stop();
+}
+
+void testSnapshotGet()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 1;
+    initial["alarm.severity"] = 2;
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+    auto cli(serv.clientConfig().build());
+
+    // consecutive GETs re-use the encoding of the same snapshot
+    for(size_t i=0u; i<2u; i++)
+        testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 1);
+
+    // a different field mask
+    auto sel(cli.get("mailbox").field("alarm.severity").exec()->wait(5.0));
+    testEq(sel["alarm.severity"].as<int32_t>(), 2);
+    testTrue(!sel["value"] || !sel["value"].isMarked());
+
+    {
+        auto update(initial.cloneEmpty());
+        update["value"] = 3;
+        mbox.post(update);
+    }
+    auto val(cli.get("mailbox").exec()->wait(5.0));
+    testEq(val["value"].as<int32_t>(), 3);
+    testEq(val["alarm.severity"].as<int32_t>(), 2);
+}
+
 } // namespace
 
 MAIN(testget)
 {
-    testPlan(62);
+    testPlan(174);
     testSetup();
     logger_config_env();
     const bool canIPv6 = pvxs::impl::evsocket::canIPv6;
@@ -529,16 +1538,39 @@ MAIN(testget)
         testSkip(2, "No IPv6 Support");
     }
     Tester().lazy();
+    Tester().infoCache();
     Tester().timeout();
     Tester().cancel();
     Tester().asyncCancel();
     Tester().orphan();
     Tester().manualExec();
+    Tester().pipelineExec();
+    Tester().getMany();
     Tester().badRequest();
     Tester().delayExec();
     Tester().ordering();
     testError(false);
     testError(true);
+    testWorkers();
+    testClientWorkers();
+    testSearchWorkers();
+    testShareContext();
+    testBulk();
+    testFuture();
+    testNameCache();
+    testInProcess();
+    testUnixSocket();
+    testExecutor();
+    testIndexedSource();
+    testSearchFilter();
+    testDeferredSearch();
+    testSearchPriority();
+    testStatsPV();
+    testSelected();
+    testCreateMany();
+    testWireCapture();
+    testSnapshotGet();
+    testNetImpairment();
     cleanup_for_valgrind();
     return testDone();
 }
@@ -0,0 +1,138 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/data.h>
+#include <pvxs/json.h>
+#include "utilpvt.h"
+
+namespace {
+
+using namespace pvxs;
+
+TypeDef testType()
+{
+    using namespace pvxs::members;
+    return TypeDef(TypeCode::Struct, "test_t", {
+                       Int32("i32"),
+                       UInt64("u64"),
+                       Float64("f64"),
+                       Bool("b"),
+                       String("s"),
+                       Int32A("ia"),
+                       StringA("sa"),
+                       BoolA("ba"),
+                       Union("u", {
+                           Int32("one"),
+                           String("two"),
+                       }),
+                       Any("a"),
+                       StructA("sta", {
+                           Int32("x"),
+                       }),
+                   });
+}
+
+const char expected[] = "{\"i32\":-5,\"u64\":18446744073709551615,\"f64\":0.5,\"b\":true,"
+                        "\"s\":\"a \\\"q\\\"\\n\\u0001\","
+                        "\"ia\":[1,2,3],\"sa\":[\"x\",\"y\"],\"ba\":[true,false],"
+                        "\"u\":{\"two\":\"hi\"},\"a\":2.5,\"sta\":[{\"x\":1},null]}";
+
+void testWrite()
+{
+    testDiag("In %s", __func__);
+
+    auto val(testType().create());
+    val["i32"] = -5;
+    val["u64"] = uint64_t(-1);
+    val["f64"] = 0.5;
+    val["b"] = true;
+    val["s"] = "a \"q\"\n\x01";
+    val["ia"] = shared_array<const int32_t>({1, 2, 3});
+    val["sa"] = shared_array<const std::string>({"x", "y"});
+    val["ba"] = shared_array<const bool>({true, false});
+    val["u->two"] = "hi";
+    val["a"] = 2.5;
+    {
+        auto fld(val["sta"]);
+        shared_array<Value> arr(2u);
+        arr[0] = fld.allocMember();
+        arr[0]["x"] = 1;
+        // arr[1] left null
+        fld = arr.freeze();
+    }
+
+    std::string buf;
+    val.format().json().appendTo(buf);
+    testStrEq(buf, expected);
+    testStrEq(std::string(SB()<<val.format().json()), expected);
+}
+
+void testRoundTrip()
+{
+    testDiag("In %s", __func__);
+
+    auto val(testType().create());
+    json::Parse(expected).into(val);
+
+    testStrEq(std::string(SB()<<val.format().json()), expected);
+    testTrue(val["u64"].isMarked());
+}
+
+void testPartial()
+{
+    testDiag("In %s", __func__);
+
+    auto val(testType().create());
+    val["f64"] = 1.5;
+    val.unmark();
+
+    json::Parse("{\"i32\": 4, \"u\": {\"one\": 2}} ").into(val);
+
+    testEq(val["i32"].as<int32_t>(), 4);
+    testTrue(val["i32"].isMarked());
+    testEq(val["f64"].as<double>(), 1.5);
+    testFalse(val["f64"].isMarked());
+    testEq(val["u->one"].as<int32_t>(), 2);
+}
+
+void testErrors()
+{
+    testDiag("In %s", __func__);
+
+    auto val(testType().create());
+
+    testThrows<std::runtime_error>([&val]() {
+        json::Parse("{\"nosuch\": 1}").into(val);
+    });
+    testThrows<std::runtime_error>([&val]() {
+        json::Parse("{\"i32\": ").into(val);
+    });
+    testThrows<std::runtime_error>([&val]() {
+        json::Parse("{\"ia\": {}}").into(val);
+    });
+    testThrows<std::runtime_error>([&val]() {
+        json::Parse("{\"i32\": \"notanumber\"}").into(val);
+    });
+}
+
+} // namespace
+
+MAIN(testjson)
+{
+    testPlan(13);
+    testSetup();
+    testWrite();
+    testRoundTrip();
+    testPartial();
+    testErrors();
+    cleanup_for_valgrind();
+    return testDone();
+}
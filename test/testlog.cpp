@@ -5,10 +5,15 @@
  */
 
 #include <ostream>
+#include <atomic>
+
+#include <string.h>
 
 #include <testMain.h>
 #include <epicsUnitTest.h>
 #include <envDefs.h>
+#include <errlog.h>
+#include <epicsThread.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/log.h>
@@ -100,13 +105,99 @@ void testEnv()
     testEq(envc.lvl.load(), Level::Debug);
 }
 
+std::atomic<unsigned> nasync{0u};
+
+void countAsync(void *, const char *message)
+{
+    if(strstr(message, "async test"))
+        nasync++;
+}
+
+void testAsync()
+{
+    testDiag("%s", __func__);
+
+    logger_level_set("test.*", Level::Info);
+    errlogAddListener(&countAsync, nullptr);
+    eltc(0);
+
+    logger_async_set(true);
+    for(unsigned i=0; i<10u; i++)
+        log_info_printf(loggera, "async test %u\n", i);
+
+    // drained by a background thread
+    for(unsigned i=0; i<100u && nasync<10u; i++) {
+        epicsThreadSleep(0.01);
+        errlogFlush();
+    }
+    testEq(nasync.load(), 10u);
+
+    logger_async_set(false);
+    log_info_printf(loggera, "async test %s\n", "sync");
+    errlogFlush();
+    testEq(nasync.load(), 11u);
+
+    eltc(1);
+    errlogRemoveListeners(&countAsync, nullptr);
+    logger_level_set("test.*", Level::Err);
+}
+
+std::atomic<unsigned> nlimit{0u};
+std::atomic<bool> limitReported{false};
+
+void countLimit(void *, const char *message)
+{
+    if(strstr(message, "limit test"))
+        nlimit++;
+    if(strstr(message, "suppressed 7 similar messages"))
+        limitReported = true;
+}
+
+void logLimited(unsigned i)
+{
+    log_warn_printf(loggera, "limit test %u\n", i);
+}
+
+void testLimit()
+{
+    testDiag("%s", __func__);
+
+    logger_level_set("test.*", Level::Warn);
+    logger_limit_set(3u, 0.5);
+    errlogAddListener(&countLimit, nullptr);
+    eltc(0);
+
+    for(unsigned i=0; i<10u; i++)
+        logLimited(i);
+    errlogFlush();
+    testEq(nlimit.load(), 3u);
+
+    // other call sites are counted separately
+    log_warn_printf(loggera, "limit test %s\n", "other");
+    errlogFlush();
+    testEq(nlimit.load(), 4u);
+
+    epicsThreadSleep(0.6);
+    logLimited(10u);
+    errlogFlush();
+    testEq(nlimit.load(), 5u);
+    testTrue(limitReported.load());
+
+    eltc(1);
+    errlogRemoveListeners(&countLimit, nullptr);
+    logger_limit_set(10u, 10.0);
+    logger_level_set("test.*", Level::Err);
+}
+
 } // namespace
 
 MAIN(testlog)
 {
-    testPlan(16);
+    testPlan(22);
     testSetup();
     testLog();
     testEnv();
+    testAsync();
+    testLimit();
     return testDone();
 }
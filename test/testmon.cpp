@@ -6,12 +6,16 @@
 #define PVXS_ENABLE_EXPERT_API
 
 #include <atomic>
+#include <cstddef>
 
 #include <testMain.h>
 
 #include <epicsUnitTest.h>
 
 #include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsThread.h>
 
 #include <pvxs/unittest.h>
 #include <pvxs/log.h>
@@ -155,6 +159,264 @@ struct BasicTest {
             testShow()<<pop(sub, evt);
         });
     }
+
+    void maxRate()
+    {
+        testShow()<<__func__;
+
+        serv.start();
+        mbox.open(initial);
+
+        sub = cli.monitor("mailbox")
+                .record("maxRate", 2.0)
+                .maskConnected(true)
+                .maskDisconnected(false)
+                .event([this](client::Subscription&) {
+                    testDiag("Event evt");
+                    evt.signal();
+                })
+                .exec();
+
+        cli.hurryUp();
+
+        if(auto val = pop(sub, evt)) {
+            testEq(val["value"].as<int32_t>(), 42);
+        } else {
+            testFail("Missing data update");
+        }
+
+        // posted within 0.5 seconds of the first update, so combined into one
+        {
+            auto update(initial.cloneEmpty());
+            update["alarm.severity"] = 1;
+            mbox.post(update);
+        }
+        post(1);
+        post(2);
+
+        if(auto val = pop(sub, evt)) {
+            testEq(val["value"].as<int32_t>(), 2);
+            testEq(val["alarm.severity"].as<int32_t>(), 1);
+        } else {
+            testFail("Missing data update");
+            testSkip(1, "no update");
+        }
+        testFalse(sub->pop())<<" No further updates";
+    }
+
+    void deadband()
+    {
+        testShow()<<__func__;
+
+        serv.start();
+        mbox.open(initial);
+
+        sub = cli.monitor("mailbox")
+                .record("deadband", 5.0)
+                .maskConnected(true)
+                .maskDisconnected(false)
+                .event([this](client::Subscription&) {
+                    testDiag("Event evt");
+                    evt.signal();
+                })
+                .exec();
+
+        cli.hurryUp();
+
+        testEq(pop(sub, evt)["value"].as<int32_t>(), 42);
+
+        post(44); // dropped
+        post(48);
+        testEq(pop(sub, evt)["value"].as<int32_t>(), 48);
+
+        // not only a change of value, so always sent
+        {
+            auto update(initial.cloneEmpty());
+            update["alarm.severity"] = 1;
+            mbox.post(update);
+        }
+        testEq(pop(sub, evt)["alarm.severity"].as<int32_t>(), 1);
+
+        post(50); // dropped
+        post(60);
+        testEq(pop(sub, evt)["value"].as<int32_t>(), 60);
+        testFalse(sub->pop())<<" No further updates";
+    }
+
+    client::Event tryPop(Value& val, std::exception_ptr* exc=nullptr)
+    {
+        while(true) {
+            auto ret = sub->tryPop(val, exc);
+            if(ret!=client::Event::Empty) {
+                return ret;
+
+            } else if (!evt.wait(5.0)) {
+                testFail("timeout waiting for event");
+                return ret;
+            }
+        }
+    }
+
+    void noThrow()
+    {
+        testShow()<<__func__;
+
+        serv.start();
+        mbox.open(initial);
+        subscribe("mailbox");
+        cli.hurryUp();
+
+        Value val;
+        std::exception_ptr exc;
+        testEq(tryPop(val, &exc), client::Event::Connected);
+        testTrue(!val && exc);
+        testThrows<client::Connected>([&exc]() {
+            std::rethrow_exception(exc);
+        });
+
+        testEq(tryPop(val, &exc), client::Event::Data);
+        testTrue(val && !exc);
+        testEq(val["value"].as<int32_t>(), 42);
+
+        testEq(sub->tryPop(val), client::Event::Empty);
+        testFalse(val);
+
+        mbox.close();
+
+        testEq(tryPop(val), client::Event::Disconnect);
+        testFalse(val);
+
+        auto res(client::Result(std::make_exception_ptr(client::Disconnect()), client::Event::Disconnect));
+        testEq(res.kind(), client::Event::Disconnect);
+        testTrue(!res.value() && res.exception());
+        testEq(client::Result().kind(), client::Event::Empty);
+    }
+
+    struct Reading {
+        int32_t value = 0;
+        std::string message;
+        shared_array<const int32_t> missing;
+    };
+
+    void sink()
+    {
+        testShow()<<__func__;
+
+        serv.start();
+        mbox.open(initial);
+
+        client::DecodeMap map;
+        map.field<int32_t>("value", offsetof(Reading, value))
+           .field<std::string>("alarm.message", offsetof(Reading, message))
+           .field<shared_array<const int32_t>>("nonexistent", offsetof(Reading, missing));
+
+        testThrows<std::logic_error>([this, &map]() {
+            cli.monitor("mailbox")
+                    .latestOnly()
+                    .sink<Reading>(map, std::make_shared<Reading>(), [](const Reading&) {})
+                    .exec();
+        });
+
+        auto dest(std::make_shared<Reading>());
+        epicsMutex lock;
+        std::vector<int32_t> seen;
+        sub = cli.monitor("mailbox")
+                .maskConnected(true)
+                .sink<Reading>(map, dest, [this, &lock, &seen](const Reading& r) {
+                    {
+                        epicsGuard<epicsMutex> G(lock);
+                        seen.push_back(r.value);
+                    }
+                    evt.signal();
+                })
+                .event([this](client::Subscription&) {
+                    evt.signal();
+                })
+                .exec();
+        cli.hurryUp();
+
+        auto waitFor = [this, &lock, &seen](size_t n) -> bool {
+            while(true) {
+                {
+                    epicsGuard<epicsMutex> G(lock);
+                    if(seen.size()>=n)
+                        return true;
+                }
+                if(!evt.wait(5.0))
+                    return false;
+            }
+        };
+
+        testTrue(waitFor(1u))<<" initial update";
+        post(5);
+        testTrue(waitFor(2u))<<" second update";
+
+        {
+            epicsGuard<epicsMutex> G(lock);
+            testEq(seen.size(), 2u);
+            testEq(seen.at(0), 42);
+            testEq(seen.at(1), 5);
+        }
+        testEq(dest->value, 5);
+        testTrue(dest->missing.empty());
+        testFalse(sub->pop())<<" data updates not queued";
+        sub.reset();
+    }
+
+    void cliSquash()
+    {
+        testShow()<<__func__;
+
+        serv.start();
+        mbox.open(initial);
+
+        sub = cli.monitor("mailbox")
+                .record("queueSize", 1u)
+                .maskConnected(true)
+                .maskDisconnected(false)
+                .event([this](client::Subscription&) {
+                    testDiag("Event evt");
+                    evt.signal();
+                })
+                .exec();
+
+        cli.hurryUp();
+
+        if(auto val = pop(sub, evt)) {
+            testEq(val["value"].as<int32_t>(), 42);
+        } else {
+            testFail("Missing data update");
+        }
+
+        {
+            auto update(initial.cloneEmpty());
+            update["alarm.severity"] = 1;
+            mbox.post(update);
+        }
+        testOk1(evt.wait(5.0));
+        // not popped, so the next update is squashed into the first
+        post(5);
+
+        client::SubscriptionStat stat;
+        for(unsigned i=0u; i<50u; i++) {
+            sub->stats(stat);
+            if(stat.nCliSquash)
+                break;
+            epicsThreadSleep(0.1);
+        }
+        testEq(stat.nCliSquash, 1u);
+
+        if(auto val = pop(sub, evt)) {
+            testEq(val["value"].as<int32_t>(), 5);
+            testTrue(val["value"].isMarked());
+            testEq(val["alarm.severity"].as<int32_t>(), 1);
+            testTrue(val["alarm.severity"].isMarked());
+        } else {
+            testFail("Missing data update");
+            testSkip(3, "no update");
+        }
+        testFalse(sub->pop())<<" No further updates";
+    }
 };
 
 struct TestLifeCycle : public BasicTest
@@ -263,6 +525,43 @@ struct TestLifeCycle : public BasicTest
         }
     }
 
+    void testBatch()
+    {
+        testShow()<<__func__;
+
+        std::vector<int32_t> values;
+        if(auto val = pop(sub, evt))
+            values.push_back(val["value"].as<int32_t>());
+
+        post(1);
+        post(2);
+        post(3);
+
+        std::vector<Value> batch;
+        while(values.size() < 4u) {
+            sub->pop(batch);
+            for(auto& val : batch)
+                values.push_back(val["value"].as<int32_t>());
+
+            if(batch.empty() && !evt.wait(5.0)) {
+                testFail("timeout waiting for event");
+                break;
+            }
+        }
+
+        testEq(values.size(), 4u);
+        testTrue(values==std::vector<int32_t>({42, 1, 2, 3}));
+
+        mbox.close();
+
+        testThrows<client::Disconnect>([this, &batch](){
+            while(!sub->pop(batch) && batch.empty()) {
+                if(!evt.wait(5.0))
+                    break;
+            }
+        });
+    }
+
     void testDelta()
     {
         testShow()<<__func__;
@@ -358,23 +657,658 @@ struct TestReconn : public BasicTest
     }
 };
 
+void testFanOut()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    shared_array<double> arr(2048u); // encodes larger than WireCache::refThreshold
+    for(size_t i=0; i<arr.size(); i++)
+        arr[i] = i;
+    initial["value"] = arr.freeze();
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    // two subscribers with the same connection and mask,
+    // one with a different mask, and one on a second connection.
+    client::Context cli1(serv.clientConfig().build()),
+                    cli2(serv.clientConfig().build());
+
+    struct Sub {
+        epicsEvent evt;
+        std::shared_ptr<client::Subscription> sub;
+    } subs[4];
+
+    for(unsigned i=0; i<4u; i++) {
+        auto& S = subs[i];
+        auto bld((i==3u ? cli2 : cli1).monitor("mailbox"));
+        if(i==2u)
+            bld.field("value");
+        S.sub = bld.event([&S](client::Subscription&) {
+            S.evt.signal();
+        })
+                .exec();
+    }
+
+    for(auto& S : subs) {
+        auto val(BasicTest::pop(S.sub, S.evt));
+        testEq(val["value"].as<shared_array<const double>>().size(), 2048u);
+    }
+
+    for(int n=1; n<=2; n++) {
+        auto update(initial.cloneEmpty());
+        shared_array<double> arr(2048u);
+        for(size_t i=0; i<arr.size(); i++)
+            arr[i] = i*n;
+        update["value"] = arr.freeze();
+        update["alarm.severity"] = n;
+        mbox.post(update);
+
+        for(unsigned i=0; i<4u; i++) {
+            auto val(BasicTest::pop(subs[i].sub, subs[i].evt));
+            auto varr(val["value"].as<shared_array<const double>>());
+            testOk(varr.size()==2048u && varr[2047]==2047*n,
+                   "sub %u update %d value[2047]=%g", i, n,
+                   varr.size()==2048u ? varr[2047] : -1.0);
+            // field("value") excludes alarm
+            testEq(val["alarm.severity"].isMarked(), i!=2u);
+        }
+    }
+}
+
+void testCompress()
+{
+    testShow()<<__func__;
+
+    constexpr size_t N = 16384u;
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    auto fill = [&initial](double scale) {
+        auto val(initial.cloneEmpty());
+        shared_array<double> arr(N);
+        for(size_t i=0; i<arr.size(); i++)
+            arr[i] = (i/64u)*scale; // long runs of repeated values
+        val["value"] = arr.freeze();
+        return val;
+    };
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(fill(1.0));
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    auto sub(cli.monitor("mailbox")
+             .record("compress", "lz4")
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+
+    auto val(BasicTest::pop(sub, evt));
+    auto varr(val["value"].as<shared_array<const double>>());
+    testOk(varr.size()==N && varr[N-1u]==(N-1u)/64u, "initial value[%zu]=%g",
+           N-1u, varr.size()==N ? varr[N-1u] : -1.0);
+
+    mbox.post(fill(2.0));
+    val = BasicTest::pop(sub, evt);
+    varr = val["value"].as<shared_array<const double>>();
+    testOk(varr.size()==N && varr[N-1u]==2.0*((N-1u)/64u), "update value[%zu]=%g",
+           N-1u, varr.size()==N ? varr[N-1u] : -1.0);
+
+    auto rpt(serv.report(false));
+    if(testEq(rpt.connections.size(), 1u)) {
+        // two full arrays, were they sent uncompressed
+        testTrue(rpt.connections.front().tx < N*sizeof(double))<<" tx="<<rpt.connections.front().tx;
+    } else {
+        testSkip(1, "No connection");
+    }
+}
+
+void testArrayDelta()
+{
+    testShow()<<__func__;
+
+    constexpr size_t N = 16384u;
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    shared_array<double> arr(N);
+    for(size_t i=0; i<arr.size(); i++)
+        arr[i] = i;
+    initial["value"] = arr.freeze();
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    auto sub(cli.monitor("mailbox")
+             .record("delta", true)
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+
+    auto val(BasicTest::pop(sub, evt));
+    testEq(val["value"].as<shared_array<const double>>().size(), N);
+    (void)serv.report(true); // zero counters
+
+    {
+        auto update(initial.cloneEmpty());
+        shared_array<double> arr(N);
+        for(size_t i=0; i<arr.size(); i++)
+            arr[i] = i;
+        arr[5] = -1.0;
+        arr[N-1u] = -2.0;
+        update["value"] = arr.freeze();
+        update["alarm.severity"] = 1;
+        mbox.post(update);
+    }
+
+    val = BasicTest::pop(sub, evt);
+    auto varr(val["value"].as<shared_array<const double>>());
+    testOk(varr.size()==N && varr[4]==4.0 && varr[5]==-1.0 && varr[N-2u]==N-2u && varr[N-1u]==-2.0,
+           "patched value[5]=%g value[%zu]=%g", varr.size()==N ? varr[5] : 0.0,
+           N-1u, varr.size()==N ? varr[N-1u] : 0.0);
+    testTrue(val["value"].isMarked());
+    testEq(val["alarm.severity"].as<int32_t>(), 1);
+
+    auto rpt(serv.report(false));
+    if(testEq(rpt.connections.size(), 1u)) {
+        testTrue(rpt.connections.front().tx < 1024u)<<" tx="<<rpt.connections.front().tx;
+    } else {
+        testSkip(1, "No connection");
+    }
+}
+
+void testPassThrough()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Float64A, true}.create());
+    shared_array<double> arr(2048u);
+    for(size_t i=0; i<arr.size(); i++)
+        arr[i] = i;
+    initial["value"] = arr.freeze();
+    initial["display.units"] = "mm";
+
+    // upstream server -> gateway client ... gateway server -> downstream client
+    auto upstream(server::SharedPV::buildReadonly());
+    upstream.open(initial);
+    auto userv(server::Config::isolated()
+               .build()
+               .addPV("up", upstream)
+               .start());
+    auto gwcli(userv.clientConfig().build());
+
+    auto downstream(server::SharedPV::buildReadonly());
+    auto gwserv(server::Config::isolated()
+                .build()
+                .addPV("down", downstream)
+                .start());
+    auto cli(gwserv.clientConfig().build());
+
+    epicsEvent gwevt;
+    auto gwsub(gwcli.monitor("up")
+               .passThrough()
+               .event([&gwevt](client::Subscription&) {
+                   gwevt.signal();
+               })
+               .exec());
+    downstream.open(BasicTest::pop(gwsub, gwevt));
+
+    epicsEvent evt;
+    auto sub(cli.monitor("down")
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+    {
+        auto val(BasicTest::pop(sub, evt));
+        testEq(val["value"].as<shared_array<const double>>().size(), 2048u);
+        testEq(val["display.units"].as<std::string>(), "mm");
+    }
+
+    {
+        auto update(initial.cloneEmpty());
+        update["alarm.severity"] = 2;
+        upstream.post(update);
+    }
+    downstream.post(BasicTest::pop(gwsub, gwevt));
+
+    {
+        auto val(BasicTest::pop(sub, evt));
+        testEq(val["alarm.severity"].as<int32_t>(), 2);
+        testFalse(val["value"].isMarked());
+        testEq(val["value"].as<shared_array<const double>>().size(), 2048u);
+        testEq(val["display.units"].as<std::string>(), "mm");
+    }
+}
+
+void testArrayAlloc()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    initial["value"] = shared_array<const double>({1.0, 2.0, 3.0});
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    auto sub(cli.monitor("mailbox")
+             .arrayAllocator(ArrayAllocator::aligned(256u))
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+
+    {
+        auto arr(BasicTest::pop(sub, evt)["value"].as<shared_array<const double>>());
+        testEq(arr.size(), 3u);
+        testEq(size_t(arr.data())%256u, 0u)<<" aligned";
+    }
+
+    {
+        auto update(initial.cloneEmpty());
+        shared_array<double> arr(1000u);
+        for(size_t i=0; i<arr.size(); i++)
+            arr[i] = i;
+        update["value"] = arr.freeze();
+        mbox.post(update);
+    }
+
+    {
+        auto arr(BasicTest::pop(sub, evt)["value"].as<shared_array<const double>>());
+        testOk(arr.size()==1000u && arr[999]==999.0, "size %zu", arr.size());
+        testEq(size_t(arr.data())%256u, 0u)<<" aligned";
+    }
+
+    auto arr(allocArray(ArrayType::Int32, 5u, ArrayAllocator::aligned(64u)));
+    testEq(arr.size(), 5u);
+    testEq(size_t(arr.data())%64u, 0u)<<" aligned";
+    testEq(arr.castTo<int32_t>()[4], 0);
+}
+
+void testShared()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 1;
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    auto conf(serv.clientConfig());
+    conf.shareMonitors = true;
+    auto cli(conf.build());
+
+    auto post = [&initial, &mbox](int32_t v) {
+        auto update(initial.cloneEmpty());
+        update["value"] = v;
+        mbox.post(update);
+    };
+
+    epicsEvent evt1, evt2;
+    auto sub1(cli.monitor("mailbox")
+              .event([&evt1](client::Subscription&) {
+                  evt1.signal();
+              })
+              .exec());
+    testEq(BasicTest::pop(sub1, evt1)["value"].as<int32_t>(), 1);
+
+    post(2);
+    testEq(BasicTest::pop(sub1, evt1)["value"].as<int32_t>(), 2);
+
+    // joins with the most recent update
+    auto sub2(cli.monitor("mailbox")
+              .event([&evt2](client::Subscription&) {
+                  evt2.signal();
+              })
+              .exec());
+    {
+        auto val(BasicTest::pop(sub2, evt2));
+        testEq(val["value"].as<int32_t>(), 2);
+        testTrue(val["value"].isMarked());
+    }
+
+    post(3);
+    {
+        auto val1(BasicTest::pop(sub1, evt1));
+        auto val2(BasicTest::pop(sub2, evt2));
+        testEq(val1["value"].as<int32_t>(), 3);
+        testEq(val2["value"].as<int32_t>(), 3);
+        // each has a private copy
+        val1["value"] = 100;
+        testEq(val2["value"].as<int32_t>(), 3);
+    }
+
+    sub1.reset(); // implied cancel.  sub2 continues
+
+    post(4);
+    testEq(BasicTest::pop(sub2, evt2)["value"].as<int32_t>(), 4);
+}
+
+void testOnlyChanged()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 1;
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.postOnlyChanged();
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    auto sub(cli.monitor("mailbox")
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+    testEq(BasicTest::pop(sub, evt)["value"].as<int32_t>(), 1);
+
+    {
+        auto update(initial.cloneEmpty());
+        update["value"] = 1; // no change, so not sent
+        mbox.post(update);
+        update["alarm.severity"] = 2;
+        mbox.post(update);
+    }
+
+    auto val(BasicTest::pop(sub, evt));
+    testEq(val["alarm.severity"].as<int32_t>(), 2);
+    testTrue(val["alarm.severity"].isMarked());
+    testFalse(val["value"].isMarked());
+    testFalse(sub->pop());
+}
+
+void testPostMove()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 1;
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    auto sub(cli.monitor("mailbox")
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+    testEq(BasicTest::pop(sub, evt)["value"].as<int32_t>(), 1);
+
+    {
+        auto update(initial.cloneEmpty());
+        update["value"] = 2;
+        mbox.post(std::move(update));
+        testFalse(update)<<" moved from";
+    }
+
+    auto val(BasicTest::pop(sub, evt));
+    testEq(val["value"].as<int32_t>(), 2);
+    testFalse(val["alarm.severity"].isMarked());
+    testEq(mbox.fetch()["value"].as<int32_t>(), 2);
+}
+
+void testMemory()
+{
+    testShow()<<__func__;
+
+    constexpr size_t N = 4096u;
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    initial["value"] = shared_array<const double>(N, 1.0);
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    auto sub(cli.monitor("mailbox")
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+    testOk1(evt.wait(5.0));
+
+    // initial update is queued, not yet pop()'d
+    auto rpt(cli.report(false));
+    if(testEq(rpt.connections.size(), 1u)) {
+        auto& conn = rpt.connections.front();
+        testTrue(conn.memQueue >= N*sizeof(double))<<" memQueue="<<conn.memQueue;
+        testTrue(conn.memTypes > 0u)<<" memTypes="<<conn.memTypes;
+    } else {
+        testSkip(2, "No connection");
+    }
+
+    testEq(BasicTest::pop(sub, evt)["value"].as<shared_array<const double>>().size(), N);
+    testEq(cli.report(false).connections.front().memQueue, 0u);
+}
+
+void testMemoryLimit()
+{
+    testShow()<<__func__;
+
+    // each update is a little more than 32KB
+    constexpr size_t N = 4096u;
+    auto initial(nt::NTScalar{TypeCode::Float64A}.create());
+    initial["value"] = shared_array<const double>(N, 1.0);
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto conf(server::Config::isolated());
+    conf.connMemoryLimit = 50000u;
+    auto serv(conf.build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    std::vector<std::shared_ptr<client::Subscription>> subs;
+    // first two fit, with queues reduced to one entry.  third is refused.
+    for(size_t i=0u; i<3u; i++) {
+        subs.push_back(cli.monitor("mailbox")
+                       .event([&evt](client::Subscription&) {
+                           evt.signal();
+                       })
+                       .exec());
+        if(i<2u) {
+            testEq(BasicTest::pop(subs.back(), evt)["value"].as<shared_array<const double>>().size(), N);
+        } else {
+            testThrows<client::RemoteError>([&subs, &evt]() {
+                testShow()<<BasicTest::pop(subs.back(), evt);
+            });
+        }
+    }
+}
+
+void testMany()
+{
+    testShow()<<__func__;
+
+    constexpr size_t N = 8u;
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+
+    auto bld(server::Config::isolated().build());
+    std::vector<server::SharedPV> pvs;
+    std::vector<std::string> names;
+    for(size_t i=0; i<N; i++) {
+        auto pv(server::SharedPV::buildReadonly());
+        auto val(initial.cloneEmpty());
+        val["value"] = int32_t(i);
+        pv.open(val);
+        names.push_back("pv" + std::to_string(i));
+        bld.addPV(names.back(), pv);
+        pvs.push_back(pv);
+    }
+    auto serv(bld.start());
+    auto cli(serv.clientConfig().build());
+
+    epicsEvent evt;
+    auto subs(cli.monitorMany(names, cli.monitor("")
+                                        .event([&evt](client::Subscription&) {
+                                            evt.signal();
+                                        })));
+
+    if(testEq(subs.size(), N)) {
+        for(size_t i=0; i<N; i++) {
+            testEq(BasicTest::pop(subs[i], evt)["value"].as<int32_t>(), int32_t(i))<<" "<<subs[i]->name();
+        }
+    }
+}
+
+void testLatestOnly()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 1;
+
+    auto mbox(server::SharedPV::buildReadonly());
+    mbox.open(initial);
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("mailbox", mbox)
+              .start());
+
+    auto cli(serv.clientConfig().build());
+
+    testThrows<std::logic_error>([&cli]() {
+        cli.monitor("mailbox").latestOnly().multicast("239.0.0.1:5076").exec();
+    });
+
+    auto sub(cli.monitor("mailbox")
+             .latestOnly()
+             .exec());
+    // a plain subscription to the same PV, to know when updates have been sent
+    epicsEvent evt;
+    auto plain(cli.monitor("mailbox")
+               .event([&evt](client::Subscription&) {
+                   evt.signal();
+               })
+               .exec());
+    testEq(BasicTest::pop(plain, evt)["value"].as<int32_t>(), 1);
+    testEq(plain->version(), 0u);
+
+    for(size_t i=0u; i<500u && !sub->version(); i++)
+        epicsThreadSleep(0.01);
+
+    uint64_t seen = 0u;
+    testEq(sub->latest(&seen)["value"].as<int32_t>(), 1);
+    testEq(seen, 1u);
+    testFalse(sub->pop())<<" data updates not queued";
+
+    {
+        auto update(initial.cloneEmpty());
+        update["value"] = 2;
+        mbox.post(update);
+        update = initial.cloneEmpty();
+        update["alarm.severity"] = 3;
+        mbox.post(update);
+    }
+    for(size_t i=0u; i<2u; i++) {
+        auto val(BasicTest::pop(plain, evt));
+        if(!val || val["alarm.severity"].as<int32_t>()==3)
+            break;
+    }
+    for(size_t i=0u; i<500u && sub->version()==seen; i++)
+        epicsThreadSleep(0.01);
+
+    // both updates merged
+    auto val(sub->latest(&seen));
+    testTrue(seen>1u)<<" version "<<seen;
+    testEq(val["value"].as<int32_t>(), 2);
+    testEq(val["alarm.severity"].as<int32_t>(), 3);
+    testTrue(val["value"].isMarked() && val["alarm.severity"].isMarked());
+}
+
 } // namespace
 
 MAIN(testmon)
 {
-    testPlan(41);
+    testPlan(173);
     testSetup();
     logger_config_env();
     BasicTest().orphan();
     BasicTest().cancel();
     BasicTest().asyncCancel();
     BasicTest().badRequest();
+    BasicTest().maxRate();
+    BasicTest().deadband();
+    BasicTest().noThrow();
+    BasicTest().sink();
+    BasicTest().cliSquash();
     TestLifeCycle().testBasic(true);
     TestLifeCycle().testBasic(false);
     TestLifeCycle().testSecond();
     TestLifeCycle().testDelta();
+    TestLifeCycle().testBatch();
     TestReconn().testReconn(false);
     TestReconn().testReconn(true);
+    testFanOut();
+    testCompress();
+    testArrayDelta();
+    testPassThrough();
+    testArrayAlloc();
+    testShared();
+    testOnlyChanged();
+    testPostMove();
+    testMemory();
+    testMemoryLimit();
+    testMany();
+    testLatestOnly();
     cleanup_for_valgrind();
     return testDone();
 }
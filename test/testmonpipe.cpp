@@ -97,9 +97,10 @@ struct Spammer : public server::Source {
     }
 };
 
-void testSpam(uint32_t nQueue, uint32_t highMark, uint16_t lastVal)
+void testSpam(uint32_t nQueue, uint32_t highMark, uint16_t lastVal, bool autoWindow=false)
 {
-    testShow()<<__func__<<" nQueue="<<nQueue<<" highMark="<<highMark<<" lastVal="<<lastVal;
+    testShow()<<__func__<<" nQueue="<<nQueue<<" highMark="<<highMark<<" lastVal="<<lastVal
+              <<" autoWindow="<<autoWindow;
 
     auto src(std::make_shared<Spammer>());
 
@@ -115,6 +116,7 @@ void testSpam(uint32_t nQueue, uint32_t highMark, uint16_t lastVal)
              .record("queueSize", nQueue)
              .record("lastVal", lastVal)
              .record("pipeline", true)
+             .record("autoWindow", autoWindow)
              .maskConnected(true)
              .maskDisconnected(true)
              .event([&wait](client::Subscription&){
@@ -145,7 +147,7 @@ void testSpam(uint32_t nQueue, uint32_t highMark, uint16_t lastVal)
 
 MAIN(testmonpipe)
 {
-    testPlan(99);
+    testPlan(151);
     testSetup();
     logger_config_env();
     testSpam(3u, 0u, 7u);
@@ -157,6 +159,7 @@ MAIN(testmonpipe)
     testSpam(4u, 3u, 10u);
     testSpam(4u, 4u, 10u);
     testSpam(4u, 6u, 10u);
+    testSpam(4u, 0u, 50u, true);
     logger_config_env();
     cleanup_for_valgrind();
     return testDone();
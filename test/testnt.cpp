@@ -44,6 +44,12 @@ void testNTScalar()
     testEq(top["display.limitLow"].type(), TypeCode::Float64);
     testEq(top["display.description"].type(), TypeCode::String);
     testEq(top["control.limitLow"].type(), TypeCode::Float64);
+
+    // appending to the (cached) definition doesn't change later builds
+    auto def = nt::NTScalar{TypeCode::Int32}.build();
+    def += {Member(TypeCode::String, "extra")};
+    testEq(def.create()["extra"].type(), TypeCode::String);
+    testEq(nt::NTScalar{TypeCode::Int32}.create()["extra"].type(), TypeCode::Null);
 }
 
 void testNTNDArray()
@@ -82,13 +88,54 @@ void testNTEnum()
     testTrue(top.idStartsWith("epics:nt/NTEnum:"))<<"\n"<<top;
 }
 
+void testNTTable()
+{
+    testDiag("In %s", __func__);
+
+    auto top = nt::NTTable{}
+            .add_column(TypeCode::StringA, "name", "Name")
+            .add_column(TypeCode::Float64A, "x")
+            .create();
+
+    testTrue(top.idStartsWith("epics:nt/NTTable:"))<<"\n"<<top;
+    testArrEq(top["labels"].as<shared_array<const std::string>>(),
+              shared_array<const std::string>({"Name", "x"}));
+
+    nt::NTTableColumns cols(top);
+    testEq(cols.size(), 2u);
+    auto x = cols.index("x");
+    testEq(x, 1u);
+    testThrows<std::out_of_range>([&cols]() { cols.index("nonexistent"); });
+
+    // second instance of the same type
+    auto other(top.cloneEmpty());
+    shared_array<std::string> names({"a", "b", "c"});
+    shared_array<double> xs({1.0, 2.0, 3.0});
+    cols.assign(other, 0u, names.freeze());
+    cols.assign(other, x, xs.freeze());
+
+    testArrEq(cols.column<double>(other, x), shared_array<const double>({1.0, 2.0, 3.0}));
+    testThrows<std::logic_error>([&cols, &other, x]() { cols.column<int32_t>(other, x); });
+    testEq(cols.nrows(other), 3u);
+
+    std::string joined;
+    double sum = 0.0;
+    for(auto row : cols.rows(other)) {
+        joined += row.get<std::string>(0u);
+        sum += row.get<double>(x);
+    }
+    testEq(joined, "abc");
+    testEq(sum, 6.0);
+}
+
 } // namespace
 
 MAIN(testnt) {
-    testPlan(18);
+    testPlan(30);
     testNTScalar();
     testNTNDArray();
     testNTURI();
     testNTEnum();
+    testNTTable();
     return testDone();
 }
@@ -267,6 +267,49 @@ struct Tester : public TesterBase
         testOk1(done.wait(5.0));
         testEq(mbox.fetch()["value"].as<uint32_t>(), 124u);
     }
+
+    void pipelineExec()
+    {
+        testShow()<<__func__;
+
+        epicsEvent initd;
+        Value top;
+
+        mbox.open(initial);
+        serv.start();
+
+        auto op = cli.put("mailbox")
+                .autoExec(false)
+                .execPipeline(4u)
+                .onInit([&initd, &top](const Value& prototype) {
+                    top = prototype;
+                    initd.signal();
+                })
+                .exec();
+
+        testOk1(initd.wait(5.0));
+
+        // stream values, sent four at a time, with completion reported only for the last
+        const size_t nexec = 10u;
+        client::Result last;
+        epicsEvent done;
+        for(size_t i=0u; i<nexec; i++) {
+            auto val(top.cloneEmpty());
+            val["value"] = int32_t(100u + i);
+            if(i+1u==nexec) {
+                op->reExecPut(val, [&last, &done](client::Result&& result) {
+                    last = std::move(result);
+                    done.signal();
+                });
+            } else {
+                op->reExecPut(val, nullptr);
+            }
+        }
+
+        testOk1(done.wait(5.0));
+        testFalse(last.error());
+        testEq(mbox.fetch()["value"].as<int32_t>(), 109);
+    }
 };
 
 struct TestPutBuilder : public TesterBase
@@ -407,11 +450,98 @@ void testError()
     }
 }
 
+void testCoalesce()
+{
+    testShow()<<__func__;
+
+    epicsEvent started, release;
+    std::atomic<bool> first{true};
+
+    server::HandlerPool pool(1u);
+    auto pv(server::SharedPV::buildReadonly());
+    pv.handlerPool(pool);
+    pv.coalescePuts();
+    pv.onPut([&started, &release, &first](server::SharedPV& pv, std::unique_ptr<server::ExecOp>&& op, Value&& val) {
+        if(first.exchange(false)) {
+            started.signal();
+            release.wait(5.0);
+        }
+        pv.post(val);
+        op->reply();
+    });
+    {
+        auto initial(nt::NTScalar{TypeCode::Int32}.create());
+        initial["value"] = 0;
+        pv.open(initial);
+    }
+
+    auto serv(server::Config::isolated()
+              .build()
+              .addPV("setpoint", pv)
+              .start());
+    auto cli(serv.clientConfig().build());
+
+    auto f1(cli.put("setpoint").set("value", 1).execFuture());
+    testOk1(started.wait(5.0));
+
+    // handler busy with 1.  2 waits, until 3 takes its place
+    auto f2(cli.put("setpoint").set("value", 2).execFuture());
+    auto f3(cli.put("setpoint").set("value", 3).execFuture());
+
+    testThrows<client::RemoteError>([&f2]() {
+        f2.wait(5.0)();
+    });
+    release.signal();
+
+    f1.wait(5.0)();
+    testPass("Put 1 complete");
+    f3.wait(5.0)();
+    testPass("Put 3 complete");
+    testEq(pv.fetch()["value"].as<int32_t>(), 3);
+}
+
+void testEarlyExec()
+{
+    testShow()<<__func__;
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 1;
+    auto mbox(server::SharedPV::buildMailbox());
+    mbox.open(initial);
+
+    auto serv = server::Config::isolated()
+            .build()
+            .addPV("mailbox", mbox)
+            .start();
+
+    auto cli = serv.clientConfig().build();
+
+    // first learns the type, then second sends EXEC along with INIT
+    cli.put("mailbox").set("value", 2).exec()->wait(5.0);
+    testEq(mbox.fetch()["value"].as<int32_t>(), 2);
+    cli.put("mailbox").set("value", 3).exec()->wait(5.0);
+    testEq(mbox.fetch()["value"].as<int32_t>(), 3);
+
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 3);
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 3);
+
+    // type changes.  EXEC built with the old type is rejected, then sent again
+    mbox.close();
+    auto changed(nt::NTScalar{TypeCode::Float64}.create());
+    changed["value"] = 1.5;
+    mbox.open(changed);
+
+    cli.put("mailbox").set("value", 4.5).exec()->wait(5.0);
+    testEq(mbox.fetch()["value"].as<double>(), 4.5);
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<double>(), 4.5);
+    testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<double>(), 4.5);
+}
+
 } // namespace
 
 MAIN(testput)
 {
-    testPlan(39);
+    testPlan(55);
     testSetup();
     logger_config_env();
     Tester().loopback(false);
@@ -421,9 +551,12 @@ MAIN(testput)
     Tester().cancel();
     Tester().orphan();
     Tester().manualExec();
+    Tester().pipelineExec();
     TestPutBuilder().testSet();
     testRO();
     testError();
+    testCoalesce();
+    testEarlyExec();
     cleanup_for_valgrind();
     return testDone();
 }
@@ -129,6 +129,32 @@ void testPvMask()
     testTrue(testmask(val, mask));
 }
 
+void testMaskCache()
+{
+    testShow()<<__func__;
+
+    auto val = nt::NTScalar{TypeCode::String}.create();
+    auto type(Value::Helper::type(val));
+
+    auto req = TypeDef(TypeCode::Struct, {
+                           members::Struct("field", {
+                               members::Struct("value", {}),
+                           })
+                       }).create();
+
+    auto mask(request2maskCached(type, req));
+    testEq(mask->size(), type->size());
+    testTrue((*mask)[type->mlookup.at("value")]);
+    testFalse((*mask)[type->mlookup.at("alarm")]);
+
+    // same pvRequest type, and same prototype type, share a result
+    testEq(request2maskCached(type, req.cloneEmpty()).get(), mask.get());
+
+    // a different prototype type does not
+    auto other(Value::Helper::type(nt::NTScalar{TypeCode::String}.create()));
+    testNotEq(request2maskCached(other, req).get(), mask.get());
+}
+
 struct TestBuilder : client::detail::CommonBuilder<TestBuilder, client::detail::PRBase>
 {
     TestBuilder()
@@ -336,6 +362,28 @@ void testError()
     }
 }
 
+void testParseCache()
+{
+    testShow()<<__func__;
+
+    const char pvr[] = "field(value)record[queueSize=2]";
+    auto req1 = client::Context::request().pvRequest(pvr).build();
+    auto req2 = client::Context::request().pvRequest(pvr).build();
+    testTrue(req1.equalInst(req2))<<" same string shares one pvRequest";
+
+    // changing a builder after parse does not alter the cached result
+    auto req3 = client::Context::request()
+            .pvRequest(pvr)
+            .record("pipeline", true)
+            .build();
+    testFalse(req3.equalInst(req1));
+    testTrue(req3["record._options.pipeline"].as<bool>());
+    testFalse(req1["record._options.pipeline"].valid());
+
+    auto req4 = client::Context::request().pvRequest(pvr).build();
+    testTrue(req4.equalInst(req1));
+}
+
 void testBuilder()
 {
     testShow()<<__func__;
@@ -394,11 +442,12 @@ void testArgs()
 
 MAIN(testpvreq)
 {
-    testPlan(38);
+    testPlan(48);
     testSetup();
     logger_config_env();
     testPvRequest();
     testPvMask();
+    testMaskCache();
     testEmpty();
     testAssemble();
     testParseEmpty();
@@ -407,6 +456,7 @@ MAIN(testpvreq)
     testParse2();
     testValid();
     testError();
+    testParseCache();
     testBuilder();
     testArgs();
     cleanup_for_valgrind();
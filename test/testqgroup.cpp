@@ -689,11 +689,30 @@ void testConst()
               );
 }
 
+void testCoalesce()
+{
+    testDiag("%s", __func__);
+    TestClient ctxt;
+
+    TestSubscription sub(ctxt.monitor("co:grp"));
+    auto val(sub.waitForUpdate());
+    testFldEq<double>(val, "a", 0.0);
+    testFldEq<double>(val, "b", 0.0);
+    sub.testEmpty();
+
+    // A and B process in one chain, so their changes are posted together
+    testdbPutFieldOk("co:A", DBR_DOUBLE, 2.0);
+    val = sub.waitForUpdate();
+    testFldEq<double>(val, "a", 2.0);
+    testFldEq<double>(val, "b", 4.0);
+    sub.testEmpty();
+}
+
 } // namespace
 
 MAIN(testqgroup)
 {
-    testPlan(33);
+    testPlan(40);
     testSetup();
     {
         TestIOC ioc;
@@ -708,12 +727,14 @@ MAIN(testqgroup)
         testdbReadDatabase("ntenum.db", nullptr, "P=enm");
         testdbReadDatabase("iq.db", nullptr, "N=iq:");
         testdbReadDatabase("const.db", nullptr, "P=tst:");
+        testdbReadDatabase("coalesce.db", nullptr, "P=co:");
         ioc.init();
         testTable();
         testEnum();
         testImage();
         testIQ();
         testConst();
+        testCoalesce();
     }
     cleanup_for_valgrind();
     return testDone();
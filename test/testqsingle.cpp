@@ -16,6 +16,9 @@
 #include <epicsTime.h>
 #include <asTrapWrite.h>
 #include <generalTimeSup.h>
+#include <waveformRecord.h>
+
+#include <pvxs/iochooks.h>
 
 #include "testioc.h"
 #include "utilpvt.h"
@@ -425,6 +428,65 @@ void testGetArray()
     val = ctxt.get("test:wf:i32.[1:2]").exec()->wait(5.0);
     testStrEq(std::string(SB()<<val["value"].format()),
               "int32_t[] = {2}[5, 6]\n");
+
+    // array buffers are re-used, and sized by the current element count
+    {
+        const epicsInt32 lng[] = {8};
+        testdbPutArrFieldOk("test:wf:i32", DBF_LONG, NELEMENTS(lng), lng);
+    }
+    val = ctxt.get("test:wf:i32").exec()->wait(5.0);
+    testStrEq(std::string(SB()<<val["value"].format()),
+              "int32_t[] = {1}[8]\n");
+
+    {
+        const epicsInt32 lng[] = {9, 10, 11, 12, 13};
+        testdbPutArrFieldOk("test:wf:i32", DBF_LONG, NELEMENTS(lng), lng);
+    }
+    val = ctxt.get("test:wf:i32").exec()->wait(5.0);
+    testStrEq(std::string(SB()<<val["value"].format()),
+              "int32_t[] = {5}[9, 10, 11, 12, 13]\n");
+}
+
+void testPublishArray()
+{
+    testDiag("%s", __func__);
+    TestClient ctxt;
+
+    auto prec = (waveformRecord*)testdbRecordPtr("test:wf:f64");
+
+    testThrows<std::invalid_argument>([prec]() {
+        ioc::publishArray((dbCommon*)prec, "NONEXIST", shared_array<const void>());
+    });
+    testThrows<std::invalid_argument>([]() {
+        ioc::publishArray(testdbRecordPtr("test:ai"), "VAL", shared_array<const void>());
+    });
+
+    // as device support would, swap in a new buffer
+    shared_array<double> next({5.0, 6.0, 7.0});
+    auto frozen(next.freeze().castTo<const void>());
+    void* orig;
+    epicsUInt32 orignord;
+    dbScanLock((dbCommon*)prec);
+    orig = prec->bptr;
+    orignord = prec->nord;
+    prec->bptr = const_cast<void*>(frozen.data());
+    prec->nord = frozen.size();
+    ioc::publishArray((dbCommon*)prec, "VAL", frozen);
+    dbScanUnlock((dbCommon*)prec);
+
+    auto val(ctxt.get("test:wf:f64").exec()->wait(5.0));
+    testStrEq(std::string(SB()<<val["value"].format()),
+              "double[] = {3}[5, 6, 7]\n");
+
+    dbScanLock((dbCommon*)prec);
+    prec->bptr = orig;
+    prec->nord = orignord;
+    ioc::publishArray((dbCommon*)prec, "VAL", shared_array<const void>());
+    dbScanUnlock((dbCommon*)prec);
+
+    val = ctxt.get("test:wf:f64").exec()->wait(5.0);
+    testStrEq(std::string(SB()<<val["value"].format()),
+              "double[] = {3}[1, 2.2, 3]\n");
 }
 
 void testPut()
@@ -579,6 +641,33 @@ void testPutProc()
     testdbGetFieldEqual("test:counter", DBF_LONG, 1);
 }
 
+void testPutASGChange()
+{
+    testDiag("%s", __func__);
+    TestClient ctxt;
+
+    // puts through one channel share its security client, which must follow changes of ASG
+    try{
+        ctxt.put("test:ro").set("value", 1).exec()->wait(5.0);
+        testFail("test:ro was writable");
+    }catch(pvxs::client::RemoteError& e){
+        testStrEq(e.what(), "Put not permitted");
+    }
+
+    testdbPutFieldOk("test:ro.ASG", DBF_STRING, "DEFAULT");
+    ctxt.put("test:ro").set("value", 2).exec()->wait(5.0);
+    testdbGetFieldEqual("test:ro", DBF_LONG, 2);
+
+    testdbPutFieldOk("test:ro.ASG", DBF_STRING, "RO");
+    try{
+        ctxt.put("test:ro").set("value", 3).exec()->wait(5.0);
+        testFail("test:ro was writable");
+    }catch(pvxs::client::RemoteError& e){
+        testStrEq(e.what(), "Put not permitted");
+    }
+    testdbGetFieldEqual("test:ro", DBF_LONG, 2);
+}
+
 void testPutLog()
 {
     testDiag("%s", __func__);
@@ -869,11 +958,43 @@ void testMonitorAIFilt(TestClient& ctxt)
     sub2.testEmpty();
 }
 
+void testMonitorShared(TestClient& ctxt)
+{
+    testDiag("%s", __func__);
+
+    TestSubscription sub1(ctxt.monitor("test:bo")
+                         .maskConnected(true)
+                         .maskDisconnected(true));
+
+    auto val(sub1.waitForUpdate());
+    testFldEq(val, "value.index", 0);
+
+    // joins the DB subscription of sub1, and starts with the latest complete value
+    TestSubscription sub2(ctxt.monitor("test:bo")
+                         .maskConnected(true)
+                         .maskDisconnected(true));
+
+    val = sub2.waitForUpdate();
+    testFldEq(val, "value.index", 0);
+    testTrue(val["value.choices"].isMarked())<<" initial update includes meta-data";
+
+    testTimeSec++;
+    testdbPutFieldOk("test:bo", DBR_STRING, "One");
+
+    val = sub1.waitForUpdate();
+    testFldEq(val, "value.index", 1);
+    val = sub2.waitForUpdate();
+    testFldEq(val, "value.index", 1);
+
+    sub1.testEmpty();
+    sub2.testEmpty();
+}
+
 } // namespace
 
 MAIN(testqsingle)
 {
-    testPlan(84);
+    testPlan(106);
     testSetup();
     pvxs::logger_config_env();
     {
@@ -893,15 +1014,18 @@ MAIN(testqsingle)
         testGetScalar();
         testLongString();
         testGetArray();
+        testPublishArray();
         testPut();
         testGetPut64();
         testPutProc();
+        testPutASGChange();
         testPutLog();
         {
             TestClient mctxt;
             testMonitorAI(mctxt);
             testMonitorBO(mctxt);
             testMonitorAIFilt(mctxt);
+            testMonitorShared(mctxt);
         }
         timeSim = false;
         testPutBlock();
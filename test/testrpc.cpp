@@ -9,6 +9,8 @@
 #include <atomic>
 #include <sstream>
 
+#include <string.h>
+
 #include <testMain.h>
 
 #include <epicsUnitTest.h>
@@ -27,6 +29,39 @@
 namespace {
 using namespace pvxs;
 
+// reply to a streaming RPC with "n" chunks
+struct StreamSource : public server::Source
+{
+    std::vector<std::shared_ptr<server::MonitorControlOp>> subs;
+
+    virtual void onSearch(Search &op) override final
+    {
+        for(auto& name : op) {
+            if(strcmp(name.name(), "stream")==0)
+                name.claim();
+        }
+    }
+    virtual void onCreate(std::unique_ptr<server::ChannelControl> &&op) override final
+    {
+        auto chan = std::move(op);
+
+        chan->onSubscribe([this](std::unique_ptr<server::MonitorSetupOp>&& setup) {
+            auto arg(setup->pvRequest()["arg"].as<Value>());
+            auto n(arg["query.n"].as<uint32_t>());
+
+            auto proto(nt::NTScalar{TypeCode::UInt32}.create());
+            auto sub(setup->connect(proto));
+            for(auto i : range(n)) {
+                auto chunk(proto.cloneEmpty());
+                chunk["value"] = i;
+                sub->forcePost(chunk);
+            }
+            sub->finish();
+            subs.push_back(sub);
+        });
+    }
+};
+
 struct Tester {
     client::Result actual;
     epicsEvent start, done;
@@ -92,6 +127,31 @@ struct Tester {
         return Value();
     }
 
+    void pool()
+    {
+        testShow()<<__func__;
+
+        server::HandlerPool pool(2u);
+        mbox.handlerPool(pool);
+        mbox.open(initial);
+        serv.start();
+
+        wait = true;
+        auto arg = initial.cloneEmpty();
+        arg["value"] = 42;
+        auto op = doCall(std::move(arg));
+
+        // RPC handler is blocked, but not the server worker
+        testEq(cli.get("mailbox").exec()->wait(5.0)["value"].as<int32_t>(), 1);
+
+        start.signal();
+        if(auto ret = testWaitOk()) {
+            testEq(ret["value"].as<int32_t>(), 42);
+        } else {
+            testSkip(1, "no reply");
+        }
+    }
+
     void echo()
     {
         mbox.open(initial);
@@ -269,6 +329,122 @@ struct Tester {
             testEq(result["implLang"].as<std::string>(), "cpp");
             testStrMatch("PVXS.*", result["version"].as<std::string>());
         }
+
+        {
+            auto result(cli.rpc("server", uri.call("latency"))
+                        .server(servaddr).exec()->wait(5.0));
+
+            // the two RPCs above, but not this one which is still in progress
+            uint64_t nrpc = 0u;
+            for(auto& ent : result["value"].as<shared_array<const Value>>()) {
+                if(ent["source"].as<std::string>()=="__server" && ent["op"].as<std::string>()=="rpc") {
+                    for(auto c : ent["count"].as<shared_array<const uint64_t>>())
+                        nrpc += c;
+                }
+            }
+            testEq(nrpc, 2u);
+        }
+    }
+
+    void serverlist()
+    {
+        using namespace pvxs::members;
+        testShow()<<__func__;
+
+        auto src(server::StaticSource::build());
+        for(auto name : {"a:1", "a:2", "a:3", "b:1"})
+            src.add(name, mbox);
+        serv.addSource("listsrc", src.source());
+        serv.start();
+
+        std::string servaddr = SB()<<"127.0.0.1:"<<serv.config().tcp_port;
+
+        auto uri(nt::NTURI({
+                               String("op"),
+                               String("pattern"),
+                               String("after"),
+                               UInt64("limit"),
+                           }));
+
+        auto list = [this, &uri, &servaddr](const char* pattern, const char* after, uint64_t limit) {
+            auto result(cli.rpc("server", uri.call("channels", pattern, after, limit))
+                        .server(servaddr).exec()->wait(5.0));
+            return result["value"].as<shared_array<const std::string>>();
+        };
+
+        testArrEq(list("a:*", "", 2u), shared_array<const std::string>({"a:1", "a:2"}));
+        // next page
+        testArrEq(list("a:*", "a:2", 2u), shared_array<const std::string>({"a:3"}));
+        testArrEq(list("*:1", "", 0u), shared_array<const std::string>({"a:1", "b:1"}));
+    }
+
+    void snapshot()
+    {
+        using namespace pvxs::members;
+        testShow()<<__func__;
+
+        auto other(server::SharedPV::buildReadonly());
+        {
+            auto val(nt::NTScalar{TypeCode::String}.create());
+            val["value"] = "hello";
+            other.open(val);
+        }
+        mbox.open(initial);
+
+        auto src(server::StaticSource::build());
+        src.add("snap:mbox", mbox)
+           .add("snap:other", other)
+           .addSnapshot("snap");
+        serv.addSource("snapsrc", src.source());
+        serv.start();
+
+        auto arg(TypeDef(TypeCode::Struct, {
+                             StringA("names"),
+                         }).create());
+        arg["names"] = shared_array<const std::string>({"snap:mbox", "snap:other", "nonexistent"});
+
+        auto result(cli.rpc("snap", arg).exec()->wait(5.0));
+        testShow()<<result;
+
+        testArrEq(result["value.name"].as<shared_array<const std::string>>(),
+                  arg["names"].as<shared_array<const std::string>>());
+        auto values(result["value.value"].as<shared_array<const Value>>());
+        auto errors(result["value.error"].as<shared_array<const std::string>>());
+        testEq(values.size(), 3u);
+        testEq(errors.size(), 3u);
+        if(values.size()==3u && errors.size()==3u) {
+            testEq(values[0]["value"].as<int32_t>(), 1);
+            testEq(values[1]["value"].as<std::string>(), "hello");
+            testOk1(!values[2]);
+            testEq(errors[0], "");
+            testEq(errors[2], "No such PV");
+        } else {
+            testSkip(5, "wrong size");
+        }
+    }
+
+    void stream()
+    {
+        testShow()<<__func__;
+
+        serv.addSource("stream", std::make_shared<StreamSource>());
+        serv.start();
+
+        std::vector<uint32_t> chunks;
+        auto op(cli.rpc("stream")
+                .arg("n", 5u)
+                .record("queueSize", 2u)
+                .chunk([&chunks](Value&& chunk) {
+                    chunks.push_back(chunk["value"].as<uint32_t>());
+                })
+                .exec());
+        op->wait(5.0);
+
+        testEq(chunks.size(), 5u);
+        bool inorder = true;
+        for(auto i : range(chunks.size()))
+            inorder &= chunks[i]==i;
+        testTrue(inorder);
     }
 };
 
@@ -276,7 +452,7 @@ struct Tester {
 
 MAIN(testrpc)
 {
-    testPlan(23);
+    testPlan(41);
     testSetup();
     Tester().echo();
     Tester().lazy();
@@ -287,6 +463,10 @@ MAIN(testrpc)
     Tester().builder();
     Tester().orphan();
     Tester().serversrc();
+    Tester().serverlist();
+    Tester().snapshot();
+    Tester().stream();
+    Tester().pool();
     cleanup_for_valgrind();
     return testDone();
 }
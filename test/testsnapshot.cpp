@@ -0,0 +1,88 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <fstream>
+
+#include <stdio.h>
+
+#include <testMain.h>
+
+#include <epicsUnitTest.h>
+
+#include <pvxs/unittest.h>
+#include <pvxs/nt.h>
+#include <pvxs/snapshot.h>
+#include "utilpvt.h"
+
+namespace {
+
+using namespace pvxs;
+
+const char fname[] = "testsnapshot.snap";
+
+void testRoundTrip()
+{
+    testDiag("In %s", __func__);
+
+    auto dbl(nt::NTScalar{TypeCode::Float64, true}.create());
+    auto str(nt::NTScalar{TypeCode::String}.create());
+
+    auto a(dbl.cloneEmpty());
+    a["value"] = 1.5;
+    a["display.units"] = "mm";
+    a["alarm.severity"] = 2;
+    {
+        SnapshotWriter W(fname);
+        W.add("b", dbl.cloneEmpty());
+        W.add("a", dbl.cloneEmpty()); // replaced below
+        W.add("c", str.cloneEmpty());
+        W.add("a", a);
+        W.close();
+    }
+
+    Snapshot S(fname);
+    testEq(S.size(), 3u);
+    {
+        std::string names;
+        for(auto& name : S.names())
+            names += name + ",";
+        testStrEq(names, "a,b,c,");
+    }
+    testStrEq(std::string(SB()<<S.get("a")), std::string(SB()<<a));
+    testEq(S.get("b")["value"].as<double>(), 0.0);
+    testEq(S.get("c")["value"].type(), TypeCode::String);
+    testFalse(!!S.get("nosuch"));
+}
+
+void testInvalid()
+{
+    testDiag("In %s", __func__);
+
+    {
+        std::ofstream out(fname);
+        out<<"not a snapshot file, but long enough to have a header";
+    }
+    testThrows<std::runtime_error>([]() {
+        Snapshot S(fname);
+    });
+
+    remove(fname);
+    testThrows<std::runtime_error>([]() {
+        Snapshot S(fname);
+    });
+}
+
+} // namespace
+
+MAIN(testsnapshot)
+{
+    testPlan(8);
+    testSetup();
+    testRoundTrip();
+    testInvalid();
+    cleanup_for_valgrind();
+    return testDone();
+}
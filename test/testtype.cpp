@@ -651,6 +651,64 @@ void testFormat()
     );
 }
 
+// appendTo() must match operator<<
+void testFormatAppend()
+{
+    testDiag("%s()", __func__);
+
+    Value top(neckBolt());
+
+    top["scalar.i32"] = -42;
+    top["scalar.u32"] = 42;
+    top["scalar.b"] = true;
+    top["scalar.f64"] = 1.0/3.0;
+    top["scalar.s"] = "tab\there \x01\xfe";
+    top["scalar.wildcard"] = 1e100;
+    top["scalar.choice->one"] = -2147483647-1;
+
+    top["array.i32"] = shared_array<int32_t>({1,-1,2,-3}).freeze().castTo<const void>();
+    top["array.s"] = shared_array<std::string>({"one", "\"two\""}).freeze().castTo<const void>();
+    {
+        auto fld = top["array.choice"];
+        shared_array<Value> arr(2);
+        (arr[0] = fld.allocMember())["->two.ahalf"] = 2468;
+        // arr[1] left null
+        fld = arr.freeze().castTo<const void>();
+    }
+
+    auto other(TypeDef(TypeCode::Struct, {
+                           members::Int8("i8"),
+                           members::UInt8("u8"),
+                           members::Int64("i64"),
+                           members::UInt64("u64"),
+                           members::Float32("f32"),
+                           members::BoolA("ba"),
+                           members::UInt8A("u8a"),
+                           members::Float32A("f32a"),
+                       }).create());
+    other["i8"] = 65;
+    other["u8"] = 66;
+    other["i64"] = -int64_t(0x7fffffffffffffffll) - 1;
+    other["u64"] = uint64_t(-1);
+    other["f32"] = 0.1f;
+    other["ba"] = shared_array<bool>({true, false}).freeze().castTo<const void>();
+    other["u8a"] = shared_array<uint8_t>({0u, 255u}).freeze().castTo<const void>();
+    other["f32a"] = shared_array<float>({1.5e-30f, -0.25f, 1e30f}).freeze().castTo<const void>();
+
+    for(auto val : {top, other}) {
+        val.mark();
+        for(auto fmt : {val.format(),
+                        val.format().arrayLimit(1u),
+                        val.format().showValue(false),
+                        val.format().delta()})
+        {
+            std::string buf("prefix");
+            fmt.appendTo(buf);
+            testStrEq(buf, std::string(SB()<<"prefix"<<fmt));
+        }
+    }
+}
+
 void testAppendBig()
 {
     auto orig(neckBolt());
@@ -663,7 +721,7 @@ void testAppendBig()
 
 MAIN(testtype)
 {
-    testPlan(71);
+    testPlan(79);
     testSetup();
     showSize();
     testCode();
@@ -674,6 +732,7 @@ MAIN(testtype)
     testTypeDefAppendIncremental();
     testOp();
     testFormat();
+    testFormatAppend();
     testAppendBig();
     cleanup_for_valgrind();
     return testDone();
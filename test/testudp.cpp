@@ -5,6 +5,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 
 #include <testMain.h>
@@ -14,10 +15,17 @@
 #include <osiSock.h>
 #include <event2/util.h>
 #include <epicsEvent.h>
+#include <epicsThread.h>
 
 #include <pvxs/log.h>
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
 #include "evhelper.h"
 #include <udp_collector.h>
+#include "mcastmon.h"
+#include "utilpvt.h"
 
 namespace {
 using namespace pvxs;
@@ -146,12 +154,201 @@ void testSearch(bool be, std::initializer_list<const char*> names)
     testOk1(!!rx.wait(30.0));
 }
 
+void testSearchBurst()
+{
+    testDiag("In %s", __func__);
+
+    SockAddr listener(SockAddr::loopback(AF_INET));
+    SockAddr sender(SockAddr::loopback(AF_INET));
+
+    evsocket sock(AF_INET, SOCK_DGRAM, 0);
+    sock.bind(sender);
+    testDiag("Sending from %s", sender.tostring().c_str());
+
+    // more than one RX batch
+    constexpr uint32_t nsearch = 40u;
+
+    epicsEvent done;
+    std::atomic<uint32_t> nrx{0u}, nbatch{0u};
+    std::vector<uint32_t> pending; // only accessed from UDP worker
+    auto manager = UDPManager::instance();
+    auto sub = manager.onSearch(listener, [&pending](const UDPManager::Search& msg)
+    {
+        pending.push_back(msg.searchID);
+    }, [&done, &nrx, &nbatch, &pending, &sender](const UDPManager::Search& msg)
+    {
+        // echo back searchIDs at the end of each batch
+        nbatch++;
+        for(auto id : pending) {
+            uint8_t reply[4];
+            memcpy(reply, &id, sizeof(reply));
+            (void)msg.replyTo(sender, reply, sizeof(reply));
+
+            if(++nrx == nsearch)
+                done.signal();
+        }
+        pending.clear();
+    });
+    sub->start();
+
+    for(auto id : range(nsearch)) {
+        std::vector<uint8_t> msg(1024, 0);
+        VectorOutBuf M(true, msg);
+
+        M.skip(8, __FILE__, __LINE__); // placeholder for header
+        to_wire(M, uint32_t(id));
+        M.skip(4, __FILE__, __LINE__);
+        to_wire(M, SockAddr::any(AF_INET));
+        to_wire(M, uint16_t(sender.port())); // reply to sender
+        to_wire(M, Size{1});
+        to_wire(M, "tcp");
+        to_wire(M, uint16_t(1u));
+        to_wire(M, uint32_t(1u));
+        to_wire(M, "burst");
+
+        auto pktlen = M.save()-msg.data();
+
+        FixedBuf H(true, msg.data(), 8);
+        to_wire(H, Header{CMD_SEARCH, 0, uint32_t(pktlen-8)});
+
+        if(sendto(sock.sock, (char*)msg.data(), pktlen, 0, &listener->sa, listener.size())!=int(pktlen))
+            testFail("Unable to send search %u", unsigned(id));
+    }
+
+    testOk1(!!done.wait(30.0));
+    manager.sync();
+    testEq(nrx.load(), nsearch);
+    testOk(nbatch.load()>=1u && nbatch.load()<=nsearch, "%u batches", unsigned(nbatch.load()));
+
+    std::vector<bool> seen(nsearch, false);
+    uint32_t nreply = 0u;
+    for(unsigned retry = 0; nreply<nsearch && retry<100; ) {
+        uint8_t reply[16];
+        if(recv(sock.sock, (char*)reply, sizeof(reply), 0)==4) {
+            uint32_t id;
+            memcpy(&id, reply, sizeof(id));
+            if(id<nsearch && !seen[id]) {
+                seen[id] = true;
+                nreply++;
+            }
+        } else {
+            epicsThreadSleep(0.01);
+            retry++;
+        }
+    }
+    testEq(nreply, nsearch);
+}
+
+void testMonitor()
+{
+    testDiag("In %s", __func__);
+
+    SockEndpoint listener(SockAddr::loopback(AF_INET));
+
+    evsocket sock(AF_INET, SOCK_DGRAM, 0);
+
+    epicsEvent rx;
+    MCastUpdate update;
+    bool ok = false;
+    auto manager = UDPManager::instance();
+    auto sub = manager.onMonitor(listener, [&rx, &update, &ok](const UDPManager::Monitor& msg)
+    {
+        std::string name;
+        if(peekMCastUpdate(name, msg) && name=="pv:b") {
+            ok = decodeMCastUpdate(update, msg);
+            rx.signal();
+        }
+    });
+    sub->start();
+
+    testDiag("Listen on %s", listener.addr.tostring().c_str());
+
+    auto val(nt::NTScalar{TypeCode::Float64}.create());
+    val["value"] = 4.5;
+    auto changed(val.cloneEmpty());
+    changed["value"] = 4.5;
+
+    std::vector<uint8_t> msg;
+    for(auto name : {"pv:a", "pv:b"}) {
+        encodeMCastUpdate(msg, name, 7u, val, changed);
+        testOk1(sendto(sock.sock, (char*)msg.data(), msg.size(), 0,
+                       &listener.addr->sa, listener.addr.size())==int(msg.size()));
+    }
+    manager.sync();
+    testOk1(!!rx.wait(30.0));
+    testTrue(ok);
+    testEq(update.seq, 7u);
+    testEq(update.val["value"].as<double>(), 4.5);
+    testTrue(update.val["value"].isMarked());
+    testFalse(update.val["alarm.severity"].isMarked());
+}
+
+Value pop(const std::shared_ptr<client::Subscription>& sub, epicsEvent& evt)
+{
+    while(true) {
+        if(auto ret = sub->pop()) {
+            return ret;
+
+        } else if (!evt.wait(5.0)) {
+            testFail("timeout waiting for event");
+            return Value();
+        }
+    }
+}
+
+void testMonitorPV()
+{
+    testDiag("In %s", __func__);
+
+    // hold a port
+    SockEndpoint ep(SockAddr::loopback(AF_INET));
+    auto manager = UDPManager::instance();
+    auto hold = manager.onMonitor(ep, [](const UDPManager::Monitor&) {});
+    const auto dest(ep.addr.tostring());
+    testDiag("Send to %s", dest.c_str());
+
+    auto pv(server::SharedPV::buildReadonly());
+    pv.multicast("mcast:pv", dest, 0.1);
+
+    auto cli(server::Config::isolated().build().clientConfig().build());
+
+    epicsEvent evt;
+    auto sub(cli.monitor("mcast:pv")
+             .multicast(dest)
+             .maskConnected(false)
+             .event([&evt](client::Subscription&) {
+                 evt.signal();
+             })
+             .exec());
+
+    auto initial(nt::NTScalar{TypeCode::Int32}.create());
+    initial["value"] = 1;
+    pv.open(initial);
+
+    testThrows<client::Connected>([&sub, &evt]() {
+        pop(sub, evt);
+    });
+
+    auto val(pop(sub, evt));
+    testEq(val["value"].as<int32_t>(), 1);
+    testTrue(val.isMarked());
+
+    auto update(initial.cloneEmpty());
+    update["value"] = 2;
+    pv.post(update);
+
+    val = pop(sub, evt);
+    testEq(val["value"].as<int32_t>(), 2);
+    testTrue(val["value"].isMarked());
+    testFalse(val["alarm.severity"].isMarked());
+}
+
 } // namespace
 
 int main(int argc, char *argv[])
 {
     SockAttach attach;
-    testPlan(46);
+    testPlan(64);
     testSetup();
     pvxs::logger_config_env();
     testBeacon(true);
@@ -160,6 +357,9 @@ int main(int argc, char *argv[])
     testSearch(false, {"hello"});
     testSearch(true , {"one", "two"});
     testSearch(false, {"one", "two"});
+    testSearchBurst();
+    testMonitor();
+    testMonitorPV();
     cleanup_for_valgrind();
     return testDone();
 }
@@ -16,7 +16,9 @@
 
 #include <pvxs/unittest.h>
 #include <pvxs/util.h>
+#include <pvxs/data.h>
 #include <utilpvt.h>
+#include <opslab.h>
 
 namespace {
 using namespace pvxs;
@@ -121,11 +123,11 @@ struct Receiver : public epicsThreadRunable
     }
 };
 
-void testSpamMany()
+void testSpamMany(size_t limit)
 {
-    testShow()<<__func__;
+    testShow()<<__func__<<"("<<limit<<")";
 
-    MPMCFIFO<int> Q(32u);
+    MPMCFIFO<int> Q(limit);
     std::array<std::atomic<bool>, 1024> rxd{};
 
     Spammer A(Q, 0, 256);
@@ -267,18 +269,85 @@ void testStrDiff()
           "+ \" yyy\"\n");
 }
 
+std::string showCPUs(const std::string& inp)
+{
+    std::ostringstream strm;
+    bool first = true;
+    for(auto cpu : parseCPUList(inp)) {
+        if(!first)
+            strm<<',';
+        first = false;
+        strm<<cpu;
+    }
+    return strm.str();
+}
+
+void testCPUList()
+{
+    testShow()<<__func__;
+
+    testEq(showCPUs(""), "");
+    testEq(showCPUs("3"), "3");
+    testEq(showCPUs("4-6,1"), "1,4,5,6");
+    testEq(showCPUs("2,2-3, 0"), "0,2,3");
+
+    testThrows<NoConvert>([](){ parseCPUList("1,"); });
+    testThrows<NoConvert>([](){ parseCPUList("3-1"); });
+    testThrows<NoConvert>([](){ parseCPUList("x"); });
+
+    auto groups(parseCPUGroups("0-1;3,2"));
+    testEq(groups.size(), 2u);
+    if(groups.size()==2u)
+        testEq(groups[1].size(), 2u);
+    else
+        testSkip(1, "no group");
+    testEq(parseCPUGroups("").size(), 0u);
+    testThrows<NoConvert>([](){ parseCPUGroups("0;;1"); });
+    testShow()<<"NUMA nodes: "<<parseCPUGroups("numa").size();
+}
+
+void testOpSlab()
+{
+    testShow()<<__func__;
+
+    auto slab(std::make_shared<impl::OpSlab>(2u));
+    const void* first;
+    {
+        auto a(impl::allocateOp<std::string>(slab, "hello"));
+        testEq(*a, "hello");
+        first = a.get();
+    }
+    testTrue(slab->spareBytes()>0u);
+    {
+        auto b(impl::allocateOp<std::string>(slab, "world"));
+        testTrue(first==b.get())<<" block re-used";
+        testEq(slab->spareBytes(), 0u);
+    }
+
+    // may outlive the slab
+    auto c(impl::allocateOp<std::string>(slab, "x"));
+    slab.reset();
+    testEq(*c, "x");
+
+    testEq(*impl::allocateOp<std::string>(nullptr, "y"), "y");
+}
+
 } // namespace
 
 MAIN(testutil)
 {
-    testPlan(33);
+    testPlan(52);
     testTrue(version_abi_check())<<" 0x"<<std::hex<<PVXS_VERSION<<" ~= 0x"<<std::hex<<PVXS_ABI_VERSION;
     testServerGUID();
     testFill();
     testSpam();
-    testSpamMany();
+    testSpamMany(32u);
+    testSpamMany(1u);
+    testSpamMany(0u); // unbounded
     testAccount();
     testTestEq();
     testStrDiff();
+    testCPUList();
+    testOpSlab();
     return testDone();
 }
@@ -14,6 +14,7 @@
 #include <pvxs/nt.h>
 #include "dataimpl.h"
 #include "pvaproto.h"
+#include "evhelper.h"
 
 namespace {
 using namespace pvxs;
@@ -1200,11 +1201,426 @@ void testEmptyRequest()
            "[0] struct  parent=[0]  [0:1)\n")<<"\nActual descs2\n"<<descs2.data();
 }
 
+void testArrayByRef()
+{
+    testDiag("%s", __func__);
+
+    TypeDef def(TypeCode::Struct, {members::UInt32A("value")});
+
+    for(auto be : {hostBE, !hostBE}) {
+        testShow()<<"be="<<be;
+
+        shared_array<uint32_t> arr(minRefBytes/4u);
+        for(auto i : range(arr.size()))
+            arr[i] = 0x01020304u + i;
+
+        auto val(def.create());
+        val["value"] = arr.freeze();
+        auto sent(val["value"].as<shared_array<const uint32_t>>());
+        auto before = sent.dataPtr().use_count();
+
+        evbuf buf(__FILE__, __LINE__, evbuffer_new());
+        {
+            EvOutBuf M(be, buf.get());
+            to_wire_valid(M, val);
+            testTrue(M.good());
+        }
+
+        // native byte order references, instead of copying
+        testEq(sent.dataPtr().use_count(), before + (be==hostBE ? 1 : 0));
+
+        TypeStore ctxt;
+        auto val2(def.create());
+        {
+            EvInBuf M(be, buf.get());
+            from_wire_valid(M, ctxt, val2);
+            testTrue(M.good());
+        }
+        testEq(evbuffer_get_length(buf.get()), 0u);
+        testArrEq(sent, val2["value"].as<shared_array<const uint32_t>>());
+
+        // released when evbuffer drained
+        testEq(sent.dataPtr().use_count(), before);
+    }
+}
+
+void testArrayPool()
+{
+    testDiag("%s", __func__);
+
+    TypeDef def(TypeCode::Struct, {members::UInt32A("value")});
+
+    shared_array<uint32_t> arr(minRefBytes/4u);
+    for(auto i : range(arr.size()))
+        arr[i] = 0x01020304u + i;
+
+    auto val(def.create());
+    val["value"] = arr.freeze();
+    auto sent(val["value"].as<shared_array<const uint32_t>>());
+
+    evbuf buf(__FILE__, __LINE__, evbuffer_new());
+    {
+        EvOutBuf M(hostBE, buf.get());
+        to_wire_valid(M, val);
+        to_wire_valid(M, val);
+    }
+
+    auto pool(std::make_shared<ArrayPool>(2u));
+    TypeStore ctxt;
+
+    auto val2(def.create());
+    {
+        EvInBuf M(hostBE, buf.get());
+        from_wire_valid(M, ctxt, val2, pool.get());
+        testTrue(M.good());
+    }
+    auto first = val2["value"].as<shared_array<const uint32_t>>().data();
+    testEq(pool->spares(), 0u);
+    val2 = Value();
+    testEq(pool->spares(), 1u);
+
+    auto val3(def.create());
+    {
+        EvInBuf M(hostBE, buf.get());
+        from_wire_valid(M, ctxt, val3, pool.get());
+        testTrue(M.good());
+    }
+    auto second(val3["value"].as<shared_array<const uint32_t>>());
+    testEq(second.data(), first)<<" storage re-used";
+    testArrEq(sent, second);
+    testEq(pool->spares(), 0u);
+
+    // arrays may outlive their pool
+    pool.reset();
+}
+
+void testStringArray()
+{
+    testDiag("%s", __func__);
+
+    TypeDef def(TypeCode::Struct, {members::StringA("value")});
+
+    // a mix of empty, short, and long (not SSO) strings
+    shared_array<std::string> arr(1000u);
+    for(auto i : range(arr.size()))
+        arr[i] = std::string(i%67u, char('a' + i%26u));
+
+    auto val(def.create());
+    val["value"] = arr.freeze();
+    auto sent(val["value"].as<shared_array<const std::string>>());
+
+    for(auto be : {hostBE, !hostBE}) {
+        testShow()<<"be="<<be;
+
+        evbuf buf(__FILE__, __LINE__, evbuffer_new());
+        {
+            EvOutBuf M(be, buf.get());
+            to_wire_valid(M, val);
+            testTrue(M.good());
+        }
+
+        TypeStore ctxt;
+        auto val2(def.create());
+        {
+            EvInBuf M(be, buf.get());
+            from_wire_valid(M, ctxt, val2);
+            testTrue(M.good());
+        }
+        testEq(evbuffer_get_length(buf.get()), 0u);
+        testArrEq(sent, val2["value"].as<shared_array<const std::string>>());
+    }
+}
+
+void testParallelEncode()
+{
+    testDiag("%s", __func__);
+
+    TypeDef def(TypeCode::Struct, {
+                    members::Float64A("x"),
+                    members::UInt32("n"),
+                    members::Float64A("y"),
+                    members::StringA("names"),
+                });
+
+    shared_array<double> x(minAsideBytes/sizeof(double)), y(x.size());
+    for(auto i : range(x.size())) {
+        x[i] = 0.5*i;
+        y[i] = -1.0*i;
+    }
+    shared_array<std::string> names(minAsideBytes/sizeof(std::string));
+    for(auto i : range(names.size()))
+        names[i] = std::string(i%37u, char('A' + i%26u));
+
+    auto val(def.create());
+    val["x"] = x.freeze();
+    val["n"] = 42u;
+    val["y"] = y.freeze();
+    val["names"] = names.freeze();
+
+    for(auto be : {hostBE, !hostBE}) {
+        testShow()<<"be="<<be;
+
+        std::vector<uint8_t> bytes[2];
+        for(auto parallel : {false, true}) {
+            evbuf buf(__FILE__, __LINE__, evbuffer_new());
+            {
+                EvOutBuf M(be, buf.get(), 0u, parallel);
+                to_wire_valid(M, val);
+                to_wire(M, uint32_t(0xdeadbeef));
+            }
+            auto& out = bytes[parallel];
+            out.resize(evbuffer_get_length(buf.get()));
+            testOk1(evbuffer_remove(buf.get(), out.data(), out.size())==int(out.size()));
+        }
+        testTrue(bytes[0]==bytes[1])<<" parallel encoding identical to serial";
+    }
+}
+
+void testVariantCache()
+{
+    testDiag("%s", __func__);
+
+    TypeDef def(TypeCode::Struct, {members::Any("value")});
+    testTrue(WirePlan(Value::Helper::desc(def.create())).variant);
+    testFalse(WirePlan(Value::Helper::desc(TypeDef(TypeCode::Struct, {members::Int32("value")}).create())).variant);
+
+    auto val(def.create());
+    val["value"] = nt::NTScalar{TypeCode::Float64}.create().update("value", 4.5);
+
+    TypeCache types;
+    TypeStore ctxt;
+    size_t sizes[2];
+
+    for(auto i : range(2u)) {
+        evbuf buf(__FILE__, __LINE__, evbuffer_new());
+        {
+            EvOutBuf M(hostBE, buf.get());
+            to_wire_valid(M, val, nullptr, &types);
+            testTrue(M.good());
+        }
+        sizes[i] = evbuffer_get_length(buf.get());
+
+        auto val2(def.create());
+        {
+            EvInBuf M(hostBE, buf.get());
+            from_wire_valid(M, ctxt, val2);
+            testTrue(M.good());
+        }
+        testEq(val2["value"].as<Value>()["value"].as<double>(), 4.5);
+    }
+    // second time, variant type sent as a reference
+    testTrue(sizes[1] < sizes[0])<<" "<<sizes[1]<<" < "<<sizes[0];
+    testEq(types.hits, 1u);
+}
+
 } // namespace
 
+void testBSwapArray()
+{
+    testDiag("%s", __func__);
+
+    for(size_t esize : {2u, 4u, 8u}) {
+        bool ok = true, okInPlace = true;
+
+        // lengths around the SIMD block sizes, at unaligned offsets
+        for(size_t nelem : {0u, 1u, 3u, 15u, 16u, 17u, 33u, 100u}) {
+            const size_t nbytes = nelem*esize;
+            for(size_t off : {0u, 1u}) {
+                std::vector<uint8_t> src(off+nbytes), dest(off+nbytes), expect(nbytes);
+                for(auto i : range(nbytes))
+                    src[off+i] = uint8_t(i*7u + esize);
+                for(size_t i=0u; i<nbytes; i+=esize) {
+                    for(auto n : range(esize))
+                        expect[i + esize-1u-n] = src[off + i + n];
+                }
+
+                bswapArray(dest.data()+off, src.data()+off, nbytes, esize);
+                ok &= std::equal(expect.begin(), expect.end(), dest.begin()+off);
+
+                bswapArray(src.data()+off, src.data()+off, nbytes, esize);
+                okInPlace &= std::equal(expect.begin(), expect.end(), src.begin()+off);
+            }
+        }
+
+        testTrue(ok)<<" esize="<<esize;
+        testTrue(okInPlace)<<" in place esize="<<esize;
+    }
+}
+
+void testTypeCache()
+{
+    testDiag("%s", __func__);
+
+    // equivalent types, built separately
+    auto A(TypeDef(TypeCode::Struct, "s", {Member(TypeCode::Int32, "x")}).create());
+    auto A2(TypeDef(TypeCode::Struct, "s", {Member(TypeCode::Int32, "x")}).create());
+    auto B(TypeDef(TypeCode::Struct, "s", {Member(TypeCode::Int32, "y")}).create());
+
+    {
+        TypeCache cache(1u);
+
+        testToBytes(true, [&A, &cache](Buffer& buf) {
+            to_wire(buf, Value::Helper::desc(A), cache);
+        }, "\xfd\x00\x00\x80\x01s\x01\x01x\x22");
+
+        testToBytes(true, [&A2, &cache](Buffer& buf) {
+            to_wire(buf, Value::Helper::desc(A2), cache);
+        }, "\xfe\x00\x00");
+
+        testEq(cache.hits, 1u);
+        testEq(cache.misses, 1u);
+
+        // exceeds limit, so forgets A
+        testToBytes(true, [&B, &cache](Buffer& buf) {
+            to_wire(buf, Value::Helper::desc(B), cache);
+        }, "\xfd\x00\x01\x80\x01s\x01\x01y\x22");
+
+        testEq(cache.size(), 1u);
+        testEq(cache.evictions, 1u);
+
+        // keys are not re-used
+        testToBytes(true, [&A, &cache](Buffer& buf) {
+            to_wire(buf, Value::Helper::desc(A), cache);
+        }, "\xfd\x00\x02\x80\x01s\x01\x01x\x22");
+    }
+
+    {
+        // round trip
+        TypeCache cache;
+        std::vector<uint8_t> msg;
+        {
+            VectorOutBuf S(true, msg);
+            to_wire(S, Value::Helper::desc(A), cache);
+            to_wire(S, Value::Helper::desc(A2), cache);
+            msg.resize(msg.size()-S.size());
+        }
+
+        TypeStore store;
+        std::vector<FieldDesc> descs, descs2;
+        FixedBuf S(true, msg);
+        from_wire(S, descs, store);
+        from_wire(S, descs2, store);
+        testTrue(S.good() && S.empty());
+        testEq(store.size(), 1u);
+        if(testEq(descs2.size(), 2u)) {
+            testEq(descs2[0].miter.size(), 1u);
+            testEq(descs2[0].miter[0].first, "x");
+        }
+    }
+
+    {
+        // a peer re-using a key replaces the cache entry
+        TypeStore store;
+        std::vector<uint8_t> msg({
+            0xfd, 0x00, 0x07, 0x80, 0x01, 's', 0x01, 0x01, 'x', 0x22,
+            0xfd, 0x00, 0x07, 0x80, 0x01, 's', 0x01, 0x01, 'y', 0x22,
+            0xfe, 0x00, 0x07});
+        std::vector<FieldDesc> descs, descs2, descs3;
+        FixedBuf S(true, msg);
+        from_wire(S, descs, store);
+        from_wire(S, descs2, store);
+        from_wire(S, descs3, store);
+        testTrue(S.good() && S.empty());
+        if(testEq(descs3.size(), 2u)) {
+            testEq(descs3[0].miter[0].first, "y");
+        }
+    }
+}
+
+void testWirePlan()
+{
+    testDiag("%s", __func__);
+
+    auto val(nt::NTScalar{TypeCode::Float64, true, true, true, true}.create());
+    // includes a sub-struct, and fields handled by the generic path
+    val["value"] = 4.5;
+    val["alarm"].mark();
+    val["alarm.severity"] = 2;
+    val["alarm.message"] = "hello";
+    val["timeStamp.userTag"] = 42;
+    val["display.form.choices"] = shared_array<const std::string>({"A", "B"});
+
+    auto desc = Value::Helper::desc(val);
+
+    BitMask mask(desc->size());
+    for(auto name : {"value", "alarm", "display"}) {
+        auto fld(val[name]);
+        auto bit = Value::Helper::desc(fld) - desc;
+        for(auto i : range(Value::Helper::desc(fld)->size()))
+            mask[bit+i] = true;
+    }
+
+    for(auto pmask : {(const BitMask*)nullptr, (const BitMask*)&mask}) {
+        WirePlan plan(desc, pmask);
+
+        std::vector<uint8_t> generic, planned;
+        {
+            VectorOutBuf S(true, generic);
+            to_wire_valid(S, val, pmask);
+            generic.resize(generic.size()-S.size());
+        }
+        {
+            VectorOutBuf S(true, planned);
+            to_wire_valid(S, val, plan);
+            planned.resize(planned.size()-S.size());
+        }
+        testEq(std::string(planned.begin(), planned.end()), std::string(generic.begin(), generic.end()))
+                <<" mask="<<(pmask ? "yes" : "no");
+
+        TypeStore ctxt;
+        auto out(val.cloneEmpty());
+        WirePlan outplan(Value::Helper::desc(out));
+        FixedBuf S(true, planned);
+        from_wire_valid(S, ctxt, out, outplan);
+        testTrue(S.good() && S.empty());
+
+        testEq(out["value"].as<double>(), 4.5);
+        testEq(out["alarm.severity"].as<int32_t>(), 2);
+        testEq(out["alarm.message"].as<std::string>(), "hello");
+        testEq(out["timeStamp.userTag"].isMarked(), !pmask);
+        testEq(out["display.form.choices"].as<shared_array<const std::string>>().size(), 2u);
+    }
+}
+
+void testInternType()
+{
+    testDiag("%s", __func__);
+
+    auto encode = [](const Value& proto) -> std::vector<uint8_t> {
+        std::vector<uint8_t> msg;
+        VectorOutBuf S(true, msg);
+        to_wire(S, Value::Helper::desc(proto));
+        msg.resize(msg.size()-S.size());
+        return msg;
+    };
+    auto decode = [](const std::vector<uint8_t>& msg) -> Value {
+        TypeStore registry; // as if from different connections
+        Value ret;
+        FixedBuf S(true, msg);
+        from_wire_type(S, registry, ret);
+        testTrue(S.good() && S.empty());
+        return ret;
+    };
+
+    auto local(nt::NTScalar{TypeCode::Float64, true}.create());
+    auto msgA(encode(local));
+    auto msgB(encode(nt::NTScalar{TypeCode::Int32, true}.create()));
+
+    auto A1(decode(msgA)), A2(decode(msgA)), B(decode(msgB));
+
+    testEq(Value::Helper::desc(A1), Value::Helper::desc(A2));
+    testNotEq(Value::Helper::desc(A1), Value::Helper::desc(B));
+    testTrue(A1.equalType(local));
+
+    // storage is not shared
+    A1["value"] = 1.0;
+    A2["value"] = 2.0;
+    testEq(A1["value"].as<double>(), 1.0);
+}
+
 MAIN(testxcode)
 {
-    testPlan(142);
+    testPlan(228);
     testSetup();
     testDeserializeString();
     testSerialize1();
@@ -1221,5 +1637,14 @@ MAIN(testxcode)
     testRegressCNEN();
     testBadFieldName();
     testEmptyRequest();
+    testArrayByRef();
+    testArrayPool();
+    testStringArray();
+    testParallelEncode();
+    testVariantCache();
+    testBSwapArray();
+    testTypeCache();
+    testWirePlan();
+    testInternType();
     return testDone();
 }
@@ -56,6 +56,8 @@ void usage(const char* argv0)
             "  -d        Shorthand for $PVXS_LOG=\"pvxs.*=DEBUG\".  Make a lot of noise.\n"
             "  -w <sec>  Operation timeout in seconds.  Default 5 sec.  '0' disables timeout,\n"
             "            useful in combination with '-v'.\n"
+            "  -g <glob> When listing PVs, only those with names matching this pattern.\n"
+            "            Evaluated by the server.  eg. 'prefix:*'\n"
             ;
 }
 
@@ -69,10 +71,11 @@ int main(int argc, char *argv[])
         bool verbose = false;
         bool info = false;
         bool active = true;
+        std::string pattern;
 
         {
             int opt;
-            while ((opt = getopt(argc, argv, "hVApivdw:")) != -1) {
+            while ((opt = getopt(argc, argv, "hVApivdw:g:")) != -1) {
                 switch(opt) {
                 case 'h':
                     usage(argv[0]);
@@ -98,6 +101,9 @@ int main(int argc, char *argv[])
                 case 'w':
                     timeout = parseTo<double>(optarg);
                     break;
+                case 'g':
+                    pattern = optarg;
+                    break;
                 default:
                     usage(argv[0]);
                     std::cerr<<"\nUnknown argument: "<<char(opt)<<std::endl;
@@ -156,9 +162,13 @@ int main(int argc, char *argv[])
             std::atomic<int> remaining{argc-optind};
 
             for(auto n : range(optind, argc)) {
-                ops.push_back(ctxt.rpc("server")
-                              .server(argv[n])
-                              .arg("op", info ? "info" : "channels")
+                auto builder(ctxt.rpc("server")
+                             .server(argv[n])
+                             .arg("op", info ? "info" : "channels"));
+                if(!info && !pattern.empty())
+                    builder.arg("pattern", pattern);
+
+                ops.push_back(builder
                               .result([argv, n, info, verbose, &remaining, &done](client::Result&& r)
                       {
                           try {
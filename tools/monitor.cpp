@@ -7,12 +7,18 @@
 #include <iostream>
 #include <list>
 #include <atomic>
+#include <vector>
+#include <string>
+#include <stdexcept>
 
+#include <cmath>
+#include <cstdio>
 #include <cstring>
 
 #include <epicsVersion.h>
 #include <epicsGetopt.h>
 #include <epicsThread.h>
+#include <epicsTime.h>
 
 #include <pvxs/client.h>
 #include <pvxs/log.h>
@@ -37,10 +43,208 @@ void usage(const char* argv0)
                "  -# <cnt>  Maximum number of elements to print for each array field.\n"
                "            Set to zero 0 for unlimited.\n"
                "            Default: 20\n"
-               "  -F <fmt>  Output format mode: delta, tree\n"
+               "  -F <fmt>  Output format mode: delta, tree, json, csv\n"
+               "            json and csv print one line per update, with only the fields selected by -f\n"
+               "  -f <fld>  Comma separated list of fields to print in json or csv mode.\n"
+               "            Default: value\n"
+               "  -B <sz>   Size of output buffer in bytes for json or csv mode.\n"
+               "            Default: 1048576\n"
+               "  -T <sec>  Interval to flush output buffer in json or csv mode.\n"
+               "            Default: 1.0\n"
+               "  -w <file> On exit, write recently captured PVA messages to a pcap file.\n"
+               "            Keeps the most recent 16MB of messages for each connection.\n"
                ;
 }
 
+enum struct Output {
+    Text, // Value::Fmt
+    JSON, // line delimited
+    CSV,
+};
+
+void appendString(std::string& out, const std::string& s, Output mode)
+{
+    out.push_back('"');
+    for(char c : s) {
+        if(mode==Output::CSV) {
+            if(c=='"')
+                out.push_back('"');
+            out.push_back(c);
+
+        } else if(c=='"' || c=='\\') {
+            out.push_back('\\');
+            out.push_back(c);
+
+        } else if(c=='\n') {
+            out += "\\n";
+
+        } else if(uint8_t(c) < 0x20u) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", unsigned(uint8_t(c)));
+            out += esc;
+
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+void appendReal(std::string& out, double v, Output mode)
+{
+    if(mode==Output::JSON && !std::isfinite(v)) {
+        out += "null";
+    } else {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.17g", v);
+        out += buf;
+    }
+}
+
+template<typename T>
+void appendArray(std::string& out, const shared_array<const T>& arr, Output mode, void (*fn)(std::string&, const T&, Output))
+{
+    out.push_back(mode==Output::JSON ? '[' : '"');
+    bool first = true;
+    for(auto& elem : arr) {
+        if(!first)
+            out.push_back(mode==Output::JSON ? ',' : ' ');
+        first = false;
+        fn(out, elem, mode);
+    }
+    out.push_back(mode==Output::JSON ? ']' : '"');
+}
+
+void appendElemInt(std::string& out, const int64_t& v, Output) { out += std::to_string(v); }
+void appendElemUInt(std::string& out, const uint64_t& v, Output) { out += std::to_string(v); }
+void appendElemReal(std::string& out, const double& v, Output mode) { appendReal(out, v, mode); }
+void appendElemBool(std::string& out, const bool& v, Output) { out += v ? "true" : "false"; }
+void appendElemString(std::string& out, const std::string& v, Output mode)
+{
+    if(mode==Output::JSON) {
+        appendString(out, v, mode);
+    } else {
+        // within an already quoted CSV cell
+        for(char c : v) {
+            if(c=='"')
+                out.push_back('"');
+            out.push_back(c);
+        }
+    }
+}
+
+/* Append one field without going through std::ostream.
+ * Sub-structures are only expanded in JSON mode.
+ * Missing fields, unions, and (for CSV) structures are null/empty.
+ */
+void appendField(std::string& out, const Value& fld, Output mode)
+{
+    if(!fld) {
+        if(mode==Output::JSON)
+            out += "null";
+        return;
+    }
+    const auto type(fld.type());
+
+    if(type.isarray() && type.kind()!=Kind::Compound) {
+        auto arr(fld.as<shared_array<const void>>());
+        switch(type.kind()) {
+        case Kind::Bool:
+            appendArray(out, arr.convertTo<const bool>(), mode, &appendElemBool);
+            return;
+        case Kind::Integer:
+            if(type.isunsigned())
+                appendArray(out, arr.convertTo<const uint64_t>(), mode, &appendElemUInt);
+            else
+                appendArray(out, arr.convertTo<const int64_t>(), mode, &appendElemInt);
+            return;
+        case Kind::Real:
+            appendArray(out, arr.convertTo<const double>(), mode, &appendElemReal);
+            return;
+        case Kind::String:
+            appendArray(out, arr.convertTo<const std::string>(), mode, &appendElemString);
+            return;
+        default:
+            break;
+        }
+
+    } else {
+        switch(type.kind()) {
+        case Kind::Bool:
+            out += fld.as<bool>() ? "true" : "false";
+            return;
+        case Kind::Integer:
+            if(type.isunsigned())
+                out += std::to_string(fld.as<uint64_t>());
+            else
+                out += std::to_string(fld.as<int64_t>());
+            return;
+        case Kind::Real:
+            appendReal(out, fld.as<double>(), mode);
+            return;
+        case Kind::String:
+            appendString(out, fld.as<std::string>(), mode);
+            return;
+        default:
+            if(mode==Output::JSON && type==TypeCode::Struct) {
+                out.push_back('{');
+                bool first = true;
+                for(auto child : fld.ichildren()) {
+                    if(!first)
+                        out.push_back(',');
+                    first = false;
+                    appendString(out, fld.nameOf(child), mode);
+                    out.push_back(':');
+                    appendField(out, child, mode);
+                }
+                out.push_back('}');
+                return;
+            }
+            break;
+        }
+    }
+    if(mode==Output::JSON)
+        out += "null";
+}
+
+// Accumulate output lines, which are written with a single fwrite() when full or stale.
+struct OutBuf {
+    std::string buf;
+    size_t limit = 1024u*1024u;
+    double interval = 1.0;
+    epicsTime lastFlush = epicsTime::getCurrent();
+
+    void flush() {
+        if(!buf.empty()) {
+            (void)fwrite(buf.data(), 1u, buf.size(), stdout);
+            buf.clear();
+        }
+        fflush(stdout);
+        lastFlush = epicsTime::getCurrent();
+    }
+
+    void maybeFlush() {
+        if(buf.size() >= limit || epicsTime::getCurrent() - lastFlush >= interval)
+            flush();
+    }
+};
+
+typedef MPMCFIFO<std::shared_ptr<client::Subscription>> WorkQueue;
+
+// wake up the main loop with a null entry.  At most one pending.
+struct Ticker {
+    WorkQueue& workqueue;
+    std::atomic<bool> pending{false};
+    explicit Ticker(WorkQueue& workqueue) :workqueue(workqueue) {}
+};
+
+void timerTick(evutil_socket_t, short, void *raw)
+{
+    auto tick = static_cast<Ticker*>(raw);
+    if(!tick->pending.exchange(true))
+        tick->workqueue.push(nullptr);
+}
+
 }
 
 int main(int argc, char *argv[])
@@ -51,10 +255,14 @@ int main(int argc, char *argv[])
         std::string request;
         Value::Fmt::format_t format = Value::Fmt::Delta;
         auto arrLimit = uint64_t(-1);
+        Output mode = Output::Text;
+        std::vector<std::string> fields({"value"});
+        OutBuf out;
+        std::string captureFile;
 
         {
             int opt;
-            while ((opt = getopt(argc, argv, "hVvdr:#:F:")) != -1) {
+            while ((opt = getopt(argc, argv, "hVvdr:#:F:f:B:T:w:")) != -1) {
                 switch(opt) {
                 case 'h':
                     usage(argv[0]);
@@ -77,13 +285,42 @@ int main(int argc, char *argv[])
                     break;
                 case 'F':
                     if(std::strcmp(optarg, "tree")==0) {
+                        mode = Output::Text;
                         format = Value::Fmt::Tree;
                     } else if(std::strcmp(optarg, "delta")==0) {
+                        mode = Output::Text;
                         format = Value::Fmt::Delta;
+                    } else if(std::strcmp(optarg, "json")==0) {
+                        mode = Output::JSON;
+                    } else if(std::strcmp(optarg, "csv")==0) {
+                        mode = Output::CSV;
                     } else {
                         std::cerr<<"Warning: ignoring unknown format '"<<optarg<<"'\n";
                     }
                     break;
+                case 'f': {
+                    fields.clear();
+                    std::string list(optarg);
+                    size_t pos = 0u;
+                    while(pos <= list.size()) {
+                        auto sep = list.find(',', pos);
+                        if(sep==std::string::npos)
+                            sep = list.size();
+                        if(sep > pos)
+                            fields.push_back(list.substr(pos, sep-pos));
+                        pos = sep+1u;
+                    }
+                }
+                    break;
+                case 'B':
+                    out.limit = parseTo<uint64_t>(optarg);
+                    break;
+                case 'T':
+                    out.interval = parseTo<double>(optarg);
+                    break;
+                case 'w':
+                    captureFile = optarg;
+                    break;
                 default:
                     usage(argv[0]);
                     std::cerr<<"\nUnknown argument: "<<char(opt)<<std::endl;
@@ -92,13 +329,16 @@ int main(int argc, char *argv[])
             }
         }
 
+        if(!captureFile.empty())
+            wireCaptureSet(16u*1024u*1024u);
+
         auto ctxt(client::Context::fromEnv());
 
         if(verbose)
             std::cout<<"Effective config\n"<<ctxt.config();
 
-        // space for every subscription and one more for SigInt
-        MPMCFIFO<std::shared_ptr<client::Subscription>> workqueue(argc-optind+1);
+        // space for every subscription, one more for SigInt, and one for the flush timer
+        WorkQueue workqueue(argc-optind+2);
         std::list<decltype (workqueue)::value_type> ops;
 
         int remaining = argc-optind;
@@ -125,8 +365,42 @@ int main(int argc, char *argv[])
             workqueue.push(nullptr);
         });
 
-        while(auto mon = workqueue.pop()) {
-            if(remaining==0u || interrupt.load())
+        /* In json and csv modes, periodically wake up the main loop with a null entry
+         * so that buffered output is not held indefinitely when updates stop.
+         */
+        Ticker tick(workqueue);
+        evbase ticker;
+        evevent tickTimer;
+        if(mode!=Output::Text) {
+            out.buf.reserve(out.limit);
+            if(mode==Output::CSV) {
+                out.buf += "name";
+                for(auto& fld : fields) {
+                    out.buf.push_back(',');
+                    appendString(out.buf, fld, mode);
+                }
+                out.buf.push_back('\n');
+            }
+
+            if(out.interval > 0.0) {
+                ticker = evbase("pvxmonitor");
+                tickTimer = evevent(__FILE__, __LINE__,
+                                    event_new(ticker.base, -1, EV_TIMEOUT|EV_PERSIST, &timerTick, &tick));
+                auto period(totv(out.interval));
+                ticker.call([&tickTimer, &period]() {
+                    if(event_add(tickTimer.get(), &period))
+                        throw std::runtime_error("Unable to start flush timer");
+                });
+            }
+        }
+
+        while(true) {
+            auto mon = workqueue.pop();
+            if(!mon && tick.pending.exchange(false) && !interrupt.load()) {
+                out.maybeFlush();
+                continue;
+            }
+            if(!mon || remaining==0u || interrupt.load())
                 break;
             auto& name = mon->name();
 
@@ -139,11 +413,34 @@ int main(int argc, char *argv[])
                 }
                 log_info_printf(app, "%s POP empty\n", name.c_str());
 
-                std::cout<<name<<"\n";
-                Indented I(std::cout);
-                std::cout<<update.format()
-                           .format(format)
-                           .arrayLimit(arrLimit);
+                if(mode==Output::Text) {
+                    std::cout<<name<<"\n";
+                    Indented I(std::cout);
+                    std::cout<<update.format()
+                               .format(format)
+                               .arrayLimit(arrLimit);
+
+                } else if(mode==Output::JSON) {
+                    out.buf += "{\"name\":";
+                    appendString(out.buf, name, mode);
+                    for(auto& fld : fields) {
+                        out.buf.push_back(',');
+                        appendString(out.buf, fld, mode);
+                        out.buf.push_back(':');
+                        appendField(out.buf, update[fld], mode);
+                    }
+                    out.buf += "}\n";
+                    out.maybeFlush();
+
+                } else { // CSV
+                    appendString(out.buf, name, mode);
+                    for(auto& fld : fields) {
+                        out.buf.push_back(',');
+                        appendField(out.buf, update[fld], mode);
+                    }
+                    out.buf.push_back('\n');
+                    out.maybeFlush();
+                }
 
             }catch(client::Finished& conn) {
                 log_info_printf(app, "%s POP Finished\n", name.c_str());
@@ -170,6 +467,18 @@ int main(int argc, char *argv[])
             workqueue.push(std::move(mon));
         }
 
+        if(mode!=Output::Text) {
+            if(tickTimer) {
+                ticker.call([&tickTimer]() {
+                    tickTimer.reset();
+                });
+            }
+            out.flush();
+        }
+
+        if(!captureFile.empty())
+            wireCaptureDump(captureFile);
+
         if(remaining==0u) {
             return 0;
 
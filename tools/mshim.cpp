@@ -12,6 +12,7 @@
 
 #include <epicsVersion.h>
 #include <epicsGetopt.h>
+#include <epicsTime.h>
 
 #include <pvxs/log.h>
 #include <pvxs/server.h>
@@ -38,6 +39,11 @@ void usage(const char* argv0)
                 "                          Optionally override OS default TTL and outbound interface selected\n"
                 "                          by the OS.\n"
                 "  -p <port#>              Default port number.  (overrides $EPICS_PVA_BROADCAST_PORT)\n"
+                "  -C <sec>                Cache search replies for this many seconds.  Cached names are\n"
+                "                          answered locally.  Replies to forwarded searches are relayed\n"
+                "                          through this shim.  (default 0, disabled)\n"
+                "  -D <sec>                With -C, drop searches repeated by the same client for the same\n"
+                "                          name within this many seconds.  (default 1.0)\n"
                 "  -h                      Show this message.\n"
                 "  -V                      Show versions.\n"
                 "\n"
@@ -50,6 +56,10 @@ void usage(const char* argv0)
                 "\n"
                 "    "<<argv0<<" -L 127.0.0.1:15076 -F 224.1.1.1,255 &  # 1\n"
                 "    "<<argv0<<" -L 224.1.1.1,255 -F 127.0.0.1:15076 &  # 2\n"
+                "\n"
+                "    3. As 1. with replies cached for 30 seconds.\n"
+                "\n"
+                "    "<<argv0<<" -C 30 -L 127.0.0.1:15076 -F 224.1.1.1,255 &  # 3\n"
     <<std::endl;
 }
 
@@ -74,14 +84,54 @@ SockEndpoint parseEP(const char* optarg, const server::Config& conf)
     return ep;
 }
 
+// monotonic time in seconds
+double now()
+{
+    return epicsMonotonicGet()*1e-9;
+}
+
+constexpr timeval cacheCleanInterval{1, 0};
+
+// replies to a relayed search expected within
+constexpr double relayTimeout = 5.0;
+
 struct App {
     const SockAttach attach;
     IfaceMap& ifmap;
     const evsocket sockTx{AF_INET, SOCK_DGRAM, 0};
     std::vector<SockEndpoint> destinations;
 
+    // search reply cache.  disabled when zero
+    double cacheTTL = 0.0;
+    double dupWindow = 1.0;
+    uint16_t replyPort = 0u;
+
     // effectively local to UDPManager worker
     std::vector<uint8_t> scratch;
+    std::vector<uint8_t> rxbuf;
+
+    // where a name was last found
+    struct Found {
+        ServerGUID guid;
+        SockAddr server; // including port
+        std::string proto;
+        double expires;
+    };
+    std::map<std::string, Found> cache;
+    // (client reply address, name) -> time of forwarding
+    std::map<std::pair<SockAddr, std::string>, double> recent;
+    // searches forwarded with our reply address, by our search ID
+    struct Relay {
+        SockAddr client;
+        uint32_t searchID;
+        std::map<uint32_t, std::string> names; // by client's ID
+        double expires;
+    };
+    std::map<uint32_t, Relay> relays;
+    uint32_t nextRelayID = 0u;
+
+    evevent replyRx;
+    evevent cleaner;
 
     App()
         :ifmap(IfaceMap::instance())
@@ -90,22 +140,122 @@ struct App {
         auto bind_addr(SockAddr::any(sockTx.af));
         sockTx.bind(bind_addr);
         sockTx.mcast_loop(true);
+        replyPort = bind_addr.port(); // bind() updates with the random port
+    }
+
+    void enableCache(evbase& loop)
+    {
+        rxbuf.resize(0x10000);
+        replyRx = evevent(__FILE__, __LINE__,
+                          event_new(loop.base, sockTx.sock, EV_READ|EV_PERSIST, &onReplyS, this));
+        cleaner = evevent(__FILE__, __LINE__,
+                          event_new(loop.base, -1, EV_TIMEOUT|EV_PERSIST, &cleanS, this));
+        loop.call([this]() {
+            if(event_add(replyRx.get(), nullptr) || event_add(cleaner.get(), &cacheCleanInterval))
+                throw std::runtime_error("Unable to enable search reply cache");
+        });
+    }
+
+    void sendReply(const UDPManager::Search& msg, const Found& found, const std::vector<uint32_t>& ids)
+    {
+        FixedBuf buf(true, scratch);
+        buf._skip(8);
+        _to_wire<12>(buf, found.guid.data(), false, __FILE__, __LINE__);
+        to_wire(buf, msg.searchID);
+        to_wire(buf, found.server);
+        to_wire(buf, uint16_t(found.server.port()));
+        to_wire(buf, found.proto);
+        to_wire(buf, uint8_t(1u)); // found
+        to_wire(buf, uint16_t(ids.size()));
+        for(auto id : ids)
+            to_wire(buf, id);
+
+        auto bufsize = buf.save()-scratch.data();
+        {
+            FixedBuf buf(true, scratch.data(), 8u);
+            to_wire(buf, Header{CMD_SEARCH_RESPONSE, pva_flags::Server, uint32_t(bufsize-8u)});
+        }
+        if(!buf.good()) {
+            log_warn_printf(applog, "Unable to construct CMD_SEARCH_RESPONSE. %s:%d\n",
+                            buf.file(), buf.line());
+
+        } else if(!msg.replyTo(msg.server, scratch.data(), bufsize)) {
+            log_warn_printf(applog, "Unable to send cached reply to %s\n",
+                            msg.server.tostring().c_str());
+
+        } else {
+            log_debug_printf(applog, "Answered %zu names for %s from cache -> %s\n",
+                             ids.size(), msg.server.tostring().c_str(),
+                             found.server.tostring().c_str());
+        }
     }
 
     void onSearch(const UDPManager::Search& msg)
     {
+        assert(!msg.server.isAny() && msg.server.family()==AF_INET); // UDPManager has already handled this case
+
+        uint32_t searchID = msg.searchID;
+        std::vector<UDPManager::Search::Name> names;
+        const std::vector<UDPManager::Search::Name>* forward = &msg.names;
+
+        if(cacheTTL>0.0) {
+            auto T(now());
+            // names answered from cache, grouped by server
+            std::map<const Found*, std::vector<uint32_t>> local;
+
+            for(auto& name : msg.names) {
+                auto it(cache.find(name.name));
+                if(it!=cache.end() && it->second.expires > T) {
+                    local[&it->second].push_back(name.id);
+                    continue;
+                }
+
+                auto& last = recent[std::make_pair(msg.server, std::string(name.name))];
+                if(last + dupWindow > T) {
+                    log_debug_printf(applog, "Drop repeated search for '%s' from %s\n",
+                                     name.name, msg.server.tostring().c_str());
+                    continue;
+                }
+                last = T;
+                names.push_back(name);
+            }
+
+            for(auto& pair : local) {
+                sendReply(msg, *pair.first, pair.second);
+            }
+
+            if(names.empty())
+                return;
+
+            // replies come back through us, to learn from and relay
+            searchID = nextRelayID++;
+            auto& relay = relays[searchID];
+            relay.client = msg.server;
+            relay.searchID = msg.searchID;
+            relay.expires = T + relayTimeout;
+            for(auto& name : names) {
+                relay.names[name.id] = name.name;
+            }
+            forward = &names;
+        }
+
         FixedBuf buf(true, scratch);
         auto save_header = buf.save();
         buf._skip(8);
-        to_wire(buf, msg.searchID);
+        to_wire(buf, searchID);
         auto save_flags = buf.save();
         to_wire(buf, {
                     uint8_t(msg.mustReply ? pva_search_flags::MustReply : 0u),
                     0,0,0
                 });
-        assert(!msg.server.isAny() && msg.server.family()==AF_INET); // UDPManager has already handled this case
-        to_wire(buf, msg.server);
-        to_wire(buf, uint16_t(msg.server.port()));
+        if(cacheTTL>0.0) {
+            // servers reply to the sender address, with our port
+            to_wire(buf, SockAddr::any(AF_INET));
+            to_wire(buf, replyPort);
+        } else {
+            to_wire(buf, msg.server);
+            to_wire(buf, uint16_t(msg.server.port()));
+        }
 
         size_t nproto = msg.otherproto.size();
         if(msg.protoTCP)
@@ -118,9 +268,9 @@ struct App {
             to_wire(buf, prot);
         }
 
-        to_wire(buf, uint16_t(msg.names.size()));
+        to_wire(buf, uint16_t(forward->size()));
 
-        for(auto& name : msg.names) {
+        for(auto& name : *forward) {
             to_wire(buf, name.id);
             to_wire(buf, name.name);
         }
@@ -173,6 +323,132 @@ struct App {
         }
     }
 
+    void onReply()
+    {
+        SockAddr src;
+        recvfromx rx{sockTx.sock, (char*)rxbuf.data(), rxbuf.size(), &src};
+        const int nrx = rx.call();
+        if(nrx<0) {
+            int err = evutil_socket_geterror(sockTx.sock);
+            if(err!=SOCK_EWOULDBLOCK && err!=EAGAIN && err!=SOCK_EINTR)
+                log_warn_printf(applog, "UDP reply RX Error : %s\n", evutil_socket_error_to_string(err));
+            return;
+        }
+
+        FixedBuf M(true, rxbuf.data(), nrx);
+        Header head{};
+        from_wire(M, head);
+        if(!M.good() || head.cmd!=CMD_SEARCH_RESPONSE || head.len > M.size()) {
+            log_debug_printf(applog, "Ignore UDP message from %s\n", src.tostring().c_str());
+            return;
+        }
+
+        Found found{};
+        uint32_t seq = 0u;
+        uint16_t port = 0u;
+        uint8_t isfound = 0u;
+        uint16_t nids = 0u;
+        _from_wire<12>(M, found.guid.data(), false, __FILE__, __LINE__);
+        from_wire(M, seq);
+        from_wire(M, found.server);
+        from_wire(M, port);
+        from_wire(M, found.proto);
+        from_wire(M, isfound);
+        from_wire(M, nids);
+        std::vector<uint32_t> ids(M.good() ? nids : 0u);
+        for(auto& id : ids)
+            from_wire(M, id);
+
+        auto it(relays.find(seq));
+        if(!M.good() || it==relays.end()) {
+            log_debug_printf(applog, "Ignore unexpected reply from %s\n", src.tostring().c_str());
+            return;
+        }
+        auto& relay = it->second;
+
+        if(found.server.isAny())
+            found.server = src;
+        found.server.setPort(port);
+
+        if(isfound && found.proto=="tcp") {
+            found.expires = now() + cacheTTL;
+            for(auto id : ids) {
+                auto nit(relay.names.find(id));
+                if(nit!=relay.names.end())
+                    cache[nit->second] = found;
+            }
+        }
+
+        // relay with the client's search ID, and the server address made explicit
+        FixedBuf buf(true, scratch);
+        buf._skip(8);
+        _to_wire<12>(buf, found.guid.data(), false, __FILE__, __LINE__);
+        to_wire(buf, relay.searchID);
+        to_wire(buf, found.server);
+        to_wire(buf, port);
+        to_wire(buf, found.proto);
+        to_wire(buf, isfound);
+        to_wire(buf, nids);
+        for(auto id : ids)
+            to_wire(buf, id);
+
+        auto bufsize = buf.save()-scratch.data();
+        {
+            FixedBuf buf(true, scratch.data(), 8u);
+            to_wire(buf, Header{CMD_SEARCH_RESPONSE, pva_flags::Server, uint32_t(bufsize-8u)});
+        }
+        if(!buf.good()) {
+            log_warn_printf(applog, "Unable to construct CMD_SEARCH_RESPONSE to relay. %s:%d\n",
+                            buf.file(), buf.line());
+            return;
+        }
+
+        auto ret = sendto(sockTx.sock, (char*)scratch.data(), bufsize, 0,
+                          &relay.client->sa, relay.client.size());
+        if(ret!=bufsize) {
+            log_warn_printf(applog, "Unable to relay reply to %s\n", relay.client.tostring().c_str());
+        } else {
+            log_debug_printf(applog, "Relayed reply %s -> %s\n",
+                             found.server.tostring().c_str(), relay.client.tostring().c_str());
+        }
+    }
+    static void onReplyS(evutil_socket_t fd, short evt, void *raw)
+    {
+        try {
+            if(evt&EV_READ)
+                static_cast<App*>(raw)->onReply();
+        }catch(std::exception& e){
+            log_exc_printf(applog, "Unhandled error in search reply callback: %s\n", e.what());
+        }
+    }
+
+    void clean()
+    {
+        auto T(now());
+        for(auto it(cache.begin()); it!=cache.end();) {
+            if(it->second.expires <= T)
+                it = cache.erase(it);
+            else
+                ++it;
+        }
+        for(auto it(recent.begin()); it!=recent.end();) {
+            if(it->second + dupWindow <= T)
+                it = recent.erase(it);
+            else
+                ++it;
+        }
+        for(auto it(relays.begin()); it!=relays.end();) {
+            if(it->second.expires <= T)
+                it = relays.erase(it);
+            else
+                ++it;
+        }
+    }
+    static void cleanS(evutil_socket_t fd, short evt, void *raw)
+    {
+        static_cast<App*>(raw)->clean();
+    }
+
     void onBeacon(const UDPManager::Beacon& msg)
     {
         FixedBuf buf(true, scratch);
@@ -247,7 +523,7 @@ int main(int argc, char *argv[])
 
         {
             int opt;
-            while ((opt = getopt(argc, argv, "L:F:phV")) != -1) {
+            while ((opt = getopt(argc, argv, "L:F:p:C:D:hV")) != -1) {
                 switch(opt) {
                 case 'L':
                 {
@@ -262,6 +538,12 @@ int main(int argc, char *argv[])
                 case 'p':
                     conf.udp_port = parseTo<uint64_t>(optarg);
                     break;
+                case 'C':
+                    app.cacheTTL = parseTo<double>(optarg);
+                    break;
+                case 'D':
+                    app.dupWindow = parseTo<double>(optarg);
+                    break;
                 case 'h':
                     usage(argv[0]);
                     return 0;
@@ -282,6 +564,9 @@ int main(int argc, char *argv[])
             return 1;
         }
 
+        if(app.cacheTTL>0.0)
+            app.enableCache(manager.loop());
+
         for(auto& listener : listeners) {
             listener->start();
         }
@@ -0,0 +1,403 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <set>
+
+#include <cstring>
+#include <cstdlib>
+
+#include <epicsVersion.h>
+#include <epicsGetopt.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+#include <pvxs/log.h>
+#include "utilpvt.h"
+#include "evhelper.h"
+
+using namespace pvxs;
+
+namespace {
+
+void usage(const char* argv0)
+{
+    std::cerr<<"Usage: "<<argv0<<" <opts> [pvname]\n"
+               "\n"
+               "Measure round trip latency of GET, PUT, and RPC operations,\n"
+               "and monitor throughput.  Without a pvname, starts a server\n"
+               "on the loopback interface with a PV of type NTScalar double[].\n"
+               "\n"
+               "  -h        Show this message.\n"
+               "  -V        Print version and exit.\n"
+               "  -v        Make more noise.\n"
+               "  -d        Shorthand for $PVXS_LOG=\"pvxs.*=DEBUG\".  Make a lot of noise.\n"
+               "  -w <sec>  Operation timeout in seconds.  default 5 sec.\n"
+               "  -m <ops>  Comma separated list of: get, put, rpc, monitor.\n"
+               "            Default: get,put,rpc,monitor with a local server, or get with pvname\n"
+               "  -n <cnt>  Number of round trips for each of GET, PUT, and RPC.  Default 1000\n"
+               "  -u <cnt>  Number of updates posted for each monitor run.  Default 10000\n"
+               "  -s <lst>  Comma separated list of array lengths.  Default 1\n"
+               "  -N <lst>  Comma separated list of subscriber counts.  Default 1\n"
+               "  -q <lst>  Comma separated list of monitor queueSize.  Default 4\n"
+               "  -p        Monitor runs both with and without pipeline=true.\n"
+               "  -E        Local server uses $EPICS_PVAS_* instead of the loopback interface.\n"
+               "  -J        Print results as JSON, one object per line.\n"
+               ;
+}
+
+std::vector<std::string> splitList(const char* arg)
+{
+    std::vector<std::string> ret;
+    for(const char* sep; (sep = strchr(arg, ','))!=nullptr; arg = sep+1)
+        ret.emplace_back(arg, sep-arg);
+    ret.emplace_back(arg);
+    return ret;
+}
+
+std::vector<uint64_t> parseList(const char* arg)
+{
+    std::vector<uint64_t> ret;
+    for(auto& ent : splitList(arg)) {
+        if(!ent.empty())
+            ret.push_back(parseTo<uint64_t>(ent));
+    }
+    if(ret.empty())
+        throw std::invalid_argument(SB()<<"Empty list '"<<arg<<"'");
+    return ret;
+}
+
+struct Output {
+    bool json = false;
+
+    void latency(const char* op, size_t nelem, std::vector<double>& samples) const
+    {
+        std::sort(samples.begin(), samples.end());
+        auto pct = [&samples](double p) -> double {
+            if(samples.empty())
+                return 0.0;
+            return samples[std::min(samples.size()-1u, size_t(p*samples.size()))];
+        };
+
+        Restore R(std::cout);
+        std::cout.setf(std::ios_base::fixed, std::ios_base::floatfield);
+        std::cout.precision(1);
+        if(json) {
+            std::cout<<"{\"op\": \""<<op<<"\", \"nelem\": "<<nelem<<", \"n\": "<<samples.size()
+                     <<", \"p50_us\": "<<pct(0.5)<<", \"p90_us\": "<<pct(0.9)
+                     <<", \"p99_us\": "<<pct(0.99)<<", \"max_us\": "<<pct(1.0)<<"}\n";
+        } else {
+            std::cout<<op<<" nelem="<<nelem<<" n="<<samples.size()
+                     <<" p50="<<pct(0.5)<<"us p90="<<pct(0.9)
+                     <<"us p99="<<pct(0.99)<<"us max="<<pct(1.0)<<"us\n";
+        }
+    }
+
+    void throughput(size_t nelem, size_t nsub, size_t queueSize, bool pipeline,
+                    size_t posted, size_t delivered, double elapsed) const
+    {
+        double rate = delivered/elapsed;
+        double mbps = rate*nelem*sizeof(double)*1e-6;
+
+        Restore R(std::cout);
+        std::cout.setf(std::ios_base::fixed, std::ios_base::floatfield);
+        std::cout.precision(1);
+        if(json) {
+            std::cout<<"{\"op\": \"monitor\", \"nelem\": "<<nelem<<", \"nsub\": "<<nsub
+                     <<", \"queueSize\": "<<queueSize<<", \"pipeline\": "<<(pipeline ? "true" : "false")
+                     <<", \"posted\": "<<posted<<", \"delivered\": "<<delivered
+                     <<", \"updates_per_sec\": "<<rate<<", \"MB_per_sec\": "<<mbps<<"}\n";
+        } else {
+            std::cout<<"monitor nelem="<<nelem<<" nsub="<<nsub<<" queueSize="<<queueSize
+                     <<" pipeline="<<(pipeline ? "true" : "false")
+                     <<" posted="<<posted<<" delivered="<<delivered
+                     <<" updates/s="<<rate<<" MB/s="<<mbps<<"\n";
+        }
+    }
+};
+
+// monotonic time in microseconds
+double nowUS()
+{
+    return epicsMonotonicGet()*1e-3;
+}
+
+Value makePayload(const Value& prototype, size_t nelem)
+{
+    shared_array<double> arr(nelem);
+    for(auto i : range(nelem))
+        arr[i] = double(i);
+    auto val(prototype.cloneEmpty());
+    val["value"] = arr.freeze();
+    return val;
+}
+
+void measureMonitor(const Output& out, server::Server& serv, server::SharedPV& pv,
+                    const Value& payload, size_t nelem, size_t nsub, size_t queueSize, bool pipeline,
+                    uint32_t nupdate, double timeout)
+{
+    {
+        // clear userTag left by any previous sweep
+        auto initial(payload.clone());
+        initial["timeStamp.userTag"] = 0u;
+        pv.post(initial);
+    }
+
+    // each Context opens a separate TCP connection
+    std::vector<client::Context> clis;
+    for(auto i : range(std::min(nsub, size_t(4u)))) {
+        (void)i;
+        clis.push_back(serv.clientConfig().build());
+    }
+
+    std::atomic<uint32_t> target{0u};
+    std::atomic<size_t> nrx{0u}, ndone{0u};
+    epicsEvent done;
+
+    std::vector<std::shared_ptr<client::Subscription>> subs;
+    for(auto i : range(nsub)) {
+        subs.push_back(clis[i%clis.size()].monitor("perf")
+                       .record("queueSize", uint32_t(queueSize))
+                       .record("pipeline", pipeline)
+                       .maskConnected(true)
+                       .maskDisconnected(true)
+                       .event([&target, &nrx, &ndone, &done, nsub](client::Subscription& sub) {
+            while(auto val = sub.pop()) {
+                nrx++;
+                auto tag = val["timeStamp.userTag"].as<uint32_t>();
+                if(tag && tag==target.load() && ++ndone==nsub)
+                    done.signal();
+            }
+        })
+                       .exec());
+    }
+
+    // wait for initial updates
+    auto deadline = nowUS() + timeout*1e6;
+    while(nrx.load()<nsub && nowUS()<deadline)
+        epicsThreadSleep(0.01);
+    if(nrx.load()<nsub)
+        throw std::runtime_error("Timeout connecting subscriptions");
+
+    nrx = 0u;
+    target = nupdate;
+
+    auto start = nowUS();
+    for(auto n : range(nupdate)) {
+        auto update(payload.cloneEmpty());
+        update["value"].assign(payload["value"]);
+        update["timeStamp.userTag"] = uint32_t(n+1u);
+        pv.post(update);
+    }
+    if(!done.wait(timeout + nupdate*1e-3))
+        throw std::runtime_error("Timeout waiting for monitor updates");
+    auto elapsed = (nowUS() - start)*1e-6;
+
+    out.throughput(nelem, nsub, queueSize, pipeline, nupdate, nrx.load(), elapsed);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    try {
+        logger_config_env(); // from $PVXS_LOG
+        double timeout = 5.0;
+        bool verbose = false;
+        bool fromEnv = false;
+        bool bothPipeline = false;
+        std::set<std::string> modes;
+        size_t count = 1000u;
+        uint32_t nupdate = 10000u;
+        std::vector<uint64_t> nelems{1u}, nsubs{1u}, queueSizes{4u};
+        Output out;
+
+        {
+            int opt;
+            while ((opt = getopt(argc, argv, "hVvdw:m:n:u:s:N:q:pEJ")) != -1) {
+                switch(opt) {
+                case 'h':
+                    usage(argv[0]);
+                    return 0;
+                case 'V':
+                    std::cout<<pvxs::version_information;
+                    return 0;
+                case 'v':
+                    verbose = true;
+                    break;
+                case 'd':
+                    logger_level_set("pvxs.*", Level::Debug);
+                    break;
+                case 'w':
+                    timeout = parseTo<double>(optarg);
+                    break;
+                case 'm':
+                    for(auto& mode : splitList(optarg)) {
+                        if(mode!="get" && mode!="put" && mode!="rpc" && mode!="monitor")
+                            throw std::invalid_argument(SB()<<"Unknown operation '"<<mode<<"'");
+                        modes.insert(mode);
+                    }
+                    break;
+                case 'n':
+                    count = parseTo<uint64_t>(optarg);
+                    break;
+                case 'u':
+                    nupdate = uint32_t(parseTo<uint64_t>(optarg));
+                    break;
+                case 's':
+                    nelems = parseList(optarg);
+                    break;
+                case 'N':
+                    nsubs = parseList(optarg);
+                    break;
+                case 'q':
+                    queueSizes = parseList(optarg);
+                    break;
+                case 'p':
+                    bothPipeline = true;
+                    break;
+                case 'E':
+                    fromEnv = true;
+                    break;
+                case 'J':
+                    out.json = true;
+                    break;
+                default:
+                    usage(argv[0]);
+                    std::cerr<<"\nUnknown argument: "<<char(opt)<<std::endl;
+                    return 1;
+                }
+            }
+        }
+
+        if(argc-optind > 1) {
+            usage(argv[0]);
+            std::cerr<<"\nExpected at most one pvname\n";
+            return 1;
+        }
+        const bool local = optind==argc;
+        const std::string pvname(local ? "perf" : argv[optind]);
+
+        if(modes.empty()) {
+            if(local) {
+                modes = {"get", "put", "rpc", "monitor"};
+            } else {
+                modes = {"get"};
+            }
+        }
+        if(!local && modes.count("monitor")) {
+            std::cerr<<"Monitor throughput requires the local server\n";
+            return 1;
+        }
+
+        const auto prototype(nt::NTScalar{TypeCode::Float64A}.create());
+
+        server::SharedPV pv;
+        server::Server serv;
+        client::Context ctxt;
+        if(local) {
+            pv = server::SharedPV::buildMailbox();
+            pv.onRPC([](server::SharedPV&, std::unique_ptr<server::ExecOp>&& op, Value&& arg) {
+                op->reply(arg);
+            });
+            pv.open(makePayload(prototype, nelems.front()));
+
+            serv = (fromEnv ? server::Config::fromEnv() : server::Config::isolated())
+                    .build()
+                    .addPV(pvname, pv);
+            if(verbose)
+                std::cout<<"Effective server config\n"<<serv.config();
+            serv.start();
+
+            ctxt = serv.clientConfig().build();
+
+        } else {
+            ctxt = client::Context::fromEnv();
+        }
+
+        if(verbose)
+            std::cout<<"Effective client config\n"<<ctxt.config();
+
+        SigInt sig([]() {
+            std::cerr<<"Interrupted\n";
+            exit(2);
+        });
+
+        for(auto nelem : nelems) {
+            const auto payload(makePayload(prototype, nelem));
+            if(local)
+                pv.post(payload);
+
+            if(modes.count("get")) {
+                std::vector<double> samples;
+                samples.reserve(count);
+                for(auto n : range(count)) {
+                    (void)n;
+                    auto start = nowUS();
+                    ctxt.get(pvname).exec()->wait(timeout);
+                    samples.push_back(nowUS() - start);
+                }
+                out.latency("get", nelem, samples);
+            }
+
+            if(modes.count("put")) {
+                std::vector<double> samples;
+                samples.reserve(count);
+                for(auto n : range(count)) {
+                    (void)n;
+                    auto start = nowUS();
+                    ctxt.put(pvname)
+                            .build([&payload](Value&& proto) -> Value {
+                                auto val(proto.cloneEmpty());
+                                val["value"].assign(payload["value"]);
+                                return val;
+                            })
+                            .exec()->wait(timeout);
+                    samples.push_back(nowUS() - start);
+                }
+                out.latency("put", nelem, samples);
+            }
+
+            if(modes.count("rpc")) {
+                std::vector<double> samples;
+                samples.reserve(count);
+                for(auto n : range(count)) {
+                    (void)n;
+                    auto start = nowUS();
+                    ctxt.rpc(pvname, payload).exec()->wait(timeout);
+                    samples.push_back(nowUS() - start);
+                }
+                out.latency("rpc", nelem, samples);
+            }
+
+            if(modes.count("monitor")) {
+                for(auto nsub : nsubs) {
+                    for(auto queueSize : queueSizes) {
+                        measureMonitor(out, serv, pv, payload, nelem, nsub, queueSize, false, nupdate, timeout);
+                        if(bothPipeline)
+                            measureMonitor(out, serv, pv, payload, nelem, nsub, queueSize, true, nupdate, timeout);
+                    }
+                }
+            }
+        }
+
+        ctxt.close();
+        if(local)
+            serv.stop();
+        return 0;
+
+    }catch(std::exception& e){
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+}
@@ -6,17 +6,23 @@
 
 #include <event2/event.h>
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 #include <iostream>
+#include <iomanip>
 #include <sstream>
 #include <vector>
 #include <set>
 #include <tuple>
 #include <regex>
+#include <unordered_map>
 
 #include <epicsVersion.h>
 #include <epicsEvent.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsTime.h>
 #include <epicsGetopt.h>
 #include <osiSock.h>
 
@@ -77,9 +83,115 @@ parsePeer(const char *optarg)
     return std::make_pair(addr.s_addr, mask.s_addr);
 }
 
+// Search traffic counters, by client host and by PV name prefix.  cf. -T
+struct SearchStats {
+    struct Count {
+        size_t searches = 0u, names = 0u;
+    };
+
+    epicsMutex lock;
+    // guarded by lock
+    std::unordered_map<std::string, Count> byClient;
+    std::unordered_map<std::string, size_t> byPrefix;
+    size_t searches = 0u, names = 0u, beacons = 0u;
+    epicsUInt64 since = epicsMonotonicGet();
+
+    // PV name up to, and including, the Nth ':'.  The whole name if fewer.
+    unsigned depth = 1u;
+
+    std::string prefixOf(const char* name) const {
+        const char* end = name;
+        for(unsigned n=0u; *end; end++) {
+            if(*end==':' && ++n==depth) {
+                end++;
+                break;
+            }
+        }
+        return std::string(name, end-name);
+    }
+
+    void search(const pva::UDPManager::Search& msg) {
+        pva::SockAddr host(msg.src);
+        host.setPort(0);
+        auto client(host.tostring());
+
+        epicsGuard<epicsMutex> G(lock);
+        auto& cnt = byClient[client];
+        cnt.searches++;
+        cnt.names += msg.names.size();
+        searches++;
+        names += msg.names.size();
+        for(const auto& pv : msg.names)
+            byPrefix[prefixOf(pv.name)]++;
+    }
+
+    void beacon() {
+        epicsGuard<epicsMutex> G(lock);
+        beacons++;
+    }
+
+    // print rates since the previous show(), then reset
+    void show(std::ostream& strm, size_t ntop) {
+        decltype(byClient) clients;
+        decltype(byPrefix) prefixes;
+        size_t nsearch, nname, nbeacon;
+        double period;
+        {
+            epicsGuard<epicsMutex> G(lock);
+            auto now = epicsMonotonicGet();
+            period = std::max(1e-9*(now-since), 1e-3);
+            since = now;
+            clients.swap(byClient);
+            prefixes.swap(byPrefix);
+            nsearch = searches;
+            nname = names;
+            nbeacon = beacons;
+            searches = names = beacons = 0u;
+        }
+
+        pva::Restore R(strm);
+        strm<<std::fixed<<std::setprecision(1)
+            <<"--- "<<period<<" s : "<<nsearch/period<<" searches/s, "
+            <<nname/period<<" names/s from "<<clients.size()<<" clients.  "
+            <<nbeacon/period<<" beacons/s\n";
+
+        std::vector<std::pair<std::string, Count>> topc(clients.begin(), clients.end());
+        auto nc = std::min(ntop, topc.size());
+        std::partial_sort(topc.begin(), topc.begin()+nc, topc.end(),
+                          [](const std::pair<std::string, Count>& lhs, const std::pair<std::string, Count>& rhs) {
+            return lhs.second.names > rhs.second.names;
+        });
+        if(nc) {
+            strm<<"  "<<std::left<<std::setw(40)<<"Client"<<std::right
+                <<std::setw(12)<<"searches/s"<<std::setw(12)<<"names/s"<<"\n";
+            for(auto i : pva::range(nc)) {
+                strm<<"  "<<std::left<<std::setw(40)<<topc[i].first<<std::right
+                    <<std::setw(12)<<topc[i].second.searches/period
+                    <<std::setw(12)<<topc[i].second.names/period<<"\n";
+            }
+        }
+
+        std::vector<std::pair<std::string, size_t>> topp(prefixes.begin(), prefixes.end());
+        auto np = std::min(ntop, topp.size());
+        std::partial_sort(topp.begin(), topp.begin()+np, topp.end(),
+                          [](const std::pair<std::string, size_t>& lhs, const std::pair<std::string, size_t>& rhs) {
+            return lhs.second > rhs.second;
+        });
+        if(np) {
+            strm<<"  "<<std::left<<std::setw(40)<<"PV prefix"<<std::right
+                <<std::setw(12)<<""<<std::setw(12)<<"names/s"<<"\n";
+            for(auto i : pva::range(np)) {
+                strm<<"  "<<std::left<<std::setw(40)<<topp[i].first<<std::right
+                    <<std::setw(12)<<""<<std::setw(12)<<topp[i].second/period<<"\n";
+            }
+        }
+        strm.flush();
+    }
+};
+
 void usage(const char *name)
 {
-    std::cerr<<"Usage: "<<name<<" [-C|-S] [-B hostip[:port]] [-H hostip]\n"
+    std::cerr<<"Usage: "<<name<<" [-C|-S] [-B hostip[:port]] [-H hostip] [-T interval [-N count] [-D depth]]\n"
                "\n"
                "PV Access Virtual Cable Tester\n"
                "\n"
@@ -93,6 +205,10 @@ void usage(const char *name)
                "  -B hostip[:port] Listen on the given interface(s).  May be repeated.\n"
                "  -H host          Show only message sent from this peer.  May be repeated.\n"
                "  -P pvname        Show only searches for this PV name.  May be repeated.\n"
+               "  -T interval      Statistics mode.  Instead of each message, print search rates\n"
+               "                   by client host and by PV name prefix every interval seconds.\n"
+               "  -N count         With -T, number of top clients and prefixes shown.  Default 10.\n"
+               "  -D depth         With -T, PV name prefix is up to the Nth ':'.  Default 1.\n"
               <<std::endl;
 }
 
@@ -109,6 +225,9 @@ int main(int argc, char *argv[])
             // stored in network byte order
             std::vector<std::pair<uint32_t, uint32_t>> peers;
             std::set<std::string> pvnames;
+            // statistics mode when non-zero.  cf. -T
+            double interval = 0.0;
+            size_t ntop = 10u;
 
             bool allowPeer(const pva::SockAddr& peer) {
                 if(peers.empty())
@@ -125,10 +244,11 @@ int main(int argc, char *argv[])
         } opts;
 
         std::vector<pva::SockAddr> bindaddrs;
+        SearchStats stats;
 
         {
             int opt;
-            while ((opt = getopt(argc, argv, "hVvCSH:B:P:")) != -1) {
+            while ((opt = getopt(argc, argv, "hVvCSH:B:P:T:N:D:")) != -1) {
                 switch(opt) {
                 case 'h':
                     usage(argv[0]);
@@ -166,6 +286,17 @@ int main(int argc, char *argv[])
                 case 'H':
                     opts.peers.push_back(parsePeer(optarg));
                     break;
+                case 'T':
+                    opts.interval = pva::parseTo<double>(optarg);
+                    if(!(opts.interval>0.0))
+                        throw std::runtime_error(pva::SB()<<"Expected positive interval.  Not "<<optarg);
+                    break;
+                case 'N':
+                    opts.ntop = pva::parseTo<uint64_t>(optarg);
+                    break;
+                case 'D':
+                    stats.depth = unsigned(pva::parseTo<uint64_t>(optarg));
+                    break;
                 }
             }
         }
@@ -204,7 +335,7 @@ int main(int argc, char *argv[])
             }
         }
 
-        auto searchCB = [&opts](const pva::UDPManager::Search& msg)
+        auto searchCB = [&opts, &stats](const pva::UDPManager::Search& msg)
         {
             if(!opts.client || !opts.allowPeer(msg.src))
                 return;
@@ -219,16 +350,24 @@ int main(int argc, char *argv[])
                 if(!show)
                     return;
             }
+            if(opts.interval>0.0) {
+                stats.search(msg);
+                return;
+            }
             log_info_printf(out, "%s Searching for:\n", msg.src.tostring().c_str());
             for(const auto pv : msg.names) {
                 log_info_printf(out, "  \"%s\"\n", pv.name);
             }
         };
 
-        auto beaconCB = [&opts](const pva::UDPManager::Beacon& msg)
+        auto beaconCB = [&opts, &stats](const pva::UDPManager::Beacon& msg)
         {
             if(!opts.server || !opts.allowPeer(msg.src))
                 return;
+            if(opts.interval>0.0) {
+                stats.beacon();
+                return;
+            }
 
             const auto& guid = msg.guid;
             log_info_printf(out, "%s\n",
@@ -254,7 +393,12 @@ int main(int argc, char *argv[])
             done.signal();
         });
 
-        done.wait();
+        if(opts.interval>0.0) {
+            while(!done.wait(opts.interval))
+                stats.show(std::cout, opts.ntop);
+        } else {
+            done.wait();
+        }
         log_info_printf(out, "Done\n%s", "");
 
         errlogFlush();
@@ -0,0 +1,659 @@
+/**
+ * Copyright - See the COPYRIGHT that is included with this distribution.
+ * pvxs is distributed subject to a Software License Agreement found
+ * in file LICENSE that is included with this distribution.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <cstring>
+#include <cstdlib>
+
+#include <epicsVersion.h>
+#include <epicsGetopt.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#include <pvxs/client.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+#include <pvxs/nt.h>
+#include <pvxs/log.h>
+#include <pvxs/util.h>
+#include "utilpvt.h"
+#include "dataimpl.h"
+#include "pvaproto.h"
+
+using namespace pvxs;
+using namespace pvxs::impl;
+
+namespace {
+
+void usage(const char* argv0)
+{
+    std::cerr<<"Usage: "<<argv0<<" -r <capture.pcap> [-A] [-o <profile>]\n"
+               "       "<<argv0<<" <opts> <profile>\n"
+               "\n"
+               "Record and replay PVA client traffic.\n"
+               "\n"
+               "With -r, convert messages captured by wireCaptureDump() or iocsh pvxcapdump\n"
+               "(see $PVXS_WIRE_CAPTURE) into a traffic profile of operations, with their times,\n"
+               "sizes, and pvRequests.  Otherwise replay a profile.  By default against a server\n"
+               "on the loopback interface with an NTScalar double[] PV standing in for each PV name,\n"
+               "sized as the largest recorded reply.\n"
+               "\n"
+               "  -h        Show this message.\n"
+               "  -V        Print version and exit.\n"
+               "  -v        Make more noise.\n"
+               "  -d        Shorthand for $PVXS_LOG=\"pvxs.*=DEBUG\".  Make a lot of noise.\n"
+               "  -r <file> Capture file to convert.\n"
+               "  -o <file> Write profile to this file instead of stdout.\n"
+               "  -A        Anonymize.  Replace PV names with pv0, pv1, ...\n"
+               "  -S <x>    Replay speed.  eg. 10 to replay ten times faster.  Default 1\n"
+               "  -R        Replay against servers found through $EPICS_PVA_* instead of the local server.\n"
+               "            pvRequest field selections are only replayed with -R.\n"
+               "  -w <sec>  Time to wait for operations to complete after the last event.  default 5 sec.\n"
+               "  -J        Print summary as JSON.\n"
+               ;
+}
+
+/* One line of a profile.
+ *
+ *   <sec> <conn> <ioid> <op> <event> <bytes> <pvname> [<options> <fields>]
+ *
+ * op is one of get, put, rpc, monitor.
+ * event is one of init, exec, reply, update, destroy.
+ * options and fields are only present for init.  eg. "queueSize=4,pipeline=true" and "value,alarm"
+ * "-" for none, or all fields.
+ */
+struct Event {
+    double time = 0.0;
+    unsigned conn = 0u;
+    uint32_t ioid = 0u;
+    std::string op, event;
+    size_t bytes = 0u;
+    std::string name, options, fields;
+};
+
+std::ostream& operator<<(std::ostream& strm, const Event& ev)
+{
+    Restore R(strm);
+    strm.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    strm.precision(6);
+    strm<<ev.time<<' '<<ev.conn<<' '<<ev.ioid<<' '<<ev.op<<' '<<ev.event<<' '<<ev.bytes<<' '<<ev.name;
+    if(ev.event=="init")
+        strm<<' '<<(ev.options.empty() ? "-" : ev.options)<<' '<<(ev.fields.empty() ? "-" : ev.fields);
+    return strm<<'\n';
+}
+
+const char* opName(uint8_t cmd)
+{
+    switch(cmd) {
+    case CMD_GET: return "get";
+    case CMD_PUT:
+    case CMD_PUT_GET: return "put";
+    case CMD_MONITOR: return "monitor";
+    case CMD_RPC: return "rpc";
+    default: return nullptr;
+    }
+}
+
+// leaf field names selected by a pvRequest "field" sub-structure
+void requestFields(std::string& out, const Value& top, const Value& fld)
+{
+    bool leaf = true;
+    for(auto child : fld.ichildren()) {
+        leaf = false;
+        requestFields(out, top, child);
+    }
+    if(leaf) {
+        if(!out.empty())
+            out += ',';
+        out += top.nameOf(fld);
+    }
+}
+
+void requestStrings(const Value& pvRequest, std::string& options, std::string& fields)
+{
+    if(auto fld = pvRequest["field"]) {
+        for(auto child : fld.ichildren())
+            requestFields(fields, fld, child);
+    }
+    if(auto opts = pvRequest["record._options"]) {
+        for(auto opt : opts.ichildren()) {
+            std::string val;
+            if(!opt.as(val))
+                continue;
+            if(!options.empty())
+                options += ',';
+            options += SB()<<opts.nameOf(opt)<<'='<<val;
+        }
+    }
+}
+
+// Decode messages captured on one connection
+struct ConnState {
+    unsigned index = 0u;
+    // capturing process was the client
+    bool client = false;
+    TypeStore rxTypes;
+    std::map<uint32_t, std::string> byCID, bySID;
+    struct Op {
+        const char* op;
+        std::string name;
+    };
+    std::map<uint32_t, Op> byIOID;
+};
+
+struct Converter {
+    bool anonymize = false;
+    std::map<std::string, ConnState> conns;
+    std::map<std::string, std::string> names;
+    std::vector<Event> events;
+    double t0 = -1.0;
+
+    std::string name(const std::string& orig) {
+        if(!anonymize)
+            return orig;
+        auto it = names.find(orig);
+        if(it==names.end())
+            it = names.emplace(orig, SB()<<"pv"<<names.size()).first;
+        return it->second;
+    }
+
+    void emit(double time, const ConnState& C, uint32_t ioid, const ConnState::Op& op, const char* event, size_t bytes) {
+        Event ev;
+        ev.time = time;
+        ev.conn = C.index;
+        ev.ioid = ioid;
+        ev.op = op.op;
+        ev.event = event;
+        ev.bytes = bytes;
+        ev.name = op.name;
+        events.push_back(std::move(ev));
+    }
+
+    // one message, including header.  May be truncated to less than 8+len
+    void message(double time, ConnState& C, uint8_t* msg, size_t mlen) {
+        FixedBuf M(true, msg, mlen);
+        Header head;
+        from_wire(M, head);
+        if(!M.good() || (head.flags&pva_flags::Control))
+            return;
+        auto seg = head.flags&pva_flags::SegMask;
+        if(seg && seg!=pva_flags::SegFirst)
+            return; // only the first segment describes the operation
+        const bool fromServer = head.flags&pva_flags::Server;
+        const bool body = !(head.flags&pva_flags::Compressed);
+        const size_t bytes = 8u + head.len;
+
+        if(head.cmd==CMD_CREATE_CHANNEL && body) {
+            if(!fromServer) {
+                uint16_t count = 0u;
+                from_wire(M, count);
+                for(auto i : range(count)) {
+                    (void)i;
+                    uint32_t cid = 0u;
+                    std::string pvname;
+                    from_wire(M, cid);
+                    from_wire(M, pvname);
+                    if(M.good())
+                        C.byCID[cid] = name(pvname);
+                }
+            } else {
+                uint32_t cid = 0u, sid = 0u;
+                from_wire(M, cid);
+                from_wire(M, sid);
+                auto it = C.byCID.find(cid);
+                if(M.good() && it!=C.byCID.end())
+                    C.bySID[sid] = it->second;
+            }
+
+        } else if(head.cmd==CMD_DESTROY_REQUEST && !fromServer && body) {
+            uint32_t sid = 0u, ioid = 0u;
+            from_wire(M, sid);
+            from_wire(M, ioid);
+            auto it = C.byIOID.find(ioid);
+            if(M.good() && it!=C.byIOID.end()) {
+                emit(time, C, ioid, it->second, "destroy", bytes);
+                C.byIOID.erase(it);
+            }
+
+        } else if(auto op = opName(head.cmd)) {
+            if(!body)
+                return;
+            uint32_t sid = 0u, ioid = 0u;
+            uint8_t subcmd = 0u;
+            if(!fromServer)
+                from_wire(M, sid);
+            from_wire(M, ioid);
+            from_wire(M, subcmd);
+            if(!M.good())
+                return;
+
+            if(!fromServer && (subcmd&0x08)) {
+                auto it = C.bySID.find(sid);
+                if(it==C.bySID.end())
+                    return; // channel created before capture began
+
+                Value pvRequest;
+                from_wire_type_value(M, C.rxTypes, pvRequest);
+
+                ConnState::Op rec{op, it->second};
+                C.byIOID[ioid] = rec;
+                emit(time, C, ioid, rec, "init", bytes);
+                if(M.good() && pvRequest)
+                    requestStrings(pvRequest, events.back().options, events.back().fields);
+                return;
+            }
+
+            auto it = C.byIOID.find(ioid);
+            if(it==C.byIOID.end() || (subcmd&0x08))
+                return; // unknown, or INIT reply
+
+            if(!fromServer) {
+                if(head.cmd!=CMD_MONITOR) // ignore ack/start/stop
+                    emit(time, C, ioid, it->second, "exec", bytes);
+            } else {
+                emit(time, C, ioid, it->second, head.cmd==CMD_MONITOR ? "update" : "reply", bytes);
+            }
+        }
+    }
+
+    void read(const std::string& fname) {
+        std::ifstream in(fname, std::ios::binary);
+        if(!in.is_open())
+            throw std::runtime_error(SB()<<"Unable to open "<<fname);
+
+        uint32_t fhead[6];
+        if(!in.read(reinterpret_cast<char*>(fhead), sizeof(fhead)))
+            throw std::runtime_error(SB()<<fname<<" is not a pcap file");
+        bool swap;
+        if(fhead[0]==0xa1b2c3d4u)
+            swap = false;
+        else if(fhead[0]==0xd4c3b2a1u)
+            swap = true;
+        else
+            throw std::runtime_error(SB()<<fname<<" is not a pcap file");
+        auto host32 = [swap](uint32_t v) -> uint32_t {
+            return swap ? ((v>>24u)|((v>>8u)&0xff00u)|((v<<8u)&0xff0000u)|(v<<24u)) : v;
+        };
+        if(host32(fhead[5])!=147u)
+            throw std::runtime_error(SB()<<fname<<" is not a PVA capture (LINKTYPE_USER0)");
+
+        // first pass, conn. index and role
+        struct Rec {
+            double time;
+            bool tx;
+            std::string peer;
+            std::vector<uint8_t> msg;
+        };
+        std::vector<Rec> recs;
+        std::vector<uint8_t> data;
+        uint32_t rhead[4];
+        while(in.read(reinterpret_cast<char*>(rhead), sizeof(rhead))) {
+            data.resize(host32(rhead[2]));
+            if(!in.read(reinterpret_cast<char*>(data.data()), data.size()))
+                break; // truncated file
+            if(data.size()<2u || data.size()<2u+data[1])
+                continue;
+
+            Rec rec;
+            rec.time = host32(rhead[0]) + host32(rhead[1])*1e-6;
+            rec.tx = data[0];
+            rec.peer.assign(reinterpret_cast<const char*>(&data[2]), data[1]);
+            rec.msg.assign(data.begin()+2+data[1], data.end());
+
+            auto& C = conns[rec.peer];
+            if(rec.msg.size()>=3u && rec.tx && !(rec.msg[2]&pva_flags::Server))
+                C.client = true;
+
+            recs.push_back(std::move(rec));
+        }
+
+        // a process with both client and server would capture each message twice
+        bool anyClient = false;
+        for(auto& pair : conns)
+            anyClient |= pair.second.client;
+        unsigned nconn = 0u;
+        for(auto& pair : conns)
+            pair.second.index = nconn++;
+
+        for(auto& rec : recs) {
+            auto& C = conns[rec.peer];
+            if(anyClient && !C.client)
+                continue;
+            if(t0<0.0)
+                t0 = rec.time;
+            message(rec.time - t0, C, rec.msg.data(), rec.msg.size());
+        }
+    }
+};
+
+// Replay a profile
+struct Replayer {
+    double speed = 1.0;
+    double timeout = 5.0;
+    bool remote = false;
+    bool json = false;
+
+    std::vector<Event> events;
+
+    std::map<std::string, size_t> nelems; // name -> array length of stand-in PV
+    std::map<std::string, server::SharedPV> pvs;
+    std::map<std::string, Value> payloads;
+    server::Server serv;
+    std::map<unsigned, client::Context> clis;
+    std::map<std::pair<unsigned, uint32_t>, const Event*> inits;
+    std::map<std::pair<unsigned, uint32_t>, std::shared_ptr<client::Operation>> ops;
+    std::map<std::pair<unsigned, uint32_t>, std::shared_ptr<client::Subscription>> subs;
+
+    // GET, PUT, and RPC operations issued, and subscriptions
+    std::atomic<size_t> nissued{0u}, ncomplete{0u}, nfail{0u}, nsubscribed{0u}, nposted{0u}, nupdates{0u};
+    double maxLag = 0.0;
+
+    void read(const std::string& fname) {
+        std::ifstream in(fname);
+        if(!in.is_open())
+            throw std::runtime_error(SB()<<"Unable to open "<<fname);
+        std::string line;
+        size_t lineno = 0u;
+        while(std::getline(in, line)) {
+            lineno++;
+            if(line.empty() || line[0]=='#')
+                continue;
+            std::istringstream strm(line);
+            Event ev;
+            strm>>ev.time>>ev.conn>>ev.ioid>>ev.op>>ev.event>>ev.bytes>>ev.name;
+            if(strm.fail())
+                throw std::runtime_error(SB()<<fname<<':'<<lineno<<" invalid event");
+            if(ev.event=="init") {
+                strm>>ev.options>>ev.fields;
+                if(ev.options=="-")
+                    ev.options.clear();
+                if(ev.fields=="-")
+                    ev.fields.clear();
+            }
+            auto& nelem = nelems[ev.name];
+            if(ev.event=="reply" || ev.event=="update" || (ev.event=="exec" && ev.op!="get"))
+                nelem = std::max(nelem, ev.bytes/sizeof(double));
+            events.push_back(std::move(ev));
+        }
+        std::stable_sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) {
+            return lhs.time < rhs.time;
+        });
+    }
+
+    std::string request(const Event& init) const {
+        SB req;
+        if(!init.options.empty())
+            req<<"record["<<init.options<<"]";
+        req<<"field("<<(remote ? init.fields : std::string())<<")";
+        return req;
+    }
+
+    Value payload(const std::string& name) {
+        auto it = payloads.find(name);
+        if(it==payloads.end()) {
+            shared_array<double> arr(std::max(size_t(1u), nelems[name]));
+            auto val(nt::NTScalar{TypeCode::Float64A}.create());
+            val["value"] = arr.freeze();
+            it = payloads.emplace(name, val).first;
+        }
+        return it->second;
+    }
+
+    void setup() {
+        const auto prototype(nt::NTScalar{TypeCode::Float64A}.create());
+        if(!remote) {
+            serv = server::Config::isolated().build();
+            for(auto& pair : nelems) {
+                auto pv(server::SharedPV::buildMailbox());
+                pv.onRPC([](server::SharedPV&, std::unique_ptr<server::ExecOp>&& op, Value&& arg) {
+                    op->reply(arg);
+                });
+                pv.open(payload(pair.first));
+                serv.addPV(pair.first, pv);
+                pvs[pair.first] = pv;
+            }
+            serv.start();
+        }
+        for(auto& ev : events) {
+            if(!clis.count(ev.conn))
+                clis[ev.conn] = remote ? client::Context::fromEnv() : serv.clientConfig().build();
+        }
+    }
+
+    void result(client::Result&& r) {
+        try {
+            (void)r();
+            ncomplete++;
+        } catch(std::exception&) {
+            nfail++;
+        }
+    }
+
+    void play(const Event& ev) {
+        const auto key(std::make_pair(ev.conn, ev.ioid));
+        auto& ctxt = clis[ev.conn];
+
+        if(ev.event=="init") {
+            inits[key] = &ev;
+            if(ev.op=="monitor") {
+                nsubscribed++;
+                subs[key] = ctxt.monitor(ev.name)
+                        .pvRequest(request(ev))
+                        .maskConnected(true)
+                        .maskDisconnected(true)
+                        .event([this](client::Subscription& sub) {
+                            try {
+                                while(sub.pop())
+                                    nupdates++;
+                            } catch(std::exception&) {
+                                nfail++;
+                            }
+                        })
+                        .exec();
+            }
+
+        } else if(ev.event=="exec") {
+            auto it = inits.find(key);
+            if(it==inits.end())
+                return;
+            auto req(request(*it->second));
+            auto cb = [this](client::Result&& r) { result(std::move(r)); };
+            nissued++;
+            // replacing an incomplete operation of the same ioid cancels it
+            if(ev.op=="get") {
+                ops[key] = ctxt.get(ev.name).pvRequest(req).result(cb).exec();
+            } else if(ev.op=="put") {
+                auto val(payload(ev.name));
+                ops[key] = ctxt.put(ev.name).pvRequest(req)
+                        .build([val](Value&& proto) -> Value {
+                            auto ret(proto.cloneEmpty());
+                            ret["value"].assign(val["value"]);
+                            return ret;
+                        })
+                        .result(cb).exec();
+            } else if(ev.op=="rpc") {
+                ops[key] = ctxt.rpc(ev.name, payload(ev.name)).result(cb).exec();
+            }
+
+        } else if(ev.event=="update" && !remote) {
+            auto it = pvs.find(ev.name);
+            if(it!=pvs.end()) {
+                it->second.post(payload(ev.name).clone());
+                nposted++;
+            }
+
+        } else if(ev.event=="destroy") {
+            ops.erase(key);
+            subs.erase(key);
+            inits.erase(key);
+        }
+    }
+
+    void run() {
+        auto start = epicsMonotonicGet();
+        for(auto& ev : events) {
+            auto due = ev.time/speed;
+            auto now = (epicsMonotonicGet()-start)*1e-9;
+            if(due > now)
+                epicsThreadSleep(due - now);
+            else
+                maxLag = std::max(maxLag, now - due);
+            play(ev);
+        }
+        auto elapsed = (epicsMonotonicGet()-start)*1e-9;
+
+        // wait for operations in progress
+        auto deadline = epicsMonotonicGet() + uint64_t(timeout*1e9);
+        while(ncomplete.load()+nfail.load() < nissued.load() && epicsMonotonicGet()<deadline)
+            epicsThreadSleep(0.01);
+
+        const double recorded = events.empty() ? 0.0 : events.back().time;
+        Restore R(std::cout);
+        std::cout.setf(std::ios_base::fixed, std::ios_base::floatfield);
+        std::cout.precision(3);
+        if(json) {
+            std::cout<<"{\"events\": "<<events.size()<<", \"speed\": "<<speed
+                     <<", \"recorded_sec\": "<<recorded<<", \"elapsed_sec\": "<<elapsed
+                     <<", \"max_lag_sec\": "<<maxLag
+                     <<", \"issued\": "<<nissued.load()<<", \"complete\": "<<ncomplete.load()
+                     <<", \"failed\": "<<nfail.load()<<", \"subscribed\": "<<nsubscribed.load()
+                     <<", \"posted\": "<<nposted.load()
+                     <<", \"updates\": "<<nupdates.load()<<"}\n";
+        } else {
+            std::cout<<"events="<<events.size()<<" speed="<<speed
+                     <<" recorded="<<recorded<<"s elapsed="<<elapsed<<"s max_lag="<<maxLag<<"s\n"
+                     <<"issued="<<nissued.load()<<" complete="<<ncomplete.load()
+                     <<" failed="<<nfail.load()<<" subscribed="<<nsubscribed.load()
+                     <<" posted="<<nposted.load()
+                     <<" updates="<<nupdates.load()<<"\n";
+        }
+
+        ops.clear();
+        subs.clear();
+        for(auto& pair : clis)
+            pair.second.close();
+        if(!remote)
+            serv.stop();
+    }
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    try {
+        logger_config_env(); // from $PVXS_LOG
+        bool verbose = false;
+        std::string capture, outname;
+        Converter conv;
+        Replayer play;
+
+        {
+            int opt;
+            while ((opt = getopt(argc, argv, "hVvdr:o:AS:Rw:J")) != -1) {
+                switch(opt) {
+                case 'h':
+                    usage(argv[0]);
+                    return 0;
+                case 'V':
+                    std::cout<<pvxs::version_information;
+                    return 0;
+                case 'v':
+                    verbose = true;
+                    break;
+                case 'd':
+                    logger_level_set("pvxs.*", Level::Debug);
+                    break;
+                case 'r':
+                    capture = optarg;
+                    break;
+                case 'o':
+                    outname = optarg;
+                    break;
+                case 'A':
+                    conv.anonymize = true;
+                    break;
+                case 'S':
+                    play.speed = parseTo<double>(optarg);
+                    if(!(play.speed>0.0))
+                        throw std::invalid_argument("Speed must be positive");
+                    break;
+                case 'R':
+                    play.remote = true;
+                    break;
+                case 'w':
+                    play.timeout = parseTo<double>(optarg);
+                    break;
+                case 'J':
+                    play.json = true;
+                    break;
+                default:
+                    usage(argv[0]);
+                    std::cerr<<"\nUnknown argument: "<<char(opt)<<std::endl;
+                    return 1;
+                }
+            }
+        }
+
+        if(!capture.empty()) {
+            if(optind!=argc) {
+                usage(argv[0]);
+                std::cerr<<"\nUnexpected arguments with -r\n";
+                return 1;
+            }
+            conv.read(capture);
+
+            std::ofstream file;
+            if(!outname.empty()) {
+                file.open(outname);
+                if(!file.is_open())
+                    throw std::runtime_error(SB()<<"Unable to open "<<outname);
+            }
+            std::ostream& out = outname.empty() ? std::cout : file;
+            out<<"# pvxreplay profile from "<<capture<<"\n"
+                 "# <sec> <conn> <ioid> <op> <event> <bytes> <pvname> [<options> <fields>]\n";
+            for(auto& ev : conv.events)
+                out<<ev;
+            if(verbose)
+                std::cerr<<conv.events.size()<<" events from "<<conv.conns.size()<<" connections\n";
+            return out.good() ? 0 : 1;
+        }
+
+        if(argc-optind != 1) {
+            usage(argv[0]);
+            std::cerr<<"\nExpected one profile\n";
+            return 1;
+        }
+
+        play.read(argv[optind]);
+        play.setup();
+        if(verbose) {
+            std::cerr<<play.events.size()<<" events, "<<play.nelems.size()<<" PVs, "
+                     <<play.clis.size()<<" client contexts\n";
+            if(!play.remote)
+                std::cerr<<"Effective server config\n"<<play.serv.config();
+        }
+
+        SigInt sig([]() {
+            std::cerr<<"Interrupted\n";
+            exit(2);
+        });
+
+        play.run();
+        return 0;
+
+    }catch(std::exception& e){
+        std::cerr<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+}